@@ -0,0 +1,40 @@
+#include "MortonCode.h"
+
+
+TEST_CASE("MortonCode.encode", "[classic]")
+{
+	CHECK(Storm::MortonCode::encode(0, 0, 0) == 0);
+
+	CHECK(Storm::MortonCode::encode(1, 0, 0) == 0b001);
+	CHECK(Storm::MortonCode::encode(0, 1, 0) == 0b010);
+	CHECK(Storm::MortonCode::encode(0, 0, 1) == 0b100);
+	CHECK(Storm::MortonCode::encode(1, 1, 1) == 0b111);
+
+	CHECK(Storm::MortonCode::encode(2, 0, 0) == 0b001000);
+	CHECK(Storm::MortonCode::encode(3, 5, 6) == 0b110101011);
+
+	constexpr uint32_t k_max = Storm::MortonCode::k_maxCoordinate;
+	CHECK(Storm::MortonCode::encode(k_max, k_max, k_max) == 0x7FFFFFFFFFFFFFFF);
+	CHECK(Storm::MortonCode::encode(k_max + 1, 0, 0) == 0);
+}
+
+TEST_CASE("MortonCode.locality", "[classic]")
+{
+	// All codes inside a 2x2x2 block are contiguous, and come before those of the next block.
+	uint64_t maxInsideBlock = 0;
+	for (uint32_t x = 0; x < 2; ++x)
+	{
+		for (uint32_t y = 0; y < 2; ++y)
+		{
+			for (uint32_t z = 0; z < 2; ++z)
+			{
+				maxInsideBlock = std::max(maxInsideBlock, Storm::MortonCode::encode(x, y, z));
+			}
+		}
+	}
+
+	CHECK(maxInsideBlock == 7);
+	CHECK(Storm::MortonCode::encode(2, 0, 0) > maxInsideBlock);
+	CHECK(Storm::MortonCode::encode(0, 2, 0) > maxInsideBlock);
+	CHECK(Storm::MortonCode::encode(0, 0, 2) > maxInsideBlock);
+}
@@ -0,0 +1,189 @@
+#include "ParallelWorkerPool.h"
+#include "RunnerHelper.h"
+#include "ThreadHelper.h"
+
+
+namespace
+{
+	constexpr std::size_t k_workerCount = 3;
+
+	template<class Func>
+	void executeOnPool(Storm::IParallelExecutor &executor, const std::size_t itemCount, const std::size_t grainSize, Func &&func)
+	{
+		auto rangeFunc = [&func](const std::size_t firstIndex, const std::size_t endIndex)
+		{
+			for (std::size_t index = firstIndex; index < endIndex; ++index)
+			{
+				func(index);
+			}
+		};
+
+		executor.execute(itemCount, grainSize, Storm::makeParallelRangeTask(rangeFunc));
+	}
+
+	bool allVisitedOnce(const std::vector<std::atomic<int>> &visitCounts)
+	{
+		return std::all_of(std::begin(visitCounts), std::end(visitCounts), [](const std::atomic<int> &visitCount)
+		{
+			return visitCount.load() == 1;
+		});
+	}
+
+	// Registers the executor for runParallel and co while in scope.
+	class ParallelExecutorRegistration
+	{
+	public:
+		ParallelExecutorRegistration(Storm::IParallelExecutor &executor)
+		{
+			Storm::setParallelExecutor(&executor);
+		}
+
+		~ParallelExecutorRegistration()
+		{
+			Storm::setParallelExecutor(nullptr);
+		}
+	};
+}
+
+
+TEST_CASE("ParallelWorkerPool.EveryIndexOnce", "[classic]")
+{
+	Storm::ParallelWorkerPool pool{ k_workerCount, false, 0 };
+
+	for (const std::size_t itemCount : { 1, 2, 7, 1000, 100003 })
+	{
+		for (const std::size_t grainSize : { 0, 1, 17, 100000 })
+		{
+			std::vector<std::atomic<int>> visitCounts(itemCount);
+			executeOnPool(pool, itemCount, grainSize, [&visitCounts](const std::size_t index)
+			{
+				++visitCounts[index];
+			});
+
+			CHECK(allVisitedOnce(visitCounts));
+		}
+	}
+}
+
+TEST_CASE("ParallelWorkerPool.NestedLoop", "[classic]")
+{
+	Storm::ParallelWorkerPool pool{ k_workerCount, false, 0 };
+
+	constexpr std::size_t k_outerCount = 64;
+	constexpr std::size_t k_innerCount = 257;
+
+	// The nested loops are run inline by the thread executing the outer item, so they shouldn't wait for the workers that are all busy with the outer loop.
+	std::vector<std::atomic<int>> visitCounts(k_outerCount * k_innerCount);
+	executeOnPool(pool, k_outerCount, 1, [&pool, &visitCounts](const std::size_t outerIndex)
+	{
+		executeOnPool(pool, k_innerCount, 0, [&visitCounts, outerIndex](const std::size_t innerIndex)
+		{
+			++visitCounts[outerIndex * k_innerCount + innerIndex];
+		});
+	});
+
+	CHECK(allVisitedOnce(visitCounts));
+
+	// Same through runParallel, which is what the application uses.
+	const ParallelExecutorRegistration registration{ pool };
+
+	std::vector<std::vector<int>> nestedItems(k_outerCount, std::vector<int>(k_innerCount, 0));
+	Storm::runParallel(nestedItems, [](std::vector<int> &innerItems)
+	{
+		Storm::runParallel(innerItems, [](int &item, const std::size_t index)
+		{
+			item += static_cast<int>(index) + 1;
+		});
+	});
+
+	for (const std::vector<int> &innerItems : nestedItems)
+	{
+		for (std::size_t index = 0; index < k_innerCount; ++index)
+		{
+			CHECK(innerItems[index] == static_cast<int>(index) + 1);
+		}
+	}
+}
+
+TEST_CASE("ParallelWorkerPool.ExceptionPropagation", "[classic]")
+{
+	Storm::ParallelWorkerPool pool{ k_workerCount, false, 0 };
+
+	constexpr std::size_t k_itemCount = 10000;
+
+	// Whatever the thread throwing it (the calling thread or a worker), the exception is rethrown to the caller.
+	for (const std::size_t throwingIndex : { static_cast<std::size_t>(0), k_itemCount / 2, k_itemCount - 1 })
+	{
+		CHECK_THROWS_AS(executeOnPool(pool, k_itemCount, 1, [throwingIndex](const std::size_t index)
+		{
+			if (index == throwingIndex)
+			{
+				throw std::runtime_error{ "Expected exception" };
+			}
+		}), std::runtime_error);
+
+		// The pool should still be usable after.
+		std::vector<std::atomic<int>> visitCounts(k_itemCount);
+		executeOnPool(pool, k_itemCount, 0, [&visitCounts](const std::size_t index)
+		{
+			++visitCounts[index];
+		});
+
+		CHECK(allVisitedOnce(visitCounts));
+	}
+}
+
+TEST_CASE("ParallelWorkerPool.ConcurrentCallers", "[classic]")
+{
+	Storm::ParallelWorkerPool pool{ k_workerCount, false, 0 };
+
+	constexpr std::size_t k_callerCount = 4;
+	constexpr std::size_t k_loopCount = 200;
+	constexpr std::size_t k_itemCount = 5000;
+
+	// Only one caller at a time gets the workers, the others run their loops with the standard parallel policy instead of waiting. All loops must be complete anyway.
+	std::atomic<std::size_t> completeLoopCount = 0;
+	std::atomic<bool> caughtException = false;
+
+	std::vector<std::thread> callers;
+	callers.reserve(k_callerCount);
+	for (std::size_t callerIndex = 0; callerIndex < k_callerCount; ++callerIndex)
+	{
+		callers.emplace_back([&pool, &completeLoopCount, &caughtException]()
+		{
+			std::vector<std::atomic<int>> visitCounts(k_itemCount);
+			for (std::size_t loopIndex = 0; loopIndex < k_loopCount; ++loopIndex)
+			{
+				for (std::atomic<int> &visitCount : visitCounts)
+				{
+					visitCount = 0;
+				}
+
+				try
+				{
+					executeOnPool(pool, k_itemCount, 0, [&visitCounts](const std::size_t index)
+					{
+						++visitCounts[index];
+					});
+				}
+				catch (...)
+				{
+					caughtException = true;
+				}
+
+				if (allVisitedOnce(visitCounts))
+				{
+					++completeLoopCount;
+				}
+			}
+		});
+	}
+
+	for (std::thread &caller : callers)
+	{
+		Storm::join(caller);
+	}
+
+	CHECK_FALSE(caughtException);
+	CHECK(completeLoopCount == k_callerCount * k_loopCount);
+}
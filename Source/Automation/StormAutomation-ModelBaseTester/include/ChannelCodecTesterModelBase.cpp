@@ -0,0 +1,213 @@
+#include "Vector3.h"
+
+#include "ChannelCodec.h"
+#include "SerializePackage.h"
+#include "SerializePackageCreationModality.h"
+
+#include <iostream>
+
+
+namespace
+{
+	// Particles drifting a little each frame, like what a record frame holds.
+	struct DriftingChannels
+	{
+	public:
+		DriftingChannels(const std::size_t particleCount) :
+			_positions(particleCount),
+			_densities(particleCount),
+			_zeroForces(particleCount, Storm::Vector3::Zero())
+		{
+			for (std::size_t iter = 0; iter < particleCount; ++iter)
+			{
+				const float value = static_cast<float>(iter);
+				_positions[iter] = Storm::Vector3{ std::fmod(value * 0.01f, 2.f), std::fmod(value * 0.0037f, 1.f), value * 0.00001f };
+				_densities[iter] = 1000.f + std::fmod(value, 7.f) * 0.5f;
+			}
+		}
+
+	public:
+		void advance(const std::size_t frame)
+		{
+			const float frameOffset = static_cast<float>(frame);
+			for (std::size_t iter = 0; iter < _positions.size(); ++iter)
+			{
+				const float phase = static_cast<float>(iter % 97) * 0.001f;
+				_positions[iter] += Storm::Vector3{ 0.0001f + phase * 0.01f, -0.0002f, std::sin(frameOffset * 0.1f + phase) * 0.0001f };
+				_densities[iter] += std::sin(frameOffset * 0.3f + phase) * 0.01f;
+			}
+		}
+
+		void serialize(Storm::ChannelCodec &codec, Storm::SerializePackage &package, const bool compress, const Storm::ChannelQuantization* positionQuantization)
+		{
+			codec.serialize(package, _states[0], _positions, compress, positionQuantization);
+			codec.serialize(package, _states[1], _densities, compress);
+			codec.serialize(package, _states[2], _zeroForces, compress);
+		}
+
+		void resetStates()
+		{
+			for (Storm::ChannelCodecState &state : _states)
+			{
+				state.reset();
+			}
+		}
+
+		std::size_t byteCount() const
+		{
+			return _positions.size() * (2 * sizeof(Storm::Vector3) + sizeof(float));
+		}
+
+	public:
+		std::vector<Storm::Vector3> _positions;
+		std::vector<float> _densities;
+		std::vector<Storm::Vector3> _zeroForces;
+
+		std::array<Storm::ChannelCodecState, 3> _states;
+	};
+
+	std::string makeTestFilePath(const std::string_view fileName)
+	{
+		return (std::filesystem::temp_directory_path() / fileName).string();
+	}
+
+	// Writes the frames then reads them back, checking each read frame against the written one.
+	template<class CheckFunc>
+	void roundTrip(const std::string &filePath, const std::size_t frameCount, const std::size_t keyFrameInterval, const bool compress, const Storm::ChannelQuantization* positionQuantization, const CheckFunc &checkFunc)
+	{
+		constexpr std::size_t k_particleCount = 5003;
+
+		std::vector<DriftingChannels> writtenFrames;
+		writtenFrames.reserve(frameCount);
+
+		{
+			Storm::ChannelCodec codec;
+			DriftingChannels frame{ k_particleCount };
+
+			Storm::SerializePackage package{ Storm::SerializePackageCreationModality::SavingNew, filePath };
+			for (std::size_t iter = 0; iter < frameCount; ++iter)
+			{
+				if (iter % keyFrameInterval == 0)
+				{
+					frame.resetStates();
+				}
+
+				frame.advance(iter);
+				frame.serialize(codec, package, compress, positionQuantization);
+				writtenFrames.emplace_back(frame);
+			}
+		}
+
+		{
+			Storm::ChannelCodec codec;
+			DriftingChannels frame{ 0 };
+
+			Storm::SerializePackage package{ Storm::SerializePackageCreationModality::Loading, filePath };
+			for (std::size_t iter = 0; iter < frameCount; ++iter)
+			{
+				if (iter % keyFrameInterval == 0)
+				{
+					frame.resetStates();
+				}
+
+				frame.serialize(codec, package, compress, positionQuantization);
+				checkFunc(writtenFrames[iter], frame);
+			}
+		}
+
+		std::filesystem::remove(filePath);
+	}
+}
+
+
+TEST_CASE("ChannelCodec.LosslessRoundTrip", "[classic]")
+{
+	const std::string filePath = makeTestFilePath("StormChannelCodecLossless.bin");
+
+	for (const bool compress : { false, true })
+	{
+		roundTrip(filePath, 10, 4, compress, nullptr, [](const DriftingChannels &written, const DriftingChannels &read)
+		{
+			CHECK(read._positions == written._positions);
+			CHECK(read._densities == written._densities);
+			CHECK(read._zeroForces == written._zeroForces);
+		});
+	}
+}
+
+TEST_CASE("ChannelCodec.QuantizedRoundTrip", "[classic]")
+{
+	const std::string filePath = makeTestFilePath("StormChannelCodecQuantized.bin");
+
+	const Storm::ChannelQuantization quantization{ { -1.f, -1.f, -1.f }, 0.0001f };
+
+	roundTrip(filePath, 10, 4, true, &quantization, [&quantization](const DriftingChannels &written, const DriftingChannels &read)
+	{
+		REQUIRE(read._positions.size() == written._positions.size());
+
+		float maxError = 0.f;
+		for (std::size_t iter = 0; iter < written._positions.size(); ++iter)
+		{
+			maxError = std::max(maxError, (read._positions[iter] - written._positions[iter]).cwiseAbs().maxCoeff());
+		}
+
+		// Half the grid precision, and a little more for the float rounding.
+		CHECK(maxError <= quantization._precision * 0.501f);
+
+		// Only the positions are quantized.
+		CHECK(read._densities == written._densities);
+	});
+}
+
+TEST_CASE("ChannelCodec.Compression.Benchmark", "[.][benchmark]")
+{
+	constexpr std::size_t k_particleCount = 200000;
+	constexpr std::size_t k_frameCount = 32;
+
+	const std::string filePath = makeTestFilePath("StormChannelCodecBenchmark.bin");
+
+	DriftingChannels frame{ k_particleCount };
+	const double totalMb = static_cast<double>(frame.byteCount() * k_frameCount) / (1024.0 * 1024.0);
+
+	for (const bool compress : { false, true })
+	{
+		Storm::ChannelCodec codec;
+		frame.resetStates();
+
+		std::chrono::high_resolution_clock::duration encodeDuration{ 0 };
+
+		{
+			Storm::SerializePackage package{ Storm::SerializePackageCreationModality::SavingNew, filePath };
+			for (std::size_t iter = 0; iter < k_frameCount; ++iter)
+			{
+				frame.advance(iter);
+
+				const auto startTime = std::chrono::high_resolution_clock::now();
+				frame.serialize(codec, package, compress, nullptr);
+				encodeDuration += std::chrono::high_resolution_clock::now() - startTime;
+			}
+		}
+
+		const double fileMb = static_cast<double>(std::filesystem::file_size(filePath)) / (1024.0 * 1024.0);
+
+		DriftingChannels read{ 0 };
+		const auto startTime = std::chrono::high_resolution_clock::now();
+		{
+			Storm::SerializePackage package{ Storm::SerializePackageCreationModality::Loading, filePath };
+			for (std::size_t iter = 0; iter < k_frameCount; ++iter)
+			{
+				read.serialize(codec, package, compress, nullptr);
+			}
+		}
+		const double decodeSec = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+		const double encodeSec = std::chrono::duration<double>(encodeDuration).count();
+
+		std::cout <<
+			(compress ? "Compressed" : "Raw") << " : " << totalMb << " Mb of channels written in " << fileMb << " Mb (ratio " << totalMb / fileMb << ").\n"
+			"Encode " << totalMb / encodeSec << " Mb/s, decode " << totalMb / decodeSec << " Mb/s.\n";
+
+		CHECK(read._positions == frame._positions);
+	}
+
+	std::filesystem::remove(filePath);
+}
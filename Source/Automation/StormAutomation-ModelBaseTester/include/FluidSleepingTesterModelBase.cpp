@@ -0,0 +1,412 @@
+#include "Vector3.h"
+
+#include "FluidSleepingVoxels.h"
+#include "ParticleNeighborhoodStorage.h"
+
+#include "ISpacePartitionerManager.h"
+#include "VoxelGrid.h"
+#include "PartitionSelection.h"
+#include "NeighborParticleReferral.h"
+
+#include <random>
+
+
+namespace
+{
+	// Like the simulator, the space partition voxels are as large as the kernel.
+	constexpr float k_kernelLength = 2.f;
+	constexpr float k_voxelEdgeLength = k_kernelLength;
+	const Storm::Vector3 k_upCorner{ 24.f, 20.f, 20.f };
+	const Storm::Vector3 k_downCorner{ 0.f, 0.f, 0.f };
+	const Storm::Vector3 k_voxelShift{ 0.f, 0.f, 0.f };
+
+	constexpr unsigned int k_fluidSystemId = 1;
+	constexpr unsigned int k_rigidBodySystemId = 2;
+
+	constexpr uint16_t k_sleepingStepCount = 10;
+
+	// Only what the sleeping and the neighbor search use from the space partitioner, on top of real voxel grids : one for the fluid, one for the dynamic rigid bodies.
+	class TestSpacePartitioner final : public Storm::ISpacePartitionerManager
+	{
+	public:
+		TestSpacePartitioner() :
+			_fluidGrid{ k_upCorner, k_downCorner, k_voxelEdgeLength },
+			_rigidBodyGrid{ k_upCorner, k_downCorner, k_voxelEdgeLength }
+		{}
+
+	public:
+		void fill(const std::vector<Storm::Vector3> &fluidPositions, const std::vector<Storm::Vector3> &rigidBodyPositions)
+		{
+			_fluidGrid.clear();
+			_fluidGrid.fill(k_voxelEdgeLength, k_voxelShift, fluidPositions, k_fluidSystemId);
+			_fluidGrid.prepareQueries();
+
+			_rigidBodyGrid.clear();
+			_rigidBodyGrid.fill(k_voxelEdgeLength, k_voxelShift, rigidBodyPositions, k_rigidBodySystemId);
+			_rigidBodyGrid.prepareQueries();
+		}
+
+		const Storm::VoxelGrid& getFluidGrid() const noexcept
+		{
+			return _fluidGrid;
+		}
+
+	public:
+		void partitionSpace() final override {}
+		void computeSpaceReordering(const std::vector<Storm::Vector3> &, Storm::PartitionSelection, const unsigned int) final override {}
+		bool prepareSpaceReorderingUpdate(const std::vector<Storm::Vector3> &, Storm::PartitionSelection, const unsigned int) final override { return false; }
+		bool applySpaceReorderingUpdate(Storm::PartitionSelection, float) final override { return false; }
+		void finishSpaceReordering(Storm::PartitionSelection) final override {}
+		void invalidateSpaceReorderingUpdate(Storm::PartitionSelection) final override {}
+		void clearSpaceReorderingNoStatic() final override {}
+		void clearSpaceReorderingForPartition(Storm::PartitionSelection) final override {}
+		void freezeStaticPartition() final override {}
+		bool isStaticPartitionFrozen() const noexcept final override { return false; }
+
+		void getAllBundles(const Storm::NeighborParticleReferralBundle* &outContainingBundlePtr, const Storm::NeighborParticleReferralBundle*(&outNeighborBundle)[Storm::k_neighborLinkedBunkCount], const Storm::Vector3 &particlePosition, Storm::PartitionSelection modality) const final override
+		{
+			this->getGrid(modality).getVoxelsDataAtPosition(k_voxelEdgeLength, k_voxelShift, outContainingBundlePtr, outNeighborBundle, particlePosition);
+		}
+
+		void getAllBundlesInfinite(const Storm::NeighborParticleReferralBundle* &outContainingBundlePtr, const Storm::NeighborParticleReferralBundle*(&outNeighborBundle)[Storm::k_neighborLinkedBunkCount], const Storm::Vector3 &particlePosition, Storm::PartitionSelection modality, const Storm::OutReflectedModality* &reflectModality) const final override
+		{
+			this->getGrid(modality).getVoxelsDataAtPositionInfinite(k_voxelEdgeLength, k_voxelShift, outContainingBundlePtr, outNeighborBundle, particlePosition, reflectModality);
+		}
+
+		void getForwardBundles(const Storm::NeighborParticleReferralBundle* &outContainingBundlePtr, const Storm::NeighborParticleReferralBundle*(&outForwardNeighborBundle)[Storm::k_neighborLinkedBunkCount], const Storm::Vector3 &particlePosition, Storm::PartitionSelection modality) const final override
+		{
+			this->getGrid(modality).getForwardVoxelsDataAtPosition(k_voxelEdgeLength, k_voxelShift, outContainingBundlePtr, outForwardNeighborBundle, particlePosition);
+		}
+
+		void getContainingBundle(const Storm::NeighborParticleReferralBundle* &outContainingBundlePtr, const Storm::Vector3 &particlePosition, Storm::PartitionSelection modality) const final override
+		{
+			this->getGrid(modality).getVoxelsDataAtPosition(k_voxelEdgeLength, k_voxelShift, outContainingBundlePtr, particlePosition);
+		}
+
+		void visitBundlesInsideBox(const Storm::Vector3 &minCorner, const Storm::Vector3 &maxCorner, Storm::PartitionSelection modality, const Storm::ISpacePartitionerManager::BundleVisitor &visitor) const final override
+		{
+			this->getGrid(modality).traverseVoxelsInsideBox(minCorner, maxCorner, k_voxelEdgeLength, k_voxelShift, visitor);
+		}
+
+		void setPartitionLength(float) final override {}
+		float getPartitionLength() const final override { return k_voxelEdgeLength; }
+
+		std::shared_ptr<Storm::IDistanceSpacePartitionProxy> makeDistancePartitionProxy(const Storm::Vector3 &, const Storm::Vector3 &, const float) final override { return nullptr; }
+
+		bool isOutsideSpaceDomain(const Storm::Vector3 &position) const final override
+		{
+			return
+				position.x() < k_downCorner.x() || position.y() < k_downCorner.y() || position.z() < k_downCorner.z() ||
+				position.x() > k_upCorner.x() || position.y() > k_upCorner.y() || position.z() > k_upCorner.z()
+				;
+		}
+
+		bool isInfiniteDomainMode() const noexcept final override { return false; }
+		Storm::Vector3 getDomainDimension() const noexcept final override { return k_upCorner - k_downCorner; }
+
+	private:
+		// The static rigid bodies don't matter to the sleeping, they share the dynamic rigid body grid.
+		const Storm::VoxelGrid& getGrid(const Storm::PartitionSelection modality) const
+		{
+			return modality == Storm::PartitionSelection::Fluid ? _fluidGrid : _rigidBodyGrid;
+		}
+
+	private:
+		Storm::VoxelGrid _fluidGrid;
+		Storm::VoxelGrid _rigidBodyGrid;
+	};
+
+	// A jittered fluid block. The particles of the low x half stay quiet (they can sleep), the others keep moving.
+	class SleepingScene
+	{
+	public:
+		SleepingScene() :
+			_randomEngine{ 42 }
+		{
+			constexpr int k_xParticleCount = 16;
+			constexpr int k_yzParticleCount = 12;
+
+			std::uniform_real_distribution<float> jitterDistribution{ -0.2f, 0.2f };
+
+			for (int xIndex = 0; xIndex < k_xParticleCount; ++xIndex)
+			{
+				for (int yIndex = 0; yIndex < k_yzParticleCount; ++yIndex)
+				{
+					for (int zIndex = 0; zIndex < k_yzParticleCount; ++zIndex)
+					{
+						const Storm::Vector3 latticePosition{ 3.f + static_cast<float>(xIndex), 3.f + static_cast<float>(yIndex), 3.f + static_cast<float>(zIndex) };
+						_positions.emplace_back(latticePosition + Storm::Vector3{ jitterDistribution(_randomEngine), jitterDistribution(_randomEngine), jitterDistribution(_randomEngine) });
+						_quietStepCounts.emplace_back(xIndex < k_xParticleCount / 2 ? k_sleepingStepCount : 0);
+					}
+				}
+			}
+
+			// One restless particle inside the quiet half, its voxel shouldn't sleep.
+			_restlessPIndex = (3 * k_yzParticleCount + 5) * k_yzParticleCount + 5;
+			_quietStepCounts[_restlessPIndex] = 0;
+
+			// A dynamic rigid body particle inside the quiet half. Even asleep, the fluid around it shouldn't keep its neighborhoods.
+			_rigidBodyPositions.emplace_back(5.5f, 11.f, 11.f);
+
+			_sleeping.resize(_positions.size(), 0);
+			_frozen.resize(_positions.size(), 0);
+			_frozenNeighborhoods.resize(_positions.size(), 0);
+			_kept.resize(_positions.size(), 0);
+		}
+
+	public:
+		// The awake particles move (less than half the kernel length each step), the sleeping ones are frozen.
+		void moveAwakeParticles()
+		{
+			std::uniform_real_distribution<float> moveDistribution{ -0.6f, 0.6f };
+			for (std::size_t particleIndex = 0; particleIndex < _positions.size(); ++particleIndex)
+			{
+				if (!_sleeping[particleIndex])
+				{
+					_positions[particleIndex] += Storm::Vector3{ moveDistribution(_randomEngine), moveDistribution(_randomEngine), moveDistribution(_randomEngine) };
+				}
+			}
+		}
+
+		// What Storm::FluidParticleSystem::updateSleeping does with the voxels.
+		void updateSleeping()
+		{
+			_partitioner.fill(_positions, _rigidBodyPositions);
+			_sleepingVoxels.computeSleepingParticles(_partitioner, k_fluidSystemId, _quietStepCounts, k_sleepingStepCount, _sleeping);
+		}
+
+		// What Storm::FluidParticleSystem::computeKeptNeighborhoods does without Verlet lists.
+		void computeKeptNeighborhoods()
+		{
+			_sleepingVoxels.computeFrozenParticles(_partitioner, k_fluidSystemId, _positions, _sleeping, _frozen);
+			for (std::size_t particleIndex = 0; particleIndex < _positions.size(); ++particleIndex)
+			{
+				_kept[particleIndex] = Storm::FluidSleepingVoxels::keepsNeighborhood(_frozen[particleIndex] != 0, _frozenNeighborhoods[particleIndex]);
+			}
+		}
+
+		Storm::ParticleNeighborhoodStorage::NeighborSources makeNeighborSources() const
+		{
+			// The particle system is only used to identify the neighbors, it is never dereferenced by the storage.
+			return Storm::ParticleNeighborhoodStorage::NeighborSources{
+				{ Storm::ParticleNeighborhoodStorage::ReferencedParticleSystem{ nullptr, &_positions, true } },
+				false,
+				Storm::Vector3::Zero(),
+				k_kernelLength
+			};
+		}
+
+		// Brute force search of the neighbors of a particle with an index in [firstNeighborIndex, particle count).
+		void searchNeighborhood(Storm::ParticleNeighborhoodBuildArray &outNeighborhood, const std::size_t particleIndex, const std::size_t firstNeighborIndex) const
+		{
+			const Storm::Vector3 &currentPPosition = _positions[particleIndex];
+			for (std::size_t neighborIndex = firstNeighborIndex; neighborIndex < _positions.size(); ++neighborIndex)
+			{
+				if (neighborIndex == particleIndex)
+				{
+					continue;
+				}
+
+				const Storm::Vector3 xij = currentPPosition - _positions[neighborIndex];
+				const float xijSquaredNorm = xij.squaredNorm();
+				if (xijSquaredNorm < k_kernelLength * k_kernelLength)
+				{
+					Storm::NeighborParticleInfo &neighbor = outNeighborhood.emplace_back(nullptr, neighborIndex, xij, xijSquaredNorm, true, true);
+
+					// A cubic falloff is enough to have kernel values that depend on xij like the real kernels.
+					const float falloff = 1.f - neighbor._xijNorm / k_kernelLength;
+					neighbor._Wij = falloff * falloff * falloff;
+					neighbor._gradWij = xij * (-3.f * falloff * falloff / (k_kernelLength * neighbor._xijNorm));
+				}
+			}
+		}
+
+	public:
+		std::mt19937 _randomEngine;
+		TestSpacePartitioner _partitioner;
+		Storm::FluidSleepingVoxels _sleepingVoxels;
+
+		std::vector<Storm::Vector3> _positions;
+		std::vector<Storm::Vector3> _rigidBodyPositions;
+		std::vector<uint16_t> _quietStepCounts;
+		std::size_t _restlessPIndex;
+
+		std::vector<uint8_t> _sleeping;
+		std::vector<uint8_t> _frozen;
+		std::vector<uint8_t> _frozenNeighborhoods;
+		std::vector<uint8_t> _kept;
+	};
+
+	bool areNear(const float first, const float second)
+	{
+		return std::abs(first - second) <= 0.0001f * std::max(1.f, std::abs(first));
+	}
+
+	bool areNear(const Storm::Vector3 &first, const Storm::Vector3 &second)
+	{
+		return areNear(first.x(), second.x()) && areNear(first.y(), second.y()) && areNear(first.z(), second.z());
+	}
+
+	// The neighborhood of each particle should be the one a brute force search finds from the current positions : same neighbors, same xij and kernel values.
+	bool isSameAsBruteForce(const SleepingScene &scene, const Storm::ParticleNeighborhoodStorage &storage, const std::size_t particleIndex)
+	{
+		Storm::ParticleNeighborhoodBuildArray expected;
+		scene.searchNeighborhood(expected, particleIndex, 0);
+
+		const Storm::ParticleNeighborhoodArray neighborhood = storage[particleIndex];
+		if (neighborhood.size() != expected.size())
+		{
+			return false;
+		}
+
+		for (const Storm::NeighborParticleInfo &neighbor : neighborhood)
+		{
+			const auto expectedNeighborIt = std::find_if(std::begin(expected), std::end(expected), [&neighbor](const Storm::NeighborParticleInfo &expectedNeighbor)
+			{
+				return expectedNeighbor._particleIndex == neighbor._particleIndex;
+			});
+
+			if (
+				expectedNeighborIt == std::end(expected) ||
+				!areNear(neighbor._xij, expectedNeighborIt->_xij) ||
+				!areNear(neighbor._Wij, expectedNeighborIt->_Wij) ||
+				!areNear(neighbor._gradWij, expectedNeighborIt->_gradWij)
+				)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// Each neighbor j of i should have i as neighbor, with the same Wij and the opposite xij and gradWij.
+	bool hasSymmetricPairs(const Storm::ParticleNeighborhoodStorage &storage, const std::size_t particleIndex)
+	{
+		for (const Storm::NeighborParticleInfo &neighbor : storage[particleIndex])
+		{
+			const Storm::ParticleNeighborhoodArray reverseNeighborhood = storage[neighbor._particleIndex];
+			const auto reverseNeighborIt = std::find_if(std::begin(reverseNeighborhood), std::end(reverseNeighborhood), [particleIndex](const Storm::NeighborParticleInfo &reverseNeighbor)
+			{
+				return reverseNeighbor._particleIndex == particleIndex;
+			});
+
+			if (
+				reverseNeighborIt == std::end(reverseNeighborhood) ||
+				!areNear((*reverseNeighborIt)._xij, -neighbor._xij) ||
+				!areNear((*reverseNeighborIt)._Wij, neighbor._Wij) ||
+				!areNear((*reverseNeighborIt)._gradWij, -neighbor._gradWij)
+				)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
+
+
+TEST_CASE("FluidSleeping.SleepingVoxels", "[classic]")
+{
+	SleepingScene scene;
+	scene.updateSleeping();
+
+	// A particle sleeps if and only if all the particles of its voxel stayed quiet long enough.
+	const Storm::VoxelGrid &grid = scene._partitioner.getFluidGrid();
+	const Storm::Vector3ui &gridBoundary = grid.getGridBoundary();
+
+	const std::size_t particleCount = scene._positions.size();
+	std::vector<unsigned int> voxelIndexes(particleCount);
+	for (std::size_t particleIndex = 0; particleIndex < particleCount; ++particleIndex)
+	{
+		unsigned int xIndex;
+		unsigned int yIndex;
+		unsigned int zIndex;
+		voxelIndexes[particleIndex] = grid.computeRawIndexFromPosition(gridBoundary, k_voxelEdgeLength, k_voxelShift, scene._positions[particleIndex], xIndex, yIndex, zIndex);
+	}
+
+	std::size_t sleepingCount = 0;
+	for (std::size_t particleIndex = 0; particleIndex < particleCount; ++particleIndex)
+	{
+		bool expectedSleeping = true;
+		for (std::size_t otherPIndex = 0; otherPIndex < particleCount; ++otherPIndex)
+		{
+			if (voxelIndexes[otherPIndex] == voxelIndexes[particleIndex] && scene._quietStepCounts[otherPIndex] < k_sleepingStepCount)
+			{
+				expectedSleeping = false;
+				break;
+			}
+		}
+
+		CAPTURE(particleIndex);
+		CHECK((scene._sleeping[particleIndex] != 0) == expectedSleeping);
+
+		sleepingCount += scene._sleeping[particleIndex];
+	}
+
+	CHECK(scene._sleeping[scene._restlessPIndex] == 0);
+	CHECK(sleepingCount != 0);
+	CHECK(sleepingCount != particleCount);
+}
+
+TEST_CASE("FluidSleeping.KeptNeighborhoods", "[classic]")
+{
+	SleepingScene scene;
+	const std::size_t particleCount = scene._positions.size();
+
+	Storm::ParticleNeighborhoodStorage storage{ scene._positions };
+
+	const auto symmetricSearchFunc = [&scene](Storm::ParticleNeighborhoodBuildArray &outForwardNeighborhood, Storm::ParticleNeighborhoodBuildArray &, const std::size_t particleIndex)
+	{
+		scene.searchNeighborhood(outForwardNeighborhood, particleIndex, particleIndex + 1);
+		return true;
+	};
+	const auto shouldKeepPrevious = [&scene](const std::size_t particleIndex)
+	{
+		return scene._kept[particleIndex] != 0;
+	};
+
+	// Like the simulation loop : the neighborhoods are built, the awake particles move, then the sleeping is updated.
+	// The first build can't keep anything, nothing was frozen before it.
+	std::size_t totalKeptCount = 0;
+	for (int stepIndex = 0; stepIndex < 4; ++stepIndex)
+	{
+		scene.computeKeptNeighborhoods();
+
+		storage.resetKeepingPrevious(scene.makeNeighborSources());
+		storage.fillSymmetricKeepingPrevious(symmetricSearchFunc, shouldKeepPrevious);
+
+		std::size_t keptCount = 0;
+		for (std::size_t particleIndex = 0; particleIndex < particleCount; ++particleIndex)
+		{
+			CAPTURE(stepIndex, particleIndex, static_cast<int>(scene._kept[particleIndex]));
+			CHECK(isSameAsBruteForce(scene, storage, particleIndex));
+			CHECK(hasSymmetricPairs(storage, particleIndex));
+
+			// The fluid near the rigid body can move anytime, its neighborhood should always be searched.
+			if ((scene._positions[particleIndex] - scene._rigidBodyPositions.front()).cwiseAbs().maxCoeff() < k_voxelEdgeLength)
+			{
+				CHECK(scene._kept[particleIndex] == 0);
+			}
+
+			keptCount += scene._kept[particleIndex];
+		}
+
+		if (stepIndex == 0)
+		{
+			CHECK(keptCount == 0);
+		}
+		else
+		{
+			CHECK(keptCount != particleCount);
+		}
+
+		totalKeptCount += keptCount;
+
+		scene.moveAwakeParticles();
+		scene.updateSleeping();
+	}
+
+	CHECK(totalKeptCount != 0);
+}
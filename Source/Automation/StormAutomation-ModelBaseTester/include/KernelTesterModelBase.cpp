@@ -0,0 +1,93 @@
+#include "Vector3.h"
+
+#include "CubicSplineKernel.h"
+#include "SplishSplashCubicSplineKernel.h"
+
+#include "InstructionSet.h"
+
+#include <random>
+
+
+namespace
+{
+	constexpr float k_kernelLength = 0.04f;
+
+	// Neighbors all around the particle, from very near to the kernel length. Some are exactly at half the kernel length, where the spline changes its part.
+	Storm::ParticleNeighborhoodBuildArray makeNeighborhood(const std::size_t neighborCount, std::mt19937 &randomEngine)
+	{
+		std::uniform_real_distribution<float> directionDistribution{ -1.f, 1.f };
+		std::uniform_real_distribution<float> normDistribution{ 0.01f * k_kernelLength, k_kernelLength };
+
+		Storm::ParticleNeighborhoodBuildArray result;
+		result.reserve(neighborCount);
+
+		for (std::size_t iter = 0; iter < neighborCount; ++iter)
+		{
+			Storm::Vector3 direction;
+			do
+			{
+				direction = Storm::Vector3{ directionDistribution(randomEngine), directionDistribution(randomEngine), directionDistribution(randomEngine) };
+			} while (direction.squaredNorm() < 0.01f);
+
+			const float norm = iter % 5 == 0 ? 0.5f * k_kernelLength : normDistribution(randomEngine);
+			const Storm::Vector3 xij = direction.normalized() * norm;
+			result.emplace_back(nullptr, iter, xij, xij.squaredNorm(), true, true);
+		}
+
+		return result;
+	}
+
+	template<class KernelType, Storm::SIMDUsageMode simdMode>
+	void checkSameAsScalar(const std::size_t neighborCount, std::mt19937 &randomEngine)
+	{
+		Storm::ParticleNeighborhoodBuildArray scalarNeighborhood = makeNeighborhood(neighborCount, randomEngine);
+		Storm::ParticleNeighborhoodBuildArray simdNeighborhood = scalarNeighborhood;
+
+		KernelType::template computeNeighborhood<Storm::SIMDUsageMode::SISD>(k_kernelLength, scalarNeighborhood);
+		KernelType::template computeNeighborhood<simdMode>(k_kernelLength, simdNeighborhood);
+
+		const float rawTolerance = 1e-5f * KernelType::zeroValue();
+		for (std::size_t iter = 0; iter < neighborCount; ++iter)
+		{
+			const Storm::NeighborParticleInfo &expected = scalarNeighborhood[iter];
+			const Storm::NeighborParticleInfo &value = simdNeighborhood[iter];
+
+			CAPTURE(neighborCount, iter, expected._xijNorm / k_kernelLength);
+			CHECK(std::fabs(value._Wij - expected._Wij) <= rawTolerance);
+			CHECK((value._gradWij - expected._gradWij).norm() <= 1e-5f * std::max(expected._gradWij.norm(), 1.f));
+		}
+	}
+
+	template<class KernelType>
+	void checkAllSIMDModesSameAsScalar()
+	{
+		std::mt19937 randomEngine{ 42 };
+
+		// Around the lane counts (8 with AVX2, 16 with AVX512), so the scalar tail is covered.
+		for (const std::size_t neighborCount : { 1, 7, 8, 9, 15, 16, 17, 33 })
+		{
+			if (Storm::InstructionSet::AVX2() && Storm::InstructionSet::FMA())
+			{
+				checkSameAsScalar<KernelType, Storm::SIMDUsageMode::AVX2>(neighborCount, randomEngine);
+			}
+
+			if (Storm::InstructionSet::AVX512F())
+			{
+				checkSameAsScalar<KernelType, Storm::SIMDUsageMode::AVX512>(neighborCount, randomEngine);
+			}
+		}
+	}
+}
+
+
+TEST_CASE("Kernel.CubicSpline.SIMD", "[classic]")
+{
+	Storm::CubicSplineKernel::initialize(k_kernelLength);
+	checkAllSIMDModesSameAsScalar<Storm::CubicSplineKernel>();
+}
+
+TEST_CASE("Kernel.SplishSplashCubicSpline.SIMD", "[classic]")
+{
+	Storm::SplishSplashCubicSplineKernel::initialize(k_kernelLength);
+	checkAllSIMDModesSameAsScalar<Storm::SplishSplashCubicSplineKernel>();
+}
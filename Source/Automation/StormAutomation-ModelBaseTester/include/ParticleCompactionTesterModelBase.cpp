@@ -0,0 +1,260 @@
+#include "Vector3.h"
+
+#include "ParticleCompaction.h"
+
+#include <random>
+#include <set>
+
+
+namespace
+{
+	constexpr std::size_t k_removedStableId = std::numeric_limits<std::size_t>::max();
+
+	std::vector<std::size_t> makeIdentity(const std::size_t particleCount)
+	{
+		std::vector<std::size_t> result(particleCount);
+		std::iota(std::begin(result), std::end(result), static_cast<std::size_t>(0));
+		return result;
+	}
+
+	// Compacts an array whose values are the particle indexes, and checks that exactly the kept particles remain, that the moves only fill holes with particles from after the new end,
+	// and that the particles before the new end that weren't removed didn't move.
+	bool isValidCompaction(const std::vector<std::size_t> &removedIndexes, const std::size_t particleCount)
+	{
+		const std::set<std::size_t> removedSet{ std::begin(removedIndexes), std::end(removedIndexes) };
+
+		std::vector<std::size_t> removedIndexesCopy = removedIndexes;
+		Storm::ParticleCompaction compaction;
+		compaction.compute(removedIndexesCopy, particleCount);
+
+		const std::size_t newParticleCount = particleCount - removedSet.size();
+		if (compaction.getRemovedCount() != removedSet.size() || compaction.getOldParticleCount() != particleCount || compaction.getNewParticleCount() != newParticleCount || compaction.empty() != removedSet.empty())
+		{
+			return false;
+		}
+
+		for (const auto &move : compaction.getMoves())
+		{
+			if (move.first >= newParticleCount || !removedSet.contains(move.first) || move.second < newParticleCount || removedSet.contains(move.second))
+			{
+				return false;
+			}
+		}
+
+		std::vector<std::size_t> values = makeIdentity(particleCount);
+		compaction.apply(values);
+
+		if (values.size() != newParticleCount)
+		{
+			return false;
+		}
+
+		for (std::size_t particleIndex = 0; particleIndex < newParticleCount; ++particleIndex)
+		{
+			if (!removedSet.contains(particleIndex) && values[particleIndex] != particleIndex)
+			{
+				return false;
+			}
+		}
+
+		std::vector<std::size_t> expectedValues;
+		for (std::size_t particleIndex = 0; particleIndex < particleCount; ++particleIndex)
+		{
+			if (!removedSet.contains(particleIndex))
+			{
+				expectedValues.emplace_back(particleIndex);
+			}
+		}
+
+		std::sort(std::begin(values), std::end(values));
+		return values == expectedValues;
+	}
+
+	// What the particle system keeps : the stable ids, their reverse mapping, and an attribute following the particles (its value is the stable id the particle had at creation).
+	class StableIdParticles
+	{
+	public:
+		StableIdParticles(const std::size_t particleCount) :
+			_stableIds{ makeIdentity(particleCount) },
+			_stableIdToIndex{ _stableIds },
+			_attributes{ _stableIds }
+		{}
+
+	public:
+		void compact(std::vector<std::size_t> removedIndexes)
+		{
+			Storm::ParticleCompaction compaction;
+			compaction.compute(removedIndexes, _stableIds.size());
+
+			compaction.applyToStableIds(_stableIds, _stableIdToIndex);
+			compaction.apply(_attributes);
+		}
+
+		// Same as Storm::ParticleSystem::appendParticles : the new stable ids were never used before.
+		void append(const std::size_t appendedCount)
+		{
+			for (std::size_t appendIter = 0; appendIter < appendedCount; ++appendIter)
+			{
+				const std::size_t newStableId = _stableIdToIndex.size();
+				_stableIdToIndex.emplace_back(_stableIds.size());
+				_stableIds.emplace_back(newStableId);
+				_attributes.emplace_back(newStableId);
+			}
+		}
+
+		bool isConsistent(const std::set<std::size_t> &removedStableIds) const
+		{
+			if (_stableIds.size() != _attributes.size())
+			{
+				return false;
+			}
+
+			// Particle index -> stable id -> same particle index, and the attributes followed their particle.
+			for (std::size_t particleIndex = 0; particleIndex < _stableIds.size(); ++particleIndex)
+			{
+				const std::size_t stableId = _stableIds[particleIndex];
+				if (_stableIdToIndex[stableId] != particleIndex || _attributes[particleIndex] != stableId || removedStableIds.contains(stableId))
+				{
+					return false;
+				}
+			}
+
+			// Stable id -> particle index -> same stable id, or unbound if the particle was removed.
+			for (std::size_t stableId = 0; stableId < _stableIdToIndex.size(); ++stableId)
+			{
+				const std::size_t particleIndex = _stableIdToIndex[stableId];
+				if (removedStableIds.contains(stableId) ? particleIndex != k_removedStableId : (particleIndex >= _stableIds.size() || _stableIds[particleIndex] != stableId))
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+	public:
+		std::vector<std::size_t> _stableIds;
+		std::vector<std::size_t> _stableIdToIndex;
+		std::vector<std::size_t> _attributes;
+	};
+}
+
+
+TEST_CASE("ParticleCompaction.Compute", "[classic]")
+{
+	// Nothing to remove.
+	CHECK(isValidCompaction({}, 10));
+	CHECK(isValidCompaction({}, 0));
+
+	// Holes only, tail only, both.
+	CHECK(isValidCompaction({ 0 }, 10));
+	CHECK(isValidCompaction({ 2, 5 }, 10));
+	CHECK(isValidCompaction({ 8, 9 }, 10));
+	CHECK(isValidCompaction({ 9 }, 10));
+	CHECK(isValidCompaction({ 1, 8 }, 10));
+	CHECK(isValidCompaction({ 0, 1, 2, 7, 9 }, 10));
+
+	// Unsorted, with duplicates.
+	CHECK(isValidCompaction({ 7, 3, 7, 3, 3, 9, 0 }, 10));
+	CHECK(isValidCompaction({ 4, 4, 4, 4 }, 5));
+
+	// Everything, or all but one.
+	CHECK(isValidCompaction(makeIdentity(10), 10));
+	CHECK(isValidCompaction({ 0 }, 1));
+	CHECK(isValidCompaction({ 0, 1, 2, 3, 5, 6, 7, 8, 9 }, 10));
+	CHECK(isValidCompaction({ 1, 2, 3, 4, 5, 6, 7, 8, 9 }, 10));
+
+	// Random removals (with duplicates), from a few particles to most of them.
+	std::mt19937 randomEngine{ 42 };
+	for (const std::size_t particleCount : { 2, 17, 256, 5000 })
+	{
+		std::uniform_int_distribution<std::size_t> indexDistribution{ 0, particleCount - 1 };
+		for (const std::size_t removeTryCount : { particleCount / 10, particleCount / 2, particleCount, particleCount * 3 })
+		{
+			std::vector<std::size_t> removedIndexes(removeTryCount);
+			for (std::size_t &removedIndex : removedIndexes)
+			{
+				removedIndex = indexDistribution(randomEngine);
+			}
+
+			CHECK(isValidCompaction(removedIndexes, particleCount));
+		}
+	}
+}
+
+TEST_CASE("ParticleCompaction.TailRemovalKeepsOrder", "[classic]")
+{
+	std::vector<std::size_t> removedIndexes{ 9, 7, 8 };
+
+	Storm::ParticleCompaction compaction;
+	compaction.compute(removedIndexes, 10);
+
+	CHECK(compaction.getMoves().empty());
+
+	std::vector<std::size_t> values = makeIdentity(10);
+	compaction.apply(values);
+	CHECK(values == makeIdentity(7));
+
+	// Empty arrays are left as is.
+	std::vector<Storm::Vector3> emptyArray;
+	compaction.apply(emptyArray);
+	CHECK(emptyArray.empty());
+}
+
+TEST_CASE("ParticleCompaction.StableIds", "[classic]")
+{
+	std::set<std::size_t> removedStableIds;
+
+	StableIdParticles particles{ 20 };
+	CHECK(particles.isConsistent(removedStableIds));
+
+	// Duplicates, holes and tail at once.
+	particles.compact({ 3, 19, 3, 0, 18, 7 });
+	removedStableIds.insert({ 0, 3, 7, 18, 19 });
+	CHECK(particles._stableIds.size() == 15);
+	CHECK(particles.isConsistent(removedStableIds));
+
+	// Removed stable ids are never given again.
+	particles.append(4);
+	CHECK(particles._stableIds.back() == 23);
+	CHECK(particles.isConsistent(removedStableIds));
+
+	// The tail only (the particles just appended and one before).
+	for (std::size_t particleIndex = 14; particleIndex < 19; ++particleIndex)
+	{
+		removedStableIds.insert(particles._stableIds[particleIndex]);
+	}
+	particles.compact({ 14, 15, 16, 17, 18 });
+	CHECK(particles.isConsistent(removedStableIds));
+
+	// Random rounds of removals and appends.
+	std::mt19937 randomEngine{ 42 };
+	for (std::size_t roundIter = 0; roundIter < 50; ++roundIter)
+	{
+		std::vector<std::size_t> removedIndexes;
+		if (!particles._stableIds.empty())
+		{
+			std::uniform_int_distribution<std::size_t> indexDistribution{ 0, particles._stableIds.size() - 1 };
+			removedIndexes.resize(particles._stableIds.size() / 4);
+			for (std::size_t &removedIndex : removedIndexes)
+			{
+				removedIndex = indexDistribution(randomEngine);
+				removedStableIds.insert(particles._stableIds[removedIndex]);
+			}
+		}
+
+		particles.compact(removedIndexes);
+		particles.append(roundIter % 7);
+		CHECK(particles.isConsistent(removedStableIds));
+	}
+
+	// Everything.
+	removedStableIds.insert(std::begin(particles._stableIds), std::end(particles._stableIds));
+	particles.compact(makeIdentity(particles._stableIds.size()));
+	CHECK(particles._stableIds.empty());
+	CHECK(particles.isConsistent(removedStableIds));
+
+	// And we can start over.
+	particles.append(3);
+	CHECK(particles.isConsistent(removedStableIds));
+}
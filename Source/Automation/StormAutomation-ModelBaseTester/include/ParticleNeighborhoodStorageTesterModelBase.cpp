@@ -0,0 +1,466 @@
+#include "Vector3.h"
+
+#include "ParticleNeighborhoodStorage.h"
+
+#include <numeric>
+#include <iostream>
+
+
+namespace
+{
+	constexpr float k_particleSpacing = 1.f;
+	constexpr float k_kernelLength = 2.f;
+	constexpr int k_kernelCellRadius = 2;
+
+	// A fluid block on a lattice, so the neighbors of each particle can be found from the integer offsets around it without any space partition.
+	class FluidBlock
+	{
+	public:
+		FluidBlock(const int edgeParticleCount) :
+			_edgeParticleCount{ edgeParticleCount }
+		{
+			const std::size_t particleCount = static_cast<std::size_t>(edgeParticleCount) * edgeParticleCount * edgeParticleCount;
+			_positions.reserve(particleCount);
+			_velocities.reserve(particleCount);
+
+			for (int xIndex = 0; xIndex < edgeParticleCount; ++xIndex)
+			{
+				for (int yIndex = 0; yIndex < edgeParticleCount; ++yIndex)
+				{
+					for (int zIndex = 0; zIndex < edgeParticleCount; ++zIndex)
+					{
+						_positions.emplace_back(static_cast<float>(xIndex) * k_particleSpacing, static_cast<float>(yIndex) * k_particleSpacing, static_cast<float>(zIndex) * k_particleSpacing);
+						_velocities.emplace_back(static_cast<float>(yIndex % 3), static_cast<float>(zIndex % 5), static_cast<float>(xIndex % 7));
+					}
+				}
+			}
+		}
+
+	public:
+		// Same kind of search than the simulator : the neighbors within the kernel length, with their kernel values.
+		void searchNeighborhood(Storm::ParticleNeighborhoodBuildArray &outNeighborhood, const std::size_t particleIndex) const
+		{
+			this->searchNeighborhoodImpl(outNeighborhood, particleIndex, false);
+		}
+
+		// What fillSymmetric expects : each pair is found only once, by the particle with the lowest index. Like the forward voxels of the space partitions, only the half of the lattice after the particle is visited.
+		void searchForwardNeighborhood(Storm::ParticleNeighborhoodBuildArray &outForwardNeighborhood, const std::size_t particleIndex) const
+		{
+			this->searchNeighborhoodImpl(outForwardNeighborhood, particleIndex, true);
+		}
+
+		Storm::ParticleNeighborhoodStorage::NeighborSources makeNeighborSources(const float kernelLength) const
+		{
+			// The particle system is only used to identify the neighbors, it is never dereferenced by the storage.
+			return Storm::ParticleNeighborhoodStorage::NeighborSources{
+				{ Storm::ParticleNeighborhoodStorage::ReferencedParticleSystem{ nullptr, &_positions, true } },
+				false,
+				Storm::Vector3::Zero(),
+				kernelLength
+			};
+		}
+
+	private:
+		void searchNeighborhoodImpl(Storm::ParticleNeighborhoodBuildArray &outNeighborhood, const std::size_t particleIndex, const bool forwardOnly) const
+		{
+			const int xIndex = static_cast<int>(particleIndex / (static_cast<std::size_t>(_edgeParticleCount) * _edgeParticleCount));
+			const int yIndex = static_cast<int>((particleIndex / _edgeParticleCount) % _edgeParticleCount);
+			const int zIndex = static_cast<int>(particleIndex % _edgeParticleCount);
+
+			const Storm::Vector3 &currentPPosition = _positions[particleIndex];
+
+			// The particle index grows with x, then y, then z. So the forward half starts at the same x, then the same y, then the next z.
+			for (int xNeighbor = forwardOnly ? xIndex : std::max(xIndex - k_kernelCellRadius, 0); xNeighbor <= std::min(xIndex + k_kernelCellRadius, _edgeParticleCount - 1); ++xNeighbor)
+			{
+				for (int yNeighbor = forwardOnly && xNeighbor == xIndex ? yIndex : std::max(yIndex - k_kernelCellRadius, 0); yNeighbor <= std::min(yIndex + k_kernelCellRadius, _edgeParticleCount - 1); ++yNeighbor)
+				{
+					for (int zNeighbor = forwardOnly && xNeighbor == xIndex && yNeighbor == yIndex ? zIndex + 1 : std::max(zIndex - k_kernelCellRadius, 0); zNeighbor <= std::min(zIndex + k_kernelCellRadius, _edgeParticleCount - 1); ++zNeighbor)
+					{
+						const std::size_t neighborIndex = (static_cast<std::size_t>(xNeighbor) * _edgeParticleCount + yNeighbor) * _edgeParticleCount + zNeighbor;
+						if (neighborIndex == particleIndex)
+						{
+							continue;
+						}
+
+						const Storm::Vector3 xij = currentPPosition - _positions[neighborIndex];
+						const float xijSquaredNorm = xij.squaredNorm();
+						if (xijSquaredNorm < k_kernelLength * k_kernelLength)
+						{
+							Storm::NeighborParticleInfo &neighbor = outNeighborhood.emplace_back(nullptr, neighborIndex, xij, xijSquaredNorm, true, true);
+
+							// A cubic falloff is enough to have kernel values that depend on xij like the real kernels.
+							const float falloff = 1.f - neighbor._xijNorm / k_kernelLength;
+							neighbor._Wij = falloff * falloff * falloff;
+							neighbor._gradWij = xij * (-3.f * falloff * falloff / (k_kernelLength * neighbor._xijNorm));
+						}
+					}
+				}
+			}
+		}
+
+	public:
+		int _edgeParticleCount;
+		std::vector<Storm::Vector3> _positions;
+		std::vector<Storm::Vector3> _velocities;
+	};
+
+	// What a solver step does with the neighborhoods : a density, a pressure force and a viscosity force loop, each one iterating once over all neighborhoods.
+	struct StepResult
+	{
+	public:
+		std::vector<float> _densities;
+		std::vector<Storm::Vector3> _pressureForces;
+		std::vector<Storm::Vector3> _viscosityForces;
+	};
+
+	template<class NeighborhoodAccessor>
+	void runStep(const FluidBlock &fluid, const NeighborhoodAccessor &neighborhoodAccessor, StepResult &outResult)
+	{
+		const std::size_t particleCount = fluid._positions.size();
+		outResult._densities.resize(particleCount);
+		outResult._pressureForces.resize(particleCount);
+		outResult._viscosityForces.resize(particleCount);
+
+		Storm::runParallel(outResult._densities, [&neighborhoodAccessor](float &density, const std::size_t particleIndex)
+		{
+			density = 1.f;
+			for (const Storm::NeighborParticleInfo &neighbor : neighborhoodAccessor(particleIndex))
+			{
+				density += neighbor._Wij;
+			}
+		});
+
+		Storm::runParallel(outResult._pressureForces, [&neighborhoodAccessor, &densities = outResult._densities](Storm::Vector3 &pressureForce, const std::size_t particleIndex)
+		{
+			const float currentPPressureCoeff = (densities[particleIndex] - 1.f) / (densities[particleIndex] * densities[particleIndex]);
+
+			pressureForce.setZero();
+			for (const Storm::NeighborParticleInfo &neighbor : neighborhoodAccessor(particleIndex))
+			{
+				const float neighborDensity = densities[neighbor._particleIndex];
+				pressureForce -= (currentPPressureCoeff + (neighborDensity - 1.f) / (neighborDensity * neighborDensity)) * neighbor._gradWij;
+			}
+		});
+
+		Storm::runParallel(outResult._viscosityForces, [&neighborhoodAccessor, &velocities = fluid._velocities](Storm::Vector3 &viscosityForce, const std::size_t particleIndex)
+		{
+			const Storm::Vector3 &currentPVelocity = velocities[particleIndex];
+
+			viscosityForce.setZero();
+			for (const Storm::NeighborParticleInfo &neighbor : neighborhoodAccessor(particleIndex))
+			{
+				const Storm::Vector3 vij = currentPVelocity - velocities[neighbor._particleIndex];
+				viscosityForce += (vij.dot(neighbor._xij) / (neighbor._xijSquaredNorm + 0.01f)) * neighbor._gradWij;
+			}
+		});
+	}
+
+	bool areNear(const float first, const float second)
+	{
+		return std::abs(first - second) <= 0.0001f * std::max(1.f, std::abs(first));
+	}
+
+	bool haveSameStepResult(const StepResult &first, const StepResult &second)
+	{
+		for (std::size_t particleIndex = 0; particleIndex < first._densities.size(); ++particleIndex)
+		{
+			if (!areNear(first._densities[particleIndex], second._densities[particleIndex]))
+			{
+				return false;
+			}
+
+			for (int coord = 0; coord < 3; ++coord)
+			{
+				if (
+					!areNear(first._pressureForces[particleIndex][coord], second._pressureForces[particleIndex][coord]) ||
+					!areNear(first._viscosityForces[particleIndex][coord], second._viscosityForces[particleIndex][coord])
+					)
+				{
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	Storm::ParticleNeighborhoodBuildArray toSortedNeighborhood(const Storm::ParticleNeighborhoodArray &neighborhood)
+	{
+		const Storm::ParticleNeighborhoodBuildArray neighbors{ std::begin(neighborhood), std::end(neighborhood) };
+
+		// Storm::NeighborParticleInfo members are const, so we sort their indexes instead.
+		std::vector<std::size_t> sortedNeighborIndexes(neighbors.size());
+		std::iota(std::begin(sortedNeighborIndexes), std::end(sortedNeighborIndexes), static_cast<std::size_t>(0));
+		std::sort(std::begin(sortedNeighborIndexes), std::end(sortedNeighborIndexes), [&neighbors](const std::size_t first, const std::size_t second)
+		{
+			return neighbors[first]._particleIndex < neighbors[second]._particleIndex;
+		});
+
+		Storm::ParticleNeighborhoodBuildArray result;
+		result.reserve(neighbors.size());
+		for (const std::size_t neighborIndex : sortedNeighborIndexes)
+		{
+			result.emplace_back(neighbors[neighborIndex]);
+		}
+
+		return result;
+	}
+
+	// The order of the neighbors inside a neighborhood isn't the same between fill and fillSymmetric, so we compare the neighbors sorted by index.
+	bool haveSameNeighborhoods(const Storm::ParticleNeighborhoodStorage &first, const Storm::ParticleNeighborhoodStorage &second)
+	{
+		if (first.size() != second.size() || first.getNeighborCount() != second.getNeighborCount())
+		{
+			return false;
+		}
+
+		for (std::size_t particleIndex = 0; particleIndex < first.size(); ++particleIndex)
+		{
+			const Storm::ParticleNeighborhoodBuildArray firstNeighborhood = toSortedNeighborhood(first[particleIndex]);
+			const Storm::ParticleNeighborhoodBuildArray secondNeighborhood = toSortedNeighborhood(second[particleIndex]);
+			if (firstNeighborhood.size() != secondNeighborhood.size())
+			{
+				return false;
+			}
+
+			for (std::size_t neighborIter = 0; neighborIter < firstNeighborhood.size(); ++neighborIter)
+			{
+				const Storm::NeighborParticleInfo &firstNeighbor = firstNeighborhood[neighborIter];
+				const Storm::NeighborParticleInfo &secondNeighbor = secondNeighborhood[neighborIter];
+				if (
+					firstNeighbor._particleIndex != secondNeighbor._particleIndex ||
+					firstNeighbor._containingParticleSystem != secondNeighbor._containingParticleSystem ||
+					firstNeighbor._isFluidParticle != secondNeighbor._isFluidParticle ||
+					firstNeighbor._xij != secondNeighbor._xij ||
+					!areNear(firstNeighbor._Wij, secondNeighbor._Wij)
+					)
+				{
+					return false;
+				}
+
+				for (int coord = 0; coord < 3; ++coord)
+				{
+					if (!areNear(firstNeighbor._gradWij[coord], secondNeighbor._gradWij[coord]))
+					{
+						return false;
+					}
+				}
+			}
+		}
+
+		return true;
+	}
+}
+
+
+TEST_CASE("ParticleNeighborhoodStorage.KernelLengthChange", "[classic]")
+{
+	const FluidBlock fluid{ 10 };
+	const auto searchFunc = [&fluid](Storm::ParticleNeighborhoodBuildArray &outNeighborhood, const std::size_t particleIndex)
+	{
+		fluid.searchNeighborhood(outNeighborhood, particleIndex);
+	};
+
+	Storm::ParticleNeighborhoodStorage storage{ fluid._positions };
+	storage.reset(fluid.makeNeighborSources(k_kernelLength));
+	storage.fill(searchFunc);
+
+	// Nothing changed, the neighborhoods can be kept.
+	storage.resetKeepingPrevious(fluid.makeNeighborSources(k_kernelLength));
+	CHECK(storage.hasPreviousNeighborhoods());
+	storage.fillKeepingPrevious(searchFunc, [](const std::size_t) { return true; });
+
+	// The kept kernel values were computed with the old kernel length, they don't match xij anymore.
+	storage.resetKeepingPrevious(fluid.makeNeighborSources(k_kernelLength * 1.1f));
+	CHECK_FALSE(storage.hasPreviousNeighborhoods());
+}
+
+TEST_CASE("ParticleNeighborhoodStorage.FillSymmetric", "[classic]")
+{
+	// Not a multiple of the block particle count, so the last block is partial.
+	const FluidBlock fluid{ 11 };
+	const auto searchFunc = [&fluid](Storm::ParticleNeighborhoodBuildArray &outNeighborhood, const std::size_t particleIndex)
+	{
+		fluid.searchNeighborhood(outNeighborhood, particleIndex);
+	};
+	const auto symmetricSearchFunc = [&fluid](Storm::ParticleNeighborhoodBuildArray &outForwardNeighborhood, Storm::ParticleNeighborhoodBuildArray &, const std::size_t particleIndex)
+	{
+		fluid.searchForwardNeighborhood(outForwardNeighborhood, particleIndex);
+		return true;
+	};
+
+	Storm::ParticleNeighborhoodStorage expected{ fluid._positions };
+	expected.reset(fluid.makeNeighborSources(k_kernelLength));
+	expected.fill(searchFunc);
+
+	// Wij is shared by both particles of a pair, and gradWij is negated (xji = -xij).
+	Storm::ParticleNeighborhoodStorage symmetric{ fluid._positions };
+	symmetric.reset(fluid.makeNeighborSources(k_kernelLength));
+	symmetric.fillSymmetric(symmetricSearchFunc);
+	CHECK(haveSameNeighborhoods(expected, symmetric));
+
+	// A rebuild reuses the search blocks of the previous one.
+	symmetric.reset(fluid.makeNeighborSources(k_kernelLength));
+	symmetric.fillSymmetric(symmetricSearchFunc);
+	CHECK(haveSameNeighborhoods(expected, symmetric));
+
+	// Nothing moved, so keeping some neighborhoods (the others being searched) should give the same neighborhoods.
+	const auto shouldKeepPrevious = [](const std::size_t particleIndex)
+	{
+		return particleIndex % 3 == 0;
+	};
+
+	Storm::ParticleNeighborhoodStorage expectedKeeping{ fluid._positions };
+	expectedKeeping.reset(fluid.makeNeighborSources(k_kernelLength));
+	expectedKeeping.fill(searchFunc);
+	expectedKeeping.resetKeepingPrevious(fluid.makeNeighborSources(k_kernelLength));
+	expectedKeeping.fillKeepingPrevious(searchFunc, shouldKeepPrevious);
+	CHECK(haveSameNeighborhoods(expected, expectedKeeping));
+
+	symmetric.resetKeepingPrevious(fluid.makeNeighborSources(k_kernelLength));
+	REQUIRE(symmetric.hasPreviousNeighborhoods());
+	symmetric.fillSymmetricKeepingPrevious(symmetricSearchFunc, shouldKeepPrevious);
+	CHECK(haveSameNeighborhoods(expected, symmetric));
+}
+
+// Hidden by default, run it explicitly with the "[benchmark]" tag.
+// Compares the neighborhood storage with the layout it replaced (one array of Storm::NeighborParticleInfo per particle) : the build, then the step loops iterating the neighborhoods.
+TEST_CASE("ParticleNeighborhoodStorage.StepTime.Benchmark", "[.][benchmark]")
+{
+	constexpr std::size_t k_stepCount = 10;
+
+	const FluidBlock fluid{ 64 };
+	const std::size_t particleCount = fluid._positions.size();
+
+	using Clock = std::chrono::high_resolution_clock;
+
+	// The former layout.
+	const auto perParticleArrayBuildStartTime = Clock::now();
+	std::vector<Storm::ParticleNeighborhoodBuildArray> perParticleArrays(particleCount);
+	Storm::runParallel(perParticleArrays, [&fluid](Storm::ParticleNeighborhoodBuildArray &neighborhood, const std::size_t particleIndex)
+	{
+		neighborhood.clear();
+		neighborhood.reserve(64);
+		fluid.searchNeighborhood(neighborhood, particleIndex);
+	});
+	const auto perParticleArrayBuildEndTime = Clock::now();
+
+	StepResult perParticleArrayResult;
+	for (std::size_t stepIndex = 0; stepIndex < k_stepCount; ++stepIndex)
+	{
+		runStep(fluid, [&perParticleArrays](const std::size_t particleIndex) -> const Storm::ParticleNeighborhoodBuildArray&
+		{
+			return perParticleArrays[particleIndex];
+		}, perParticleArrayResult);
+	}
+	const auto perParticleArrayStepEndTime = Clock::now();
+
+	std::size_t perParticleArrayMemory = perParticleArrays.capacity() * sizeof(Storm::ParticleNeighborhoodBuildArray);
+	for (const Storm::ParticleNeighborhoodBuildArray &neighborhood : perParticleArrays)
+	{
+		perParticleArrayMemory += neighborhood.capacity() * sizeof(Storm::NeighborParticleInfo);
+	}
+
+	// The neighborhood storage.
+	Storm::ParticleNeighborhoodStorage storage{ fluid._positions };
+
+	const auto storageBuildStartTime = Clock::now();
+	storage.reset(fluid.makeNeighborSources(k_kernelLength));
+	storage.fill([&fluid](Storm::ParticleNeighborhoodBuildArray &outNeighborhood, const std::size_t particleIndex)
+	{
+		fluid.searchNeighborhood(outNeighborhood, particleIndex);
+	});
+	const auto storageBuildEndTime = Clock::now();
+
+	StepResult storageResult;
+	for (std::size_t stepIndex = 0; stepIndex < k_stepCount; ++stepIndex)
+	{
+		runStep(fluid, [&storage](const std::size_t particleIndex)
+		{
+			return storage[particleIndex];
+		}, storageResult);
+	}
+	const auto storageStepEndTime = Clock::now();
+
+	CHECK(storage.getNeighborCount() == std::accumulate(std::begin(perParticleArrays), std::end(perParticleArrays), static_cast<std::size_t>(0), [](const std::size_t count, const Storm::ParticleNeighborhoodBuildArray &neighborhood)
+	{
+		return count + neighborhood.size();
+	}));
+	CHECK(haveSameStepResult(perParticleArrayResult, storageResult));
+
+	const auto toMs = [](const auto duration)
+	{
+		return std::chrono::duration<double, std::milli>(duration).count();
+	};
+
+	std::cout <<
+		particleCount << " particles, " << storage.getNeighborCount() << " neighbors, " << k_stepCount << " steps\n" <<
+		"Per particle arrays : " << perParticleArrayMemory / (1024 * 1024) << "MB" <<
+		", build " << toMs(perParticleArrayBuildEndTime - perParticleArrayBuildStartTime) << "ms" <<
+		", step " << toMs(perParticleArrayStepEndTime - perParticleArrayBuildEndTime) / static_cast<double>(k_stepCount) << "ms\n" <<
+		"Neighborhood storage : " << storage.computeUsedMemory() / (1024 * 1024) << "MB" <<
+		", build " << toMs(storageBuildEndTime - storageBuildStartTime) << "ms" <<
+		", step " << toMs(storageStepEndTime - storageBuildEndTime) / static_cast<double>(k_stepCount) << "ms\n";
+}
+
+// Hidden by default, run it explicitly with the "[benchmark]" tag.
+// Build time of the neighborhoods with fill (each pair searched and evaluated by both particles) and with fillSymmetric (each pair searched and evaluated once, then scattered).
+TEST_CASE("ParticleNeighborhoodStorage.FillSymmetric.Benchmark", "[.][benchmark]")
+{
+	constexpr std::size_t k_buildCount = 5;
+
+	const FluidBlock fluid{ 64 };
+
+	using Clock = std::chrono::high_resolution_clock;
+
+	Storm::ParticleNeighborhoodStorage storage{ fluid._positions };
+	Storm::ParticleNeighborhoodStorage symmetricStorage{ fluid._positions };
+
+	// Warm up, so the block arrays are already allocated, like in the simulation loop.
+	storage.reset(fluid.makeNeighborSources(k_kernelLength));
+	storage.fill([&fluid](Storm::ParticleNeighborhoodBuildArray &outNeighborhood, const std::size_t particleIndex)
+	{
+		fluid.searchNeighborhood(outNeighborhood, particleIndex);
+	});
+
+	symmetricStorage.reset(fluid.makeNeighborSources(k_kernelLength));
+	symmetricStorage.fillSymmetric([&fluid](Storm::ParticleNeighborhoodBuildArray &outForwardNeighborhood, Storm::ParticleNeighborhoodBuildArray &, const std::size_t particleIndex)
+	{
+		fluid.searchForwardNeighborhood(outForwardNeighborhood, particleIndex);
+		return true;
+	});
+
+	const auto fillStartTime = Clock::now();
+	for (std::size_t buildIter = 0; buildIter < k_buildCount; ++buildIter)
+	{
+		storage.reset(fluid.makeNeighborSources(k_kernelLength));
+		storage.fill([&fluid](Storm::ParticleNeighborhoodBuildArray &outNeighborhood, const std::size_t particleIndex)
+		{
+			fluid.searchNeighborhood(outNeighborhood, particleIndex);
+		});
+	}
+	const auto fillEndTime = Clock::now();
+
+	for (std::size_t buildIter = 0; buildIter < k_buildCount; ++buildIter)
+	{
+		symmetricStorage.reset(fluid.makeNeighborSources(k_kernelLength));
+		symmetricStorage.fillSymmetric([&fluid](Storm::ParticleNeighborhoodBuildArray &outForwardNeighborhood, Storm::ParticleNeighborhoodBuildArray &, const std::size_t particleIndex)
+		{
+			fluid.searchForwardNeighborhood(outForwardNeighborhood, particleIndex);
+			return true;
+		});
+	}
+	const auto fillSymmetricEndTime = Clock::now();
+
+	CHECK(storage.getNeighborCount() == symmetricStorage.getNeighborCount());
+
+	const auto toMs = [](const auto duration)
+	{
+		return std::chrono::duration<double, std::milli>(duration).count();
+	};
+
+	std::cout <<
+		fluid._positions.size() << " particles, " << storage.getNeighborCount() << " neighbors\n" <<
+		"fill " << toMs(fillEndTime - fillStartTime) / static_cast<double>(k_buildCount) << "ms" <<
+		", fillSymmetric " << toMs(fillSymmetricEndTime - fillEndTime) / static_cast<double>(k_buildCount) << "ms\n";
+}
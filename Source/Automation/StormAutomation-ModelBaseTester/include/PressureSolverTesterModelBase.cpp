@@ -0,0 +1,497 @@
+#include "Vector3.h"
+
+#include "DFSPHSolverData.h"
+
+
+namespace
+{
+	// The pressure solves of IISPH, CGSPH and DFSPH (Storm-Simulator) reproduced on a fluid only block, to check that both converge on the same system.
+	// These are copies of the solver math, not the solvers themselves (they need the whole simulator to run), so this says nothing about the solvers speed.
+	// The block is made of particles on a lattice (rest state), moving toward its center so the advected density is compressed.
+	class CompressedFluidBlock
+	{
+	public:
+		struct Neighbor
+		{
+		public:
+			std::size_t _index;
+			Storm::Vector3 _gradWij;
+		};
+
+	public:
+		CompressedFluidBlock(const std::size_t particleCountPerSide, const float deltaTime) :
+			_deltaTime{ deltaTime }
+		{
+			constexpr float k_particleRadius = 0.01f;
+			const float spacing = 2.f * k_particleRadius;
+			_kernelLength = 4.f * k_particleRadius;
+			_particleVolume = spacing * spacing * spacing;
+
+			const float halfExtent = static_cast<float>(particleCountPerSide - 1) * spacing * 0.5f;
+
+			for (std::size_t x = 0; x < particleCountPerSide; ++x)
+			{
+				for (std::size_t y = 0; y < particleCountPerSide; ++y)
+				{
+					for (std::size_t z = 0; z < particleCountPerSide; ++z)
+					{
+						const Storm::Vector3 position{ static_cast<float>(x) * spacing - halfExtent, static_cast<float>(y) * spacing - halfExtent, static_cast<float>(z) * spacing - halfExtent };
+						_positions.emplace_back(position);
+
+						// div(v) = -3 * 3.3, therefore the block is compressed by about 1% each step of 1ms.
+						_velocities.emplace_back(position * -3.3f);
+					}
+				}
+			}
+
+			this->computeNeighborhoods();
+			this->computeDensities();
+		}
+
+	private:
+		float rawKernel(const float norm) const
+		{
+			const float h3 = _kernelLength * _kernelLength * _kernelLength;
+			const float q = norm / _kernelLength;
+			if (q < 0.5f)
+			{
+				return static_cast<float>(8.0 / M_PI) / h3 * (6.f * q * q * (q - 1.f) + 1.f);
+			}
+
+			const float oneMinusQ = 1.f - q;
+			return static_cast<float>(8.0 / M_PI) / h3 * 2.f * oneMinusQ * oneMinusQ * oneMinusQ;
+		}
+
+		Storm::Vector3 gradientKernel(const Storm::Vector3 &xij, const float norm) const
+		{
+			const float h4 = _kernelLength * _kernelLength * _kernelLength * _kernelLength;
+			const float q = norm / _kernelLength;
+			const float factor = q < 0.5f ? q * (3.f * q - 2.f) : -(1.f - q) * (1.f - q);
+			return xij * (static_cast<float>(48.0 / M_PI) / h4 * factor / norm);
+		}
+
+		void computeNeighborhoods()
+		{
+			const std::size_t particleCount = _positions.size();
+
+			_neighborhoods.resize(particleCount);
+			for (std::size_t iter = 0; iter < particleCount; ++iter)
+			{
+				for (std::size_t neighborIter = 0; neighborIter < particleCount; ++neighborIter)
+				{
+					const Storm::Vector3 xij = _positions[iter] - _positions[neighborIter];
+					const float norm = xij.norm();
+					if (neighborIter != iter && norm < _kernelLength)
+					{
+						_neighborhoods[iter].emplace_back(Neighbor{ neighborIter, this->gradientKernel(xij, norm) });
+					}
+				}
+			}
+		}
+
+		void computeDensities()
+		{
+			const std::size_t particleCount = _positions.size();
+
+			// The rest density is the one of the particles inside the block, so only the compression coming from the velocities is solved.
+			std::vector<float> volumeRatios(particleCount);
+			float maxVolumeRatio = 0.f;
+			for (std::size_t iter = 0; iter < particleCount; ++iter)
+			{
+				float volumeRatio = this->rawKernel(0.f);
+				for (const Neighbor &neighbor : _neighborhoods[iter])
+				{
+					volumeRatio += this->rawKernel((_positions[iter] - _positions[neighbor._index]).norm());
+				}
+
+				volumeRatios[iter] = volumeRatio * _particleVolume;
+				maxVolumeRatio = std::max(maxVolumeRatio, volumeRatios[iter]);
+			}
+
+			_density0 = 1000.f;
+			_particleVolume /= maxVolumeRatio;
+
+			_densities.resize(particleCount);
+			for (std::size_t iter = 0; iter < particleCount; ++iter)
+			{
+				_densities[iter] = _density0 * volumeRatios[iter] / maxVolumeRatio;
+			}
+		}
+
+		float computeAdvectedDensity(const std::size_t particleIndex) const
+		{
+			float advectedDensity = 0.f;
+			for (const Neighbor &neighbor : _neighborhoods[particleIndex])
+			{
+				advectedDensity += _particleVolume * (_velocities[particleIndex] - _velocities[neighbor._index]).dot(neighbor._gradWij);
+			}
+
+			return advectedDensity * _deltaTime + _densities[particleIndex] / _density0;
+		}
+
+	public:
+		// Relaxed Jacobi, like IISPHSolver (fluid neighbors only). Returns the iteration count.
+		std::size_t solveIISPH(const std::size_t minIteration, const std::size_t maxIteration, const float maxError, const float relaxationCoefficient, float &outError) const
+		{
+			const std::size_t particleCount = _positions.size();
+			const float deltaTimeSquared = _deltaTime * _deltaTime;
+
+			std::vector<Storm::Vector3> dii(particleCount);
+			std::vector<Storm::Vector3> diiP(particleCount);
+			std::vector<Storm::Vector3> dijPj(particleCount);
+			std::vector<float> aii(particleCount);
+			std::vector<float> advectedDensities(particleCount);
+			std::vector<float> pressures(particleCount, 0.f);
+			std::vector<float> predictedPressures(particleCount);
+
+			for (std::size_t iter = 0; iter < particleCount; ++iter)
+			{
+				const float densityRatio = _densities[iter] / _density0;
+				const float dpiCoeff = _particleVolume / (densityRatio * densityRatio);
+
+				dii[iter].setZero();
+				for (const Neighbor &neighbor : _neighborhoods[iter])
+				{
+					dii[iter] -= dpiCoeff * neighbor._gradWij;
+				}
+
+				aii[iter] = 0.f;
+				for (const Neighbor &neighbor : _neighborhoods[iter])
+				{
+					aii[iter] += _particleVolume * (dii[iter] - dpiCoeff * neighbor._gradWij).dot(neighbor._gradWij);
+				}
+
+				advectedDensities[iter] = this->computeAdvectedDensity(iter);
+				diiP[iter] = dii[iter] * pressures[iter];
+			}
+
+			std::size_t iteration = 0;
+			do
+			{
+				for (std::size_t iter = 0; iter < particleCount; ++iter)
+				{
+					dijPj[iter].setZero();
+					for (const Neighbor &neighbor : _neighborhoods[iter])
+					{
+						const float neighborDensityRatio = _densities[neighbor._index] / _density0;
+						dijPj[iter] -= (_particleVolume / (neighborDensityRatio * neighborDensityRatio) * pressures[neighbor._index]) * neighbor._gradWij;
+					}
+				}
+
+				outError = 0.f;
+				for (std::size_t iter = 0; iter < particleCount; ++iter)
+				{
+					const float densityRatio = _densities[iter] / _density0;
+					const float dpi = pressures[iter] * _particleVolume / (densityRatio * densityRatio);
+
+					float tmpSum = 0.f;
+					for (const Neighbor &neighbor : _neighborhoods[iter])
+					{
+						const Storm::Vector3 sumVectDiv = dijPj[iter] - diiP[neighbor._index] - dijPj[neighbor._index] + dpi * neighbor._gradWij;
+						tmpSum += _particleVolume * sumVectDiv.dot(neighbor._gradWij);
+					}
+
+					const float denom = aii[iter] * deltaTimeSquared;
+					predictedPressures[iter] = 0.f;
+					if (std::fabs(denom) > 0.000000001f)
+					{
+						const float densityAdvectionReverse = 1.f - advectedDensities[iter];
+						const float predictedPressure = relaxationCoefficient * (densityAdvectionReverse - deltaTimeSquared * tmpSum) / denom + pressures[iter] * (1.f - relaxationCoefficient);
+						if (predictedPressure > 0.f)
+						{
+							predictedPressures[iter] = predictedPressure;
+							outError += _density0 * ((aii[iter] * predictedPressure + tmpSum) * deltaTimeSquared - densityAdvectionReverse);
+						}
+					}
+				}
+
+				outError /= static_cast<float>(particleCount);
+
+				for (std::size_t iter = 0; iter < particleCount; ++iter)
+				{
+					pressures[iter] = predictedPressures[iter];
+					diiP[iter] = dii[iter] * pressures[iter];
+				}
+
+				++iteration;
+			} while (iteration < minIteration || (iteration < maxIteration && outError > maxError));
+
+			return iteration;
+		}
+
+		// Jacobi preconditioned conjugate gradient on the stiffness, like CGSPHSolver. Returns the iteration count.
+		std::size_t solveCGSPH(const std::size_t minIteration, const std::size_t maxIteration, const float maxError, float &outError) const
+		{
+			const std::size_t particleCount = _positions.size();
+			const float deltaTimeSquared = _deltaTime * _deltaTime;
+
+			std::vector<Storm::Vector3> sumGradWij(particleCount);
+			std::vector<float> invDiagonal(particleCount);
+			std::vector<float> stiffness(particleCount, 0.f);
+			std::vector<float> residual(particleCount);
+			std::vector<float> preconditionedResidual(particleCount);
+			std::vector<float> searchDirection(particleCount, 0.f);
+			std::vector<Storm::Vector3> searchDirectionGradient(particleCount);
+			std::vector<float> operatorResult(particleCount);
+
+			for (std::size_t iter = 0; iter < particleCount; ++iter)
+			{
+				float sumSquaredGradWij = 0.f;
+				sumGradWij[iter].setZero();
+				for (const Neighbor &neighbor : _neighborhoods[iter])
+				{
+					sumGradWij[iter] += _particleVolume * neighbor._gradWij;
+					sumSquaredGradWij += _particleVolume * _particleVolume * neighbor._gradWij.squaredNorm();
+				}
+
+				const float diagonal = deltaTimeSquared * (sumGradWij[iter].squaredNorm() + sumSquaredGradWij);
+				invDiagonal[iter] = diagonal > 0.000000001f ? 1.f / diagonal : 0.f;
+			}
+
+			const auto applyPressureOperator = [&]()
+			{
+				for (std::size_t iter = 0; iter < particleCount; ++iter)
+				{
+					searchDirectionGradient[iter] = searchDirection[iter] * sumGradWij[iter];
+					for (const Neighbor &neighbor : _neighborhoods[iter])
+					{
+						searchDirectionGradient[iter] += (_particleVolume * searchDirection[neighbor._index]) * neighbor._gradWij;
+					}
+				}
+
+				float directionDotOperatorResult = 0.f;
+				for (std::size_t iter = 0; iter < particleCount; ++iter)
+				{
+					float divergence = searchDirectionGradient[iter].dot(sumGradWij[iter]);
+					for (const Neighbor &neighbor : _neighborhoods[iter])
+					{
+						divergence -= _particleVolume * searchDirectionGradient[neighbor._index].dot(neighbor._gradWij);
+					}
+
+					operatorResult[iter] = deltaTimeSquared * divergence;
+					directionDotOperatorResult += searchDirection[iter] * operatorResult[iter];
+				}
+
+				return directionDotOperatorResult;
+			};
+
+			applyPressureOperator();
+
+			float residualDotPreconditioned = 0.f;
+			for (std::size_t iter = 0; iter < particleCount; ++iter)
+			{
+				residual[iter] = std::max(this->computeAdvectedDensity(iter) - 1.f, 0.f) - operatorResult[iter];
+				preconditionedResidual[iter] = invDiagonal[iter] * residual[iter];
+				searchDirection[iter] = preconditionedResidual[iter];
+				residualDotPreconditioned += residual[iter] * preconditionedResidual[iter];
+			}
+
+			std::size_t iteration = 0;
+			do
+			{
+				const float directionDotOperatorResult = applyPressureOperator();
+				const float alpha = directionDotOperatorResult > 0.000000001f ? residualDotPreconditioned / directionDotOperatorResult : 0.f;
+
+				float newResidualDotPreconditioned = 0.f;
+				for (std::size_t iter = 0; iter < particleCount; ++iter)
+				{
+					stiffness[iter] += alpha * searchDirection[iter];
+					residual[iter] -= alpha * operatorResult[iter];
+					preconditionedResidual[iter] = invDiagonal[iter] * residual[iter];
+					newResidualDotPreconditioned += residual[iter] * preconditionedResidual[iter];
+				}
+
+				const float beta = residualDotPreconditioned > 0.000000001f ? newResidualDotPreconditioned / residualDotPreconditioned : 0.f;
+				residualDotPreconditioned = newResidualDotPreconditioned;
+
+				outError = 0.f;
+				for (std::size_t iter = 0; iter < particleCount; ++iter)
+				{
+					searchDirection[iter] = preconditionedResidual[iter] + beta * searchDirection[iter];
+					outError += _density0 * std::fabs(residual[iter]);
+				}
+
+				outError /= static_cast<float>(particleCount);
+
+				++iteration;
+			} while (iteration < minIteration || (iteration < maxIteration && outError > maxError));
+
+			return iteration;
+		}
+
+		// Jacobi on the stiffness, like DFSPHSolver::pressureSolve (fluid neighbors only). Returns the iteration count.
+		// inOutStiffness is time step independent, like Storm::DFSPHSolverData::_densityStiffness : the solve starts from it when warmStart is true (0 otherwise), and it receives the stiffness the solve ended with.
+		std::size_t solveDFSPH(const std::size_t minIteration, const std::size_t maxIteration, const float maxError, const bool warmStart, std::vector<float> &inOutStiffness, float &outError) const
+		{
+			const std::size_t particleCount = _positions.size();
+			const float deltaTimeSquared = _deltaTime * _deltaTime;
+			const float invDeltaTimeSquared = 1.f / deltaTimeSquared;
+
+			std::vector<Storm::Vector3> velocities = _velocities;
+			std::vector<float> kCoeffs(particleCount);
+			std::vector<float> densityAdvs(particleCount);
+			std::vector<float> stiffnesses(particleCount);
+
+			for (std::size_t iter = 0; iter < particleCount; ++iter)
+			{
+				Storm::Vector3 sumGradPk = Storm::Vector3::Zero();
+				float sumSquaredGradPk = 0.f;
+				for (const Neighbor &neighbor : _neighborhoods[iter])
+				{
+					const Storm::Vector3 gradPk = _particleVolume * neighbor._gradWij;
+					sumGradPk += gradPk;
+					sumSquaredGradPk += gradPk.squaredNorm();
+				}
+
+				const float sumGradPkSquared = sumGradPk.squaredNorm() + sumSquaredGradPk;
+				kCoeffs[iter] = sumGradPkSquared > 0.000000001f ? -invDeltaTimeSquared / sumGradPkSquared : 0.f;
+			}
+
+			// Adds dt * sum(Vj * (ki + kj) * gradWij) to the velocities.
+			const auto applyStiffnesses = [&]()
+			{
+				for (std::size_t iter = 0; iter < particleCount; ++iter)
+				{
+					for (const Neighbor &neighbor : _neighborhoods[iter])
+					{
+						velocities[iter] += (_deltaTime * _particleVolume * (stiffnesses[iter] + stiffnesses[neighbor._index])) * neighbor._gradWij;
+					}
+				}
+			};
+
+			const auto computeDensityAdvs = [&]()
+			{
+				outError = 0.f;
+				for (std::size_t iter = 0; iter < particleCount; ++iter)
+				{
+					float densityChange = 0.f;
+					for (const Neighbor &neighbor : _neighborhoods[iter])
+					{
+						densityChange += _particleVolume * (velocities[iter] - velocities[neighbor._index]).dot(neighbor._gradWij);
+					}
+
+					densityAdvs[iter] = std::max(_densities[iter] / _density0 + _deltaTime * densityChange, 1.f);
+					outError += _density0 * densityAdvs[iter] - _density0;
+				}
+
+				outError /= static_cast<float>(particleCount);
+			};
+
+			if (warmStart)
+			{
+				for (std::size_t iter = 0; iter < particleCount; ++iter)
+				{
+					stiffnesses[iter] = Storm::DFSPHSolverData::computeWarmStartStiffness(inOutStiffness[iter], invDeltaTimeSquared);
+				}
+
+				applyStiffnesses();
+			}
+			else
+			{
+				inOutStiffness.assign(particleCount, 0.f);
+			}
+
+			// From now on, the stiffness added by each iteration is accumulated separately from the one applied.
+			for (std::size_t iter = 0; iter < particleCount; ++iter)
+			{
+				inOutStiffness[iter] = stiffnesses[iter];
+			}
+
+			computeDensityAdvs();
+
+			std::size_t iteration = 0;
+			do
+			{
+				for (std::size_t iter = 0; iter < particleCount; ++iter)
+				{
+					stiffnesses[iter] = (densityAdvs[iter] - 1.f) * kCoeffs[iter];
+					inOutStiffness[iter] += stiffnesses[iter];
+				}
+
+				applyStiffnesses();
+				computeDensityAdvs();
+
+				++iteration;
+			} while (iteration < minIteration || (iteration < maxIteration && outError > maxError));
+
+			for (float &stiffness : inOutStiffness)
+			{
+				stiffness *= deltaTimeSquared;
+			}
+
+			return iteration;
+		}
+
+		std::size_t getParticleCount() const
+		{
+			return _positions.size();
+		}
+
+	private:
+		float _deltaTime;
+		float _kernelLength;
+		float _particleVolume;
+		float _density0;
+
+		std::vector<Storm::Vector3> _positions;
+		std::vector<Storm::Vector3> _velocities;
+		std::vector<float> _densities;
+		std::vector<std::vector<Neighbor>> _neighborhoods;
+	};
+}
+
+
+TEST_CASE("PressureSolver.IISPHAndCGSPH.Convergence", "[classic]")
+{
+	// Same defaults than SceneFluidCustomIISPHConfig, SceneFluidCustomCGSPHConfig and SceneFluidConfig.
+	constexpr std::size_t k_minIteration = 2;
+	constexpr std::size_t k_maxIteration = 150;
+	constexpr float k_relaxationCoefficient = 0.5f;
+
+	const CompressedFluidBlock block{ 12, 0.001f };
+
+	for (const float maxError : { 0.1f, 0.01f })
+	{
+		float iisphError;
+		const std::size_t iisphIteration = block.solveIISPH(k_minIteration, k_maxIteration, maxError, k_relaxationCoefficient, iisphError);
+
+		float cgsphError;
+		const std::size_t cgsphIteration = block.solveCGSPH(k_minIteration, k_maxIteration, maxError, cgsphError);
+
+		CAPTURE(maxError, iisphIteration, iisphError, cgsphIteration, cgsphError);
+		CHECK(iisphIteration < k_maxIteration);
+		CHECK(iisphError <= maxError);
+		CHECK(cgsphIteration < k_maxIteration);
+		CHECK(cgsphError <= maxError);
+	}
+}
+
+TEST_CASE("PressureSolver.DFSPH.WarmStart", "[classic]")
+{
+	// Same defaults than SceneFluidCustomDFSPHConfig.
+	constexpr std::size_t k_minIteration = 2;
+	constexpr std::size_t k_maxIteration = 100;
+
+	const CompressedFluidBlock block{ 12, 0.001f };
+
+	for (const float maxError : { 0.1f, 0.01f })
+	{
+		// The previous step, solved from scratch. It leaves the stiffness the next step is warm started with.
+		std::vector<float> stiffnesses;
+		float previousError;
+		block.solveDFSPH(k_minIteration, k_maxIteration, maxError, false, stiffnesses, previousError);
+
+		// The next step is the same system (a steady flow), where the previous stiffness is the best guess.
+		std::vector<float> coldStiffnesses;
+		float coldError;
+		const std::size_t coldIteration = block.solveDFSPH(k_minIteration, k_maxIteration, maxError, false, coldStiffnesses, coldError);
+
+		float warmError;
+		const std::size_t warmIteration = block.solveDFSPH(k_minIteration, k_maxIteration, maxError, true, stiffnesses, warmError);
+
+		CAPTURE(maxError, coldIteration, coldError, warmIteration, warmError);
+		CHECK(coldError <= maxError);
+		CHECK(warmError <= maxError);
+		CHECK(warmIteration <= coldIteration);
+	}
+}
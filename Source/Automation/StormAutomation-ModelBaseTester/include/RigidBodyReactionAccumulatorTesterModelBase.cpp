@@ -0,0 +1,239 @@
+#include "Vector3.h"
+
+#include "RigidBodyReactionAccumulator.h"
+#include "ParallelWorkerPool.h"
+
+#include <random>
+#include <iostream>
+
+
+namespace
+{
+	constexpr std::size_t k_rigidBodyNeighborCount = 8;
+
+	// Fluid particles touching the particles of a rigid body, like the fluid particles near its surface.
+	// Each fluid particle pushes on its rigid body neighbors and receives the opposite force (3rd Newton law), as the solvers do.
+	class FluidOnRigidBody
+	{
+	public:
+		FluidOnRigidBody(const std::size_t fluidParticleCount, const std::size_t rigidBodyParticleCount) :
+			_rigidBodyNeighbors(fluidParticleCount * k_rigidBodyNeighborCount),
+			_fluidVelocities(fluidParticleCount),
+			_rigidBodyVelocities(rigidBodyParticleCount)
+		{
+			std::mt19937 randomEngine{ 42 };
+			std::uniform_int_distribution<std::size_t> rigidBodyParticleOffsetDistribution{ 0, 15 };
+			std::uniform_real_distribution<float> velocityDistribution{ -1.f, 1.f };
+
+			// The particles are sorted spatially, so consecutive fluid particles touch the same area of the rigid body.
+			for (std::size_t fluidParticleIndex = 0; fluidParticleIndex < fluidParticleCount; ++fluidParticleIndex)
+			{
+				const std::size_t nearestRigidBodyParticleIndex = fluidParticleIndex * rigidBodyParticleCount / fluidParticleCount;
+				for (std::size_t neighborIter = 0; neighborIter < k_rigidBodyNeighborCount; ++neighborIter)
+				{
+					_rigidBodyNeighbors[fluidParticleIndex * k_rigidBodyNeighborCount + neighborIter] = (nearestRigidBodyParticleIndex + rigidBodyParticleOffsetDistribution(randomEngine)) % rigidBodyParticleCount;
+				}
+			}
+
+			for (std::vector<Storm::Vector3>* velocities : { &_fluidVelocities, &_rigidBodyVelocities })
+			{
+				for (Storm::Vector3 &velocity : *velocities)
+				{
+					velocity = Storm::Vector3{ velocityDistribution(randomEngine), velocityDistribution(randomEngine), velocityDistribution(randomEngine) };
+				}
+			}
+		}
+
+	public:
+		// recordReaction(rigidBodyParticleIndex, pressureComponent, viscosityComponent) mirrors the forces on the rigid body particle.
+		template<class RecordReactionFunc>
+		Storm::Vector3 computeForce(const std::size_t fluidParticleIndex, const RecordReactionFunc &recordReaction) const
+		{
+			const Storm::Vector3 &vi = _fluidVelocities[fluidParticleIndex];
+
+			Storm::Vector3 totalForce = Storm::Vector3::Zero();
+			for (std::size_t neighborIter = 0; neighborIter < k_rigidBodyNeighborCount; ++neighborIter)
+			{
+				const std::size_t rigidBodyParticleIndex = _rigidBodyNeighbors[fluidParticleIndex * k_rigidBodyNeighborCount + neighborIter];
+				const Storm::Vector3 vij = vi - _rigidBodyVelocities[rigidBodyParticleIndex];
+
+				const Storm::Vector3 pressureComponent = vi.cross(vij) * 0.5f;
+				const Storm::Vector3 viscosityComponent = vij * (0.01f * vij.squaredNorm());
+
+				totalForce += pressureComponent + viscosityComponent;
+				recordReaction(rigidBodyParticleIndex, pressureComponent, viscosityComponent);
+			}
+
+			return totalForce;
+		}
+
+		std::size_t getFluidParticleCount() const
+		{
+			return _fluidVelocities.size();
+		}
+
+		std::size_t getRigidBodyParticleCount() const
+		{
+			return _rigidBodyVelocities.size();
+		}
+
+	private:
+		std::vector<std::size_t> _rigidBodyNeighbors;
+		std::vector<Storm::Vector3> _fluidVelocities;
+		std::vector<Storm::Vector3> _rigidBodyVelocities;
+	};
+
+	struct SolverForces
+	{
+	public:
+		SolverForces(const FluidOnRigidBody &scene) :
+			_fluidForces(scene.getFluidParticleCount(), Storm::Vector3::Zero()),
+			_rigidBodyForces(scene.getRigidBodyParticleCount(), Storm::Vector3::Zero()),
+			_rigidBodyPressureForces(scene.getRigidBodyParticleCount(), Storm::Vector3::Zero()),
+			_rigidBodyViscosityForces(scene.getRigidBodyParticleCount(), Storm::Vector3::Zero())
+		{}
+
+	public:
+		std::vector<Storm::Vector3> _fluidForces;
+		std::vector<Storm::Vector3> _rigidBodyForces;
+		std::vector<Storm::Vector3> _rigidBodyPressureForces;
+		std::vector<Storm::Vector3> _rigidBodyViscosityForces;
+	};
+
+	// What the solvers did before the accumulator : take the rigid body particle system mutex for each reaction.
+	void computeWithLock(const FluidOnRigidBody &scene, SolverForces &inOutForces, std::mutex &rigidBodyMutex)
+	{
+		Storm::runParallel(inOutForces._fluidForces, [&scene, &inOutForces, &rigidBodyMutex](Storm::Vector3 &currentPForce, const std::size_t currentPIndex)
+		{
+			currentPForce = scene.computeForce(currentPIndex, [&inOutForces, &rigidBodyMutex](const std::size_t rigidBodyParticleIndex, const Storm::Vector3 &pressureComponent, const Storm::Vector3 &viscosityComponent)
+			{
+				std::lock_guard<std::mutex> lock{ rigidBodyMutex };
+				inOutForces._rigidBodyForces[rigidBodyParticleIndex] -= pressureComponent + viscosityComponent;
+				inOutForces._rigidBodyPressureForces[rigidBodyParticleIndex] -= pressureComponent;
+				inOutForces._rigidBodyViscosityForces[rigidBodyParticleIndex] -= viscosityComponent;
+			});
+		});
+	}
+
+	void computeWithAccumulator(const FluidOnRigidBody &scene, SolverForces &inOutForces, Storm::RigidBodyReactionAccumulator &accumulator)
+	{
+		accumulator.runParallel(inOutForces._fluidForces, [&scene, &inOutForces](Storm::Vector3 &currentPForce, const std::size_t currentPIndex, Storm::RigidBodyReactionAccumulator::Chunk &rbReactions)
+		{
+			currentPForce = scene.computeForce(currentPIndex, [&inOutForces, &rbReactions](const std::size_t rigidBodyParticleIndex, const Storm::Vector3 &pressureComponent, const Storm::Vector3 &viscosityComponent)
+			{
+				rbReactions.subtract(inOutForces._rigidBodyForces[rigidBodyParticleIndex], pressureComponent + viscosityComponent);
+				rbReactions.subtract(inOutForces._rigidBodyPressureForces[rigidBodyParticleIndex], pressureComponent);
+				rbReactions.subtract(inOutForces._rigidBodyViscosityForces[rigidBodyParticleIndex], viscosityComponent);
+			});
+		});
+	}
+
+	bool areNear(const std::vector<Storm::Vector3> &first, const std::vector<Storm::Vector3> &second)
+	{
+		for (std::size_t index = 0; index < first.size(); ++index)
+		{
+			if ((first[index] - second[index]).norm() > 0.0001f * std::max(1.f, first[index].norm()))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// Registers the executor for runParallel and co while in scope.
+	class ParallelExecutorRegistration
+	{
+	public:
+		ParallelExecutorRegistration(Storm::IParallelExecutor &executor)
+		{
+			Storm::setParallelExecutor(&executor);
+		}
+
+		~ParallelExecutorRegistration()
+		{
+			Storm::setParallelExecutor(nullptr);
+		}
+	};
+}
+
+
+TEST_CASE("RigidBodyReactionAccumulator.Deterministic", "[classic]")
+{
+	const FluidOnRigidBody scene{ 20000, 500 };
+
+	// Sequential reference.
+	SolverForces expected{ scene };
+	for (std::size_t fluidParticleIndex = 0; fluidParticleIndex < scene.getFluidParticleCount(); ++fluidParticleIndex)
+	{
+		expected._fluidForces[fluidParticleIndex] = scene.computeForce(fluidParticleIndex, [&expected](const std::size_t rigidBodyParticleIndex, const Storm::Vector3 &pressureComponent, const Storm::Vector3 &viscosityComponent)
+		{
+			expected._rigidBodyForces[rigidBodyParticleIndex] -= pressureComponent + viscosityComponent;
+			expected._rigidBodyPressureForces[rigidBodyParticleIndex] -= pressureComponent;
+			expected._rigidBodyViscosityForces[rigidBodyParticleIndex] -= viscosityComponent;
+		});
+	}
+
+	// The reactions are summed in the same order whatever the thread count, so the results should be exactly the same.
+	std::vector<SolverForces> results;
+	for (const std::size_t workerCount : { 0, 1, 3, 7 })
+	{
+		Storm::ParallelWorkerPool pool{ workerCount, false, 0 };
+		const ParallelExecutorRegistration registration{ pool };
+
+		Storm::RigidBodyReactionAccumulator accumulator;
+		computeWithAccumulator(scene, results.emplace_back(scene), accumulator);
+	}
+
+	for (const SolverForces &result : results)
+	{
+		CHECK(result._fluidForces == results.front()._fluidForces);
+		CHECK(result._rigidBodyForces == results.front()._rigidBodyForces);
+		CHECK(result._rigidBodyPressureForces == results.front()._rigidBodyPressureForces);
+		CHECK(result._rigidBodyViscosityForces == results.front()._rigidBodyViscosityForces);
+	}
+
+	CHECK(results.front()._fluidForces == expected._fluidForces);
+	CHECK(areNear(results.front()._rigidBodyForces, expected._rigidBodyForces));
+	CHECK(areNear(results.front()._rigidBodyPressureForces, expected._rigidBodyPressureForces));
+	CHECK(areNear(results.front()._rigidBodyViscosityForces, expected._rigidBodyViscosityForces));
+}
+
+// Hidden by default, run it explicitly with the "[benchmark]" tag.
+// Cost of the reaction loop on one thread, with the rigid body mutex the solvers used to take (uncontended here) and with the accumulator.
+TEST_CASE("RigidBodyReactionAccumulator.SingleThread.Benchmark", "[.][benchmark]")
+{
+	constexpr std::size_t k_loopCount = 10;
+
+	const FluidOnRigidBody scene{ 200000, 5000 };
+
+	// Only the calling thread runs the loops.
+	Storm::ParallelWorkerPool pool{ 0, false, 0 };
+	const ParallelExecutorRegistration registration{ pool };
+
+	SolverForces lockForces{ scene };
+	std::mutex rigidBodyMutex;
+
+	const auto lockStartTime = std::chrono::high_resolution_clock::now();
+	for (std::size_t loopIter = 0; loopIter < k_loopCount; ++loopIter)
+	{
+		computeWithLock(scene, lockForces, rigidBodyMutex);
+	}
+	const auto lockEndTime = std::chrono::high_resolution_clock::now();
+
+	SolverForces accumulatorForces{ scene };
+	Storm::RigidBodyReactionAccumulator accumulator;
+
+	for (std::size_t loopIter = 0; loopIter < k_loopCount; ++loopIter)
+	{
+		computeWithAccumulator(scene, accumulatorForces, accumulator);
+	}
+	const auto accumulatorEndTime = std::chrono::high_resolution_clock::now();
+
+	// Both sum the same reactions, only the order differs.
+	CHECK(areNear(lockForces._rigidBodyForces, accumulatorForces._rigidBodyForces));
+
+	std::cout <<
+		"Mutex " << std::chrono::duration<double, std::milli>(lockEndTime - lockStartTime).count() / static_cast<double>(k_loopCount) << "ms" <<
+		", accumulator " << std::chrono::duration<double, std::milli>(accumulatorEndTime - lockEndTime).count() / static_cast<double>(k_loopCount) << "ms\n";
+}
@@ -0,0 +1,112 @@
+#include "Vector3.h"
+
+#include "RigidBodyTransform.h"
+
+#include <random>
+
+
+namespace
+{
+	std::vector<Storm::Vector3> makeRandomVects(const std::size_t count, std::mt19937 &randomEngine)
+	{
+		std::uniform_real_distribution<float> coordDistribution{ -10.f, 10.f };
+
+		std::vector<Storm::Vector3> result(count);
+		for (Storm::Vector3 &vect : result)
+		{
+			vect = Storm::Vector3{ coordDistribution(randomEngine), coordDistribution(randomEngine), coordDistribution(randomEngine) };
+		}
+
+		return result;
+	}
+
+	Storm::RigidBodyTransform makeTransform()
+	{
+		const Storm::Vector3 axis = Storm::Vector3{ 0.3f, -1.f, 0.7f }.normalized();
+		return Storm::RigidBodyTransform{ Storm::Quaternion{ Eigen::AngleAxisf{ 1.2f, axis } }, Storm::Vector3{ 4.f, -2.5f, 12.f } };
+	}
+
+	bool isClose(const Storm::Vector3 &value, const Storm::Vector3 &expected)
+	{
+		return (value - expected).norm() <= 1e-5f * std::max(1.f, expected.norm());
+	}
+}
+
+
+TEST_CASE("RigidBodyTransform.Batched", "[classic]")
+{
+	const Storm::RigidBodyTransform transform = makeTransform();
+	std::mt19937 randomEngine{ 42 };
+
+	// Counts around the 4 lanes, so the scalar tail is covered with 0 to 3 particles.
+	for (const std::size_t count : { 1, 3, 4, 5, 7, 8, 9, 17 })
+	{
+		const std::vector<Storm::Vector3> localVects = makeRandomVects(count, randomEngine);
+
+		// One more item than transformed, to check that we don't write past the end.
+		const Storm::Vector3 sentinel{ 123.f, 456.f, 789.f };
+		std::vector<Storm::Vector3> positions(count + 1, sentinel);
+		std::vector<Storm::Vector3> directions(count + 1, sentinel);
+
+		transform.transformPositions(localVects.data(), positions.data(), count);
+		transform.transformDirections(localVects.data(), directions.data(), count);
+
+		for (std::size_t iter = 0; iter < count; ++iter)
+		{
+			CAPTURE(count, iter);
+			CHECK(isClose(positions[iter], transform.transformPosition(localVects[iter])));
+			CHECK(isClose(directions[iter], transform.transformDirection(localVects[iter])));
+		}
+
+		CHECK(positions[count] == sentinel);
+		CHECK(directions[count] == sentinel);
+	}
+}
+
+// Hidden by default, run it explicitly with the "[benchmark]" tag.
+// Transform time of the particles one by one (what the rigid body update did before) and batched.
+TEST_CASE("RigidBodyTransform.Batched.Benchmark", "[.][benchmark]")
+{
+	constexpr std::size_t k_particleCount = 1 << 20;
+	constexpr std::size_t k_runCount = 20;
+
+	const Storm::RigidBodyTransform transform = makeTransform();
+	std::mt19937 randomEngine{ 42 };
+
+	const std::vector<Storm::Vector3> localPositions = makeRandomVects(k_particleCount, randomEngine);
+	std::vector<Storm::Vector3> scalarPositions(k_particleCount);
+	std::vector<Storm::Vector3> batchedPositions(k_particleCount);
+
+	using Clock = std::chrono::high_resolution_clock;
+
+	const auto scalarStartTime = Clock::now();
+	for (std::size_t runIndex = 0; runIndex < k_runCount; ++runIndex)
+	{
+		for (std::size_t iter = 0; iter < k_particleCount; ++iter)
+		{
+			scalarPositions[iter] = transform.transformPosition(localPositions[iter]);
+		}
+	}
+	const auto scalarEndTime = Clock::now();
+
+	for (std::size_t runIndex = 0; runIndex < k_runCount; ++runIndex)
+	{
+		transform.transformPositions(localPositions.data(), batchedPositions.data(), k_particleCount);
+	}
+	const auto batchedEndTime = Clock::now();
+
+	for (std::size_t iter = 0; iter < k_particleCount; ++iter)
+	{
+		REQUIRE(isClose(batchedPositions[iter], scalarPositions[iter]));
+	}
+
+	const auto toMs = [](const auto duration)
+	{
+		return std::chrono::duration<double, std::milli>(duration).count();
+	};
+
+	std::cout <<
+		k_particleCount << " particles\n" <<
+		"One by one : " << toMs(scalarEndTime - scalarStartTime) / static_cast<double>(k_runCount) << "ms\n" <<
+		"Batched : " << toMs(batchedEndTime - scalarEndTime) / static_cast<double>(k_runCount) << "ms\n";
+}
@@ -0,0 +1,120 @@
+#include "Vector3.h"
+
+#include "RunnerHelper.h"
+
+
+TEST_CASE("RunnerHelper.reduceChunkedParallel", "[classic]")
+{
+	std::vector<float> values(10000);
+	float expectedSum = 0.f;
+	for (std::size_t iter = 0; iter < values.size(); ++iter)
+	{
+		values[iter] = static_cast<float>(iter % 7);
+		expectedSum += values[iter];
+	}
+
+	const Storm::ParallelReduceResult result = Storm::reduceChunkedParallel(values, [](const float value, const std::size_t index, Storm::ParallelReduceResult &chunkResult)
+	{
+		chunkResult._sum += value;
+		chunkResult._max = std::max(chunkResult._max, value);
+		if (index == 7777)
+		{
+			chunkResult._flag = true;
+		}
+	});
+
+	CHECK(result._sum == expectedSum);
+	CHECK(result._max == 6.f);
+	CHECK(result._flag);
+}
+
+TEST_CASE("RunnerHelper.reduceChunkedParallel.Empty", "[classic]")
+{
+	std::vector<float> values;
+	bool called = false;
+
+	const Storm::ParallelReduceResult result = Storm::reduceChunkedParallel(values, [&called](const float, const std::size_t, Storm::ParallelReduceResult &)
+	{
+		called = true;
+	});
+
+	CHECK_FALSE(called);
+	CHECK(result._sum == 0.f);
+	CHECK(result._max == 0.f);
+	CHECK_FALSE(result._flag);
+}
+
+TEST_CASE("RunnerHelper.reduceChunkedParallel.Deterministic", "[classic]")
+{
+	std::vector<float> values(100000);
+	for (std::size_t iter = 0; iter < values.size(); ++iter)
+	{
+		values[iter] = 1.f / static_cast<float>(iter + 1);
+	}
+
+	const auto sumFunc = [](const float value, const std::size_t, Storm::ParallelReduceResult &chunkResult)
+	{
+		chunkResult._sum += value;
+	};
+
+	// Float addition isn't associative, so this would fail sooner or later if the summation order depended on the scheduling.
+	const float firstSum = Storm::reduceChunkedParallel(values, sumFunc)._sum;
+	for (int iter = 0; iter < 20; ++iter)
+	{
+		REQUIRE(Storm::reduceChunkedParallel(values, sumFunc)._sum == firstSum);
+	}
+}
+
+TEST_CASE("RunnerHelper.reduceChunkedParallel.CustomResult", "[classic]")
+{
+	// What Storm::RigidBodyParticleSystem::computeWrench reduces : the total force and the total torque F x p (p relative to the world origin), accumulated around the rigid body center.
+	struct Wrench
+	{
+	public:
+		void merge(const Wrench &other)
+		{
+			_force += other._force;
+			_torque += other._torque;
+		}
+
+	public:
+		Storm::Vector3 _force = Storm::Vector3::Zero();
+		Storm::Vector3 _torque = Storm::Vector3::Zero();
+	};
+
+	const Storm::Vector3 center{ 100.f, -50.f, 20.f };
+
+	std::vector<Storm::Vector3> positions(5000);
+	std::vector<Storm::Vector3> forces(positions.size());
+
+	Eigen::Vector3d expectedForce = Eigen::Vector3d::Zero();
+	Eigen::Vector3d expectedTorque = Eigen::Vector3d::Zero();
+	for (std::size_t iter = 0; iter < positions.size(); ++iter)
+	{
+		const float iterFl = static_cast<float>(iter);
+		positions[iter] = center + Storm::Vector3{ std::sin(iterFl), std::cos(iterFl * 0.7f), std::sin(iterFl * 1.3f) };
+		forces[iter] = Storm::Vector3{ std::cos(iterFl * 0.3f), 0.5f, std::sin(iterFl * 0.11f) };
+
+		expectedForce += forces[iter].cast<double>();
+		expectedTorque += forces[iter].cast<double>().cross(positions[iter].cast<double>());
+	}
+
+	const auto wrenchFunc = [&forces, &center](const Storm::Vector3 &position, const std::size_t index, Wrench &chunkWrench)
+	{
+		chunkWrench._force += forces[index];
+		chunkWrench._torque += forces[index].cross(position - center);
+	};
+
+	const Wrench result = Storm::reduceChunkedParallel<256, Wrench>(positions, wrenchFunc);
+	const Storm::Vector3 torque = result._torque + result._force.cross(center);
+
+	CHECK((result._force.cast<double>() - expectedForce).norm() < 1e-3 * expectedForce.norm());
+	CHECK((torque.cast<double>() - expectedTorque).norm() < 1e-3 * expectedTorque.norm());
+
+	for (int iter = 0; iter < 10; ++iter)
+	{
+		const Wrench otherResult = Storm::reduceChunkedParallel<256, Wrench>(positions, wrenchFunc);
+		REQUIRE(otherResult._force == result._force);
+		REQUIRE(otherResult._torque == result._torque);
+	}
+}
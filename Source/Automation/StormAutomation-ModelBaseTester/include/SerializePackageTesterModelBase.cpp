@@ -0,0 +1,230 @@
+#include "Vector3.h"
+
+#include "SerializePackage.h"
+#include "SerializePackageCreationModality.h"
+
+#include <iostream>
+
+
+namespace
+{
+	// Mimics the per particle arrays a record frame holds for each particle system.
+	struct RecordLikeFrame
+	{
+	public:
+		RecordLikeFrame() = default;
+
+		RecordLikeFrame(const std::size_t particleCount) :
+			_vector3Channels(k_vector3ChannelCount, std::vector<Storm::Vector3>(particleCount)),
+			_floatChannels(k_floatChannelCount, std::vector<float>(particleCount))
+		{
+			for (std::size_t channel = 0; channel < k_vector3ChannelCount; ++channel)
+			{
+				for (std::size_t iter = 0; iter < particleCount; ++iter)
+				{
+					const float value = static_cast<float>(iter + channel);
+					_vector3Channels[channel][iter] = Storm::Vector3{ value, -value, value * 0.5f };
+				}
+			}
+
+			for (std::size_t channel = 0; channel < k_floatChannelCount; ++channel)
+			{
+				for (std::size_t iter = 0; iter < particleCount; ++iter)
+				{
+					_floatChannels[channel][iter] = static_cast<float>(iter) * 0.25f + static_cast<float>(channel);
+				}
+			}
+		}
+
+	public:
+		void serialize(Storm::SerializePackage &package)
+		{
+			package << _vector3Channels << _floatChannels;
+		}
+
+		// What SerializePackage used to do for any container : one stream operation per element (per coordinate for Vector3).
+		void serializePerElement(Storm::SerializePackage &package)
+		{
+			for (std::vector<Storm::Vector3> &channel : _vector3Channels)
+			{
+				for (Storm::Vector3 &item : channel)
+				{
+					package << item.x() << item.y() << item.z();
+				}
+			}
+
+			for (std::vector<float> &channel : _floatChannels)
+			{
+				for (float &item : channel)
+				{
+					package << item;
+				}
+			}
+		}
+
+		std::size_t byteCount() const
+		{
+			const std::size_t particleCount = _floatChannels.empty() ? 0 : _floatChannels.front().size();
+			return particleCount * (k_vector3ChannelCount * sizeof(Storm::Vector3) + k_floatChannelCount * sizeof(float));
+		}
+
+	public:
+		static constexpr std::size_t k_vector3ChannelCount = 13;
+		static constexpr std::size_t k_floatChannelCount = 3;
+
+		std::vector<std::vector<Storm::Vector3>> _vector3Channels;
+		std::vector<std::vector<float>> _floatChannels;
+	};
+
+	bool areSame(const RecordLikeFrame &left, const RecordLikeFrame &right)
+	{
+		return left._vector3Channels == right._vector3Channels && left._floatChannels == right._floatChannels;
+	}
+
+	std::string makeTestFilePath(const std::string_view fileName)
+	{
+		return (std::filesystem::temp_directory_path() / fileName).string();
+	}
+}
+
+
+TEST_CASE("SerializePackage.BulkRoundTrip", "[classic]")
+{
+	const std::string filePath = makeTestFilePath("StormSerializePackageBulkRoundTrip.bin");
+
+	// 0 sends everything directly to the file, 7 is smaller than most of what we write, the default buffers everything.
+	for (const std::size_t writeBufferSize : { std::size_t{ 0 }, std::size_t{ 7 }, Storm::SerializePackage::k_defaultWriteBufferSize })
+	{
+		RecordLikeFrame written{ 10007 };
+		std::vector<double> writtenDoubles(123, 3.5);
+		std::string writtenStr = "Storm";
+		uint64_t writtenTail = 42;
+
+		uint64_t patchedValue = 7;
+
+		{
+			Storm::SerializePackage package{ Storm::SerializePackageCreationModality::SavingNew, filePath, writeBufferSize };
+			package << written << writtenDoubles << writtenStr << writtenTail;
+
+			// Seeking flushes the pending writes, so we can patch what was already written.
+			const std::size_t endPosition = package.getStreamPosition();
+			package.seekAbsolute(endPosition - sizeof(uint64_t));
+			package << patchedValue;
+		}
+
+		RecordLikeFrame read;
+		std::vector<double> readDoubles;
+		std::string readStr;
+		uint64_t readTail = 0;
+
+		{
+			Storm::SerializePackage package{ Storm::SerializePackageCreationModality::Loading, filePath };
+			package << read << readDoubles << readStr << readTail;
+		}
+
+		CHECK(areSame(written, read));
+		CHECK(readDoubles == writtenDoubles);
+		CHECK(readStr == writtenStr);
+		CHECK(readTail == patchedValue);
+	}
+
+	std::filesystem::remove(filePath);
+}
+
+TEST_CASE("SerializePackage.BulkIsSameAsPerElement", "[classic]")
+{
+	const std::string bulkFilePath = makeTestFilePath("StormSerializePackageBulk.bin");
+	const std::string perElementFilePath = makeTestFilePath("StormSerializePackagePerElement.bin");
+
+	RecordLikeFrame frame{ 1000 };
+
+	{
+		Storm::SerializePackage package{ Storm::SerializePackageCreationModality::SavingNewPreheaderProvidedAfter, bulkFilePath };
+		for (std::vector<Storm::Vector3> &channel : frame._vector3Channels)
+		{
+			package << channel;
+		}
+	}
+
+	{
+		Storm::SerializePackage package{ Storm::SerializePackageCreationModality::SavingNewPreheaderProvidedAfter, perElementFilePath };
+		for (std::vector<Storm::Vector3> &channel : frame._vector3Channels)
+		{
+			uint64_t channelSize = channel.size();
+			package << channelSize;
+			for (Storm::Vector3 &item : channel)
+			{
+				package << item;
+			}
+		}
+	}
+
+	// The record files written before the bulk path should remain readable, so the layout must not change.
+	std::ifstream bulkFile{ bulkFilePath, std::ios_base::binary };
+	std::ifstream perElementFile{ perElementFilePath, std::ios_base::binary };
+	const std::string bulkContent{ std::istreambuf_iterator<char>{ bulkFile }, std::istreambuf_iterator<char>{} };
+	const std::string perElementContent{ std::istreambuf_iterator<char>{ perElementFile }, std::istreambuf_iterator<char>{} };
+	bulkFile.close();
+	perElementFile.close();
+
+	CHECK(bulkContent == perElementContent);
+
+	std::filesystem::remove(bulkFilePath);
+	std::filesystem::remove(perElementFilePath);
+}
+
+TEST_CASE("SerializePackage.RecordThroughput.Benchmark", "[.][benchmark]")
+{
+	constexpr std::size_t k_particleCount = 200000;
+	constexpr std::size_t k_frameCount = 5;
+
+	const std::string filePath = makeTestFilePath("StormSerializePackageThroughput.bin");
+
+	RecordLikeFrame frame{ k_particleCount };
+	const double totalMb = static_cast<double>(frame.byteCount() * k_frameCount) / (1024.0 * 1024.0);
+
+	const auto logThroughput = [totalMb](const std::string_view name, const std::chrono::high_resolution_clock::time_point startTime)
+	{
+		const double elapsedSec = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+		std::cout << name << " : " << totalMb << " Mb in " << elapsedSec * 1000.0 << "ms (" << totalMb / elapsedSec << " Mb/s)\n";
+	};
+
+	{
+		const auto startTime = std::chrono::high_resolution_clock::now();
+		Storm::SerializePackage package{ Storm::SerializePackageCreationModality::SavingNew, filePath, 0 };
+		for (std::size_t iter = 0; iter < k_frameCount; ++iter)
+		{
+			frame.serializePerElement(package);
+		}
+		package.flush();
+		logThroughput("Per element write", startTime);
+	}
+
+	for (const std::size_t writeBufferSize : { std::size_t{ 0 }, Storm::SerializePackage::k_defaultWriteBufferSize, std::size_t{ 8 * 1024 * 1024 } })
+	{
+		const auto startTime = std::chrono::high_resolution_clock::now();
+		Storm::SerializePackage package{ Storm::SerializePackageCreationModality::SavingNew, filePath, writeBufferSize };
+		for (std::size_t iter = 0; iter < k_frameCount; ++iter)
+		{
+			package << frame;
+		}
+		package.flush();
+		logThroughput("Bulk write (write buffer of " + std::to_string(writeBufferSize) + " bytes)", startTime);
+	}
+
+	{
+		RecordLikeFrame read;
+
+		const auto startTime = std::chrono::high_resolution_clock::now();
+		Storm::SerializePackage package{ Storm::SerializePackageCreationModality::Loading, filePath };
+		for (std::size_t iter = 0; iter < k_frameCount; ++iter)
+		{
+			package << read;
+		}
+		logThroughput("Bulk read", startTime);
+
+		CHECK(areSame(frame, read));
+	}
+
+	std::filesystem::remove(filePath);
+}
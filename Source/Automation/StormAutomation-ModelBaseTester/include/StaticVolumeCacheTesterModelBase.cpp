@@ -0,0 +1,137 @@
+#include "Vector3.h"
+
+#include "StaticVolumeCache.h"
+
+#include "KernelMode.h"
+
+#include <fstream>
+
+
+namespace
+{
+	const Storm::Vector3 k_domainDimension{ 4.f, 2.f, 3.f };
+
+	std::filesystem::path makeTestFilePath(const std::string_view fileName)
+	{
+		return std::filesystem::temp_directory_path() / "StormStaticVolumeCacheTest" / fileName;
+	}
+
+	std::vector<Storm::Vector3> makeStaticPositions(const std::size_t particleCount)
+	{
+		std::vector<Storm::Vector3> result;
+		result.reserve(particleCount);
+
+		for (std::size_t iter = 0; iter < particleCount; ++iter)
+		{
+			const float value = static_cast<float>(iter) * 0.1f;
+			result.emplace_back(value, -value, value * 0.5f);
+		}
+
+		return result;
+	}
+
+	uint64_t computeKey(const Storm::KernelMode kernelMode, const float kernelLength, const bool infiniteDomain, const Storm::Vector3 &domainDimension, const std::vector<Storm::Vector3> &firstPositions, const std::vector<Storm::Vector3> &secondPositions)
+	{
+		Storm::StaticVolumeCache cache{ kernelMode, kernelLength, infiniteDomain, domainDimension };
+		cache.addStaticParticleSystem(1, firstPositions);
+		cache.addStaticParticleSystem(2, secondPositions);
+		return cache.getKey();
+	}
+
+	std::vector<float> makeStaticVolumes(const std::size_t particleCount)
+	{
+		std::vector<float> result(particleCount);
+		for (std::size_t iter = 0; iter < particleCount; ++iter)
+		{
+			result[iter] = 1.f / static_cast<float>(iter + 1);
+		}
+
+		return result;
+	}
+}
+
+
+TEST_CASE("StaticVolumeCache.KeyStability", "[classic]")
+{
+	const std::vector<Storm::Vector3> firstPositions = makeStaticPositions(100);
+	const std::vector<Storm::Vector3> secondPositions = makeStaticPositions(50);
+
+	const uint64_t key = computeKey(Storm::KernelMode::CubicSpline, 0.04f, false, k_domainDimension, firstPositions, secondPositions);
+
+	// The key names the cache files, the same scene should always give the same key (or the caches would never be reused).
+	// The value is pinned, changing how the key is computed orphans all existing caches and should be a conscious choice.
+	CHECK(key == computeKey(Storm::KernelMode::CubicSpline, 0.04f, false, k_domainDimension, firstPositions, secondPositions));
+	CHECK(key == 0x9A4D192CD2D69645ull);
+
+	// Anything the static volumes depend on should change the key.
+	CHECK(key != computeKey(Storm::KernelMode::SplishSplashCubicSpline, 0.04f, false, k_domainDimension, firstPositions, secondPositions));
+	CHECK(key != computeKey(Storm::KernelMode::CubicSpline, 0.041f, false, k_domainDimension, firstPositions, secondPositions));
+	CHECK(key != computeKey(Storm::KernelMode::CubicSpline, 0.04f, true, k_domainDimension, firstPositions, secondPositions));
+	CHECK(key != computeKey(Storm::KernelMode::CubicSpline, 0.04f, false, Storm::Vector3{ 4.f, 2.f, 3.5f }, firstPositions, secondPositions));
+	CHECK(key != computeKey(Storm::KernelMode::CubicSpline, 0.04f, false, k_domainDimension, secondPositions, firstPositions));
+
+	std::vector<Storm::Vector3> movedPositions = firstPositions;
+	movedPositions[42].y() += 0.001f;
+	CHECK(key != computeKey(Storm::KernelMode::CubicSpline, 0.04f, false, k_domainDimension, movedPositions, secondPositions));
+
+	Storm::StaticVolumeCache otherIdCache{ Storm::KernelMode::CubicSpline, 0.04f, false, k_domainDimension };
+	otherIdCache.addStaticParticleSystem(1, firstPositions);
+	otherIdCache.addStaticParticleSystem(3, secondPositions);
+	CHECK(key != otherIdCache.getKey());
+}
+
+TEST_CASE("StaticVolumeCache.RoundTrip", "[classic]")
+{
+	const std::filesystem::path cachePath = makeTestFilePath("RoundTrip.cStaticVolumes");
+	const std::vector<float> written = makeStaticVolumes(1000);
+
+	REQUIRE(Storm::StaticVolumeCache::write(cachePath, written));
+
+	std::vector<float> read(written.size());
+	CHECK(Storm::StaticVolumeCache::read(cachePath, read));
+	CHECK(read == written);
+
+	// Another particle count means another rigid body sampling, the cache shouldn't be used.
+	std::vector<float> readOtherCount(written.size() + 1);
+	CHECK_FALSE(Storm::StaticVolumeCache::read(cachePath, readOtherCount));
+
+	std::filesystem::remove_all(cachePath.parent_path());
+}
+
+TEST_CASE("StaticVolumeCache.Invalid", "[classic]")
+{
+	const std::filesystem::path cachePath = makeTestFilePath("Invalid.cStaticVolumes");
+	const std::vector<float> written = makeStaticVolumes(1000);
+
+	std::vector<float> read(written.size());
+	CHECK_FALSE(Storm::StaticVolumeCache::read(cachePath, read));
+
+	// A truncated cache (an interrupted copy for example) shouldn't be read.
+	REQUIRE(Storm::StaticVolumeCache::write(cachePath, written));
+	std::filesystem::resize_file(cachePath, std::filesystem::file_size(cachePath) - sizeof(float));
+	CHECK_FALSE(Storm::StaticVolumeCache::read(cachePath, read));
+
+	// Same for a cache whose writing didn't reach the end (the placeholder checksum is still there).
+	REQUIRE(Storm::StaticVolumeCache::write(cachePath, written));
+	{
+		std::fstream cacheStream{ cachePath, std::ios_base::in | std::ios_base::out | std::ios_base::binary };
+		const uint64_t placeholderChecksum = 0x00AA00CC;
+		cacheStream.write(reinterpret_cast<const char*>(&placeholderChecksum), sizeof(placeholderChecksum));
+	}
+	CHECK_FALSE(Storm::StaticVolumeCache::read(cachePath, read));
+
+	// A cache that cannot be written is reported and isn't left behind, without removing what was there instead of the file.
+	std::filesystem::remove(cachePath);
+	std::filesystem::create_directories(cachePath);
+	CHECK_FALSE(Storm::StaticVolumeCache::write(cachePath, written));
+	CHECK(std::filesystem::is_directory(cachePath));
+
+	const std::filesystem::path blockedCachePath = cachePath.parent_path() / "Blocked" / "Blocked.cStaticVolumes";
+	{
+		std::ofstream blockingFile{ cachePath.parent_path() / "Blocked" };
+	}
+	CHECK_FALSE(Storm::StaticVolumeCache::write(blockedCachePath, written));
+	CHECK_FALSE(std::filesystem::exists(blockedCachePath));
+
+	std::filesystem::remove_all(cachePath.parent_path());
+}
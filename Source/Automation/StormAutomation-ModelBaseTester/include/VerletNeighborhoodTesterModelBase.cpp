@@ -0,0 +1,229 @@
+#include "Vector3.h"
+
+#include "VerletNeighborhood.h"
+#include "ParticleNeighborhoodStorage.h"
+
+#include <random>
+
+
+namespace
+{
+	constexpr float k_kernelLength = 2.f;
+	constexpr float k_searchLength = 2.4f;
+	constexpr float k_halfSkin = (k_searchLength - k_kernelLength) * 0.5f;
+
+	// A jittered fluid block with Verlet list neighborhoods, refreshed like Storm::SimulatorManager::refreshParticleNeighborhood does.
+	class VerletScene
+	{
+	public:
+		VerletScene() :
+			_randomEngine{ 42 },
+			_neighborhood{ _positions },
+			_neighborhoodCandidates{ _positions },
+			_buildCount{ 0 }
+		{
+			constexpr int k_edgeParticleCount = 10;
+
+			std::uniform_real_distribution<float> jitterDistribution{ -0.3f, 0.3f };
+
+			for (int xIndex = 0; xIndex < k_edgeParticleCount; ++xIndex)
+			{
+				for (int yIndex = 0; yIndex < k_edgeParticleCount; ++yIndex)
+				{
+					for (int zIndex = 0; zIndex < k_edgeParticleCount; ++zIndex)
+					{
+						_positions.emplace_back(static_cast<float>(xIndex) + jitterDistribution(_randomEngine), static_cast<float>(yIndex) + jitterDistribution(_randomEngine), static_cast<float>(zIndex) + jitterDistribution(_randomEngine));
+					}
+				}
+			}
+
+			// Two pairs of particles outside the block, that will come toward each other. The first is just inside the search length, the second just outside.
+			_positions.emplace_back(20.f, 0.f, 0.f);
+			_positions.emplace_back(20.f + k_searchLength - 0.01f, 0.f, 0.f);
+			_positions.emplace_back(30.f, 0.f, 0.f);
+			_positions.emplace_back(30.f + k_searchLength + 0.002f, 0.f, 0.f);
+		}
+
+	public:
+		void buildCandidates()
+		{
+			_neighborhoodCandidates.reset(this->makeNeighborSources(k_searchLength));
+			_neighborhoodCandidates.fill([this](Storm::ParticleNeighborhoodBuildArray &outNeighborhood, const std::size_t particleIndex)
+			{
+				this->searchNeighborhood(outNeighborhood, particleIndex, k_searchLength);
+			});
+
+			_positionsAtBuild = _positions;
+			++_buildCount;
+		}
+
+		// The candidates are searched again only when they aren't valid anymore.
+		void refreshNeighborhood()
+		{
+			const float maxDisplacementSquared = Storm::VerletNeighborhood::computeMaxDisplacementSquared(_positions, _positionsAtBuild);
+			if (!Storm::VerletNeighborhood::areCandidatesValid(maxDisplacementSquared, k_kernelLength, k_searchLength))
+			{
+				this->buildCandidates();
+			}
+
+			const auto candidateDisplacementFunc = [this](const Storm::NeighborParticleInfo &candidate) -> Storm::Vector3
+			{
+				return _positions[candidate._particleIndex] - _positionsAtBuild[candidate._particleIndex];
+			};
+
+			_neighborhood.reset(this->makeNeighborSources(k_kernelLength));
+			_neighborhood.fill([this, &candidateDisplacementFunc](Storm::ParticleNeighborhoodBuildArray &outNeighborhood, const std::size_t particleIndex)
+			{
+				const Storm::Vector3 currentPDisplacement = _positions[particleIndex] - _positionsAtBuild[particleIndex];
+				Storm::VerletNeighborhood::filterCandidates(_neighborhoodCandidates[particleIndex], currentPDisplacement, k_kernelLength * k_kernelLength, candidateDisplacementFunc, outNeighborhood);
+			});
+		}
+
+		// All particles move by the same distance, in random directions. The particles of the pairs move toward each other.
+		void moveParticles(const float displacementNorm)
+		{
+			std::uniform_real_distribution<float> directionDistribution{ -1.f, 1.f };
+
+			const std::size_t pairFirstPIndex = _positions.size() - 4;
+			for (std::size_t particleIndex = 0; particleIndex < pairFirstPIndex; ++particleIndex)
+			{
+				Storm::Vector3 direction;
+				do
+				{
+					direction = Storm::Vector3{ directionDistribution(_randomEngine), directionDistribution(_randomEngine), directionDistribution(_randomEngine) };
+				} while (direction.squaredNorm() < 0.01f);
+
+				_positions[particleIndex] += direction.normalized() * displacementNorm;
+			}
+
+			for (std::size_t particleIndex = pairFirstPIndex; particleIndex < _positions.size(); particleIndex += 2)
+			{
+				_positions[particleIndex].x() += displacementNorm;
+				_positions[particleIndex + 1].x() -= displacementNorm;
+			}
+		}
+
+		// Brute force search of the neighbors nearer than searchLength.
+		void searchNeighborhood(Storm::ParticleNeighborhoodBuildArray &outNeighborhood, const std::size_t particleIndex, const float searchLength) const
+		{
+			const Storm::Vector3 &currentPPosition = _positions[particleIndex];
+			for (std::size_t neighborIndex = 0; neighborIndex < _positions.size(); ++neighborIndex)
+			{
+				const Storm::Vector3 xij = currentPPosition - _positions[neighborIndex];
+				const float xijSquaredNorm = xij.squaredNorm();
+				if (neighborIndex != particleIndex && Storm::ParticleSystem::isElligibleNeighborParticle(searchLength * searchLength, xijSquaredNorm))
+				{
+					outNeighborhood.emplace_back(nullptr, neighborIndex, xij, xijSquaredNorm, true, true);
+				}
+			}
+		}
+
+	private:
+		Storm::ParticleNeighborhoodStorage::NeighborSources makeNeighborSources(const float kernelLength) const
+		{
+			// The particle system is only used to identify the neighbors, it is never dereferenced by the storage.
+			return Storm::ParticleNeighborhoodStorage::NeighborSources{
+				{ Storm::ParticleNeighborhoodStorage::ReferencedParticleSystem{ nullptr, &_positions, true } },
+				false,
+				Storm::Vector3::Zero(),
+				kernelLength
+			};
+		}
+
+	public:
+		std::mt19937 _randomEngine;
+
+		std::vector<Storm::Vector3> _positions;
+		std::vector<Storm::Vector3> _positionsAtBuild;
+
+		Storm::ParticleNeighborhoodStorage _neighborhood;
+		Storm::ParticleNeighborhoodStorage _neighborhoodCandidates;
+		std::size_t _buildCount;
+	};
+
+	// The neighborhood of each particle should be the one a full search finds from the current positions : same neighbors, same xij.
+	bool isSameAsFullSearch(const VerletScene &scene, const std::size_t particleIndex)
+	{
+		Storm::ParticleNeighborhoodBuildArray expected;
+		scene.searchNeighborhood(expected, particleIndex, k_kernelLength);
+
+		const Storm::ParticleNeighborhoodArray neighborhood = scene._neighborhood[particleIndex];
+		if (neighborhood.size() != expected.size())
+		{
+			return false;
+		}
+
+		for (const Storm::NeighborParticleInfo &neighbor : neighborhood)
+		{
+			const auto expectedNeighborIt = std::find_if(std::begin(expected), std::end(expected), [&neighbor](const Storm::NeighborParticleInfo &expectedNeighbor)
+			{
+				return expectedNeighbor._particleIndex == neighbor._particleIndex;
+			});
+
+			if (expectedNeighborIt == std::end(expected) || (neighbor._xij - expectedNeighborIt->_xij).norm() > 0.0001f)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool areNeighbors(const VerletScene &scene, const std::size_t particleIndex, const std::size_t neighborIndex)
+	{
+		const Storm::ParticleNeighborhoodArray neighborhood = scene._neighborhood[particleIndex];
+		return std::any_of(std::begin(neighborhood), std::end(neighborhood), [neighborIndex](const Storm::NeighborParticleInfo &neighbor)
+		{
+			return neighbor._particleIndex == neighborIndex;
+		});
+	}
+
+	// Moves the particles from the candidates build by displacementRatio times half the skin, in 2 steps, refreshing the neighborhoods after each of them.
+	void checkRefreshAfterMove(const float displacementRatio, const bool expectRebuild)
+	{
+		VerletScene scene;
+		scene.buildCandidates();
+		scene.refreshNeighborhood();
+
+		const std::size_t particleCount = scene._positions.size();
+		for (int stepIndex = 0; stepIndex < 2; ++stepIndex)
+		{
+			scene.moveParticles(0.5f * displacementRatio * k_halfSkin);
+			scene.refreshNeighborhood();
+
+			for (std::size_t particleIndex = 0; particleIndex < particleCount; ++particleIndex)
+			{
+				CAPTURE(displacementRatio, stepIndex, particleIndex);
+				CHECK(isSameAsFullSearch(scene, particleIndex));
+			}
+		}
+
+		CHECK(scene._buildCount == (expectRebuild ? 2 : 1));
+
+		// The pair that started inside the search length came inside the kernel support. The other one only did if it moved more than half the skin.
+		CHECK(areNeighbors(scene, particleCount - 4, particleCount - 3));
+		CHECK(areNeighbors(scene, particleCount - 2, particleCount - 1) == expectRebuild);
+	}
+}
+
+
+TEST_CASE("VerletNeighborhood.MoveUnderHalfSkin", "[classic]")
+{
+	checkRefreshAfterMove(0.99f, false);
+}
+
+TEST_CASE("VerletNeighborhood.MoveOverHalfSkin", "[classic]")
+{
+	checkRefreshAfterMove(1.01f, true);
+}
+
+TEST_CASE("VerletNeighborhood.CandidatesValidity", "[classic]")
+{
+	CHECK(Storm::VerletNeighborhood::areCandidatesValid(0.f, k_kernelLength, k_searchLength));
+	CHECK(Storm::VerletNeighborhood::areCandidatesValid(0.99f * k_halfSkin * 0.99f * k_halfSkin, k_kernelLength, k_searchLength));
+	CHECK_FALSE(Storm::VerletNeighborhood::areCandidatesValid(1.01f * k_halfSkin * 1.01f * k_halfSkin, k_kernelLength, k_searchLength));
+
+	const std::vector<Storm::Vector3> positionsAtBuild{ Storm::Vector3{ 0.f, 0.f, 0.f }, Storm::Vector3{ 1.f, 1.f, 1.f }, Storm::Vector3{ 2.f, 2.f, 2.f } };
+	const std::vector<Storm::Vector3> positions{ Storm::Vector3{ 0.1f, 0.f, 0.f }, Storm::Vector3{ 1.f, 1.3f, 1.f }, Storm::Vector3{ 2.f, 2.f, 1.8f } };
+	CHECK(std::fabs(Storm::VerletNeighborhood::computeMaxDisplacementSquared(positions, positionsAtBuild) - 0.09f) < 0.00001f);
+}
@@ -0,0 +1,934 @@
+#include "Vector3.h"
+
+#include "VoxelGrid.h"
+#include "HashedVoxelGrid.h"
+#include "NeighborParticleReferral.h"
+#include "NeighborParticleReferralBundle.h"
+#include "OutReflectedModality.h"
+
+#include <random>
+#include <iostream>
+
+
+namespace
+{
+	constexpr float k_voxelEdgeLength = 0.5f;
+	const Storm::Vector3 k_upCorner{ 20.f, 20.f, 20.f };
+	const Storm::Vector3 k_downCorner{ 0.f, 0.f, 0.f };
+	const Storm::Vector3 k_voxelShift{ 0.f, 0.f, 0.f };
+
+	constexpr unsigned int k_firstSystemId = 3;
+	constexpr unsigned int k_secondSystemId = 7;
+
+	class ParticleGenerator
+	{
+	public:
+		ParticleGenerator() :
+			_randomEngine{ 42 },
+			_positionDistribution{ 0.f, 20.f },
+			_ratioDistribution{ 0.f, 1.f }
+		{}
+
+	public:
+		Storm::Vector3 generatePosition()
+		{
+			return Storm::Vector3{ _positionDistribution(_randomEngine), _positionDistribution(_randomEngine), _positionDistribution(_randomEngine) };
+		}
+
+		void fill(std::vector<Storm::Vector3> &positions)
+		{
+			for (Storm::Vector3 &position : positions)
+			{
+				position = this->generatePosition();
+			}
+		}
+
+		// Teleport about movedRatio of the particles to another random place. Most of them end up in another voxel.
+		void move(std::vector<Storm::Vector3> &positions, const float movedRatio)
+		{
+			for (Storm::Vector3 &position : positions)
+			{
+				if (_ratioDistribution(_randomEngine) < movedRatio)
+				{
+					position = this->generatePosition();
+				}
+			}
+		}
+
+	private:
+		std::mt19937 _randomEngine;
+		std::uniform_real_distribution<float> _positionDistribution;
+		std::uniform_real_distribution<float> _ratioDistribution;
+	};
+
+	void rebuild(Storm::ISpacePartition &grid, const std::vector<Storm::Vector3> &firstSystem, const std::vector<Storm::Vector3> &secondSystem)
+	{
+		grid.clear();
+		grid.fill(k_voxelEdgeLength, k_voxelShift, firstSystem, k_firstSystemId);
+		grid.fill(k_voxelEdgeLength, k_voxelShift, secondSystem, k_secondSystemId);
+		grid.prepareQueries();
+	}
+
+	bool update(Storm::ISpacePartition &grid, const std::vector<Storm::Vector3> &firstSystem, const std::vector<Storm::Vector3> &secondSystem, const float maxMovedParticleRatio)
+	{
+		if (
+			grid.prepareUpdate(k_voxelEdgeLength, k_voxelShift, firstSystem, k_firstSystemId) &&
+			grid.prepareUpdate(k_voxelEdgeLength, k_voxelShift, secondSystem, k_secondSystemId) &&
+			grid.applyUpdate(maxMovedParticleRatio)
+			)
+		{
+			grid.prepareQueries();
+			return true;
+		}
+
+		return false;
+	}
+
+	bool haveSameReferrals(const Storm::VoxelGrid &grid, const Storm::VoxelGrid &expected)
+	{
+		if (grid.size() != expected.size())
+		{
+			return false;
+		}
+
+		const std::size_t voxelCount = grid.size();
+		for (std::size_t voxelIndex = 0; voxelIndex < voxelCount; ++voxelIndex)
+		{
+			const Storm::NeighborParticleReferralBundle &gridBundle = *grid.getBundleAt(voxelIndex, 0);
+			const Storm::NeighborParticleReferralBundle &expectedBundle = *expected.getBundleAt(voxelIndex, 1);
+
+			const std::size_t referralCount = gridBundle.size();
+			if (referralCount != expectedBundle.size())
+			{
+				return false;
+			}
+
+			for (std::size_t iter = 0; iter < referralCount; ++iter)
+			{
+				const Storm::NeighborParticleReferral &gridReferral = gridBundle[iter];
+				const Storm::NeighborParticleReferral &expectedReferral = expectedBundle[iter];
+				if (gridReferral._particleIndex != expectedReferral._particleIndex || gridReferral._systemId != expectedReferral._systemId)
+				{
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	// Random positions with 1 to 3 coordinates snapped on a voxel face, and the domain corners. A particle exactly on a face belongs to the voxel after it, except on the up corner faces.
+	std::vector<Storm::Vector3> makeVoxelBoundaryPositions(ParticleGenerator &generator, const std::size_t particleCount)
+	{
+		std::vector<Storm::Vector3> result;
+		result.reserve(particleCount + 8);
+
+		for (std::size_t iter = 0; iter < particleCount; ++iter)
+		{
+			Storm::Vector3 position = generator.generatePosition();
+			for (int coord = 0; coord <= static_cast<int>(iter % 3); ++coord)
+			{
+				const int snappedCoord = static_cast<int>((iter + coord) % 3);
+				position[snappedCoord] = std::round(position[snappedCoord] / k_voxelEdgeLength) * k_voxelEdgeLength;
+			}
+
+			result.emplace_back(position);
+		}
+
+		for (int corner = 0; corner < 8; ++corner)
+		{
+			result.emplace_back(
+				corner & 1 ? k_upCorner.x() : k_downCorner.x(),
+				corner & 2 ? k_upCorner.y() : k_downCorner.y(),
+				corner & 4 ? k_upCorner.z() : k_downCorner.z()
+			);
+		}
+
+		return result;
+	}
+
+	// The fill before the counting sort appended each particle to its voxel, system after system, in particle index order. The counting sort should give the same bundles.
+	bool haveSameReferralsAsPreviousFill(const Storm::VoxelGrid &grid, const std::vector<Storm::Vector3> &firstSystem, const std::vector<Storm::Vector3> &secondSystem)
+	{
+		std::vector<std::vector<Storm::NeighborParticleReferral>> expectedVoxels(grid.size());
+
+		const auto previousFill = [&grid, &expectedVoxels](const std::vector<Storm::Vector3> &positions, const unsigned int systemId)
+		{
+			unsigned int dummy1;
+			unsigned int dummy2;
+			unsigned int dummy3;
+
+			for (std::size_t particleIndex = 0; particleIndex < positions.size(); ++particleIndex)
+			{
+				const std::size_t voxelIndex = grid.computeRawIndexFromPosition(grid.getGridBoundary(), k_voxelEdgeLength, k_voxelShift, positions[particleIndex], dummy1, dummy2, dummy3);
+				expectedVoxels[voxelIndex].emplace_back(particleIndex, systemId);
+			}
+		};
+
+		previousFill(firstSystem, k_firstSystemId);
+		previousFill(secondSystem, k_secondSystemId);
+
+		for (std::size_t voxelIndex = 0; voxelIndex < expectedVoxels.size(); ++voxelIndex)
+		{
+			const Storm::NeighborParticleReferralBundle &gridBundle = *grid.getBundleAt(voxelIndex, 0);
+			const std::vector<Storm::NeighborParticleReferral> &expectedReferrals = expectedVoxels[voxelIndex];
+
+			if (
+				gridBundle.size() != expectedReferrals.size() ||
+				!std::equal(std::begin(gridBundle), std::end(gridBundle), std::begin(expectedReferrals), [](const Storm::NeighborParticleReferral &gridReferral, const Storm::NeighborParticleReferral &expectedReferral)
+			{
+				return gridReferral._particleIndex == expectedReferral._particleIndex && gridReferral._systemId == expectedReferral._systemId;
+			}))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
+
+
+TEST_CASE("VoxelGrid.Fill.SameAsPreviousFill", "[classic]")
+{
+	ParticleGenerator generator;
+
+	std::vector<Storm::Vector3> firstSystem(20000);
+	generator.fill(firstSystem);
+
+	const std::vector<Storm::Vector3> boundarySystem = makeVoxelBoundaryPositions(generator, 5000);
+	firstSystem.insert(std::end(firstSystem), std::begin(boundarySystem), std::end(boundarySystem));
+
+	std::vector<Storm::Vector3> secondSystem = makeVoxelBoundaryPositions(generator, 3000);
+
+	Storm::VoxelGrid grid{ k_upCorner, k_downCorner, k_voxelEdgeLength };
+	rebuild(grid, firstSystem, secondSystem);
+	CHECK(haveSameReferralsAsPreviousFill(grid, firstSystem, secondSystem));
+
+	// Filled again after a clear, the buffers of the previous fill are reused.
+	generator.fill(firstSystem);
+	secondSystem.resize(1000);
+	rebuild(grid, firstSystem, secondSystem);
+	CHECK(haveSameReferralsAsPreviousFill(grid, firstSystem, secondSystem));
+
+	// An empty system doesn't change the others.
+	rebuild(grid, firstSystem, std::vector<Storm::Vector3>{});
+	CHECK(haveSameReferralsAsPreviousFill(grid, firstSystem, std::vector<Storm::Vector3>{}));
+}
+
+TEST_CASE("VoxelGrid.IncrementalUpdate", "[classic]")
+{
+	ParticleGenerator generator;
+
+	std::vector<Storm::Vector3> firstSystem(20000);
+	std::vector<Storm::Vector3> secondSystem(5000);
+	generator.fill(firstSystem);
+	generator.fill(secondSystem);
+
+	Storm::VoxelGrid grid{ k_upCorner, k_downCorner, k_voxelEdgeLength };
+	rebuild(grid, firstSystem, secondSystem);
+
+	Storm::VoxelGrid expected{ k_upCorner, k_downCorner, k_voxelEdgeLength };
+
+	for (const float movedRatio : { 0.f, 0.001f, 0.05f, 0.5f })
+	{
+		generator.move(firstSystem, movedRatio);
+		generator.move(secondSystem, movedRatio);
+
+		REQUIRE(update(grid, firstSystem, secondSystem, 1.f));
+
+		rebuild(expected, firstSystem, secondSystem);
+		CHECK(haveSameReferrals(grid, expected));
+	}
+}
+
+TEST_CASE("VoxelGrid.IncrementalUpdate.Fallback", "[classic]")
+{
+	ParticleGenerator generator;
+
+	std::vector<Storm::Vector3> firstSystem(20000);
+	std::vector<Storm::Vector3> secondSystem(5000);
+	generator.fill(firstSystem);
+	generator.fill(secondSystem);
+
+	Storm::VoxelGrid grid{ k_upCorner, k_downCorner, k_voxelEdgeLength };
+	rebuild(grid, firstSystem, secondSystem);
+
+	Storm::VoxelGrid expected{ k_upCorner, k_downCorner, k_voxelEdgeLength };
+	rebuild(expected, firstSystem, secondSystem);
+
+	// Too many particles moved : the update is refused and the grid is left as it was.
+	generator.fill(firstSystem);
+	CHECK_FALSE(update(grid, firstSystem, secondSystem, 0.1f));
+	CHECK(haveSameReferrals(grid, expected));
+
+	// The particle count changed.
+	firstSystem.pop_back();
+	CHECK_FALSE(grid.prepareUpdate(k_voxelEdgeLength, k_voxelShift, firstSystem, k_firstSystemId));
+
+	// Not registered.
+	CHECK_FALSE(grid.prepareUpdate(k_voxelEdgeLength, k_voxelShift, secondSystem, 12));
+
+	// Invalidated, until the next full rebuild.
+	rebuild(grid, firstSystem, secondSystem);
+	grid.invalidateUpdate();
+	CHECK_FALSE(grid.prepareUpdate(k_voxelEdgeLength, k_voxelShift, firstSystem, k_firstSystemId));
+
+	rebuild(grid, firstSystem, secondSystem);
+	generator.move(secondSystem, 0.01f);
+	CHECK(update(grid, firstSystem, secondSystem, 0.1f));
+
+	rebuild(expected, firstSystem, secondSystem);
+	CHECK(haveSameReferrals(grid, expected));
+}
+
+// Hidden by default, run it explicitly with the "[benchmark]" tag.
+TEST_CASE("VoxelGrid.IncrementalUpdate.Benchmark", "[.][benchmark]")
+{
+	ParticleGenerator generator;
+
+	std::vector<Storm::Vector3> firstSystem(300000);
+	std::vector<Storm::Vector3> secondSystem(50000);
+	generator.fill(firstSystem);
+	generator.fill(secondSystem);
+
+	Storm::VoxelGrid grid{ k_upCorner, k_downCorner, k_voxelEdgeLength };
+	rebuild(grid, firstSystem, secondSystem);
+
+	Storm::VoxelGrid expected{ k_upCorner, k_downCorner, k_voxelEdgeLength };
+
+	for (const float movedRatio : { 0.f, 0.001f, 0.01f, 0.05f, 0.1f, 0.25f, 0.5f })
+	{
+		generator.move(firstSystem, movedRatio);
+		generator.move(secondSystem, movedRatio);
+
+		const auto updateStartTime = std::chrono::high_resolution_clock::now();
+		REQUIRE(update(grid, firstSystem, secondSystem, 1.f));
+		const auto updateEndTime = std::chrono::high_resolution_clock::now();
+
+		rebuild(expected, firstSystem, secondSystem);
+		const auto rebuildEndTime = std::chrono::high_resolution_clock::now();
+
+		CHECK(haveSameReferrals(grid, expected));
+
+		std::cout <<
+			"Moved particle ratio " << movedRatio <<
+			" : incremental update " << std::chrono::duration<double, std::milli>(updateEndTime - updateStartTime).count() << "ms" <<
+			", full rebuild " << std::chrono::duration<double, std::milli>(rebuildEndTime - updateEndTime).count() << "ms\n";
+	}
+}
+
+namespace
+{
+	// Brute force reference : the voxels containing the points sampled with a tiny step along the ray, in the order they are crossed.
+	std::vector<std::size_t> sampleVoxelsUnderRaycast(const Storm::VoxelGrid &grid, const Storm::Vector3 &origin, const Storm::Vector3 &direction, const float minDist, const float maxDist)
+	{
+		std::vector<std::size_t> result;
+
+		const Storm::Vector3ui &gridBoundary = grid.getGridBoundary();
+		const Storm::Vector3 gridUpCorner = k_voxelShift + Storm::Vector3{ static_cast<float>(gridBoundary.x()), static_cast<float>(gridBoundary.y()), static_cast<float>(gridBoundary.z()) } * k_voxelEdgeLength;
+
+		constexpr float k_sampleStep = k_voxelEdgeLength / 1000.f;
+		for (float dist = minDist; dist <= maxDist; dist += k_sampleStep)
+		{
+			const Storm::Vector3 position = origin + dist * direction;
+			if (
+				position.x() < k_voxelShift.x() || position.y() < k_voxelShift.y() || position.z() < k_voxelShift.z() ||
+				position.x() >= gridUpCorner.x() || position.y() >= gridUpCorner.y() || position.z() >= gridUpCorner.z()
+				)
+			{
+				continue;
+			}
+
+			unsigned int xIndex;
+			unsigned int yIndex;
+			unsigned int zIndex;
+			const std::size_t voxelIndex = grid.computeRawIndexFromPosition(gridBoundary, k_voxelEdgeLength, k_voxelShift, position, xIndex, yIndex, zIndex);
+			if (result.empty() || result.back() != voxelIndex)
+			{
+				result.emplace_back(voxelIndex);
+			}
+		}
+
+		return result;
+	}
+
+	// Brute force reference for an inflated ray : the voxels whose box inflated by rayRadius is crossed by the ray, sorted by voxel index.
+	std::vector<std::size_t> selectVoxelsNearRaycast(const Storm::VoxelGrid &grid, const Storm::Vector3 &origin, const Storm::Vector3 &direction, const float minDist, const float maxDist, const float rayRadius)
+	{
+		std::vector<std::size_t> result;
+
+		const Storm::Vector3ui &gridBoundary = grid.getGridBoundary();
+		for (unsigned int xIndex = 0; xIndex < gridBoundary.x(); ++xIndex)
+		{
+			for (unsigned int yIndex = 0; yIndex < gridBoundary.y(); ++yIndex)
+			{
+				for (unsigned int zIndex = 0; zIndex < gridBoundary.z(); ++zIndex)
+				{
+					const Storm::Vector3 voxelMin = k_voxelShift + Storm::Vector3{ static_cast<float>(xIndex), static_cast<float>(yIndex), static_cast<float>(zIndex) } * k_voxelEdgeLength;
+
+					float enterDist = minDist;
+					float exitDist = maxDist;
+					for (int axis = 0; axis < 3; ++axis)
+					{
+						const float boxMin = voxelMin[axis] - rayRadius;
+						const float boxMax = voxelMin[axis] + k_voxelEdgeLength + rayRadius;
+						if (direction[axis] == 0.f)
+						{
+							if (origin[axis] < boxMin || origin[axis] >= boxMax)
+							{
+								enterDist = maxDist + 1.f;
+							}
+						}
+						else
+						{
+							const float firstDist = (boxMin - origin[axis]) / direction[axis];
+							const float secondDist = (boxMax - origin[axis]) / direction[axis];
+							enterDist = std::max(enterDist, std::min(firstDist, secondDist));
+							exitDist = std::min(exitDist, std::max(firstDist, secondDist));
+						}
+					}
+
+					if (enterDist <= exitDist)
+					{
+						result.emplace_back(grid.computeRawIndexFromCoordIndex(xIndex, yIndex, zIndex));
+					}
+				}
+			}
+		}
+
+		std::sort(std::begin(result), std::end(result));
+		return result;
+	}
+
+	std::vector<std::size_t> traverseVoxelsUnderRaycast(const Storm::VoxelGrid &grid, const Storm::Vector3 &origin, const Storm::Vector3 &direction, const float minDist, const float maxDist, const float rayRadius = 0.f)
+	{
+		std::vector<std::size_t> result;
+
+		// Each particle is alone in its voxel, so we can identify the voxel with the particle inside it.
+		grid.traverseVoxelsUnderRaycast(origin, direction, minDist, maxDist, rayRadius, k_voxelEdgeLength, k_voxelShift, [&result](const Storm::NeighborParticleReferralBundle &bundle, const float)
+		{
+			if (!bundle.empty())
+			{
+				result.emplace_back(bundle.front()._particleIndex);
+			}
+			return true;
+		});
+
+		return result;
+	}
+}
+
+TEST_CASE("VoxelGrid.RaycastTraversal", "[classic]")
+{
+	Storm::VoxelGrid grid{ Storm::Vector3{ 4.f, 4.f, 4.f }, k_downCorner, k_voxelEdgeLength };
+
+	// Put a particle at the center of each voxel, its index being the voxel index.
+	const Storm::Vector3ui &gridBoundary = grid.getGridBoundary();
+	std::vector<Storm::Vector3> voxelCenters(grid.size());
+	for (unsigned int xIndex = 0; xIndex < gridBoundary.x(); ++xIndex)
+	{
+		for (unsigned int yIndex = 0; yIndex < gridBoundary.y(); ++yIndex)
+		{
+			for (unsigned int zIndex = 0; zIndex < gridBoundary.z(); ++zIndex)
+			{
+				voxelCenters[grid.computeRawIndexFromCoordIndex(xIndex, yIndex, zIndex)] = (Storm::Vector3{ static_cast<float>(xIndex), static_cast<float>(yIndex), static_cast<float>(zIndex) } + Storm::Vector3::Constant(0.5f)) * k_voxelEdgeLength;
+			}
+		}
+	}
+
+	grid.fill(k_voxelEdgeLength, k_voxelShift, voxelCenters, k_firstSystemId);
+
+	const auto checkRaycast = [&grid](const Storm::Vector3 &origin, const Storm::Vector3 &direction, const float minDist, const float maxDist)
+	{
+		const Storm::Vector3 normalizedDirection = direction.normalized();
+		CHECK(traverseVoxelsUnderRaycast(grid, origin, normalizedDirection, minDist, maxDist) == sampleVoxelsUnderRaycast(grid, origin, normalizedDirection, minDist, maxDist));
+	};
+
+	// Along an axis, inside the grid.
+	checkRaycast(Storm::Vector3{ 0.1f, 1.3f, 2.2f }, Storm::Vector3{ 1.f, 0.f, 0.f }, 0.f, 100.f);
+	checkRaycast(Storm::Vector3{ 1.3f, 3.9f, 2.2f }, Storm::Vector3{ 0.f, -1.f, 0.f }, 0.f, 100.f);
+
+	// Diagonals, starting outside the grid (not passing exactly through a voxel corner, where any crossing order would be valid).
+	checkRaycast(Storm::Vector3{ -1.f, -0.73f, -1.29f }, Storm::Vector3{ 1.f, 0.87f, 1.13f }, 0.f, 100.f);
+	checkRaycast(Storm::Vector3{ 5.f, 0.23f, 3.71f }, Storm::Vector3{ -1.f, 0.31f, -0.17f }, 0.f, 100.f);
+
+	// Clipped by the min and max distance.
+	checkRaycast(Storm::Vector3{ 0.1f, 0.2f, 0.3f }, Storm::Vector3{ 0.5f, 0.7f, 0.3f }, 1.1f, 3.4f);
+
+	// Missing the grid.
+	CHECK(traverseVoxelsUnderRaycast(grid, Storm::Vector3{ -1.f, 5.f, 1.f }, Storm::Vector3{ 1.f, 0.f, 0.f }, 0.f, 100.f).empty());
+	CHECK(traverseVoxelsUnderRaycast(grid, Storm::Vector3{ -1.f, 1.f, 1.f }, Storm::Vector3{ -1.f, 0.f, 0.f }, 0.f, 100.f).empty());
+}
+
+TEST_CASE("VoxelGrid.RaycastTraversal.InflatedRay", "[classic]")
+{
+	Storm::VoxelGrid grid{ Storm::Vector3{ 4.f, 4.f, 4.f }, k_downCorner, k_voxelEdgeLength };
+
+	// The ray stays inside the voxels of y index 1 while the particle is inside a voxel of y index 2, but the ray passes nearer than the particle radius from its center.
+	constexpr float k_particleRadius = 0.05f;
+	const std::vector<Storm::Vector3> particles{ Storm::Vector3{ 1.7f, 1.02f, 1.2f } };
+	grid.fill(k_voxelEdgeLength, k_voxelShift, particles, k_firstSystemId);
+
+	const Storm::Vector3 origin{ -1.f, 0.98f, 1.2f };
+	const Storm::Vector3 direction{ 1.f, 0.f, 0.f };
+
+	CHECK(traverseVoxelsUnderRaycast(grid, origin, direction, 0.f, 100.f).empty());
+	CHECK(traverseVoxelsUnderRaycast(grid, origin, direction, 0.f, 100.f, k_particleRadius) == std::vector<std::size_t>{ 0 });
+
+	// Same but passing along the outside of the grid.
+	grid.clear();
+	const std::vector<Storm::Vector3> borderParticles{ Storm::Vector3{ 1.7f, 0.02f, 1.2f } };
+	grid.fill(k_voxelEdgeLength, k_voxelShift, borderParticles, k_firstSystemId);
+
+	const Storm::Vector3 outsideOrigin{ -1.f, -0.02f, 1.2f };
+	CHECK(traverseVoxelsUnderRaycast(grid, outsideOrigin, direction, 0.f, 100.f).empty());
+	CHECK(traverseVoxelsUnderRaycast(grid, outsideOrigin, direction, 0.f, 100.f, k_particleRadius) == std::vector<std::size_t>{ 0 });
+}
+
+TEST_CASE("VoxelGrid.RaycastTraversal.InflatedRay.SameThanBruteForce", "[classic]")
+{
+	Storm::VoxelGrid grid{ Storm::Vector3{ 4.f, 4.f, 4.f }, k_downCorner, k_voxelEdgeLength };
+
+	// Put a particle at the center of each voxel, its index being the voxel index.
+	const Storm::Vector3ui &gridBoundary = grid.getGridBoundary();
+	std::vector<Storm::Vector3> voxelCenters(grid.size());
+	for (unsigned int xIndex = 0; xIndex < gridBoundary.x(); ++xIndex)
+	{
+		for (unsigned int yIndex = 0; yIndex < gridBoundary.y(); ++yIndex)
+		{
+			for (unsigned int zIndex = 0; zIndex < gridBoundary.z(); ++zIndex)
+			{
+				voxelCenters[grid.computeRawIndexFromCoordIndex(xIndex, yIndex, zIndex)] = (Storm::Vector3{ static_cast<float>(xIndex), static_cast<float>(yIndex), static_cast<float>(zIndex) } + Storm::Vector3::Constant(0.5f)) * k_voxelEdgeLength;
+			}
+		}
+	}
+
+	grid.fill(k_voxelEdgeLength, k_voxelShift, voxelCenters, k_firstSystemId);
+
+	const auto checkRaycast = [&grid](const Storm::Vector3 &origin, const Storm::Vector3 &direction, const float minDist, const float maxDist, const float rayRadius)
+	{
+		const Storm::Vector3 normalizedDirection = direction.normalized();
+
+		// Each voxel should be visited once, with non decreasing enter distances.
+		bool enterDistOrdered = true;
+		float lastEnterDist = -std::numeric_limits<float>::max();
+		grid.traverseVoxelsUnderRaycast(origin, normalizedDirection, minDist, maxDist, rayRadius, k_voxelEdgeLength, k_voxelShift, [&enterDistOrdered, &lastEnterDist](const Storm::NeighborParticleReferralBundle &, const float voxelEnterDist)
+		{
+			enterDistOrdered = enterDistOrdered && voxelEnterDist >= lastEnterDist;
+			lastEnterDist = voxelEnterDist;
+			return true;
+		});
+		CHECK(enterDistOrdered);
+
+		std::vector<std::size_t> visited = traverseVoxelsUnderRaycast(grid, origin, normalizedDirection, minDist, maxDist, rayRadius);
+		std::sort(std::begin(visited), std::end(visited));
+		CHECK(visited == selectVoxelsNearRaycast(grid, origin, normalizedDirection, minDist, maxDist, rayRadius));
+	};
+
+	for (const float rayRadius : { 0.1f, 0.25f, k_voxelEdgeLength })
+	{
+		// Along an axis, inside the grid.
+		checkRaycast(Storm::Vector3{ 0.1f, 1.3f, 2.2f }, Storm::Vector3{ 1.f, 0.f, 0.f }, 0.f, 100.f, rayRadius);
+		checkRaycast(Storm::Vector3{ 1.3f, 3.9f, 2.2f }, Storm::Vector3{ 0.f, -1.f, 0.f }, 0.f, 100.f, rayRadius);
+
+		// Diagonals, starting outside the grid.
+		checkRaycast(Storm::Vector3{ -1.f, -0.73f, -1.29f }, Storm::Vector3{ 1.f, 0.87f, 1.13f }, 0.f, 100.f, rayRadius);
+		checkRaycast(Storm::Vector3{ 5.f, 0.23f, 3.71f }, Storm::Vector3{ -1.f, 0.31f, -0.17f }, 0.f, 100.f, rayRadius);
+		checkRaycast(Storm::Vector3{ 4.3f, 4.1f, -0.6f }, Storm::Vector3{ -0.9f, -1.f, 0.45f }, 0.f, 100.f, rayRadius);
+
+		// Clipped by the min and max distance.
+		checkRaycast(Storm::Vector3{ 0.1f, 0.2f, 0.3f }, Storm::Vector3{ 0.5f, 0.7f, 0.3f }, 1.1f, 3.4f, rayRadius);
+
+		// Passing along the outside of the grid.
+		checkRaycast(Storm::Vector3{ -1.f, -0.08f, 1.1f }, Storm::Vector3{ 1.f, 0.f, 0.05f }, 0.f, 100.f, rayRadius);
+	}
+}
+
+namespace
+{
+	bool haveSameBundleReferrals(const Storm::NeighborParticleReferralBundle &bundle, const Storm::NeighborParticleReferralBundle &expectedBundle)
+	{
+		return std::equal(std::begin(bundle), std::end(bundle), std::begin(expectedBundle), std::end(expectedBundle), [](const Storm::NeighborParticleReferral &referral, const Storm::NeighborParticleReferral &expectedReferral)
+		{
+			return referral._particleIndex == expectedReferral._particleIndex && referral._systemId == expectedReferral._systemId;
+		});
+	}
+
+	template<bool infiniteDomain>
+	bool haveSameNeighborhood(const Storm::ISpacePartition &partition, const Storm::ISpacePartition &expected, const Storm::Vector3 &position)
+	{
+		const Storm::NeighborParticleReferralBundle* containingBundle;
+		const Storm::NeighborParticleReferralBundle* neighborBundles[Storm::k_neighborLinkedBunkCount];
+		const Storm::NeighborParticleReferralBundle* expectedContainingBundle;
+		const Storm::NeighborParticleReferralBundle* expectedNeighborBundles[Storm::k_neighborLinkedBunkCount];
+
+		// The bundles are views on the thread storage shared by all partitions, so copy the first ones before querying the second partition.
+		Storm::NeighborParticleReferralBundle containingBundleCopy;
+		std::vector<Storm::NeighborParticleReferralBundle> neighborBundleCopies;
+
+		const Storm::OutReflectedModality* reflectModality;
+		if constexpr (infiniteDomain)
+		{
+			partition.getVoxelsDataAtPositionInfinite(k_voxelEdgeLength, k_voxelShift, containingBundle, neighborBundles, position, reflectModality);
+		}
+		else
+		{
+			partition.getVoxelsDataAtPosition(k_voxelEdgeLength, k_voxelShift, containingBundle, neighborBundles, position);
+		}
+
+		containingBundleCopy = *containingBundle;
+		for (const Storm::NeighborParticleReferralBundle*const* neighborBundle = neighborBundles; *neighborBundle != nullptr; ++neighborBundle)
+		{
+			neighborBundleCopies.emplace_back(**neighborBundle);
+		}
+
+		if constexpr (infiniteDomain)
+		{
+			expected.getVoxelsDataAtPositionInfinite(k_voxelEdgeLength, k_voxelShift, expectedContainingBundle, expectedNeighborBundles, position, reflectModality);
+		}
+		else
+		{
+			expected.getVoxelsDataAtPosition(k_voxelEdgeLength, k_voxelShift, expectedContainingBundle, expectedNeighborBundles, position);
+		}
+
+		if (!haveSameBundleReferrals(containingBundleCopy, *expectedContainingBundle))
+		{
+			return false;
+		}
+
+		std::size_t neighborIndex = 0;
+		for (; expectedNeighborBundles[neighborIndex] != nullptr; ++neighborIndex)
+		{
+			if (neighborIndex == neighborBundleCopies.size() || !haveSameBundleReferrals(neighborBundleCopies[neighborIndex], *expectedNeighborBundles[neighborIndex]))
+			{
+				return false;
+			}
+		}
+
+		return neighborIndex == neighborBundleCopies.size();
+	}
+
+	std::size_t countOccupiedVoxels(const Storm::VoxelGrid &grid)
+	{
+		std::size_t occupiedVoxelCount = 0;
+
+		const std::size_t voxelCount = grid.size();
+		for (std::size_t voxelIndex = 0; voxelIndex < voxelCount; ++voxelIndex)
+		{
+			if (!grid.getBundleAt(voxelIndex, 0)->empty())
+			{
+				++occupiedVoxelCount;
+			}
+		}
+
+		return occupiedVoxelCount;
+	}
+}
+
+TEST_CASE("HashedVoxelGrid.SameNeighborhoodThanDense", "[classic]")
+{
+	ParticleGenerator generator;
+
+	std::vector<Storm::Vector3> firstSystem(20000);
+	std::vector<Storm::Vector3> secondSystem(5000);
+	generator.fill(firstSystem);
+	generator.fill(secondSystem);
+
+	Storm::VoxelGrid denseGrid{ k_upCorner, k_downCorner, k_voxelEdgeLength };
+	Storm::HashedVoxelGrid hashedGrid{ k_upCorner, k_downCorner, k_voxelEdgeLength };
+
+	// The queries are only valid once prepareQueries was called, so the update can't start from a partition that was never prepared.
+	hashedGrid.fill(k_voxelEdgeLength, k_voxelShift, firstSystem, k_firstSystemId);
+	CHECK_FALSE(hashedGrid.prepareUpdate(k_voxelEdgeLength, k_voxelShift, firstSystem, k_firstSystemId));
+
+	rebuild(denseGrid, firstSystem, secondSystem);
+	rebuild(hashedGrid, firstSystem, secondSystem);
+
+	CHECK(hashedGrid.getRegisteredSystemIds() == denseGrid.getRegisteredSystemIds());
+
+	const auto haveSameNeighborhoods = [&hashedGrid, &denseGrid](const std::vector<Storm::Vector3> &particles)
+	{
+		// Query at the particles (the domain boundaries are reached too since the particles fill the whole domain), and at empty places.
+		std::vector<Storm::Vector3> queriedPositions = particles;
+		queriedPositions.emplace_back(Storm::Vector3{ 0.f, 0.f, 0.f });
+		queriedPositions.emplace_back(Storm::Vector3{ 19.99f, 19.99f, 19.99f });
+		queriedPositions.emplace_back(Storm::Vector3{ -3.f, 8.f, 25.f });
+
+		bool allSame = true;
+		for (const Storm::Vector3 &position : queriedPositions)
+		{
+			allSame = allSame && haveSameNeighborhood<false>(hashedGrid, denseGrid, position) && haveSameNeighborhood<true>(hashedGrid, denseGrid, position);
+		}
+
+		return allSame;
+	};
+
+	CHECK(haveSameNeighborhoods(firstSystem));
+
+	// The incremental updates should give the same neighborhood than a full rebuild of the dense grid.
+	for (const float movedRatio : { 0.f, 0.001f, 0.05f, 0.5f })
+	{
+		generator.move(firstSystem, movedRatio);
+		generator.move(secondSystem, movedRatio);
+
+		REQUIRE(update(hashedGrid, firstSystem, secondSystem, 1.f));
+		rebuild(denseGrid, firstSystem, secondSystem);
+
+		CHECK(hashedGrid.getOccupiedVoxelCount() == countOccupiedVoxels(denseGrid));
+		CHECK(haveSameNeighborhoods(secondSystem));
+	}
+
+	// Too many moved particles : nothing should change, and a full rebuild is needed.
+	generator.move(firstSystem, 1.f);
+	CHECK_FALSE(update(hashedGrid, firstSystem, secondSystem, 0.1f));
+
+	hashedGrid.clear();
+	CHECK(hashedGrid.getOccupiedVoxelCount() == 0);
+	CHECK(hashedGrid.getRegisteredSystemIds().empty());
+}
+
+// Hidden by default, run it explicitly with the "[benchmark]" tag.
+TEST_CASE("HashedVoxelGrid.SparseScene.Benchmark", "[.][benchmark]")
+{
+	// A tall and mostly empty domain (like a wind tunnel) : the fluid only occupies the bottom 1% of it.
+	constexpr float k_benchmarkVoxelEdgeLength = 0.2f;
+	const Storm::Vector3 domainUpCorner{ 20.f, 500.f, 20.f };
+
+	std::mt19937 randomEngine{ 42 };
+	std::uniform_real_distribution<float> horizontalDistribution{ 0.f, 20.f };
+	std::uniform_real_distribution<float> verticalDistribution{ 0.f, 5.f };
+
+	// Several systems, like a scene with many rigid bodies : the hashed grid is only built once all of them are registered.
+	constexpr unsigned int k_benchmarkSystemCount = 4;
+	std::vector<std::vector<Storm::Vector3>> systems(k_benchmarkSystemCount, std::vector<Storm::Vector3>(125000));
+	for (std::vector<Storm::Vector3> &system : systems)
+	{
+		for (Storm::Vector3 &position : system)
+		{
+			position = Storm::Vector3{ horizontalDistribution(randomEngine), verticalDistribution(randomEngine), horizontalDistribution(randomEngine) };
+		}
+	}
+
+	// The positions after one step : a few particles moved to the next voxel.
+	std::vector<std::vector<Storm::Vector3>> movedSystems = systems;
+	std::uniform_real_distribution<float> ratioDistribution{ 0.f, 1.f };
+	for (std::vector<Storm::Vector3> &system : movedSystems)
+	{
+		for (Storm::Vector3 &position : system)
+		{
+			if (ratioDistribution(randomEngine) < 0.02f)
+			{
+				position.x() = std::min(position.x() + k_benchmarkVoxelEdgeLength, 19.99f);
+			}
+		}
+	}
+
+	const auto benchmark = [&systems, &movedSystems](const char* partitionName, Storm::ISpacePartition &partition)
+	{
+		const auto fillStartTime = std::chrono::high_resolution_clock::now();
+		partition.clear();
+		for (unsigned int systemId = 0; systemId < k_benchmarkSystemCount; ++systemId)
+		{
+			partition.fill(k_benchmarkVoxelEdgeLength, k_voxelShift, systems[systemId], systemId);
+		}
+		partition.prepareQueries();
+		const auto fillEndTime = std::chrono::high_resolution_clock::now();
+
+		// Query the neighborhood of each particle, like a neighborhood search would do.
+		std::size_t neighborCandidateCount = 0;
+		for (const std::vector<Storm::Vector3> &system : systems)
+		{
+			for (const Storm::Vector3 &position : system)
+			{
+				const Storm::NeighborParticleReferralBundle* containingBundle;
+				const Storm::NeighborParticleReferralBundle* neighborBundles[Storm::k_neighborLinkedBunkCount];
+				partition.getVoxelsDataAtPosition(k_benchmarkVoxelEdgeLength, k_voxelShift, containingBundle, neighborBundles, position);
+
+				neighborCandidateCount += containingBundle->size();
+				for (const Storm::NeighborParticleReferralBundle*const* neighborBundle = neighborBundles; *neighborBundle != nullptr; ++neighborBundle)
+				{
+					neighborCandidateCount += (*neighborBundle)->size();
+				}
+			}
+		}
+		const auto queryEndTime = std::chrono::high_resolution_clock::now();
+
+		bool updated = true;
+		for (unsigned int systemId = 0; systemId < k_benchmarkSystemCount; ++systemId)
+		{
+			updated = updated && partition.prepareUpdate(k_benchmarkVoxelEdgeLength, k_voxelShift, movedSystems[systemId], systemId);
+		}
+		updated = updated && partition.applyUpdate(1.f);
+		partition.prepareQueries();
+		const auto updateEndTime = std::chrono::high_resolution_clock::now();
+
+		CHECK(updated);
+
+		std::cout <<
+			partitionName << " : " << partition.getAllocatedMemorySize() / (1024 * 1024) << "MB" <<
+			", fill " << std::chrono::duration<double, std::milli>(fillEndTime - fillStartTime).count() << "ms" <<
+			", neighborhood queries " << std::chrono::duration<double, std::milli>(queryEndTime - fillEndTime).count() << "ms" <<
+			" (" << neighborCandidateCount << " candidates)" <<
+			", incremental update " << std::chrono::duration<double, std::milli>(updateEndTime - queryEndTime).count() << "ms\n";
+
+		return neighborCandidateCount;
+	};
+
+	Storm::VoxelGrid denseGrid{ domainUpCorner, k_downCorner, k_benchmarkVoxelEdgeLength };
+	Storm::HashedVoxelGrid hashedGrid{ domainUpCorner, k_downCorner, k_benchmarkVoxelEdgeLength };
+
+	const std::size_t denseCandidateCount = benchmark("Dense grid", denseGrid);
+	const std::size_t hashedCandidateCount = benchmark("Hashed grid", hashedGrid);
+
+	CHECK(hashedCandidateCount == denseCandidateCount);
+}
+
+namespace
+{
+	using ParticlePair = std::pair<std::size_t, std::size_t>;
+
+	// The pairs of particles closer than radius found by looking only at the particles after the current one inside its voxel, and at all particles of the forward voxels.
+	// Each pair is stored as (smallest index, biggest index), so a pair found twice would appear twice.
+	std::vector<ParticlePair> searchForwardPairs(const Storm::ISpacePartition &partition, const std::vector<Storm::Vector3> &positions, const float radius)
+	{
+		std::vector<ParticlePair> result;
+
+		const float radiusSquared = radius * radius;
+		for (std::size_t particleIndex = 0; particleIndex < positions.size(); ++particleIndex)
+		{
+			const Storm::NeighborParticleReferralBundle* containingBundle;
+			const Storm::NeighborParticleReferralBundle* forwardBundles[Storm::k_neighborLinkedBunkCount];
+			partition.getForwardVoxelsDataAtPosition(k_voxelEdgeLength, k_voxelShift, containingBundle, forwardBundles, positions[particleIndex]);
+
+			const auto addIfNeighbor = [&result, &positions, particleIndex, radiusSquared](const Storm::NeighborParticleReferral &referral)
+			{
+				if ((positions[particleIndex] - positions[referral._particleIndex]).squaredNorm() < radiusSquared)
+				{
+					result.emplace_back(std::min(particleIndex, referral._particleIndex), std::max(particleIndex, referral._particleIndex));
+				}
+			};
+
+			auto referralIter = std::find_if(std::begin(*containingBundle), std::end(*containingBundle), [particleIndex](const Storm::NeighborParticleReferral &referral)
+			{
+				return referral._particleIndex == particleIndex;
+			});
+			if (referralIter != std::end(*containingBundle))
+			{
+				std::for_each(referralIter + 1, std::end(*containingBundle), addIfNeighbor);
+			}
+
+			for (const Storm::NeighborParticleReferralBundle*const* forwardBundle = forwardBundles; *forwardBundle != nullptr; ++forwardBundle)
+			{
+				std::for_each(std::begin(**forwardBundle), std::end(**forwardBundle), addIfNeighbor);
+			}
+		}
+
+		std::sort(std::begin(result), std::end(result));
+		return result;
+	}
+}
+
+TEST_CASE("VoxelGrid.ForwardNeighborhood", "[classic]")
+{
+	// Crowd the particles inside a corner of the domain so there is a lot of neighbors, and the domain boundaries are reached.
+	std::mt19937 randomEngine{ 42 };
+	std::uniform_real_distribution<float> positionDistribution{ 0.f, 3.f };
+
+	std::vector<Storm::Vector3> positions(4000);
+	for (Storm::Vector3 &position : positions)
+	{
+		position = Storm::Vector3{ positionDistribution(randomEngine), positionDistribution(randomEngine), positionDistribution(randomEngine) };
+	}
+
+	const float radius = k_voxelEdgeLength;
+
+	std::vector<ParticlePair> expectedPairs;
+	for (std::size_t particleIndex = 0; particleIndex < positions.size(); ++particleIndex)
+	{
+		for (std::size_t otherPIndex = particleIndex + 1; otherPIndex < positions.size(); ++otherPIndex)
+		{
+			if ((positions[particleIndex] - positions[otherPIndex]).squaredNorm() < radius * radius)
+			{
+				expectedPairs.emplace_back(particleIndex, otherPIndex);
+			}
+		}
+	}
+
+	REQUIRE(!expectedPairs.empty());
+
+	Storm::VoxelGrid denseGrid{ k_upCorner, k_downCorner, k_voxelEdgeLength };
+	Storm::HashedVoxelGrid hashedGrid{ k_upCorner, k_downCorner, k_voxelEdgeLength };
+
+	for (Storm::ISpacePartition* partition : { static_cast<Storm::ISpacePartition*>(&denseGrid), static_cast<Storm::ISpacePartition*>(&hashedGrid) })
+	{
+		partition->fill(k_voxelEdgeLength, k_voxelShift, positions, k_firstSystemId);
+		partition->prepareQueries();
+
+		// Each pair should be found exactly once.
+		CHECK(searchForwardPairs(*partition, positions, radius) == expectedPairs);
+	}
+}
+
+TEST_CASE("VoxelGrid.InsideBoxTraversal", "[classic]")
+{
+	std::vector<Storm::Vector3> positions(20000);
+	ParticleGenerator{}.fill(positions);
+
+	Storm::VoxelGrid denseGrid{ k_upCorner, k_downCorner, k_voxelEdgeLength };
+	Storm::HashedVoxelGrid hashedGrid{ k_upCorner, k_downCorner, k_voxelEdgeLength };
+
+	const auto checkBox = [&positions](const Storm::ISpacePartition &partition, const Storm::Vector3 &minCorner, const Storm::Vector3 &maxCorner)
+	{
+		std::vector<std::size_t> visitedParticles;
+		partition.traverseVoxelsInsideBox(minCorner, maxCorner, k_voxelEdgeLength, k_voxelShift, [&visitedParticles](const Storm::NeighborParticleReferralBundle &bundle)
+		{
+			CHECK(!bundle.empty());
+			for (const Storm::NeighborParticleReferral &referral : bundle)
+			{
+				visitedParticles.emplace_back(referral._particleIndex);
+			}
+		});
+
+		// Each voxel is visited once, therefore each particle too.
+		std::sort(std::begin(visitedParticles), std::end(visitedParticles));
+		CHECK(std::adjacent_find(std::begin(visitedParticles), std::end(visitedParticles)) == std::end(visitedParticles));
+
+		// All particles inside the box should have been visited, and the others should be less than one voxel away from the box.
+		for (std::size_t particleIndex = 0; particleIndex < positions.size(); ++particleIndex)
+		{
+			const Storm::Vector3 &position = positions[particleIndex];
+			const bool visited = std::binary_search(std::begin(visitedParticles), std::end(visitedParticles), particleIndex);
+			if ((position.array() >= minCorner.array()).all() && (position.array() <= maxCorner.array()).all())
+			{
+				CHECK(visited);
+			}
+			else if (visited)
+			{
+				CHECK((position.array() > (minCorner.array() - k_voxelEdgeLength)).all());
+				CHECK((position.array() < (maxCorner.array() + k_voxelEdgeLength)).all());
+			}
+		}
+
+		return visitedParticles.size();
+	};
+
+	for (Storm::ISpacePartition* partition : { static_cast<Storm::ISpacePartition*>(&denseGrid), static_cast<Storm::ISpacePartition*>(&hashedGrid) })
+	{
+		partition->fill(k_voxelEdgeLength, k_voxelShift, positions, k_firstSystemId);
+		partition->prepareQueries();
+
+		// Inside the domain, not aligned on the voxels.
+		CHECK(checkBox(*partition, Storm::Vector3{ 3.1f, 7.27f, 11.6f }, Storm::Vector3{ 5.8f, 9.03f, 12.9f }) != 0);
+
+		// Crossing the domain boundaries : only the part inside the domain is visited.
+		CHECK(checkBox(*partition, Storm::Vector3{ -2.f, 18.3f, -0.4f }, Storm::Vector3{ 1.3f, 25.f, 2.1f }) != 0);
+
+		// The whole domain.
+		CHECK(checkBox(*partition, k_downCorner - Storm::Vector3::Ones(), k_upCorner + Storm::Vector3::Ones()) == positions.size());
+
+		// Outside the domain.
+		CHECK(checkBox(*partition, Storm::Vector3{ -5.f, 2.f, 2.f }, Storm::Vector3{ -1.f, 4.f, 4.f }) == 0);
+		CHECK(checkBox(*partition, Storm::Vector3{ 2.f, 21.f, 2.f }, Storm::Vector3{ 4.f, 30.f, 4.f }) == 0);
+	}
+}
@@ -9,6 +9,7 @@
 #include "SceneConfig.h"
 #include "SceneRigidBodyConfig.h"
 #include "SceneSmokeEmitterConfig.h"
+#include "SceneOpenBoundaryConfig.h"
 
 #include "ConfigReadParam.h"
 
@@ -283,6 +284,10 @@ void Storm::ConfigManager::initialize_Implementation(int argc, const char* argv[
 			{
 				Storm::throwException<Storm::Exception>("Record fps wasn't set while we should be recording. We should always set one!");
 			}
+			else if (!sceneConfig._openBoundariesConfig.empty())
+			{
+				Storm::throwException<Storm::Exception>("Open boundaries cannot be used while recording since they change the fluid particle count, and a record expects it to remain constant!");
+			}
 
 			const std::filesystem::path recordFilePathFs{ sceneRecordConfig._recordFilePath };
 			std::filesystem::remove_all(recordFilePathFs);
@@ -555,6 +560,11 @@ const Storm::SceneSmokeEmitterConfig& Storm::ConfigManager::getSceneSmokeEmitter
 	}
 }
 
+const std::vector<Storm::SceneOpenBoundaryConfig>& Storm::ConfigManager::getSceneOpenBoundariesConfig() const
+{
+	return _sceneConfigHolder.getConfig()._openBoundariesConfig;
+}
+
 const Storm::SceneCageConfig* Storm::ConfigManager::getSceneOptionalCageConfig() const
 {
 	return _sceneConfigHolder.getConfig()._optionalCageConfig.get();
@@ -62,6 +62,7 @@ namespace Storm
 		const Storm::SceneScriptConfig& getSceneScriptConfig() const final override;
 		const std::vector<Storm::SceneSmokeEmitterConfig>& getSceneSmokeEmittersConfig() const final override;
 		const Storm::SceneSmokeEmitterConfig& getSceneSmokeEmitter(unsigned int emitterId) const final override;
+		const std::vector<Storm::SceneOpenBoundaryConfig>& getSceneOpenBoundariesConfig() const final override;
 
 		const Storm::SceneCageConfig* getSceneOptionalCageConfig() const final override;
 
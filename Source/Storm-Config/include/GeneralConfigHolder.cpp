@@ -238,7 +238,8 @@ bool Storm::GeneralConfigHolder::read(const std::string &generalConfigFilePathSt
 						for (const auto &profileDataXml : debugXmlElement.second)
 						{
 							if (
-								!Storm::XmlReader::handleXml(profileDataXml, "profileSimulationSpeed", generalDebugConfig._profileSimulationSpeed)
+								!Storm::XmlReader::handleXml(profileDataXml, "profileSimulationSpeed", generalDebugConfig._profileSimulationSpeed) &&
+								!Storm::XmlReader::handleXml(profileDataXml, "profileParallelLoops", generalDebugConfig._profileParallelLoops)
 								)
 							{
 								LOG_ERROR << profileDataXml.first << " (inside General.Debug.Profile) is unknown, therefore it cannot be handled";
@@ -418,7 +419,11 @@ bool Storm::GeneralConfigHolder::read(const std::string &generalConfigFilePathSt
 				{
 					if (
 						!Storm::XmlReader::handleXml(simulationXmlElement, "allowNoFluid", generalSimulationConfig._allowNoFluid) &&
-						!Storm::XmlReader::handleXml(simulationXmlElement, "stateRefreshFrameCount", generalSimulationConfig._stateRefreshFrameCount)
+						!Storm::XmlReader::handleXml(simulationXmlElement, "stateRefreshFrameCount", generalSimulationConfig._stateRefreshFrameCount) &&
+						!Storm::XmlReader::handleXml(simulationXmlElement, "useWorkerPool", generalSimulationConfig._useParallelWorkerPool) &&
+						!Storm::XmlReader::handleXml(simulationXmlElement, "workerCount", generalSimulationConfig._parallelWorkerCount) &&
+						!Storm::XmlReader::handleXml(simulationXmlElement, "pinWorkers", generalSimulationConfig._pinParallelWorkers) &&
+						!Storm::XmlReader::handleXml(simulationXmlElement, "parallelGrainSize", generalSimulationConfig._parallelGrainSize)
 						)
 					{
 						LOG_ERROR << simulationXmlElement.first << " (inside General.Simulation) is unknown, therefore it cannot be handled";
@@ -437,6 +442,11 @@ bool Storm::GeneralConfigHolder::read(const std::string &generalConfigFilePathSt
 						"And we won't execute some checks and won't be advised about why this state was reached."
 						;
 				}
+
+				if (generalSimulationConfig._parallelWorkerCount > 1024)
+				{
+					Storm::throwException<Storm::Exception>("Parallel worker count is too high (" + std::to_string(generalSimulationConfig._parallelWorkerCount) + "), it shouldn't exceed 1024!");
+				}
 			}
 
 			return true;
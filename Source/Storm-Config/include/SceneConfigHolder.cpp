@@ -16,8 +16,10 @@
 #include "SceneScriptConfig.h"
 #include "SceneCageConfig.h"
 #include "SceneSmokeEmitterConfig.h"
+#include "SceneOpenBoundaryConfig.h"
 #include "SceneFluidCustomDFSPHConfig.h"
 #include "SceneFluidCustomIISPHConfig.h"
+#include "SceneFluidCustomCGSPHConfig.h"
 #include "SceneFluidCustomPCISPHConfig.h"
 
 #include "GeneralConfig.h"
@@ -37,12 +39,16 @@
 #include "VolumeComputationTechnique.h"
 #include "ViscosityMethod.h"
 #include "ParticleRemovalMode.h"
+#include "SpacePartitionMode.h"
+#include "OpenBoundaryType.h"
 
 #include "RecordMode.h"
+#include "RecordChannel.h"
 
 #include "ColorChecker.h"
 #include "XmlReader.h"
 #include "BitField.h"
+#include "StringAlgo.h"
 
 #pragma warning(push)
 #pragma warning(disable:4702)
@@ -192,6 +198,10 @@ namespace
 		{
 			return Storm::SimulationMode::DFSPH;
 		}
+		else if (inOutSimulModeStr == "CGSPH")
+		{
+			return Storm::SimulationMode::CGSPH;
+		}
 		else
 		{
 			Storm::throwException<Storm::Exception>("Simulation mode value is unknown : '" + inOutSimulModeStr + "'");
@@ -215,6 +225,23 @@ namespace
 		}
 	}
 
+	Storm::SpacePartitionMode parseSpacePartitionMode(std::string spacePartitionModeStr)
+	{
+		boost::algorithm::to_lower(spacePartitionModeStr);
+		if (spacePartitionModeStr == "dense")
+		{
+			return Storm::SpacePartitionMode::Dense;
+		}
+		else if (spacePartitionModeStr == "hashed")
+		{
+			return Storm::SpacePartitionMode::Hashed;
+		}
+		else
+		{
+			Storm::throwException<Storm::Exception>("Space partition mode value is unknown : '" + spacePartitionModeStr + "'");
+		}
+	}
+
 	Storm::FluidParticleLoadDenseMode parseLoadDenseMode(std::string loadModeStr)
 	{
 		boost::algorithm::to_lower(loadModeStr);
@@ -334,6 +361,23 @@ if (blowerTypeStr == BlowerTypeXmlName) return Storm::BlowerType::BlowerTypeName
 		}
 	}
 
+	Storm::OpenBoundaryType parseOpenBoundaryType(std::string openBoundaryTypeStr)
+	{
+		boost::algorithm::to_lower(openBoundaryTypeStr);
+		if (openBoundaryTypeStr == "inflow")
+		{
+			return Storm::OpenBoundaryType::Inflow;
+		}
+		else if (openBoundaryTypeStr == "outflow")
+		{
+			return Storm::OpenBoundaryType::Outflow;
+		}
+		else
+		{
+			Storm::throwException<Storm::Exception>("Open boundary type value is unknown : '" + openBoundaryTypeStr + "'");
+		}
+	}
+
 	Storm::ConstraintType parseConstraintType(std::string constraintTypeStr)
 	{
 		boost::algorithm::to_lower(constraintTypeStr);
@@ -351,6 +395,55 @@ if (blowerTypeStr == BlowerTypeXmlName) return Storm::BlowerType::BlowerTypeName
 		}
 	}
 
+	Storm::RecordChannel parseRecordChannels(std::string recordChannelsStr)
+	{
+		constexpr std::pair<std::string_view, Storm::RecordChannel> k_channelNames[] =
+		{
+			{ "all", Storm::RecordChannel::All },
+			{ "positions", Storm::RecordChannel::Positions },
+			{ "velocities", Storm::RecordChannel::Velocities },
+			{ "forces", Storm::RecordChannel::Forces },
+			{ "densities", Storm::RecordChannel::Densities },
+			{ "pressures", Storm::RecordChannel::Pressures },
+			{ "volumes", Storm::RecordChannel::Volumes },
+			{ "normals", Storm::RecordChannel::Normals },
+			{ "pressureforces", Storm::RecordChannel::PressureForces },
+			{ "viscosityforces", Storm::RecordChannel::ViscosityForces },
+			{ "dragforces", Storm::RecordChannel::DragForces },
+			{ "dynamicpressureforces", Storm::RecordChannel::DynamicPressureQForces },
+			{ "nostickforces", Storm::RecordChannel::NoStickForces },
+			{ "coandaforces", Storm::RecordChannel::CoandaForces },
+			{ "intermediarydensitypressureforces", Storm::RecordChannel::IntermediaryDensityPressureForces },
+			{ "intermediaryvelocitypressureforces", Storm::RecordChannel::IntermediaryVelocityPressureForces },
+			{ "blowerforces", Storm::RecordChannel::BlowerForces },
+		};
+
+		boost::algorithm::to_lower(recordChannelsStr);
+
+		std::vector<std::string> channelNames;
+		Storm::StringAlgo::split(channelNames, recordChannelsStr, Storm::StringAlgo::makeSplitPredicate<std::string>(',', ' ', '\t'));
+
+		using RecordChannelUnderlyingNative = Storm::EnumUnderlyingNative<Storm::RecordChannel>;
+
+		RecordChannelUnderlyingNative result = 0;
+		for (const std::string &channelName : channelNames)
+		{
+			const auto found = std::find_if(std::begin(k_channelNames), std::end(k_channelNames), [&channelName](const auto &channelNamePair)
+			{
+				return channelNamePair.first == channelName;
+			});
+
+			if (found == std::end(k_channelNames))
+			{
+				Storm::throwException<Storm::Exception>("Record channel value is unknown : '" + channelName + "'");
+			}
+
+			result |= static_cast<RecordChannelUnderlyingNative>(found->second);
+		}
+
+		return static_cast<Storm::RecordChannel>(result);
+	}
+
 	std::unique_ptr<Storm::GeometryConfig> parseGeometryType(const boost::property_tree::ptree &tree)
 	{
 		std::unique_ptr<Storm::GeometryConfig> result = std::make_unique<Storm::GeometryConfig>();
@@ -575,6 +668,17 @@ void Storm::SceneConfigHolder::read(const std::string &sceneConfigFilePathStr, c
 			!Storm::XmlReader::handleXml(generalXmlElement, "fps", sceneSimulationConfig._expectedFps) &&
 			!Storm::XmlReader::handleXml(generalXmlElement, "midUpdateViscosity", sceneSimulationConfig._midUpdateViscosity) &&
 			!Storm::XmlReader::handleXml(generalXmlElement, "neighborCheckStep", sceneSimulationConfig._recomputeNeighborhoodStep) &&
+			!Storm::XmlReader::handleXml(generalXmlElement, "neighborSkinCoeff", sceneSimulationConfig._neighborhoodSkinCoeff) &&
+			!Storm::XmlReader::handleXml(generalXmlElement, "incrementalPartitionThreshold", sceneSimulationConfig._incrementalPartitionThreshold) &&
+			!Storm::XmlReader::handleXml(generalXmlElement, "spacePartition", sceneSimulationConfig._spacePartitionMode, parseSpacePartitionMode) &&
+			!Storm::XmlReader::handleXml(generalXmlElement, "cacheStaticVolumes", sceneSimulationConfig._cacheStaticVolumes) &&
+			!Storm::XmlReader::handleXml(generalXmlElement, "symmetricNeighborSearch", sceneSimulationConfig._symmetricNeighborSearch) &&
+			!Storm::XmlReader::handleXml(generalXmlElement, "fluidSleepingStepCount", sceneSimulationConfig._fluidSleepingStepCount) &&
+			!Storm::XmlReader::handleXml(generalXmlElement, "fluidSleepingVelocityThreshold", sceneSimulationConfig._fluidSleepingVelocityThreshold) &&
+			!Storm::XmlReader::handleXml(generalXmlElement, "fluidSleepingDensityErrorThreshold", sceneSimulationConfig._fluidSleepingDensityErrorThreshold) &&
+			!Storm::XmlReader::handleXml(generalXmlElement, "fluidSleepingAccelerationThreshold", sceneSimulationConfig._fluidSleepingAccelerationThreshold) &&
+			!Storm::XmlReader::handleXml(generalXmlElement, "particleReorderStep", sceneSimulationConfig._particleReorderingStep) &&
+			!Storm::XmlReader::handleXml(generalXmlElement, "particleReorderLocalityThreshold", sceneSimulationConfig._particleReorderingLocalityThreshold) &&
 			!Storm::XmlReader::handleXml(generalXmlElement, "simulationNoWait", sceneSimulationConfig._simulationNoWait) &&
 			!Storm::XmlReader::handleXml(generalXmlElement, "particleRadius", sceneSimulationConfig._particleRadius) &&
 			!Storm::XmlReader::handleXml(generalXmlElement, "endPhysicsTime", sceneSimulationConfig._endSimulationPhysicsTimeInSeconds) &&
@@ -584,6 +688,7 @@ void Storm::SceneConfigHolder::read(const std::string &sceneConfigFilePathStr, c
 			!Storm::XmlReader::handleXml(generalXmlElement, "fluidParticleRemovalMode", sceneSimulationConfig._fluidParticleRemovalMode, parseParticleRemovalMode) &&
 			!Storm::XmlReader::handleXml(generalXmlElement, "startFixRigidBodies", sceneSimulationConfig._fixRigidBodyAtStartTime) &&
 			!Storm::XmlReader::handleXml(generalXmlElement, "freeRbAtTime", sceneSimulationConfig._freeRbAtPhysicsTime) &&
+			!Storm::XmlReader::handleXml(generalXmlElement, "applyRbForcesPerParticle", sceneSimulationConfig._applyRbForcesPerParticle) &&
 			!Storm::XmlReader::handleXml(generalXmlElement, "noStickConstraint", sceneSimulationConfig._noStickConstraint) &&
 			!Storm::XmlReader::handleXml(generalXmlElement, "useCoandaEffect", sceneSimulationConfig._useCoandaEffect) &&
 			!Storm::XmlReader::handleXml(generalXmlElement, "useCoendaEffect", sceneSimulationConfig._useCoandaEffect) && // legacy
@@ -618,6 +723,26 @@ void Storm::SceneConfigHolder::read(const std::string &sceneConfigFilePathStr, c
 	{
 		Storm::throwException<Storm::Exception>("neighborCheckStep is equal to 0 which isn't allowed (we must recompute neighborhood at least one time)!");
 	}
+	else if (sceneSimulationConfig._neighborhoodSkinCoeff < 0.f)
+	{
+		Storm::throwException<Storm::Exception>("neighborSkinCoeff shouldn't be below 0 (value is " + std::to_string(sceneSimulationConfig._neighborhoodSkinCoeff) + ")!");
+	}
+	else if (sceneSimulationConfig._incrementalPartitionThreshold < 0.f || sceneSimulationConfig._incrementalPartitionThreshold > 1.f)
+	{
+		Storm::throwException<Storm::Exception>("incrementalPartitionThreshold should be between 0 and 1 (value is " + std::to_string(sceneSimulationConfig._incrementalPartitionThreshold) + ")!");
+	}
+	else if (sceneSimulationConfig._fluidSleepingStepCount > std::numeric_limits<uint16_t>::max())
+	{
+		Storm::throwException<Storm::Exception>("fluidSleepingStepCount shouldn't be greater than " + std::to_string(std::numeric_limits<uint16_t>::max()) + " (value is " + std::to_string(sceneSimulationConfig._fluidSleepingStepCount) + ")!");
+	}
+	else if (sceneSimulationConfig._fluidSleepingVelocityThreshold < 0.f || sceneSimulationConfig._fluidSleepingDensityErrorThreshold < 0.f || sceneSimulationConfig._fluidSleepingAccelerationThreshold < 0.f)
+	{
+		Storm::throwException<Storm::Exception>("The fluid sleeping thresholds shouldn't be below 0 (velocity is " + std::to_string(sceneSimulationConfig._fluidSleepingVelocityThreshold) + ", density error is " + std::to_string(sceneSimulationConfig._fluidSleepingDensityErrorThreshold) + " and acceleration is " + std::to_string(sceneSimulationConfig._fluidSleepingAccelerationThreshold) + ")!");
+	}
+	else if (sceneSimulationConfig._particleReorderingLocalityThreshold < 0.f)
+	{
+		Storm::throwException<Storm::Exception>("particleReorderLocalityThreshold shouldn't be below 0 (value is " + std::to_string(sceneSimulationConfig._particleReorderingLocalityThreshold) + ")!");
+	}
 	else if (sceneSimulationConfig._endSimulationPhysicsTimeInSeconds != -1.f && sceneSimulationConfig._endSimulationPhysicsTimeInSeconds <= 0.f)
 	{
 		Storm::throwException<Storm::Exception>("end simulation time was set to a negative or zero time (" + std::to_string(sceneSimulationConfig._endSimulationPhysicsTimeInSeconds) + "). It isn't allowed!");
@@ -782,7 +907,12 @@ void Storm::SceneConfigHolder::read(const std::string &sceneConfigFilePathStr, c
 				!Storm::XmlReader::handleXml(recordXmlElement, "recordFps", recordConfig._recordFps) &&
 				!Storm::XmlReader::handleXml(recordXmlElement, "recordFile", recordConfig._recordFilePath) &&
 				!Storm::XmlReader::handleXml(recordXmlElement, "replayRealTime", recordConfig._replayRealTime) &&
-				!Storm::XmlReader::handleXml(recordXmlElement, "leanStartJump", recordConfig._leanStartJump)
+				!Storm::XmlReader::handleXml(recordXmlElement, "leanStartJump", recordConfig._leanStartJump) &&
+				!Storm::XmlReader::handleXml(recordXmlElement, "writeBufferSize", recordConfig._writeBufferSizeInKb) &&
+				!Storm::XmlReader::handleXml(recordXmlElement, "compress", recordConfig._compressRecord) &&
+				!Storm::XmlReader::handleXml(recordXmlElement, "positionPrecision", recordConfig._positionPrecision) &&
+				!Storm::XmlReader::handleXml(recordXmlElement, "keyFrameInterval", recordConfig._keyFrameInterval) &&
+				!Storm::XmlReader::handleXml(recordXmlElement, "channels", recordConfig._recordedChannels, parseRecordChannels)
 				)
 			{
 				LOG_ERROR << "tag '" << recordXmlElement.first << "' (inside Scene.Record) is unknown, therefore it cannot be handled";
@@ -793,7 +923,20 @@ void Storm::SceneConfigHolder::read(const std::string &sceneConfigFilePathStr, c
 		{
 			Storm::throwException<Storm::Exception>("Record fps should remain unset or should be a positive value (currently " + std::to_string(recordConfig._recordFps) + ")");
 		}
-		else if (recordConfig._leanStartJump == 0)
+		else if (recordConfig._positionPrecision < 0.f)
+		{
+			Storm::throwException<Storm::Exception>("Record position precision cannot be negative (currently " + std::to_string(recordConfig._positionPrecision) + ")");
+		}
+		else if (recordConfig._keyFrameInterval == 0)
+		{
+			Storm::throwException<Storm::Exception>("Record key frame interval should be strictly positive!");
+		}
+		else if (!STORM_IS_BIT_ENABLED(recordConfig._recordedChannels, Storm::RecordChannel::Positions))
+		{
+			Storm::throwException<Storm::Exception>("Record channels should contain the positions, we cannot replay anything without them!");
+		}
+
+		if (recordConfig._leanStartJump == 0)
 		{
 			recordConfig._leanStartJump = 1;
 		}
@@ -926,6 +1069,10 @@ void Storm::SceneConfigHolder::read(const std::string &sceneConfigFilePathStr, c
 		fluidConfig._customSimulationSettings = std::make_unique<Storm::SceneFluidCustomIISPHConfig>();
 		break;
 
+	case Storm::SimulationMode::CGSPH:
+		fluidConfig._customSimulationSettings = std::make_unique<Storm::SceneFluidCustomCGSPHConfig>();
+		break;
+
 	case Storm::SimulationMode::WCSPH:
 	default:
 		fluidConfig._customSimulationSettings = std::make_unique<Storm::SceneFluidDefaultCustomConfig>();
@@ -979,6 +1126,7 @@ void Storm::SceneConfigHolder::read(const std::string &sceneConfigFilePathStr, c
 						!Storm::XmlReader::handleXml(fluidParticleCustomSimulConfigXml, "enableThresholdDensity", fluidDfsphConfig._enableThresholdDensity) &&
 						!Storm::XmlReader::handleXml(fluidParticleCustomSimulConfigXml, "useRotationFix", fluidDfsphConfig._useFixRotation) &&
 						!Storm::XmlReader::handleXml(fluidParticleCustomSimulConfigXml, "enableDensitySolve", fluidDfsphConfig._enableDensitySolve) &&
+						!Storm::XmlReader::handleXml(fluidParticleCustomSimulConfigXml, "enableWarmStart", fluidDfsphConfig._enableWarmStart) &&
 						!Storm::XmlReader::handleXml(fluidParticleCustomSimulConfigXml, "useBernouilliPrinciple", fluidDfsphConfig._useBernoulliPrinciple) &&
 						!Storm::XmlReader::handleXml(fluidParticleCustomSimulConfigXml, "neighborThresholdDensity", fluidDfsphConfig._neighborThresholdDensity) &&
 						!Storm::XmlReader::handleXml(fluidParticleCustomSimulConfigXml, "minPredictIteration", fluidDfsphConfig._minPredictIteration) &&
@@ -1024,7 +1172,8 @@ void Storm::SceneConfigHolder::read(const std::string &sceneConfigFilePathStr, c
 					if (
 						!Storm::XmlReader::handleXml(fluidParticleCustomSimulConfigXml, "minPredictIteration", fluidIisphConfig._minPredictIteration) &&
 						!Storm::XmlReader::handleXml(fluidParticleCustomSimulConfigXml, "maxPredictIteration", fluidIisphConfig._maxPredictIteration) &&
-						!Storm::XmlReader::handleXml(fluidParticleCustomSimulConfigXml, "maxError", fluidIisphConfig._maxError)
+						!Storm::XmlReader::handleXml(fluidParticleCustomSimulConfigXml, "maxError", fluidIisphConfig._maxError) &&
+						!Storm::XmlReader::handleXml(fluidParticleCustomSimulConfigXml, "enableWarmStart", fluidIisphConfig._enableWarmStart)
 						)
 					{
 						LOG_ERROR << "tag '" << fluidParticleCustomSimulConfigXml.first << "' (inside Scene.Fluid.IISPH) is unknown, therefore it cannot be handled";
@@ -1044,6 +1193,34 @@ void Storm::SceneConfigHolder::read(const std::string &sceneConfigFilePathStr, c
 					Storm::throwException<Storm::Exception>("Max prediction iteration shouldn't be equal to 0 (we should at least compute the iteration one time!");
 				}
 			}
+			else if (sceneSimulationConfig._simulationMode == Storm::SimulationMode::CGSPH && fluidXmlElement.first == "CGSPH")
+			{
+				Storm::SceneFluidCustomCGSPHConfig &fluidCgsphConfig = static_cast<Storm::SceneFluidCustomCGSPHConfig &>(*fluidConfig._customSimulationSettings);  // NOLINT(cppcoreguidelines-pro-type-static-cast-downcast)
+				for (const auto &fluidParticleCustomSimulConfigXml : fluidXmlElement.second)
+				{
+					if (
+						!Storm::XmlReader::handleXml(fluidParticleCustomSimulConfigXml, "minPredictIteration", fluidCgsphConfig._minPredictIteration) &&
+						!Storm::XmlReader::handleXml(fluidParticleCustomSimulConfigXml, "maxPredictIteration", fluidCgsphConfig._maxPredictIteration) &&
+						!Storm::XmlReader::handleXml(fluidParticleCustomSimulConfigXml, "maxError", fluidCgsphConfig._maxError)
+						)
+					{
+						LOG_ERROR << "tag '" << fluidParticleCustomSimulConfigXml.first << "' (inside Scene.Fluid.CGSPH) is unknown, therefore it cannot be handled";
+					}
+				}
+
+				if (fluidCgsphConfig._maxError <= 0.f)
+				{
+					Storm::throwException<Storm::Exception>("Max solver error cannot be negative or equal to 0.f!");
+				}
+				else if (fluidCgsphConfig._minPredictIteration > fluidCgsphConfig._maxPredictIteration)
+				{
+					Storm::throwException<Storm::Exception>("Max prediction iteration (" + std::to_string(fluidCgsphConfig._maxPredictIteration) + ") should be greater or equal than min prediction iter (" + std::to_string(fluidCgsphConfig._minPredictIteration) + ")!");
+				}
+				else if (fluidCgsphConfig._maxPredictIteration == 0)
+				{
+					Storm::throwException<Storm::Exception>("Max prediction iteration shouldn't be equal to 0 (we should at least compute the iteration one time!");
+				}
+			}
 			else if (sceneSimulationConfig._simulationMode == Storm::SimulationMode::PCISPH && fluidXmlElement.first == "PCISPH")
 			{
 				Storm::SceneFluidCustomPCISPHConfig &fluidPcisphConfig = static_cast<Storm::SceneFluidCustomPCISPHConfig &>(*fluidConfig._customSimulationSettings);  // NOLINT(cppcoreguidelines-pro-type-static-cast-downcast)
@@ -1872,6 +2049,63 @@ void Storm::SceneConfigHolder::read(const std::string &sceneConfigFilePathStr, c
 		}
 	});
 
+	/* Open Boundaries */
+	auto &openBoundariesConfigArray = _sceneConfig->_openBoundariesConfig;
+	Storm::XmlReader::readDataInList(srcTree, "OpenBoundaries", "OpenBoundary", openBoundariesConfigArray,
+		[](const auto &openBoundaryConfigXml, Storm::SceneOpenBoundaryConfig &openBoundaryConfig)
+	{
+		return
+			Storm::XmlReader::handleXml(openBoundaryConfigXml, "id", openBoundaryConfig._openBoundaryId) ||
+			Storm::XmlReader::handleXml(openBoundaryConfigXml, "type", openBoundaryConfig._type, parseOpenBoundaryType) ||
+			Storm::XmlReader::handleXml(openBoundaryConfigXml, "boxMin", openBoundaryConfig._boxMin, parseVector3Element) ||
+			Storm::XmlReader::handleXml(openBoundaryConfigXml, "boxMax", openBoundaryConfig._boxMax, parseVector3Element) ||
+			Storm::XmlReader::handleXml(openBoundaryConfigXml, "velocity", openBoundaryConfig._velocity, parseVector3Element) ||
+			Storm::XmlReader::handleXml(openBoundaryConfigXml, "reservedLayerCount", openBoundaryConfig._reservedLayerCount)
+			;
+	},
+		[&openBoundariesConfigArray](Storm::SceneOpenBoundaryConfig &openBoundaryConfig)
+	{
+		if (openBoundaryConfig._openBoundaryId == std::numeric_limits<decltype(openBoundaryConfig._openBoundaryId)>::max())
+		{
+			Storm::throwException<Storm::Exception>("Open boundary id should be set using 'id' tag!");
+		}
+
+		if (std::any_of(std::begin(openBoundariesConfigArray), std::end(openBoundariesConfigArray), [&openBoundaryConfig](const auto &registeredOpenBoundary)
+		{
+			return registeredOpenBoundary._openBoundaryId == openBoundaryConfig._openBoundaryId && &registeredOpenBoundary != &openBoundaryConfig;
+		}))
+		{
+			Storm::throwException<Storm::Exception>("Open boundary with id " + std::to_string(openBoundaryConfig._openBoundaryId) + " shares the same id than an already registered open boundary. It is forbidden!");
+		}
+
+		if (openBoundaryConfig._type == Storm::OpenBoundaryType::None)
+		{
+			Storm::throwException<Storm::Exception>("Open boundary with id " + std::to_string(openBoundaryConfig._openBoundaryId) + " should have defined a type, this is mandatory!");
+		}
+
+		if (openBoundaryConfig._boxMin.x() >= openBoundaryConfig._boxMax.x() || openBoundaryConfig._boxMin.y() >= openBoundaryConfig._boxMax.y() || openBoundaryConfig._boxMin.z() >= openBoundaryConfig._boxMax.z())
+		{
+			Storm::throwException<Storm::Exception>(
+				"No components of the open boundary " + std::to_string(openBoundaryConfig._openBoundaryId) + " box min should be greater or equal than box max\n"
+				"=> Box min : " + Storm::toStdString(openBoundaryConfig._boxMin) + "\n"
+				"=> Box max : " + Storm::toStdString(openBoundaryConfig._boxMax)
+			);
+		}
+
+		if (openBoundaryConfig._type == Storm::OpenBoundaryType::Inflow)
+		{
+			const int nonZeroVelocityAxisCount =
+				static_cast<int>(openBoundaryConfig._velocity.x() != 0.f) +
+				static_cast<int>(openBoundaryConfig._velocity.y() != 0.f) +
+				static_cast<int>(openBoundaryConfig._velocity.z() != 0.f);
+
+			if (nonZeroVelocityAxisCount != 1)
+			{
+				Storm::throwException<Storm::Exception>("Inflow open boundary with id " + std::to_string(openBoundaryConfig._openBoundaryId) + " velocity should be non zero and aligned to one axis (value was " + Storm::toStdString(openBoundaryConfig._velocity) + ")!");
+			}
+		}
+	});
+
 	/*End init : the automatic values.*/
 	sceneSimulationConfig._applyDragEffect =
 		fluidConfig._uniformDragCoefficient > 0.f ||
@@ -0,0 +1,558 @@
+#include "ChannelCodec.h"
+
+
+namespace
+{
+	enum class PlaneMode : uint8_t
+	{
+		Raw,
+		Constant,
+		Rans,
+	};
+
+	constexpr std::size_t k_planeCount = sizeof(uint32_t);
+	constexpr std::size_t k_symbolCount = 256;
+
+	// rANS with a 32 bits state and a byte wise renormalization (see "Asymmetric numeral systems" from Jarek Duda, and Fabian Giesen's rANS implementation).
+	constexpr uint32_t k_probabilityBits = 12;
+	constexpr uint32_t k_probabilityScale = 1 << k_probabilityBits;
+	constexpr uint32_t k_ransLowBound = 1 << 23;
+
+	// Even and odd symbols are coded with their own state, so the decoding of one doesn't wait for the other.
+	constexpr std::size_t k_ransStateCount = 2;
+
+	struct RansEncodeSymbol
+	{
+	public:
+		void init(const uint32_t start, const uint32_t freq)
+		{
+			_maxState = ((k_ransLowBound >> k_probabilityBits) << 8) * freq;
+			_complementFreq = k_probabilityScale - freq;
+
+			// The division by the frequency is replaced by a multiplication by its reciprocal.
+			if (freq < 2)
+			{
+				_reciprocalFreq = ~0u;
+				_reciprocalShift = 0;
+				_bias = start + k_probabilityScale - 1;
+			}
+			else
+			{
+				uint32_t shift = 0;
+				while (freq > (1u << shift))
+				{
+					++shift;
+				}
+
+				_reciprocalFreq = static_cast<uint32_t>(((static_cast<uint64_t>(1) << (shift + 31)) + freq - 1) / freq);
+				_reciprocalShift = shift - 1;
+				_bias = start;
+			}
+		}
+
+	public:
+		uint32_t _maxState;
+		uint32_t _reciprocalFreq;
+		uint32_t _bias;
+		uint32_t _complementFreq;
+		uint32_t _reciprocalShift;
+	};
+
+	uint32_t zigzagEncode(const uint32_t value)
+	{
+		return (value << 1) ^ static_cast<uint32_t>(static_cast<int32_t>(value) >> 31);
+	}
+
+	uint32_t zigzagDecode(const uint32_t value)
+	{
+		return (value >> 1) ^ (~(value & 1) + 1);
+	}
+
+	// The frequencies sum to k_probabilityScale and each used symbol keeps at least 1.
+	void normalizeFrequencies(const uint32_t(&counts)[k_symbolCount], const std::size_t totalCount, uint32_t(&outFreqs)[k_symbolCount])
+	{
+		uint32_t freqSum = 0;
+		std::size_t mostFrequentSymbol = 0;
+		for (std::size_t symbol = 0; symbol < k_symbolCount; ++symbol)
+		{
+			const uint32_t count = counts[symbol];
+			if (count != 0)
+			{
+				outFreqs[symbol] = std::max(static_cast<uint32_t>(static_cast<uint64_t>(count) * k_probabilityScale / totalCount), 1u);
+				freqSum += outFreqs[symbol];
+
+				if (count > counts[mostFrequentSymbol])
+				{
+					mostFrequentSymbol = symbol;
+				}
+			}
+			else
+			{
+				outFreqs[symbol] = 0;
+			}
+		}
+
+		// Rounding errors are given to (or taken from) the most frequent symbols, they are the least impacted.
+		if (freqSum < k_probabilityScale)
+		{
+			outFreqs[mostFrequentSymbol] += k_probabilityScale - freqSum;
+		}
+		else
+		{
+			while (freqSum > k_probabilityScale)
+			{
+				const std::size_t highestFreqSymbol = static_cast<std::size_t>(std::max_element(std::begin(outFreqs), std::end(outFreqs)) - std::begin(outFreqs));
+				const uint32_t taken = std::min(freqSum - k_probabilityScale, outFreqs[highestFreqSymbol] - 1);
+				outFreqs[highestFreqSymbol] -= taken;
+				freqSum -= taken;
+			}
+		}
+	}
+
+	void encodePlane(Storm::SerializePackage &package, const uint8_t* bytes, const std::size_t byteCount, std::vector<uint8_t> &encodedBytes)
+	{
+		uint32_t counts[k_symbolCount] = {};
+		for (std::size_t iter = 0; iter < byteCount; ++iter)
+		{
+			++counts[bytes[iter]];
+		}
+
+		uint16_t usedSymbolCount = static_cast<uint16_t>(std::count_if(std::begin(counts), std::end(counts), [](const uint32_t count) { return count != 0; }));
+		if (usedSymbolCount == 1)
+		{
+			uint8_t planeMode = static_cast<uint8_t>(PlaneMode::Constant);
+			uint8_t symbol = bytes[0];
+			package << planeMode << symbol;
+			return;
+		}
+
+		uint32_t freqs[k_symbolCount];
+		normalizeFrequencies(counts, byteCount, freqs);
+
+		RansEncodeSymbol encodeSymbols[k_symbolCount];
+		for (uint32_t symbol = 0, start = 0; symbol < k_symbolCount; start += freqs[symbol], ++symbol)
+		{
+			if (freqs[symbol] != 0)
+			{
+				encodeSymbols[symbol].init(start, freqs[symbol]);
+			}
+		}
+
+		// A symbol cannot output more than 2 bytes, plus the final states.
+		const std::size_t maxEncodedSize = byteCount * 2 + k_ransStateCount * sizeof(uint32_t);
+		if (encodedBytes.size() < maxEncodedSize)
+		{
+			encodedBytes.resize(maxEncodedSize);
+		}
+
+		uint8_t*const encodedEnd = encodedBytes.data() + maxEncodedSize;
+		uint8_t* encodedIter = encodedEnd;
+
+		// rANS is a stack, we encode backward so the decoder reads forward.
+		uint32_t states[k_ransStateCount] = { k_ransLowBound, k_ransLowBound };
+		for (std::size_t iter = byteCount; iter-- > 0;)
+		{
+			uint32_t &state = states[iter % k_ransStateCount];
+			const RansEncodeSymbol &encodeSymbol = encodeSymbols[bytes[iter]];
+			while (state >= encodeSymbol._maxState)
+			{
+				*--encodedIter = static_cast<uint8_t>(state & 0xFF);
+				state >>= 8;
+			}
+
+			const uint32_t quotient = static_cast<uint32_t>((static_cast<uint64_t>(state) * encodeSymbol._reciprocalFreq) >> 32) >> encodeSymbol._reciprocalShift;
+			state += encodeSymbol._bias + quotient * encodeSymbol._complementFreq;
+		}
+
+		for (std::size_t stateIndex = k_ransStateCount; stateIndex-- > 0;)
+		{
+			const uint32_t state = states[stateIndex];
+			encodedIter -= sizeof(uint32_t);
+			encodedIter[0] = static_cast<uint8_t>(state);
+			encodedIter[1] = static_cast<uint8_t>(state >> 8);
+			encodedIter[2] = static_cast<uint8_t>(state >> 16);
+			encodedIter[3] = static_cast<uint8_t>(state >> 24);
+		}
+
+		uint64_t encodedSize = static_cast<uint64_t>(encodedEnd - encodedIter);
+		const std::size_t freqTableSize = sizeof(usedSymbolCount) + usedSymbolCount * (sizeof(uint8_t) + sizeof(uint16_t));
+
+		// Not worth it (random bytes, like the lowest bits of the floats mantissa).
+		if (freqTableSize + sizeof(encodedSize) + encodedSize >= byteCount)
+		{
+			uint8_t planeMode = static_cast<uint8_t>(PlaneMode::Raw);
+			package << planeMode;
+			package.writeRaw(bytes, byteCount);
+			return;
+		}
+
+		uint8_t planeMode = static_cast<uint8_t>(PlaneMode::Rans);
+		package << planeMode << usedSymbolCount;
+
+		for (std::size_t symbol = 0; symbol < k_symbolCount; ++symbol)
+		{
+			if (freqs[symbol] != 0)
+			{
+				uint8_t symbolValue = static_cast<uint8_t>(symbol);
+				uint16_t freq = static_cast<uint16_t>(freqs[symbol]);
+				package << symbolValue << freq;
+			}
+		}
+
+		package << encodedSize;
+		package.writeRaw(encodedIter, static_cast<std::size_t>(encodedSize));
+	}
+
+	void decodePlane(Storm::SerializePackage &package, uint8_t* outBytes, const std::size_t byteCount, std::vector<uint8_t> &encodedBytes)
+	{
+		uint8_t planeMode;
+		package << planeMode;
+
+		switch (static_cast<PlaneMode>(planeMode))
+		{
+		case PlaneMode::Raw:
+			package.readRaw(outBytes, byteCount);
+			return;
+
+		case PlaneMode::Constant:
+		{
+			uint8_t symbol;
+			package << symbol;
+			std::fill(outBytes, outBytes + byteCount, symbol);
+			return;
+		}
+
+		case PlaneMode::Rans:
+			break;
+
+		default:
+			Storm::throwException<Storm::Exception>("Unknown channel plane mode (" + std::to_string(planeMode) + ")!");
+		}
+
+		uint16_t usedSymbolCount;
+		package << usedSymbolCount;
+
+		uint32_t freqs[k_symbolCount] = {};
+		for (uint16_t iter = 0; iter < usedSymbolCount; ++iter)
+		{
+			uint8_t symbol;
+			uint16_t freq;
+			package << symbol << freq;
+			freqs[symbol] = freq;
+		}
+
+		uint32_t starts[k_symbolCount];
+		uint8_t slotToSymbol[k_probabilityScale];
+
+		uint32_t start = 0;
+		for (std::size_t symbol = 0; symbol < k_symbolCount; ++symbol)
+		{
+			const uint32_t freq = freqs[symbol];
+			if (start + freq > k_probabilityScale)
+			{
+				Storm::throwException<Storm::Exception>("Channel plane frequencies are corrupted!");
+			}
+
+			starts[symbol] = start;
+			std::fill(slotToSymbol + start, slotToSymbol + start + freq, static_cast<uint8_t>(symbol));
+			start += freq;
+		}
+
+		if (start != k_probabilityScale)
+		{
+			Storm::throwException<Storm::Exception>("Channel plane frequencies are corrupted!");
+		}
+
+		uint64_t encodedSize;
+		package << encodedSize;
+
+		if (encodedSize < k_ransStateCount * sizeof(uint32_t) || encodedSize > byteCount)
+		{
+			Storm::throwException<Storm::Exception>("Channel plane encoded size is corrupted (" + std::to_string(encodedSize) + " bytes for " + std::to_string(byteCount) + " symbols)!");
+		}
+
+		encodedBytes.resize(static_cast<std::size_t>(encodedSize));
+		package.readRaw(encodedBytes.data(), encodedBytes.size());
+
+		const uint8_t* encodedIter = encodedBytes.data();
+		const uint8_t*const encodedEnd = encodedIter + encodedBytes.size();
+
+		uint32_t states[k_ransStateCount];
+		for (uint32_t &state : states)
+		{
+			state =
+				static_cast<uint32_t>(encodedIter[0]) |
+				(static_cast<uint32_t>(encodedIter[1]) << 8) |
+				(static_cast<uint32_t>(encodedIter[2]) << 16) |
+				(static_cast<uint32_t>(encodedIter[3]) << 24);
+			encodedIter += sizeof(uint32_t);
+		}
+
+		for (std::size_t iter = 0; iter < byteCount; ++iter)
+		{
+			uint32_t &state = states[iter % k_ransStateCount];
+			const uint8_t symbol = slotToSymbol[state & (k_probabilityScale - 1)];
+			outBytes[iter] = symbol;
+
+			state = freqs[symbol] * (state >> k_probabilityBits) + (state & (k_probabilityScale - 1)) - starts[symbol];
+			while (state < k_ransLowBound && encodedIter != encodedEnd)
+			{
+				state = (state << 8) | *encodedIter++;
+			}
+		}
+
+		if (encodedIter != encodedEnd || std::any_of(std::begin(states), std::end(states), [](const uint32_t state) { return state != k_ransLowBound; }))
+		{
+			Storm::throwException<Storm::Exception>("Channel plane is corrupted!");
+		}
+	}
+}
+
+
+Storm::ChannelCodecState::ChannelCodecState() :
+	_mode{ Storm::ChannelCodecMode::Raw }
+{}
+
+void Storm::ChannelCodecState::reset()
+{
+	_mode = Storm::ChannelCodecMode::Raw;
+	_words.clear();
+}
+
+Storm::ChannelCodec::ChannelCodec() :
+	_decodedMode{ Storm::ChannelCodecMode::Raw }
+{}
+
+Storm::ChannelCodec::~ChannelCodec() = default;
+
+void Storm::ChannelCodec::encode(Storm::SerializePackage &package, Storm::ChannelCodecState &state, const float* values, const std::size_t itemCount, const std::size_t componentCount, const bool compress, const Storm::ChannelQuantization* quantization)
+{
+	const std::size_t valueCount = itemCount * componentCount;
+
+	Storm::ChannelCodecMode mode;
+	if (std::all_of(values, values + valueCount, [](const float value) { return value == 0.f; }))
+	{
+		mode = Storm::ChannelCodecMode::Zero;
+	}
+	else if (!compress)
+	{
+		mode = Storm::ChannelCodecMode::Raw;
+	}
+	else if (quantization != nullptr && this->quantize(values, itemCount, componentCount, *quantization))
+	{
+		mode = Storm::ChannelCodecMode::QuantizedDelta;
+	}
+	else
+	{
+		// Either not quantized, or some values are too far from the grid origin to be quantized.
+		mode = Storm::ChannelCodecMode::Delta;
+
+		_words.resize(valueCount);
+		std::memcpy(_words.data(), values, valueCount * sizeof(float));
+	}
+
+	uint8_t modeValue = static_cast<uint8_t>(mode);
+	uint64_t itemCountValue = static_cast<uint64_t>(itemCount);
+	package << modeValue << itemCountValue;
+
+	switch (mode)
+	{
+	case Storm::ChannelCodecMode::Raw:
+		package.writeRaw(values, valueCount * sizeof(float));
+		state.reset();
+		break;
+
+	case Storm::ChannelCodecMode::Zero:
+		state.reset();
+		break;
+
+	case Storm::ChannelCodecMode::Delta:
+	case Storm::ChannelCodecMode::QuantizedDelta:
+		this->encodeResiduals(package, state, mode);
+		break;
+	}
+}
+
+bool Storm::ChannelCodec::quantize(const float* values, const std::size_t itemCount, const std::size_t componentCount, const Storm::ChannelQuantization &quantization)
+{
+	constexpr double k_minQuantized = static_cast<double>(std::numeric_limits<int32_t>::min());
+	constexpr double k_maxQuantized = static_cast<double>(std::numeric_limits<int32_t>::max());
+
+	const double invPrecision = 1.0 / static_cast<double>(quantization._precision);
+
+	_words.resize(itemCount * componentCount);
+
+	for (std::size_t itemIndex = 0; itemIndex < itemCount; ++itemIndex)
+	{
+		for (std::size_t component = 0; component < componentCount; ++component)
+		{
+			const std::size_t valueIndex = itemIndex * componentCount + component;
+			const double quantized = std::round((static_cast<double>(values[valueIndex]) - static_cast<double>(quantization._origin[component])) * invPrecision);
+
+			// Also rejects NaN.
+			if (!(quantized >= k_minQuantized && quantized <= k_maxQuantized))
+			{
+				return false;
+			}
+
+			_words[valueIndex] = static_cast<uint32_t>(static_cast<int32_t>(quantized));
+		}
+	}
+
+	return true;
+}
+
+void Storm::ChannelCodec::encodeResiduals(Storm::SerializePackage &package, Storm::ChannelCodecState &state, const Storm::ChannelCodecMode mode)
+{
+	const std::size_t wordCount = _words.size();
+	const bool hasReference = state._mode == mode && state._words.size() == wordCount;
+
+	_residuals.resize(wordCount);
+
+	if (mode == Storm::ChannelCodecMode::Delta)
+	{
+		if (hasReference)
+		{
+			for (std::size_t iter = 0; iter < wordCount; ++iter)
+			{
+				_residuals[iter] = _words[iter] ^ state._words[iter];
+			}
+		}
+		else
+		{
+			std::copy(std::begin(_words), std::end(_words), std::begin(_residuals));
+		}
+	}
+	else
+	{
+		if (hasReference)
+		{
+			for (std::size_t iter = 0; iter < wordCount; ++iter)
+			{
+				_residuals[iter] = zigzagEncode(_words[iter] - state._words[iter]);
+			}
+		}
+		else
+		{
+			std::transform(std::begin(_words), std::end(_words), std::begin(_residuals), zigzagEncode);
+		}
+	}
+
+	// What we encoded is the reference of the next frame.
+	state._mode = mode;
+	state._words.swap(_words);
+
+	_planeBytes.resize(wordCount);
+	for (std::size_t plane = 0; plane < k_planeCount; ++plane)
+	{
+		const uint32_t shift = static_cast<uint32_t>(plane * 8);
+		for (std::size_t iter = 0; iter < wordCount; ++iter)
+		{
+			_planeBytes[iter] = static_cast<uint8_t>(_residuals[iter] >> shift);
+		}
+
+		encodePlane(package, _planeBytes.data(), wordCount, _encodedBytes);
+	}
+}
+
+std::size_t Storm::ChannelCodec::decodeHeader(Storm::SerializePackage &package)
+{
+	uint8_t modeValue;
+	uint64_t itemCount;
+	package << modeValue << itemCount;
+
+	if (modeValue > static_cast<uint8_t>(Storm::ChannelCodecMode::QuantizedDelta))
+	{
+		Storm::throwException<Storm::Exception>("Unknown channel codec mode (" + std::to_string(modeValue) + ")!");
+	}
+
+	_decodedMode = static_cast<Storm::ChannelCodecMode>(modeValue);
+	return static_cast<std::size_t>(itemCount);
+}
+
+void Storm::ChannelCodec::decodeValues(Storm::SerializePackage &package, Storm::ChannelCodecState &state, float* values, const std::size_t itemCount, const std::size_t componentCount, const Storm::ChannelQuantization* quantization)
+{
+	const std::size_t valueCount = itemCount * componentCount;
+	const Storm::ChannelCodecMode mode = _decodedMode;
+
+	switch (mode)
+	{
+	case Storm::ChannelCodecMode::Raw:
+		package.readRaw(values, valueCount * sizeof(float));
+		state.reset();
+		return;
+
+	case Storm::ChannelCodecMode::Zero:
+		std::fill(values, values + valueCount, 0.f);
+		state.reset();
+		return;
+
+	case Storm::ChannelCodecMode::QuantizedDelta:
+		if (quantization == nullptr)
+		{
+			Storm::throwException<Storm::Exception>("Channel was quantized but we don't know the quantization grid!");
+		}
+		break;
+
+	default:
+		break;
+	}
+
+	_residuals.assign(valueCount, 0);
+	_planeBytes.resize(valueCount);
+	for (std::size_t plane = 0; plane < k_planeCount; ++plane)
+	{
+		decodePlane(package, _planeBytes.data(), valueCount, _encodedBytes);
+
+		const uint32_t shift = static_cast<uint32_t>(plane * 8);
+		for (std::size_t iter = 0; iter < valueCount; ++iter)
+		{
+			_residuals[iter] |= static_cast<uint32_t>(_planeBytes[iter]) << shift;
+		}
+	}
+
+	const bool hasReference = state._mode == mode && state._words.size() == valueCount;
+	state._mode = mode;
+	state._words.resize(valueCount);
+
+	if (mode == Storm::ChannelCodecMode::Delta)
+	{
+		if (hasReference)
+		{
+			for (std::size_t iter = 0; iter < valueCount; ++iter)
+			{
+				state._words[iter] ^= _residuals[iter];
+			}
+		}
+		else
+		{
+			state._words.swap(_residuals);
+		}
+
+		std::memcpy(values, state._words.data(), valueCount * sizeof(float));
+	}
+	else
+	{
+		if (hasReference)
+		{
+			for (std::size_t iter = 0; iter < valueCount; ++iter)
+			{
+				state._words[iter] += zigzagDecode(_residuals[iter]);
+			}
+		}
+		else
+		{
+			std::transform(std::begin(_residuals), std::end(_residuals), std::begin(state._words), zigzagDecode);
+		}
+
+		const double precision = static_cast<double>(quantization->_precision);
+		for (std::size_t itemIndex = 0; itemIndex < itemCount; ++itemIndex)
+		{
+			for (std::size_t component = 0; component < componentCount; ++component)
+			{
+				const std::size_t valueIndex = itemIndex * componentCount + component;
+				values[valueIndex] = static_cast<float>(static_cast<double>(quantization->_origin[component]) + static_cast<double>(static_cast<int32_t>(state._words[valueIndex])) * precision);
+			}
+		}
+	}
+}
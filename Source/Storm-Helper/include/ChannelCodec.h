@@ -0,0 +1,89 @@
+#pragma once
+
+#include "SerializePackage.h"
+
+#include <array>
+
+
+namespace Storm
+{
+	enum class ChannelCodecMode : uint8_t
+	{
+		Raw,
+		Zero, // All values are zero, only the item count is written.
+		Delta, // Bits of the values xored with the ones of the previous frame. Lossless.
+		QuantizedDelta, // Values snapped on a grid, minus the ones of the previous frame. Lossy, the error is at most half the grid precision.
+	};
+
+	// The grid the values of a channel are snapped onto. Each item component has its own origin.
+	struct ChannelQuantization
+	{
+	public:
+		std::array<float, 3> _origin;
+		float _precision;
+	};
+
+	// What the next frame of a channel is encoded against (or decoded with). Each channel should have its own state, on the writer side as well as on the reader side.
+	struct ChannelCodecState
+	{
+	public:
+		ChannelCodecState();
+
+	public:
+		// The next frame won't depend on the previous ones (key frame).
+		void reset();
+
+	public:
+		Storm::ChannelCodecMode _mode;
+		std::vector<uint32_t> _words;
+	};
+
+	// Encodes the successive frames of channels of floats (a Vector3 channel is seen as a channel of 3 times more floats).
+	// The residuals against the previous frame are split in byte planes, then each plane is entropy coded (rANS).
+	// The codec only holds the working buffers, therefore one codec can serialize any count of channels as long as they each have their own state.
+	class ChannelCodec
+	{
+	public:
+		ChannelCodec();
+		~ChannelCodec();
+
+	public:
+		// Encode the channel when the package is serializing, decode it otherwise. When decoding, compress and quantization are taken from what was written,
+		// except the quantization grid that should be the same than the one used to write the channel.
+		template<class ContainerType>
+		void serialize(Storm::SerializePackage &package, Storm::ChannelCodecState &state, ContainerType &container, const bool compress, const Storm::ChannelQuantization* quantization = nullptr)
+		{
+			using ItemType = typename ContainerType::value_type;
+			constexpr std::size_t k_componentCount = sizeof(ItemType) / sizeof(float);
+			static_assert(k_componentCount > 0 && k_componentCount <= 3 && sizeof(ItemType) == k_componentCount * sizeof(float), "Channel codec only handles items made of 1 to 3 floats!");
+
+			if (package.isSerializing())
+			{
+				this->encode(package, state, reinterpret_cast<const float*>(std::data(container)), std::size(container), k_componentCount, compress, quantization);
+			}
+			else
+			{
+				const std::size_t itemCount = this->decodeHeader(package);
+				Storm::SerializePackage::resize(container, itemCount);
+				this->decodeValues(package, state, reinterpret_cast<float*>(std::data(container)), itemCount, k_componentCount, quantization);
+			}
+		}
+
+	private:
+		void encode(Storm::SerializePackage &package, Storm::ChannelCodecState &state, const float* values, const std::size_t itemCount, const std::size_t componentCount, const bool compress, const Storm::ChannelQuantization* quantization);
+		bool quantize(const float* values, const std::size_t itemCount, const std::size_t componentCount, const Storm::ChannelQuantization &quantization);
+		void encodeResiduals(Storm::SerializePackage &package, Storm::ChannelCodecState &state, const Storm::ChannelCodecMode mode);
+
+		std::size_t decodeHeader(Storm::SerializePackage &package);
+		void decodeValues(Storm::SerializePackage &package, Storm::ChannelCodecState &state, float* values, const std::size_t itemCount, const std::size_t componentCount, const Storm::ChannelQuantization* quantization);
+
+	private:
+		// Working buffers, kept between channels to not reallocate them each time.
+		std::vector<uint32_t> _words;
+		std::vector<uint32_t> _residuals;
+		std::vector<uint8_t> _planeBytes;
+		std::vector<uint8_t> _encodedBytes;
+
+		Storm::ChannelCodecMode _decodedMode;
+	};
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "NonInstanciable.h"
+
+
+namespace Storm
+{
+	// Morton code (Z-order curve). The bits of the 3 coordinates are interleaved, so that 2 points near in space are likely near in the code order.
+	class MortonCode : private Storm::NonInstanciable
+	{
+	public:
+		enum : uint32_t
+		{
+			// Each coordinate is encoded on 21 bits, so the whole code fits inside 63 bits.
+			k_maxCoordinate = (1 << 21) - 1
+		};
+
+	private:
+		static constexpr uint64_t spreadBits(uint64_t value)
+		{
+			value &= Storm::MortonCode::k_maxCoordinate;
+			value = (value | value << 32) & 0x001F00000000FFFF;
+			value = (value | value << 16) & 0x001F0000FF0000FF;
+			value = (value | value << 8) & 0x100F00F00F00F00F;
+			value = (value | value << 4) & 0x10C30C30C30C30C3;
+			value = (value | value << 2) & 0x1249249249249249;
+			return value;
+		}
+
+	public:
+		// Coordinates bigger than k_maxCoordinate are truncated.
+		static constexpr uint64_t encode(const uint32_t x, const uint32_t y, const uint32_t z)
+		{
+			return Storm::MortonCode::spreadBits(x) | (Storm::MortonCode::spreadBits(y) << 1) | (Storm::MortonCode::spreadBits(z) << 2);
+		}
+	};
+}
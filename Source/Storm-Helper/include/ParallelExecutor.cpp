@@ -0,0 +1,29 @@
+#include "ParallelExecutor.h"
+
+
+namespace
+{
+	std::atomic<Storm::IParallelExecutor*> g_parallelExecutor = nullptr;
+	std::atomic<Storm::ParallelLoopProfileHook> g_parallelLoopProfileHook = nullptr;
+}
+
+
+void Storm::setParallelExecutor(Storm::IParallelExecutor* executor) noexcept
+{
+	g_parallelExecutor.store(executor, std::memory_order_release);
+}
+
+Storm::IParallelExecutor* Storm::getParallelExecutor() noexcept
+{
+	return g_parallelExecutor.load(std::memory_order_acquire);
+}
+
+void Storm::setParallelLoopProfileHook(Storm::ParallelLoopProfileHook hook) noexcept
+{
+	g_parallelLoopProfileHook.store(hook, std::memory_order_release);
+}
+
+Storm::ParallelLoopProfileHook Storm::getParallelLoopProfileHook() noexcept
+{
+	return g_parallelLoopProfileHook.load(std::memory_order_acquire);
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <source_location>
+
+
+namespace Storm
+{
+	// A task to be run on items ranges [firstIndex, endIndex[ by a parallel executor. The context is forwarded untouched to the function.
+	// We don't use std::function because we don't want to allocate anything each time we run a parallel loop.
+	struct ParallelRangeTask
+	{
+	public:
+		using RangeFuncPtr = void(*)(void* context, const std::size_t firstIndex, const std::size_t endIndex);
+
+	public:
+		void* _context;
+		RangeFuncPtr _func;
+	};
+
+	template<class RangeFunc>
+	Storm::ParallelRangeTask makeParallelRangeTask(RangeFunc &rangeFunc)
+	{
+		return Storm::ParallelRangeTask{
+			static_cast<void*>(std::addressof(rangeFunc)),
+			[](void* context, const std::size_t firstIndex, const std::size_t endIndex)
+			{
+				(*static_cast<RangeFunc*>(context))(firstIndex, endIndex);
+			}
+		};
+	}
+
+	// The executor runParallel and reduceParallel run on. The application registers its own worker pool,
+	// but if none was registered (tools, or before the application initialization), we fallback to the standard parallel execution policy.
+	class IParallelExecutor
+	{
+	public:
+		virtual ~IParallelExecutor() = default;
+
+	public:
+		// Run the task over all items in [0, itemCount[ and returns once all of them were processed. The calling thread takes part in the execution.
+		// grainSize is the count of consecutive items a thread takes at once. 0 means we let the executor choose.
+		virtual void execute(const std::size_t itemCount, const std::size_t grainSize, const Storm::ParallelRangeTask &task) = 0;
+
+		// The count of threads that could run a task at the same time (the calling thread included).
+		virtual std::size_t getConcurrency() const noexcept = 0;
+	};
+
+	// Called after each parallel loop with the location it was called from. Used by the profiler.
+	using ParallelLoopProfileHook = void(*)(const std::source_location &location, const std::size_t itemCount, const std::chrono::nanoseconds duration);
+
+	void setParallelExecutor(Storm::IParallelExecutor* executor) noexcept;
+	Storm::IParallelExecutor* getParallelExecutor() noexcept;
+
+	void setParallelLoopProfileHook(Storm::ParallelLoopProfileHook hook) noexcept;
+	Storm::ParallelLoopProfileHook getParallelLoopProfileHook() noexcept;
+
+	class ParallelLoopProfileScope
+	{
+	public:
+		ParallelLoopProfileScope(const std::source_location &location, const std::size_t itemCount) :
+			_hook{ Storm::getParallelLoopProfileHook() },
+			_location{ location },
+			_itemCount{ itemCount }
+		{
+			if (_hook != nullptr)
+			{
+				_startTime = std::chrono::high_resolution_clock::now();
+			}
+		}
+
+		~ParallelLoopProfileScope()
+		{
+			if (_hook != nullptr)
+			{
+				_hook(_location, _itemCount, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - _startTime));
+			}
+		}
+
+	private:
+		const Storm::ParallelLoopProfileHook _hook;
+		const std::source_location _location;
+		const std::size_t _itemCount;
+		std::chrono::high_resolution_clock::time_point _startTime;
+	};
+}
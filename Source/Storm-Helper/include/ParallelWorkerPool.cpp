@@ -0,0 +1,295 @@
+#include "ParallelWorkerPool.h"
+
+#include "ThreadHelper.h"
+
+#include "LeanWindowsInclude.h"
+
+#include <processthreadsapi.h>
+#include <comdef.h>
+#include <numeric>
+
+
+namespace
+{
+	// Set for the pool workers, and for the thread that started a loop while it executes it. A loop started from those threads is run inline.
+	thread_local bool t_insideParallelLoop = false;
+
+	// Loops are usually started back to back, therefore the workers spin a little before going to sleep.
+	constexpr std::size_t k_workerSpinCount = 1024;
+
+	// When the grain size isn't fixed, each loop is cut into this count of chunks per participating thread, so the work can be balanced.
+	constexpr std::size_t k_autoChunkCountPerThread = 8;
+
+	constexpr uint64_t k_participantCountBitCount = 16;
+	constexpr uint64_t k_participantCountMask = (static_cast<uint64_t>(1) << k_participantCountBitCount) - 1;
+
+	void nameCurrentWorker(const std::size_t workerIndex)
+	{
+		const std::wstring workerName = L"Parallel Worker " + std::to_wstring(workerIndex);
+		HRESULT res = ::SetThreadDescription(::GetCurrentThread(), workerName.c_str());
+		if (FAILED(res))
+		{
+			LOG_ERROR << "Cannot set the name of the parallel worker " << workerIndex << ". Reason " << Storm::toStdString(_com_error{ res });
+		}
+	}
+
+	void pinCurrentWorker(const std::size_t workerIndex)
+	{
+		// The thread starting the loops (the simulation thread) isn't pinned and is expected to be on the first core, so the workers take the next ones.
+		const std::size_t coreCount = std::min<std::size_t>(std::max<std::size_t>(std::thread::hardware_concurrency(), 1), sizeof(DWORD_PTR) * CHAR_BIT);
+		const std::size_t coreIndex = (workerIndex + 1) % coreCount;
+
+		if (::SetThreadAffinityMask(::GetCurrentThread(), static_cast<DWORD_PTR>(1) << coreIndex) == 0)
+		{
+			LOG_ERROR << "Cannot pin the parallel worker " << workerIndex << " to the core " << coreIndex << ". Error code was " << ::GetLastError();
+		}
+	}
+}
+
+
+Storm::ParallelWorkerPool::ParallelWorkerPool(const std::size_t workerCount, const bool pinWorkers, const std::size_t defaultGrainSize) :
+	_slices{ std::make_unique<Storm::ParallelWorkerPool::Slice[]>(workerCount + 1) },
+	_defaultGrainSize{ defaultGrainSize },
+	_loopTicket{ 0 },
+	_stop{ false },
+	_task{ nullptr },
+	_grainSize{ 1 },
+	_participantCount{ 0 },
+	_pendingWorkers{ 0 }
+{
+	if (workerCount >= k_participantCountMask)
+	{
+		Storm::throwException<Storm::Exception>("Parallel worker count is too high (" + std::to_string(workerCount) + "), it should be under " + std::to_string(k_participantCountMask));
+	}
+
+	_workers.reserve(workerCount);
+	for (std::size_t workerIndex = 0; workerIndex < workerCount; ++workerIndex)
+	{
+		_workers.emplace_back([this, workerIndex, pinWorkers]()
+		{
+			this->workerLoop(workerIndex, pinWorkers);
+		});
+	}
+}
+
+Storm::ParallelWorkerPool::~ParallelWorkerPool()
+{
+	// Wait for the loop being executed, if any.
+	std::lock_guard<std::mutex> executeLock{ _executeMutex };
+
+	{
+		std::lock_guard<std::mutex> wakeLock{ _wakeMutex };
+		_stop = true;
+	}
+
+	_wakeCV.notify_all();
+
+	for (std::thread &worker : _workers)
+	{
+		Storm::join(worker);
+	}
+}
+
+void Storm::ParallelWorkerPool::execute(const std::size_t itemCount, std::size_t grainSize, const Storm::ParallelRangeTask &task)
+{
+	if (itemCount == 0)
+	{
+		return;
+	}
+
+	const std::size_t concurrency = this->getConcurrency();
+
+	if (grainSize == 0)
+	{
+		grainSize = _defaultGrainSize;
+		if (grainSize == 0)
+		{
+			grainSize = std::max<std::size_t>(itemCount / (concurrency * k_autoChunkCountPerThread), 1);
+		}
+	}
+
+	const std::size_t participantCount = std::min(concurrency, (itemCount + grainSize - 1) / grainSize);
+	if (participantCount < 2 || t_insideParallelLoop)
+	{
+		task._func(task._context, 0, itemCount);
+		return;
+	}
+
+	std::unique_lock<std::mutex> executeLock{ _executeMutex, std::try_to_lock };
+	if (!executeLock.owns_lock())
+	{
+		// The workers are busy with a loop from another thread. Waiting for it would serialize the threads, so we don't use the workers for this one.
+		this->executeWithStandardPolicy(itemCount, grainSize, task);
+		return;
+	}
+
+	for (std::size_t sliceIndex = 0; sliceIndex < participantCount; ++sliceIndex)
+	{
+		Storm::ParallelWorkerPool::Slice &slice = _slices[sliceIndex];
+		slice._cursor.store(sliceIndex * itemCount / participantCount, std::memory_order_relaxed);
+		slice._end = (sliceIndex + 1) * itemCount / participantCount;
+	}
+
+	_task = &task;
+	_grainSize = grainSize;
+	_participantCount = participantCount;
+	_pendingWorkers.store(participantCount - 1, std::memory_order_relaxed);
+
+	{
+		std::lock_guard<std::mutex> wakeLock{ _wakeMutex };
+		const uint64_t generation = (_loopTicket.load(std::memory_order_relaxed) >> k_participantCountBitCount) + 1;
+		_loopTicket.store((generation << k_participantCountBitCount) | static_cast<uint64_t>(participantCount), std::memory_order_release);
+	}
+
+	_wakeCV.notify_all();
+
+	t_insideParallelLoop = true;
+	this->participate(0);
+	t_insideParallelLoop = false;
+
+	for (std::size_t pendingWorkers = _pendingWorkers.load(std::memory_order_acquire); pendingWorkers != 0; pendingWorkers = _pendingWorkers.load(std::memory_order_acquire))
+	{
+		_pendingWorkers.wait(pendingWorkers, std::memory_order_acquire);
+	}
+
+	_task = nullptr;
+
+	if (_exception)
+	{
+		std::rethrow_exception(std::exchange(_exception, nullptr));
+	}
+}
+
+std::size_t Storm::ParallelWorkerPool::getConcurrency() const noexcept
+{
+	return _workers.size() + 1;
+}
+
+void Storm::ParallelWorkerPool::workerLoop(const std::size_t workerIndex, const bool pin)
+{
+	t_insideParallelLoop = true;
+
+	nameCurrentWorker(workerIndex);
+	if (pin)
+	{
+		pinCurrentWorker(workerIndex);
+	}
+
+	const std::size_t sliceIndex = workerIndex + 1;
+
+	uint64_t lastGeneration = 0;
+	for (;;)
+	{
+		uint64_t ticket = _loopTicket.load(std::memory_order_acquire);
+		for (std::size_t spinIter = 0; (ticket >> k_participantCountBitCount) == lastGeneration && spinIter < k_workerSpinCount; ++spinIter)
+		{
+			std::this_thread::yield();
+			ticket = _loopTicket.load(std::memory_order_acquire);
+		}
+
+		if ((ticket >> k_participantCountBitCount) == lastGeneration)
+		{
+			std::unique_lock<std::mutex> wakeLock{ _wakeMutex };
+			_wakeCV.wait(wakeLock, [this, &ticket, lastGeneration]()
+			{
+				ticket = _loopTicket.load(std::memory_order_acquire);
+				return _stop || (ticket >> k_participantCountBitCount) != lastGeneration;
+			});
+
+			if (_stop)
+			{
+				return;
+			}
+		}
+
+		lastGeneration = ticket >> k_participantCountBitCount;
+
+		// A loop cannot finish without its participants, so we won't miss a loop we should take part of.
+		if (sliceIndex < static_cast<std::size_t>(ticket & k_participantCountMask))
+		{
+			this->participate(sliceIndex);
+
+			if (_pendingWorkers.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			{
+				_pendingWorkers.notify_one();
+			}
+		}
+	}
+}
+
+void Storm::ParallelWorkerPool::participate(const std::size_t sliceIndex)
+{
+	try
+	{
+		this->processSlice(_slices[sliceIndex]);
+
+		// Our slice is exhausted, steal the remaining chunks of the others.
+		for (std::size_t offset = 1; offset < _participantCount; ++offset)
+		{
+			this->processSlice(_slices[(sliceIndex + offset) % _participantCount]);
+		}
+	}
+	catch (...)
+	{
+		{
+			std::lock_guard<std::mutex> exceptionLock{ _exceptionMutex };
+			if (!_exception)
+			{
+				_exception = std::current_exception();
+			}
+		}
+
+		// Stop the loop as soon as possible. The first exception will be rethrown to the thread that started the loop.
+		for (std::size_t iter = 0; iter < _participantCount; ++iter)
+		{
+			Storm::ParallelWorkerPool::Slice &slice = _slices[iter];
+			slice._cursor.store(slice._end, std::memory_order_relaxed);
+		}
+	}
+}
+
+void Storm::ParallelWorkerPool::executeWithStandardPolicy(const std::size_t itemCount, const std::size_t grainSize, const Storm::ParallelRangeTask &task)
+{
+	const std::size_t chunkCount = (itemCount + grainSize - 1) / grainSize;
+
+	std::vector<std::size_t> chunkIndexes(chunkCount);
+	std::iota(std::begin(chunkIndexes), std::end(chunkIndexes), static_cast<std::size_t>(0));
+
+	// The standard parallel algorithms terminate the application if an exception escapes, so we catch it to rethrow it like a loop executed on the workers.
+	std::mutex exceptionMutex;
+	std::exception_ptr exception;
+
+	std::for_each(std::execution::par, std::begin(chunkIndexes), std::end(chunkIndexes), [itemCount, grainSize, &task, &exceptionMutex, &exception](const std::size_t chunkIndex)
+	{
+		try
+		{
+			const std::size_t firstIndex = chunkIndex * grainSize;
+			task._func(task._context, firstIndex, std::min(firstIndex + grainSize, itemCount));
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> exceptionLock{ exceptionMutex };
+			if (!exception)
+			{
+				exception = std::current_exception();
+			}
+		}
+	});
+
+	if (exception)
+	{
+		std::rethrow_exception(exception);
+	}
+}
+
+void Storm::ParallelWorkerPool::processSlice(Storm::ParallelWorkerPool::Slice &slice)
+{
+	const Storm::ParallelRangeTask &task = *_task;
+	const std::size_t grainSize = _grainSize;
+	const std::size_t endIndex = slice._end;
+
+	for (std::size_t firstIndex = slice._cursor.fetch_add(grainSize, std::memory_order_relaxed); firstIndex < endIndex; firstIndex = slice._cursor.fetch_add(grainSize, std::memory_order_relaxed))
+	{
+		task._func(task._context, firstIndex, std::min(firstIndex + grainSize, endIndex));
+	}
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "ParallelExecutor.h"
+
+#include <condition_variable>
+
+
+namespace Storm
+{
+	// Persistent worker threads executing the parallel loops (runParallel, reduceParallel, ...).
+	// The items range of a loop is split in one slice per participating thread, and each thread takes chunks of grain size items from its slice,
+	// then steals chunks from the other slices once its own slice is exhausted.
+	// Only one loop is executed on the workers at a time. A loop started from a thread that already executes a loop (nested loop) is run inline on that thread,
+	// and a loop started from another thread while the workers are busy (i.e. the graphics or serializer thread while the simulation runs its loops) is run with the standard parallel policy instead of waiting.
+	class ParallelWorkerPool final : public Storm::IParallelExecutor
+	{
+	private:
+		struct alignas(64) Slice
+		{
+		public:
+			std::atomic<std::size_t> _cursor;
+			std::size_t _end;
+		};
+
+	public:
+		// workerCount doesn't count the calling thread that also takes part of the loops. defaultGrainSize of 0 means we compute it from the item count of each loop.
+		ParallelWorkerPool(const std::size_t workerCount, const bool pinWorkers, const std::size_t defaultGrainSize);
+		~ParallelWorkerPool();
+
+	public:
+		void execute(const std::size_t itemCount, const std::size_t grainSize, const Storm::ParallelRangeTask &task) final override;
+		std::size_t getConcurrency() const noexcept final override;
+
+	private:
+		void workerLoop(const std::size_t workerIndex, const bool pin);
+		void participate(const std::size_t sliceIndex);
+		void processSlice(Storm::ParallelWorkerPool::Slice &slice);
+		void executeWithStandardPolicy(const std::size_t itemCount, const std::size_t grainSize, const Storm::ParallelRangeTask &task);
+
+	private:
+		std::vector<std::thread> _workers;
+		std::unique_ptr<Storm::ParallelWorkerPool::Slice[]> _slices;
+		std::size_t _defaultGrainSize;
+
+		// Only one loop at a time on the workers.
+		std::mutex _executeMutex;
+
+		// The loop generation in the high bits, and the count of thread participating to it in the low bits. Read at once to be consistent.
+		std::mutex _wakeMutex;
+		std::condition_variable _wakeCV;
+		std::atomic<uint64_t> _loopTicket;
+		bool _stop;
+
+		// The current loop. Only valid while it is executed.
+		const Storm::ParallelRangeTask* _task;
+		std::size_t _grainSize;
+		std::size_t _participantCount;
+		std::atomic<std::size_t> _pendingWorkers;
+
+		std::mutex _exceptionMutex;
+		std::exception_ptr _exception;
+	};
+}
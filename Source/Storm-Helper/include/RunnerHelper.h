@@ -1,6 +1,7 @@
 #pragma once
 
 #include "MacroConfig.h"
+#include "ParallelExecutor.h"
 
 
 namespace Storm
@@ -36,7 +37,7 @@ namespace Storm
 	template<class ContainerType> auto extractContainerType(const ContainerType &cont, ...) -> decltype(*std::begin(cont));
 
 	template<bool useOpenMPWhenEnabled = false, class ContainerType, class Func>
-	auto runParallel(ContainerType &container, Func &&func)
+	auto runParallel(ContainerType &container, Func &&func, const std::source_location &location = std::source_location::current())
 		-> decltype(func(*std::begin(container), Storm::retrieveItemIndex(container, *std::begin(container))), void())
 	{
 #if STORM_USE_OPENMP
@@ -55,35 +56,167 @@ namespace Storm
 		}
 #endif
 
-		std::for_each(std::execution::par, std::begin(container), std::end(container), [&container, &func](auto &item)
+		const Storm::ParallelLoopProfileScope profileScope{ location, std::size(container) };
+
+		if (Storm::IParallelExecutor*const executor = Storm::getParallelExecutor(); executor != nullptr)
+		{
+			const auto first = std::begin(container);
+			auto rangeFunc = [&first, &func](const std::size_t firstIndex, const std::size_t endIndex)
+			{
+				for (std::size_t index = firstIndex; index < endIndex; ++index)
+				{
+					func(first[index], index);
+				}
+			};
+
+			executor->execute(std::size(container), 0, Storm::makeParallelRangeTask(rangeFunc));
+		}
+		else
 		{
-			func(item, Storm::retrieveItemIndex(container, item));
-		});
+			std::for_each(std::execution::par, std::begin(container), std::end(container), [&container, &func](auto &item)
+			{
+				func(item, Storm::retrieveItemIndex(container, item));
+			});
+		}
 	}
 
 	template<class ContainerType, class Func>
-	auto runParallel(ContainerType &container, Func &&func)
+	auto runParallel(ContainerType &container, Func &&func, const std::source_location &location = std::source_location::current())
 		-> decltype(func(*std::begin(container)), void())
 	{
+		const Storm::ParallelLoopProfileScope profileScope{ location, std::size(container) };
+
+		// The worker pool needs to jump directly to an item, otherwise (i.e. maps) we stay with the standard parallel policy.
+		if constexpr (std::random_access_iterator<decltype(std::begin(container))>)
+		{
+			if (Storm::IParallelExecutor*const executor = Storm::getParallelExecutor(); executor != nullptr)
+			{
+				const auto first = std::begin(container);
+				auto rangeFunc = [&first, &func](const std::size_t firstIndex, const std::size_t endIndex)
+				{
+					for (std::size_t index = firstIndex; index < endIndex; ++index)
+					{
+						func(first[index]);
+					}
+				};
+
+				executor->execute(std::size(container), 0, Storm::makeParallelRangeTask(rangeFunc));
+				return;
+			}
+		}
+
 		std::for_each(std::execution::par, std::begin(container), std::end(container), func);
 	}
 
 #if _WIN32
 	__forceinline const unsigned int retrieveParallelPolicyExecThreadCount()
 	{
+		if (const Storm::IParallelExecutor*const executor = Storm::getParallelExecutor(); executor != nullptr)
+		{
+			return static_cast<unsigned int>(executor->getConcurrency());
+		}
+
 		return __std_parallel_algorithms_hw_threads() * 4;
 	}
 #endif
 
 	template<class ContainerType, class ValueType>
-	auto reduceParallel(const ContainerType &container, const ValueType &value)
+	auto reduceParallel(const ContainerType &container, const ValueType &value, const std::source_location &location = std::source_location::current())
 	{
+		if constexpr (std::random_access_iterator<decltype(std::begin(container))>)
+		{
+			if (Storm::IParallelExecutor*const executor = Storm::getParallelExecutor(); executor != nullptr)
+			{
+				const Storm::ParallelLoopProfileScope profileScope{ location, std::size(container) };
+
+				// A few chunks per thread to let the pool balance the work. Each chunk contains at least one item, so each partial result starts from its first item.
+				const std::size_t itemCount = std::size(container);
+				const std::size_t chunkCount = std::min(itemCount, executor->getConcurrency() * 4);
+
+				const auto first = std::begin(container);
+				if (chunkCount < 2)
+				{
+					return std::reduce(first, std::end(container), value);
+				}
+
+				using ResultType = decltype(std::reduce(first, std::end(container), value));
+
+				std::vector<ResultType> chunkResults;
+				chunkResults.reserve(chunkCount);
+				for (std::size_t chunkIndex = 0; chunkIndex < chunkCount; ++chunkIndex)
+				{
+					chunkResults.emplace_back(first[chunkIndex * itemCount / chunkCount]);
+				}
+
+				auto rangeFunc = [&first, &chunkResults, itemCount, chunkCount](const std::size_t firstChunk, const std::size_t endChunk)
+				{
+					for (std::size_t chunkIndex = firstChunk; chunkIndex < endChunk; ++chunkIndex)
+					{
+						const std::size_t firstIndex = chunkIndex * itemCount / chunkCount;
+						const std::size_t endIndex = (chunkIndex + 1) * itemCount / chunkCount;
+						chunkResults[chunkIndex] = std::reduce(first + firstIndex + 1, first + endIndex, chunkResults[chunkIndex]);
+					}
+				};
+
+				executor->execute(chunkCount, 1, Storm::makeParallelRangeTask(rangeFunc));
+
+				return std::reduce(std::begin(chunkResults), std::end(chunkResults), static_cast<ResultType>(value));
+			}
+		}
+
 		return std::reduce(std::execution::par, std::begin(container), std::end(container), value);
 	}
 
 	template<class ContainerType>
-	auto reduceParallel(const ContainerType &container)
+	auto reduceParallel(const ContainerType &container, const std::source_location &location = std::source_location::current())
 	{
-		return Storm::reduceParallel(container, Storm::defaultItem<std::remove_cvref_t<decltype(Storm::extractContainerType(container, 0))>>(0));
+		return Storm::reduceParallel(container, Storm::defaultItem<std::remove_cvref_t<decltype(Storm::extractContainerType(container, 0))>>(0), location);
+	}
+
+	// Partial result of a chunk of Storm::reduceChunkedParallel, and the final result once all chunks were merged.
+	struct ParallelReduceResult
+	{
+	public:
+		__forceinline void merge(const Storm::ParallelReduceResult &other)
+		{
+			_sum += other._sum;
+			_max = std::max(_max, other._max);
+			_flag = _flag || other._flag;
+		}
+
+	public:
+		float _sum = 0.f;
+		float _max = 0.f;
+		bool _flag = false;
+	};
+
+	// Like runParallel, except that func(item, index, chunkResult) also receives the result of the chunk the item belongs to, to accumulate into it without any atomic.
+	// Chunks are made of a fixed count of consecutive items and are merged sequentially in order, therefore the reduction is deterministic whatever the thread count is.
+	// ResultType should be default constructible to its neutral value, and have a merge(const ResultType &) method.
+	template<std::size_t chunkItemCount = 1024, class ResultType = Storm::ParallelReduceResult, class ContainerType, class Func>
+	ResultType reduceChunkedParallel(ContainerType &container, Func &&func, const std::source_location &location = std::source_location::current())
+	{
+		static_assert(chunkItemCount > 0, "Chunk item count should be strictly positive!");
+
+		const std::size_t itemCount = std::size(container);
+
+		std::vector<ResultType> chunkResults((itemCount + chunkItemCount - 1) / chunkItemCount);
+		Storm::runParallel(chunkResults, [&container, &func, itemCount](ResultType &chunkResult, const std::size_t chunkIndex)
+		{
+			const std::size_t firstIndex = chunkIndex * chunkItemCount;
+			const std::size_t endIndex = std::min(firstIndex + chunkItemCount, itemCount);
+			for (std::size_t index = firstIndex; index < endIndex; ++index)
+			{
+				func(container[index], index, chunkResult);
+			}
+		}, location);
+
+		ResultType result;
+		for (const ResultType &chunkResult : chunkResults)
+		{
+			result.merge(chunkResult);
+		}
+
+		return result;
 	}
 }
@@ -7,6 +7,7 @@ namespace Storm
 	{
 		SISD, // None
 		SSE,
+		AVX2,
 		AVX512,
 	};
 }
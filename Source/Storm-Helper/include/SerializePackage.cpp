@@ -9,16 +9,35 @@
 
 namespace
 {
+	// Make the package looks like a stream for binaryWrite and binaryRead, so everything goes through the write buffer.
+	struct PackageRawStream
+	{
+	public:
+		void write(const char* data, const std::size_t byteCount)
+		{
+			_package.writeRaw(data, byteCount);
+		}
+
+		void read(char* data, const std::size_t byteCount)
+		{
+			_package.readRaw(data, byteCount);
+		}
+
+	public:
+		Storm::SerializePackage &_package;
+	};
+
 	template<class Type>
-	void handleBinaryPacket(const bool isSaving, std::fstream &inOutStream, Type &outVal)
+	void handleBinaryPacket(Storm::SerializePackage &package, Type &outVal)
 	{
-		if (isSaving)
+		PackageRawStream packageStream{ package };
+		if (package.isSerializing())
 		{
-			Storm::binaryWrite(inOutStream, outVal);
+			Storm::binaryWrite(packageStream, outVal);
 		}
 		else
 		{
-			Storm::binaryRead(inOutStream, outVal);
+			Storm::binaryRead(packageStream, outVal);
 		}
 	}
 
@@ -42,10 +61,17 @@ namespace
 }
 
 
-Storm::SerializePackage::SerializePackage(Storm::SerializePackageCreationModality modality, const std::string &packageFilePath) :
+Storm::SerializePackage::SerializePackage(Storm::SerializePackageCreationModality modality, const std::string &packageFilePath, const std::size_t writeBufferSize) :
 	_isSaving{ modalityIsSaving(modality) },
-	_filePath{ packageFilePath }
+	_filePath{ packageFilePath },
+	_writeBufferCapacity{ 0 }
 {
+	if (_isSaving)
+	{
+		_writeBufferCapacity = writeBufferSize;
+		_writeBuffer.reserve(_writeBufferCapacity);
+	}
+
 	if (_isSaving || std::filesystem::exists(packageFilePath))
 	{
 		int openFlag = std::ios_base::binary;
@@ -110,81 +136,86 @@ Storm::SerializePackage::SerializePackage(Storm::SerializePackageCreationModalit
 	}
 }
 
+Storm::SerializePackage::~SerializePackage()
+{
+	this->flushWriteBuffer();
+}
+
 Storm::SerializePackage& Storm::SerializePackage::operator<<(char &other)
 {
-	handleBinaryPacket(_isSaving, _file, other);
+	handleBinaryPacket(*this, other);
 	return *this;
 }
 
 Storm::SerializePackage& Storm::SerializePackage::operator<<(int8_t &other)
 {
-	handleBinaryPacket(_isSaving, _file, other);
+	handleBinaryPacket(*this, other);
 	return *this;
 }
 
 Storm::SerializePackage& Storm::SerializePackage::operator<<(uint64_t &other)
 {
-	handleBinaryPacket(_isSaving, _file, other);
+	handleBinaryPacket(*this, other);
 	return *this;
 }
 
 Storm::SerializePackage& Storm::SerializePackage::operator<<(uint32_t &other)
 {
-	handleBinaryPacket(_isSaving, _file, other);
+	handleBinaryPacket(*this, other);
 	return *this;
 }
 
 Storm::SerializePackage& Storm::SerializePackage::operator<<(uint16_t &other)
 {
-	handleBinaryPacket(_isSaving, _file, other);
+	handleBinaryPacket(*this, other);
 	return *this;
 }
 
 Storm::SerializePackage& Storm::SerializePackage::operator<<(uint8_t &other)
 {
-	handleBinaryPacket(_isSaving, _file, other);
+	handleBinaryPacket(*this, other);
 	return *this;
 }
 
 Storm::SerializePackage& Storm::SerializePackage::operator<<(int16_t &other)
 {
-	handleBinaryPacket(_isSaving, _file, other);
+	handleBinaryPacket(*this, other);
 	return *this;
 }
 
 Storm::SerializePackage& Storm::SerializePackage::operator<<(int32_t &other)
 {
-	handleBinaryPacket(_isSaving, _file, other);
+	handleBinaryPacket(*this, other);
 	return *this;
 }
 
 Storm::SerializePackage& Storm::SerializePackage::operator<<(int64_t &other)
 {
-	handleBinaryPacket(_isSaving, _file, other);
+	handleBinaryPacket(*this, other);
 	return *this;
 }
 
 Storm::SerializePackage& Storm::SerializePackage::operator<<(double &other)
 {
-	handleBinaryPacket(_isSaving, _file, other);
+	handleBinaryPacket(*this, other);
 	return *this;
 }
 
 Storm::SerializePackage& Storm::SerializePackage::operator<<(float &other)
 {
-	handleBinaryPacket(_isSaving, _file, other);
+	handleBinaryPacket(*this, other);
 	return *this;
 }
 
 Storm::SerializePackage& Storm::SerializePackage::operator<<(bool &other)
 {
-	handleBinaryPacket(_isSaving, _file, other);
+	handleBinaryPacket(*this, other);
 	return *this;
 }
 
 Storm::SerializePackage& Storm::SerializePackage::operator<<(std::string &other)
 {
-	handleBinaryPacket(_isSaving, _file, other);
+	handleBinaryPacket(*this, other);
 	return *this;
 }
 
@@ -200,11 +231,46 @@ const std::fstream& Storm::SerializePackage::getUnderlyingStream() const noexcep
 
 std::fstream& Storm::SerializePackage::getUnderlyingStream() noexcept
 {
+	this->flushWriteBuffer();
 	return _file;
 }
 
+void Storm::SerializePackage::writeRaw(const void* data, const std::size_t byteCount)
+{
+	const char*const bytes = static_cast<const char*>(data);
+
+	if (_writeBuffer.size() + byteCount > _writeBufferCapacity)
+	{
+		this->flushWriteBuffer();
+
+		// Not worth a copy into the buffer, we would have to flush it right away.
+		if (byteCount >= _writeBufferCapacity)
+		{
+			_file.write(bytes, byteCount);
+			return;
+		}
+	}
+
+	_writeBuffer.insert(std::end(_writeBuffer), bytes, bytes + byteCount);
+}
+
+void Storm::SerializePackage::readRaw(void* data, const std::size_t byteCount)
+{
+	_file.read(static_cast<char*>(data), byteCount);
+}
+
+void Storm::SerializePackage::flushWriteBuffer()
+{
+	if (!_writeBuffer.empty())
+	{
+		_file.write(_writeBuffer.data(), _writeBuffer.size());
+		_writeBuffer.clear();
+	}
+}
+
 void Storm::SerializePackage::seekAbsolute(const std::size_t newPos)
 {
+	this->flushWriteBuffer();
 	_file.clear();
 	_file.seekp(newPos);
 }
@@ -216,15 +282,18 @@ const std::string& Storm::SerializePackage::getFilePath() const noexcept
 
 void Storm::SerializePackage::flush()
 {
+	this->flushWriteBuffer();
 	_file.flush();
 }
 
 std::size_t Storm::SerializePackage::getStreamPosition()
 {
-	return _file.tellg();
+	// The pending writes will be written at the current position.
+	return static_cast<std::size_t>(_file.tellg()) + _writeBuffer.size();
 }
 
 std::size_t Storm::SerializePackage::getPacketSize() const
 {
-	return std::filesystem::file_size(_filePath);
+	// Pending writes are usually appended at the end.
+	return std::filesystem::file_size(_filePath) + _writeBuffer.size();
 }
@@ -13,7 +13,13 @@ namespace Storm
 	class SerializePackage
 	{
 	public:
-		SerializePackage(Storm::SerializePackageCreationModality modality, const std::string &packageFilePath);
+		// Default size of the buffer accumulating the writes before they are sent to the file, in bytes.
+		static constexpr std::size_t k_defaultWriteBufferSize = 1024 * 1024;
+
+	public:
+		// writeBufferSize is only used when saving. 0 means the writes are directly sent to the file stream.
+		SerializePackage(Storm::SerializePackageCreationModality modality, const std::string &packageFilePath, const std::size_t writeBufferSize = Storm::SerializePackage::k_defaultWriteBufferSize);
+		~SerializePackage();
 
 	private:
 		template<class ContainerType, uint64_t resultSize>
@@ -49,6 +55,26 @@ namespace Storm
 
 		}
 
+		// Types whose serialized binary layout is exactly their memory layout, so a contiguous array of them can be moved with only one read or write.
+		template<class Type>
+		static constexpr bool isRawSerializable()
+		{
+			if constexpr (std::is_arithmetic_v<Type>)
+			{
+				return true;
+			}
+			else if constexpr (requires(Type &vect3) { vect3.x(); vect3.y(); vect3.z(); })
+			{
+				// Vector3 are serialized coordinate by coordinate, this matches their memory layout only if there is nothing else inside.
+				using ScalarType = std::remove_cvref_t<decltype(std::declval<Type &>().x())>;
+				return std::is_arithmetic_v<ScalarType> && sizeof(Type) == 3 * sizeof(ScalarType);
+			}
+			else
+			{
+				return false;
+			}
+		}
+
 		template<class Type>
 		auto doSerialize(Type &other, int) -> decltype(other.serialize(std::declval<SerializePackage>()), static_cast<SerializePackage*>(nullptr))
 		{
@@ -81,10 +107,26 @@ namespace Storm
 				resizeContainer(container, containerSize, 0);
 			}
 
-			for (auto &item : container)
+			if constexpr (std::ranges::contiguous_range<ContainerType> && Storm::SerializePackage::isRawSerializable<std::ranges::range_value_t<ContainerType>>())
 			{
-				this->operator <<(item);
+				const std::size_t byteCount = std::size(container) * sizeof(std::ranges::range_value_t<ContainerType>);
+				if (_isSaving)
+				{
+					this->writeRaw(std::data(container), byteCount);
+				}
+				else
+				{
+					this->readRaw(std::data(container), byteCount);
+				}
 			}
+			else
+			{
+				for (auto &item : container)
+				{
+					this->operator <<(item);
+				}
+			}
+
 			return this;
 		}
 
@@ -167,9 +209,21 @@ namespace Storm
 		// true if serializing (saving/writing), false if deserializing (loading/reading)
 		bool isSerializing() const noexcept;
 
+		// Beware, the writes still inside the write buffer aren't in the const stream. The non const version flushes them first.
 		const std::fstream& getUnderlyingStream() const noexcept;
 		std::fstream& getUnderlyingStream() noexcept;
 
+		// Write or read byteCount bytes as is. What was written with writeRaw should be read back with readRaw with the same byte count.
+		void writeRaw(const void* data, const std::size_t byteCount);
+		void readRaw(void* data, const std::size_t byteCount);
+
+		// Resize the container the same way the package does when reading it (without initializing the new items if the Vector hijacker was included for the container type).
+		template<class ContainerType>
+		static void resize(ContainerType &cont, const std::size_t newSize)
+		{
+			Storm::SerializePackage::resizeContainer(cont, newSize, 0);
+		}
+
 		void seekAbsolute(const std::size_t newPos);
 
 		const std::string& getFilePath() const noexcept;
@@ -180,9 +234,16 @@ namespace Storm
 
 		std::size_t getPacketSize() const;
 
+	private:
+		void flushWriteBuffer();
+
 	private:
 		bool _isSaving;
 		std::fstream _file;
 		const std::string _filePath;
+
+		// The pending writes. Its capacity is reserved once and never exceeded.
+		std::vector<char> _writeBuffer;
+		std::size_t _writeBufferCapacity;
 	};
 }
@@ -1,6 +1,12 @@
 #include "ThreadManager.h"
 
 #include "AsyncActionExecutor.h"
+#include "ParallelWorkerPool.h"
+
+#include "SingletonHolder.h"
+#include "IConfigManager.h"
+
+#include "GeneralSimulationConfig.h"
 
 #include "ThreadPriority.h"
 
@@ -38,6 +44,40 @@ namespace
 Storm::ThreadManager::ThreadManager() = default;
 Storm::ThreadManager::~ThreadManager() = default;
 
+void Storm::ThreadManager::initialize_Implementation()
+{
+	const Storm::IConfigManager &configMgr = Storm::SingletonHolder::instance().getSingleton<Storm::IConfigManager>();
+	const Storm::GeneralSimulationConfig &generalSimulationConfig = configMgr.getGeneralSimulationConfig();
+
+	if (generalSimulationConfig._useParallelWorkerPool)
+	{
+		// The thread starting a parallel loop takes part in it, so by default we leave it its own core.
+		std::size_t workerCount = generalSimulationConfig._parallelWorkerCount;
+		if (workerCount == 0)
+		{
+			workerCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+		}
+
+		_parallelWorkerPool = std::make_unique<Storm::ParallelWorkerPool>(workerCount, generalSimulationConfig._pinParallelWorkers, generalSimulationConfig._parallelGrainSize);
+		Storm::setParallelExecutor(_parallelWorkerPool.get());
+
+		LOG_COMMENT << "Parallel loops will be run on our worker pool (" << workerCount << " workers in addition to the calling thread).";
+	}
+	else
+	{
+		LOG_COMMENT << "Parallel worker pool is disabled, parallel loops will be run with the standard parallel execution policy.";
+	}
+}
+
+void Storm::ThreadManager::cleanUp_Implementation()
+{
+	if (_parallelWorkerPool != nullptr)
+	{
+		Storm::setParallelExecutor(nullptr);
+		_parallelWorkerPool.reset();
+	}
+}
+
 void Storm::ThreadManager::registerCurrentThread(Storm::ThreadEnumeration threadEnum, const std::wstring &newName)
 {
 	HRESULT res = ::SetThreadDescription(::GetCurrentThread(), newName.c_str());
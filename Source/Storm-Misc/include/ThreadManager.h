@@ -2,19 +2,23 @@
 
 #include "Singleton.h"
 #include "IThreadManager.h"
-#include "SingletonDefaultImplementation.h"
 
 
 namespace Storm
 {
 	class AsyncActionExecutor;
+	class ParallelWorkerPool;
 
 	class ThreadManager final :
-		private Storm::Singleton<ThreadManager, Storm::DefineDefaultInitAndCleanupImplementation>,
+		private Storm::Singleton<ThreadManager>,
 		public Storm::IThreadManager
 	{
 		STORM_DECLARE_SINGLETON(ThreadManager);
 
+	private:
+		void initialize_Implementation();
+		void cleanUp_Implementation();
+
 	public:
 		void registerCurrentThread(Storm::ThreadEnumeration threadEnum, const std::wstring &newName) final override;
 		void executeOnThread(const std::thread::id &threadId, Storm::AsyncAction &&action) final override;
@@ -38,5 +42,7 @@ namespace Storm
 		std::map<Storm::ThreadEnumeration, std::thread::id> _threadIdMapping;
 
 		std::map<Storm::ThreadEnumeration, std::vector<Storm::AsyncAction>> _pendingThreadsRegisteringActions;
+
+		std::unique_ptr<Storm::ParallelWorkerPool> _parallelWorkerPool;
 	};
 }
@@ -34,7 +34,11 @@ Storm::GeneralGraphicConfig::GeneralGraphicConfig() :
 
 Storm::GeneralSimulationConfig::GeneralSimulationConfig() :
 	_allowNoFluid{ false },
-	_stateRefreshFrameCount{ 0 }
+	_stateRefreshFrameCount{ 0 },
+	_useParallelWorkerPool{ true },
+	_parallelWorkerCount{ 0 },
+	_pinParallelWorkers{ false },
+	_parallelGrainSize{ 0 }
 {}
 
 Storm::GeneralNetworkConfig::GeneralNetworkConfig() :
@@ -55,6 +59,7 @@ Storm::GeneralDebugConfig::GeneralDebugConfig() :
 	_shouldLogGraphicDeviceMessage{ false },
 	_shouldLogPhysics{ false },
 	_profileSimulationSpeed{ false },
+	_profileParallelLoops{ false },
 	_displayVectoredExceptions{ Storm::VectoredExceptionDisplayMode::DisplayFatal },
 	_physXPvdDebugSocketSettings{ std::make_unique<Storm::SocketSetting>("127.0.0.1", 5425) },
 	_pvdConnectTimeoutMillisec{ 33 },
@@ -29,6 +29,7 @@ namespace Storm
 
 		// Profile
 		bool _profileSimulationSpeed;
+		bool _profileParallelLoops;
 
 		// PhysX
 		std::unique_ptr<Storm::SocketSetting> _physXPvdDebugSocketSettings;
@@ -12,5 +12,10 @@ namespace Storm
 		bool _allowNoFluid;
 
 		int64_t _stateRefreshFrameCount;
+
+		bool _useParallelWorkerPool;
+		unsigned int _parallelWorkerCount;
+		bool _pinParallelWorkers;
+		unsigned int _parallelGrainSize;
 	};
 }
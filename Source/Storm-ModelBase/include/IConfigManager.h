@@ -29,6 +29,7 @@ namespace Storm
 	struct SceneScriptConfig;
 	struct SceneCageConfig;
 	struct SceneSmokeEmitterConfig;
+	struct SceneOpenBoundaryConfig;
 
 	enum class ThreadPriority;
 	enum class VectoredExceptionDisplayMode;
@@ -78,6 +79,7 @@ namespace Storm
 		virtual const Storm::SceneScriptConfig& getSceneScriptConfig() const = 0;
 		virtual const std::vector<Storm::SceneSmokeEmitterConfig>& getSceneSmokeEmittersConfig() const = 0;
 		virtual const Storm::SceneSmokeEmitterConfig& getSceneSmokeEmitter(unsigned int emitterId) const = 0;
+		virtual const std::vector<Storm::SceneOpenBoundaryConfig>& getSceneOpenBoundariesConfig() const = 0;
 
 		virtual const Storm::SceneCageConfig* getSceneOptionalCageConfig() const = 0;
 
@@ -31,6 +31,9 @@ namespace Storm
 		virtual void getMeshTransform(unsigned int meshId, Storm::Vector3 &outTrans, Storm::Quaternion &outQuatRot) const = 0;
 		virtual void applyLocalForces(unsigned int particleSystemId, const std::vector<Storm::Vector3> &position, const std::vector<Storm::Vector3> &force) = 0;
 
+		// Apply the total force and torque of all particles at once (one call to the physics engine instead of one per particle). torque uses the same convention than applyLocalForces (force cross position, position in world space).
+		virtual void applyWrench(unsigned int particleSystemId, const Storm::Vector3 &force, const Storm::Vector3 &torque) = 0;
+
 		virtual void loadConstraints(const std::vector<Storm::SceneConstraintConfig> &constraintsToLoad) = 0;
 		virtual void addConstraint(const Storm::SceneConstraintConfig &constraintConfig) = 0;
 
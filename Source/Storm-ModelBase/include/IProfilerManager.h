@@ -23,5 +23,13 @@ namespace Storm
 		virtual void endSpeedProfile(const std::wstring_view &profileName) = 0;
 		virtual float getSpeedProfileAccumulatedTime() const = 0;
 		virtual float getCurrentSpeedProfile() const = 0;
+
+		// Fluid sleeping (see fluidSleepingStepCount). To be called once per iteration with the fluid particle counts during this iteration and its duration.
+		// The awake fluid ratio and the speedup the sleeping brought are logged when the profiler is cleaned up.
+		virtual void addFluidSleepingProfile(const std::size_t fluidParticleCount, const std::size_t awakeFluidParticleCount, const std::chrono::nanoseconds iterationDuration) = 0;
+
+		// Neighborhood storage. To be called once per iteration with the neighbor count of all particle systems, the memory their neighborhood storage use,
+		// and the memory the same neighborhoods would have used stored as one array of NeighborParticleInfo per particle. The peaks are logged when the profiler is cleaned up.
+		virtual void addNeighborhoodMemoryProfile(const std::size_t neighborCount, const std::size_t usedMemory, const std::size_t perParticleArrayLayoutMemory) = 0;
 	};
 }
@@ -6,6 +6,7 @@
 namespace Storm
 {
 	struct RaycastQueryRequest;
+	struct RaycastHitResult;
 
 	class IRaycastManager : public Storm::ISingletonHeldInterface<Storm::IRaycastManager>
 	{
@@ -15,5 +16,9 @@ namespace Storm
 	public:
 		virtual void queryRaycast(const Storm::Vector3 &origin, const Storm::Vector3 &direction, Storm::RaycastQueryRequest &&queryRequest) const = 0;
 		virtual void queryRaycast(const Storm::Vector2 &pixelScreenPos, Storm::RaycastQueryRequest &&queryRequest) const = 0;
+
+		// Trace all rays synchronously and in parallel, against the partitions selected by queryRequest (its callback isn't used and can be null). Should be called from the space partition thread.
+		// outResults[i] receives the hits of the ray going from origins[i] toward directions[i], sorted by distance (only the nearest one if queryRequest wants only the first hit).
+		virtual void queryRaycastBatch(const std::vector<Storm::Vector3> &origins, const std::vector<Storm::Vector3> &directions, const Storm::RaycastQueryRequest &queryRequest, std::vector<std::vector<Storm::RaycastHitResult>> &outResults) const = 0;
 	};
 }
@@ -21,7 +21,10 @@ namespace Storm
 		virtual ~ISerializerManager() = default;
 
 	public:
-		virtual void recordFrame(Storm::SerializeRecordPendingData &&frameRecord) = 0;
+		// The frame to fill before giving it to recordFrame. Frames are reused from one record to the other, so their arrays already have the capacity of the previous frames.
+		// Blocks if the serializer has too many frames left to write.
+		virtual std::unique_ptr<Storm::SerializeRecordPendingData> acquireRecordFrame() = 0;
+		virtual void recordFrame(std::unique_ptr<Storm::SerializeRecordPendingData> &&frameRecord) = 0;
 		virtual void beginRecord(Storm::SerializeRecordHeader &&recordHeader) = 0;
 
 		// The SerializerManager keeps the ownership of the header. But it shouldn't change after the first call to this method, therefore it is ok to share among other threads.
@@ -36,6 +39,9 @@ namespace Storm
 
 		virtual bool resetReplay() = 0;
 
+		// Position the replay so the next obtained frame is the last recorded frame before the physics time. Return false if there is no frame to go to.
+		virtual bool seekReplay(const float physicsTime) = 0;
+
 		virtual std::string getArchivePath() const = 0;
 
 	public:
@@ -3,6 +3,7 @@
 #include "SingletonHeldInterfaceBase.h"
 
 #include "SpacePartitionConstants.h"
+#include "NeighborParticleReferralBundle.h"
 
 namespace Storm
 {
@@ -13,6 +14,9 @@ namespace Storm
 
 	class ISpacePartitionerManager : public Storm::ISingletonHeldInterface<Storm::ISpacePartitionerManager>
 	{
+	public:
+		using BundleVisitor = std::function<void(const Storm::NeighborParticleReferralBundle &)>;
+
 	public:
 		virtual ~ISpacePartitionerManager() = default;
 
@@ -21,26 +25,56 @@ namespace Storm
 		virtual void partitionSpace() = 0;
 
 		// Reorder the space using the passed particle Positions. This does not clear the former reordering but add the particle positions to the right partition.
+		// Beware, a particle system should be registered only once between 2 clears.
 		virtual void computeSpaceReordering(const std::vector<Storm::Vector3> &particlePositions, Storm::PartitionSelection modality, const unsigned int systemId) = 0;
 
+		// Incremental alternative to a clear followed by computeSpaceReordering for all systems : prepareSpaceReorderingUpdate should be called once for each system registered since the last clear,
+		// then applySpaceReorderingUpdate patches only the voxels whose particles changed. Both return false if the update isn't possible (unknown system, particle count changed, too many moved particles, ...),
+		// in which case nothing was changed and the partition should be rebuilt (clear, then computeSpaceReordering).
+		// maxMovedParticleRatio is the ratio of particles (among all particles registered inside the partition) that changed of voxel above which we prefer the full rebuild.
+		virtual bool prepareSpaceReorderingUpdate(const std::vector<Storm::Vector3> &particlePositions, Storm::PartitionSelection modality, const unsigned int systemId) = 0;
+		virtual bool applySpaceReorderingUpdate(Storm::PartitionSelection modality, float maxMovedParticleRatio) = 0;
+
+		// To call once all systems were registered (computeSpaceReordering) or updated (applySpaceReorderingUpdate), before querying the partition. Some partitions (see Storm::SpacePartitionMode::Hashed)
+		// only sort the particles and build their lookup tables there, once for all systems.
+		virtual void finishSpaceReordering(Storm::PartitionSelection modality) = 0;
+
+		// Prevent the next incremental update of the partition, forcing a full rebuild. Should be called when the particle indexes changed without changing their count (i.e. reordering).
+		virtual void invalidateSpaceReorderingUpdate(Storm::PartitionSelection modality) = 0;
+
 		// Clear the space partition from all registered particle referrals for partition that aren't static. This does not remove the partition.
 		virtual void clearSpaceReorderingNoStatic() = 0;
 
 		// Clear the selected space partition from all registered particle referrals. This does not remove the partition.
 		virtual void clearSpaceReorderingForPartition(Storm::PartitionSelection modality) = 0;
 
+		// Static rigid bodies never move, so their partition only needs to be built once. Once frozen, the static partition is kept as is and shouldn't be refilled,
+		// until it is cleared (clearSpaceReorderingForPartition) or recreated (partitionSpace, setPartitionLength) : it would then be unfrozen.
+		virtual void freezeStaticPartition() = 0;
+		virtual bool isStaticPartitionFrozen() const noexcept = 0;
+
 		// Get the all bundles that can be considered as neighbor from the bundle referred by systemId containing the particlePosition. 
 		// Note that inOutContainingBundlePtr can also contain the particle at particlePosition.
-		virtual void getAllBundles(const std::vector<Storm::NeighborParticleReferral>* &outContainingBundlePtr, const std::vector<Storm::NeighborParticleReferral>*(&outNeighborBundle)[Storm::k_neighborLinkedBunkCount], const Storm::Vector3 &particlePosition, Storm::PartitionSelection modality) const = 0;
+		// The bundles are views owned by the calling thread. They stay valid until the next call to getAllBundles, getAllBundlesInfinite or getContainingBundle from the same thread, or until the partition is refreshed.
+		virtual void getAllBundles(const Storm::NeighborParticleReferralBundle* &outContainingBundlePtr, const Storm::NeighborParticleReferralBundle*(&outNeighborBundle)[Storm::k_neighborLinkedBunkCount], const Storm::Vector3 &particlePosition, Storm::PartitionSelection modality) const = 0;
 
 		// Get the all bundles that can be considered as neighbor from the bundle referred by systemId containing the particlePosition. 
 		// Note that inOutContainingBundlePtr can also contain the particle at particlePosition.
 		// This method is the overload that takes the infinite domain into account and should be called if isInfiniteDomainMode returns true instead of getAllBundles.
 		// reflectModality is the reflected modality of the last call to getAllBundlesInfinite (in the current thread). We provide our own OutReflectedModality and reflectModality would point to it. But another run of getAllBundlesInfinite (or getAllBundles) and the variable will be modified.
-		virtual void getAllBundlesInfinite(const std::vector<Storm::NeighborParticleReferral>* &outContainingBundlePtr, const std::vector<Storm::NeighborParticleReferral>*(&outNeighborBundle)[Storm::k_neighborLinkedBunkCount], const Storm::Vector3 &particlePosition, Storm::PartitionSelection modality, const Storm::OutReflectedModality* &reflectModality) const = 0;
+		virtual void getAllBundlesInfinite(const Storm::NeighborParticleReferralBundle* &outContainingBundlePtr, const Storm::NeighborParticleReferralBundle*(&outNeighborBundle)[Storm::k_neighborLinkedBunkCount], const Storm::Vector3 &particlePosition, Storm::PartitionSelection modality, const Storm::OutReflectedModality* &reflectModality) const = 0;
+
+		// Get the bundle containing particlePosition and only the neighbor bundles after it (half of the neighbor bundles, ended by a nullptr), without taking the infinite domain into account.
+		// If a particle only looks at the particles after it inside the containing bundle and at all particles of the forward bundles, each pair of neighbors of the same partition is visited only once.
+		// Same lifetime rules than the bundles returned by getAllBundles.
+		virtual void getForwardBundles(const Storm::NeighborParticleReferralBundle* &outContainingBundlePtr, const Storm::NeighborParticleReferralBundle*(&outForwardNeighborBundle)[Storm::k_neighborLinkedBunkCount], const Storm::Vector3 &particlePosition, Storm::PartitionSelection modality) const = 0;
+
+		// Get the containing bundle containing particlePosition. Same lifetime rules than the bundles returned by getAllBundles.
+		virtual void getContainingBundle(const Storm::NeighborParticleReferralBundle* &containingBundlePtr, const Storm::Vector3 &particlePosition, Storm::PartitionSelection modality) const = 0;
 
-		// Get the containing bundle containing particlePosition.
-		virtual void getContainingBundle(const std::vector<Storm::NeighborParticleReferral>* &containingBundlePtr, const Storm::Vector3 &particlePosition, Storm::PartitionSelection modality) const = 0;
+		// Visit the non empty bundles whose cell overlaps the axis aligned box between minCorner and maxCorner, without taking the infinite domain into account.
+		// A bundle can contain particles outside the box (the cells are bigger), and remains valid only during the visit.
+		virtual void visitBundlesInsideBox(const Storm::Vector3 &minCorner, const Storm::Vector3 &maxCorner, Storm::PartitionSelection modality, const Storm::ISpacePartitionerManager::BundleVisitor &visitor) const = 0;
 
 		// Set the partition length used when partitioning the space. The length is the length of one partition.
 		// Beware since setting it will automatically reset the partitioning (recreate all partitions and clear the particle referrals).
@@ -0,0 +1,10 @@
+#pragma once
+
+
+namespace Storm
+{
+	struct NeighborParticleReferral;
+
+	// A bundle is a contiguous view over the particle referrals registered inside one cell of a space partition. It doesn't own the referrals.
+	using NeighborParticleReferralBundle = std::span<const Storm::NeighborParticleReferral>;
+}
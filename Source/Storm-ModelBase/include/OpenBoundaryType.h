@@ -0,0 +1,17 @@
+#pragma once
+
+
+namespace Storm
+{
+	enum class OpenBoundaryType
+	{
+		// The bad value...
+		None,
+
+		// Fluid particles are injected inside the domain, layer by layer, with an imposed velocity.
+		Inflow,
+
+		// Fluid particles entering the zone are removed from the domain.
+		Outflow,
+	};
+}
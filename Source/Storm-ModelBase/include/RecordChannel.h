@@ -0,0 +1,31 @@
+#pragma once
+
+#include "BitField.h"
+
+
+namespace Storm
+{
+	// The per particle channels a record frame can hold. Positions are always recorded.
+	enum class RecordChannel : uint16_t
+	{
+		None =									0x0,
+		Positions =								0b0000000000000001,
+		Velocities =							0b0000000000000010,
+		Forces =								0b0000000000000100,
+		Densities =								0b0000000000001000,
+		Pressures =								0b0000000000010000,
+		Volumes =								0b0000000000100000,
+		Normals =								0b0000000001000000,
+		PressureForces =						0b0000000010000000,
+		ViscosityForces =						0b0000000100000000,
+		DragForces =							0b0000001000000000,
+		DynamicPressureQForces =				0b0000010000000000,
+		NoStickForces =							0b0000100000000000,
+		CoandaForces =							0b0001000000000000,
+		IntermediaryDensityPressureForces =		0b0010000000000000,
+		IntermediaryVelocityPressureForces =	0b0100000000000000,
+		BlowerForces =							0b1000000000000000,
+
+		All =									0b1111111111111111,
+	};
+}
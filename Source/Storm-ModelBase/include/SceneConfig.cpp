@@ -13,7 +13,9 @@
 #include "SceneFluidCustomDFSPHConfig.h"
 #include "SceneFluidCustomPCISPHConfig.h"
 #include "SceneFluidCustomIISPHConfig.h"
+#include "SceneFluidCustomCGSPHConfig.h"
 #include "SceneCageConfig.h"
+#include "SceneOpenBoundaryConfig.h"
 
 #include "CollisionType.h"
 #include "ConstraintType.h"
@@ -23,10 +25,13 @@
 #include "BlowerType.h"
 #include "InsideParticleRemovalTechnique.h"
 #include "RecordMode.h"
+#include "RecordChannel.h"
 #include "LayeringGenerationTechnique.h"
 #include "ViscosityMethod.h"
 #include "VolumeComputationTechnique.h"
 #include "ParticleRemovalMode.h"
+#include "OpenBoundaryType.h"
+#include "SpacePartitionMode.h"
 
 
 namespace
@@ -75,6 +80,17 @@ Storm::SceneSimulationConfig::SceneSimulationConfig() :
 	_maxKernelIncrementCoeff{ 0.f },
 	_maxCFLTime{ 0.5f },
 	_recomputeNeighborhoodStep{ 1 },
+	_neighborhoodSkinCoeff{ 0.1f },
+	_incrementalPartitionThreshold{ 0.f },
+	_spacePartitionMode{ Storm::SpacePartitionMode::Dense },
+	_cacheStaticVolumes{ false },
+	_symmetricNeighborSearch{ false },
+	_fluidSleepingStepCount{ 0 },
+	_fluidSleepingVelocityThreshold{ 0.01f },
+	_fluidSleepingDensityErrorThreshold{ 0.01f },
+	_fluidSleepingAccelerationThreshold{ 0.1f },
+	_particleReorderingStep{ 0 },
+	_particleReorderingLocalityThreshold{ 0.f },
 	_midUpdateViscosity{ false },
 	_simulationNoWait{ false },
 	_hasFluid{ true },
@@ -88,6 +104,7 @@ Storm::SceneSimulationConfig::SceneSimulationConfig() :
 	_fluidParticleRemovalMode{ Storm::ParticleRemovalMode::Sphere },
 	_removeFluidForVolumeConsistency{ false },
 	_freeRbAtPhysicsTime{ -1.f },
+	_applyRbForcesPerParticle{ false },
 	_noStickConstraint{ false },
 	_applyDragEffect{ false },
 	_useCoandaEffect{ false },
@@ -203,6 +220,15 @@ Storm::SceneFluidCustomPCISPHConfig::SceneFluidCustomPCISPHConfig() :
 }
 
 Storm::SceneFluidCustomIISPHConfig::SceneFluidCustomIISPHConfig() :
+	_minPredictIteration{ 2 },
+	_maxPredictIteration{ 150 },
+	_maxError{ 0.01f },
+	_enableWarmStart{ false }
+{
+
+}
+
+Storm::SceneFluidCustomCGSPHConfig::SceneFluidCustomCGSPHConfig() :
 	_minPredictIteration{ 2 },
 	_maxPredictIteration{ 150 },
 	_maxError{ 0.01f }
@@ -216,6 +242,7 @@ Storm::SceneFluidCustomDFSPHConfig::SceneFluidCustomDFSPHConfig() :
 	_enableThresholdDensity{ true },
 	_useFixRotation{ true },
 	_enableDensitySolve{ true },
+	_enableWarmStart{ false },
 	_useBernoulliPrinciple{ false },
 	_minPredictIteration{ 2 },
 	_maxPredictIteration{ 150 },
@@ -284,7 +311,12 @@ Storm::SceneRecordConfig::SceneRecordConfig() :
 	_recordFps{ -1.f },
 	_recordFilePath{},
 	_replayRealTime{ true },
-	_leanStartJump{ 1 }
+	_leanStartJump{ 1 },
+	_writeBufferSizeInKb{ 8192 },
+	_compressRecord{ true },
+	_positionPrecision{ 0.f },
+	_keyFrameInterval{ 32 },
+	_recordedChannels{ Storm::RecordChannel::All }
 {
 
 }
@@ -320,6 +352,15 @@ Storm::SceneSmokeEmitterConfig::SceneSmokeEmitterConfig() :
 	_emitterEndTimeSeconds{ std::numeric_limits<decltype(_emitterEndTimeSeconds)>::quiet_NaN() }
 {}
 
+Storm::SceneOpenBoundaryConfig::SceneOpenBoundaryConfig() :
+	_openBoundaryId{ std::numeric_limits<decltype(_openBoundaryId)>::max() },
+	_type{ Storm::OpenBoundaryType::None },
+	_boxMin{ dummyMandatoryVector3ForMin() },
+	_boxMax{ dummyMandatoryVector3ForMax() },
+	_velocity{ Storm::Vector3::Zero() },
+	_reservedLayerCount{ 32 }
+{}
+
 Storm::SceneConfig::SceneConfig() = default;
 
 // Needed for prototypes. Otherwise, std::vector declared inside this structure won't compile anywhere else because the underlying structure wasn't defined (vector cannot destroy undefined element)...
@@ -15,6 +15,7 @@ namespace Storm
 	struct SceneConstraintConfig;
 	struct SceneCageConfig;
 	struct SceneSmokeEmitterConfig;
+	struct SceneOpenBoundaryConfig;
 
 	struct SceneConfig
 	{
@@ -36,5 +37,6 @@ namespace Storm
 		std::vector<Storm::SceneBlowerConfig> _blowersConfig;
 		std::vector<Storm::SceneConstraintConfig> _contraintsConfig;
 		std::vector<Storm::SceneSmokeEmitterConfig> _smokeEmittersConfig;
+		std::vector<Storm::SceneOpenBoundaryConfig> _openBoundariesConfig;
 	};
 }
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "SceneFluidDefaultCustomConfig.h"
+
+
+namespace Storm
+{
+	struct SceneFluidCustomCGSPHConfig : public Storm::SceneFluidDefaultCustomConfig
+	{
+	public:
+		SceneFluidCustomCGSPHConfig();
+
+	public:
+		unsigned int _maxPredictIteration;
+		unsigned int _minPredictIteration;
+		float _maxError;
+	};
+}
@@ -15,6 +15,7 @@ namespace Storm
 		bool _enableThresholdDensity;
 		bool _useFixRotation;
 		bool _enableDensitySolve;
+		bool _enableWarmStart;
 
 		float _kPressurePredictedCoeff; // This one is for testing... This is the multiplication factor for the kDFSPH and co. It doesn't exist inside the true formula (therefore should be 1.f in the real DFSPH method)
 		
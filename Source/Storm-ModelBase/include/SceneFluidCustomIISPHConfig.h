@@ -14,5 +14,6 @@ namespace Storm
 		unsigned int _maxPredictIteration;
 		unsigned int _minPredictIteration;
 		float _maxError;
+		bool _enableWarmStart;
 	};
 }
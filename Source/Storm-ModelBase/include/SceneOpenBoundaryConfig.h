@@ -0,0 +1,24 @@
+#pragma once
+
+
+namespace Storm
+{
+	enum class OpenBoundaryType;
+
+	struct SceneOpenBoundaryConfig
+	{
+	public:
+		SceneOpenBoundaryConfig();
+
+	public:
+		unsigned int _openBoundaryId;
+		Storm::OpenBoundaryType _type;
+
+		Storm::Vector3 _boxMin;
+		Storm::Vector3 _boxMax;
+
+		// Inflow only.
+		Storm::Vector3 _velocity;
+		unsigned int _reservedLayerCount;
+	};
+}
@@ -4,6 +4,7 @@
 namespace Storm
 {
 	enum class RecordMode;
+	enum class RecordChannel : uint16_t;
 
 	struct SceneRecordConfig
 	{
@@ -16,5 +17,12 @@ namespace Storm
 		std::string _recordFilePath;
 		bool _replayRealTime;
 		unsigned int _leanStartJump;
+		unsigned int _writeBufferSizeInKb;
+
+		bool _compressRecord;
+		float _positionPrecision;
+		unsigned int _keyFrameInterval;
+
+		Storm::RecordChannel _recordedChannels;
 	};
 }
@@ -7,6 +7,7 @@ namespace Storm
 	enum class KernelMode;
 	enum class ViscosityMethod;
 	enum class ParticleRemovalMode;
+	enum class SpacePartitionMode;
 
 	struct SceneSimulationConfig
 	{
@@ -37,6 +38,22 @@ namespace Storm
 		bool _simulationNoWait;
 
 		unsigned char _recomputeNeighborhoodStep;
+		float _neighborhoodSkinCoeff;
+		float _incrementalPartitionThreshold;
+
+		Storm::SpacePartitionMode _spacePartitionMode;
+
+		bool _cacheStaticVolumes;
+
+		bool _symmetricNeighborSearch;
+
+		unsigned int _fluidSleepingStepCount;
+		float _fluidSleepingVelocityThreshold;
+		float _fluidSleepingDensityErrorThreshold;
+		float _fluidSleepingAccelerationThreshold;
+
+		unsigned int _particleReorderingStep;
+		float _particleReorderingLocalityThreshold;
 
 		Storm::SimulationMode _simulationMode;
 		std::string _simulationModeStr;
@@ -49,6 +66,8 @@ namespace Storm
 		bool _fixRigidBodyAtStartTime;
 		float _freeRbAtPhysicsTime;
 
+		bool _applyRbForcesPerParticle;
+
 		float _endSimulationPhysicsTimeInSeconds;
 
 		bool _shouldRemoveRbCollidingPAtStateFileLoad;
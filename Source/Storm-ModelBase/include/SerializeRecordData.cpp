@@ -7,6 +7,8 @@
 #include "SerializeRecordParticleSystemData.h"
 #include "SerializeRecordContraintsData.h"
 
+#include "RecordChannel.h"
+
 
 Storm::SerializeSupportedFeatureLayout::SerializeSupportedFeatureLayout()
 {
@@ -15,7 +17,12 @@ Storm::SerializeSupportedFeatureLayout::SerializeSupportedFeatureLayout()
 
 Storm::SerializeRecordHeader::SerializeRecordHeader() :
 	_supportedFeaturesLayout{ std::make_shared<Storm::SerializeSupportedFeatureLayout>() },
-	_realEndPhysicsTime{ std::numeric_limits<float>::quiet_NaN() }
+	_realEndPhysicsTime{ std::numeric_limits<float>::quiet_NaN() },
+	_frameIndexPosition{ 0 },
+	_keyFrameInterval{ 1 },
+	_positionPrecision{ 0.f },
+	_positionQuantizationOrigin{ Storm::Vector3::Zero() },
+	_recordedChannels{ Storm::RecordChannel::All }
 {}
 
 Storm::SerializeRecordHeader::SerializeRecordHeader(Storm::SerializeRecordHeader &&) = default;
@@ -6,6 +6,7 @@ namespace Storm
 	struct SerializeParticleSystemLayout;
 	struct SerializeConstraintLayout;
 	struct SerializeSupportedFeatureLayout;
+	enum class RecordChannel : uint16_t;
 
 	struct SerializeRecordHeader
 	{
@@ -21,6 +22,18 @@ namespace Storm
 		uint8_t _infiniteDomain;
 		uint64_t _frameCount;
 		float _realEndPhysicsTime;
+		uint64_t _frameIndexPosition; // Where the frame index (physics time and position of each frame) is written inside the record file. 0 if there is none.
+
+		// Frames are encoded against the previous one, except key frames that are encoded on their own. Reading a frame needs to start from the key frame before.
+		uint32_t _keyFrameInterval;
+
+		// The grid the particle positions are snapped onto. A precision of 0 means the positions aren't quantized.
+		float _positionPrecision;
+		Storm::Vector3 _positionQuantizationOrigin;
+
+		// The per particle channels written inside the frames. The others are absent from the record.
+		Storm::RecordChannel _recordedChannels;
+
 		std::vector<Storm::SerializeParticleSystemLayout> _particleSystemLayouts;
 		std::vector<Storm::SerializeConstraintLayout> _contraintLayouts;
 		std::shared_ptr<Storm::SerializeSupportedFeatureLayout> _supportedFeaturesLayout;
@@ -25,5 +25,9 @@ namespace Storm
 		uint8_t _hasCoandaForces : 1;
 		uint8_t _hasKernelLength : 1;
 		uint8_t _hasInfiniteDomainFlag : 1;
+		uint8_t _hasVelocities : 1;
+		uint8_t _hasForces : 1;
+		uint8_t _hasPressureComponentforces : 1;
+		uint8_t _hasViscosityComponentforces : 1;
 	};
 }
@@ -10,5 +10,6 @@ namespace Storm
 		PCISPH,
 		IISPH,
 		DFSPH,
+		CGSPH,
 	};
 }
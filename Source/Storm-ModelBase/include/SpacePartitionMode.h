@@ -0,0 +1,14 @@
+#pragma once
+
+
+namespace Storm
+{
+	enum class SpacePartitionMode
+	{
+		// Every voxel of the domain exists. Fastest to query, but the memory grows with the domain volume.
+		Dense,
+
+		// Only the voxels containing particles exist (spatial hash). The memory grows with the particle count, but the queries are slower. Only for big and mostly empty domains.
+		Hashed,
+	};
+}
@@ -138,6 +138,13 @@ void Storm::PhysicsDynamicRigidBody::applyForce(const Storm::Vector3 &location,
 #endif
 }
 
+void Storm::PhysicsDynamicRigidBody::applyWrench(const Storm::Vector3 &force, const Storm::Vector3 &torque)
+{
+	// Same as the sum of applyForce calls, but only 2 calls to PhysX.
+	_internalRb->addForce(Storm::convertToPx(force));
+	_internalRb->addTorque(Storm::convertToPx(torque));
+}
+
 Storm::Vector3 Storm::PhysicsDynamicRigidBody::getPhysicAppliedForce() const noexcept
 {
 	Storm::Vector3 force = _internalRb->getMass() * Storm::PhysicsManager::instance().getPhysXHandler().getGravity();
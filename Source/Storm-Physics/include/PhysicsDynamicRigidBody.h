@@ -29,6 +29,7 @@ namespace Storm
 		void getMeshTransform(Storm::Vector3 &outTrans, Storm::Quaternion &outQuatRot) const;
 
 		void applyForce(const Storm::Vector3 &location, const Storm::Vector3 &force);
+		void applyWrench(const Storm::Vector3 &force, const Storm::Vector3 &torque);
 		Storm::Vector3 getPhysicAppliedForce() const noexcept;
 		Storm::Vector3 getTotalForce(const float deltaTime) const noexcept;
 
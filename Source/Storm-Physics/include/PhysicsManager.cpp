@@ -504,6 +504,25 @@ void Storm::PhysicsManager::applyLocalForces(unsigned int particleSystemId, cons
 	}
 }
 
+void Storm::PhysicsManager::applyWrench(unsigned int particleSystemId, const Storm::Vector3 &force, const Storm::Vector3 &torque)
+{
+	if (!_rigidBodiesFixated)
+	{
+		if (const auto dynamicFound = _dynamicsRbMap.find(particleSystemId); dynamicFound != std::end(_dynamicsRbMap))
+		{
+			Storm::PhysicsDynamicRigidBody &dynamicRb = *dynamicFound->second;
+			if (!dynamicRb.isAnimated())
+			{
+				dynamicRb.applyWrench(force, torque);
+			}
+		}
+		else
+		{
+			assert(_staticsRbMap.find(particleSystemId) != std::end(_staticsRbMap) && "Cannot find requested physics rigid body!");
+		}
+	}
+}
+
 void Storm::PhysicsManager::getMeshTransform(unsigned int meshId, Storm::Vector3 &outTrans, Storm::Quaternion &outQuatRot) const
 {
 	Storm::SearchAlgo::executeOnObjectInContainer(meshId, [&outTrans, &outQuatRot](const auto &rbFound)
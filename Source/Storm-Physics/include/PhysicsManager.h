@@ -40,6 +40,7 @@ namespace Storm
 		void getMeshTransform(unsigned int meshId, Storm::Vector3 &outTrans, Storm::Rotation &outRot) const final override;
 		void getMeshTransform(unsigned int meshId, Storm::Vector3 &outTrans, Storm::Quaternion &outQuatRot) const final override;
 		void applyLocalForces(unsigned int particleSystemId, const std::vector<Storm::Vector3> &position, const std::vector<Storm::Vector3> &force) final override;
+		void applyWrench(unsigned int particleSystemId, const Storm::Vector3 &force, const Storm::Vector3 &torque) final override;
 
 		void addConstraint(const Storm::SceneConstraintConfig &constraintConfig) final override;
 		void loadConstraints(const std::vector<Storm::SceneConstraintConfig> &constraintsToLoad) final override;
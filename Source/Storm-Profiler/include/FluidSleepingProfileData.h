@@ -0,0 +1,21 @@
+#pragma once
+
+
+namespace Storm
+{
+	struct FluidSleepingProfileData
+	{
+	public:
+		std::size_t _iterationCount = 0;
+		double _accumulatedAwakeRatio = 0.0;
+		double _minAwakeRatio = 1.0;
+
+		// The iterations without any sleeping fluid particle are the reference to compare the iterations with sleeping particles to.
+		std::size_t _fullyAwakeIterationCount = 0;
+		std::chrono::nanoseconds _fullyAwakeAccumulatedDuration{ 0 };
+
+		std::size_t _sleepingIterationCount = 0;
+		std::chrono::nanoseconds _sleepingAccumulatedDuration{ 0 };
+		double _sleepingAccumulatedAwakeRatio = 0.0;
+	};
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+
+namespace Storm
+{
+	struct NeighborhoodMemoryProfileData
+	{
+	public:
+		std::size_t _iterationCount = 0;
+		std::size_t _accumulatedNeighborCount = 0;
+
+		// The peaks are what decide if a scene fits in memory.
+		std::size_t _peakNeighborCount = 0;
+		std::size_t _peakUsedMemory = 0;
+		std::size_t _peakPerParticleArrayLayoutMemory = 0;
+	};
+}
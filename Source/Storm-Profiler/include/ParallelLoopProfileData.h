@@ -0,0 +1,25 @@
+#pragma once
+
+
+namespace Storm
+{
+	struct ParallelLoopProfileData
+	{
+	public:
+		void merge(const Storm::ParallelLoopProfileData &other)
+		{
+			_functionName = other._functionName;
+			_callCount += other._callCount;
+			_accumulatedItemCount += other._accumulatedItemCount;
+			_accumulatedDuration += other._accumulatedDuration;
+			_maxDuration = std::max(_maxDuration, other._maxDuration);
+		}
+
+	public:
+		const char* _functionName = nullptr;
+		std::size_t _callCount = 0;
+		std::size_t _accumulatedItemCount = 0;
+		std::chrono::nanoseconds _accumulatedDuration{ 0 };
+		std::chrono::nanoseconds _maxDuration{ 0 };
+	};
+}
@@ -7,9 +7,20 @@
 
 #include "GeneralDebugConfig.h"
 
+#include "ParallelExecutor.h"
+
+
+namespace
+{
+	void onParallelLoopEnded(const std::source_location &location, const std::size_t itemCount, const std::chrono::nanoseconds duration)
+	{
+		Storm::ProfilerManager::instance().addParallelLoopProfile(location, itemCount, duration);
+	}
+}
 
 Storm::ProfilerManager::ProfilerManager() :
-	_speedProfile{ false }
+	_speedProfile{ false },
+	_parallelLoopProfile{ false }
 {}
 
 Storm::ProfilerManager::~ProfilerManager() = default;
@@ -19,7 +30,34 @@ void Storm::ProfilerManager::initialize_Implementation()
 	const Storm::SingletonHolder &singletonHolder = Storm::SingletonHolder::instance();
 	const Storm::IConfigManager &configMgr = singletonHolder.getSingleton<Storm::IConfigManager>();
 
-	_speedProfile = configMgr.getGeneralDebugConfig()._profileSimulationSpeed;
+	const Storm::GeneralDebugConfig &generalDebugConfig = configMgr.getGeneralDebugConfig();
+
+	_speedProfile = generalDebugConfig._profileSimulationSpeed;
+
+	_parallelLoopProfile = generalDebugConfig._profileParallelLoops;
+	if (_parallelLoopProfile)
+	{
+		Storm::setParallelLoopProfileHook(onParallelLoopEnded);
+	}
+}
+
+void Storm::ProfilerManager::cleanUp_Implementation()
+{
+	if (_parallelLoopProfile)
+	{
+		Storm::setParallelLoopProfileHook(nullptr);
+		this->logParallelLoopProfiles();
+	}
+
+	if (_fluidSleepingProfile._iterationCount != 0)
+	{
+		this->logFluidSleepingProfile();
+	}
+
+	if (_neighborhoodMemoryProfile._iterationCount != 0)
+	{
+		this->logNeighborhoodMemoryProfile();
+	}
 }
 
 void Storm::ProfilerManager::registerCurrentThreadAsSimulationThread(const std::wstring_view &profileName)
@@ -91,3 +129,203 @@ float Storm::ProfilerManager::getCurrentSpeedProfile() const
 
 	return 0.f;
 }
+
+void Storm::ProfilerManager::addFluidSleepingProfile(const std::size_t fluidParticleCount, const std::size_t awakeFluidParticleCount, const std::chrono::nanoseconds iterationDuration)
+{
+	if (fluidParticleCount == 0)
+	{
+		return;
+	}
+
+	const double awakeRatio = static_cast<double>(awakeFluidParticleCount) / static_cast<double>(fluidParticleCount);
+
+	++_fluidSleepingProfile._iterationCount;
+	_fluidSleepingProfile._accumulatedAwakeRatio += awakeRatio;
+	_fluidSleepingProfile._minAwakeRatio = std::min(_fluidSleepingProfile._minAwakeRatio, awakeRatio);
+
+	if (awakeFluidParticleCount == fluidParticleCount)
+	{
+		++_fluidSleepingProfile._fullyAwakeIterationCount;
+		_fluidSleepingProfile._fullyAwakeAccumulatedDuration += iterationDuration;
+	}
+	else
+	{
+		++_fluidSleepingProfile._sleepingIterationCount;
+		_fluidSleepingProfile._sleepingAccumulatedDuration += iterationDuration;
+		_fluidSleepingProfile._sleepingAccumulatedAwakeRatio += awakeRatio;
+	}
+}
+
+void Storm::ProfilerManager::addNeighborhoodMemoryProfile(const std::size_t neighborCount, const std::size_t usedMemory, const std::size_t perParticleArrayLayoutMemory)
+{
+	++_neighborhoodMemoryProfile._iterationCount;
+	_neighborhoodMemoryProfile._accumulatedNeighborCount += neighborCount;
+
+	_neighborhoodMemoryProfile._peakNeighborCount = std::max(_neighborhoodMemoryProfile._peakNeighborCount, neighborCount);
+	_neighborhoodMemoryProfile._peakUsedMemory = std::max(_neighborhoodMemoryProfile._peakUsedMemory, usedMemory);
+	_neighborhoodMemoryProfile._peakPerParticleArrayLayoutMemory = std::max(_neighborhoodMemoryProfile._peakPerParticleArrayLayoutMemory, perParticleArrayLayoutMemory);
+}
+
+void Storm::ProfilerManager::addParallelLoopProfile(const std::source_location &location, const std::size_t itemCount, const std::chrono::nanoseconds duration)
+{
+	thread_local ParallelLoopThreadProfiles* t_threadProfiles = nullptr;
+	if (t_threadProfiles == nullptr)
+	{
+		std::lock_guard<std::mutex> lock{ _parallelLoopProfileMutex };
+		t_threadProfiles = _parallelLoopThreadProfiles.emplace_back(std::make_unique<ParallelLoopThreadProfiles>()).get();
+	}
+
+	std::lock_guard<std::mutex> lock{ t_threadProfiles->_mutex };
+
+	Storm::ParallelLoopProfileData &profileData = t_threadProfiles->_profiles[ParallelLoopProfileKey{ location.file_name(), location.line() }];
+	profileData._functionName = location.function_name();
+	++profileData._callCount;
+	profileData._accumulatedItemCount += itemCount;
+	profileData._accumulatedDuration += duration;
+	profileData._maxDuration = std::max(profileData._maxDuration, duration);
+}
+
+void Storm::ProfilerManager::logParallelLoopProfiles() const
+{
+	using ProfileEntry = ParallelLoopProfileMap::value_type;
+
+	ParallelLoopProfileMap parallelLoopProfiles;
+	{
+		std::lock_guard<std::mutex> lock{ _parallelLoopProfileMutex };
+		for (const std::unique_ptr<ParallelLoopThreadProfiles> &threadProfiles : _parallelLoopThreadProfiles)
+		{
+			std::lock_guard<std::mutex> threadLock{ threadProfiles->_mutex };
+			for (const ProfileEntry &threadProfile : threadProfiles->_profiles)
+			{
+				parallelLoopProfiles[threadProfile.first].merge(threadProfile.second);
+			}
+		}
+	}
+
+	std::vector<const ProfileEntry*> sortedProfiles;
+	sortedProfiles.reserve(parallelLoopProfiles.size());
+	for (const ProfileEntry &profile : parallelLoopProfiles)
+	{
+		sortedProfiles.emplace_back(&profile);
+	}
+
+	// The most time consuming loops first.
+	std::sort(std::begin(sortedProfiles), std::end(sortedProfiles), [](const ProfileEntry* left, const ProfileEntry* right)
+	{
+		return left->second._accumulatedDuration > right->second._accumulatedDuration;
+	});
+
+	std::string profileReport;
+	profileReport.reserve(sortedProfiles.size() * 256);
+
+	for (const ProfileEntry* profile : sortedProfiles)
+	{
+		const Storm::ParallelLoopProfileData &profileData = profile->second;
+		const double accumulatedMs = std::chrono::duration<double, std::milli>{ profileData._accumulatedDuration }.count();
+
+		profileReport += "\n";
+		profileReport += profile->first.first;
+		profileReport += "(";
+		profileReport += std::to_string(profile->first.second);
+		profileReport += ") ";
+		profileReport += profileData._functionName;
+		profileReport += " : ";
+		profileReport += std::to_string(profileData._callCount);
+		profileReport += " calls, ";
+		profileReport += std::to_string(accumulatedMs);
+		profileReport += " ms total, ";
+		profileReport += std::to_string(accumulatedMs / static_cast<double>(profileData._callCount));
+		profileReport += " ms average, ";
+		profileReport += std::to_string(std::chrono::duration<double, std::milli>{ profileData._maxDuration }.count());
+		profileReport += " ms max, ";
+		profileReport += std::to_string(profileData._accumulatedItemCount / profileData._callCount);
+		profileReport += " items average.";
+	}
+
+	LOG_COMMENT << "Parallel loops profile (" << sortedProfiles.size() << " loops) :" << profileReport;
+}
+
+void Storm::ProfilerManager::logFluidSleepingProfile() const
+{
+	const auto averageIterationMs = [](const std::chrono::nanoseconds accumulatedDuration, const std::size_t iterationCount)
+	{
+		return std::chrono::duration<double, std::milli>{ accumulatedDuration }.count() / static_cast<double>(iterationCount);
+	};
+
+	std::string profileReport;
+	profileReport.reserve(512);
+
+	profileReport += "\nAwake fluid ratio : ";
+	profileReport += std::to_string(100.0 * _fluidSleepingProfile._accumulatedAwakeRatio / static_cast<double>(_fluidSleepingProfile._iterationCount));
+	profileReport += "% average, ";
+	profileReport += std::to_string(100.0 * _fluidSleepingProfile._minAwakeRatio);
+	profileReport += "% min.";
+
+	if (_fluidSleepingProfile._fullyAwakeIterationCount != 0)
+	{
+		profileReport += "\nIterations without sleeping particles : ";
+		profileReport += std::to_string(_fluidSleepingProfile._fullyAwakeIterationCount);
+		profileReport += ", ";
+		profileReport += std::to_string(averageIterationMs(_fluidSleepingProfile._fullyAwakeAccumulatedDuration, _fluidSleepingProfile._fullyAwakeIterationCount));
+		profileReport += " ms average.";
+	}
+
+	if (_fluidSleepingProfile._sleepingIterationCount != 0)
+	{
+		profileReport += "\nIterations with sleeping particles : ";
+		profileReport += std::to_string(_fluidSleepingProfile._sleepingIterationCount);
+		profileReport += ", ";
+		profileReport += std::to_string(averageIterationMs(_fluidSleepingProfile._sleepingAccumulatedDuration, _fluidSleepingProfile._sleepingIterationCount));
+		profileReport += " ms average, ";
+		profileReport += std::to_string(100.0 * _fluidSleepingProfile._sleepingAccumulatedAwakeRatio / static_cast<double>(_fluidSleepingProfile._sleepingIterationCount));
+		profileReport += "% awake average.";
+	}
+
+	// Both kinds of iterations don't simulate the same state of the scene (the fluid sleeps once it settled), so this is only an estimation.
+	if (_fluidSleepingProfile._fullyAwakeIterationCount != 0 && _fluidSleepingProfile._sleepingIterationCount != 0)
+	{
+		profileReport += "\nEstimated speedup of the iterations with sleeping particles : x";
+		profileReport += std::to_string(
+			averageIterationMs(_fluidSleepingProfile._fullyAwakeAccumulatedDuration, _fluidSleepingProfile._fullyAwakeIterationCount) /
+			averageIterationMs(_fluidSleepingProfile._sleepingAccumulatedDuration, _fluidSleepingProfile._sleepingIterationCount)
+		);
+	}
+
+	LOG_COMMENT << "Fluid sleeping profile (" << _fluidSleepingProfile._iterationCount << " iterations) :" << profileReport;
+}
+
+void Storm::ProfilerManager::logNeighborhoodMemoryProfile() const
+{
+	const auto toMegaBytes = [](const std::size_t byteCount)
+	{
+		return static_cast<double>(byteCount) / (1024.0 * 1024.0);
+	};
+
+	std::string profileReport;
+	profileReport.reserve(512);
+
+	profileReport += "\nNeighbors : ";
+	profileReport += std::to_string(_neighborhoodMemoryProfile._accumulatedNeighborCount / _neighborhoodMemoryProfile._iterationCount);
+	profileReport += " average, ";
+	profileReport += std::to_string(_neighborhoodMemoryProfile._peakNeighborCount);
+	profileReport += " peak.";
+
+	profileReport += "\nNeighborhood storage peak memory : ";
+	profileReport += std::to_string(toMegaBytes(_neighborhoodMemoryProfile._peakUsedMemory));
+	profileReport += " MB.";
+
+	profileReport += "\nAn array of NeighborParticleInfo per particle would have taken at least : ";
+	profileReport += std::to_string(toMegaBytes(_neighborhoodMemoryProfile._peakPerParticleArrayLayoutMemory));
+	profileReport += " MB at peak";
+
+	if (_neighborhoodMemoryProfile._peakUsedMemory != 0)
+	{
+		profileReport += " (x";
+		profileReport += std::to_string(static_cast<double>(_neighborhoodMemoryProfile._peakPerParticleArrayLayoutMemory) / static_cast<double>(_neighborhoodMemoryProfile._peakUsedMemory));
+		profileReport += ')';
+	}
+
+	profileReport += '.';
+
+	LOG_COMMENT << "Neighborhood memory profile (" << _neighborhoodMemoryProfile._iterationCount << " iterations) :" << profileReport;
+}
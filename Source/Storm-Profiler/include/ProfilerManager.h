@@ -1,22 +1,28 @@
 #pragma once
 
 #include "Singleton.h"
-#include "SingletonDefaultImplementation.h"
 #include "IProfilerManager.h"
 
+#include "ParallelLoopProfileData.h"
+#include "FluidSleepingProfileData.h"
+#include "NeighborhoodMemoryProfileData.h"
+
+#include <source_location>
+
 
 namespace Storm
 {
 	class SpeedProfileHandler;
 
 	class ProfilerManager final :
-		private Storm::Singleton<Storm::ProfilerManager, Storm::DefineDefaultCleanupImplementationOnly>,
+		private Storm::Singleton<Storm::ProfilerManager>,
 		public Storm::IProfilerManager
 	{
 		STORM_DECLARE_SINGLETON(ProfilerManager);
 
 	private:
 		void initialize_Implementation();
+		void cleanUp_Implementation();
 
 	public:
 		void registerCurrentThreadAsSimulationThread(const std::wstring_view &profileName) final override;
@@ -28,8 +34,42 @@ namespace Storm
 		float getSpeedProfileAccumulatedTime() const final override;
 		float getCurrentSpeedProfile() const final override;
 
+		void addFluidSleepingProfile(const std::size_t fluidParticleCount, const std::size_t awakeFluidParticleCount, const std::chrono::nanoseconds iterationDuration) final override;
+		void addNeighborhoodMemoryProfile(const std::size_t neighborCount, const std::size_t usedMemory, const std::size_t perParticleArrayLayoutMemory) final override;
+
+	public:
+		// Called after each parallel loop (runParallel, reduceParallel, ...) when the parallel loops profiling is enabled.
+		void addParallelLoopProfile(const std::source_location &location, const std::size_t itemCount, const std::chrono::nanoseconds duration);
+
+	private:
+		// The loop location : the file name and the line. Compared by value since the same file name literal isn't guaranteed to have the same address in all modules.
+		using ParallelLoopProfileKey = std::pair<std::string_view, uint_least32_t>;
+		using ParallelLoopProfileMap = std::map<ParallelLoopProfileKey, Storm::ParallelLoopProfileData>;
+
+		// The profiles of the loops started by one thread. Only this thread and the final report lock its mutex, so it is never contended while simulating.
+		struct ParallelLoopThreadProfiles
+		{
+		public:
+			std::mutex _mutex;
+			ParallelLoopProfileMap _profiles;
+		};
+
+	private:
+		void logParallelLoopProfiles() const;
+		void logFluidSleepingProfile() const;
+		void logNeighborhoodMemoryProfile() const;
+
 	private:
 		bool _speedProfile;
 		std::map<std::thread::id, Storm::SpeedProfileHandler> _speedProfileHandlerMap;
+
+		// One per thread that started a parallel loop, merged when reporting. The global mutex is only locked when a thread starts its first loop.
+		bool _parallelLoopProfile;
+		mutable std::mutex _parallelLoopProfileMutex;
+		std::vector<std::unique_ptr<ParallelLoopThreadProfiles>> _parallelLoopThreadProfiles;
+
+		// Only filled by the simulation thread.
+		Storm::FluidSleepingProfileData _fluidSleepingProfile;
+		Storm::NeighborhoodMemoryProfileData _neighborhoodMemoryProfile;
 	};
 }
@@ -0,0 +1,163 @@
+#include "RecordFrameCodec.h"
+
+#include "SerializeRecordHeader.h"
+#include "SerializeRecordParticleSystemData.h"
+
+#include "RecordChannel.h"
+
+
+namespace
+{
+	void fillAbsentChannel(std::vector<float> &channel, const std::size_t particleCount)
+	{
+		channel.assign(particleCount, 0.f);
+	}
+
+	void fillAbsentChannel(std::vector<Storm::Vector3> &channel, const std::size_t particleCount)
+	{
+		channel.assign(particleCount, Storm::Vector3::Zero());
+	}
+
+	// In the order the channels are serialized.
+	constexpr std::string_view k_channelNames[] =
+	{
+		"Positions",
+		"Velocities",
+		"Forces",
+		"Densities",
+		"Pressures",
+		"Volumes",
+		"Normals",
+		"PressureForces",
+		"ViscosityForces",
+		"DragForces",
+		"DynamicPressureQForces",
+		"NoStickForces",
+		"CoandaForces",
+		"IntermediaryDensityPressureForces",
+		"IntermediaryVelocityPressureForces",
+		"BlowerForces",
+	};
+}
+
+
+Storm::RecordFrameCodec::RecordFrameCodec(const Storm::SerializeRecordHeader &header, const bool compress) :
+	_positionQuantization{ { header._positionQuantizationOrigin.x(), header._positionQuantizationOrigin.y(), header._positionQuantizationOrigin.z() }, header._positionPrecision },
+	_quantizePositions{ header._positionPrecision > 0.f },
+	_compress{ compress },
+	_recordedChannels{ header._recordedChannels },
+	_encoding{ false },
+	_rawByteCount{ 0 },
+	_codedByteCount{ 0 },
+	_codingDuration{ 0 }
+{
+	_channelRawByteCounts.fill(0);
+	_channelCodedByteCounts.fill(0);
+}
+
+Storm::RecordFrameCodec::~RecordFrameCodec() = default;
+
+void Storm::RecordFrameCodec::reset()
+{
+	for (auto &statesPerSystem : _statesPerSystem)
+	{
+		for (Storm::ChannelCodecState &state : statesPerSystem.second)
+		{
+			state.reset();
+		}
+	}
+}
+
+void Storm::RecordFrameCodec::serialize(Storm::SerializePackage &package, Storm::SerializeRecordParticleSystemData &frameData)
+{
+	const auto startTime = std::chrono::high_resolution_clock::now();
+	const std::size_t startPosition = package.getStreamPosition();
+
+	ParticleSystemChannelStates &states = _statesPerSystem[frameData._systemId];
+	const Storm::ChannelQuantization*const positionQuantization = _quantizePositions ? &_positionQuantization : nullptr;
+
+	std::size_t channelIndex = 0;
+	const auto serializeChannel = [this, &package, &states, &channelIndex, &frameData](auto &channel, const bool recorded, const Storm::ChannelQuantization*const quantization = nullptr)
+	{
+		Storm::ChannelCodecState &state = states[channelIndex];
+		if (recorded)
+		{
+			const std::size_t channelStartPosition = package.getStreamPosition();
+			_codec.serialize(package, state, channel, _compress, quantization);
+
+			const std::size_t channelRawByteCount = channel.size() * sizeof(channel[0]);
+			_rawByteCount += channelRawByteCount;
+			_channelRawByteCounts[channelIndex] += channelRawByteCount;
+			_channelCodedByteCounts[channelIndex] += package.getStreamPosition() - channelStartPosition;
+		}
+		else if (!package.isSerializing())
+		{
+			// Positions are always recorded and serialized first, so we know the particle count.
+			fillAbsentChannel(channel, frameData._positions.size());
+		}
+
+		++channelIndex;
+	};
+
+	serializeChannel(frameData._positions, true, positionQuantization);
+	serializeChannel(frameData._velocities, STORM_IS_BIT_ENABLED(_recordedChannels, Storm::RecordChannel::Velocities));
+	serializeChannel(frameData._forces, STORM_IS_BIT_ENABLED(_recordedChannels, Storm::RecordChannel::Forces));
+	serializeChannel(frameData._densities, STORM_IS_BIT_ENABLED(_recordedChannels, Storm::RecordChannel::Densities));
+	serializeChannel(frameData._pressures, STORM_IS_BIT_ENABLED(_recordedChannels, Storm::RecordChannel::Pressures));
+	serializeChannel(frameData._volumes, STORM_IS_BIT_ENABLED(_recordedChannels, Storm::RecordChannel::Volumes));
+	serializeChannel(frameData._normals, STORM_IS_BIT_ENABLED(_recordedChannels, Storm::RecordChannel::Normals));
+	serializeChannel(frameData._pressureComponentforces, STORM_IS_BIT_ENABLED(_recordedChannels, Storm::RecordChannel::PressureForces));
+	serializeChannel(frameData._viscosityComponentforces, STORM_IS_BIT_ENABLED(_recordedChannels, Storm::RecordChannel::ViscosityForces));
+	serializeChannel(frameData._dragComponentforces, STORM_IS_BIT_ENABLED(_recordedChannels, Storm::RecordChannel::DragForces));
+	serializeChannel(frameData._dynamicPressureQForces, STORM_IS_BIT_ENABLED(_recordedChannels, Storm::RecordChannel::DynamicPressureQForces));
+	serializeChannel(frameData._noStickForces, STORM_IS_BIT_ENABLED(_recordedChannels, Storm::RecordChannel::NoStickForces));
+	serializeChannel(frameData._coandaForces, STORM_IS_BIT_ENABLED(_recordedChannels, Storm::RecordChannel::CoandaForces));
+	serializeChannel(frameData._intermediaryPressureDensityComponentForces, STORM_IS_BIT_ENABLED(_recordedChannels, Storm::RecordChannel::IntermediaryDensityPressureForces));
+	serializeChannel(frameData._intermediaryPressureVelocityComponentForces, STORM_IS_BIT_ENABLED(_recordedChannels, Storm::RecordChannel::IntermediaryVelocityPressureForces));
+	serializeChannel(frameData._blowerForces, STORM_IS_BIT_ENABLED(_recordedChannels, Storm::RecordChannel::BlowerForces));
+
+	assert(channelIndex == k_channelCount && "We should serialize all channels!");
+
+	_encoding = package.isSerializing();
+	_codedByteCount += package.getStreamPosition() - startPosition;
+	_codingDuration += std::chrono::high_resolution_clock::now() - startTime;
+}
+
+void Storm::RecordFrameCodec::logStatistics() const
+{
+	if (_rawByteCount == 0)
+	{
+		return;
+	}
+
+	constexpr double coeffByteToMb = 1.0 / (1024.0 * 1024.0);
+	const double rawMb = static_cast<double>(_rawByteCount) * coeffByteToMb;
+	const double codedMb = static_cast<double>(_codedByteCount) * coeffByteToMb;
+	const double codingSeconds = std::chrono::duration<double>(_codingDuration).count();
+
+	static_assert(std::size(k_channelNames) == k_channelCount, "Each serialized channel should have a name!");
+
+	std::string channelReport;
+	channelReport.reserve(1024);
+
+	for (std::size_t channelIndex = 0; channelIndex < k_channelCount; ++channelIndex)
+	{
+		const std::size_t channelRawByteCount = _channelRawByteCounts[channelIndex];
+		if (channelRawByteCount != 0)
+		{
+			channelReport += "\n";
+			channelReport += k_channelNames[channelIndex];
+			channelReport += " : ";
+			channelReport += std::to_string(static_cast<double>(channelRawByteCount) * coeffByteToMb);
+			channelReport += " Mb -> ";
+			channelReport += std::to_string(static_cast<double>(_channelCodedByteCounts[channelIndex]) * coeffByteToMb);
+			channelReport += " Mb (x";
+			channelReport += std::to_string(static_cast<double>(channelRawByteCount) / static_cast<double>(std::max(_channelCodedByteCounts[channelIndex], static_cast<std::size_t>(1))));
+			channelReport += ')';
+		}
+	}
+
+	LOG_COMMENT <<
+		"Record particle channels " << (_encoding ? "encoded" : "decoded") << " : " << rawMb << " Mb of channels for " << codedMb << " Mb inside the record (compression ratio of " << rawMb / std::max(codedMb, coeffByteToMb) << ").\n"
+		"It took " << codingSeconds << "s (" << rawMb / std::max(codingSeconds, 1e-9) << " Mb/s)." << channelReport;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "ChannelCodec.h"
+
+
+namespace Storm
+{
+	struct SerializeRecordHeader;
+	struct SerializeRecordParticleSystemData;
+	enum class RecordChannel : uint16_t;
+
+	// Encodes (or decodes) the particle channels of the recorded frames (from record version 1.17 onwards).
+	// Each channel of each particle system is encoded against what it was the frame before, since the last key frame.
+	// Channels that aren't recorded are skipped when writing, and filled with zeros when reading.
+	class RecordFrameCodec
+	{
+	private:
+		static constexpr std::size_t k_channelCount = 16;
+
+		using ParticleSystemChannelStates = std::array<Storm::ChannelCodecState, k_channelCount>;
+
+	public:
+		// compress is only used when writing. Without it, the channels are written as is (except the ones that are all zero).
+		RecordFrameCodec(const Storm::SerializeRecordHeader &header, const bool compress);
+		~RecordFrameCodec();
+
+	public:
+		// The next frame is a key frame. It won't depend on the previous ones.
+		void reset();
+
+		void serialize(Storm::SerializePackage &package, Storm::SerializeRecordParticleSystemData &frameData);
+
+		// Logs (LOG_COMMENT) the compression ratio and throughput of all frames coded so far, in total and per channel. This is called at the end of each record and replay.
+		void logStatistics() const;
+
+	private:
+		Storm::ChannelCodec _codec;
+		std::map<uint32_t, ParticleSystemChannelStates> _statesPerSystem;
+
+		Storm::ChannelQuantization _positionQuantization;
+		bool _quantizePositions;
+		bool _compress;
+		Storm::RecordChannel _recordedChannels;
+
+		// Statistics
+		bool _encoding;
+		std::size_t _rawByteCount;
+		std::size_t _codedByteCount;
+		std::array<std::size_t, k_channelCount> _channelRawByteCounts;
+		std::array<std::size_t, k_channelCount> _channelCodedByteCounts;
+		std::chrono::high_resolution_clock::duration _codingDuration;
+	};
+}
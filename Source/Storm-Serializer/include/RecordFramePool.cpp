@@ -0,0 +1,80 @@
+#include "RecordFramePool.h"
+
+#include "SerializeRecordContraintsData.h"
+#include "SerializeRecordParticleSystemData.h"
+#include "SerializeRecordPendingData.h"
+
+
+Storm::RecordFramePool::RecordFramePool(const std::size_t frameCount) :
+	_frameCount{ frameCount },
+	_allocatedFrameCount{ 0 },
+	_waitCount{ 0 },
+	_closed{ false }
+{
+	if (_frameCount == 0)
+	{
+		Storm::throwException<Storm::Exception>("Record frame pool should have at least one frame!");
+	}
+
+	_freeFrames.reserve(_frameCount);
+}
+
+Storm::RecordFramePool::~RecordFramePool()
+{
+	if (_waitCount > 0)
+	{
+		LOG_DEBUG << "The simulation waited " << _waitCount << " times for the serializer to write the recorded frames.";
+	}
+}
+
+std::unique_ptr<Storm::SerializeRecordPendingData> Storm::RecordFramePool::acquire()
+{
+	std::unique_lock<std::mutex> lock{ _mutex };
+
+	if (_freeFrames.empty() && _allocatedFrameCount == _frameCount && !_closed)
+	{
+		++_waitCount;
+		_frameReleasedCV.wait(lock, [this]()
+		{
+			return !_freeFrames.empty() || _closed;
+		});
+	}
+
+	if (!_freeFrames.empty())
+	{
+		std::unique_ptr<Storm::SerializeRecordPendingData> frame = std::move(_freeFrames.back());
+		_freeFrames.pop_back();
+		return frame;
+	}
+	else if (_allocatedFrameCount < _frameCount)
+	{
+		++_allocatedFrameCount;
+	}
+
+	return std::make_unique<Storm::SerializeRecordPendingData>();
+}
+
+void Storm::RecordFramePool::release(std::unique_ptr<Storm::SerializeRecordPendingData> &&frame)
+{
+	{
+		std::lock_guard<std::mutex> lock{ _mutex };
+
+		// Frames allocated after closing aren't counted, we don't keep more than the pool size.
+		if (_freeFrames.size() < _frameCount)
+		{
+			_freeFrames.emplace_back(std::move(frame));
+		}
+	}
+
+	_frameReleasedCV.notify_one();
+}
+
+void Storm::RecordFramePool::close()
+{
+	{
+		std::lock_guard<std::mutex> lock{ _mutex };
+		_closed = true;
+	}
+
+	_frameReleasedCV.notify_all();
+}
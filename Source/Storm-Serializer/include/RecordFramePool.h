@@ -0,0 +1,35 @@
+#pragma once
+
+
+namespace Storm
+{
+	struct SerializeRecordPendingData;
+
+	// Record frames circulating between the simulation thread (that fills them) and the serializer thread (that writes them then gives them back).
+	// The frames keep their arrays between two records, so filling them doesn't reallocate anything once the pool is warm.
+	// Only frameCount frames can be in flight, therefore the simulation waits for the serializer if the latter falls behind instead of piling up frames in memory.
+	class RecordFramePool
+	{
+	public:
+		RecordFramePool(const std::size_t frameCount);
+		~RecordFramePool();
+
+	public:
+		// Blocks while all frames are in flight. Once the pool is closed, a new frame is allocated instead since no frame would be given back anymore.
+		std::unique_ptr<Storm::SerializeRecordPendingData> acquire();
+		void release(std::unique_ptr<Storm::SerializeRecordPendingData> &&frame);
+
+		// To call when the serializer thread doesn't write frames anymore, to not block the simulation forever.
+		void close();
+
+	private:
+		std::vector<std::unique_ptr<Storm::SerializeRecordPendingData>> _freeFrames;
+		const std::size_t _frameCount;
+		std::size_t _allocatedFrameCount;
+		std::size_t _waitCount;
+		bool _closed;
+
+		std::mutex _mutex;
+		std::condition_variable _frameReleasedCV;
+	};
+}
@@ -13,6 +13,8 @@
 #include "SerializeParticleSystemLayout.h"
 #include "SerializeSupportedFeatureLayout.h"
 
+#include "RecordChannel.h"
+
 #include "Version.h"
 
 
@@ -23,6 +25,12 @@ namespace
 		const Storm::IConfigManager &configMgr = Storm::SingletonHolder::instance().getSingleton<Storm::IConfigManager>();
 		return configMgr.getSceneRecordConfig()._recordFilePath;
 	}
+
+	inline std::size_t retrieveRecordWriteBufferSize()
+	{
+		const Storm::IConfigManager &configMgr = Storm::SingletonHolder::instance().getSingleton<Storm::IConfigManager>();
+		return static_cast<std::size_t>(configMgr.getSceneRecordConfig()._writeBufferSizeInKb) * 1024;
+	}
 }
 
 // Reading
@@ -44,7 +52,7 @@ Storm::RecordHandlerBase::RecordHandlerBase(Storm::SerializeRecordHeader &&heade
 // Writing
 Storm::RecordHandlerBase::RecordHandlerBase(Storm::SerializeRecordHeader &&header, const Storm::Version &recordVersion) :
 	_header{ std::move(header) },
-	_package{ Storm::SerializePackageCreationModality::SavingAppendPreheaderProvidedAfter, retrieveRecordFilePath() },
+	_package{ Storm::SerializePackageCreationModality::SavingAppendPreheaderProvidedAfter, retrieveRecordFilePath(), retrieveRecordWriteBufferSize() },
 	_movingSystemCount{ 0 },
 	_preheaderSerializer{ std::make_unique<Storm::RecordPreHeaderSerializer>(recordVersion) }
 {
@@ -71,6 +79,41 @@ void Storm::RecordHandlerBase::serializeHeader()
 		_package << _header._realEndPhysicsTime;
 	}
 
+	if (currentVersion >= Storm::Version{ 1, 16 })
+	{
+		// This part after is only available from version 1.16 onwards.
+		_package << _header._frameIndexPosition;
+	}
+	else
+	{
+		_header._frameIndexPosition = 0;
+	}
+
+	if (currentVersion >= Storm::Version{ 1, 17 })
+	{
+		// This part after is only available from version 1.17 onwards.
+		_package << _header._keyFrameInterval << _header._positionPrecision << _header._positionQuantizationOrigin;
+	}
+	else
+	{
+		// Before, each frame was written on its own.
+		_header._keyFrameInterval = 1;
+		_header._positionPrecision = 0.f;
+	}
+
+	if (currentVersion >= Storm::Version{ 1, 18 })
+	{
+		// This part after is only available from version 1.18 onwards.
+		auto recordedChannels = static_cast<Storm::EnumUnderlyingNative<Storm::RecordChannel>>(_header._recordedChannels);
+		_package << recordedChannels;
+		_header._recordedChannels = static_cast<Storm::RecordChannel>(recordedChannels);
+	}
+	else
+	{
+		// Before, every channel was recorded.
+		_header._recordedChannels = Storm::RecordChannel::All;
+	}
+
 #define XMACRO_STORM_SERIALIZE_VECTOR3_TYPE			\
 	STORM_SERIALIZE_VECTOR3_TYPE_SPECIFIC(float)	\
 	STORM_SERIALIZE_VECTOR3_TYPE_SPECIFIC(double)
@@ -176,12 +219,13 @@ const Storm::SerializeRecordHeader& Storm::RecordHandlerBase::getHeader() const
 	return _header;
 }
 
-void Storm::RecordHandlerBase::endWriteHeader(uint64_t headerPos, uint64_t frameCount, float realPhysicsTime)
+void Storm::RecordHandlerBase::endWriteHeader(uint64_t headerPos, uint64_t frameCount, float realPhysicsTime, uint64_t frameIndexPosition)
 {
 	_package.seekAbsolute(headerPos + sizeof(_header._recordFrameRate));
 	_package 
 		<< frameCount
 		<< realPhysicsTime
+		<< frameIndexPosition
 		;
 
 	_preheaderSerializer->endSerializing(_package);
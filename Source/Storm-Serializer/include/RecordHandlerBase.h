@@ -29,7 +29,7 @@ namespace Storm
 		void serializeHeader();
 		const Storm::SerializeRecordHeader& getHeader() const noexcept;
 
-		void endWriteHeader(uint64_t headerPos, uint64_t frameCount, float realPhysicsTime);
+		void endWriteHeader(uint64_t headerPos, uint64_t frameCount, float realPhysicsTime, uint64_t frameIndexPosition);
 
 	protected:
 		Storm::SerializePackage _package;
@@ -1,6 +1,7 @@
 #include "RecordReader.h"
 
 #include "RecordPreHeaderSerializer.h"
+#include "RecordFrameCodec.h"
 
 #include "SerializeRecordHeader.h"
 #include "SerializeConstraintLayout.h"
@@ -11,9 +12,17 @@
 #include "SerializeRecordParticleSystemData.h"
 #include "SerializeRecordPendingData.h"
 
+#include "RecordChannel.h"
+
 #define STORM_HIJACKED_TYPE Storm::Vector3
 // ReSharper disable once CppUnusedIncludeDirective
 #include "VectHijack.h"
+#undef STORM_HIJACKED_TYPE
+
+#define STORM_HIJACKED_TYPE float
+// ReSharper disable once CppUnusedIncludeDirective
+#include "VectHijack.h"
+#undef STORM_HIJACKED_TYPE
 
 
 namespace
@@ -107,7 +116,13 @@ Storm::RecordReader::RecordReader(const std::string &recordFilePath) :
 	this->init();
 }
 
-Storm::RecordReader::~RecordReader() = default;
+Storm::RecordReader::~RecordReader()
+{
+	if (_frameCodec)
+	{
+		_frameCodec->logStatistics();
+	}
+}
 
 void Storm::RecordReader::init()
 {
@@ -168,10 +183,14 @@ void Storm::RecordReader::init()
 	{
 		_readMethodToUse = &Storm::RecordReader::readNextFrame_v1_13_0;
 	}
-	else if (currentRecordVersion <= Storm::Version{ 1, 15, 0 }) // Version 15 has only changes in the header.
+	else if (currentRecordVersion <= Storm::Version{ 1, 16, 0 }) // Version 15 and 16 have only changes in the header (and footer for 16).
 	{
 		_readMethodToUse = &Storm::RecordReader::readNextFrame_v1_14_0;
 	}
+	else if (currentRecordVersion <= Storm::Version{ 1, 18, 0 }) // Version 18 has only changes in the header (the channels absent from the frames are handled by the frame codec).
+	{
+		_readMethodToUse = &Storm::RecordReader::readNextFrame_v1_17_0;
+	}
 	else
 	{
 		Storm::throwException<Storm::Exception>("Cannot read the current record because the version " + Storm::toStdString(currentRecordVersion) + " isn't handled ");
@@ -179,10 +198,50 @@ void Storm::RecordReader::init()
 
 	Storm::RecordHandlerBase::serializeHeader();
 	_firstFramePosition = _package.getStreamPosition();
+
+	if (_header._keyFrameInterval == 0)
+	{
+		Storm::throwException<Storm::Exception>("The record key frame interval cannot be 0!");
+	}
+
+	_frameCodec = std::make_unique<Storm::RecordFrameCodec>(_header, false);
 
 	this->fillSupportedFeature(currentRecordVersion, *_header._supportedFeaturesLayout);
 
 	_noMoreFrame = _header._frameCount == 0;
+	_nextFrameIndex = 0;
+
+	this->readFrameIndex();
+}
+
+void Storm::RecordReader::readFrameIndex()
+{
+	_frameIndexComplete = _header._frameCount == 0;
+
+	// Records written before version 1.16 don't have a frame index. It will be filled while we read the frames (see indexFramesUntil).
+	// We don't scan them at opening : their frames aren't prefixed by their size, so skipping one means reading the size of each of its arrays with the layout of its version,
+	// and the replay of those records reads all their frames in order anyway.
+	if (_header._frameIndexPosition != 0 && !_frameIndexComplete)
+	{
+		_package.seekAbsolute(_header._frameIndexPosition);
+		_package << _framePhysicsTimes << _framePositions;
+
+		if (_framePhysicsTimes.size() == _header._frameCount && _framePositions.size() == _header._frameCount)
+		{
+			_frameIndexComplete = true;
+		}
+		else
+		{
+			LOG_WARNING <<
+				"The record frame index doesn't match the frame count (" << _framePhysicsTimes.size() << " indexed frames for " << _header._frameCount << " frames).\n"
+				"We'll ignore it and index the frames while reading them.";
+
+			_framePhysicsTimes.clear();
+			_framePositions.clear();
+		}
+
+		_package.seekAbsolute(_firstFramePosition);
+	}
 }
 
 bool Storm::RecordReader::resetToBeginning()
@@ -193,17 +252,106 @@ bool Storm::RecordReader::resetToBeginning()
 	if (hasFrame)
 	{
 		_package.seekAbsolute(_firstFramePosition);
+		_nextFrameIndex = 0;
 	}
 
 	return hasFrame;
 }
 
+bool Storm::RecordReader::seekToFrameBefore(const float physicsTime)
+{
+	if (_header._frameCount == 0)
+	{
+		return false;
+	}
+
+	if (!_frameIndexComplete && (_framePhysicsTimes.empty() || _framePhysicsTimes.back() < physicsTime))
+	{
+		this->indexFramesUntil(physicsTime);
+	}
+
+	const auto firstIndexedTimeIt = std::begin(_framePhysicsTimes);
+	const auto frameAfterIt = std::lower_bound(firstIndexedTimeIt, std::end(_framePhysicsTimes), physicsTime);
+
+	// If the physics time is before the first frame, we'll take the first frame.
+	const std::size_t frameIndex = frameAfterIt == firstIndexedTimeIt ? 0 : static_cast<std::size_t>(std::distance(firstIndexedTimeIt, frameAfterIt)) - 1;
+	if (frameIndex >= _framePositions.size())
+	{
+		return false;
+	}
+
+	// Decode from the key frame up to the frame before the one we want, so the next read frame can be decoded against it.
+	const std::size_t keyFrameIndex = this->retrieveKeyFrameIndex(frameIndex);
+	_package.seekAbsolute(_framePositions[keyFrameIndex]);
+	_nextFrameIndex = keyFrameIndex;
+	_noMoreFrame = false;
+
+	Storm::SerializeRecordPendingData skippedFrame;
+	while (_nextFrameIndex < frameIndex)
+	{
+		if (!this->readNextFrame(skippedFrame))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void Storm::RecordReader::indexFramesUntil(const float physicsTime)
+{
+	// Start from the last indexed frame (or the key frame it is decoded from), we don't want to read twice what we have already indexed.
+	if (_framePositions.empty())
+	{
+		_package.seekAbsolute(_firstFramePosition);
+		_nextFrameIndex = 0;
+	}
+	else
+	{
+		const std::size_t keyFrameIndex = this->retrieveKeyFrameIndex(_framePositions.size() - 1);
+		_package.seekAbsolute(_framePositions[keyFrameIndex]);
+		_nextFrameIndex = keyFrameIndex;
+	}
+
+	_noMoreFrame = false;
+
+	// Reading a frame indexes it. We stop at the first frame at or after the physics time, so we know the one before was the last one before the physics time.
+	Storm::SerializeRecordPendingData skippedFrame;
+	while (this->readNextFrame(skippedFrame) && skippedFrame._physicsTime < physicsTime)
+	{}
+
+	if (_noMoreFrame)
+	{
+		_frameIndexComplete = true;
+	}
+}
+
+void Storm::RecordReader::indexReadFrame(const std::size_t framePosition, const float physicsTime)
+{
+	if (!_frameIndexComplete && _nextFrameIndex == _framePositions.size())
+	{
+		_framePhysicsTimes.emplace_back(physicsTime);
+		_framePositions.emplace_back(framePosition);
+
+		_frameIndexComplete = _framePositions.size() == _header._frameCount;
+	}
+
+	++_nextFrameIndex;
+}
+
+std::size_t Storm::RecordReader::retrieveKeyFrameIndex(const std::size_t frameIndex) const noexcept
+{
+	return frameIndex - frameIndex % _header._keyFrameInterval;
+}
+
 bool Storm::RecordReader::readNextFrame(Storm::SerializeRecordPendingData &outPendingData)
 {
 	if (!_noMoreFrame)
 	{
+		const std::size_t framePosition = _package.getStreamPosition();
 		if ((this->*_readMethodToUse)(outPendingData))
 		{
+			this->indexReadFrame(framePosition, outPendingData._physicsTime);
 			this->correctVersionMismatch(outPendingData);
 			return true;
 		}
@@ -229,6 +377,24 @@ void Storm::RecordReader::fillSupportedFeature(const Storm::Version &currentVers
 	missingFeatures._hasKernelLength = currentVersion >= Storm::Version{ 1, 12, 0 };
 	missingFeatures._hasIntermediaryVelocityPressureForces = currentVersion >= Storm::Version{ 1, 13, 0 };
 	missingFeatures._hasBlowerForces = currentVersion >= Storm::Version{ 1, 14, 0 };
+
+	// The channels that weren't selected when recording are filled with zeros.
+	const Storm::RecordChannel recordedChannels = _header._recordedChannels;
+	missingFeatures._hasVelocities = STORM_IS_BIT_ENABLED(recordedChannels, Storm::RecordChannel::Velocities);
+	missingFeatures._hasForces = STORM_IS_BIT_ENABLED(recordedChannels, Storm::RecordChannel::Forces);
+	missingFeatures._hasPressureComponentforces = STORM_IS_BIT_ENABLED(recordedChannels, Storm::RecordChannel::PressureForces);
+	missingFeatures._hasViscosityComponentforces = STORM_IS_BIT_ENABLED(recordedChannels, Storm::RecordChannel::ViscosityForces);
+	missingFeatures._hasDensities = missingFeatures._hasDensities && STORM_IS_BIT_ENABLED(recordedChannels, Storm::RecordChannel::Densities);
+	missingFeatures._hasPressures = missingFeatures._hasPressures && STORM_IS_BIT_ENABLED(recordedChannels, Storm::RecordChannel::Pressures);
+	missingFeatures._hasVolumes = missingFeatures._hasVolumes && STORM_IS_BIT_ENABLED(recordedChannels, Storm::RecordChannel::Volumes);
+	missingFeatures._hasNormals = missingFeatures._hasNormals && STORM_IS_BIT_ENABLED(recordedChannels, Storm::RecordChannel::Normals);
+	missingFeatures._hasDragComponentforces = missingFeatures._hasDragComponentforces && STORM_IS_BIT_ENABLED(recordedChannels, Storm::RecordChannel::DragForces);
+	missingFeatures._hasDynamicPressureQForces = missingFeatures._hasDynamicPressureQForces && STORM_IS_BIT_ENABLED(recordedChannels, Storm::RecordChannel::DynamicPressureQForces);
+	missingFeatures._hasNoStickForces = missingFeatures._hasNoStickForces && STORM_IS_BIT_ENABLED(recordedChannels, Storm::RecordChannel::NoStickForces);
+	missingFeatures._hasCoandaForces = missingFeatures._hasCoandaForces && STORM_IS_BIT_ENABLED(recordedChannels, Storm::RecordChannel::CoandaForces);
+	missingFeatures._hasIntermediaryDensityPressureForces = missingFeatures._hasIntermediaryDensityPressureForces && STORM_IS_BIT_ENABLED(recordedChannels, Storm::RecordChannel::IntermediaryDensityPressureForces);
+	missingFeatures._hasIntermediaryVelocityPressureForces = missingFeatures._hasIntermediaryVelocityPressureForces && STORM_IS_BIT_ENABLED(recordedChannels, Storm::RecordChannel::IntermediaryVelocityPressureForces);
+	missingFeatures._hasBlowerForces = missingFeatures._hasBlowerForces && STORM_IS_BIT_ENABLED(recordedChannels, Storm::RecordChannel::BlowerForces);
 }
 
 void Storm::RecordReader::correctVersionMismatch(Storm::SerializeRecordPendingData &outPendingData)
@@ -286,7 +452,7 @@ void Storm::RecordReader::correctVersionMismatch(Storm::SerializeRecordPendingDa
 	{
 		correctVersionMismatchImpl<1, 13, 0>(outPendingData);
 	}
-	else if (currentRecordVersion <= Storm::Version{ 1, 15, 0 }) // Version 15 has only changes in the header.
+	else if (currentRecordVersion <= Storm::Version{ 1, 18, 0 }) // Version 15 and 16 have only changes in the header (and footer for 16), 17 only changes how the channels are encoded, 18 which channels are recorded.
 	{
 		correctVersionMismatchImpl<1, 14, 0>(outPendingData);
 	}
@@ -1143,3 +1309,61 @@ bool Storm::RecordReader::readNextFrame_v1_14_0(Storm::SerializeRecordPendingDat
 
 	return true;
 }
+
+bool Storm::RecordReader::readNextFrame_v1_17_0(Storm::SerializeRecordPendingData &outPendingData)
+{
+	uint64_t frameNumber = std::numeric_limits<uint64_t>::max();
+	_package << frameNumber;
+
+	_noMoreFrame = frameNumber >= _header._frameCount;
+	if (_noMoreFrame)
+	{
+		return false;
+	}
+
+	_package
+		<< outPendingData._physicsTime
+		<< outPendingData._kernelLength;
+
+	if (frameNumber == 0)
+	{
+		// If it is the first frame, then we would have all particles from all rigid bodies (static rigid bodies included).
+		outPendingData._particleSystemElements.resize(_header._particleSystemLayouts.size());
+	}
+	else
+	{
+		// The other frame have only the particle system that are allowed to move (gain some spaces).
+		outPendingData._particleSystemElements.resize(_movingSystemCount);
+	}
+
+	// Key frames don't depend on the previous frames.
+	if (frameNumber % _header._keyFrameInterval == 0)
+	{
+		_frameCodec->reset();
+	}
+
+	for (Storm::SerializeRecordParticleSystemData &frameData : outPendingData._particleSystemElements)
+	{
+		_package <<
+			frameData._systemId <<
+			frameData._wantedDensity <<
+			frameData._pSystemPosition <<
+			frameData._pSystemGlobalForce <<
+			frameData._pSystemTotalEngineForce
+			;
+
+		_frameCodec->serialize(_package, frameData);
+	}
+
+	outPendingData._constraintElements.resize(_header._contraintLayouts.size());
+	for (Storm::SerializeRecordContraintsData &constraintData : outPendingData._constraintElements)
+	{
+		_package <<
+			constraintData._id <<
+			constraintData._position1 <<
+			constraintData._position2
+			;
+	}
+
+	return true;
+}
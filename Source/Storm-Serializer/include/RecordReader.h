@@ -7,6 +7,7 @@ namespace Storm
 {
 	struct SerializeRecordPendingData;
 	class RecordPreHeaderSerializer;
+	class RecordFrameCodec;
 
 	class RecordReader : public Storm::RecordHandlerBase
 	{
@@ -24,6 +25,20 @@ namespace Storm
 	public:
 		bool resetToBeginning();
 
+		// Position the reader so the next read frame is the last frame recorded before the physics time (the first frame if there is none).
+		// Therefore the frame read after it is the first frame at or after the physics time.
+		bool seekToFrameBefore(const float physicsTime);
+
+	private:
+		void readFrameIndex();
+
+		// Only for records without frame index (before version 1.16). Read (and decode) the frames after the last indexed one until the physics time, so each frame is decoded at most once to be indexed.
+		void indexFramesUntil(const float physicsTime);
+		void indexReadFrame(const std::size_t framePosition, const float physicsTime);
+
+		// Frames are decoded against the previous ones since the last key frame. To read a frame, we should start decoding from this key frame.
+		std::size_t retrieveKeyFrameIndex(const std::size_t frameIndex) const noexcept;
+
 	public:
 		bool readNextFrame(Storm::SerializeRecordPendingData &outPendingData);
 
@@ -49,11 +64,20 @@ namespace Storm
 		bool readNextFrame_v1_12_0(Storm::SerializeRecordPendingData &outPendingData);
 		bool readNextFrame_v1_13_0(Storm::SerializeRecordPendingData &outPendingData);
 		bool readNextFrame_v1_14_0(Storm::SerializeRecordPendingData &outPendingData);
+		bool readNextFrame_v1_17_0(Storm::SerializeRecordPendingData &outPendingData);
 
 	public:
 		ReadMethodDelegate _readMethodToUse;
 
 		bool _noMoreFrame;
 		std::size_t _firstFramePosition;
+
+		// The physics time and position of each frame. Read from the record footer, or filled while reading the frames for records without one.
+		std::vector<float> _framePhysicsTimes;
+		std::vector<uint64_t> _framePositions;
+		bool _frameIndexComplete;
+		std::size_t _nextFrameIndex;
+
+		std::unique_ptr<Storm::RecordFrameCodec> _frameCodec;
 	};
 }
@@ -1,4 +1,12 @@
 #include "RecordWriter.h"
+#include "RecordFrameCodec.h"
+
+#include "SingletonHolder.h"
+#include "IConfigManager.h"
+
+#include "SceneRecordConfig.h"
+
+#include "RecordChannel.h"
 
 #include "SerializeRecordContraintsData.h"
 #include "SerializeRecordParticleSystemData.h"
@@ -13,6 +21,11 @@
 // Therefore we need it here also.
 #define STORM_HIJACKED_TYPE Storm::Vector3
 #include "VectHijack.h"
+#undef STORM_HIJACKED_TYPE
+
+#define STORM_HIJACKED_TYPE float
+#include "VectHijack.h"
+#undef STORM_HIJACKED_TYPE
 
 
 namespace
@@ -22,7 +35,13 @@ namespace
 	// Each time you change/add/remove something that modifies the layout of the recording, increase the version number here (to not break the retro compatibility). 
 	constexpr Storm::Version retrieveRecordPacketVersion()
 	{
-		return Storm::Version{ 1, 15, 0 };
+		return Storm::Version{ 1, 18, 0 };
+	}
+
+	bool retrieveRecordCompression()
+	{
+		const Storm::IConfigManager &configMgr = Storm::SingletonHolder::instance().getSingleton<Storm::IConfigManager>();
+		return configMgr.getSceneRecordConfig()._compressRecord;
 	}
 
 	void recordStreamPosition(Storm::RecordWriter*const recordWriter, uint64_t &outPosition, const std::filesystem::path &recordFilePath)
@@ -44,6 +63,8 @@ Storm::RecordWriter::RecordWriter(Storm::SerializeRecordHeader &&header) :
 	Storm::RecordHandlerBase::serializeHeader();
 
 	recordStreamPosition(this, _recordBodyPosition, recordFilePath);
+
+	_frameCodec = std::make_unique<Storm::RecordFrameCodec>(_header, retrieveRecordCompression());
 }
 
 Storm::RecordWriter::~RecordWriter() = default;
@@ -77,12 +98,22 @@ void Storm::RecordWriter::write(/*const*/ Storm::SerializeRecordPendingData &dat
 		);
 	}
 
+	// Index the frame so the reader can seek to it directly.
+	_framePhysicsTimes.emplace_back(data._physicsTime);
+	_framePositions.emplace_back(static_cast<uint64_t>(_package.getStreamPosition()));
+
 	_package <<
 		_frameNumber <<
 		data._physicsTime <<
 		data._kernelLength
 		;
 
+	// Key frames are encoded on their own, the reader can start decoding from them.
+	if (_frameNumber % _header._keyFrameInterval == 0)
+	{
+		_frameCodec->reset();
+	}
+
 	for (Storm::SerializeRecordParticleSystemData &frameData : data._particleSystemElements)
 	{
 		this->ensureFrameDataCoherency(frameData);
@@ -92,24 +123,10 @@ void Storm::RecordWriter::write(/*const*/ Storm::SerializeRecordPendingData &dat
 			frameData._wantedDensity <<
 			frameData._pSystemPosition <<
 			frameData._pSystemGlobalForce <<
-			frameData._pSystemTotalEngineForce <<
-			frameData._positions <<
-			frameData._velocities <<
-			frameData._forces <<
-			frameData._densities <<
-			frameData._pressures <<
-			frameData._volumes <<
-			frameData._normals <<
-			frameData._pressureComponentforces <<
-			frameData._viscosityComponentforces <<
-			frameData._dragComponentforces <<
-			frameData._dynamicPressureQForces <<
-			frameData._noStickForces <<
-			frameData._coandaForces <<
-			frameData._intermediaryPressureDensityComponentForces <<
-			frameData._intermediaryPressureVelocityComponentForces <<
-			frameData._blowerForces
+			frameData._pSystemTotalEngineForce
 			;
+
+		_frameCodec->serialize(_package, frameData);
 	}
 
 	for (Storm::SerializeRecordContraintsData &constraintData : data._constraintElements)
@@ -132,11 +149,16 @@ void Storm::RecordWriter::write(/*const*/ Storm::SerializeRecordPendingData &dat
 
 void Storm::RecordWriter::endWrite(float realEndPhysicsTime)
 {
-	Storm::RecordHandlerBase::endWriteHeader(_headerPosition, _frameNumber, realEndPhysicsTime);
+	// The frame index is the footer of the record, written after the last frame.
+	const uint64_t frameIndexPosition = static_cast<uint64_t>(_package.getStreamPosition());
+	_package << _framePhysicsTimes << _framePositions;
+
+	Storm::RecordHandlerBase::endWriteHeader(_headerPosition, _frameNumber, realEndPhysicsTime, frameIndexPosition);
 
 	this->flush();
 
 	LOG_DEBUG << "Record writing ended with " << _frameNumber << " recorded frame.";
+	_frameCodec->logStatistics();
 }
 
 void Storm::RecordWriter::flush()
@@ -147,21 +169,21 @@ void Storm::RecordWriter::flush()
 void Storm::RecordWriter::ensureFrameDataCoherency(const Storm::SerializeRecordParticleSystemData &frameData) const
 {
 	const std::size_t positionsCount = frameData._positions.size();
-	const std::size_t velocitiesCount = frameData._velocities.size();
-	const std::size_t forcesCount = frameData._forces.size();
-	const std::size_t pressureTmpForceCount = frameData._pressureComponentforces.size();
-	const std::size_t viscosityTmpForceCount = frameData._viscosityComponentforces.size();
-	const std::size_t dragTmpForceCount = frameData._dragComponentforces.size();
-	const std::size_t dynamicPressureQTmpForceCount = frameData._dynamicPressureQForces.size();
-	const std::size_t noStickForceCount = frameData._noStickForces.size();
+
+	// Channels that aren't recorded aren't filled.
+	const auto isChannelCoherent = [positionsCount](const auto &channel, const bool recorded)
+	{
+		return !recorded || channel.size() == positionsCount;
+	};
+
 	if (
-		positionsCount != velocitiesCount ||
-		positionsCount != forcesCount ||
-		positionsCount != pressureTmpForceCount ||
-		positionsCount != viscosityTmpForceCount ||
-		positionsCount != dragTmpForceCount ||
-		positionsCount != dynamicPressureQTmpForceCount ||
-		positionsCount != noStickForceCount
+		!isChannelCoherent(frameData._velocities, STORM_IS_BIT_ENABLED(_header._recordedChannels, Storm::RecordChannel::Velocities)) ||
+		!isChannelCoherent(frameData._forces, STORM_IS_BIT_ENABLED(_header._recordedChannels, Storm::RecordChannel::Forces)) ||
+		!isChannelCoherent(frameData._pressureComponentforces, STORM_IS_BIT_ENABLED(_header._recordedChannels, Storm::RecordChannel::PressureForces)) ||
+		!isChannelCoherent(frameData._viscosityComponentforces, STORM_IS_BIT_ENABLED(_header._recordedChannels, Storm::RecordChannel::ViscosityForces)) ||
+		!isChannelCoherent(frameData._dragComponentforces, STORM_IS_BIT_ENABLED(_header._recordedChannels, Storm::RecordChannel::DragForces)) ||
+		!isChannelCoherent(frameData._dynamicPressureQForces, STORM_IS_BIT_ENABLED(_header._recordedChannels, Storm::RecordChannel::DynamicPressureQForces)) ||
+		!isChannelCoherent(frameData._noStickForces, STORM_IS_BIT_ENABLED(_header._recordedChannels, Storm::RecordChannel::NoStickForces))
 		)
 	{
 		Storm::throwException<Storm::Exception>("Frame " + std::to_string(_frameNumber) + " data particle count mismatches!");
@@ -9,6 +9,7 @@ namespace Storm
 	struct SerializeRecordParticleSystemData;
 	struct SerializeRecordContraintsData;
 	class RecordPreHeaderSerializer;
+	class RecordFrameCodec;
 
 	class RecordWriter : public Storm::RecordHandlerBase
 	{
@@ -34,5 +35,11 @@ namespace Storm
 		// This frame number is not the real frame number of the simulation, but more like the recorded frame number
 		// those purpose is to track how much frame we recorded so far and to know how much more frame is remaining when we'll read the record.
 		uint64_t _frameNumber;
+
+		// The frame index : the physics time and the position inside the record file of each recorded frame.
+		std::vector<float> _framePhysicsTimes;
+		std::vector<uint64_t> _framePositions;
+
+		std::unique_ptr<Storm::RecordFrameCodec> _frameCodec;
 	};
 }
@@ -6,6 +6,7 @@
 #include "IConfigManager.h"
 
 #include "SceneSimulationConfig.h"
+#include "TimeWaitResult.h"
 
 #include "SerializeRecordContraintsData.h"
 #include "SerializeRecordParticleSystemData.h"
@@ -17,6 +18,7 @@
 
 #include "RecordWriter.h"
 #include "RecordReader.h"
+#include "RecordFramePool.h"
 
 #include "RecordArchiver.h"
 
@@ -59,6 +61,9 @@ namespace
 		}
 	}
 
+	// Frames the simulation can push before having to wait for the serializer to write them.
+	constexpr std::size_t k_recordFramePoolSize = 4;
+
 	template<class Func>
 	void executeOnSerializerThread(Func &&func)
 	{
@@ -69,6 +74,8 @@ namespace
 
 
 Storm::SerializerManager::SerializerManager() :
+	_recordFramePool{ std::make_unique<Storm::RecordFramePool>(k_recordFramePoolSize) },
+	_recordFramePushed{ false },
 	_initForExport{ false }
 {
 
@@ -161,7 +168,7 @@ void Storm::SerializerManager::run()
 			this->execute();
 		};
 
-		while (timeMgr.waitForTimeOrExit(serializerRefreshTime))
+		while (this->waitRefreshOrRecordFrame(timeMgr, serializerRefreshTime))
 		{
 			serializingIterationExecutorLambda();
 		}
@@ -193,6 +200,25 @@ void Storm::SerializerManager::run()
 		Storm::requestExitOtherThread();
 		this->clearRecordQueue();
 	}
+
+	// The frames pushed from now on are written at clean up, the simulation shouldn't wait for them.
+	_recordFramePool->close();
+}
+
+bool Storm::SerializerManager::waitRefreshOrRecordFrame(const Storm::ITimeManager &timeMgr, const std::chrono::milliseconds refreshTime)
+{
+	{
+		std::unique_lock<std::mutex> lock{ _recordFramePushedMutex };
+		_recordFramePushedCV.wait_for(lock, refreshTime, [this]()
+		{
+			return _recordFramePushed;
+		});
+
+		_recordFramePushed = false;
+	}
+
+	// The time manager doesn't wake us up when quitting, so exiting could be delayed by one refresh time at most.
+	return timeMgr.getStateNoSyncWait() != Storm::TimeWaitResult::Exit;
 }
 
 void Storm::SerializerManager::execute()
@@ -221,7 +247,11 @@ void Storm::SerializerManager::execute()
 void Storm::SerializerManager::clearRecordQueue()
 {
 	assert(Storm::isSerializerThread() && "This method should only be executed inside the serializer thread!");
-	_pendingRecord = decltype(_pendingRecord){};
+	while (!_pendingRecord.empty())
+	{
+		_recordFramePool->release(std::move(_pendingRecord.front()));
+		_pendingRecord.pop();
+	}
 }
 
 void Storm::SerializerManager::processRecordQueue_Unchecked()
@@ -230,20 +260,35 @@ void Storm::SerializerManager::processRecordQueue_Unchecked()
 	do
 	{
 		_recordWriter->write(*_pendingRecord.front());
+		_recordFramePool->release(std::move(_pendingRecord.front()));
 		_pendingRecord.pop();
 	} while(!_pendingRecord.empty());
 
 	_recordWriter->flush();
 }
 
-void Storm::SerializerManager::recordFrame(Storm::SerializeRecordPendingData &&frameRecord)
+std::unique_ptr<Storm::SerializeRecordPendingData> Storm::SerializerManager::acquireRecordFrame()
 {
-	executeOnSerializerThread([this, rec = Storm::FuncMovePass<Storm::SerializeRecordPendingData>{ std::move(frameRecord) }]() mutable
+	assert(Storm::isSimulationThread() && "this method should only be called from simulation thread.");
+	return _recordFramePool->acquire();
+}
+
+void Storm::SerializerManager::recordFrame(std::unique_ptr<Storm::SerializeRecordPendingData> &&frameRecord)
+{
+	executeOnSerializerThread([this, rec = Storm::FuncMovePass<std::unique_ptr<Storm::SerializeRecordPendingData>>{ std::move(frameRecord) }]() mutable
 	{
 		assert(Storm::isSerializerThread() && "This method should only be executed inside the serializer thread!");
 
-		_pendingRecord.emplace(std::make_unique<Storm::SerializeRecordPendingData>(std::move(rec._object)));
+		_pendingRecord.emplace(std::move(rec._object));
 	});
+
+	// Write it now instead of at the next refresh : the pool has only a few frames, the simulation would wait for the serializer if it records faster than k_recordFramePoolSize frames per refresh time.
+	{
+		std::lock_guard<std::mutex> lock{ _recordFramePushedMutex };
+		_recordFramePushed = true;
+	}
+
+	_recordFramePushedCV.notify_one();
 }
 
 void Storm::SerializerManager::beginRecord(Storm::SerializeRecordHeader &&recordHeader)
@@ -362,6 +407,19 @@ bool Storm::SerializerManager::resetReplay()
 	}
 }
 
+bool Storm::SerializerManager::seekReplay(const float physicsTime)
+{
+	assert(Storm::isSimulationThread() && "this method should only be called from simulation thread.");
+	if (_recordReader)
+	{
+		return _recordReader->seekToFrameBefore(physicsTime);
+	}
+	else
+	{
+		Storm::throwException<Storm::Exception>("We aren't replaying, therefore we cannot seek!");
+	}
+}
+
 void Storm::SerializerManager::saveState(Storm::StateSavingOrders &&savingOrder)
 {
 	executeOnSerializerThread([this, savingOrderFwd = Storm::FuncMovePass<Storm::StateSavingOrders>{ std::move(savingOrder) }]() mutable
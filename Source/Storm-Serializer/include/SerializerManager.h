@@ -9,6 +9,8 @@ namespace Storm
 	class RecordReader;
 	class RecordWriter;
 	class RecordArchiver;
+	class RecordFramePool;
+	class ITimeManager;
 
 	class SerializerManager final :
 		private Storm::Singleton<Storm::SerializerManager>,
@@ -30,12 +32,16 @@ namespace Storm
 		void run();
 		void execute();
 
+		// Waits for the refresh time, or less if the simulation pushed a record frame meanwhile. Returns false if we should exit.
+		bool waitRefreshOrRecordFrame(const Storm::ITimeManager &timeMgr, const std::chrono::milliseconds refreshTime);
+
 	private:
 		void clearRecordQueue();
 		void processRecordQueue_Unchecked();
 
 	public:
-		void recordFrame(Storm::SerializeRecordPendingData &&frameRecord) final override;
+		std::unique_ptr<Storm::SerializeRecordPendingData> acquireRecordFrame() final override;
+		void recordFrame(std::unique_ptr<Storm::SerializeRecordPendingData> &&frameRecord) final override;
 		void beginRecord(Storm::SerializeRecordHeader &&recordHeader) final override;
 
 	private:
@@ -51,6 +57,7 @@ namespace Storm
 
 	public:
 		bool resetReplay() final override;
+		bool seekReplay(const float physicsTime) final override;
 
 	public:
 		void saveState(Storm::StateSavingOrders &&savingOrder) final override;
@@ -72,6 +79,12 @@ namespace Storm
 		std::unique_ptr<Storm::RecordReader> _recordReader;
 		std::unique_ptr<Storm::RecordWriter> _recordWriter;
 		std::queue<std::unique_ptr<Storm::SerializeRecordPendingData>> _pendingRecord;
+		std::unique_ptr<Storm::RecordFramePool> _recordFramePool;
+
+		// Wakes up the serializer thread when a record frame is pushed, so the record fps isn't capped by the pool size over the refresh time.
+		bool _recordFramePushed;
+		std::mutex _recordFramePushedMutex;
+		std::condition_variable _recordFramePushedCV;
 
 		// State recording
 		std::unique_ptr<Storm::StateSavingOrders> _stateSavingRequestOrders;
@@ -3,6 +3,8 @@
 #include "IBlower.h"
 #include "BlowerState.h"
 
+#include "NeighborParticleReferral.h"
+
 
 namespace Storm
 {
@@ -242,6 +244,32 @@ namespace Storm
 			}
 		}
 
+		void applyForces(const std::vector<Storm::Vector3> &inParticlePositions, const Storm::NeighborParticleReferralBundle &bundle, const unsigned int systemId, std::vector<Storm::Vector3> &inOutParticleForces) const final override
+		{
+			if (_state != Storm::BlowerState::NotWorking)
+			{
+				for (const Storm::NeighborParticleReferral &referral : bundle)
+				{
+					if (referral._systemId == systemId)
+					{
+						this->applyForceInternal(inParticlePositions[referral._particleIndex], inOutParticleForces[referral._particleIndex]);
+					}
+				}
+			}
+		}
+
+		bool isBlowing() const final override
+		{
+			return _state != Storm::BlowerState::NotWorking;
+		}
+
+		void getEffectAreaBoundingBox(Storm::Vector3 &outMinCorner, Storm::Vector3 &outMaxCorner) const final override
+		{
+			const Storm::Vector3 halfExtent = BlowerEffectArea::getHalfExtent();
+			outMinCorner = _blowerPosition - halfExtent;
+			outMaxCorner = _blowerPosition + halfExtent;
+		}
+
 	public:
 		void tweakEnabling() final override
 		{
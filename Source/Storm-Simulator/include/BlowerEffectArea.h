@@ -22,6 +22,11 @@ namespace Storm
 				std::fabs(relativePosDiff.z()) < _dimension.z();
 		}
 
+		__forceinline Storm::Vector3 getHalfExtent() const
+		{
+			return _dimension;
+		}
+
 	protected:
 		const Storm::Vector3 _dimension;
 	};
@@ -34,6 +39,7 @@ namespace Storm
 
 	public:
 		using Storm::BlowerCubeArea::isInside;
+		using Storm::BlowerCubeArea::getHalfExtent;
 
 	public:
 		static constexpr bool hasDistanceEffect() { return true; }
@@ -72,6 +78,12 @@ namespace Storm
 			return false;
 		}
 
+		__forceinline Storm::Vector3 getHalfExtent() const
+		{
+			const float radius = std::sqrtf(_radiusSquared);
+			return Storm::Vector3{ radius, radius, radius };
+		}
+
 	protected:
 		float _radiusSquared;
 	};
@@ -83,6 +95,7 @@ namespace Storm
 
 	public:
 		using Storm::BlowerSphereArea::isInside;
+		using Storm::BlowerSphereArea::getHalfExtent;
 
 	protected:
 		static constexpr bool hasDistanceEffect() { return true; }
@@ -98,6 +111,7 @@ namespace Storm
 
 	public:
 		using Storm::BlowerSphereArea::isInside;
+		using Storm::BlowerSphereArea::getHalfExtent;
 
 	protected:
 		static constexpr bool hasDistanceEffect() { return true; }
@@ -116,6 +130,7 @@ namespace Storm
 
 	public:
 		using Storm::BlowerSphereArea::isInside;
+		using Storm::BlowerSphereArea::getHalfExtent;
 
 	protected:
 		static constexpr bool hasDistanceEffect() { return true; }
@@ -149,6 +164,12 @@ namespace Storm
 			return false;
 		}
 
+		__forceinline Storm::Vector3 getHalfExtent() const
+		{
+			const float radius = std::sqrtf(_radiusSquared);
+			return Storm::Vector3{ radius, _midHeight, radius };
+		}
+
 	protected:
 		float _midHeight;
 		float _radiusSquared;
@@ -162,6 +183,7 @@ namespace Storm
 
 	public:
 		using Storm::BlowerCylinderArea::isInside;
+		using Storm::BlowerCylinderArea::getHalfExtent;
 
 	protected:
 		static constexpr bool hasDistanceEffect() { return true; }
@@ -193,6 +215,13 @@ namespace Storm
 			return false;
 		}
 
+		__forceinline Storm::Vector3 getHalfExtent() const
+		{
+			// The radius is the biggest at one of the ends.
+			const float maxRadius = std::sqrtf(std::max(_downRadiusSquared, _downRadiusSquared + _diffRadiusSquared));
+			return Storm::Vector3{ maxRadius, _midHeight, maxRadius };
+		}
+
 	protected:
 		float _midHeight;
 		float _diffRadiusSquared;
@@ -0,0 +1,750 @@
+// ReSharper disable CppClangTidyCppcoreguidelinesProTypeStaticCastDowncast
+#include "CGSPHSolver.h"
+
+#include "CGSPHSolverData.h"
+
+#include "SingletonHolder.h"
+#include "IConfigManager.h"
+
+#include "SimulatorManager.h"
+
+#include "FluidParticleSystem.h"
+#include "RigidBodyParticleSystem.h"
+
+#include "RunnerHelper.h"
+#include "SPHSolverUtils.h"
+
+#include "Kernel.h"
+#include "ViscosityMethod.h"
+
+#include "SceneSimulationConfig.h"
+#include "SceneFluidConfig.h"
+#include "SceneFluidCustomCGSPHConfig.h"
+
+#include "IterationParameter.h"
+
+#define STORM_HIJACKED_TYPE Storm::CGSPHSolverData
+#	include "VectHijack.h"
+#undef STORM_HIJACKED_TYPE
+
+
+namespace
+{
+#define STORM_SOLVER_NAMES_XMACRO \
+	STORM_SOLVER_NAME("Pressure")
+
+	using GUINames = std::remove_reference_t<Storm::PredictiveSolverHandler::SolversNames>;
+
+	constexpr static GUINames g_solverIterationNames
+	{
+#define STORM_SOLVER_NAME(SolverName) STORM_TEXT(SolverName " solve iteration"),
+		STORM_SOLVER_NAMES_XMACRO
+#undef STORM_SOLVER_NAME
+
+		nullptr
+	};
+
+	constexpr static GUINames g_solverErrorsNames
+	{
+#define STORM_SOLVER_NAME(SolverName) STORM_TEXT(SolverName " solve error"),
+		STORM_SOLVER_NAMES_XMACRO
+#undef STORM_SOLVER_NAME
+
+		nullptr
+	};
+
+#undef STORM_SOLVER_NAMES_XMACRO
+
+
+	template<Storm::ViscosityMethod viscosityMethodOnFluid, Storm::ViscosityMethod viscosityMethodOnRigidBody>
+	Storm::Vector3 computeViscosity(const Storm::IterationParameter &iterationParameter, const Storm::SceneFluidConfig &fluidConfig, const Storm::FluidParticleSystem &fluidParticleSystem, const float currentPMass, const Storm::Vector3 &vi, const Storm::ParticleNeighborhoodArray &currentPNeighborhood, const float currentPDensity, const float viscoPrecoeff, Storm::RigidBodyReactionAccumulator::Chunk &rbReactions)
+	{
+		Storm::Vector3 totalViscosityForceOnParticle = Storm::Vector3::Zero();
+
+		const float density0 = fluidParticleSystem.getRestDensity();
+
+		for (const Storm::NeighborParticleInfo &neighbor : currentPNeighborhood)
+		{
+			const Storm::Vector3 vij = vi - neighbor._containingParticleSystem->getVelocity()[neighbor._particleIndex];
+
+			const float vijDotXij = vij.dot(neighbor._xij);
+			const float viscoGlobalCoeff = currentPMass * 10.f * vijDotXij / (neighbor._xijSquaredNorm + viscoPrecoeff);
+
+			Storm::Vector3 viscosityComponent;
+
+			if (neighbor._isFluidParticle)
+			{
+				const Storm::FluidParticleSystem* neighborPSystemAsFluid = static_cast<Storm::FluidParticleSystem*>(neighbor._containingParticleSystem);
+				const float neighborDensity0 = neighborPSystemAsFluid->getRestDensity();
+				const float neighborMass = neighborPSystemAsFluid->getMasses()[neighbor._particleIndex];
+				const float neighborRawDensity = neighborPSystemAsFluid->getDensities()[neighbor._particleIndex];
+				const float neighborDensity = neighborRawDensity * density0 / neighborDensity0;
+
+				if constexpr (viscosityMethodOnFluid == Storm::ViscosityMethod::Standard)
+				{
+					viscosityComponent = (viscoGlobalCoeff * fluidConfig._cinematicViscosity * neighborMass / neighborRawDensity) * neighbor._gradWij;
+				}
+				else if constexpr (viscosityMethodOnFluid == Storm::ViscosityMethod::XSPH)
+				{
+					viscosityComponent = (-(currentPMass * neighborMass * fluidConfig._cinematicViscosity / (iterationParameter._deltaTime * neighborDensity)) * neighbor._Wij) * vij;
+				}
+				else
+				{
+					Storm::throwException<Storm::Exception>("Non implemented viscosity method to use on fluid!");
+				}
+			}
+			else
+			{
+				const Storm::RigidBodyParticleSystem* neighborPSystemAsBoundary = static_cast<Storm::RigidBodyParticleSystem*>(neighbor._containingParticleSystem);
+
+				const float rbViscosity = neighborPSystemAsBoundary->getViscosity();
+
+				// Viscosity
+				if (rbViscosity > 0.f)
+				{
+					const float neighborVolume = neighborPSystemAsBoundary->getVolumes()[neighbor._particleIndex];
+					if constexpr (viscosityMethodOnRigidBody == Storm::ViscosityMethod::Standard)
+					{
+						viscosityComponent = (viscoGlobalCoeff * rbViscosity * neighborVolume * density0 / currentPDensity) * neighbor._gradWij;
+					}
+					else if constexpr (viscosityMethodOnRigidBody == Storm::ViscosityMethod::XSPH)
+					{
+						viscosityComponent = (-(currentPMass * rbViscosity * neighborVolume * density0 / (iterationParameter._deltaTime * currentPDensity)) * neighbor._Wij) * vij;
+					}
+					else
+					{
+						Storm::throwException<Storm::Exception>("Non implemented viscosity method to use on rigid body!");
+					}
+				}
+				else
+				{
+					viscosityComponent = Storm::Vector3::Zero();
+				}
+
+				// Mirror the force on the boundary solid following the 3rd newton law
+				if (!neighborPSystemAsBoundary->isStatic())
+				{
+					Storm::Vector3 &boundaryNeighborTmpViscosityForce = neighbor._containingParticleSystem->getTemporaryViscosityForces()[neighbor._particleIndex];
+
+					rbReactions.subtract(boundaryNeighborTmpViscosityForce, viscosityComponent);
+				}
+			}
+
+			totalViscosityForceOnParticle += viscosityComponent;
+		}
+
+		return totalViscosityForceOnParticle;
+	}
+}
+
+
+Storm::CGSPHSolver::CGSPHSolver(const float /*k_kernelLength*/, const Storm::ParticleSystemContainer &particleSystemsMap) :
+	Storm::PredictiveSolverHandler{ g_solverIterationNames, g_solverErrorsNames }
+{
+	std::size_t totalParticleCount = 0;
+
+	for (const auto &particleSystemPair : particleSystemsMap)
+	{
+		const Storm::ParticleSystem &currentPSystem = *particleSystemPair.second;
+		if (currentPSystem.isFluids())
+		{
+			const Storm::VectorHijacker currentPSystemPCount{ currentPSystem.getParticleCount() };
+
+			std::vector<Storm::CGSPHSolverData> &currentPSystemData = _data[particleSystemPair.first];
+			currentPSystemData.reserve(currentPSystemPCount._newSize);
+			Storm::setNumUninitialized_hijack(currentPSystemData, currentPSystemPCount);
+
+			Storm::runParallel(currentPSystemData, [](Storm::CGSPHSolverData &currentPData)
+			{
+				currentPData._stiffness = 0.f;
+			});
+
+			totalParticleCount += currentPSystemPCount._newSize;
+		}
+	}
+
+	_totalParticleCountFl = static_cast<float>(totalParticleCount);
+}
+
+void Storm::CGSPHSolver::execute(const Storm::IterationParameter &iterationParameter)
+{
+	// Note :
+	// Even if some part of the algorithm is exactly the same as inside other solvers, I did not factorize on purpose (I did, but reverted immediately because it was a really bad idea) !
+	// The reason is that the algorithm piece works for this solver. If a bug arise, then it could be because of this solver algorithm and don't have anything to do with other solvers algorithm,
+	// therefore trying to fix the parent factorized method is not the right solution since it would risk to jeopardize all other solvers.
+	//
+	// Yes I know it is hard to maintain with all those copy-pasted piece of code, but it would be harder to improve/develop a specific solver where all modifications are shared and could break other solvers we didn't test (since I don't have any QA and don't have time to test every solvers myself, it is preferable to keep copy pasted code).
+	// Therefore, if you detect a bug in any solvers, and think the bug would impact other solvers, check them manually one by one and fix the issue locally.
+
+	const Storm::SingletonHolder &singletonHolder = Storm::SingletonHolder::instance();
+
+	const Storm::IConfigManager &configMgr = singletonHolder.getSingleton<Storm::IConfigManager>();
+	const Storm::SceneSimulationConfig &sceneSimulationConfig = configMgr.getSceneSimulationConfig();
+	const Storm::SceneFluidConfig &fluidConfig = configMgr.getSceneFluidConfig();
+	const Storm::SceneFluidCustomCGSPHConfig &sceneCgsphFluidConfig = static_cast<const Storm::SceneFluidCustomCGSPHConfig &>(*fluidConfig._customSimulationSettings);
+	
+	Storm::SimulatorManager &simulMgr = Storm::SimulatorManager::instance();
+
+	const float k_kernelZero = Storm::retrieveKernelZeroValue(sceneSimulationConfig._kernelMode);
+	
+	unsigned int currentPredictionIter = 0;
+
+	const float deltaTimeSquared = iterationParameter._deltaTime * iterationParameter._deltaTime;
+
+	Storm::ParticleSystemContainer &particleSystems = *iterationParameter._particleSystems;
+
+	// 1st : Initialize iteration
+	simulMgr.advanceBlowersTime(iterationParameter._deltaTime);
+	simulMgr.refreshParticleNeighborhood();
+	simulMgr.subIterationStart();
+
+	if (!this->shouldContinue()) STORM_UNLIKELY
+	{
+		return;
+	}
+
+	// 2nd : Compute the base density
+	for (auto &particleSystemPair : particleSystems)
+	{
+		Storm::ParticleSystem &currentParticleSystem = *particleSystemPair.second;
+		if (currentParticleSystem.isFluids())
+		{
+			Storm::FluidParticleSystem &fluidParticleSystem = static_cast<Storm::FluidParticleSystem &>(currentParticleSystem);
+
+			const float particleVolume = fluidParticleSystem.getParticleVolume();
+			const float density0 = fluidParticleSystem.getRestDensity();
+			const Storm::ParticleNeighborhoodStorage &neighborhoodArrays = fluidParticleSystem.getNeighborhoodArrays();
+			std::vector<float> &masses = fluidParticleSystem.getMasses();
+
+			Storm::runParallel(fluidParticleSystem.getDensities(), [&](float &currentPDensity, const std::size_t currentPIndex)
+			{
+				// Density
+				currentPDensity = particleVolume * k_kernelZero;
+
+				const Storm::ParticleNeighborhoodArray currentPNeighborhood = neighborhoodArrays[currentPIndex];
+				for (const Storm::NeighborParticleInfo &neighbor : currentPNeighborhood)
+				{
+					float deltaDensity;
+					if (neighbor._isFluidParticle)
+					{
+						deltaDensity = static_cast<Storm::FluidParticleSystem*>(neighbor._containingParticleSystem)->getParticleVolume() * neighbor._Wij;
+					}
+					else
+					{
+						deltaDensity = static_cast<Storm::RigidBodyParticleSystem*>(neighbor._containingParticleSystem)->getVolumes()[neighbor._particleIndex] * neighbor._Wij;
+					}
+					currentPDensity += deltaDensity;
+				}
+
+				// Volume * density is mass...
+				currentPDensity *= density0;
+
+				float &currentPMass = masses[currentPIndex];
+				currentPMass = currentPDensity * particleVolume;
+			});
+		}
+	}
+
+	if (!this->shouldContinue()) STORM_UNLIKELY
+	{
+		return;
+	}
+
+	// 3rd : Compute the non pressure forces (viscosity)
+	for (auto &particleSystemPair : particleSystems)
+	{
+		Storm::ParticleSystem &currentParticleSystem = *particleSystemPair.second;
+		if (currentParticleSystem.isFluids())
+		{
+			Storm::FluidParticleSystem &fluidParticleSystem = static_cast<Storm::FluidParticleSystem &>(currentParticleSystem);
+
+			const Storm::ParticleNeighborhoodStorage &neighborhoodArrays = currentParticleSystem.getNeighborhoodArrays();
+			std::vector<float> &masses = fluidParticleSystem.getMasses();
+			const std::vector<float> &densities = fluidParticleSystem.getDensities();
+			std::vector<Storm::Vector3> &temporaryPViscoForces = fluidParticleSystem.getTemporaryViscosityForces();
+
+			const std::vector<Storm::Vector3> &velocities = fluidParticleSystem.getVelocity();
+
+			const float viscoPrecoeff = 0.01f * iterationParameter._kernelLengthSquared;
+
+			std::vector<Storm::CGSPHSolverData> &dataField = _data.find(particleSystemPair.first)->second;
+
+			_rbReactionAccumulator.runParallel(fluidParticleSystem.getForces(), [&](Storm::Vector3 &currentPForce, const std::size_t currentPIndex, Storm::RigidBodyReactionAccumulator::Chunk &rbReactions)
+			{
+				const float currentPMass = masses[currentPIndex];
+				const float currentPDensity = densities[currentPIndex];
+				const Storm::Vector3 &vi = velocities[currentPIndex];
+
+				Storm::Vector3 &currentPTmpViscoForce = temporaryPViscoForces[currentPIndex];
+
+				// Sleeping particles are frozen, their non pressure forces are null.
+				const Storm::ParticleNeighborhoodArray currentPNeighborhood = fluidParticleSystem.isParticleSleeping(currentPIndex) ? neighborhoodArrays.getEmptyNeighborhood(currentPIndex) : neighborhoodArrays[currentPIndex];
+
+#define STORM_COMPUTE_VISCOSITY(fluidMethod, rbMethod) \
+	computeViscosity<fluidMethod, rbMethod>(iterationParameter, fluidConfig, fluidParticleSystem, currentPMass, vi, currentPNeighborhood, currentPDensity, viscoPrecoeff, rbReactions)
+
+				switch (sceneSimulationConfig._fluidViscoMethod)
+				{
+				case Storm::ViscosityMethod::Standard:
+					switch (sceneSimulationConfig._rbViscoMethod)
+					{
+					case Storm::ViscosityMethod::Standard:
+						currentPTmpViscoForce = STORM_COMPUTE_VISCOSITY(Storm::ViscosityMethod::Standard, Storm::ViscosityMethod::Standard);
+						break;
+					case Storm::ViscosityMethod::XSPH:
+						currentPTmpViscoForce = STORM_COMPUTE_VISCOSITY(Storm::ViscosityMethod::Standard, Storm::ViscosityMethod::XSPH);
+						break;
+
+					default:
+						Storm::throwException<Storm::Exception>("Non implemented viscosity method to use on rigid body!");
+					}
+					break;
+
+				case Storm::ViscosityMethod::XSPH:
+					switch (sceneSimulationConfig._rbViscoMethod)
+					{
+					case Storm::ViscosityMethod::Standard:
+						currentPTmpViscoForce = STORM_COMPUTE_VISCOSITY(Storm::ViscosityMethod::XSPH, Storm::ViscosityMethod::Standard);
+						break;
+					case Storm::ViscosityMethod::XSPH:
+						currentPTmpViscoForce = STORM_COMPUTE_VISCOSITY(Storm::ViscosityMethod::XSPH, Storm::ViscosityMethod::XSPH);
+						break;
+
+					default:
+						Storm::throwException<Storm::Exception>("Non implemented viscosity method to use on rigid body!");
+					}
+					break;
+
+				default:
+					Storm::throwException<Storm::Exception>("Non implemented viscosity method to use on fluid!");
+				}
+
+#undef STORM_COMPUTE_VISCOSITY
+
+				currentPForce += currentPTmpViscoForce;
+
+				if (sceneSimulationConfig._applyDragEffect)
+				{
+					Storm::Vector3 &currentPTmpDragForceComponent = fluidParticleSystem.getTemporaryDragForces()[currentPIndex];
+
+					if (fluidConfig._uniformDragCoefficient > 0.f)
+					{
+						currentPTmpDragForceComponent = Storm::SPHSolverUtils::computeSumDragForce<true>(iterationParameter, fluidConfig._uniformDragCoefficient, fluidParticleSystem, vi, currentPNeighborhood, currentPDensity, rbReactions);
+					}
+					else
+					{
+						currentPTmpDragForceComponent = Storm::SPHSolverUtils::computeSumDragForce<false>(iterationParameter, fluidConfig._uniformDragCoefficient, fluidParticleSystem, vi, currentPNeighborhood, currentPDensity, rbReactions);
+					}
+
+					currentPForce += currentPTmpDragForceComponent;
+				}
+
+				// We should also initialize the data field now (avoid to restart the threads).
+				Storm::CGSPHSolverData &currentPDataField = dataField[currentPIndex];
+
+				currentPDataField._nonPressureAcceleration = currentPForce / currentPMass;
+				currentPDataField._predictedAcceleration = currentPDataField._nonPressureAcceleration;
+				currentPDataField._predictedVelocity = vi + currentPDataField._nonPressureAcceleration * iterationParameter._deltaTime;
+
+				// Note : Maybe we should also compute a prediction of the position ?
+			});
+		}
+	}
+
+	if (!this->shouldContinue()) STORM_UNLIKELY
+	{
+		return;
+	}
+
+
+	// 4th : compute advected density, the gradient sums and the Jacobi preconditioner
+	for (auto &dataFieldPair : _data)
+	{
+		// Since data field was made from fluids particles only, no need to check if this is a fluid.
+		const Storm::FluidParticleSystem &fluidParticleSystem = static_cast<const Storm::FluidParticleSystem &>(*particleSystems.find(dataFieldPair.first)->second);
+
+		const std::vector<float> &densities = fluidParticleSystem.getDensities();
+		const Storm::ParticleNeighborhoodStorage &neighborhoodArrays = fluidParticleSystem.getNeighborhoodArrays();
+
+		const float density0 = fluidParticleSystem.getRestDensity();
+
+		Storm::runParallel(dataFieldPair.second, [&](Storm::CGSPHSolverData &currentPData, const std::size_t currentPIndex)
+		{
+			const Storm::ParticleNeighborhoodArray currentPNeighborhood = neighborhoodArrays[currentPIndex];
+
+			currentPData._advectedDensity = 0.f;
+			currentPData._sumGradWij.setZero();
+
+			float fluidSumSquaredGradWij = 0.f;
+
+			Storm::Vector3 diffVelocity;
+
+			const std::vector<Storm::CGSPHSolverData>* neighborDataArray = &dataFieldPair.second;
+			const Storm::FluidParticleSystem* lastNeighborFluidSystem = &fluidParticleSystem;
+
+			float neighborPVolume;
+
+			for (const Storm::NeighborParticleInfo &neighborInfo : currentPNeighborhood)
+			{
+				if (neighborInfo._isFluidParticle)
+				{
+					if (neighborInfo._containingParticleSystem != lastNeighborFluidSystem)
+					{
+						lastNeighborFluidSystem = static_cast<const Storm::FluidParticleSystem*>(neighborInfo._containingParticleSystem);
+						neighborDataArray = &_data.find(lastNeighborFluidSystem->getId())->second;
+					}
+
+					const Storm::CGSPHSolverData &neighborData = (*neighborDataArray)[neighborInfo._particleIndex];
+
+					neighborPVolume = lastNeighborFluidSystem->getParticleVolume();
+					diffVelocity = currentPData._predictedVelocity - neighborData._predictedVelocity;
+
+					fluidSumSquaredGradWij += neighborPVolume * neighborPVolume * neighborInfo._gradWij.squaredNorm();
+				}
+				else
+				{
+					const Storm::RigidBodyParticleSystem &neighborRbSystem = static_cast<const Storm::RigidBodyParticleSystem &>(*neighborInfo._containingParticleSystem);
+
+					neighborPVolume = neighborRbSystem.getVolumes()[neighborInfo._particleIndex];
+					diffVelocity = currentPData._predictedVelocity - neighborRbSystem.getVelocity()[neighborInfo._particleIndex];
+				}
+
+				currentPData._advectedDensity += neighborPVolume * diffVelocity.dot(neighborInfo._gradWij);
+				currentPData._sumGradWij += neighborPVolume * neighborInfo._gradWij;
+			}
+
+			currentPData._advectedDensity *= iterationParameter._deltaTime;
+			currentPData._advectedDensity += densities[currentPIndex] / density0;
+
+			// The diagonal of the pressure operator is the same coefficient DFSPH uses as its denominator.
+			const float diagonal = deltaTimeSquared * (currentPData._sumGradWij.squaredNorm() + fluidSumSquaredGradWij);
+			if (diagonal > 0.000000001f)
+			{
+				currentPData._invDiagonal = 1.f / diagonal;
+			}
+			else
+			{
+				currentPData._invDiagonal = 0.f;
+			}
+
+			// Like IISPH, start from a relaxed value of the pressure stiffness the last step ended with.
+			currentPData._stiffness *= fluidConfig._pressureInitRelaxationCoefficient;
+			currentPData._searchDirection = currentPData._stiffness;
+		});
+	}
+
+	if (!this->shouldContinue()) STORM_UNLIKELY
+	{
+		return;
+	}
+
+	// The pressure operator is applied matrix free. It is A = dt^2 * D * G where G gives the pressure acceleration from the stiffness and D is the SPH divergence.
+	// D is the transpose of G (up to the particle volumes), therefore A is symmetric positive semi-definite and suited for a conjugate gradient.
+	// The operator is applied to the search direction in 2 neighborhood passes : the first one computes G and the second one computes D.
+	const auto computeSearchDirectionGradient = [this, &particleSystems]()
+	{
+		for (auto &dataFieldPair : _data)
+		{
+			// Since data field was made from fluids particles only, no need to check if this is a fluid.
+			const Storm::FluidParticleSystem &fluidParticleSystem = static_cast<const Storm::FluidParticleSystem &>(*particleSystems.find(dataFieldPair.first)->second);
+
+			const Storm::ParticleNeighborhoodStorage &neighborhoodArrays = fluidParticleSystem.getNeighborhoodArrays();
+
+			Storm::runParallel(dataFieldPair.second, [&](Storm::CGSPHSolverData &currentPData, const std::size_t currentPIndex)
+			{
+				const Storm::ParticleNeighborhoodArray currentPNeighborhood = neighborhoodArrays[currentPIndex];
+
+				// Rigid bodies don't have any stiffness, they only contribute to the sum of gradients.
+				currentPData._searchDirectionGradient = currentPData._searchDirection * currentPData._sumGradWij;
+
+				const std::vector<Storm::CGSPHSolverData>* neighborDataArray = &dataFieldPair.second;
+				const Storm::FluidParticleSystem* lastNeighborFluidSystem = &fluidParticleSystem;
+
+				for (const Storm::NeighborParticleInfo &neighborInfo : currentPNeighborhood)
+				{
+					if (neighborInfo._isFluidParticle)
+					{
+						if (neighborInfo._containingParticleSystem != lastNeighborFluidSystem)
+						{
+							lastNeighborFluidSystem = static_cast<const Storm::FluidParticleSystem*>(neighborInfo._containingParticleSystem);
+							neighborDataArray = &_data.find(lastNeighborFluidSystem->getId())->second;
+						}
+
+						const Storm::CGSPHSolverData &neighborData = (*neighborDataArray)[neighborInfo._particleIndex];
+						currentPData._searchDirectionGradient += (lastNeighborFluidSystem->getParticleVolume() * neighborData._searchDirection) * neighborInfo._gradWij;
+					}
+				}
+			});
+		}
+	};
+
+	const auto applyPressureOperator = [this, &particleSystems, deltaTimeSquared]()
+	{
+		float directionDotOperatorResult = 0.f;
+
+		for (auto &dataFieldPair : _data)
+		{
+			// Since data field was made from fluids particles only, no need to check if this is a fluid.
+			const Storm::FluidParticleSystem &fluidParticleSystem = static_cast<const Storm::FluidParticleSystem &>(*particleSystems.find(dataFieldPair.first)->second);
+
+			const Storm::ParticleNeighborhoodStorage &neighborhoodArrays = fluidParticleSystem.getNeighborhoodArrays();
+
+			const Storm::ParallelReduceResult operatorResult = Storm::reduceChunkedParallel(dataFieldPair.second, [&](Storm::CGSPHSolverData &currentPData, const std::size_t currentPIndex, Storm::ParallelReduceResult &chunkResult)
+			{
+				const Storm::ParticleNeighborhoodArray currentPNeighborhood = neighborhoodArrays[currentPIndex];
+
+				float divergence = currentPData._searchDirectionGradient.dot(currentPData._sumGradWij);
+
+				const std::vector<Storm::CGSPHSolverData>* neighborDataArray = &dataFieldPair.second;
+				const Storm::FluidParticleSystem* lastNeighborFluidSystem = &fluidParticleSystem;
+
+				for (const Storm::NeighborParticleInfo &neighborInfo : currentPNeighborhood)
+				{
+					if (neighborInfo._isFluidParticle)
+					{
+						if (neighborInfo._containingParticleSystem != lastNeighborFluidSystem)
+						{
+							lastNeighborFluidSystem = static_cast<const Storm::FluidParticleSystem*>(neighborInfo._containingParticleSystem);
+							neighborDataArray = &_data.find(lastNeighborFluidSystem->getId())->second;
+						}
+
+						const Storm::CGSPHSolverData &neighborData = (*neighborDataArray)[neighborInfo._particleIndex];
+						divergence -= lastNeighborFluidSystem->getParticleVolume() * neighborData._searchDirectionGradient.dot(neighborInfo._gradWij);
+					}
+				}
+
+				currentPData._operatorResult = deltaTimeSquared * divergence;
+				chunkResult._sum += currentPData._searchDirection * currentPData._operatorResult;
+			});
+
+			directionDotOperatorResult += operatorResult._sum;
+		}
+
+		return directionDotOperatorResult;
+	};
+
+	// 5th : solve the pressure poisson equation with a Jacobi preconditioned conjugate gradient
+	float averageDensityError;
+
+	// Reset the rigid bodies pressure forces, they are only computed once the stiffness is known.
+	this->initializePredictionIteration(particleSystems, averageDensityError);
+
+	// Initial residual. The source term only corrects compression, like the pressure clamping of IISPH would
+	// (we cannot clamp the pressure inside the solve since it would break the conjugate gradient).
+	computeSearchDirectionGradient();
+	applyPressureOperator();
+
+	float residualDotPreconditioned = 0.f;
+	for (auto &dataFieldPair : _data)
+	{
+		const Storm::ParallelReduceResult initResult = Storm::reduceChunkedParallel(dataFieldPair.second, [](Storm::CGSPHSolverData &currentPData, const std::size_t, Storm::ParallelReduceResult &chunkResult)
+		{
+			currentPData._residual = std::max(currentPData._advectedDensity - 1.f, 0.f) - currentPData._operatorResult;
+			currentPData._preconditionedResidual = currentPData._invDiagonal * currentPData._residual;
+			currentPData._searchDirection = currentPData._preconditionedResidual;
+
+			chunkResult._sum += currentPData._residual * currentPData._preconditionedResidual;
+		});
+
+		residualDotPreconditioned += initResult._sum;
+	}
+
+	if (!this->shouldContinue()) STORM_UNLIKELY
+	{
+		return;
+	}
+
+	do
+	{
+		computeSearchDirectionGradient();
+		const float directionDotOperatorResult = applyPressureOperator();
+
+		if (!this->shouldContinue()) STORM_UNLIKELY
+		{
+			return;
+		}
+
+		const float alpha = directionDotOperatorResult > 0.000000001f ? residualDotPreconditioned / directionDotOperatorResult : 0.f;
+
+		float newResidualDotPreconditioned = 0.f;
+		for (auto &dataFieldPair : _data)
+		{
+			const Storm::ParallelReduceResult updateResult = Storm::reduceChunkedParallel(dataFieldPair.second, [alpha](Storm::CGSPHSolverData &currentPData, const std::size_t, Storm::ParallelReduceResult &chunkResult)
+			{
+				currentPData._stiffness += alpha * currentPData._searchDirection;
+				currentPData._residual -= alpha * currentPData._operatorResult;
+				currentPData._preconditionedResidual = currentPData._invDiagonal * currentPData._residual;
+
+				chunkResult._sum += currentPData._residual * currentPData._preconditionedResidual;
+			});
+
+			newResidualDotPreconditioned += updateResult._sum;
+		}
+
+		const float beta = residualDotPreconditioned > 0.000000001f ? newResidualDotPreconditioned / residualDotPreconditioned : 0.f;
+		residualDotPreconditioned = newResidualDotPreconditioned;
+
+		// Update the search direction and evaluate the error (same unit as IISPH) at the same time.
+		averageDensityError = 0.f;
+		for (auto &dataFieldPair : _data)
+		{
+			const float currentPSystemDensity0 = static_cast<const Storm::FluidParticleSystem &>(*particleSystems.find(dataFieldPair.first)->second).getRestDensity();
+
+			const Storm::ParallelReduceResult directionResult = Storm::reduceChunkedParallel(dataFieldPair.second, [beta, currentPSystemDensity0](Storm::CGSPHSolverData &currentPData, const std::size_t, Storm::ParallelReduceResult &chunkResult)
+			{
+				currentPData._searchDirection = currentPData._preconditionedResidual + beta * currentPData._searchDirection;
+				chunkResult._sum += currentPSystemDensity0 * std::fabs(currentPData._residual);
+			});
+
+			averageDensityError += directionResult._sum;
+		}
+
+		averageDensityError /= _totalParticleCountFl;
+
+		if (!this->shouldContinue()) STORM_UNLIKELY
+		{
+			return;
+		}
+
+		++currentPredictionIter;
+
+	} while (currentPredictionIter < sceneCgsphFluidConfig._minPredictIteration || (currentPredictionIter < sceneCgsphFluidConfig._maxPredictIteration && averageDensityError > sceneCgsphFluidConfig._maxError));
+
+	this->updateCurrentPredictionIter(currentPredictionIter, sceneCgsphFluidConfig._maxPredictIteration, averageDensityError, sceneCgsphFluidConfig._maxError, 0);
+
+	if (!this->shouldContinue()) STORM_UNLIKELY
+	{
+		return;
+	}
+
+	// 6th : Compute the pressure force
+	for (auto &dataFieldPair : _data)
+	{
+		// Since data field was made from fluids particles only, no need to check if this is a fluid.
+		Storm::FluidParticleSystem &fluidParticleSystem = static_cast<Storm::FluidParticleSystem &>(*particleSystems.find(dataFieldPair.first)->second);
+
+		const std::vector<float> &masses = fluidParticleSystem.getMasses();
+		const std::vector<float> &densities = fluidParticleSystem.getDensities();
+		std::vector<float> &pressures = fluidParticleSystem.getPressures();
+		const float currentPSystemDensity0 = fluidParticleSystem.getRestDensity();
+		const Storm::ParticleNeighborhoodStorage &neighborhoodArrays = fluidParticleSystem.getNeighborhoodArrays();
+
+		_rbReactionAccumulator.runParallel(dataFieldPair.second, [&](Storm::CGSPHSolverData &currentPData, const std::size_t currentPIndex, Storm::RigidBodyReactionAccumulator::Chunk &rbReactions)
+		{
+			const Storm::ParticleNeighborhoodArray currentPNeighborhood = neighborhoodArrays[currentPIndex];
+			const float currentPDensity = densities[currentPIndex];
+			const float currentPMass = masses[currentPIndex];
+
+			// The stiffness is density0 * pressure / density^2.
+			pressures[currentPIndex] = currentPData._stiffness * currentPDensity * currentPDensity / currentPSystemDensity0;
+
+			Storm::Vector3 pressureAccel = currentPData._stiffness * currentPData._sumGradWij;
+
+			const std::vector<Storm::CGSPHSolverData>* neighborDataArray = &dataFieldPair.second;
+			const Storm::FluidParticleSystem* lastNeighborFluidSystem = &fluidParticleSystem;
+
+			for (const Storm::NeighborParticleInfo &neighborInfo : currentPNeighborhood)
+			{
+				if (neighborInfo._isFluidParticle)
+				{
+					if (neighborInfo._containingParticleSystem != lastNeighborFluidSystem)
+					{
+						lastNeighborFluidSystem = static_cast<const Storm::FluidParticleSystem*>(neighborInfo._containingParticleSystem);
+						neighborDataArray = &_data.find(lastNeighborFluidSystem->getId())->second;
+					}
+
+					const Storm::CGSPHSolverData &neighborData = (*neighborDataArray)[neighborInfo._particleIndex];
+					pressureAccel += (lastNeighborFluidSystem->getParticleVolume() * neighborData._stiffness) * neighborInfo._gradWij;
+				}
+				else
+				{
+					Storm::RigidBodyParticleSystem &neighborPSystemAsRb = static_cast<Storm::RigidBodyParticleSystem &>(*neighborInfo._containingParticleSystem);
+					if (!neighborPSystemAsRb.isStatic())
+					{
+						const Storm::Vector3 pressureForceOnRb = (currentPMass * currentPData._stiffness * neighborPSystemAsRb.getVolumes()[neighborInfo._particleIndex]) * neighborInfo._gradWij;
+
+						Storm::Vector3 &tmpPressureForce = neighborPSystemAsRb.getTemporaryPressureForces()[neighborInfo._particleIndex];
+
+						rbReactions.add(tmpPressureForce, pressureForceOnRb);
+					}
+				}
+			}
+
+			currentPData._predictedAcceleration -= pressureAccel;
+		});
+	}
+
+	if (!this->shouldContinue()) STORM_UNLIKELY
+	{
+		return;
+	}
+
+	this->transfertEndDataToSystems(particleSystems, iterationParameter, &_data, [](void* data, const unsigned int pSystemId, Storm::FluidParticleSystem &fluidParticleSystem, const Storm::IterationParameter &iterationParameter)
+	{
+		auto &dataField = reinterpret_cast<decltype(_data)*>(data)->find(pSystemId)->second;
+
+		const std::vector<float> &masses = fluidParticleSystem.getMasses();
+		std::vector<Storm::Vector3> &forces = fluidParticleSystem.getForces();
+		std::vector<Storm::Vector3> &velocities = fluidParticleSystem.getVelocity();
+		std::vector<Storm::Vector3> &positions = fluidParticleSystem.getPositions();
+		std::vector<Storm::Vector3> &tmpPressureForces = fluidParticleSystem.getTemporaryPressureForces();
+
+#pragma warning (push)
+#pragma warning (disable: 4189) // It is being used, but the compiler isn't able to tell until it compiles it
+		constexpr const float minForceDirtyEpsilon = 0.0001f;
+#pragma warning (pop)
+
+		const Storm::ParallelReduceResult integrationResult = Storm::reduceChunkedParallel(dataField, [&](const Storm::CGSPHSolverData &currentPData, const std::size_t currentPIndex, Storm::ParallelReduceResult &chunkResult)
+		{
+			const float currentPMass = masses[currentPIndex];
+			forces[currentPIndex] = currentPData._predictedAcceleration * currentPMass;
+			tmpPressureForces[currentPIndex] = (currentPData._predictedAcceleration - currentPData._nonPressureAcceleration) * currentPMass;
+
+			// Euler integration
+			Storm::Vector3 &currentPVelocity = velocities[currentPIndex];
+			Storm::Vector3 &currentPPositions = positions[currentPIndex];
+
+			currentPVelocity += currentPData._predictedAcceleration * iterationParameter._deltaTime;
+			currentPPositions += currentPVelocity * iterationParameter._deltaTime;
+
+			if (!chunkResult._flag)
+			{
+				if (
+					std::fabs(currentPVelocity.x()) > minForceDirtyEpsilon ||
+					std::fabs(currentPVelocity.y()) > minForceDirtyEpsilon ||
+					std::fabs(currentPVelocity.z()) > minForceDirtyEpsilon
+					)
+				{
+					chunkResult._flag = true;
+				}
+			}
+		});
+
+		fluidParticleSystem.setIsDirty(integrationResult._flag);
+	});
+
+	// 7th : flush physics state (rigid bodies)
+	simulMgr.flushPhysics(iterationParameter._deltaTime);
+}
+
+void Storm::CGSPHSolver::removeRawEndData(const unsigned int pSystemId, std::size_t toRemoveCount)
+{
+	Storm::SPHSolverUtils::removeRawEndData(pSystemId, toRemoveCount, _data);
+}
+
+void Storm::CGSPHSolver::reorderParticleData(const unsigned int pSystemId, const std::vector<std::size_t> &newToOldIndexes)
+{
+	Storm::SPHSolverUtils::reorderData(pSystemId, newToOldIndexes, _data);
+}
+
+void Storm::CGSPHSolver::compactParticleData(const unsigned int pSystemId, const Storm::ParticleCompaction &compaction)
+{
+	Storm::SPHSolverUtils::compactData(pSystemId, compaction, _data);
+	_totalParticleCountFl -= static_cast<float>(compaction.getRemovedCount());
+}
+
+void Storm::CGSPHSolver::appendRawEndData(const unsigned int pSystemId, std::size_t toAddCount)
+{
+	Storm::SPHSolverUtils::appendRawEndData(pSystemId, toAddCount, _data);
+	_totalParticleCountFl += static_cast<float>(toAddCount);
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "SPHBaseSolver.h"
+#include "PredictiveSolverHandler.h"
+#include "SPHSolverPrivateLogic.h"
+
+
+namespace Storm
+{
+	struct CGSPHSolverData;
+
+	class CGSPHSolver :
+		public Storm::ISPHBaseSolver,
+		private Storm::PredictiveSolverHandler,
+		private Storm::SPHSolverPrivateLogic
+	{
+	public:
+		CGSPHSolver(const float k_kernelLength, const Storm::ParticleSystemContainer &particleSystemsMap);
+
+	public:
+		void execute(const Storm::IterationParameter &iterationParameter) final override;
+		void removeRawEndData(const unsigned int pSystemId, std::size_t toRemoveCount) final override;
+		void reorderParticleData(const unsigned int pSystemId, const std::vector<std::size_t> &newToOldIndexes) final override;
+		void compactParticleData(const unsigned int pSystemId, const Storm::ParticleCompaction &compaction) final override;
+		void appendRawEndData(const unsigned int pSystemId, std::size_t toAddCount) final override;
+
+	private:
+		std::map<unsigned int, std::vector<Storm::CGSPHSolverData>> _data;
+		float _totalParticleCountFl;
+	};
+}
\ No newline at end of file
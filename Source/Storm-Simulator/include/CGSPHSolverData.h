@@ -0,0 +1,26 @@
+#pragma once
+
+
+namespace Storm
+{
+	struct CGSPHSolverData
+	{
+	public:
+		Storm::Vector3 _nonPressureAcceleration;
+		Storm::Vector3 _predictedAcceleration; // Non pressure accel + pressure accel
+
+		Storm::Vector3 _predictedVelocity;
+
+		float _advectedDensity;
+		Storm::Vector3 _sumGradWij; // Sum of V_j * gradWij over all neighbors (fluids and rigid bodies).
+		float _invDiagonal; // Jacobi preconditioner (inverse of the pressure operator diagonal).
+
+		// Conjugate gradient vectors. The unknown is the pressure stiffness (pressure / density squared) as in DFSPH.
+		float _stiffness;
+		float _residual;
+		float _preconditionedResidual;
+		float _searchDirection;
+		float _operatorResult;
+		Storm::Vector3 _searchDirectionGradient;
+	};
+}
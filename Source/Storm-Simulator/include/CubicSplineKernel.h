@@ -1,5 +1,7 @@
 #pragma once
 
+#include "NeighborParticleInfo.h"
+#include "SIMDUsageMode.h"
 
 namespace Storm
 {
@@ -16,6 +18,10 @@ namespace Storm
 		static Storm::Vector3 gradient(const float k_kernelLength, const Storm::Vector3 &vectToNeighbor, const float norm);
 		static float zeroValue();
 
+		// Compute Wij and gradWij of all neighbors of a neighborhood (8 neighbors at once with AVX2, 16 with AVX512).
+		template<Storm::SIMDUsageMode simdMode>
+		static void computeNeighborhood(const float k_kernelLength, Storm::ParticleNeighborhoodBuildArray &inOutNeighborhood);
+
 	private:
 		static float s_rawPrecoeff;
 		static float s_gradientPrecoeff;
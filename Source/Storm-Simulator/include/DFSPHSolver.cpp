@@ -60,7 +60,7 @@ namespace
 #undef STORM_SOLVER_NAMES_XMACRO
 
 	template<Storm::ViscosityMethod viscosityMethodOnFluid, Storm::ViscosityMethod viscosityMethodOnRigidBody>
-	Storm::Vector3 computeViscosity(const Storm::IterationParameter &iterationParameter, const Storm::SceneFluidConfig &fluidConfig, const Storm::FluidParticleSystem &fluidParticleSystem, const float currentPMass, const Storm::Vector3 &vi, const Storm::ParticleNeighborhoodArray &currentPNeighborhood, const float currentPDensity, const float viscoPrecoeff)
+	Storm::Vector3 computeViscosity(const Storm::IterationParameter &iterationParameter, const Storm::SceneFluidConfig &fluidConfig, const Storm::FluidParticleSystem &fluidParticleSystem, const float currentPMass, const Storm::Vector3 &vi, const Storm::ParticleNeighborhoodArray &currentPNeighborhood, const float currentPDensity, const float viscoPrecoeff, Storm::RigidBodyReactionAccumulator::Chunk &rbReactions)
 	{
 		Storm::Vector3 totalViscosityForceOnParticle = Storm::Vector3::Zero();
 
@@ -135,8 +135,7 @@ namespace
 				{
 					Storm::Vector3 &boundaryNeighborTmpViscosityForce = neighbor._containingParticleSystem->getTemporaryViscosityForces()[neighbor._particleIndex];
 
-					std::lock_guard<std::mutex> lock{ neighbor._containingParticleSystem->_mutex };
-					boundaryNeighborTmpViscosityForce -= viscosityComponent;
+					rbReactions.subtract(boundaryNeighborTmpViscosityForce, viscosityComponent);
 				}
 			}
 
@@ -146,7 +145,7 @@ namespace
 		return totalViscosityForceOnParticle;
 	}
 
-	Storm::Vector3 computeBernoulliPrinciple(const Storm::FluidParticleSystem &fluidParticleSystem, const std::size_t currentPIndex, const Storm::ParticleNeighborhoodArray &currentPNeighborhood)
+	Storm::Vector3 computeBernoulliPrinciple(const Storm::FluidParticleSystem &fluidParticleSystem, const std::size_t currentPIndex, const Storm::ParticleNeighborhoodArray &currentPNeighborhood, Storm::RigidBodyReactionAccumulator::Chunk &rbReactions)
 	{
 		// Explanation :
 		// SPH computes static pressure in the fluids. But total pressure is given by the sum between static and dynamic pressure.
@@ -196,8 +195,7 @@ namespace
 				{
 					Storm::Vector3 &boundaryNeighborTmpDynamicQForce = neighbor._containingParticleSystem->getTemporaryBernoulliDynamicPressureForces()[neighbor._particleIndex];
 
-					std::lock_guard<std::mutex> lock{ neighbor._containingParticleSystem->_mutex };
-					boundaryNeighborTmpDynamicQForce -= currentDynamicPressureQComponent;
+					rbReactions.subtract(boundaryNeighborTmpDynamicQForce, currentDynamicPressureQComponent);
 				}
 			}
 #else
@@ -232,8 +230,7 @@ namespace
 				{
 					Storm::Vector3 &boundaryNeighborTmpDynamicQForce = neighbor._containingParticleSystem->getTemporaryBernoulliDynamicPressureForces()[neighbor._particleIndex];
 
-					std::lock_guard<std::mutex> lock{ neighbor._containingParticleSystem->_mutex };
-					boundaryNeighborTmpDynamicQForce += currentDynamicPressureQComponent;
+					rbReactions.add(boundaryNeighborTmpDynamicQForce, currentDynamicPressureQComponent);
 				}
 			}
 
@@ -243,7 +240,7 @@ namespace
 		return dynamicPressureForce;
 	}
 
-	Storm::Vector3 produceNoStickConditionForces(const Storm::IterationParameter &iterationParameter, const Storm::FluidParticleSystem &/*fluidParticleSystem*/, const Storm::Vector3 &vi, const float currentPMass, const Storm::ParticleNeighborhoodArray &currentPNeighborhood)
+	Storm::Vector3 produceNoStickConditionForces(const Storm::IterationParameter &iterationParameter, const Storm::FluidParticleSystem &/*fluidParticleSystem*/, const Storm::Vector3 &vi, const float currentPMass, const Storm::ParticleNeighborhoodArray &currentPNeighborhood, Storm::RigidBodyReactionAccumulator::Chunk &rbReactions)
 	{
 		Storm::Vector3 result = Storm::Vector3::Zero();
 
@@ -270,8 +267,7 @@ namespace
 					{
 						Storm::Vector3 &boundaryNeighborTmpNoStickForce = neighbor._containingParticleSystem->getTemporaryNoStickForces()[neighbor._particleIndex];
 
-						std::lock_guard<std::mutex> lock{ neighbor._containingParticleSystem->_mutex };
-						boundaryNeighborTmpNoStickForce += addedForce;
+						rbReactions.add(boundaryNeighborTmpNoStickForce, addedForce);
 					}
 				}
 			}
@@ -280,7 +276,7 @@ namespace
 		return result;
 	}
 
-	Storm::Vector3 produceCoandaForces(const Storm::IterationParameter &iterationParameter, const Storm::FluidParticleSystem &fluidParticleSystem, const Storm::Vector3 &/*vi*/, const float currentPMass, const Storm::ParticleNeighborhoodArray &currentPNeighborhood)
+	Storm::Vector3 produceCoandaForces(const Storm::IterationParameter &iterationParameter, const Storm::FluidParticleSystem &fluidParticleSystem, const Storm::Vector3 &/*vi*/, const float currentPMass, const Storm::ParticleNeighborhoodArray &currentPNeighborhood, Storm::RigidBodyReactionAccumulator::Chunk &rbReactions)
 	{
 		Storm::Vector3 result = Storm::Vector3::Zero();
 
@@ -308,8 +304,7 @@ namespace
 					{
 						Storm::Vector3 &boundaryNeighborTmpCoandaForce = neighbor._containingParticleSystem->getTemporaryCoandaForces()[neighbor._particleIndex];
 
-						std::lock_guard<std::mutex> lock{ neighbor._containingParticleSystem->_mutex };
-						boundaryNeighborTmpCoandaForce += addedForce;
+						rbReactions.add(boundaryNeighborTmpCoandaForce, addedForce);
 					}
 				}
 			}
@@ -344,6 +339,8 @@ Storm::DFSPHSolver::DFSPHSolver(const float /*k_kernelLength*/, const Storm::Par
 				currentPData._nonPressureAcceleration.setZero();
 				currentPData._kCoeff = 0.f;
 				currentPData._densityAdv = 0.f;
+				currentPData._divergenceStiffness = 0.f;
+				currentPData._densityStiffness = 0.f;
 			});
 
 			totalParticleCount += currentPSystemPCount._newSize;
@@ -362,6 +359,7 @@ Storm::DFSPHSolver::DFSPHSolver(const float /*k_kernelLength*/, const Storm::Par
 	_neighborThresholdDensity = dfsphFluidConfig._neighborThresholdDensity;
 	_useRotationFix = dfsphFluidConfig._useFixRotation;
 	_enableDensitySolve = dfsphFluidConfig._enableDensitySolve;
+	_enableWarmStart = dfsphFluidConfig._enableWarmStart;
 }
 
 Storm::DFSPHSolver::~DFSPHSolver() = default;
@@ -509,13 +507,12 @@ void Storm::DFSPHSolver::execute(const Storm::IterationParameter &iterationParam
 		const std::vector<Storm::Vector3> &tmpPressureVelocityForces = fluidParticleSystem.getTemporaryPressureVelocityIntermediaryForces();
 		const std::vector<Storm::Vector3> &velocityPreTimestep = fluidParticleSystem.getVelocityPreTimestep();
 
-		std::atomic<bool> dirtyTmp = false;
 #pragma warning (push)
 #pragma warning (disable: 4189) // It is being used, but the compiler cannot see it before it compiles for real
 		constexpr const float minForceDirtyEpsilon = 0.0001f;
 #pragma warning (push)
 
-		Storm::runParallel(dataField, [&](const Storm::DFSPHSolverData &currentPData, const std::size_t currentPIndex)
+		const Storm::ParallelReduceResult integrationResult = Storm::reduceChunkedParallel(dataField, [&](const Storm::DFSPHSolverData &currentPData, const std::size_t currentPIndex, Storm::ParallelReduceResult &chunkResult)
 		{
 			// Euler integration
 			Storm::Vector3 &currentPVelocity = velocities[currentPIndex];
@@ -528,7 +525,7 @@ void Storm::DFSPHSolver::execute(const Storm::IterationParameter &iterationParam
 			currentPVelocity = currentPData._predictedVelocity;
 			currentPPosition += currentPVelocity * iterationParameter._deltaTime;
 
-			if (!dirtyTmp)
+			if (!chunkResult._flag)
 			{
 				if (
 					std::fabs(currentPVelocity.x()) > minForceDirtyEpsilon ||
@@ -536,12 +533,12 @@ void Storm::DFSPHSolver::execute(const Storm::IterationParameter &iterationParam
 					std::fabs(currentPVelocity.z()) > minForceDirtyEpsilon
 					)
 				{
-					dirtyTmp = true;
+					chunkResult._flag = true;
 				}
 			}
 		});
 
-		fluidParticleSystem.setIsDirty(dirtyTmp);
+		fluidParticleSystem.setIsDirty(integrationResult._flag);
 	}, !sceneSimulationConfig._midUpdateViscosity);
 
 	// 11th : flush physics state (rigid bodies)
@@ -553,6 +550,23 @@ void Storm::DFSPHSolver::removeRawEndData(const unsigned int pSystemId, std::siz
 	Storm::SPHSolverUtils::removeRawEndData(pSystemId, toRemoveCount, _data);
 }
 
+void Storm::DFSPHSolver::reorderParticleData(const unsigned int pSystemId, const std::vector<std::size_t> &newToOldIndexes)
+{
+	Storm::SPHSolverUtils::reorderData(pSystemId, newToOldIndexes, _data);
+}
+
+void Storm::DFSPHSolver::compactParticleData(const unsigned int pSystemId, const Storm::ParticleCompaction &compaction)
+{
+	Storm::SPHSolverUtils::compactData(pSystemId, compaction, _data);
+	_totalParticleCountFl -= static_cast<float>(compaction.getRemovedCount());
+}
+
+void Storm::DFSPHSolver::appendRawEndData(const unsigned int pSystemId, std::size_t toAddCount)
+{
+	Storm::SPHSolverUtils::appendRawEndData(pSystemId, toAddCount, _data);
+	_totalParticleCountFl += static_cast<float>(toAddCount);
+}
+
 void Storm::DFSPHSolver::setEnableThresholdDensity(bool enable)
 {
 	_enableThresholdDensity = enable;
@@ -583,14 +597,14 @@ void Storm::DFSPHSolver::initializeStepDensities(const Storm::IterationParameter
 
 			const float particleVolume = fluidParticleSystem.getParticleVolume();
 			const float density0 = fluidParticleSystem.getRestDensity();
-			const std::vector<Storm::ParticleNeighborhoodArray> &neighborhoodArrays = fluidParticleSystem.getNeighborhoodArrays();
+			const Storm::ParticleNeighborhoodStorage &neighborhoodArrays = fluidParticleSystem.getNeighborhoodArrays();
 
 			Storm::runParallel(fluidParticleSystem.getDensities(), [&](float &currentPDensity, const std::size_t currentPIndex)
 			{
 				// Density
 				currentPDensity = particleVolume * k_kernelZero;
 
-				const Storm::ParticleNeighborhoodArray &currentPNeighborhood = neighborhoodArrays[currentPIndex];
+				const Storm::ParticleNeighborhoodArray currentPNeighborhood = neighborhoodArrays[currentPIndex];
 				for (const Storm::NeighborParticleInfo &neighbor : currentPNeighborhood)
 				{
 					float deltaDensity;
@@ -624,7 +638,7 @@ void Storm::DFSPHSolver::initializeStepDensities(const Storm::IterationParameter
 			{
 				Storm::FluidParticleSystem &fluidPSystem = static_cast<Storm::FluidParticleSystem &>(currentParticleSystem);
 
-				const std::vector<Storm::ParticleNeighborhoodArray> &neighborhoodArrays = fluidPSystem.getNeighborhoodArrays();
+				const Storm::ParticleNeighborhoodStorage &neighborhoodArrays = fluidPSystem.getNeighborhoodArrays();
 				const std::vector<Storm::Vector3> &velocities = fluidPSystem.getVelocity();
 				const std::vector<float> &densities = fluidPSystem.getDensities();
 
@@ -633,7 +647,7 @@ void Storm::DFSPHSolver::initializeStepDensities(const Storm::IterationParameter
 				// In other words, we consider reflected particle, aka out of domain particle, to have no velocity.
 				Storm::runParallel(fluidPSystem.getPressures(), [this, &neighborhoodArrays, &velocities, &densities, density0 = fluidPSystem.getRestDensity(), k_velocityInCasePReflected = Storm::Vector3::Zero()](float &currentPQ, const std::size_t currentPIndex)
 				{
-					const Storm::ParticleNeighborhoodArray &currentPNeighborhood = neighborhoodArrays[currentPIndex];
+					const Storm::ParticleNeighborhoodArray currentPNeighborhood = neighborhoodArrays[currentPIndex];
 #if false
 					const Storm::Vector3 &vi = velocities[currentPIndex];
 					currentPQ = vi.squaredNorm() / 2.f * densities[currentPIndex];
@@ -747,7 +761,7 @@ void Storm::DFSPHSolver::computeNonPressureForces_Internal(const Storm::Iteratio
 		{
 			Storm::FluidParticleSystem &fluidParticleSystem = static_cast<Storm::FluidParticleSystem &>(currentParticleSystem);
 			
-			const std::vector<Storm::ParticleNeighborhoodArray> &neighborhoodArrays = currentParticleSystem.getNeighborhoodArrays();
+			const Storm::ParticleNeighborhoodStorage &neighborhoodArrays = currentParticleSystem.getNeighborhoodArrays();
 			std::vector<float> &masses = fluidParticleSystem.getMasses();
 			const std::vector<float> &densities = fluidParticleSystem.getDensities();
 			std::vector<Storm::Vector3> &temporaryPViscoForces = fluidParticleSystem.getTemporaryViscosityForces();
@@ -758,7 +772,7 @@ void Storm::DFSPHSolver::computeNonPressureForces_Internal(const Storm::Iteratio
 
 			Storm::DFSPHSolver::DFSPHSolverDataArray &dataField = _data.find(particleSystemPair.first)->second;
 
-			Storm::runParallel(fluidParticleSystem.getForces(), [&](Storm::Vector3 &currentPForce, const std::size_t currentPIndex)
+			_rbReactionAccumulator.runParallel(fluidParticleSystem.getForces(), [&](Storm::Vector3 &currentPForce, const std::size_t currentPIndex, Storm::RigidBodyReactionAccumulator::Chunk &rbReactions)
 			{
 				const float currentPMass = masses[currentPIndex];
 				const Storm::Vector3 &vi = velocities[currentPIndex];
@@ -766,10 +780,11 @@ void Storm::DFSPHSolver::computeNonPressureForces_Internal(const Storm::Iteratio
 				Storm::Vector3 &currentPTmpViscoForce = temporaryPViscoForces[currentPIndex];
 
 				const float currentPDensity = densities[currentPIndex];
-				const Storm::ParticleNeighborhoodArray &currentPNeighborhood = neighborhoodArrays[currentPIndex];
+				// Sleeping particles are frozen, their non pressure forces are null.
+				const Storm::ParticleNeighborhoodArray currentPNeighborhood = fluidParticleSystem.isParticleSleeping(currentPIndex) ? neighborhoodArrays.getEmptyNeighborhood(currentPIndex) : neighborhoodArrays[currentPIndex];
 
 #define STORM_COMPUTE_VISCOSITY(fluidMethod, rbMethod) \
-	computeViscosity<fluidMethod, rbMethod>(iterationParameter, fluidConfig, fluidParticleSystem, currentPMass, vi, currentPNeighborhood, currentPDensity, viscoPrecoeff)
+	computeViscosity<fluidMethod, rbMethod>(iterationParameter, fluidConfig, fluidParticleSystem, currentPMass, vi, currentPNeighborhood, currentPDensity, viscoPrecoeff, rbReactions)
 
 				switch (sceneSimulationConfig._fluidViscoMethod)
 				{
@@ -816,11 +831,11 @@ void Storm::DFSPHSolver::computeNonPressureForces_Internal(const Storm::Iteratio
 
 					if (fluidConfig._uniformDragCoefficient > 0.f)
 					{
-						currentPTmpDragForceComponent = Storm::SPHSolverUtils::computeSumDragForce<true>(iterationParameter, fluidConfig._uniformDragCoefficient, fluidParticleSystem, vi, currentPNeighborhood, currentPDensity);
+						currentPTmpDragForceComponent = Storm::SPHSolverUtils::computeSumDragForce<true>(iterationParameter, fluidConfig._uniformDragCoefficient, fluidParticleSystem, vi, currentPNeighborhood, currentPDensity, rbReactions);
 					}
 					else
 					{
-						currentPTmpDragForceComponent = Storm::SPHSolverUtils::computeSumDragForce<false>(iterationParameter, fluidConfig._uniformDragCoefficient, fluidParticleSystem, vi, currentPNeighborhood, currentPDensity);
+						currentPTmpDragForceComponent = Storm::SPHSolverUtils::computeSumDragForce<false>(iterationParameter, fluidConfig._uniformDragCoefficient, fluidParticleSystem, vi, currentPNeighborhood, currentPDensity, rbReactions);
 					}
 
 					currentPForce += currentPTmpDragForceComponent;
@@ -829,21 +844,21 @@ void Storm::DFSPHSolver::computeNonPressureForces_Internal(const Storm::Iteratio
 				if (dfsphFluidConfig._useBernoulliPrinciple)
 				{
 					Storm::Vector3 &dynamicPressureForce = fluidParticleSystem.getTemporaryBernoulliDynamicPressureForces()[currentPIndex];
-					dynamicPressureForce = computeBernoulliPrinciple(fluidParticleSystem, currentPIndex, currentPNeighborhood);
+					dynamicPressureForce = computeBernoulliPrinciple(fluidParticleSystem, currentPIndex, currentPNeighborhood, rbReactions);
 					currentPForce += dynamicPressureForce;
 				}
 
 				if (sceneSimulationConfig._noStickConstraint)
 				{
 					Storm::Vector3 &currentPTmpNoStickForce = fluidParticleSystem.getTemporaryNoStickForces()[currentPIndex];
-					currentPTmpNoStickForce = produceNoStickConditionForces(iterationParameter, fluidParticleSystem, vi, currentPMass, currentPNeighborhood);
+					currentPTmpNoStickForce = produceNoStickConditionForces(iterationParameter, fluidParticleSystem, vi, currentPMass, currentPNeighborhood, rbReactions);
 					currentPForce += currentPTmpNoStickForce;
 				}
 
 				if (sceneSimulationConfig._useCoandaEffect)
 				{
 					Storm::Vector3 &currentPTmpCoandaForce = fluidParticleSystem.getTemporaryCoandaForces()[currentPIndex];
-					currentPTmpCoandaForce = produceCoandaForces(iterationParameter, fluidParticleSystem, vi, currentPMass, currentPNeighborhood);
+					currentPTmpCoandaForce = produceCoandaForces(iterationParameter, fluidParticleSystem, vi, currentPMass, currentPNeighborhood, rbReactions);
 					currentPForce += currentPTmpCoandaForce;
 				}
 
@@ -866,6 +881,183 @@ void Storm::DFSPHSolver::computeNonPressureForces_Internal(const Storm::Iteratio
 	}
 }
 
+void Storm::DFSPHSolver::warmStartDivergenceSolve(const Storm::IterationParameter &iterationParameter)
+{
+	Storm::ParticleSystemContainer &particleSystems = *iterationParameter._particleSystems;
+
+	const float invertDeltaTime = 1.f / iterationParameter._deltaTime;
+
+	//////////////////////////////////////////////////////////////////////////
+	// Restore the time step inside the stiffness the last divergence solve ended with (see Storm::DFSPHSolverData::computeWarmStartStiffness).
+	//////////////////////////////////////////////////////////////////////////
+	for (auto &dataFieldPair : _data)
+	{
+		Storm::runParallel(dataFieldPair.second, [invertDeltaTime](Storm::DFSPHSolverData &currentPData)
+		{
+			currentPData._divergenceStiffness = Storm::DFSPHSolverData::computeWarmStartStiffness(currentPData._divergenceStiffness, invertDeltaTime);
+		});
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Apply it (same as one Jacobi iteration, but with the stored stiffness)
+	//////////////////////////////////////////////////////////////////////////
+	for (auto &dataFieldPair : _data)
+	{
+		// Since data field was made from fluid particles, no need to check.
+		Storm::FluidParticleSystem &fluidPSystem = static_cast<Storm::FluidParticleSystem &>(*particleSystems.find(dataFieldPair.first)->second);
+
+		const std::vector<float> &masses = fluidPSystem.getMasses();
+		const Storm::ParticleNeighborhoodStorage &neighborhoodArrays = fluidPSystem.getNeighborhoodArrays();
+		std::vector<Storm::Vector3> &intermediaryPressureForces = fluidPSystem.getTemporaryPressureDensityIntermediaryForces();
+
+		const float density0 = fluidPSystem.getRestDensity();
+
+		_rbReactionAccumulator.runParallel(dataFieldPair.second, [&](Storm::DFSPHSolverData &currentPData, const std::size_t currentPIndex, Storm::RigidBodyReactionAccumulator::Chunk &rbReactions)
+		{
+			const float ki = currentPData._divergenceStiffness;
+			const bool computePressureForBoundary = std::fabs(ki) > Storm::SPHSolverPrivateLogic::k_epsilon;
+
+			const float deltaVToForce = masses[currentPIndex] * invertDeltaTime;
+
+			Storm::Vector3 &vi = currentPData._predictedVelocity;
+			Storm::Vector3 &currentPIntermediaryForce = intermediaryPressureForces[currentPIndex];
+
+			const Storm::DFSPHSolver::DFSPHSolverDataArray* neighborDataArray = &dataFieldPair.second;
+			const Storm::FluidParticleSystem* lastNeighborFluidSystem = &fluidPSystem;
+
+			const Storm::ParticleNeighborhoodArray currentPNeighborhood = neighborhoodArrays[currentPIndex];
+			for (const Storm::NeighborParticleInfo &neighbor : currentPNeighborhood)
+			{
+				if (neighbor._isFluidParticle)
+				{
+					if (neighbor._containingParticleSystem != lastNeighborFluidSystem)
+					{
+						lastNeighborFluidSystem = static_cast<const Storm::FluidParticleSystem*>(neighbor._containingParticleSystem);
+						neighborDataArray = &_data.find(lastNeighborFluidSystem->getId())->second;
+					}
+
+					// The stored stiffness of a neighbor reflected from the other side of the domain isn't taken, only the particle own stiffness applies (same as warmStartPressureSolve).
+					const float kj = neighbor._notReflected ? (*neighborDataArray)[neighbor._particleIndex]._divergenceStiffness : 0.f;
+
+					const float kSum = ki + lastNeighborFluidSystem->getRestDensity() / density0 * kj;
+					if (std::fabs(kSum) > Storm::SPHSolverPrivateLogic::k_epsilon)
+					{
+						const Storm::Vector3 velChange = (iterationParameter._deltaTime * kSum * lastNeighborFluidSystem->getParticleVolume()) * neighbor._gradWij;
+						vi += velChange;
+
+						currentPIntermediaryForce += deltaVToForce * velChange;
+					}
+				}
+				else if (computePressureForBoundary)
+				{
+					Storm::RigidBodyParticleSystem* neighborPSystemAsBoundary = static_cast<Storm::RigidBodyParticleSystem*>(neighbor._containingParticleSystem);
+
+					const Storm::Vector3 velChange = (iterationParameter._deltaTime * ki * neighborPSystemAsBoundary->getVolumes()[neighbor._particleIndex]) * neighbor._gradWij;
+					vi += velChange;
+
+					const Storm::Vector3 addedPressureForce = deltaVToForce * velChange;
+					currentPIntermediaryForce += addedPressureForce;
+
+					if (!neighborPSystemAsBoundary->isStatic())
+					{
+						rbReactions.subtract(neighborPSystemAsBoundary->getTemporaryPressureForces()[neighbor._particleIndex], addedPressureForce);
+						rbReactions.subtract(neighborPSystemAsBoundary->getTemporaryPressureDensityIntermediaryForces()[neighbor._particleIndex], addedPressureForce);
+					}
+				}
+			}
+		});
+	}
+}
+
+void Storm::DFSPHSolver::warmStartPressureSolve(const Storm::IterationParameter &iterationParameter)
+{
+	Storm::ParticleSystemContainer &particleSystems = *iterationParameter._particleSystems;
+
+	const float invDeltaTime = 1.f / iterationParameter._deltaTime;
+	const float invDeltaTimeSquared = invDeltaTime * invDeltaTime;
+
+	//////////////////////////////////////////////////////////////////////////
+	// Restore the time step inside the stiffness the last pressure solve ended with (see Storm::DFSPHSolverData::computeWarmStartStiffness).
+	//////////////////////////////////////////////////////////////////////////
+	for (auto &dataFieldPair : _data)
+	{
+		Storm::runParallel(dataFieldPair.second, [invDeltaTimeSquared](Storm::DFSPHSolverData &currentPData)
+		{
+			currentPData._densityStiffness = Storm::DFSPHSolverData::computeWarmStartStiffness(currentPData._densityStiffness, invDeltaTimeSquared);
+		});
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Apply it (same as one Jacobi iteration, but with the stored stiffness)
+	//////////////////////////////////////////////////////////////////////////
+	for (auto &dataFieldPair : _data)
+	{
+		// Since data field was made from fluid particles, no need to check.
+		Storm::FluidParticleSystem &fluidPSystem = static_cast<Storm::FluidParticleSystem &>(*particleSystems.find(dataFieldPair.first)->second);
+
+		const std::vector<float> &masses = fluidPSystem.getMasses();
+		const Storm::ParticleNeighborhoodStorage &neighborhoodArrays = fluidPSystem.getNeighborhoodArrays();
+		std::vector<Storm::Vector3> &temporaryVelocityPressureForces = fluidPSystem.getTemporaryPressureVelocityIntermediaryForces();
+
+		const float density0 = fluidPSystem.getRestDensity();
+
+		_rbReactionAccumulator.runParallel(dataFieldPair.second, [&](Storm::DFSPHSolverData &currentPData, const std::size_t currentPIndex, Storm::RigidBodyReactionAccumulator::Chunk &rbReactions)
+		{
+			const float ki = currentPData._densityStiffness;
+			const bool computePressureForBoundary = std::fabs(ki) > Storm::SPHSolverPrivateLogic::k_epsilon;
+
+			const float deltaVToForce = masses[currentPIndex] * invDeltaTime;
+
+			Storm::Vector3 &vi = currentPData._predictedVelocity;
+			Storm::Vector3 &currentPTemporaryVelocityPressureForce = temporaryVelocityPressureForces[currentPIndex];
+
+			const Storm::DFSPHSolver::DFSPHSolverDataArray* neighborDataArray = &dataFieldPair.second;
+			const Storm::FluidParticleSystem* lastNeighborFluidSystem = &fluidPSystem;
+
+			const Storm::ParticleNeighborhoodArray currentPNeighborhood = neighborhoodArrays[currentPIndex];
+			for (const Storm::NeighborParticleInfo &neighbor : currentPNeighborhood)
+			{
+				if (neighbor._isFluidParticle)
+				{
+					if (neighbor._containingParticleSystem != lastNeighborFluidSystem)
+					{
+						lastNeighborFluidSystem = static_cast<const Storm::FluidParticleSystem*>(neighbor._containingParticleSystem);
+						neighborDataArray = &_data.find(lastNeighborFluidSystem->getId())->second;
+					}
+
+					// The stored stiffness of a neighbor reflected from the other side of the domain isn't taken, only the particle own stiffness applies (same as warmStartDivergenceSolve).
+					const float kj = neighbor._notReflected ? (*neighborDataArray)[neighbor._particleIndex]._densityStiffness : 0.f;
+
+					const float kSum = ki + lastNeighborFluidSystem->getRestDensity() / density0 * kj;
+					if (std::fabs(kSum) > Storm::SPHSolverPrivateLogic::k_epsilon)
+					{
+						const Storm::Vector3 velChange = (iterationParameter._deltaTime * kSum * lastNeighborFluidSystem->getParticleVolume()) * neighbor._gradWij;
+						vi += velChange;
+
+						currentPTemporaryVelocityPressureForce -= deltaVToForce * velChange;
+					}
+				}
+				else if (computePressureForBoundary)
+				{
+					Storm::RigidBodyParticleSystem* neighborPSystemAsBoundary = static_cast<Storm::RigidBodyParticleSystem*>(neighbor._containingParticleSystem);
+
+					const Storm::Vector3 velChange = (iterationParameter._deltaTime * ki * neighborPSystemAsBoundary->getVolumes()[neighbor._particleIndex]) * neighbor._gradWij;
+					vi += velChange;
+
+					const Storm::Vector3 addedPressureForce = deltaVToForce * velChange;
+					currentPTemporaryVelocityPressureForce += addedPressureForce;
+
+					if (!neighborPSystemAsBoundary->isStatic())
+					{
+						rbReactions.subtract(neighborPSystemAsBoundary->getTemporaryPressureForces()[neighbor._particleIndex], addedPressureForce);
+						rbReactions.subtract(neighborPSystemAsBoundary->getTemporaryPressureVelocityIntermediaryForces()[neighbor._particleIndex], addedPressureForce);
+					}
+				}
+			}
+		});
+	}
+}
+
 void Storm::DFSPHSolver::divergenceSolve(const Storm::IterationParameter &iterationParameter, const Storm::SceneFluidCustomDFSPHConfig &sceneDFSPHSimulationConfig, unsigned int &outIteration, float &outAverageError)
 {
 	Storm::ParticleSystemContainer &particleSystems = *iterationParameter._particleSystems;
@@ -880,6 +1072,12 @@ void Storm::DFSPHSolver::divergenceSolve(const Storm::IterationParameter &iterat
 	const unsigned int maxIter = sceneDFSPHSimulationConfig._maxPredictIteration;
 	const float etaCoeff = invertDeltaTime * sceneDFSPHSimulationConfig._maxDensityError * 0.01f;
 
+	const bool enableWarmStart = _enableWarmStart;
+	if (enableWarmStart)
+	{
+		this->warmStartDivergenceSolve(iterationParameter);
+	}
+
 	//////////////////////////////////////////////////////////////////////////
 	// Compute velocity of density change
 	//////////////////////////////////////////////////////////////////////////
@@ -908,20 +1106,18 @@ void Storm::DFSPHSolver::divergenceSolve(const Storm::IterationParameter &iterat
 
 		chk = true;
 
-		std::atomic<float> avgDensityErrAtom;
 		for (auto &dataFieldPair : _data)
 		{
 			// Since data field was made from fluid particles, no need to check.
 			Storm::FluidParticleSystem &fluidPSystem = static_cast<Storm::FluidParticleSystem &>(*particleSystems.find(dataFieldPair.first)->second);
 			
 			const std::vector<float> &masses = fluidPSystem.getMasses();
-			const std::vector<Storm::ParticleNeighborhoodArray> &neighborhoodArrays = fluidPSystem.getNeighborhoodArrays();
+			const Storm::ParticleNeighborhoodStorage &neighborhoodArrays = fluidPSystem.getNeighborhoodArrays();
 			std::vector<Storm::Vector3> &intermediaryPressureForces = fluidPSystem.getTemporaryPressureDensityIntermediaryForces();
 
 			const float density0 = fluidPSystem.getRestDensity();
-			avgDensityErrAtom = 0.f;
 
-			auto lambda = [&]<bool computePressureForBoundary>(Storm::DFSPHSolverData &currentPData, const std::size_t currentPIndex, const float ki)
+			auto lambda = [&]<bool computePressureForBoundary>(Storm::DFSPHSolverData &currentPData, const std::size_t currentPIndex, const float ki, Storm::RigidBodyReactionAccumulator::Chunk &rbReactions)
 			{
 				const float currentPMass = masses[currentPIndex];
 				Storm::Vector3 &currentPIntermediaryForce = intermediaryPressureForces[currentPIndex];
@@ -936,7 +1132,7 @@ void Storm::DFSPHSolver::divergenceSolve(const Storm::IterationParameter &iterat
 				//////////////////////////////////////////////////////////////////////////
 				// Perform Jacobi iteration over all blocks
 				//////////////////////////////////////////////////////////////////////////	
-				const Storm::ParticleNeighborhoodArray &currentPNeighborhood = neighborhoodArrays[currentPIndex];
+				const Storm::ParticleNeighborhoodArray currentPNeighborhood = neighborhoodArrays[currentPIndex];
 				for (const Storm::NeighborParticleInfo &neighbor : currentPNeighborhood)
 				{
 					if (neighbor._isFluidParticle)
@@ -979,16 +1175,15 @@ void Storm::DFSPHSolver::divergenceSolve(const Storm::IterationParameter &iterat
 							Storm::Vector3 &tmpPressureForce = neighborPSystemAsBoundary->getTemporaryPressureForces()[neighbor._particleIndex];
 							Storm::Vector3 &tmpPressureIntermediaryForce = neighborPSystemAsBoundary->getTemporaryPressureDensityIntermediaryForces()[neighbor._particleIndex];
 
-							std::lock_guard<std::mutex> lock{ neighbor._containingParticleSystem->_mutex };
-							tmpPressureForce -= addedPressureForce;
-							tmpPressureIntermediaryForce -= addedPressureForce;
+							rbReactions.subtract(tmpPressureForce, addedPressureForce);
+							rbReactions.subtract(tmpPressureIntermediaryForce, addedPressureForce);
 						}
 #endif
 					}
 				}
 			};
 
-			Storm::runParallel(dataFieldPair.second, [&lambda](Storm::DFSPHSolverData &currentPData, const std::size_t currentPIndex)
+			_rbReactionAccumulator.runParallel(dataFieldPair.second, [&lambda, enableWarmStart](Storm::DFSPHSolverData &currentPData, const std::size_t currentPIndex, Storm::RigidBodyReactionAccumulator::Chunk &rbReactions)
 			{
 				//////////////////////////////////////////////////////////////////////////
 				// Evaluate rhs
@@ -996,42 +1191,48 @@ void Storm::DFSPHSolver::divergenceSolve(const Storm::IterationParameter &iterat
 				const float b_i = currentPData._densityAdv;
 				const float ki = b_i * currentPData._kCoeff;
 
+				if (enableWarmStart)
+				{
+					currentPData._divergenceStiffness += ki;
+				}
+
 				if (std::fabs(ki) > Storm::SPHSolverPrivateLogic::k_epsilon)
 				{
-					lambda.template operator()<true>(currentPData, currentPIndex, ki);
+					lambda.template operator()<true>(currentPData, currentPIndex, ki, rbReactions);
 				}
 				else
 				{
-					lambda.template operator()<false>(currentPData, currentPIndex, ki);
+					lambda.template operator()<false>(currentPData, currentPIndex, ki, rbReactions);
 				}
 			});
 
 			//////////////////////////////////////////////////////////////////////////
 			// Update rho_adv and density error
 			//////////////////////////////////////////////////////////////////////////
-			Storm::runParallel(dataFieldPair.second, [&](Storm::DFSPHSolverData &currentPData, const std::size_t currentPIndex)
+			const Storm::ParallelReduceResult densityChangeResult = Storm::reduceChunkedParallel(dataFieldPair.second, [&](Storm::DFSPHSolverData &currentPData, const std::size_t currentPIndex, Storm::ParallelReduceResult &chunkResult)
 			{
 				this->computeDensityChange(iterationParameter, fluidPSystem, &dataFieldPair.second, currentPData, currentPIndex);
-				avgDensityErrAtom += density0 * (currentPData._densityAdv);
+				chunkResult._sum += density0 * (currentPData._densityAdv);
 			});
 
-			avgDensityErrAtom = avgDensityErrAtom / _totalParticleCountFl;
+			const float avgDensityErr = densityChangeResult._sum / _totalParticleCountFl;
 
 			// Maximal allowed density fluctuation
 			// use maximal density error divided by time step size
 			const float eta = etaCoeff * density0;  // maxError is given in percent
-			chk = chk && (avgDensityErrAtom <= eta);
+			chk = chk && (avgDensityErr <= eta);
 
-			outAverageError += avgDensityErrAtom;
+			outAverageError += avgDensityErr;
 		}
 
 		outAverageError /= _totalParticleCountFl;
 
 		++outIteration;
 
+		// Break instead of returning : the time step must still be removed from the stiffness below, otherwise the next warm start would restore it a second time.
 		if (!this->shouldContinue()) STORM_UNLIKELY
 		{
-			return;
+			break;
 		}
 
 	} while ((!chk || (outIteration < minIter)) && (outIteration < maxIter));
@@ -1048,6 +1249,7 @@ void Storm::DFSPHSolver::divergenceSolve(const Storm::IterationParameter &iterat
 		Storm::runParallel(dataFieldPair.second, [&iterationParameter](Storm::DFSPHSolverData &currentPData)
 		{
 			currentPData._kCoeff *= iterationParameter._deltaTime;
+			currentPData._divergenceStiffness *= iterationParameter._deltaTime;
 		});
 	}
 }
@@ -1064,6 +1266,11 @@ void Storm::DFSPHSolver::pressureSolve(const Storm::IterationParameter &iteratio
 	const float invDeltaTime = 1.f / iterationParameter._deltaTime;
 	const float invDeltaTimeSquared = 1.f / deltaTimeSquared;
 
+	const bool enableWarmStart = _enableWarmStart;
+	if (enableWarmStart)
+	{
+		this->warmStartPressureSolve(iterationParameter);
+	}
 
 	//////////////////////////////////////////////////////////////////////////
 	// Compute rho_adv
@@ -1101,10 +1308,10 @@ void Storm::DFSPHSolver::pressureSolve(const Storm::IterationParameter &iteratio
 			const float density0 = fluidPSystem.getRestDensity();
 
 			const std::vector<float> &masses = fluidPSystem.getMasses();
-			const std::vector<Storm::ParticleNeighborhoodArray> &neighborhoodArrays = fluidPSystem.getNeighborhoodArrays();
+			const Storm::ParticleNeighborhoodStorage &neighborhoodArrays = fluidPSystem.getNeighborhoodArrays();
 			std::vector<Storm::Vector3> &temporaryVelocityPressureForces = fluidPSystem.getTemporaryPressureVelocityIntermediaryForces();
 			
-			auto lambda = [&]<bool computePressureForBoundary>(Storm::DFSPHSolverData & currentPData, const std::size_t currentPIndex, const float ki)
+			auto lambda = [&]<bool computePressureForBoundary>(Storm::DFSPHSolverData & currentPData, const std::size_t currentPIndex, const float ki, Storm::RigidBodyReactionAccumulator::Chunk &rbReactions)
 			{
 				const float currentPMass = masses[currentPIndex];
 				Storm::Vector3 &vi = currentPData._predictedVelocity;
@@ -1113,7 +1320,7 @@ void Storm::DFSPHSolver::pressureSolve(const Storm::IterationParameter &iteratio
 				const Storm::DFSPHSolver::DFSPHSolverDataArray* neighborDataArray = &dataFieldPair.second;
 				const Storm::FluidParticleSystem* lastNeighborFluidSystem = &fluidPSystem;
 
-				const Storm::ParticleNeighborhoodArray &currentPNeighborhood = neighborhoodArrays[currentPIndex];
+				const Storm::ParticleNeighborhoodArray currentPNeighborhood = neighborhoodArrays[currentPIndex];
 				for (const Storm::NeighborParticleInfo &neighbor : currentPNeighborhood)
 				{
 					if (neighbor._isFluidParticle)
@@ -1157,9 +1364,8 @@ void Storm::DFSPHSolver::pressureSolve(const Storm::IterationParameter &iteratio
 							Storm::Vector3 &tmpPressureForce = neighborPSystemAsBoundary->getTemporaryPressureForces()[neighbor._particleIndex];
 							Storm::Vector3 &tmpIntermediaryPressureVelocityForce = neighborPSystemAsBoundary->getTemporaryPressureVelocityIntermediaryForces()[neighbor._particleIndex];
 
-							std::lock_guard<std::mutex> lock{ neighbor._containingParticleSystem->_mutex };
-							tmpPressureForce -= addedPressureForce;
-							tmpIntermediaryPressureVelocityForce -= addedPressureForce;
+							rbReactions.subtract(tmpPressureForce, addedPressureForce);
+							rbReactions.subtract(tmpIntermediaryPressureVelocityForce, addedPressureForce);
 						}
 #endif
 					}
@@ -1169,7 +1375,7 @@ void Storm::DFSPHSolver::pressureSolve(const Storm::IterationParameter &iteratio
 			//////////////////////////////////////////////////////////////////////////
 			// Compute pressure forces
 			//////////////////////////////////////////////////////////////////////////
-			Storm::runParallel(dataFieldPair.second, [&lambda](Storm::DFSPHSolverData &currentPData, const std::size_t currentPIndex)
+			_rbReactionAccumulator.runParallel(dataFieldPair.second, [&lambda, enableWarmStart](Storm::DFSPHSolverData &currentPData, const std::size_t currentPIndex, Storm::RigidBodyReactionAccumulator::Chunk &rbReactions)
 			{
 				//////////////////////////////////////////////////////////////////////////
 				// Evaluate rhs
@@ -1177,28 +1383,31 @@ void Storm::DFSPHSolver::pressureSolve(const Storm::IterationParameter &iteratio
 				const float b_i = currentPData._densityAdv - 1.f;
 				const float ki = b_i * currentPData._kCoeff;
 
+				if (enableWarmStart)
+				{
+					currentPData._densityStiffness += ki;
+				}
+
 				if (std::fabs(ki) > Storm::SPHSolverPrivateLogic::k_epsilon)
 				{
-					lambda.template operator()<true>(currentPData, currentPIndex, ki);
+					lambda.template operator()<true>(currentPData, currentPIndex, ki, rbReactions);
 				}
 				else
 				{
-					lambda.template operator()<false>(currentPData, currentPIndex, ki);
+					lambda.template operator()<false>(currentPData, currentPIndex, ki, rbReactions);
 				}
 			});
 
-			std::atomic<float> densityError = 0.f;
-
 			//////////////////////////////////////////////////////////////////////////
 			// Update rho_adv and density error
 			//////////////////////////////////////////////////////////////////////////
-			Storm::runParallel(dataFieldPair.second, [&](Storm::DFSPHSolverData &currentPData, const std::size_t currentPIndex)
+			const Storm::ParallelReduceResult densityErrorResult = Storm::reduceChunkedParallel(dataFieldPair.second, [&](Storm::DFSPHSolverData &currentPData, const std::size_t currentPIndex, Storm::ParallelReduceResult &chunkResult)
 			{
 				this->computeDensityAdv(iterationParameter, fluidPSystem, &dataFieldPair.second, currentPData, currentPIndex);
-				densityError += density0 * currentPData._densityAdv - density0;
+				chunkResult._sum += density0 * currentPData._densityAdv - density0;
 			});
 
-			outAverageError = densityError / _totalParticleCountFl;
+			outAverageError = densityErrorResult._sum / _totalParticleCountFl;
 
 			// Maximal allowed density fluctuation
 			const float eta = etaCoeff * density0;  // maxError is given in percent
@@ -1207,11 +1416,24 @@ void Storm::DFSPHSolver::pressureSolve(const Storm::IterationParameter &iteratio
 
 		++outIteration;
 
+		// Same as the divergence solve, the time step must still be removed from the stiffness below.
 		if (!this->shouldContinue()) STORM_UNLIKELY
 		{
-			return;
+			break;
 		}
 	} while ((!chk || (outIteration < minIter)) && (outIteration < maxIter));
+
+	if (enableWarmStart)
+	{
+		// Like the divergence solve, remove the time step from the stiffness so it stays valid for the next step.
+		for (auto &dataFieldPair : _data)
+		{
+			Storm::runParallel(dataFieldPair.second, [deltaTimeSquared](Storm::DFSPHSolverData &currentPData)
+			{
+				currentPData._densityStiffness *= deltaTimeSquared;
+			});
+		}
+	}
 }
 
 void Storm::DFSPHSolver::computeDFSPHFactor(const Storm::IterationParameter &iterationParameter, Storm::FluidParticleSystem &fluidPSystem, Storm::DFSPHSolver::DFSPHSolverDataArray &pSystemData, const double kMultiplicationCoeff)
@@ -1220,14 +1442,14 @@ void Storm::DFSPHSolver::computeDFSPHFactor(const Storm::IterationParameter &ite
 	// Init parameters
 	//////////////////////////////////////////////////////////////////////////
 
-	const std::vector<Storm::ParticleNeighborhoodArray> &neighborhoodArrays = fluidPSystem.getNeighborhoodArrays();
+	const Storm::ParticleNeighborhoodStorage &neighborhoodArrays = fluidPSystem.getNeighborhoodArrays();
 
 	//////////////////////////////////////////////////////////////////////////
 	// Compute pressure stiffness denominator
 	//////////////////////////////////////////////////////////////////////////
 	Storm::runParallel(pSystemData, [&iterationParameter, &neighborhoodArrays, kMultiplicationCoeff](Storm::DFSPHSolverData &currentPData, const std::size_t currentPIndex)
 	{
-		const Storm::ParticleNeighborhoodArray &currentPNeighborhood = neighborhoodArrays[currentPIndex];
+		const Storm::ParticleNeighborhoodArray currentPNeighborhood = neighborhoodArrays[currentPIndex];
 
 		//////////////////////////////////////////////////////////////////////////
 		// Compute gradient dp_i/dx_j * (1/k)  and dp_j/dx_j * (1/k)
@@ -1275,7 +1497,7 @@ void Storm::DFSPHSolver::computeDensityAdv(const Storm::IterationParameter &iter
 
 	const float density0 = fluidPSystem.getRestDensity();
 
-	const Storm::ParticleNeighborhoodArray &currentPNeighborhood = fluidPSystem.getNeighborhoodArrays()[currentPIndex];
+	const Storm::ParticleNeighborhoodArray currentPNeighborhood = fluidPSystem.getNeighborhoodArrays()[currentPIndex];
 
 	const Storm::Vector3 &vi = currentPData._predictedVelocity;
 
@@ -1316,7 +1538,7 @@ void Storm::DFSPHSolver::computeDensityAdv(const Storm::IterationParameter &iter
 
 void Storm::DFSPHSolver::computeDensityChange(const Storm::IterationParameter &/*iterationParameter*/, Storm::FluidParticleSystem &fluidPSystem, const Storm::DFSPHSolver::DFSPHSolverDataArray* currentSystemData, Storm::DFSPHSolverData &currentPData, const std::size_t currentPIndex)
 {
-	const Storm::ParticleNeighborhoodArray &currentPNeighborhood = fluidPSystem.getNeighborhoodArrays()[currentPIndex];
+	const Storm::ParticleNeighborhoodArray currentPNeighborhood = fluidPSystem.getNeighborhoodArrays()[currentPIndex];
 	
 	float &densityAdv = currentPData._densityAdv;
 	densityAdv = 0.f;
@@ -27,6 +27,9 @@ namespace Storm
 	public:
 		void execute(const Storm::IterationParameter &iterationParameter) final override;
 		void removeRawEndData(const unsigned int pSystemId, std::size_t toRemoveCount) final override;
+		void reorderParticleData(const unsigned int pSystemId, const std::vector<std::size_t> &newToOldIndexes) final override;
+		void compactParticleData(const unsigned int pSystemId, const Storm::ParticleCompaction &compaction) final override;
+		void appendRawEndData(const unsigned int pSystemId, std::size_t toAddCount) final override;
 
 	public:
 		void setEnableThresholdDensity(bool enable);
@@ -40,6 +43,8 @@ namespace Storm
 		void computeNonPressureForces_Internal(const Storm::IterationParameter &iterationParameter, const Storm::SceneSimulationConfig &sceneSimulationConfig, const Storm::SceneFluidConfig &fluidConfig);
 
 	private:
+		void warmStartDivergenceSolve(const Storm::IterationParameter &iterationParameter);
+		void warmStartPressureSolve(const Storm::IterationParameter &iterationParameter);
 		void divergenceSolve(const Storm::IterationParameter &iterationParameter, const Storm::SceneFluidCustomDFSPHConfig &sceneDFSPHSimulationConfig, unsigned int &outIteration, float &outAverageError);
 		void pressureSolve(const Storm::IterationParameter &iterationParameter, const Storm::SceneFluidCustomDFSPHConfig &sceneDFSPHSimulationConfig, unsigned int &outIteration, float &outAverageError);
 		void computeDFSPHFactor(const Storm::IterationParameter &iterationParameter, Storm::FluidParticleSystem &fluidPSystem, Storm::DFSPHSolver::DFSPHSolverDataArray &pSystemData, const double kMultiplicationCoeff);
@@ -50,6 +55,7 @@ namespace Storm
 		std::map<unsigned int, Storm::DFSPHSolver::DFSPHSolverDataArray> _data;
 		float _totalParticleCountFl;
 		bool _enableDensitySolve;
+		bool _enableWarmStart;
 		bool _enableThresholdDensity;
 		bool _useRotationFix;
 		std::size_t _neighborThresholdDensity;
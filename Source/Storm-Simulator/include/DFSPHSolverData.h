@@ -5,6 +5,15 @@ namespace Storm
 {
 	struct DFSPHSolverData
 	{
+	public:
+		// The stiffness a solve starts from when warm started, from the stored one (timeStepFactor puts the time step back : 1/dt for the divergence solve, 1/dt^2 for the density solve).
+		// Both solves use the same rule, the one of the SPlisHSPlasH density warm start : the whole stiffness, with the suction clamped.
+		// Our k coefficients are negated compared to SPlisHSPlasH (a compression gives a negative stiffness), so its lower bound of -0.5 is an upper bound of 0.5 here.
+		static float computeWarmStartStiffness(const float storedStiffness, const float timeStepFactor)
+		{
+			return std::min(storedStiffness * timeStepFactor, 0.5f);
+		}
+
 	public:
 		Storm::Vector3 _nonPressureAcceleration;
 
@@ -12,5 +21,9 @@ namespace Storm
 
 		float _densityAdv;
 		Storm::Vector3 _predictedVelocity;
+
+		// Sum of the stiffnesses (k_i) the divergence and density solves ended with, time step independent. Used as initial guess if the warm start is enabled.
+		float _divergenceStiffness;
+		float _densityStiffness;
 	};
 }
@@ -17,6 +17,8 @@
 #include "IBlower.h"
 
 #include "MassCoeffHandler.h"
+#include "ParticleReorderer.h"
+#include "ParticleCompaction.h"
 
 #include "RunnerHelper.h"
 #include "FastOperation.h"
@@ -36,6 +38,7 @@
 
 Storm::FluidParticleSystem::FluidParticleSystem(unsigned int particleSystemIndex, std::vector<Storm::Vector3> &&worldPositions) :
 	Storm::ParticleSystem{ particleSystemIndex, std::move(worldPositions) },
+	_sleepingParticleCount{ 0 },
 	_fields{ std::make_unique<Storm::UIFieldContainer>() }
 {
 	const Storm::SingletonHolder &singletonHolder = Storm::SingletonHolder::instance();
@@ -80,6 +83,7 @@ Storm::FluidParticleSystem::FluidParticleSystem(unsigned int particleSystemIndex
 	_densities.resize(particleCount);
 	_pressure.resize(particleCount);
 	_tmpBlowerForces.resize(particleCount, Storm::Vector3::Zero());
+	_sleeping.resize(particleCount, 0);
 	
 	_velocityPreTimestep.resize(particleCount);
 	
@@ -89,11 +93,13 @@ Storm::FluidParticleSystem::FluidParticleSystem(unsigned int particleSystemIndex
 
 Storm::FluidParticleSystem::FluidParticleSystem(unsigned int particleSystemIndex, std::size_t particleCount) :
 	Storm::ParticleSystem{ particleSystemIndex, particleCount },
+	_sleepingParticleCount{ 0 },
 	_fields{ std::make_unique<Storm::UIFieldContainer>() }
 {
 	_densities.resize(particleCount);
 	_pressure.resize(particleCount);
 	_tmpBlowerForces.resize(particleCount);
+	_sleeping.resize(particleCount, 0);
 
 	// It will be overwritten by the record afterward but just to make it non stupid in case we have an old record that did not support the feature at the time.
 	const Storm::SingletonHolder &singletonHolder = Storm::SingletonHolder::instance();
@@ -135,6 +141,12 @@ void Storm::FluidParticleSystem::onIterationStart()
 	{
 		_massCoeffControlHandler->update();
 	}
+
+	// The particle count changed (particles removed, state loaded, ...). Former sleeping particles are meaningless.
+	if (_sleeping.size() != this->getParticleCount())
+	{
+		this->wakeAllParticles();
+	}
 }
 
 void Storm::FluidParticleSystem::onSubIterationStart(const Storm::ParticleSystemContainer &allParticleSystems, const std::vector<std::unique_ptr<Storm::IBlower>> &blowers)
@@ -147,9 +159,11 @@ void Storm::FluidParticleSystem::onSubIterationStart(const Storm::ParticleSystem
 
 	const Storm::Vector3 gravityAccel = _gravityEnabled ? sceneSimulationConfig._gravity : Storm::Vector3::Zero();
 
-	Storm::runParallel(_force, [this, &gravityAccel, &blowers](Storm::Vector3 &currentPForce, const std::size_t currentPIndex)
+	this->computeBlowerForces(sceneSimulationConfig, blowers);
+
+	Storm::runParallel(_force, [this, &gravityAccel](Storm::Vector3 &currentPForce, const std::size_t currentPIndex)
 	{
-		this->internalInitializeForce(gravityAccel, blowers, currentPForce, currentPIndex);
+		this->internalInitializeForce(gravityAccel, currentPForce, currentPIndex);
 
 		_velocityPreTimestep[currentPIndex] = _velocity[currentPIndex];
 	});
@@ -196,6 +210,11 @@ bool Storm::FluidParticleSystem::isWall() const noexcept
 	return false;
 }
 
+bool Storm::FluidParticleSystem::hasSleepingParticles() const noexcept
+{
+	return _sleepingParticleCount != 0;
+}
+
 void Storm::FluidParticleSystem::setPositions(std::vector<Storm::Vector3> &&positions)
 {
 	_positions = std::move(positions);
@@ -346,6 +365,62 @@ void Storm::FluidParticleSystem::prepareSaving(const bool replayMode)
 	}
 }
 
+void Storm::FluidParticleSystem::reorderParticles(const std::vector<std::size_t> &newToOldIndexes)
+{
+	Storm::ParticleSystem::reorderParticles(newToOldIndexes);
+
+	Storm::ParticleReorderer::applyPermutation(_masses, newToOldIndexes);
+	Storm::ParticleReorderer::applyPermutation(_densities, newToOldIndexes);
+	Storm::ParticleReorderer::applyPermutation(_pressure, newToOldIndexes);
+	Storm::ParticleReorderer::applyPermutation(_velocityPreTimestep, newToOldIndexes);
+	Storm::ParticleReorderer::applyPermutation(_tmpBlowerForces, newToOldIndexes);
+
+	// The neighborhoods are rebuilt entirely after a reordering, so it is simpler to restart sleeping from scratch.
+	this->wakeAllParticles();
+}
+
+void Storm::FluidParticleSystem::compactParticles(const Storm::ParticleCompaction &compaction)
+{
+	Storm::ParticleSystem::compactParticles(compaction);
+
+	compaction.apply(_masses);
+	compaction.apply(_densities);
+	compaction.apply(_pressure);
+	compaction.apply(_velocityPreTimestep);
+	compaction.apply(_tmpBlowerForces);
+
+	// Same as the reordering, the moved particles neighborhoods are rebuilt entirely.
+	this->wakeAllParticles();
+}
+
+void Storm::FluidParticleSystem::appendParticles(const std::vector<Storm::Vector3> &positions, const Storm::Vector3 &velocity)
+{
+	Storm::ParticleSystem::appendParticles(positions, velocity);
+
+	const std::size_t particleCount = this->getParticleCount();
+
+	// The new particles start at rest density, with no pressure.
+	_masses.resize(particleCount, _particleVolume * _wantedDensity);
+	_densities.resize(particleCount, _wantedDensity);
+	_pressure.resize(particleCount, 0.f);
+	_velocityPreTimestep.resize(particleCount, velocity);
+	_tmpBlowerForces.resize(particleCount, Storm::Vector3::Zero());
+
+	this->wakeAllParticles();
+}
+
+void Storm::FluidParticleSystem::reserveParticles(const std::size_t particleCount)
+{
+	Storm::ParticleSystem::reserveParticles(particleCount);
+
+	_masses.reserve(particleCount);
+	_densities.reserve(particleCount);
+	_pressure.reserve(particleCount);
+	_velocityPreTimestep.reserve(particleCount);
+	_tmpBlowerForces.reserve(particleCount);
+	_sleeping.reserve(particleCount);
+}
+
 float Storm::FluidParticleSystem::getRestDensity() const noexcept
 {
 	// Wanted density is equal to the rest density if we did not enable the density smooth change.
@@ -412,6 +487,177 @@ void Storm::FluidParticleSystem::setGravityEnabled(bool enabled) noexcept
 	_gravityEnabled = enabled;
 }
 
+std::size_t Storm::FluidParticleSystem::getSleepingParticleCount() const noexcept
+{
+	return _sleepingParticleCount;
+}
+
+void Storm::FluidParticleSystem::wakeAllParticles()
+{
+	_sleeping.assign(this->getParticleCount(), 0);
+	_sleepingParticleCount = 0;
+	_frozenNeighborhoods.clear();
+
+	// Restart counting the quiet steps from scratch (updateSleeping resizes it).
+	_quietStepCounts.clear();
+}
+
+void Storm::FluidParticleSystem::updateSleeping(const Storm::ParticleSystemContainer &allParticleSystems)
+{
+	const Storm::SingletonHolder &singletonHolder = Storm::SingletonHolder::instance();
+	const Storm::ISpacePartitionerManager &spacePartitionerMgr = singletonHolder.getSingleton<Storm::ISpacePartitionerManager>();
+
+	const Storm::IConfigManager &configMgr = singletonHolder.getSingleton<Storm::IConfigManager>();
+	const Storm::SceneSimulationConfig &sceneSimulationConfig = configMgr.getSceneSimulationConfig();
+
+	const std::size_t particleCount = this->getParticleCount();
+	if (_quietStepCounts.size() != particleCount)
+	{
+		_sleeping.assign(particleCount, 0);
+		_wasSleeping.assign(particleCount, 0);
+		_quietStepCounts.assign(particleCount, 0);
+		_frozenPositions.resize(particleCount);
+		_frozenNeighborhoods.assign(particleCount, 0);
+		_sleepingParticleCount = 0;
+	}
+
+	const uint16_t sleepingStepCount = static_cast<uint16_t>(sceneSimulationConfig._fluidSleepingStepCount);
+	const float velocityThresholdSquared = sceneSimulationConfig._fluidSleepingVelocityThreshold * sceneSimulationConfig._fluidSleepingVelocityThreshold;
+	const float accelerationThresholdSquared = sceneSimulationConfig._fluidSleepingAccelerationThreshold * sceneSimulationConfig._fluidSleepingAccelerationThreshold;
+	const float densityErrorThreshold = sceneSimulationConfig._fluidSleepingDensityErrorThreshold;
+
+	// Count the steps each particle stayed quiet, from what the solver just computed (even for sleeping particles, that are frozen only afterward).
+	// Like the pressure solvers, we only consider the compression as a density error (particles near the free surface have a lower density).
+	Storm::runParallel(_quietStepCounts, [this, sleepingStepCount, velocityThresholdSquared, accelerationThresholdSquared, densityErrorThreshold](uint16_t &currentPQuietStepCount, const std::size_t currentPIndex)
+	{
+		const float currentPMass = _masses[currentPIndex];
+		const float maxForceSquared = accelerationThresholdSquared * currentPMass * currentPMass;
+
+		const bool isQuiet =
+			_velocity[currentPIndex].squaredNorm() <= velocityThresholdSquared &&
+			(_densities[currentPIndex] / _restDensity - 1.f) <= densityErrorThreshold &&
+			_force[currentPIndex].squaredNorm() <= maxForceSquared &&
+			_tmpBlowerForces[currentPIndex].squaredNorm() <= maxForceSquared
+			;
+
+		currentPQuietStepCount = isQuiet ? std::min(static_cast<uint16_t>(currentPQuietStepCount + 1), sleepingStepCount) : 0;
+	});
+
+	// The particles moving fast enough wake their neighbors from this fluid. We look from the moving particles since their neighborhoods are up to date
+	// (the neighborhood of a sleeping particle is only searched again once something moves around it).
+	for (const auto &particleSystemPair : allParticleSystems)
+	{
+		const Storm::ParticleSystem &pSystem = *particleSystemPair.second;
+		if (pSystem.isStatic())
+		{
+			continue;
+		}
+
+		const Storm::ParticleNeighborhoodStorage &neighborhoodArrays = pSystem.getNeighborhoodArrays();
+		if (neighborhoodArrays.size() != pSystem.getParticleCount())
+		{
+			continue;
+		}
+
+		Storm::runParallel(pSystem.getVelocity(), [this, &neighborhoodArrays, velocityThresholdSquared](const Storm::Vector3 &currentPVelocity, const std::size_t currentPIndex)
+		{
+			if (currentPVelocity.squaredNorm() > velocityThresholdSquared)
+			{
+				for (const Storm::NeighborParticleInfo &neighbor : neighborhoodArrays[currentPIndex])
+				{
+					if (neighbor._containingParticleSystem == this)
+					{
+						// Many moving particles can wake the same neighbor.
+						std::atomic_ref<uint16_t>{ _quietStepCounts[neighbor._particleIndex] }.store(0, std::memory_order_relaxed);
+					}
+				}
+			}
+		});
+	}
+
+	// A fluid partition voxel sleeps if all the particles of this fluid inside it were quiet long enough. Otherwise, all of them are awake.
+	std::swap(_sleeping, _wasSleeping);
+	_sleepingVoxels.computeSleepingParticles(spacePartitionerMgr, this->getId(), _quietStepCounts, sleepingStepCount, _sleeping);
+
+	// The sleeping particles stay where they fell asleep. The woken ones keep what the solver computed.
+	Storm::runParallel(_sleeping, [this](const uint8_t currentPSleeping, const std::size_t currentPIndex)
+	{
+		if (currentPSleeping)
+		{
+			if (_wasSleeping[currentPIndex])
+			{
+				_positions[currentPIndex] = _frozenPositions[currentPIndex];
+			}
+			else
+			{
+				_frozenPositions[currentPIndex] = _positions[currentPIndex];
+			}
+
+			_velocity[currentPIndex].setZero();
+		}
+	});
+
+	_sleepingParticleCount = static_cast<std::size_t>(std::count(std::execution::par, std::begin(_sleeping), std::end(_sleeping), static_cast<uint8_t>(1)));
+
+	// Nobody sleeps, so the next neighborhoods will all be searched while nothing is frozen (computeKeptNeighborhoods won't be called to tell it).
+	if (_sleepingParticleCount == 0)
+	{
+		std::fill(std::execution::par, std::begin(_frozenNeighborhoods), std::end(_frozenNeighborhoods), static_cast<uint8_t>(0));
+	}
+}
+
+const std::vector<uint8_t>& Storm::FluidParticleSystem::computeKeptNeighborhoods(const Storm::ParticleSystemContainer &/*allParticleSystems*/, const bool fromCandidates)
+{
+	const Storm::SingletonHolder &singletonHolder = Storm::SingletonHolder::instance();
+	const Storm::ISpacePartitionerManager &spacePartitionerMgr = singletonHolder.getSingleton<Storm::ISpacePartitionerManager>();
+
+	const std::size_t particleCount = this->getParticleCount();
+	_frozenNeighborhoods.resize(particleCount, 0);
+	_keptNeighborhoods.resize(particleCount);
+
+	if (fromCandidates)
+	{
+		// Verlet list : the candidates are all particles that can come near before the next full search.
+		Storm::runParallel(_keptNeighborhoods, [this](uint8_t &currentPKept, const std::size_t currentPIndex)
+		{
+			bool isFrozen = this->isParticleSleeping(currentPIndex);
+			if (isFrozen)
+			{
+				for (const Storm::NeighborParticleInfo &candidate : _neighborhoodCandidates[currentPIndex])
+				{
+					const bool isCandidateFrozen = candidate._containingParticleSystem == this ? this->isParticleSleeping(candidate._particleIndex) : candidate._containingParticleSystem->isStatic();
+					if (!isCandidateFrozen)
+					{
+						isFrozen = false;
+						break;
+					}
+				}
+			}
+
+			currentPKept = Storm::FluidSleepingVoxels::keepsNeighborhood(isFrozen, _frozenNeighborhoods[currentPIndex]);
+		});
+
+		return _keptNeighborhoods;
+	}
+
+	// The neighbors coming from the other side of the domain aren't worth the trouble.
+	if (spacePartitionerMgr.isInfiniteDomainMode())
+	{
+		std::fill(std::execution::par, std::begin(_keptNeighborhoods), std::end(_keptNeighborhoods), static_cast<uint8_t>(0));
+		std::fill(std::execution::par, std::begin(_frozenNeighborhoods), std::end(_frozenNeighborhoods), static_cast<uint8_t>(0));
+		return _keptNeighborhoods;
+	}
+
+	// Whatever the way we check what surrounds a particle, its neighborhood is kept only if it was already frozen when the neighborhood was built.
+	_sleepingVoxels.computeFrozenParticles(spacePartitionerMgr, this->getId(), _positions, _sleeping, _keptNeighborhoods);
+	Storm::runParallel(_keptNeighborhoods, [this](uint8_t &currentPKept, const std::size_t currentPIndex)
+	{
+		currentPKept = Storm::FluidSleepingVoxels::keepsNeighborhood(currentPKept != 0, _frozenNeighborhoods[currentPIndex]);
+	});
+
+	return _keptNeighborhoods;
+}
+
 // TODO : Factorize with buildSpecificParticleNeighborhoodOnParticleSystemUsingSpacePartition without performance loss (because this code is performance critical)
 void Storm::FluidParticleSystem::buildNeighborhoodOnParticleSystemUsingSpacePartition(const Storm::ParticleSystemContainer &allParticleSystems, const float kernelLength)
 {
@@ -421,10 +667,15 @@ void Storm::FluidParticleSystem::buildNeighborhoodOnParticleSystemUsingSpacePart
 	const Storm::IConfigManager &configMgr = singletonHolder.getSingleton<Storm::IConfigManager>();
 	const Storm::SceneSimulationConfig &sceneSimulationConfig = configMgr.getSceneSimulationConfig();
 
-	const Storm::RawKernelMethodDelegate rawKernel = Storm::retrieveRawKernelMethod(sceneSimulationConfig._kernelMode);
-	const Storm::GradKernelMethodDelegate gradKernel = Storm::retrieveGradKernelMethod(sceneSimulationConfig._kernelMode);
+	if (sceneSimulationConfig._symmetricNeighborSearch && !spacePartitionerMgr.isInfiniteDomainMode())
+	{
+		this->buildSymmetricNeighborhoodOnParticleSystemUsingSpacePartition(allParticleSystems, kernelLength);
+		return;
+	}
 
-	Storm::runParallel(_neighborhood, [this, &allParticleSystems, &spacePartitionerMgr, &rawKernel, &gradKernel, kernelLength, kernelLengthSquared = kernelLength * kernelLength, currentSystemId = this->getId(), domainDimension = spacePartitionerMgr.getDomainDimension(), infiniteDomain = spacePartitionerMgr.isInfiniteDomainMode()](ParticleNeighborhoodArray &currentPNeighborhood, const std::size_t particleIndex)
+	const Storm::KernelBatchMethodDelegate kernelBatch = Storm::retrieveKernelBatchMethod(sceneSimulationConfig._kernelMode);
+
+	const auto searchNeighborhood = [this, &allParticleSystems, &spacePartitionerMgr, &kernelBatch, kernelLength, kernelLengthSquared = kernelLength * kernelLength, currentSystemId = this->getId(), domainDimension = spacePartitionerMgr.getDomainDimension(), infiniteDomain = spacePartitionerMgr.isInfiniteDomainMode()](ParticleNeighborhoodBuildArray &currentPNeighborhood, const std::size_t particleIndex)
 	{
 		const Storm::Vector3 &currentPPosition = _positions[particleIndex];
 		if (spacePartitionerMgr.isOutsideSpaceDomain(currentPPosition)) STORM_UNLIKELY
@@ -432,10 +683,10 @@ void Storm::FluidParticleSystem::buildNeighborhoodOnParticleSystemUsingSpacePart
 			return;
 		}
 
-		const std::vector<Storm::NeighborParticleReferral>* bundleContainingPtr;
-		const std::vector<Storm::NeighborParticleReferral>* outLinkedNeighborBundle[Storm::k_neighborLinkedBunkCount];
+		const Storm::NeighborParticleReferralBundle* bundleContainingPtr;
+		const Storm::NeighborParticleReferralBundle* outLinkedNeighborBundle[Storm::k_neighborLinkedBunkCount];
 
-		Storm::NeighborSearchInParam<ParticleNeighborhoodArray, decltype(rawKernel), decltype(gradKernel), Storm::k_neighborLinkedBunkCount> inParam{
+		Storm::NeighborSearchInParam<ParticleNeighborhoodBuildArray, Storm::k_neighborLinkedBunkCount> inParam{
 			this,
 			allParticleSystems,
 			kernelLength,
@@ -446,8 +697,6 @@ void Storm::FluidParticleSystem::buildNeighborhoodOnParticleSystemUsingSpacePart
 			currentPPosition,
 			bundleContainingPtr,
 			outLinkedNeighborBundle,
-			rawKernel,
-			gradKernel,
 			domainDimension,
 			true
 		};
@@ -496,7 +745,121 @@ void Storm::FluidParticleSystem::buildNeighborhoodOnParticleSystemUsingSpacePart
 			spacePartitionerMgr.getAllBundles(bundleContainingPtr, outLinkedNeighborBundle, currentPPosition, Storm::PartitionSelection::DynamicRigidBody);
 			Storm::searchForNeighborhood<false, false>(inParam);
 		}
+
+		kernelBatch(kernelLength, currentPNeighborhood);
+	};
+
+	if (_sleepingParticleCount != 0)
+	{
+		// Sleeping particles don't move, they keep the neighborhood they had as long as nothing moves around them.
+		const std::vector<uint8_t> &keptNeighborhoods = this->computeKeptNeighborhoods(allParticleSystems, false);
+		_neighborhood.fillKeepingPrevious(searchNeighborhood, [&keptNeighborhoods](const std::size_t particleIndex)
+		{
+			return keptNeighborhoods[particleIndex] != 0;
+		});
+	}
+	else
+	{
+		_neighborhood.fill(searchNeighborhood);
+	}
+}
+
+void Storm::FluidParticleSystem::buildSymmetricNeighborhoodOnParticleSystemUsingSpacePartition(const Storm::ParticleSystemContainer &allParticleSystems, const float kernelLength)
+{
+	const Storm::SingletonHolder &singletonHolder = Storm::SingletonHolder::instance();
+	const Storm::ISpacePartitionerManager &spacePartitionerMgr = singletonHolder.getSingleton<Storm::ISpacePartitionerManager>();
+
+	const Storm::IConfigManager &configMgr = singletonHolder.getSingleton<Storm::IConfigManager>();
+	const Storm::SceneSimulationConfig &sceneSimulationConfig = configMgr.getSceneSimulationConfig();
+
+	const Storm::KernelBatchMethodDelegate kernelBatch = Storm::retrieveKernelBatchMethod(sceneSimulationConfig._kernelMode);
+
+	// The fluid partition is shared by all fluids. If we're alone, there is no need to search the other fluids neighbors in the whole neighborhood.
+	const bool hasOtherFluids = std::any_of(std::begin(allParticleSystems), std::end(allParticleSystems), [this](const auto &particleSystemPair)
+	{
+		return particleSystemPair.second.get() != this && particleSystemPair.second->isFluids();
 	});
+
+	const auto searchNeighborhood = [this, &allParticleSystems, &spacePartitionerMgr, &kernelBatch, hasOtherFluids, kernelLength, kernelLengthSquared = kernelLength * kernelLength, currentSystemId = this->getId(), domainDimension = spacePartitionerMgr.getDomainDimension()](ParticleNeighborhoodBuildArray &forwardNeighborhood, ParticleNeighborhoodBuildArray &otherNeighborhood, const std::size_t particleIndex)
+	{
+		const Storm::Vector3 &currentPPosition = _positions[particleIndex];
+
+		const Storm::NeighborParticleReferralBundle* bundleContainingPtr;
+		const Storm::NeighborParticleReferralBundle* outLinkedNeighborBundle[Storm::k_neighborLinkedBunkCount];
+
+		// The particles outside the domain don't have neighbors, but they're still inside the partition, so the particles before them expect them to search the pairs they share.
+		Storm::NeighborSearchInParam<ParticleNeighborhoodBuildArray, Storm::k_neighborLinkedBunkCount> forwardInParam{
+			this,
+			allParticleSystems,
+			kernelLength,
+			kernelLengthSquared,
+			currentSystemId,
+			forwardNeighborhood,
+			particleIndex,
+			currentPPosition,
+			bundleContainingPtr,
+			outLinkedNeighborBundle,
+			domainDimension,
+			true
+		};
+
+		spacePartitionerMgr.getForwardBundles(bundleContainingPtr, outLinkedNeighborBundle, currentPPosition, Storm::PartitionSelection::Fluid);
+		Storm::searchForForwardNeighborhood(forwardInParam);
+
+		kernelBatch(kernelLength, forwardNeighborhood);
+
+		if (spacePartitionerMgr.isOutsideSpaceDomain(currentPPosition)) STORM_UNLIKELY
+		{
+			return false;
+		}
+
+		Storm::NeighborSearchInParam<ParticleNeighborhoodBuildArray, Storm::k_neighborLinkedBunkCount> otherInParam{
+			this,
+			allParticleSystems,
+			kernelLength,
+			kernelLengthSquared,
+			currentSystemId,
+			otherNeighborhood,
+			particleIndex,
+			currentPPosition,
+			bundleContainingPtr,
+			outLinkedNeighborBundle,
+			domainDimension,
+			true
+		};
+
+		if (hasOtherFluids)
+		{
+			spacePartitionerMgr.getAllBundles(bundleContainingPtr, outLinkedNeighborBundle, currentPPosition, Storm::PartitionSelection::Fluid);
+			Storm::searchForOtherSystemsNeighborhood(otherInParam);
+		}
+
+		otherInParam._isFluid = false;
+
+		spacePartitionerMgr.getAllBundles(bundleContainingPtr, outLinkedNeighborBundle, currentPPosition, Storm::PartitionSelection::StaticRigidBody);
+		Storm::searchForNeighborhood<false, false>(otherInParam);
+
+		spacePartitionerMgr.getAllBundles(bundleContainingPtr, outLinkedNeighborBundle, currentPPosition, Storm::PartitionSelection::DynamicRigidBody);
+		Storm::searchForNeighborhood<false, false>(otherInParam);
+
+		kernelBatch(kernelLength, otherNeighborhood);
+
+		return true;
+	};
+
+	if (_sleepingParticleCount != 0)
+	{
+		// Same than buildNeighborhoodOnParticleSystemUsingSpacePartition. The particles keeping their neighborhood don't search anything, even the pairs they share with the other particles.
+		const std::vector<uint8_t> &keptNeighborhoods = this->computeKeptNeighborhoods(allParticleSystems, false);
+		_neighborhood.fillSymmetricKeepingPrevious(searchNeighborhood, [&keptNeighborhoods](const std::size_t particleIndex)
+		{
+			return keptNeighborhoods[particleIndex] != 0;
+		});
+	}
+	else
+	{
+		_neighborhood.fillSymmetric(searchNeighborhood);
+	}
 }
 
 // TODO : Factorize with buildNeighborhoodOnParticleSystemUsingSpacePartition without performance loss (because this code is performance critical)
@@ -514,22 +877,22 @@ void Storm::FluidParticleSystem::buildSpecificParticleNeighborhoodOnParticleSyst
 	const Storm::IConfigManager &configMgr = singletonHolder.getSingleton<Storm::IConfigManager>();
 	const Storm::SceneSimulationConfig &sceneSimulationConfig = configMgr.getSceneSimulationConfig();
 
-	const std::vector<Storm::NeighborParticleReferral>* bundleContainingPtr;
-	const std::vector<Storm::NeighborParticleReferral>* outLinkedNeighborBundle[Storm::k_neighborLinkedBunkCount];
+	const Storm::NeighborParticleReferralBundle* bundleContainingPtr;
+	const Storm::NeighborParticleReferralBundle* outLinkedNeighborBundle[Storm::k_neighborLinkedBunkCount];
+
+	Storm::ParticleNeighborhoodBuildArray currentPNeighborhood;
 
-	Storm::NeighborSearchInParam<ParticleNeighborhoodArray, decltype(Storm::retrieveRawKernelMethod(sceneSimulationConfig._kernelMode)), decltype(Storm::retrieveGradKernelMethod(sceneSimulationConfig._kernelMode)), Storm::k_neighborLinkedBunkCount> inParam{
+	Storm::NeighborSearchInParam<ParticleNeighborhoodBuildArray, Storm::k_neighborLinkedBunkCount> inParam{
 		this,
 		allParticleSystems,
 		kernelLength,
 		kernelLength * kernelLength,
 		this->getId(),
-		_neighborhood[particleIndex],
+		currentPNeighborhood,
 		particleIndex,
 		currentPPosition,
 		bundleContainingPtr,
 		outLinkedNeighborBundle,
-		Storm::retrieveRawKernelMethod(sceneSimulationConfig._kernelMode),
-		Storm::retrieveGradKernelMethod(sceneSimulationConfig._kernelMode),
 		spacePartitionerMgr.getDomainDimension(),
 		true
 	};
@@ -578,13 +941,14 @@ void Storm::FluidParticleSystem::buildSpecificParticleNeighborhoodOnParticleSyst
 		spacePartitionerMgr.getAllBundles(bundleContainingPtr, outLinkedNeighborBundle, currentPPosition, Storm::PartitionSelection::DynamicRigidBody);
 		Storm::searchForNeighborhood<false, false>(inParam);
 	}
+
+	Storm::retrieveKernelBatchMethod(sceneSimulationConfig._kernelMode)(kernelLength, currentPNeighborhood);
+	_neighborhood.setParticleNeighborhood(particleIndex, currentPNeighborhood);
 }
 
 bool Storm::FluidParticleSystem::computeVelocityChange(float deltaTimeInSec, float highVelocityThresholdSquared)
 {
-	std::atomic<bool> highSpeed = false;
-
-	Storm::runParallel(_force, [this, deltaTimeInSec, &highSpeed, highVelocityThresholdSquared](const Storm::Vector3 &currentForce, const std::size_t currentPIndex)
+	const Storm::ParallelReduceResult velocityResult = Storm::reduceChunkedParallel(_force, [this, deltaTimeInSec, highVelocityThresholdSquared](const Storm::Vector3 &currentForce, const std::size_t currentPIndex, Storm::ParallelReduceResult &chunkResult)
 	{
 		Storm::Vector3 &currentPVelocity = _velocity[currentPIndex];
 
@@ -593,11 +957,11 @@ bool Storm::FluidParticleSystem::computeVelocityChange(float deltaTimeInSec, flo
 		currentPVelocity += solver._velocityVariation;
 		if (currentPVelocity.squaredNorm() > highVelocityThresholdSquared)
 		{
-			highSpeed = true;
+			chunkResult._flag = true;
 		}
 	});
 
-	return highSpeed;
+	return velocityResult._flag;
 }
 
 void Storm::FluidParticleSystem::updatePosition(float deltaTimeInSec, bool)
@@ -630,28 +994,69 @@ void Storm::FluidParticleSystem::revertToCurrentTimestep(const std::vector<std::
 
 	const Storm::Vector3 gravityAccel = _gravityEnabled ? sceneSimulationConfig._gravity : Storm::Vector3::Zero();
 
-	Storm::runParallel(_force, [this, &blowers, &gravityAccel](Storm::Vector3 &force, const std::size_t currentPIndex)
+	this->computeBlowerForces(sceneSimulationConfig, blowers);
+
+	Storm::runParallel(_force, [this, &gravityAccel](Storm::Vector3 &force, const std::size_t currentPIndex)
 	{
-		this->internalInitializeForce(gravityAccel, blowers, force, currentPIndex);
+		this->internalInitializeForce(gravityAccel, force, currentPIndex);
 		_velocity[currentPIndex] = _velocityPreTimestep[currentPIndex];
 	});
 }
 
-void Storm::FluidParticleSystem::internalInitializeForce(const Storm::Vector3 &gravityAccel, const std::vector<std::unique_ptr<Storm::IBlower>> &blowers, Storm::Vector3 &force, const std::size_t currentPIndex)
+void Storm::FluidParticleSystem::internalInitializeForce(const Storm::Vector3 &gravityAccel, Storm::Vector3 &force, const std::size_t currentPIndex)
 {
 	const float currentPMass = _masses[currentPIndex];
 	force = currentPMass * gravityAccel;
 
-	Storm::Vector3 &currentPBlowerForce = _tmpBlowerForces[currentPIndex];
-	currentPBlowerForce.setZero();
+	force += _tmpBlowerForces[currentPIndex];
 
-	const Storm::Vector3 &currentPPosition = _positions[currentPIndex];
-	for (const std::unique_ptr<Storm::IBlower> &blowerUPtr : blowers)
+	this->resetParticleTemporaryForces(currentPIndex);
+}
+
+void Storm::FluidParticleSystem::computeBlowerForces(const Storm::SceneSimulationConfig &sceneSimulationConfig, const std::vector<std::unique_ptr<Storm::IBlower>> &blowers)
+{
+	Storm::runParallel(_tmpBlowerForces, [](Storm::Vector3 &currentPBlowerForce)
+	{
+		currentPBlowerForce.setZero();
+	});
+
+	if (blowers.empty())
 	{
-		blowerUPtr->applyForce(currentPPosition, currentPBlowerForce);
+		return;
 	}
 
-	force += currentPBlowerForce;
+	const Storm::ISpacePartitionerManager &spacePartitionerMgr = Storm::SingletonHolder::instance().getSingleton<Storm::ISpacePartitionerManager>();
 
-	this->resetParticleTemporaryForces(currentPIndex);
+	// With Verlet lists, the partition is only refreshed when a particle has moved more than half the skin (which is less than a partition cell) since the last refresh.
+	// Therefore a particle could have left the cells overlapping the effect area but still be inside it, so we look one more cell around.
+	const float boundingBoxMargin = sceneSimulationConfig._recomputeNeighborhoodStep > 1 ? spacePartitionerMgr.getPartitionLength() : 0.f;
+
+	const unsigned int systemId = this->getId();
+
+	for (const std::unique_ptr<Storm::IBlower> &blowerUPtr : blowers)
+	{
+		const Storm::IBlower &blower = *blowerUPtr;
+		if (!blower.isBlowing())
+		{
+			continue;
+		}
+
+		Storm::Vector3 minCorner;
+		Storm::Vector3 maxCorner;
+		blower.getEffectAreaBoundingBox(minCorner, maxCorner);
+		minCorner.array() -= boundingBoxMargin;
+		maxCorner.array() += boundingBoxMargin;
+
+		_blowerBundles.clear();
+		spacePartitionerMgr.visitBundlesInsideBox(minCorner, maxCorner, Storm::PartitionSelection::Fluid, [this](const Storm::NeighborParticleReferralBundle &bundle)
+		{
+			_blowerBundles.emplace_back(bundle);
+		});
+
+		// A particle is registered inside only one cell, so each cell can be processed by a different thread.
+		Storm::runParallel(_blowerBundles, [this, &blower, systemId](const Storm::NeighborParticleReferralBundle &bundle)
+		{
+			blower.applyForces(_positions, bundle, systemId, _tmpBlowerForces);
+		});
+	}
 }
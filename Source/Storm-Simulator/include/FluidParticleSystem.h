@@ -1,12 +1,14 @@
 #pragma once
 
 #include "ParticleSystem.h"
+#include "FluidSleepingVoxels.h"
 
 
 namespace Storm
 {
 	class UIFieldContainer;
 	class MassCoeffHandler;
+	struct SceneSimulationConfig;
 
 	class FluidParticleSystem : public Storm::ParticleSystem
 	{
@@ -24,6 +26,7 @@ namespace Storm
 		bool isFluids() const noexcept final override;
 		bool isStatic() const noexcept final override;
 		bool isWall() const noexcept final override;
+		bool hasSleepingParticles() const noexcept final override;
 
 		void setPositions(std::vector<Storm::Vector3> &&positions) final override;
 		void setVelocity(std::vector<Storm::Vector3> &&velocities) final override;
@@ -48,6 +51,11 @@ namespace Storm
 
 		void prepareSaving(const bool replayMode) final override;
 
+		void reorderParticles(const std::vector<std::size_t> &newToOldIndexes) final override;
+		void compactParticles(const Storm::ParticleCompaction &compaction) final override;
+		void appendParticles(const std::vector<Storm::Vector3> &positions, const Storm::Vector3 &velocity) final override;
+		void reserveParticles(const std::size_t particleCount) final override;
+
 	public:
 		// Accessible by dynamic casting.
 		float getRestDensity() const noexcept;
@@ -68,10 +76,24 @@ namespace Storm
 
 		void setGravityEnabled(bool enabled) noexcept;
 
+		// Activity based sleeping (see fluidSleepingStepCount). Sleeping particles are frozen and keep their former neighborhood while nothing moves around them, their non pressure forces aren't computed.
+		__forceinline bool isParticleSleeping(const std::size_t particleIndex) const noexcept { return _sleeping[particleIndex] != 0; }
+		std::size_t getSleepingParticleCount() const noexcept;
+		void wakeAllParticles();
+
+		// Should be called at the end of each iteration, once the solver has computed the new particles state.
+		// Puts to sleep the fluid partition voxels whose particles all stayed quiet long enough, and wakes the others.
+		void updateSleeping(const Storm::ParticleSystemContainer &allParticleSystems);
+
 	public:
 		void buildNeighborhoodOnParticleSystemUsingSpacePartition(const Storm::ParticleSystemContainer &allParticleSystems, const float kernelLength) final override;
 		void buildSpecificParticleNeighborhoodOnParticleSystemUsingSpacePartition(const Storm::ParticleSystemContainer &allParticleSystems, const std::size_t particleIndex, const float kernelLength) final override;
 
+	protected:
+		// A sleeping particle keeps its previous neighborhood only if it is still exact : it was built while everything that could be its neighbor was frozen, and everything still is.
+		// Otherwise, an awake particle coming near would see the sleeping particle without the sleeping particle seeing it.
+		const std::vector<uint8_t>& computeKeptNeighborhoods(const Storm::ParticleSystemContainer &allParticleSystems, const bool fromCandidates) final override;
+
 	public:
 		bool computeVelocityChange(float deltaTimeInSec, float highVelocityThresholdSquared) final override;
 		void updatePosition(float deltaTimeInSec, bool force) final override;
@@ -80,7 +102,13 @@ namespace Storm
 		void revertToCurrentTimestep(const std::vector<std::unique_ptr<Storm::IBlower>> &blowers) final override;
 
 	private:
-		void internalInitializeForce(const Storm::Vector3 &gravityAccel, const std::vector<std::unique_ptr<Storm::IBlower>> &blowers, Storm::Vector3 &force, const std::size_t currentPIndex);
+		void internalInitializeForce(const Storm::Vector3 &gravityAccel, Storm::Vector3 &force, const std::size_t currentPIndex);
+
+		// Fill _tmpBlowerForces. Each blower is only applied to the particles inside the fluid partition cells overlapping its effect area, therefore the fluid partition should be up to date.
+		void computeBlowerForces(const Storm::SceneSimulationConfig &sceneSimulationConfig, const std::vector<std::unique_ptr<Storm::IBlower>> &blowers);
+
+		// Same as buildNeighborhoodOnParticleSystemUsingSpacePartition, but each pair of particles of this fluid is searched and its kernel values computed only once. Doesn't handle the infinite domain.
+		void buildSymmetricNeighborhoodOnParticleSystemUsingSpacePartition(const Storm::ParticleSystemContainer &allParticleSystems, const float kernelLength);
 
 	private:
 		std::vector<float> _masses;
@@ -90,6 +118,22 @@ namespace Storm
 		std::vector<Storm::Vector3> _velocityPreTimestep;
 		std::vector<Storm::Vector3> _tmpBlowerForces;
 
+		// The fluid partition cells overlapping the effect area of the blower being applied. Kept to not reallocate it each time.
+		std::vector<Storm::NeighborParticleReferralBundle> _blowerBundles;
+
+		// Sleeping state. _sleeping is always sized to the particle count (even when sleeping is disabled), the other arrays only when sleeping is enabled.
+		std::vector<uint8_t> _sleeping;
+		std::vector<uint8_t> _wasSleeping;
+		std::vector<uint16_t> _quietStepCounts;
+		std::vector<Storm::Vector3> _frozenPositions;
+		std::size_t _sleepingParticleCount;
+		Storm::FluidSleepingVoxels _sleepingVoxels;
+
+		// Per particle, 1 if its current neighborhood was built while it and everything that could be its neighbor were frozen.
+		std::vector<uint8_t> _frozenNeighborhoods;
+		// Per particle, 1 if it keeps its previous neighborhood in the neighborhood build in progress.
+		std::vector<uint8_t> _keptNeighborhoods;
+
 		float _restDensity;
 		float _wantedDensity;
 		float _particleVolume;
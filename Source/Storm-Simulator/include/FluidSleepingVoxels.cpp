@@ -0,0 +1,133 @@
+#include "FluidSleepingVoxels.h"
+
+#include "ISpacePartitionerManager.h"
+
+#include "PartitionSelection.h"
+#include "NeighborParticleReferral.h"
+
+#include "RunnerHelper.h"
+
+
+Storm::FluidSleepingVoxels::FluidSleepingVoxels() = default;
+Storm::FluidSleepingVoxels::~FluidSleepingVoxels() = default;
+
+void Storm::FluidSleepingVoxels::computeSleepingParticles(const Storm::ISpacePartitionerManager &spacePartitionerMgr, const unsigned int systemId, const std::vector<uint16_t> &quietStepCounts, const uint16_t sleepingStepCount, std::vector<uint8_t> &outSleeping)
+{
+	assert(quietStepCounts.size() == outSleeping.size() && "Particle count mismatch between the quiet step counts and the sleeping flags!");
+
+	const std::size_t particleCount = outSleeping.size();
+	std::fill(std::execution::par, std::begin(outSleeping), std::end(outSleeping), static_cast<uint8_t>(0));
+
+	constexpr float k_maxCoord = std::numeric_limits<float>::max();
+
+	_bundles.clear();
+	spacePartitionerMgr.visitBundlesInsideBox(Storm::Vector3{ -k_maxCoord, -k_maxCoord, -k_maxCoord }, Storm::Vector3{ k_maxCoord, k_maxCoord, k_maxCoord }, Storm::PartitionSelection::Fluid, [this](const Storm::NeighborParticleReferralBundle &bundle)
+	{
+		_bundles.emplace_back(bundle);
+	});
+
+	Storm::runParallel(_bundles, [&quietStepCounts, &outSleeping, sleepingStepCount, particleCount, systemId](const Storm::NeighborParticleReferralBundle &bundle)
+	{
+		bool hasParticle = false;
+		for (const Storm::NeighborParticleReferral &referral : bundle)
+		{
+			if (referral._systemId == systemId && referral._particleIndex < particleCount)
+			{
+				if (quietStepCounts[referral._particleIndex] < sleepingStepCount)
+				{
+					return;
+				}
+
+				hasParticle = true;
+			}
+		}
+
+		if (hasParticle)
+		{
+			for (const Storm::NeighborParticleReferral &referral : bundle)
+			{
+				if (referral._systemId == systemId && referral._particleIndex < particleCount)
+				{
+					outSleeping[referral._particleIndex] = 1;
+				}
+			}
+		}
+	});
+}
+
+void Storm::FluidSleepingVoxels::computeFrozenParticles(const Storm::ISpacePartitionerManager &spacePartitionerMgr, const unsigned int systemId, const std::vector<Storm::Vector3> &positions, const std::vector<uint8_t> &sleeping, std::vector<uint8_t> &outFrozen)
+{
+	assert(positions.size() == sleeping.size() && positions.size() == outFrozen.size() && "Particle count mismatch between the positions, the sleeping flags and the frozen flags!");
+
+	const std::size_t particleCount = positions.size();
+
+	// Flag the particles whose voxel only contains sleeping particles of this fluid. Since the flag is the same for all particles of a voxel, checking the first particle of a voxel is enough afterward.
+	const auto isFrozenReferral = [&sleeping, particleCount, systemId](const Storm::NeighborParticleReferral &referral)
+	{
+		return referral._systemId == systemId && referral._particleIndex < particleCount && sleeping[referral._particleIndex] != 0;
+	};
+
+	_frozenVoxels.resize(particleCount);
+
+	constexpr float k_maxCoord = std::numeric_limits<float>::max();
+	spacePartitionerMgr.visitBundlesInsideBox(Storm::Vector3{ -k_maxCoord, -k_maxCoord, -k_maxCoord }, Storm::Vector3{ k_maxCoord, k_maxCoord, k_maxCoord }, Storm::PartitionSelection::Fluid, [this, &isFrozenReferral, particleCount, systemId](const Storm::NeighborParticleReferralBundle &bundle)
+	{
+		const uint8_t isFrozenVoxel = static_cast<uint8_t>(std::all_of(std::begin(bundle), std::end(bundle), isFrozenReferral));
+		for (const Storm::NeighborParticleReferral &referral : bundle)
+		{
+			if (referral._systemId == systemId && referral._particleIndex < particleCount)
+			{
+				_frozenVoxels[referral._particleIndex] = isFrozenVoxel;
+			}
+		}
+	});
+
+	Storm::runParallel(outFrozen, [this, &spacePartitionerMgr, &positions, &sleeping, &isFrozenReferral](uint8_t &currentPFrozen, const std::size_t currentPIndex)
+	{
+		const Storm::Vector3 &currentPPosition = positions[currentPIndex];
+
+		bool isFrozen = sleeping[currentPIndex] != 0 && !spacePartitionerMgr.isOutsideSpaceDomain(currentPPosition);
+		if (isFrozen)
+		{
+			const Storm::NeighborParticleReferralBundle* bundleContainingPtr;
+			const Storm::NeighborParticleReferralBundle* outLinkedNeighborBundle[Storm::k_neighborLinkedBunkCount];
+
+			const auto allBundlesOf = [&bundleContainingPtr, &outLinkedNeighborBundle](const auto &predicate)
+			{
+				if (!predicate(*bundleContainingPtr))
+				{
+					return false;
+				}
+
+				for (const Storm::NeighborParticleReferralBundle** linkedNeighborReferralsIter = outLinkedNeighborBundle; *linkedNeighborReferralsIter != nullptr; ++linkedNeighborReferralsIter)
+				{
+					if (!predicate(**linkedNeighborReferralsIter))
+					{
+						return false;
+					}
+				}
+
+				return true;
+			};
+
+			// All particles from the fluid partition around should be frozen...
+			spacePartitionerMgr.getAllBundles(bundleContainingPtr, outLinkedNeighborBundle, currentPPosition, Storm::PartitionSelection::Fluid);
+			isFrozen = allBundlesOf([this, &isFrozenReferral](const Storm::NeighborParticleReferralBundle &bundle)
+			{
+				return bundle.empty() || (isFrozenReferral(bundle.front()) && _frozenVoxels[bundle.front()._particleIndex] != 0);
+			});
+
+			// ... and no dynamic rigid body should be around (the static ones don't move).
+			if (isFrozen)
+			{
+				spacePartitionerMgr.getAllBundles(bundleContainingPtr, outLinkedNeighborBundle, currentPPosition, Storm::PartitionSelection::DynamicRigidBody);
+				isFrozen = allBundlesOf([](const Storm::NeighborParticleReferralBundle &bundle)
+				{
+					return bundle.empty();
+				});
+			}
+		}
+
+		currentPFrozen = static_cast<uint8_t>(isFrozen);
+	});
+}
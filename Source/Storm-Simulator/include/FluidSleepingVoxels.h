@@ -0,0 +1,43 @@
+#pragma once
+
+#include "NeighborParticleReferralBundle.h"
+
+
+namespace Storm
+{
+	class ISpacePartitionerManager;
+
+	// The fluid partition voxel decisions of the fluid sleeping (see Storm::FluidParticleSystem::updateSleeping and Storm::FluidParticleSystem::computeKeptNeighborhoods).
+	// They only depend on the space partition and on the per particle arrays they're given, so they can be checked without a whole particle system.
+	class FluidSleepingVoxels
+	{
+	public:
+		FluidSleepingVoxels();
+		~FluidSleepingVoxels();
+
+	public:
+		// Sets outSleeping to 1 for the particles of the fluid systemId whose fluid partition voxel only contains particles of this fluid that stayed quiet for sleepingStepCount steps, to 0 for the others.
+		// The voxels containing particles of other fluids only sleep if the particles of this fluid inside are quiet. outSleeping should already be sized to the particle count.
+		void computeSleepingParticles(const Storm::ISpacePartitionerManager &spacePartitionerMgr, const unsigned int systemId, const std::vector<uint16_t> &quietStepCounts, const uint16_t sleepingStepCount, std::vector<uint8_t> &outSleeping);
+
+		// Sets outFrozen to 1 for the sleeping particles that nothing around can move : the fluid partition voxels around them only contain sleeping particles of the same fluid, and there is no dynamic rigid body around. 0 for the others.
+		// Doesn't handle the infinite domain. outFrozen should already be sized to the particle count.
+		void computeFrozenParticles(const Storm::ISpacePartitionerManager &spacePartitionerMgr, const unsigned int systemId, const std::vector<Storm::Vector3> &positions, const std::vector<uint8_t> &sleeping, std::vector<uint8_t> &outFrozen);
+
+	public:
+		// A particle keeps its previous neighborhood only if it is still exact : it was built while everything that could be its neighbor was frozen (inOutFrozenNeighborhood, updated for the next build), and everything still is.
+		static __forceinline uint8_t keepsNeighborhood(const bool isFrozen, uint8_t &inOutFrozenNeighborhood)
+		{
+			const uint8_t result = static_cast<uint8_t>(isFrozen && inOutFrozenNeighborhood != 0);
+			inOutFrozenNeighborhood = static_cast<uint8_t>(isFrozen);
+			return result;
+		}
+
+	private:
+		// The fluid partition voxels, kept to not reallocate them at each step.
+		std::vector<Storm::NeighborParticleReferralBundle> _bundles;
+
+		// Per particle, 1 if its fluid partition voxel only contains sleeping particles of this fluid.
+		std::vector<uint8_t> _frozenVoxels;
+	};
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "CRTPHierarchy.h"
+#include "NeighborParticleReferralBundle.h"
 
 
 namespace Storm
@@ -19,6 +20,15 @@ namespace Storm
 		virtual void setTime(float timeSec) = 0;
 		virtual void applyForce(const Storm::Vector3 &inParticlePosition, Storm::Vector3 &inOutParticleForce) const = 0;
 
+		// Same as applyForce, but for all particles of the bundle that belong to the particle system systemId (the other are skipped). The particle index inside the bundle is the index inside inParticlePositions and inOutParticleForces.
+		virtual void applyForces(const std::vector<Storm::Vector3> &inParticlePositions, const Storm::NeighborParticleReferralBundle &bundle, const unsigned int systemId, std::vector<Storm::Vector3> &inOutParticleForces) const = 0;
+
+		// Returns false if the blower doesn't apply any force right now, therefore there is no need to look for the particles it would affect.
+		virtual bool isBlowing() const = 0;
+
+		// The world axis aligned bounding box of the effect area. A particle outside it is never affected by the blower.
+		virtual void getEffectAreaBoundingBox(Storm::Vector3 &outMinCorner, Storm::Vector3 &outMaxCorner) const = 0;
+
 		virtual bool operator==(const std::size_t id) const = 0;
 		virtual bool operator<(const std::size_t id) const = 0;
 
@@ -57,7 +57,7 @@ namespace
 
 
 	template<Storm::ViscosityMethod viscosityMethodOnFluid, Storm::ViscosityMethod viscosityMethodOnRigidBody>
-	Storm::Vector3 computeViscosity(const Storm::IterationParameter &iterationParameter, const Storm::SceneFluidConfig &fluidConfig, const Storm::FluidParticleSystem &fluidParticleSystem, const float currentPMass, const Storm::Vector3 &vi, const Storm::ParticleNeighborhoodArray &currentPNeighborhood, const float currentPDensity, const float viscoPrecoeff)
+	Storm::Vector3 computeViscosity(const Storm::IterationParameter &iterationParameter, const Storm::SceneFluidConfig &fluidConfig, const Storm::FluidParticleSystem &fluidParticleSystem, const float currentPMass, const Storm::Vector3 &vi, const Storm::ParticleNeighborhoodArray &currentPNeighborhood, const float currentPDensity, const float viscoPrecoeff, Storm::RigidBodyReactionAccumulator::Chunk &rbReactions)
 	{
 		Storm::Vector3 totalViscosityForceOnParticle = Storm::Vector3::Zero();
 
@@ -126,8 +126,7 @@ namespace
 				{
 					Storm::Vector3 &boundaryNeighborTmpViscosityForce = neighbor._containingParticleSystem->getTemporaryViscosityForces()[neighbor._particleIndex];
 
-					std::lock_guard<std::mutex> lock{ neighbor._containingParticleSystem->_mutex };
-					boundaryNeighborTmpViscosityForce -= viscosityComponent;
+					rbReactions.subtract(boundaryNeighborTmpViscosityForce, viscosityComponent);
 				}
 			}
 
@@ -155,6 +154,11 @@ Storm::IISPHSolver::IISPHSolver(const float /*k_kernelLength*/, const Storm::Par
 			currentPSystemData.reserve(currentPSystemPCount._newSize);
 			Storm::setNumUninitialized_hijack(currentPSystemData, currentPSystemPCount);
 
+			Storm::runParallel(currentPSystemData, [](Storm::IISPHSolverData &currentPData)
+			{
+				currentPData._warmStartPressure = 0.f;
+			});
+
 			totalParticleCount += currentPSystemPCount._newSize;
 		}
 	}
@@ -186,6 +190,7 @@ void Storm::IISPHSolver::execute(const Storm::IterationParameter &iterationParam
 	unsigned int currentPredictionIter = 0;
 
 	const float deltaTimeSquared = iterationParameter._deltaTime * iterationParameter._deltaTime;
+	const float invDeltaTimeSquared = 1.f / deltaTimeSquared;
 
 	Storm::ParticleSystemContainer &particleSystems = *iterationParameter._particleSystems;
 
@@ -209,7 +214,7 @@ void Storm::IISPHSolver::execute(const Storm::IterationParameter &iterationParam
 
 			const float particleVolume = fluidParticleSystem.getParticleVolume();
 			const float density0 = fluidParticleSystem.getRestDensity();
-			const std::vector<Storm::ParticleNeighborhoodArray> &neighborhoodArrays = fluidParticleSystem.getNeighborhoodArrays();
+			const Storm::ParticleNeighborhoodStorage &neighborhoodArrays = fluidParticleSystem.getNeighborhoodArrays();
 			std::vector<float> &masses = fluidParticleSystem.getMasses();
 
 			Storm::runParallel(fluidParticleSystem.getDensities(), [&](float &currentPDensity, const std::size_t currentPIndex)
@@ -217,7 +222,7 @@ void Storm::IISPHSolver::execute(const Storm::IterationParameter &iterationParam
 				// Density
 				currentPDensity = particleVolume * k_kernelZero;
 
-				const Storm::ParticleNeighborhoodArray &currentPNeighborhood = neighborhoodArrays[currentPIndex];
+				const Storm::ParticleNeighborhoodArray currentPNeighborhood = neighborhoodArrays[currentPIndex];
 				for (const Storm::NeighborParticleInfo &neighbor : currentPNeighborhood)
 				{
 					float deltaDensity;
@@ -254,7 +259,7 @@ void Storm::IISPHSolver::execute(const Storm::IterationParameter &iterationParam
 		{
 			Storm::FluidParticleSystem &fluidParticleSystem = static_cast<Storm::FluidParticleSystem &>(currentParticleSystem);
 
-			const std::vector<Storm::ParticleNeighborhoodArray> &neighborhoodArrays = currentParticleSystem.getNeighborhoodArrays();
+			const Storm::ParticleNeighborhoodStorage &neighborhoodArrays = currentParticleSystem.getNeighborhoodArrays();
 			std::vector<float> &masses = fluidParticleSystem.getMasses();
 			const std::vector<float> &densities = fluidParticleSystem.getDensities();
 			std::vector<Storm::Vector3> &temporaryPViscoForces = fluidParticleSystem.getTemporaryViscosityForces();
@@ -265,7 +270,7 @@ void Storm::IISPHSolver::execute(const Storm::IterationParameter &iterationParam
 
 			std::vector<Storm::IISPHSolverData> &dataField = _data.find(particleSystemPair.first)->second;
 
-			Storm::runParallel(fluidParticleSystem.getForces(), [&](Storm::Vector3 &currentPForce, const std::size_t currentPIndex)
+			_rbReactionAccumulator.runParallel(fluidParticleSystem.getForces(), [&](Storm::Vector3 &currentPForce, const std::size_t currentPIndex, Storm::RigidBodyReactionAccumulator::Chunk &rbReactions)
 			{
 				const float currentPMass = masses[currentPIndex];
 				const float currentPDensity = densities[currentPIndex];
@@ -273,10 +278,11 @@ void Storm::IISPHSolver::execute(const Storm::IterationParameter &iterationParam
 
 				Storm::Vector3 &currentPTmpViscoForce = temporaryPViscoForces[currentPIndex];
 
-				const Storm::ParticleNeighborhoodArray &currentPNeighborhood = neighborhoodArrays[currentPIndex];
+				// Sleeping particles are frozen, their non pressure forces are null.
+				const Storm::ParticleNeighborhoodArray currentPNeighborhood = fluidParticleSystem.isParticleSleeping(currentPIndex) ? neighborhoodArrays.getEmptyNeighborhood(currentPIndex) : neighborhoodArrays[currentPIndex];
 
 #define STORM_COMPUTE_VISCOSITY(fluidMethod, rbMethod) \
-	computeViscosity<fluidMethod, rbMethod>(iterationParameter, fluidConfig, fluidParticleSystem, currentPMass, vi, currentPNeighborhood, currentPDensity, viscoPrecoeff)
+	computeViscosity<fluidMethod, rbMethod>(iterationParameter, fluidConfig, fluidParticleSystem, currentPMass, vi, currentPNeighborhood, currentPDensity, viscoPrecoeff, rbReactions)
 
 				switch (sceneSimulationConfig._fluidViscoMethod)
 				{
@@ -323,11 +329,11 @@ void Storm::IISPHSolver::execute(const Storm::IterationParameter &iterationParam
 
 					if (fluidConfig._uniformDragCoefficient > 0.f)
 					{
-						currentPTmpDragForceComponent = Storm::SPHSolverUtils::computeSumDragForce<true>(iterationParameter, fluidConfig._uniformDragCoefficient, fluidParticleSystem, vi, currentPNeighborhood, currentPDensity);
+						currentPTmpDragForceComponent = Storm::SPHSolverUtils::computeSumDragForce<true>(iterationParameter, fluidConfig._uniformDragCoefficient, fluidParticleSystem, vi, currentPNeighborhood, currentPDensity, rbReactions);
 					}
 					else
 					{
-						currentPTmpDragForceComponent = Storm::SPHSolverUtils::computeSumDragForce<false>(iterationParameter, fluidConfig._uniformDragCoefficient, fluidParticleSystem, vi, currentPNeighborhood, currentPDensity);
+						currentPTmpDragForceComponent = Storm::SPHSolverUtils::computeSumDragForce<false>(iterationParameter, fluidConfig._uniformDragCoefficient, fluidParticleSystem, vi, currentPNeighborhood, currentPDensity, rbReactions);
 					}
 
 					currentPForce += currentPTmpDragForceComponent;
@@ -357,7 +363,7 @@ void Storm::IISPHSolver::execute(const Storm::IterationParameter &iterationParam
 		Storm::FluidParticleSystem &fluidParticleSystem = static_cast<Storm::FluidParticleSystem &>(*particleSystems.find(dataFieldPair.first)->second);
 
 		const std::vector<float> &densities = fluidParticleSystem.getDensities();
-		const std::vector<Storm::ParticleNeighborhoodArray> &neighborhoodArrays = fluidParticleSystem.getNeighborhoodArrays();
+		const Storm::ParticleNeighborhoodStorage &neighborhoodArrays = fluidParticleSystem.getNeighborhoodArrays();
 		std::vector<float> &pressures = fluidParticleSystem.getPressures();
 
 		const float density0 = fluidParticleSystem.getRestDensity();
@@ -366,7 +372,7 @@ void Storm::IISPHSolver::execute(const Storm::IterationParameter &iterationParam
 
 		Storm::runParallel(dataFieldPair.second, [&](Storm::IISPHSolverData &currentPData, const std::size_t currentPIndex)
 		{
-			const Storm::ParticleNeighborhoodArray &currentPNeighborhood = neighborhoodArrays[currentPIndex];
+			const Storm::ParticleNeighborhoodArray currentPNeighborhood = neighborhoodArrays[currentPIndex];
 
 			// Compute d_ii
 			const float currentPDensityRatio = densities[currentPIndex] / density0;
@@ -437,9 +443,17 @@ void Storm::IISPHSolver::execute(const Storm::IterationParameter &iterationParam
 			// Init pressures
 			float &currentPPressure = pressures[currentPIndex];
 
-			// From the original 2014 article (the one written by Ihmsen, not the tutorial). IISPH initialized the pressure to 0.5 of the pressure from last simulation step.
-			// It was an empirical value motivated by greater convergence, the downside than the nearest it is from 0, the slower the convergence would get.
-			currentPPressure *= fluidConfig._pressureInitRelaxationCoefficient;
+			if (sceneIisphFluidConfig._enableWarmStart)
+			{
+				// Warm start from the whole pressure the last step ended with.
+				currentPPressure = currentPData._warmStartPressure * invDeltaTimeSquared;
+			}
+			else
+			{
+				// From the original 2014 article (the one written by Ihmsen, not the tutorial). IISPH initialized the pressure to 0.5 of the pressure from last simulation step.
+				// It was an empirical value motivated by greater convergence, the downside than the nearest it is from 0, the slower the convergence would get.
+				currentPPressure *= fluidConfig._pressureInitRelaxationCoefficient;
+			}
 
 			currentPData._diiP = currentPData._dii * currentPPressure;
 		});
@@ -464,11 +478,11 @@ void Storm::IISPHSolver::execute(const Storm::IterationParameter &iterationParam
 			// Since data field was made from fluids particles only, no need to check if this is a fluid.
 			const Storm::FluidParticleSystem &fluidParticleSystem = static_cast<const Storm::FluidParticleSystem &>(*particleSystems.find(dataFieldPair.first)->second);
 
-			const std::vector<Storm::ParticleNeighborhoodArray> &neighborhoodArrays = fluidParticleSystem.getNeighborhoodArrays();
+			const Storm::ParticleNeighborhoodStorage &neighborhoodArrays = fluidParticleSystem.getNeighborhoodArrays();
 
 			Storm::runParallel(dataFieldPair.second, [&](Storm::IISPHSolverData &currentPData, const std::size_t currentPIndex)
 			{
-				const Storm::ParticleNeighborhoodArray &currentPNeighborhood = neighborhoodArrays[currentPIndex];
+				const Storm::ParticleNeighborhoodArray currentPNeighborhood = neighborhoodArrays[currentPIndex];
 
 				currentPData._dijPj.setZero();
 
@@ -503,17 +517,15 @@ void Storm::IISPHSolver::execute(const Storm::IterationParameter &iterationParam
 
 			const std::vector<float> &densities = fluidParticleSystem.getDensities();
 			const std::vector<float> &pressures = fluidParticleSystem.getPressures();
-			const std::vector<Storm::ParticleNeighborhoodArray> &neighborhoodArrays = fluidParticleSystem.getNeighborhoodArrays();
+			const Storm::ParticleNeighborhoodStorage &neighborhoodArrays = fluidParticleSystem.getNeighborhoodArrays();
 
 			const float currentPSystemDensity0 = fluidParticleSystem.getRestDensity();
 
-			std::atomic<float> densityErrorAccu = 0.f;
-
-			Storm::runParallel(dataFieldPair.second, [&](Storm::IISPHSolverData &currentPData, const std::size_t currentPIndex)
+			const Storm::ParallelReduceResult densityErrorResult = Storm::reduceChunkedParallel(dataFieldPair.second, [&](Storm::IISPHSolverData &currentPData, const std::size_t currentPIndex, Storm::ParallelReduceResult &chunkResult)
 			{
 				const float &currentPPressure = pressures[currentPIndex];
 				const float &currentPDensity = densities[currentPIndex];
-				const Storm::ParticleNeighborhoodArray &currentPNeighborhood = neighborhoodArrays[currentPIndex];
+				const Storm::ParticleNeighborhoodArray currentPNeighborhood = neighborhoodArrays[currentPIndex];
 
 				const float currentPSystemDensityRatio = currentPDensity / currentPSystemDensity0;
 				const float dpi = currentPPressure * fluidParticleSystem.getParticleVolume() / (currentPSystemDensityRatio * currentPSystemDensityRatio);
@@ -563,7 +575,7 @@ void Storm::IISPHSolver::execute(const Storm::IterationParameter &iterationParam
 					if (currentPData._predictedPressure > 0.f)
 					{
 						const float densityErrorAdded = currentPSystemDensity0 * ((currentPData._aii * currentPData._predictedPressure + tmpSum) * deltaTimeSquared - densityAdvectionReverse);
-						densityErrorAccu += densityErrorAdded;
+						chunkResult._sum += densityErrorAdded;
 					}
 					else
 					{
@@ -576,7 +588,7 @@ void Storm::IISPHSolver::execute(const Storm::IterationParameter &iterationParam
 				}
 			});
 
-			averageDensityError += densityErrorAccu;
+			averageDensityError += densityErrorResult._sum;
 		}
 
 		averageDensityError /= _totalParticleCountFl;
@@ -617,6 +629,20 @@ void Storm::IISPHSolver::execute(const Storm::IterationParameter &iterationParam
 		return;
 	}
 
+	if (sceneIisphFluidConfig._enableWarmStart)
+	{
+		for (auto &dataFieldPair : _data)
+		{
+			// Since data field was made from fluids particles only, no need to check if this is a fluid.
+			const std::vector<float> &pressures = static_cast<const Storm::FluidParticleSystem &>(*particleSystems.find(dataFieldPair.first)->second).getPressures();
+
+			Storm::runParallel(dataFieldPair.second, [&pressures, deltaTimeSquared](Storm::IISPHSolverData &currentPData, const std::size_t currentPIndex)
+			{
+				currentPData._warmStartPressure = pressures[currentPIndex] * deltaTimeSquared;
+			});
+		}
+	}
+
 	// 6th : Compute the pressure force
 	for (auto &dataFieldPair : _data)
 	{
@@ -626,11 +652,11 @@ void Storm::IISPHSolver::execute(const Storm::IterationParameter &iterationParam
 		const std::vector<float> &densities = fluidParticleSystem.getDensities();
 		const std::vector<float> &pressures = fluidParticleSystem.getPressures();
 		const float currentPSystemDensity0 = fluidParticleSystem.getRestDensity();
-		const std::vector<Storm::ParticleNeighborhoodArray> &neighborhoodArrays = fluidParticleSystem.getNeighborhoodArrays();
+		const Storm::ParticleNeighborhoodStorage &neighborhoodArrays = fluidParticleSystem.getNeighborhoodArrays();
 
-		Storm::runParallel(dataFieldPair.second, [&](Storm::IISPHSolverData &currentPData, const std::size_t currentPIndex)
+		_rbReactionAccumulator.runParallel(dataFieldPair.second, [&](Storm::IISPHSolverData &currentPData, const std::size_t currentPIndex, Storm::RigidBodyReactionAccumulator::Chunk &rbReactions)
 		{
-			const Storm::ParticleNeighborhoodArray &currentPNeighborhood = neighborhoodArrays[currentPIndex];
+			const Storm::ParticleNeighborhoodArray currentPNeighborhood = neighborhoodArrays[currentPIndex];
 			const float currentPDensity = densities[currentPIndex];
 
 			currentPData._nonPressureAcceleration.setZero();
@@ -667,8 +693,7 @@ void Storm::IISPHSolver::execute(const Storm::IterationParameter &iterationParam
 
 						Storm::Vector3 &tmpPressureForce = neighborPSystemAsRb.getTemporaryPressureForces()[neighborInfo._particleIndex];
 
-						std::lock_guard<std::mutex> lock{ neighborPSystemAsRb._mutex };
-						tmpPressureForce += pressureForceOnRb;
+						rbReactions.add(tmpPressureForce, pressureForceOnRb);
 					}
 				}
 
@@ -692,13 +717,12 @@ void Storm::IISPHSolver::execute(const Storm::IterationParameter &iterationParam
 		std::vector<Storm::Vector3> &positions = fluidParticleSystem.getPositions();
 		std::vector<Storm::Vector3> &tmpPressureForces = fluidParticleSystem.getTemporaryPressureForces();
 
-		std::atomic<bool> dirtyTmp = false;
 #pragma warning (push)
 #pragma warning (disable: 4189) // It is being used, but the compiler isn't able to tell until it compiles it
 		constexpr const float minForceDirtyEpsilon = 0.0001f;
 #pragma warning (pop)
 
-		Storm::runParallel(dataField, [&](const Storm::IISPHSolverData &currentPData, const std::size_t currentPIndex)
+		const Storm::ParallelReduceResult integrationResult = Storm::reduceChunkedParallel(dataField, [&](const Storm::IISPHSolverData &currentPData, const std::size_t currentPIndex, Storm::ParallelReduceResult &chunkResult)
 		{
 			const float currentPMass = masses[currentPIndex];
 			forces[currentPIndex] = currentPData._predictedAcceleration * currentPMass;
@@ -711,7 +735,7 @@ void Storm::IISPHSolver::execute(const Storm::IterationParameter &iterationParam
 			currentPVelocity += currentPData._predictedAcceleration * iterationParameter._deltaTime;
 			currentPPositions += currentPVelocity * iterationParameter._deltaTime;
 
-			if (!dirtyTmp)
+			if (!chunkResult._flag)
 			{
 				if (
 					std::fabs(currentPVelocity.x()) > minForceDirtyEpsilon ||
@@ -719,12 +743,12 @@ void Storm::IISPHSolver::execute(const Storm::IterationParameter &iterationParam
 					std::fabs(currentPVelocity.z()) > minForceDirtyEpsilon
 					)
 				{
-					dirtyTmp = true;
+					chunkResult._flag = true;
 				}
 			}
 		});
 
-		fluidParticleSystem.setIsDirty(dirtyTmp);
+		fluidParticleSystem.setIsDirty(integrationResult._flag);
 	});
 
 	// 7th : flush physics state (rigid bodies)
@@ -735,3 +759,20 @@ void Storm::IISPHSolver::removeRawEndData(const unsigned int pSystemId, std::siz
 {
 	Storm::SPHSolverUtils::removeRawEndData(pSystemId, toRemoveCount, _data);
 }
+
+void Storm::IISPHSolver::reorderParticleData(const unsigned int pSystemId, const std::vector<std::size_t> &newToOldIndexes)
+{
+	Storm::SPHSolverUtils::reorderData(pSystemId, newToOldIndexes, _data);
+}
+
+void Storm::IISPHSolver::compactParticleData(const unsigned int pSystemId, const Storm::ParticleCompaction &compaction)
+{
+	Storm::SPHSolverUtils::compactData(pSystemId, compaction, _data);
+	_totalParticleCountFl -= static_cast<float>(compaction.getRemovedCount());
+}
+
+void Storm::IISPHSolver::appendRawEndData(const unsigned int pSystemId, std::size_t toAddCount)
+{
+	Storm::SPHSolverUtils::appendRawEndData(pSystemId, toAddCount, _data);
+	_totalParticleCountFl += static_cast<float>(toAddCount);
+}
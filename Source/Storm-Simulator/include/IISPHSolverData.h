@@ -12,6 +12,7 @@ namespace Storm
 		Storm::Vector3 _predictedVelocity;
 
 		float _predictedPressure;
+		float _warmStartPressure; // Pressure the last step ended with, multiplied by the squared time step to stay valid if it changes.
 
 		float _advectedDensity;
 		float _aii;
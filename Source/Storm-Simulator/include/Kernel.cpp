@@ -4,6 +4,120 @@
 #include "Kernel.h"
 #include "KernelMode.h"
 
+#include "InstructionSet.h"
+
+
+namespace
+{
+	Storm::SIMDUsageMode retrieveKernelBatchSIMDUsageMode()
+	{
+		static const Storm::SIMDUsageMode k_simdMode =
+			Storm::InstructionSet::AVX512F() ? Storm::SIMDUsageMode::AVX512 :
+			(Storm::InstructionSet::AVX2() && Storm::InstructionSet::FMA()) ? Storm::SIMDUsageMode::AVX2 :
+			Storm::SIMDUsageMode::SISD
+			;
+
+		return k_simdMode;
+	}
+
+	// Both kernels are the same cubic spline, only their precoefficients differ.
+	// The SIMD version evaluates both parts of the spline (q < 0.5 and q >= 0.5) and keeps the right one with a masked blend instead of branching per neighbor.
+	template<class KernelType, Storm::SIMDUsageMode simdMode>
+	void computeCubicSplineNeighborhood(const float rawPrecoeff, const float gradientPrecoeff, const float kernelLength, Storm::ParticleNeighborhoodBuildArray &inOutNeighborhood)
+	{
+		const std::size_t neighborCount = inOutNeighborhood.size();
+		std::size_t iter = 0;
+
+		if constexpr (simdMode == Storm::SIMDUsageMode::AVX512 || simdMode == Storm::SIMDUsageMode::AVX2)
+		{
+			enum : std::size_t
+			{
+				k_laneCount = simdMode == Storm::SIMDUsageMode::AVX512 ? 16 : 8
+			};
+
+			alignas(64) float norms[k_laneCount];
+			alignas(64) float wij[k_laneCount];
+			alignas(64) float gradCoeffs[k_laneCount];
+
+			const float invKernelLength = 1.f / kernelLength;
+
+			for (; iter + k_laneCount <= neighborCount; iter += k_laneCount)
+			{
+				Storm::NeighborParticleInfo*const neighbors = inOutNeighborhood.data() + iter;
+				for (std::size_t lane = 0; lane < k_laneCount; ++lane)
+				{
+					norms[lane] = neighbors[lane]._xijNorm;
+				}
+
+				if constexpr (simdMode == Storm::SIMDUsageMode::AVX512)
+				{
+					const __m512 one = _mm512_set1_ps(1.f);
+					const __m512 norm = _mm512_load_ps(norms);
+					const __m512 q = _mm512_mul_ps(norm, _mm512_set1_ps(invKernelLength));
+					const __m512 oneMinusQ = _mm512_sub_ps(one, q);
+					const __m512 oneMinusQSquared = _mm512_mul_ps(oneMinusQ, oneMinusQ);
+					const __mmask16 isNear = _mm512_cmp_ps_mask(q, _mm512_set1_ps(0.5f), _CMP_LT_OQ);
+
+					// Raw : 6q^2(q - 1) + 1 when near, 2(1 - q)^3 otherwise.
+					const __m512 nearRaw = _mm512_fmadd_ps(_mm512_mul_ps(_mm512_set1_ps(6.f), _mm512_mul_ps(q, q)), _mm512_sub_ps(q, one), one);
+					const __m512 farRaw = _mm512_mul_ps(_mm512_set1_ps(2.f), _mm512_mul_ps(oneMinusQSquared, oneMinusQ));
+					_mm512_store_ps(wij, _mm512_mul_ps(_mm512_set1_ps(rawPrecoeff), _mm512_mask_blend_ps(isNear, farRaw, nearRaw)));
+
+					// Gradient : q(3q - 2) when near, -(1 - q)^2 otherwise. Divided by the norm since it multiplies xij.
+					const __m512 nearGrad = _mm512_mul_ps(q, _mm512_fmsub_ps(_mm512_set1_ps(3.f), q, _mm512_set1_ps(2.f)));
+					const __m512 farGrad = _mm512_sub_ps(_mm512_setzero_ps(), oneMinusQSquared);
+					_mm512_store_ps(gradCoeffs, _mm512_div_ps(_mm512_mul_ps(_mm512_set1_ps(gradientPrecoeff), _mm512_mask_blend_ps(isNear, farGrad, nearGrad)), norm));
+				}
+				else
+				{
+					const __m256 one = _mm256_set1_ps(1.f);
+					const __m256 norm = _mm256_load_ps(norms);
+					const __m256 q = _mm256_mul_ps(norm, _mm256_set1_ps(invKernelLength));
+					const __m256 oneMinusQ = _mm256_sub_ps(one, q);
+					const __m256 oneMinusQSquared = _mm256_mul_ps(oneMinusQ, oneMinusQ);
+					const __m256 isNear = _mm256_cmp_ps(q, _mm256_set1_ps(0.5f), _CMP_LT_OQ);
+
+					// Raw : 6q^2(q - 1) + 1 when near, 2(1 - q)^3 otherwise.
+					const __m256 nearRaw = _mm256_fmadd_ps(_mm256_mul_ps(_mm256_set1_ps(6.f), _mm256_mul_ps(q, q)), _mm256_sub_ps(q, one), one);
+					const __m256 farRaw = _mm256_mul_ps(_mm256_set1_ps(2.f), _mm256_mul_ps(oneMinusQSquared, oneMinusQ));
+					_mm256_store_ps(wij, _mm256_mul_ps(_mm256_set1_ps(rawPrecoeff), _mm256_blendv_ps(farRaw, nearRaw, isNear)));
+
+					// Gradient : q(3q - 2) when near, -(1 - q)^2 otherwise. Divided by the norm since it multiplies xij.
+					const __m256 nearGrad = _mm256_mul_ps(q, _mm256_fmsub_ps(_mm256_set1_ps(3.f), q, _mm256_set1_ps(2.f)));
+					const __m256 farGrad = _mm256_sub_ps(_mm256_setzero_ps(), oneMinusQSquared);
+					_mm256_store_ps(gradCoeffs, _mm256_div_ps(_mm256_mul_ps(_mm256_set1_ps(gradientPrecoeff), _mm256_blendv_ps(farGrad, nearGrad, isNear)), norm));
+				}
+
+				for (std::size_t lane = 0; lane < k_laneCount; ++lane)
+				{
+					Storm::NeighborParticleInfo &neighbor = neighbors[lane];
+					neighbor._Wij = wij[lane];
+					neighbor._gradWij = neighbor._xij * gradCoeffs[lane];
+				}
+			}
+		}
+
+		// Remaining neighbors (or all of them without SIMD).
+		for (; iter < neighborCount; ++iter)
+		{
+			Storm::NeighborParticleInfo &neighbor = inOutNeighborhood[iter];
+			neighbor._Wij = KernelType::raw(kernelLength, neighbor._xijNorm);
+			neighbor._gradWij = KernelType::gradient(kernelLength, neighbor._xij, neighbor._xijNorm);
+		}
+	}
+
+	template<class KernelType>
+	Storm::KernelBatchMethodDelegate retrieveKernelBatchMethodForCurrentCPU()
+	{
+		switch (retrieveKernelBatchSIMDUsageMode())
+		{
+		case Storm::SIMDUsageMode::AVX512: return KernelType::template computeNeighborhood<Storm::SIMDUsageMode::AVX512>;
+		case Storm::SIMDUsageMode::AVX2: return KernelType::template computeNeighborhood<Storm::SIMDUsageMode::AVX2>;
+		default: return KernelType::template computeNeighborhood<Storm::SIMDUsageMode::SISD>;
+		}
+	}
+}
+
 
 float Storm::CubicSplineKernel::s_rawPrecoeff = 0.f;
 float Storm::CubicSplineKernel::s_gradientPrecoeff = 0.f;
@@ -61,6 +175,12 @@ float Storm::CubicSplineKernel::zeroValue()
 	return s_kernelZero;
 }
 
+template<Storm::SIMDUsageMode simdMode>
+void Storm::CubicSplineKernel::computeNeighborhood(const float k_kernelLength, Storm::ParticleNeighborhoodBuildArray &inOutNeighborhood)
+{
+	computeCubicSplineNeighborhood<Storm::CubicSplineKernel, simdMode>(s_rawPrecoeff, s_gradientPrecoeff, k_kernelLength, inOutNeighborhood);
+}
+
 void Storm::SplishSplashCubicSplineKernel::initialize(const float kernelLength)
 {
 	constexpr float k_constexprRawPrecoeffCoeff = static_cast<float>(8.0 / M_PI);
@@ -109,6 +229,20 @@ float Storm::SplishSplashCubicSplineKernel::zeroValue()
 	return s_kernelZero;
 }
 
+template<Storm::SIMDUsageMode simdMode>
+void Storm::SplishSplashCubicSplineKernel::computeNeighborhood(const float k_kernelLength, Storm::ParticleNeighborhoodBuildArray &inOutNeighborhood)
+{
+	computeCubicSplineNeighborhood<Storm::SplishSplashCubicSplineKernel, simdMode>(s_rawPrecoeff, s_gradientPrecoeff, k_kernelLength, inOutNeighborhood);
+}
+
+// Explicitly instantiated for each SIMD mode, so one can be called directly whatever the CPU (the tests compare them).
+template void Storm::CubicSplineKernel::computeNeighborhood<Storm::SIMDUsageMode::SISD>(const float, Storm::ParticleNeighborhoodBuildArray &);
+template void Storm::CubicSplineKernel::computeNeighborhood<Storm::SIMDUsageMode::AVX2>(const float, Storm::ParticleNeighborhoodBuildArray &);
+template void Storm::CubicSplineKernel::computeNeighborhood<Storm::SIMDUsageMode::AVX512>(const float, Storm::ParticleNeighborhoodBuildArray &);
+template void Storm::SplishSplashCubicSplineKernel::computeNeighborhood<Storm::SIMDUsageMode::SISD>(const float, Storm::ParticleNeighborhoodBuildArray &);
+template void Storm::SplishSplashCubicSplineKernel::computeNeighborhood<Storm::SIMDUsageMode::AVX2>(const float, Storm::ParticleNeighborhoodBuildArray &);
+template void Storm::SplishSplashCubicSplineKernel::computeNeighborhood<Storm::SIMDUsageMode::AVX512>(const float, Storm::ParticleNeighborhoodBuildArray &);
+
 void Storm::initializeKernels(const float kernelLength)
 {
 	Storm::CubicSplineKernel::initialize(kernelLength);
@@ -137,6 +271,17 @@ Storm::GradKernelMethodDelegate Storm::retrieveGradKernelMethod(const Storm::Ker
 	Storm::throwException<Storm::Exception>("Unknown kernel mode!");
 }
 
+Storm::KernelBatchMethodDelegate Storm::retrieveKernelBatchMethod(const Storm::KernelMode kernelMode)
+{
+	switch (kernelMode)
+	{
+	case Storm::KernelMode::CubicSpline: return retrieveKernelBatchMethodForCurrentCPU<Storm::CubicSplineKernel>();
+	case Storm::KernelMode::SplishSplashCubicSpline: return retrieveKernelBatchMethodForCurrentCPU<Storm::SplishSplashCubicSplineKernel>();
+	}
+
+	Storm::throwException<Storm::Exception>("Unknown kernel mode!");
+}
+
 float Storm::retrieveKernelZeroValue(const Storm::KernelMode kernelMode)
 {
 	switch (kernelMode)
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "NeighborParticleInfo.h"
+
 namespace Storm
 {
 	enum class KernelMode;
@@ -7,9 +9,15 @@ namespace Storm
 	using RawKernelMethodDelegate = float(*)(const float k_kernelLength, const float norm);
 	using GradKernelMethodDelegate = Storm::Vector3(*)(const float k_kernelLength, const Storm::Vector3 &vectToNeighbor, const float norm);
 
+	// Fills Wij and gradWij of all neighbors of a neighborhood at once.
+	using KernelBatchMethodDelegate = void(*)(const float k_kernelLength, Storm::ParticleNeighborhoodBuildArray &inOutNeighborhood);
+
 	void initializeKernels(const float kernelLength);
 
 	Storm::RawKernelMethodDelegate retrieveRawKernelMethod(const Storm::KernelMode kernelMode);
 	Storm::GradKernelMethodDelegate retrieveGradKernelMethod(const Storm::KernelMode kernelMode);
+
+	// The returned method is the one instantiated for the kernel mode and the best SIMD instruction set the CPU supports.
+	Storm::KernelBatchMethodDelegate retrieveKernelBatchMethod(const Storm::KernelMode kernelMode);
 	float retrieveKernelZeroValue(const Storm::KernelMode kernelMode);
 }
@@ -7,6 +7,7 @@ namespace Storm
 
 	// Just a structure to identify and retrieve the particle (neighborhood) from the data oriented architecture we took.
 	// It has some data we had when we build the neighborhood to help us not recomping them again.
+	// Note : This is what the neighbor search fills, but it isn't what we store. The neighborhood storage keeps a compact version of it and rebuild it on the fly when iterating (see ParticleNeighborhoodStorage).
 	struct NeighborParticleInfo
 	{
 	public:
@@ -49,5 +50,6 @@ namespace Storm
 		Storm::Vector3 _gradWij;
 	};
 
-	using ParticleNeighborhoodArray = std::vector<Storm::NeighborParticleInfo>;
+	// The neighborhood of one particle, as filled by the neighbor search before being packed inside the neighborhood storage.
+	using ParticleNeighborhoodBuildArray = std::vector<Storm::NeighborParticleInfo>;
 }
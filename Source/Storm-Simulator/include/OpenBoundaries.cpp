@@ -0,0 +1,212 @@
+#include "OpenBoundaries.h"
+
+#include "SingletonHolder.h"
+#include "IConfigManager.h"
+#include "ISpacePartitionerManager.h"
+
+#include "SceneSimulationConfig.h"
+#include "SceneOpenBoundaryConfig.h"
+
+#include "OpenBoundaryType.h"
+#include "PartitionSelection.h"
+#include "NeighborParticleReferral.h"
+
+#include "FluidParticleSystem.h"
+#include "SPHBaseSolver.h"
+#include "ParticleCompaction.h"
+
+#include "BoundingBox.h"
+
+#include "RunnerHelper.h"
+
+
+Storm::OpenBoundaries::OpenBoundaries(const std::vector<Storm::SceneOpenBoundaryConfig> &openBoundariesConfig, const float particleRadius) :
+	_particleRadius{ particleRadius },
+	_particleDiameter{ particleRadius * 2.f },
+	_compaction{ std::make_unique<Storm::ParticleCompaction>() }
+{
+	for (const Storm::SceneOpenBoundaryConfig &openBoundaryConfig : openBoundariesConfig)
+	{
+		switch (openBoundaryConfig._type)
+		{
+		case Storm::OpenBoundaryType::Inflow:
+			this->addInflow(openBoundaryConfig);
+			break;
+
+		case Storm::OpenBoundaryType::Outflow:
+			_outflows.emplace_back(Outflow{
+				._boxMin = openBoundaryConfig._boxMin,
+				._boxMax = openBoundaryConfig._boxMax
+			});
+			break;
+
+		case Storm::OpenBoundaryType::None:
+		default:
+			Storm::throwException<Storm::Exception>("Open boundary " + std::to_string(openBoundaryConfig._openBoundaryId) + " type is unknown!");
+		}
+	}
+}
+
+Storm::OpenBoundaries::~OpenBoundaries() = default;
+
+void Storm::OpenBoundaries::addInflow(const Storm::SceneOpenBoundaryConfig &openBoundaryConfig)
+{
+	Inflow &inflow = _inflows.emplace_back();
+	inflow._boxMin = openBoundaryConfig._boxMin;
+	inflow._boxMax = openBoundaryConfig._boxMax;
+	inflow._velocity = openBoundaryConfig._velocity;
+	inflow._travelledDistance = 0.f;
+	inflow._reservedLayerCount = openBoundaryConfig._reservedLayerCount;
+
+	// The velocity was checked to be aligned to one axis when the config was read.
+	inflow._axis = inflow._velocity.x() != 0.f ? 0 : (inflow._velocity.y() != 0.f ? 1 : 2);
+	inflow._direction = inflow._velocity[inflow._axis] > 0.f ? 1.f : -1.f;
+	inflow._upstreamFaceCoord = inflow._direction > 0.f ? inflow._boxMin[inflow._axis] : inflow._boxMax[inflow._axis];
+
+	// The layer is a lattice of particle diameter spacing, centered on the upstream face of the box.
+	const int firstLayerAxis = (inflow._axis + 1) % 3;
+	const int secondLayerAxis = (inflow._axis + 2) % 3;
+
+	const auto computeLattice = [this, &inflow](const int axis, std::size_t &outCount, float &outFirstCoord)
+	{
+		const float extent = inflow._boxMax[axis] - inflow._boxMin[axis];
+		outCount = std::max(static_cast<std::size_t>(extent / _particleDiameter), static_cast<std::size_t>(1));
+		outFirstCoord = inflow._boxMin[axis] + (extent - static_cast<float>(outCount - 1) * _particleDiameter) * 0.5f;
+	};
+
+	std::size_t firstAxisCount;
+	float firstAxisFirstCoord;
+	computeLattice(firstLayerAxis, firstAxisCount, firstAxisFirstCoord);
+
+	std::size_t secondAxisCount;
+	float secondAxisFirstCoord;
+	computeLattice(secondLayerAxis, secondAxisCount, secondAxisFirstCoord);
+
+	inflow._layer.reserve(firstAxisCount * secondAxisCount);
+	for (std::size_t firstIter = 0; firstIter < firstAxisCount; ++firstIter)
+	{
+		for (std::size_t secondIter = 0; secondIter < secondAxisCount; ++secondIter)
+		{
+			Storm::Vector3 &layerPosition = inflow._layer.emplace_back(Storm::Vector3::Zero());
+			layerPosition[firstLayerAxis] = firstAxisFirstCoord + static_cast<float>(firstIter) * _particleDiameter;
+			layerPosition[secondLayerAxis] = secondAxisFirstCoord + static_cast<float>(secondIter) * _particleDiameter;
+		}
+	}
+
+	LOG_DEBUG << "Inflow open boundary " << openBoundaryConfig._openBoundaryId << " will inject layers of " << inflow._layer.size() << " particles.";
+}
+
+void Storm::OpenBoundaries::reserve(Storm::FluidParticleSystem &fluidPSystem) const
+{
+	std::size_t reservedParticleCount = fluidPSystem.getParticleCount();
+	for (const Inflow &inflow : _inflows)
+	{
+		reservedParticleCount += inflow._layer.size() * static_cast<std::size_t>(inflow._reservedLayerCount);
+	}
+
+	fluidPSystem.reserveParticles(reservedParticleCount);
+}
+
+bool Storm::OpenBoundaries::update(Storm::FluidParticleSystem &fluidPSystem, Storm::ISPHBaseSolver &solver, const float deltaTime)
+{
+	const Storm::SingletonHolder &singletonHolder = Storm::SingletonHolder::instance();
+	const Storm::ISpacePartitionerManager &spacePartitionerMgr = singletonHolder.getSingleton<Storm::ISpacePartitionerManager>();
+
+	const Storm::IConfigManager &configMgr = singletonHolder.getSingleton<Storm::IConfigManager>();
+	const Storm::SceneSimulationConfig &sceneSimulationConfig = configMgr.getSceneSimulationConfig();
+
+	// Like the blowers : with Verlet lists, the partition could be late of less than a cell since its last refresh.
+	const float boxMargin = sceneSimulationConfig._recomputeNeighborhoodStep > 1 ? spacePartitionerMgr.getPartitionLength() : 0.f;
+
+	const unsigned int fluidId = fluidPSystem.getId();
+	const std::vector<Storm::Vector3> &positions = fluidPSystem.getPositions();
+	std::vector<Storm::Vector3> &velocities = fluidPSystem.getVelocity();
+
+	// 1st : impose the inflow velocity. This must be done before the particle indexes change since we use the partition to find the particles inside the inflows.
+	for (const Inflow &inflow : _inflows)
+	{
+		this->gatherBundlesInsideBox(spacePartitionerMgr, inflow._boxMin, inflow._boxMax, boxMargin);
+
+		// A particle is registered inside only one cell, so each cell can be processed by a different thread.
+		Storm::runParallel(_bundles, [&inflow, &positions, &velocities, fluidId](const Storm::NeighborParticleReferralBundle &bundle)
+		{
+			for (const Storm::NeighborParticleReferral &referral : bundle)
+			{
+				if (referral._systemId == fluidId && Storm::isInsideBoundingBox(inflow._boxMin, inflow._boxMax, positions[referral._particleIndex]))
+				{
+					velocities[referral._particleIndex] = inflow._velocity;
+				}
+			}
+		});
+	}
+
+	// 2nd : remove the particles inside the outflows (the same particle can be found by several overlapping outflows, the compaction handles it).
+	_removedIndexes.clear();
+	for (const Outflow &outflow : _outflows)
+	{
+		this->gatherBundlesInsideBox(spacePartitionerMgr, outflow._boxMin, outflow._boxMax, boxMargin);
+		for (const Storm::NeighborParticleReferralBundle &bundle : _bundles)
+		{
+			for (const Storm::NeighborParticleReferral &referral : bundle)
+			{
+				if (referral._systemId == fluidId && Storm::isInsideBoundingBox(outflow._boxMin, outflow._boxMax, positions[referral._particleIndex]))
+				{
+					_removedIndexes.emplace_back(referral._particleIndex);
+				}
+			}
+		}
+	}
+
+	bool particleIndexesChanged = false;
+
+	_compaction->compute(_removedIndexes, fluidPSystem.getParticleCount());
+	if (!_compaction->empty())
+	{
+		fluidPSystem.compactParticles(*_compaction);
+		solver.compactParticleData(fluidId, *_compaction);
+		particleIndexesChanged = true;
+	}
+
+	// 3rd : inject a new layer for each particle diameter the inflow particles travelled.
+	for (Inflow &inflow : _inflows)
+	{
+		_injectedPositions.clear();
+
+		inflow._travelledDistance += std::fabs(inflow._velocity[inflow._axis]) * deltaTime;
+		while (inflow._travelledDistance >= _particleDiameter)
+		{
+			inflow._travelledDistance -= _particleDiameter;
+
+			// The layer has already travelled the remaining distance.
+			const float layerCoord = inflow._upstreamFaceCoord + inflow._direction * (_particleRadius + inflow._travelledDistance);
+			for (const Storm::Vector3 &layerPosition : inflow._layer)
+			{
+				Storm::Vector3 &injectedPosition = _injectedPositions.emplace_back(layerPosition);
+				injectedPosition[inflow._axis] = layerCoord;
+			}
+		}
+
+		if (!_injectedPositions.empty())
+		{
+			fluidPSystem.appendParticles(_injectedPositions, inflow._velocity);
+			solver.appendRawEndData(fluidId, _injectedPositions.size());
+			particleIndexesChanged = true;
+		}
+	}
+
+	return particleIndexesChanged;
+}
+
+void Storm::OpenBoundaries::gatherBundlesInsideBox(const Storm::ISpacePartitionerManager &spacePartitionerMgr, const Storm::Vector3 &boxMin, const Storm::Vector3 &boxMax, const float boxMargin)
+{
+	Storm::Vector3 minCorner = boxMin;
+	Storm::Vector3 maxCorner = boxMax;
+	minCorner.array() -= boxMargin;
+	maxCorner.array() += boxMargin;
+
+	_bundles.clear();
+	spacePartitionerMgr.visitBundlesInsideBox(minCorner, maxCorner, Storm::PartitionSelection::Fluid, [this](const Storm::NeighborParticleReferralBundle &bundle)
+	{
+		_bundles.emplace_back(bundle);
+	});
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "NeighborParticleReferralBundle.h"
+
+
+namespace Storm
+{
+	struct SceneOpenBoundaryConfig;
+	class FluidParticleSystem;
+	class ISPHBaseSolver;
+	class ISpacePartitionerManager;
+	class ParticleCompaction;
+
+	// The inflow and outflow zones, so that the simulated domain can be restricted to the region of interest (i.e. a wind tunnel without its upstream and downstream air).
+	// Outflow zones remove the fluid particles that entered them. Inflow zones impose their velocity to the fluid particles inside them,
+	// and inject a new layer of particles at their upstream face each time the previous layer has travelled one particle diameter.
+	class OpenBoundaries
+	{
+	private:
+		struct Inflow
+		{
+		public:
+			Storm::Vector3 _boxMin;
+			Storm::Vector3 _boxMax;
+			Storm::Vector3 _velocity;
+
+			// The positions of the particles of one injected layer, except the coordinate along the velocity axis.
+			std::vector<Storm::Vector3> _layer;
+
+			int _axis;
+			float _direction;
+			float _upstreamFaceCoord;
+
+			float _travelledDistance;
+			unsigned int _reservedLayerCount;
+		};
+
+		struct Outflow
+		{
+		public:
+			Storm::Vector3 _boxMin;
+			Storm::Vector3 _boxMax;
+		};
+
+	public:
+		OpenBoundaries(const std::vector<Storm::SceneOpenBoundaryConfig> &openBoundariesConfig, const float particleRadius);
+		~OpenBoundaries();
+
+	private:
+		void addInflow(const Storm::SceneOpenBoundaryConfig &openBoundaryConfig);
+
+	public:
+		// Preallocate the fluid particle arrays for the particles the inflows will inject during their reserved layer count.
+		void reserve(Storm::FluidParticleSystem &fluidPSystem) const;
+
+		// Should be called at the end of an iteration, while the fluid partition still references the current particle indexes.
+		// Returns true if particles were removed or injected, in which case the particle indexes have changed.
+		bool update(Storm::FluidParticleSystem &fluidPSystem, Storm::ISPHBaseSolver &solver, const float deltaTime);
+
+	private:
+		void gatherBundlesInsideBox(const Storm::ISpacePartitionerManager &spacePartitionerMgr, const Storm::Vector3 &boxMin, const Storm::Vector3 &boxMax, const float boxMargin);
+
+	private:
+		std::vector<Inflow> _inflows;
+		std::vector<Outflow> _outflows;
+
+		float _particleRadius;
+		float _particleDiameter;
+
+		// Tmp buffers kept to not reallocate them each time we update.
+		std::unique_ptr<Storm::ParticleCompaction> _compaction;
+		std::vector<std::size_t> _removedIndexes;
+		std::vector<Storm::Vector3> _injectedPositions;
+		std::vector<Storm::NeighborParticleReferralBundle> _bundles;
+	};
+}
@@ -64,7 +64,7 @@ namespace
 #undef STORM_SOLVER_NAMES_XMACRO
 
 	template<Storm::ViscosityMethod viscosityMethodOnFluid, Storm::ViscosityMethod viscosityMethodOnRigidBody>
-	Storm::Vector3 computeViscosity(const Storm::IterationParameter &iterationParameter, const Storm::SceneFluidConfig &fluidConfig, const Storm::FluidParticleSystem &fluidParticleSystem, const float currentPMass, const Storm::Vector3 &vi, const Storm::ParticleNeighborhoodArray &currentPNeighborhood, const float currentPDensity, const float viscoPrecoeff)
+	Storm::Vector3 computeViscosity(const Storm::IterationParameter &iterationParameter, const Storm::SceneFluidConfig &fluidConfig, const Storm::FluidParticleSystem &fluidParticleSystem, const float currentPMass, const Storm::Vector3 &vi, const Storm::ParticleNeighborhoodArray &currentPNeighborhood, const float currentPDensity, const float viscoPrecoeff, Storm::RigidBodyReactionAccumulator::Chunk &rbReactions)
 	{
 		Storm::Vector3 totalViscosityForceOnParticle = Storm::Vector3::Zero();
 
@@ -133,8 +133,7 @@ namespace
 				{
 					Storm::Vector3 &boundaryNeighborTmpViscosityForce = neighbor._containingParticleSystem->getTemporaryViscosityForces()[neighbor._particleIndex];
 
-					std::lock_guard<std::mutex> lock{ neighbor._containingParticleSystem->_mutex };
-					boundaryNeighborTmpViscosityForce -= viscosityComponent;
+					rbReactions.subtract(boundaryNeighborTmpViscosityForce, viscosityComponent);
 				}
 			}
 
@@ -269,7 +268,7 @@ void Storm::PCISPHSolver::execute(const Storm::IterationParameter &iterationPara
 
 			const float particleVolume = fluidParticleSystem.getParticleVolume();
 			const float density0 = fluidParticleSystem.getRestDensity();
-			const std::vector<Storm::ParticleNeighborhoodArray> &neighborhoodArrays = fluidParticleSystem.getNeighborhoodArrays();
+			const Storm::ParticleNeighborhoodStorage &neighborhoodArrays = fluidParticleSystem.getNeighborhoodArrays();
 			std::vector<float> &pressures = fluidParticleSystem.getPressures();
 			std::vector<float> &masses = fluidParticleSystem.getMasses();
 
@@ -278,7 +277,7 @@ void Storm::PCISPHSolver::execute(const Storm::IterationParameter &iterationPara
 				// Density
 				currentPDensity = particleVolume * k_kernelZero;
 
-				const Storm::ParticleNeighborhoodArray &currentPNeighborhood = neighborhoodArrays[currentPIndex];
+				const Storm::ParticleNeighborhoodArray currentPNeighborhood = neighborhoodArrays[currentPIndex];
 				for (const Storm::NeighborParticleInfo &neighbor : currentPNeighborhood)
 				{
 					float deltaDensity;
@@ -327,7 +326,7 @@ void Storm::PCISPHSolver::execute(const Storm::IterationParameter &iterationPara
 		{
 			Storm::FluidParticleSystem &fluidParticleSystem = static_cast<Storm::FluidParticleSystem &>(currentParticleSystem);
 			
-			const std::vector<Storm::ParticleNeighborhoodArray> &neighborhoodArrays = currentParticleSystem.getNeighborhoodArrays();
+			const Storm::ParticleNeighborhoodStorage &neighborhoodArrays = currentParticleSystem.getNeighborhoodArrays();
 			const std::vector<float> &masses = fluidParticleSystem.getMasses();
 			const std::vector<float> &densities = fluidParticleSystem.getDensities();
 			std::vector<Storm::Vector3> &temporaryPViscoForces = fluidParticleSystem.getTemporaryViscosityForces();
@@ -339,7 +338,7 @@ void Storm::PCISPHSolver::execute(const Storm::IterationParameter &iterationPara
 			
 			std::vector<Storm::PCISPHSolverData> &dataField = _data.find(particleSystemPair.first)->second;
 
-			Storm::runParallel(fluidParticleSystem.getForces(), [&](Storm::Vector3 &currentPForce, const std::size_t currentPIndex)
+			_rbReactionAccumulator.runParallel(fluidParticleSystem.getForces(), [&](Storm::Vector3 &currentPForce, const std::size_t currentPIndex, Storm::RigidBodyReactionAccumulator::Chunk &rbReactions)
 			{
 				const float currentPMass = masses[currentPIndex];
 				const float currentPDensity = densities[currentPIndex];
@@ -347,10 +346,11 @@ void Storm::PCISPHSolver::execute(const Storm::IterationParameter &iterationPara
 
 				Storm::Vector3 &currentPTmpViscoForce = temporaryPViscoForces[currentPIndex];
 
-				const Storm::ParticleNeighborhoodArray &currentPNeighborhood = neighborhoodArrays[currentPIndex];
+				// Sleeping particles are frozen, their non pressure forces are null.
+				const Storm::ParticleNeighborhoodArray currentPNeighborhood = fluidParticleSystem.isParticleSleeping(currentPIndex) ? neighborhoodArrays.getEmptyNeighborhood(currentPIndex) : neighborhoodArrays[currentPIndex];
 
 #define STORM_COMPUTE_VISCOSITY(fluidMethod, rbMethod) \
-					computeViscosity<fluidMethod, rbMethod>(iterationParameter, fluidConfig, fluidParticleSystem, currentPMass, vi, currentPNeighborhood, currentPDensity, viscoPrecoeff)
+					computeViscosity<fluidMethod, rbMethod>(iterationParameter, fluidConfig, fluidParticleSystem, currentPMass, vi, currentPNeighborhood, currentPDensity, viscoPrecoeff, rbReactions)
 
 				switch (sceneSimulationConfig._fluidViscoMethod)
 				{
@@ -397,11 +397,11 @@ void Storm::PCISPHSolver::execute(const Storm::IterationParameter &iterationPara
 
 					if (fluidConfig._uniformDragCoefficient > 0.f)
 					{
-						currentPTmpDragForceComponent = Storm::SPHSolverUtils::computeSumDragForce<true>(iterationParameter, fluidConfig._uniformDragCoefficient, fluidParticleSystem, vi, currentPNeighborhood, currentPDensity);
+						currentPTmpDragForceComponent = Storm::SPHSolverUtils::computeSumDragForce<true>(iterationParameter, fluidConfig._uniformDragCoefficient, fluidParticleSystem, vi, currentPNeighborhood, currentPDensity, rbReactions);
 					}
 					else
 					{
-						currentPTmpDragForceComponent = Storm::SPHSolverUtils::computeSumDragForce<false>(iterationParameter, fluidConfig._uniformDragCoefficient, fluidParticleSystem, vi, currentPNeighborhood, currentPDensity);
+						currentPTmpDragForceComponent = Storm::SPHSolverUtils::computeSumDragForce<false>(iterationParameter, fluidConfig._uniformDragCoefficient, fluidParticleSystem, vi, currentPNeighborhood, currentPDensity, rbReactions);
 					}
 
 					currentPForce += currentPTmpDragForceComponent;
@@ -450,13 +450,11 @@ void Storm::PCISPHSolver::execute(const Storm::IterationParameter &iterationPara
 
 			const std::vector<float> &masses = fluidParticleSystem.getMasses();
 			const std::vector<float> &densities = fluidParticleSystem.getDensities();
-			const std::vector<Storm::ParticleNeighborhoodArray> &neighborhoodArrays = fluidParticleSystem.getNeighborhoodArrays();
+			const Storm::ParticleNeighborhoodStorage &neighborhoodArrays = fluidParticleSystem.getNeighborhoodArrays();
 
 			const float density0 = fluidParticleSystem.getRestDensity();
 
-			std::atomic<float> densityError = 0.f;
-
-			Storm::runParallel(dataFieldPair.second, [&](Storm::PCISPHSolverData &currentPData, const std::size_t currentPIndex)
+			const Storm::ParallelReduceResult densityErrorResult = Storm::reduceChunkedParallel(dataFieldPair.second, [&](Storm::PCISPHSolverData &currentPData, const std::size_t currentPIndex, Storm::ParallelReduceResult &chunkResult)
 			{
 #if !STORM_USE_SPLISH_SPLASH_BIDOUILLE
 				const float currentPMass = masses[currentPIndex];
@@ -470,7 +468,7 @@ void Storm::PCISPHSolver::execute(const Storm::IterationParameter &iterationPara
 
 				const std::pair<const unsigned int, std::vector<Storm::PCISPHSolverData>>* currentNeighborPFluidData = &*std::begin(_data);
 
-				const Storm::ParticleNeighborhoodArray &currentPNeighborhood = neighborhoodArrays[currentPIndex];
+				const Storm::ParticleNeighborhoodArray currentPNeighborhood = neighborhoodArrays[currentPIndex];
 				for (const Storm::NeighborParticleInfo &neighbor : currentPNeighborhood)
 				{
 					float neighborPVolume;
@@ -521,18 +519,18 @@ void Storm::PCISPHSolver::execute(const Storm::IterationParameter &iterationPara
 				}
 
 #if !STORM_USE_SPLISH_SPLASH_DENSITY_BIDOUILLE
-				densityError += std::fabs((currentPData._predictedDensity - density0) / density0);
+				chunkResult._sum += std::fabs((currentPData._predictedDensity - density0) / density0);
 				currentPData._predictedPressure += k_templatePStiffnessCoeffK * currentPData._predictedDensity;
 #else // SplishSplash impl
 
 				currentPData._predictedDensity = std::max(currentPData._predictedDensity, 1.f);
 				const float shiftedPredictedDensity = currentPData._predictedDensity - 1.f;
-				densityError += density0 * shiftedPredictedDensity;
+				chunkResult._sum += density0 * shiftedPredictedDensity;
 				currentPData._predictedPressure += k_templatePStiffnessCoeffK * shiftedPredictedDensity;
 #endif
 			});
 
-			averageDensityError += densityError;
+			averageDensityError += densityErrorResult._sum;
 		}
 
 		averageDensityError /= totalParticleCountFl;
@@ -549,11 +547,11 @@ void Storm::PCISPHSolver::execute(const Storm::IterationParameter &iterationPara
 			const Storm::FluidParticleSystem &currentParticleSystem = static_cast<const Storm::FluidParticleSystem &>(*particleSystems.find(dataFieldPair.first)->second);
 
 			//const std::vector<float> &masses = currentParticleSystem.getMasses();
-			const std::vector<Storm::ParticleNeighborhoodArray> &neighborhoodArrays = currentParticleSystem.getNeighborhoodArrays();
+			const Storm::ParticleNeighborhoodStorage &neighborhoodArrays = currentParticleSystem.getNeighborhoodArrays();
 
-			Storm::runParallel(dataFieldPair.second, [&](Storm::PCISPHSolverData &currentPData, const std::size_t currentPIndex)
+			_rbReactionAccumulator.runParallel(dataFieldPair.second, [&](Storm::PCISPHSolverData &currentPData, const std::size_t currentPIndex, Storm::RigidBodyReactionAccumulator::Chunk &rbReactions)
 			{
-				const Storm::ParticleNeighborhoodArray &currentPNeighborhood = neighborhoodArrays[currentPIndex];
+				const Storm::ParticleNeighborhoodArray currentPNeighborhood = neighborhoodArrays[currentPIndex];
 				currentPData._predictedAcceleration = currentPData._nonPressureAcceleration;
 
 				const std::pair<const unsigned int, std::vector<Storm::PCISPHSolverData>>* currentNeighborPFluidData = &*std::begin(_data);
@@ -634,11 +632,10 @@ void Storm::PCISPHSolver::execute(const Storm::IterationParameter &iterationPara
 
 								Storm::Vector3 &tmpPressureForce = neighborPSystemAsRb.getTemporaryPressureForces()[neighbor._particleIndex];
 
-								std::lock_guard<std::mutex> lock{ neighbor._containingParticleSystem->_mutex };
 #if STORM_MINUS_ACCEL
-								tmpPressureForce += pressureTmpVect;
+								rbReactions.add(tmpPressureForce, pressureTmpVect);
 #else
-								tmpPressureForce -= pressureTmpVect;
+								rbReactions.subtract(tmpPressureForce, pressureTmpVect);
 #endif
 							}
 						}
@@ -669,13 +666,12 @@ void Storm::PCISPHSolver::execute(const Storm::IterationParameter &iterationPara
 		std::vector<Storm::Vector3> &forces = fluidParticleSystem.getForces();
 		std::vector<Storm::Vector3> &tmpPressureForces = fluidParticleSystem.getTemporaryPressureForces();
 
-		std::atomic<bool> dirtyTmp = false;
 #pragma warning (push)
 #pragma warning (disable: 4189) // It is being used, but the compiler cannot see it before it compiles for real
 		constexpr const float minForceDirtyEpsilon = 0.0001f;
 #pragma warning (push)
 		
-		Storm::runParallel(dataField, [&](const Storm::PCISPHSolverData &currentPData, const std::size_t currentPIndex)
+		const Storm::ParallelReduceResult integrationResult = Storm::reduceChunkedParallel(dataField, [&](const Storm::PCISPHSolverData &currentPData, const std::size_t currentPIndex, Storm::ParallelReduceResult &chunkResult)
 		{
 			densities[currentPIndex] = currentPData._predictedDensity;
 			pressures[currentPIndex] = currentPData._predictedPressure;
@@ -691,7 +687,7 @@ void Storm::PCISPHSolver::execute(const Storm::IterationParameter &iterationPara
 			currentPVelocity += currentPData._predictedAcceleration * iterationParameter._deltaTime;
 			currentPPositions += currentPVelocity * iterationParameter._deltaTime;
 
-			if (!dirtyTmp)
+			if (!chunkResult._flag)
 			{
 				if (
 					std::fabs(currentPVelocity.x()) > minForceDirtyEpsilon ||
@@ -699,12 +695,12 @@ void Storm::PCISPHSolver::execute(const Storm::IterationParameter &iterationPara
 					std::fabs(currentPVelocity.z()) > minForceDirtyEpsilon
 					)
 				{
-					dirtyTmp = true;
+					chunkResult._flag = true;
 				}
 			}
 		});
 
-		fluidParticleSystem.setIsDirty(dirtyTmp);
+		fluidParticleSystem.setIsDirty(integrationResult._flag);
 	});
 
 	// 7th : flush physics state (rigid bodies)
@@ -715,3 +711,20 @@ void Storm::PCISPHSolver::removeRawEndData(const unsigned int pSystemId, std::si
 {
 	Storm::SPHSolverUtils::removeRawEndData(pSystemId, toRemoveCount, _data);
 }
+
+void Storm::PCISPHSolver::reorderParticleData(const unsigned int pSystemId, const std::vector<std::size_t> &newToOldIndexes)
+{
+	Storm::SPHSolverUtils::reorderData(pSystemId, newToOldIndexes, _data);
+}
+
+void Storm::PCISPHSolver::compactParticleData(const unsigned int pSystemId, const Storm::ParticleCompaction &compaction)
+{
+	Storm::SPHSolverUtils::compactData(pSystemId, compaction, _data);
+	_totalParticleCount -= compaction.getRemovedCount();
+}
+
+void Storm::PCISPHSolver::appendRawEndData(const unsigned int pSystemId, std::size_t toAddCount)
+{
+	Storm::SPHSolverUtils::appendRawEndData(pSystemId, toAddCount, _data);
+	_totalParticleCount += toAddCount;
+}
@@ -20,6 +20,9 @@ namespace Storm
 	public:
 		void execute(const Storm::IterationParameter &iterationParameter) final override;
 		void removeRawEndData(const unsigned int pSystemId, std::size_t toRemoveCount) final override;
+		void reorderParticleData(const unsigned int pSystemId, const std::vector<std::size_t> &newToOldIndexes) final override;
+		void compactParticleData(const unsigned int pSystemId, const Storm::ParticleCompaction &compaction) final override;
+		void appendRawEndData(const unsigned int pSystemId, std::size_t toAddCount) final override;
 
 	private:
 		float _kUniformStiffnessConstCoefficient;
@@ -0,0 +1,103 @@
+#include "ParticleCompaction.h"
+
+
+Storm::ParticleCompaction::ParticleCompaction() :
+	_oldParticleCount{ 0 },
+	_removedCount{ 0 }
+{
+
+}
+
+Storm::ParticleCompaction::~ParticleCompaction() = default;
+
+void Storm::ParticleCompaction::compute(std::vector<std::size_t> &removedIndexes, const std::size_t particleCount)
+{
+	_moves.clear();
+	_oldParticleCount = particleCount;
+
+	std::sort(std::execution::par, std::begin(removedIndexes), std::end(removedIndexes));
+	removedIndexes.erase(std::unique(std::begin(removedIndexes), std::end(removedIndexes)), std::end(removedIndexes));
+
+	_removedCount = removedIndexes.size();
+	if (_removedCount == 0)
+	{
+		return;
+	}
+
+	assert(removedIndexes.back() < particleCount && "A removed index is out of range!");
+
+	// The holes are the removed particles before the new end, they're filled with the kept particles after the new end (there is as many of both).
+	const std::size_t newParticleCount = particleCount - _removedCount;
+	const auto firstRemovedAfterNewEnd = std::lower_bound(std::begin(removedIndexes), std::end(removedIndexes), newParticleCount);
+
+	_moves.reserve(static_cast<std::size_t>(std::distance(std::begin(removedIndexes), firstRemovedAfterNewEnd)));
+
+	auto removedAfterNewEndIter = firstRemovedAfterNewEnd;
+	std::size_t sourceIndex = newParticleCount;
+	for (auto holeIter = std::begin(removedIndexes); holeIter != firstRemovedAfterNewEnd; ++holeIter)
+	{
+		// Skip the particles after the new end that are also removed.
+		while (removedAfterNewEndIter != std::end(removedIndexes) && *removedAfterNewEndIter == sourceIndex)
+		{
+			++removedAfterNewEndIter;
+			++sourceIndex;
+		}
+
+		_moves.emplace_back(*holeIter, sourceIndex);
+		++sourceIndex;
+	}
+}
+
+bool Storm::ParticleCompaction::empty() const noexcept
+{
+	return _removedCount == 0;
+}
+
+std::size_t Storm::ParticleCompaction::getRemovedCount() const noexcept
+{
+	return _removedCount;
+}
+
+std::size_t Storm::ParticleCompaction::getOldParticleCount() const noexcept
+{
+	return _oldParticleCount;
+}
+
+std::size_t Storm::ParticleCompaction::getNewParticleCount() const noexcept
+{
+	return _oldParticleCount - _removedCount;
+}
+
+const std::vector<std::pair<std::size_t, std::size_t>>& Storm::ParticleCompaction::getMoves() const noexcept
+{
+	return _moves;
+}
+
+void Storm::ParticleCompaction::applyToStableIds(std::vector<std::size_t> &inOutStableIds, std::vector<std::size_t> &inOutStableIdToIndex) const
+{
+	if (_removedCount == 0)
+	{
+		return;
+	}
+
+	assert(inOutStableIds.size() == _oldParticleCount && "The compaction should be applied to stable ids with the same particle count than the one it was computed for!");
+
+	// The removed particles are the ones whose stable id is still bound to their index once the moves are done.
+	for (const auto &move : _moves)
+	{
+		inOutStableIdToIndex[inOutStableIds[move.first]] = std::numeric_limits<std::size_t>::max();
+		inOutStableIdToIndex[inOutStableIds[move.second]] = move.first;
+	}
+
+	const std::size_t newParticleCount = this->getNewParticleCount();
+	for (std::size_t removedIndex = newParticleCount; removedIndex < _oldParticleCount; ++removedIndex)
+	{
+		std::size_t &stableIdIndex = inOutStableIdToIndex[inOutStableIds[removedIndex]];
+		if (stableIdIndex == removedIndex)
+		{
+			stableIdIndex = std::numeric_limits<std::size_t>::max();
+		}
+	}
+
+	this->apply(inOutStableIds);
+}
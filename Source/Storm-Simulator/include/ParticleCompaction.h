@@ -0,0 +1,59 @@
+#pragma once
+
+#include "RunnerHelper.h"
+
+
+namespace Storm
+{
+	// Removes particles from the per particle arrays in a time proportional to the removed particle count, whatever the particle count is :
+	// the last kept particles are moved into the holes left by the removed ones (swap-compaction), then the end of the arrays is dropped.
+	// Beware, this doesn't preserve the order of the kept particles.
+	class ParticleCompaction
+	{
+	public:
+		ParticleCompaction();
+		~ParticleCompaction();
+
+	public:
+		// removedIndexes are the indexes of the particles to remove. They don't need to be sorted and can contain duplicates (the method sorts them and removes the duplicates).
+		void compute(std::vector<std::size_t> &removedIndexes, const std::size_t particleCount);
+
+	public:
+		bool empty() const noexcept;
+		std::size_t getRemovedCount() const noexcept;
+		std::size_t getOldParticleCount() const noexcept;
+		std::size_t getNewParticleCount() const noexcept;
+
+		// Each move is (destination index, source index) : the particle at the source index (a kept particle at the end) is moved at the destination index (a hole left by a removed particle).
+		const std::vector<std::pair<std::size_t, std::size_t>>& getMoves() const noexcept;
+
+	public:
+		// Apply the compaction to a per particle array. Empty arrays are left as is.
+		template<class Type>
+		void apply(std::vector<Type> &inOutArray) const
+		{
+			if (inOutArray.empty() || _removedCount == 0)
+			{
+				return;
+			}
+
+			assert(inOutArray.size() == _oldParticleCount && "The compaction should be applied to an array with the same particle count than the one it was computed for!");
+
+			Storm::runParallel(_moves, [&inOutArray](const std::pair<std::size_t, std::size_t> &move)
+			{
+				inOutArray[move.first] = std::move(inOutArray[move.second]);
+			});
+
+			inOutArray.erase(std::begin(inOutArray) + _oldParticleCount - _removedCount, std::end(inOutArray));
+		}
+
+		// Apply the compaction to the stable ids (particle index -> stable id) and update the reverse mapping (stable id -> particle index) accordingly.
+		// The stable ids of the removed particles are bound to std::numeric_limits<std::size_t>::max() afterward.
+		void applyToStableIds(std::vector<std::size_t> &inOutStableIds, std::vector<std::size_t> &inOutStableIdToIndex) const;
+
+	private:
+		std::vector<std::pair<std::size_t, std::size_t>> _moves;
+		std::size_t _oldParticleCount;
+		std::size_t _removedCount;
+	};
+}
@@ -0,0 +1,536 @@
+#include "ParticleNeighborhoodStorage.h"
+
+
+void Storm::ParticleNeighborhoodStorage::Block::clear()
+{
+	_packedNeighbors.clear();
+	_xij.clear();
+	_Wij.clear();
+	_gradWij.clear();
+}
+
+std::size_t Storm::ParticleNeighborhoodStorage::Block::computeUsedMemory() const
+{
+	return
+		_packedNeighbors.capacity() * sizeof(uint32_t) +
+		_xij.capacity() * sizeof(Storm::Vector3) +
+		_Wij.capacity() * sizeof(float) +
+		_gradWij.capacity() * sizeof(Storm::Vector3)
+		;
+}
+
+void Storm::ParticleNeighborhoodStorage::SymmetricSearchBlock::clear()
+{
+	_forwardNeighbors.clear();
+	_otherNeighbors.clear();
+	_forwardEnds.clear();
+	_otherEnds.clear();
+	_hasNeighborhood.clear();
+	_keepsPrevious.clear();
+}
+
+Storm::ParticleNeighborhoodStorage::ParticleNeighborhoodStorage(const std::vector<Storm::Vector3> &ownerPositions) :
+	_kernelLength{ 0.f },
+	_ownerPositions{ &ownerPositions },
+	_hasPreviousNeighborhoods{ false },
+	_infiniteDomain{ false },
+	_domainDimension{ Storm::Vector3::Zero() },
+	_halfDomainDimension{ Storm::Vector3::Zero() }
+{
+
+}
+
+Storm::ParticleNeighborhoodStorage::~ParticleNeighborhoodStorage() = default;
+
+std::size_t Storm::ParticleNeighborhoodStorage::size() const noexcept
+{
+	return _offsets.size();
+}
+
+std::size_t Storm::ParticleNeighborhoodStorage::getNeighborCount() const
+{
+	std::size_t result = 0;
+	for (const Block &block : _blocks)
+	{
+		result += block._packedNeighbors.size();
+	}
+
+	return result;
+}
+
+Storm::ParticleNeighborhoodArray Storm::ParticleNeighborhoodStorage::operator[](const std::size_t particleIndex) const
+{
+	assert(particleIndex < _offsets.size() && "Particle index out of range!");
+
+	const Block &block = _blocks[particleIndex >> k_blockParticleCountShift];
+	const std::size_t beginOffset = _offsets[particleIndex];
+	const std::size_t endOffset = this->getNeighborhoodEndOffset(particleIndex);
+
+	return Storm::ParticleNeighborhoodArray{
+		*this,
+		(*_ownerPositions)[particleIndex],
+		block._packedNeighbors.data() + beginOffset,
+		block._xij.data() + beginOffset,
+		block._Wij.data() + beginOffset,
+		block._gradWij.data() + beginOffset,
+		endOffset - beginOffset
+	};
+}
+
+Storm::ParticleNeighborhoodArray Storm::ParticleNeighborhoodStorage::getEmptyNeighborhood(const std::size_t particleIndex) const
+{
+	assert(particleIndex < _offsets.size() && "Particle index out of range!");
+	return Storm::ParticleNeighborhoodArray{ *this, (*_ownerPositions)[particleIndex], nullptr, nullptr, nullptr, nullptr, 0 };
+}
+
+void Storm::ParticleNeighborhoodStorage::reset(const Storm::ParticleNeighborhoodStorage::NeighborSources &sources)
+{
+	if (sources._referencedPSystems.size() > k_maxReferencedParticleSystemCount) STORM_UNLIKELY
+	{
+		Storm::throwException<Storm::Exception>("The neighborhood storage cannot handle more than " + std::to_string(k_maxReferencedParticleSystemCount) + " particle systems (we have " + std::to_string(sources._referencedPSystems.size()) + ")!");
+	}
+
+	for (const ReferencedParticleSystem &referencedPSystem : sources._referencedPSystems)
+	{
+		if (referencedPSystem._positions->size() > k_maxParticleCountPerSystem) STORM_UNLIKELY
+		{
+			Storm::throwException<Storm::Exception>("The neighborhood storage cannot handle particle systems with more than " + std::to_string(k_maxParticleCountPerSystem) + " particles (one has " + std::to_string(referencedPSystem._positions->size()) + ")!");
+		}
+	}
+
+	_hasPreviousNeighborhoods = false;
+
+	_referencedPSystems = sources._referencedPSystems;
+	_kernelLength = sources._kernelLength;
+
+	_infiniteDomain = sources._infiniteDomain;
+	_domainDimension = sources._domainDimension;
+	_halfDomainDimension = _domainDimension / 2.f;
+
+	const std::size_t particleCount = _ownerPositions->size();
+	_offsets.assign(particleCount, 0);
+	_blocks.resize((particleCount + k_blockParticleCount - 1) >> k_blockParticleCountShift);
+
+	Storm::runParallel(_blocks, [](Block &block)
+	{
+		block.clear();
+	});
+}
+
+void Storm::ParticleNeighborhoodStorage::resetKeepingPrevious(const Storm::ParticleNeighborhoodStorage::NeighborSources &sources)
+{
+	// Swap instead of copying, the former previous neighborhoods become the storage reset just after (and we keep their capacity).
+	std::swap(_offsets, _previousOffsets);
+	std::swap(_blocks, _previousBlocks);
+	std::swap(_referencedPSystems, _previousReferencedPSystems);
+
+	const float previousKernelLength = _kernelLength;
+
+	this->reset(sources);
+
+	// The packed neighbors refer to the particle systems by their slot, therefore the registered particle systems should be exactly the same.
+	// And the previous kernel values are only right for the kernel length they were computed with.
+	_hasPreviousNeighborhoods =
+		_previousOffsets.size() == _offsets.size() &&
+		previousKernelLength == _kernelLength &&
+		std::equal(std::begin(_previousReferencedPSystems), std::end(_previousReferencedPSystems), std::begin(_referencedPSystems), std::end(_referencedPSystems), [](const ReferencedParticleSystem &previous, const ReferencedParticleSystem &current)
+		{
+			return previous._pSystem == current._pSystem && previous._positions == current._positions;
+		});
+}
+
+bool Storm::ParticleNeighborhoodStorage::hasPreviousNeighborhoods() const noexcept
+{
+	return _hasPreviousNeighborhoods;
+}
+
+void Storm::ParticleNeighborhoodStorage::invalidate()
+{
+	// Without the offsets, resetKeepingPrevious sees a particle count mismatch. The blocks are left as is to keep their capacity.
+	_offsets.clear();
+}
+
+void Storm::ParticleNeighborhoodStorage::resize(const std::size_t particleCount)
+{
+	const std::size_t oldParticleCount = _offsets.size();
+	if (particleCount > oldParticleCount)
+	{
+		// The new particles inside the old last block start (and end) at the end of this block.
+		_offsets.resize(particleCount, 0);
+		if (const std::size_t oldLastBlockPCount = oldParticleCount & (k_blockParticleCount - 1); oldLastBlockPCount != 0)
+		{
+			const uint32_t oldLastBlockEnd = static_cast<uint32_t>(_blocks.back()._packedNeighbors.size());
+			const std::size_t oldLastBlockEndPIndex = std::min(oldParticleCount - oldLastBlockPCount + k_blockParticleCount, particleCount);
+			std::fill(std::begin(_offsets) + oldParticleCount, std::begin(_offsets) + oldLastBlockEndPIndex, oldLastBlockEnd);
+		}
+
+		_blocks.resize((particleCount + k_blockParticleCount - 1) >> k_blockParticleCountShift);
+		return;
+	}
+	else if (particleCount == oldParticleCount)
+	{
+		return;
+	}
+
+	_blocks.resize((particleCount + k_blockParticleCount - 1) >> k_blockParticleCountShift);
+
+	// The last block may still contain the removed particles neighbors. They're the last ones of the block.
+	if (const std::size_t lastBlockPCount = particleCount & (k_blockParticleCount - 1); lastBlockPCount != 0)
+	{
+		const std::size_t newBlockEnd = _offsets[particleCount];
+
+		Block &lastBlock = _blocks.back();
+		lastBlock._packedNeighbors.resize(newBlockEnd);
+		lastBlock._xij.resize(newBlockEnd);
+		lastBlock._Wij.resize(newBlockEnd);
+		lastBlock._gradWij.resize(newBlockEnd);
+	}
+
+	_offsets.resize(particleCount);
+}
+
+void Storm::ParticleNeighborhoodStorage::setParticleNeighborhood(const std::size_t particleIndex, const Storm::ParticleNeighborhoodBuildArray &neighborhood)
+{
+	assert(!_referencedPSystems.empty() && "The neighborhood storage should have been reset before being filled!");
+	assert(particleIndex < _offsets.size() && "Particle index out of range!");
+
+	Block newNeighborhood;
+	this->appendToBlock(newNeighborhood, neighborhood);
+
+	Block &block = _blocks[particleIndex >> k_blockParticleCountShift];
+	const std::size_t beginOffset = _offsets[particleIndex];
+	const std::size_t endOffset = this->getNeighborhoodEndOffset(particleIndex);
+
+	const auto replaceRange = [beginOffset, endOffset](auto &blockArray, const auto &newArray)
+	{
+		blockArray.erase(std::begin(blockArray) + beginOffset, std::begin(blockArray) + endOffset);
+		blockArray.insert(std::begin(blockArray) + beginOffset, std::begin(newArray), std::end(newArray));
+	};
+
+	replaceRange(block._packedNeighbors, newNeighborhood._packedNeighbors);
+	replaceRange(block._xij, newNeighborhood._xij);
+	replaceRange(block._Wij, newNeighborhood._Wij);
+	replaceRange(block._gradWij, newNeighborhood._gradWij);
+
+	// Shift the offsets of the next particles of the same block.
+	const std::size_t blockEndPIndex = std::min(((particleIndex >> k_blockParticleCountShift) + 1) << k_blockParticleCountShift, _offsets.size());
+	const std::size_t newEndOffset = beginOffset + neighborhood.size();
+	for (std::size_t nextPIndex = particleIndex + 1; nextPIndex < blockEndPIndex; ++nextPIndex)
+	{
+		_offsets[nextPIndex] = static_cast<uint32_t>(_offsets[nextPIndex] - endOffset + newEndOffset);
+	}
+}
+
+std::size_t Storm::ParticleNeighborhoodStorage::computeUsedMemory() const
+{
+	std::size_t result = _offsets.capacity() * sizeof(uint32_t) + _blocks.capacity() * sizeof(Block);
+	for (const Block &block : _blocks)
+	{
+		result += block.computeUsedMemory();
+	}
+
+	result += _previousOffsets.capacity() * sizeof(uint32_t) + _previousBlocks.capacity() * sizeof(Block);
+	for (const Block &block : _previousBlocks)
+	{
+		result += block.computeUsedMemory();
+	}
+
+	return result;
+}
+
+std::size_t Storm::ParticleNeighborhoodStorage::computePerParticleArrayLayoutMemory() const
+{
+	constexpr std::size_t k_perParticleArrayReservedCapacity = 64;
+
+	std::size_t result = _offsets.size() * sizeof(Storm::ParticleNeighborhoodBuildArray);
+	for (std::size_t particleIndex = 0; particleIndex < _offsets.size(); ++particleIndex)
+	{
+		const std::size_t neighborCount = this->getNeighborhoodEndOffset(particleIndex) - _offsets[particleIndex];
+		result += std::max(neighborCount, k_perParticleArrayReservedCapacity) * sizeof(Storm::NeighborParticleInfo);
+	}
+
+	return result;
+}
+
+void Storm::ParticleNeighborhoodStorage::appendToBlock(Block &block, const Storm::ParticleNeighborhoodBuildArray &neighborhood) const
+{
+	std::size_t lastSlot = 0;
+	for (const Storm::NeighborParticleInfo &neighbor : neighborhood)
+	{
+		block._packedNeighbors.emplace_back(this->packNeighbor(neighbor, lastSlot));
+		block._xij.emplace_back(neighbor._xij);
+		block._Wij.emplace_back(neighbor._Wij);
+		block._gradWij.emplace_back(neighbor._gradWij);
+	}
+}
+
+void Storm::ParticleNeighborhoodStorage::appendPreviousToBlock(Block &block, const std::size_t particleIndex) const
+{
+	assert(this->isPreviousNeighborhoodInsideKernelSupport(particleIndex) && "A kept neighbor moved since its neighborhood was built, its kernel values are wrong!");
+
+	const Block &previousBlock = _previousBlocks[particleIndex >> k_blockParticleCountShift];
+
+	const std::size_t beginOffset = _previousOffsets[particleIndex];
+	const std::size_t endOffset = this->getPreviousNeighborhoodEndOffset(particleIndex);
+
+	block._packedNeighbors.insert(std::end(block._packedNeighbors), std::begin(previousBlock._packedNeighbors) + beginOffset, std::begin(previousBlock._packedNeighbors) + endOffset);
+	block._xij.insert(std::end(block._xij), std::begin(previousBlock._xij) + beginOffset, std::begin(previousBlock._xij) + endOffset);
+	block._Wij.insert(std::end(block._Wij), std::begin(previousBlock._Wij) + beginOffset, std::begin(previousBlock._Wij) + endOffset);
+	block._gradWij.insert(std::end(block._gradWij), std::begin(previousBlock._gradWij) + beginOffset, std::begin(previousBlock._gradWij) + endOffset);
+}
+
+void Storm::ParticleNeighborhoodStorage::appendPreviousToSearchBlock(SymmetricSearchBlock &searchBlock, const std::size_t particleIndex, const uint32_t ownerPackedSlot) const
+{
+	assert(this->isPreviousNeighborhoodInsideKernelSupport(particleIndex) && "A kept neighbor moved since its neighborhood was built, its kernel values are wrong!");
+
+	const Block &previousBlock = _previousBlocks[particleIndex >> k_blockParticleCountShift];
+
+	const std::size_t endOffset = this->getPreviousNeighborhoodEndOffset(particleIndex);
+	for (std::size_t offset = _previousOffsets[particleIndex]; offset < endOffset; ++offset)
+	{
+		const uint32_t packedNeighbor = previousBlock._packedNeighbors[offset];
+
+		Block &block = (packedNeighbor & ~static_cast<uint32_t>(k_particleIndexMask)) == ownerPackedSlot ? searchBlock._forwardNeighbors : searchBlock._otherNeighbors;
+		block._packedNeighbors.emplace_back(packedNeighbor);
+		block._xij.emplace_back(previousBlock._xij[offset]);
+		block._Wij.emplace_back(previousBlock._Wij[offset]);
+		block._gradWij.emplace_back(previousBlock._gradWij[offset]);
+	}
+}
+
+uint32_t Storm::ParticleNeighborhoodStorage::packNeighbor(const Storm::NeighborParticleInfo &neighbor, std::size_t &inOutLastSlot) const
+{
+	// Neighbors of the same particle system come in a row, so most of the time, the slot is the same as the last one.
+	if (_referencedPSystems[inOutLastSlot]._pSystem != neighbor._containingParticleSystem)
+	{
+		const std::size_t referencedPSystemCount = _referencedPSystems.size();
+		for (inOutLastSlot = 0; inOutLastSlot < referencedPSystemCount; ++inOutLastSlot)
+		{
+			if (_referencedPSystems[inOutLastSlot]._pSystem == neighbor._containingParticleSystem)
+			{
+				break;
+			}
+		}
+
+		assert(inOutLastSlot != referencedPSystemCount && "The neighbor particle system wasn't registered when the storage was reset!");
+	}
+
+	return static_cast<uint32_t>((inOutLastSlot << k_particleIndexBitCount) | neighbor._particleIndex);
+}
+
+std::size_t Storm::ParticleNeighborhoodStorage::findOwnerSlot() const
+{
+	std::size_t ownerSlot = 0;
+	while (_referencedPSystems[ownerSlot]._positions != _ownerPositions)
+	{
+		++ownerSlot;
+		assert(ownerSlot != _referencedPSystems.size() && "The owner particle system wasn't registered when the storage was reset!");
+	}
+
+	return ownerSlot;
+}
+
+void Storm::ParticleNeighborhoodStorage::scatterSymmetricSearch(const uint32_t ownerPackedSlot)
+{
+	const std::size_t particleCount = _offsets.size();
+
+	// The particles that kept their previous neighborhood already have all their pairs.
+	const auto receivesFoundPairs = [this](const std::size_t particleIndex)
+	{
+		const SymmetricSearchBlock &searchBlock = _symmetricSearchBlocks[particleIndex >> k_blockParticleCountShift];
+		const std::size_t inBlockPIndex = particleIndex & (k_blockParticleCount - 1);
+		return searchBlock._hasNeighborhood[inBlockPIndex] && !searchBlock._keepsPrevious[inBlockPIndex];
+	};
+
+	// First, count how many times each particle was found by another particle as forward neighbor.
+	_symmetricWriteCursors.assign(particleCount, 0);
+	Storm::runParallel(_symmetricSearchBlocks, [this, &receivesFoundPairs](const SymmetricSearchBlock &searchBlock)
+	{
+		for (const uint32_t packedNeighbor : searchBlock._forwardNeighbors._packedNeighbors)
+		{
+			const std::size_t neighborPIndex = packedNeighbor & k_particleIndexMask;
+			if (receivesFoundPairs(neighborPIndex))
+			{
+				std::atomic_ref<uint32_t>{ _symmetricWriteCursors[neighborPIndex] }.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+	});
+
+	// Then we know the size of each neighborhood. Their layout is : forward neighbors, then the neighbors that found this particle, then the other particle systems neighbors.
+	// The part of each block that doesn't need the other blocks is written now, the write cursor of each particle is moved to where the neighbors that found it should be written.
+	Storm::runParallel(_blocks, [this, particleCount](Block &block, const std::size_t blockIndex)
+	{
+		const SymmetricSearchBlock &searchBlock = _symmetricSearchBlocks[blockIndex];
+
+		const std::size_t firstPIndex = blockIndex << k_blockParticleCountShift;
+		const std::size_t endPIndex = std::min(firstPIndex + k_blockParticleCount, particleCount);
+
+		uint32_t blockNeighborCount = 0;
+		for (std::size_t particleIndex = firstPIndex; particleIndex < endPIndex; ++particleIndex)
+		{
+			const std::size_t inBlockPIndex = particleIndex - firstPIndex;
+
+			_offsets[particleIndex] = blockNeighborCount;
+			if (searchBlock._hasNeighborhood[inBlockPIndex])
+			{
+				const uint32_t forwardBegin = inBlockPIndex != 0 ? searchBlock._forwardEnds[inBlockPIndex - 1] : 0;
+				const uint32_t otherBegin = inBlockPIndex != 0 ? searchBlock._otherEnds[inBlockPIndex - 1] : 0;
+				blockNeighborCount += (searchBlock._forwardEnds[inBlockPIndex] - forwardBegin) + _symmetricWriteCursors[particleIndex] + (searchBlock._otherEnds[inBlockPIndex] - otherBegin);
+			}
+		}
+
+		block._packedNeighbors.resize(blockNeighborCount);
+		block._xij.resize(blockNeighborCount);
+		block._Wij.resize(blockNeighborCount);
+		block._gradWij.resize(blockNeighborCount);
+
+		for (std::size_t particleIndex = firstPIndex; particleIndex < endPIndex; ++particleIndex)
+		{
+			const std::size_t inBlockPIndex = particleIndex - firstPIndex;
+			if (!searchBlock._hasNeighborhood[inBlockPIndex])
+			{
+				continue;
+			}
+
+			const auto copyRange = [&block](const Block &srcBlock, const uint32_t srcBegin, const uint32_t srcEnd, const uint32_t dstBegin)
+			{
+				std::copy(std::begin(srcBlock._packedNeighbors) + srcBegin, std::begin(srcBlock._packedNeighbors) + srcEnd, std::begin(block._packedNeighbors) + dstBegin);
+				std::copy(std::begin(srcBlock._xij) + srcBegin, std::begin(srcBlock._xij) + srcEnd, std::begin(block._xij) + dstBegin);
+				std::copy(std::begin(srcBlock._Wij) + srcBegin, std::begin(srcBlock._Wij) + srcEnd, std::begin(block._Wij) + dstBegin);
+				std::copy(std::begin(srcBlock._gradWij) + srcBegin, std::begin(srcBlock._gradWij) + srcEnd, std::begin(block._gradWij) + dstBegin);
+			};
+
+			const uint32_t forwardBegin = inBlockPIndex != 0 ? searchBlock._forwardEnds[inBlockPIndex - 1] : 0;
+			const uint32_t forwardEnd = searchBlock._forwardEnds[inBlockPIndex];
+			const uint32_t otherBegin = inBlockPIndex != 0 ? searchBlock._otherEnds[inBlockPIndex - 1] : 0;
+			const uint32_t otherEnd = searchBlock._otherEnds[inBlockPIndex];
+
+			uint32_t &writeCursor = _symmetricWriteCursors[particleIndex];
+			const uint32_t foundByOthersCount = writeCursor;
+
+			copyRange(searchBlock._forwardNeighbors, forwardBegin, forwardEnd, _offsets[particleIndex]);
+			writeCursor = _offsets[particleIndex] + (forwardEnd - forwardBegin);
+			copyRange(searchBlock._otherNeighbors, otherBegin, otherEnd, writeCursor + foundByOthersCount);
+		}
+	});
+
+	// Write the other direction of each forward pair. Each slot is reserved by an atomic increment of the write cursor, so no lock is needed even though the neighbor may be inside a block another thread writes.
+	Storm::runParallel(_symmetricSearchBlocks, [this, &receivesFoundPairs, ownerPackedSlot](const SymmetricSearchBlock &searchBlock, const std::size_t blockIndex)
+	{
+		const std::size_t firstPIndex = blockIndex << k_blockParticleCountShift;
+		const std::size_t blockPCount = searchBlock._forwardEnds.size();
+
+		uint32_t forwardIter = 0;
+		for (std::size_t inBlockPIndex = 0; inBlockPIndex < blockPCount; ++inBlockPIndex)
+		{
+			const uint32_t thisPacked = ownerPackedSlot | static_cast<uint32_t>(firstPIndex + inBlockPIndex);
+			for (const uint32_t forwardEnd = searchBlock._forwardEnds[inBlockPIndex]; forwardIter < forwardEnd; ++forwardIter)
+			{
+				const std::size_t neighborPIndex = searchBlock._forwardNeighbors._packedNeighbors[forwardIter] & k_particleIndexMask;
+				if (receivesFoundPairs(neighborPIndex))
+				{
+					const uint32_t writeIndex = std::atomic_ref<uint32_t>{ _symmetricWriteCursors[neighborPIndex] }.fetch_add(1, std::memory_order_relaxed);
+
+					Block &neighborBlock = _blocks[neighborPIndex >> k_blockParticleCountShift];
+					neighborBlock._packedNeighbors[writeIndex] = thisPacked;
+					neighborBlock._xij[writeIndex] = -searchBlock._forwardNeighbors._xij[forwardIter];
+					neighborBlock._Wij[writeIndex] = searchBlock._forwardNeighbors._Wij[forwardIter];
+					neighborBlock._gradWij[writeIndex] = -searchBlock._forwardNeighbors._gradWij[forwardIter];
+				}
+			}
+		}
+	});
+
+	// Finally, the order the pairs were written in depends on the threads. Sort the neighbors that found each particle (they're after its forward neighbors, until the write cursor) to get the same neighborhoods each time.
+	// The forward neighbors are already in a deterministic order (the search order). The pairs found by one block are written in particle order, and the blocks mostly run in order,
+	// so those ranges are nearly sorted : an insertion sort in place is cheaper than copying them out to sort them.
+	Storm::runParallel(_blocks, [this, particleCount](Block &block, const std::size_t blockIndex)
+	{
+		const SymmetricSearchBlock &searchBlock = _symmetricSearchBlocks[blockIndex];
+
+		const std::size_t firstPIndex = blockIndex << k_blockParticleCountShift;
+		const std::size_t endPIndex = std::min(firstPIndex + k_blockParticleCount, particleCount);
+		for (std::size_t particleIndex = firstPIndex; particleIndex < endPIndex; ++particleIndex)
+		{
+			const std::size_t inBlockPIndex = particleIndex - firstPIndex;
+			const uint32_t forwardBegin = inBlockPIndex != 0 ? searchBlock._forwardEnds[inBlockPIndex - 1] : 0;
+
+			const std::size_t beginOffset = _offsets[particleIndex] + (searchBlock._forwardEnds[inBlockPIndex] - forwardBegin);
+			const std::size_t endOffset = _symmetricWriteCursors[particleIndex];
+
+			for (std::size_t offset = beginOffset + 1; offset < endOffset; ++offset)
+			{
+				const uint32_t packedNeighbor = block._packedNeighbors[offset];
+				if (packedNeighbor > block._packedNeighbors[offset - 1])
+				{
+					continue;
+				}
+
+				const Storm::Vector3 xij = block._xij[offset];
+				const float wij = block._Wij[offset];
+				const Storm::Vector3 gradWij = block._gradWij[offset];
+
+				std::size_t insertOffset = offset;
+				do
+				{
+					block._packedNeighbors[insertOffset] = block._packedNeighbors[insertOffset - 1];
+					block._xij[insertOffset] = block._xij[insertOffset - 1];
+					block._Wij[insertOffset] = block._Wij[insertOffset - 1];
+					block._gradWij[insertOffset] = block._gradWij[insertOffset - 1];
+					--insertOffset;
+				} while (insertOffset != beginOffset && block._packedNeighbors[insertOffset - 1] > packedNeighbor);
+
+				block._packedNeighbors[insertOffset] = packedNeighbor;
+				block._xij[insertOffset] = xij;
+				block._Wij[insertOffset] = wij;
+				block._gradWij[insertOffset] = gradWij;
+			}
+		}
+	});
+}
+
+std::size_t Storm::ParticleNeighborhoodStorage::getNeighborhoodEndOffset(const std::size_t particleIndex) const
+{
+	const std::size_t nextPIndex = particleIndex + 1;
+	if ((nextPIndex & (k_blockParticleCount - 1)) != 0 && nextPIndex < _offsets.size())
+	{
+		return _offsets[nextPIndex];
+	}
+
+	return _blocks[particleIndex >> k_blockParticleCountShift]._packedNeighbors.size();
+}
+
+std::size_t Storm::ParticleNeighborhoodStorage::getPreviousNeighborhoodEndOffset(const std::size_t particleIndex) const
+{
+	const std::size_t nextPIndex = particleIndex + 1;
+	if ((nextPIndex & (k_blockParticleCount - 1)) != 0 && nextPIndex < _previousOffsets.size())
+	{
+		return _previousOffsets[nextPIndex];
+	}
+
+	return _previousBlocks[particleIndex >> k_blockParticleCountShift]._packedNeighbors.size();
+}
+
+bool Storm::ParticleNeighborhoodStorage::isPreviousNeighborhoodInsideKernelSupport(const std::size_t particleIndex) const
+{
+	const Block &previousBlock = _previousBlocks[particleIndex >> k_blockParticleCountShift];
+	const Storm::Vector3 &currentPPosition = (*_ownerPositions)[particleIndex];
+	const float kernelLengthSquared = _kernelLength * _kernelLength;
+
+	const std::size_t endOffset = this->getPreviousNeighborhoodEndOffset(particleIndex);
+	for (std::size_t offset = _previousOffsets[particleIndex]; offset < endOffset; ++offset)
+	{
+		const uint32_t packedNeighbor = previousBlock._packedNeighbors[offset];
+		const std::vector<Storm::Vector3> &neighborPositions = *_referencedPSystems[packedNeighbor >> k_particleIndexBitCount]._positions;
+
+		Storm::Vector3 xij = currentPPosition - neighborPositions[packedNeighbor & k_particleIndexMask];
+		this->applyDomainReflection(xij);
+
+		if (xij.squaredNorm() > kernelLengthSquared)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
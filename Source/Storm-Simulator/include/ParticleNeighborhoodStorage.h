@@ -0,0 +1,508 @@
+#pragma once
+
+#include "NeighborParticleInfo.h"
+
+#include "RunnerHelper.h"
+
+
+namespace Storm
+{
+	class ParticleNeighborhoodStorage;
+
+	// A view on the neighborhood of one particle stored inside a ParticleNeighborhoodStorage.
+	// The neighbors are rebuilt (by value) when accessed, from the compact data.
+	class ParticleNeighborhoodArray
+	{
+	public:
+		class Iterator
+		{
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = Storm::NeighborParticleInfo;
+			using difference_type = std::ptrdiff_t;
+			using pointer = void;
+			using reference = Storm::NeighborParticleInfo;
+
+		public:
+			Iterator(const Storm::ParticleNeighborhoodArray &owner, const std::size_t neighborIndex) :
+				_owner{ &owner },
+				_neighborIndex{ neighborIndex }
+			{}
+
+		public:
+			__forceinline Storm::NeighborParticleInfo operator*() const
+			{
+				return (*_owner)[_neighborIndex];
+			}
+
+			__forceinline Iterator& operator++()
+			{
+				++_neighborIndex;
+				return *this;
+			}
+
+			__forceinline Iterator operator++(int)
+			{
+				Iterator result = *this;
+				++_neighborIndex;
+				return result;
+			}
+
+			__forceinline bool operator==(const Iterator &other) const noexcept
+			{
+				return _neighborIndex == other._neighborIndex;
+			}
+
+			__forceinline bool operator!=(const Iterator &other) const noexcept
+			{
+				return _neighborIndex != other._neighborIndex;
+			}
+
+		private:
+			const Storm::ParticleNeighborhoodArray* _owner;
+			std::size_t _neighborIndex;
+		};
+
+	public:
+		ParticleNeighborhoodArray(const Storm::ParticleNeighborhoodStorage &storage, const Storm::Vector3 &currentPPosition, const uint32_t*const packedNeighbors, const Storm::Vector3*const xij, const float*const wij, const Storm::Vector3*const gradWij, const std::size_t neighborCount) :
+			_storage{ &storage },
+			_currentPPosition{ &currentPPosition },
+			_packedNeighbors{ packedNeighbors },
+			_xij{ xij },
+			_Wij{ wij },
+			_gradWij{ gradWij },
+			_neighborCount{ neighborCount }
+		{}
+
+	public:
+		__forceinline std::size_t size() const noexcept
+		{
+			return _neighborCount;
+		}
+
+		__forceinline bool empty() const noexcept
+		{
+			return _neighborCount == 0;
+		}
+
+		__forceinline Iterator begin() const
+		{
+			return Iterator{ *this, 0 };
+		}
+
+		__forceinline Iterator end() const
+		{
+			return Iterator{ *this, _neighborCount };
+		}
+
+		Storm::NeighborParticleInfo operator[](const std::size_t neighborIndex) const;
+
+	private:
+		const Storm::ParticleNeighborhoodStorage* _storage;
+		const Storm::Vector3* _currentPPosition;
+		const uint32_t* _packedNeighbors;
+		const Storm::Vector3* _xij;
+		const float* _Wij;
+		const Storm::Vector3* _gradWij;
+		std::size_t _neighborCount;
+	};
+
+	// The neighborhood of all particles of one particle system, stored as a structure of arrays.
+	// Each neighbor is packed into 32 bits (the referenced particle system slot in the high bits, the particle index in the low bits) with xij and its kernel values besides.
+	// xij is cached since recomputing it from the positions when iterating (one random access to the neighbor position per neighbor) made the solver loops around 15% slower, for 12 bytes per neighbor.
+	// Its norm isn't stored, it is cheap to recompute (the storage stays around 3.5 times lighter than an array of NeighborParticleInfo).
+	// Like the kernel values, xij is the one of the positions when the neighborhoods were filled : the neighborhoods should be built (or refreshed) before being used,
+	// and a kept neighborhood (see fillKeepingPrevious) is only valid if its particle and all its neighbors didn't move, and if the kernel length is the same.
+	//
+	// The particles are grouped by blocks of k_blockParticleCount that are filled independently, so the parallel build doesn't need a count pass before the fill.
+	// Inside a block, the neighbors of consecutive particles are contiguous in memory.
+	class ParticleNeighborhoodStorage
+	{
+	private:
+		friend class Storm::ParticleNeighborhoodArray;
+
+		struct Block
+		{
+		public:
+			void clear();
+			std::size_t computeUsedMemory() const;
+
+		public:
+			std::vector<uint32_t> _packedNeighbors;
+			std::vector<Storm::Vector3> _xij;
+			std::vector<float> _Wij;
+			std::vector<Storm::Vector3> _gradWij;
+		};
+
+		// What the particles of one block found during the search step of fillSymmetric, before it is scattered into the real blocks.
+		struct SymmetricSearchBlock
+		{
+		public:
+			void clear();
+
+		public:
+			// The pairs of particles of the owner system found by the particles of the block (each pair is found by only one of its 2 particles).
+			Block _forwardNeighbors;
+			// All the other neighbors (other particle systems), that aren't shared.
+			Block _otherNeighbors;
+
+			// Per particle of the block, the end of its neighbors inside _forwardNeighbors and _otherNeighbors.
+			std::vector<uint32_t> _forwardEnds;
+			std::vector<uint32_t> _otherEnds;
+
+			// Per particle of the block, false if the particle shouldn't have any neighborhood (its forward neighbors would still have it as neighbor).
+			std::vector<bool> _hasNeighborhood;
+
+			// Per particle of the block, true if the particle got back its previous neighborhood (see fillSymmetricKeepingPrevious). Its neighbors from the owner system are inside _forwardNeighbors.
+			std::vector<bool> _keepsPrevious;
+		};
+
+	public:
+		struct ReferencedParticleSystem
+		{
+		public:
+			Storm::ParticleSystem* _pSystem;
+			const std::vector<Storm::Vector3>* _positions;
+			bool _isFluid;
+		};
+
+		// What the neighborhoods are filled from. The particle systems are referenced by their slot inside _referencedPSystems.
+		struct NeighborSources
+		{
+		public:
+			std::vector<Storm::ParticleNeighborhoodStorage::ReferencedParticleSystem> _referencedPSystems;
+
+			// In infinite domain mode, the neighbors can come from the other side of the domain.
+			bool _infiniteDomain;
+			Storm::Vector3 _domainDimension;
+
+			// The kernel length the kernel values will be computed with.
+			float _kernelLength;
+		};
+
+	public:
+		enum : std::size_t
+		{
+			k_blockParticleCountShift = 8,
+			k_blockParticleCount = static_cast<std::size_t>(1) << k_blockParticleCountShift,
+
+			k_particleIndexBitCount = 24,
+			k_particleIndexMask = (static_cast<std::size_t>(1) << k_particleIndexBitCount) - 1,
+
+			k_maxParticleCountPerSystem = k_particleIndexMask + 1,
+			k_maxReferencedParticleSystemCount = static_cast<std::size_t>(1) << (32 - k_particleIndexBitCount),
+		};
+
+	public:
+		ParticleNeighborhoodStorage(const std::vector<Storm::Vector3> &ownerPositions);
+		~ParticleNeighborhoodStorage();
+
+	public:
+		// The particle count.
+		std::size_t size() const noexcept;
+
+		// The total neighbor count (sum of all particle neighborhood sizes).
+		std::size_t getNeighborCount() const;
+
+		Storm::ParticleNeighborhoodArray operator[](const std::size_t particleIndex) const;
+
+		// A view without any neighbor, for the particles we don't want to compute the interactions with their neighbors.
+		Storm::ParticleNeighborhoodArray getEmptyNeighborhood(const std::size_t particleIndex) const;
+
+	public:
+		// Clear all neighborhoods and size the storage to the owner particle count. This must be called before filling the neighborhoods since this is where we register the particle systems neighbors can come from.
+		void reset(const Storm::ParticleNeighborhoodStorage::NeighborSources &sources);
+
+		// Same as reset, but the current neighborhoods are kept aside to be reused by fillKeepingPrevious.
+		// They can only be reused if the particle count, the registered particle systems and the kernel length didn't change (see hasPreviousNeighborhoods).
+		void resetKeepingPrevious(const Storm::ParticleNeighborhoodStorage::NeighborSources &sources);
+		bool hasPreviousNeighborhoods() const noexcept;
+
+		// The current neighborhoods won't be reused by the next resetKeepingPrevious. To call when they don't match the particles anymore (but we still want to keep the storage capacity).
+		void invalidate();
+
+		// The added particles have an empty neighborhood. When shrinking, the removed particles are the last ones.
+		void resize(const std::size_t particleCount);
+
+		// Fill all particles neighborhoods in parallel. searchFunc(Storm::ParticleNeighborhoodBuildArray &outNeighborhood, const std::size_t particleIndex) is called once per particle with an empty array to fill.
+		template<class SearchFunc>
+		void fill(const SearchFunc &searchFunc)
+		{
+			assert(!_referencedPSystems.empty() && "The neighborhood storage should have been reset before being filled!");
+
+			Storm::runParallel(_blocks, [this, &searchFunc, particleCount = _offsets.size()](Block &block, const std::size_t blockIndex)
+			{
+				block.clear();
+
+				Storm::ParticleNeighborhoodBuildArray currentPNeighborhood;
+				currentPNeighborhood.reserve(64);
+
+				const std::size_t firstPIndex = blockIndex << k_blockParticleCountShift;
+				const std::size_t endPIndex = std::min(firstPIndex + k_blockParticleCount, particleCount);
+				for (std::size_t particleIndex = firstPIndex; particleIndex < endPIndex; ++particleIndex)
+				{
+					_offsets[particleIndex] = static_cast<uint32_t>(block._packedNeighbors.size());
+
+					currentPNeighborhood.clear();
+					searchFunc(currentPNeighborhood, particleIndex);
+
+					this->appendToBlock(block, currentPNeighborhood);
+				}
+			});
+		}
+
+		// Same as fill, but the particles for which shouldKeepPrevious(const std::size_t particleIndex) returns true get back the neighborhood they had before resetKeepingPrevious instead of searching it.
+		// The kept neighbors are the same particles with the same xij and kernel values. Therefore, a particle should keep its neighborhood only if it and all particles that could be its neighbors didn't move since
+		// (the kernel values would not match xij anymore otherwise). The debug builds check that the kept neighbors are still inside the kernel support.
+		// If there is no previous neighborhood to keep, this is a fill.
+		template<class SearchFunc, class KeepPredicate>
+		void fillKeepingPrevious(const SearchFunc &searchFunc, const KeepPredicate &shouldKeepPrevious)
+		{
+			if (!_hasPreviousNeighborhoods)
+			{
+				this->fill(searchFunc);
+				return;
+			}
+
+			Storm::runParallel(_blocks, [this, &searchFunc, &shouldKeepPrevious, particleCount = _offsets.size()](Block &block, const std::size_t blockIndex)
+			{
+				block.clear();
+
+				Storm::ParticleNeighborhoodBuildArray currentPNeighborhood;
+				currentPNeighborhood.reserve(64);
+
+				const std::size_t firstPIndex = blockIndex << k_blockParticleCountShift;
+				const std::size_t endPIndex = std::min(firstPIndex + k_blockParticleCount, particleCount);
+				for (std::size_t particleIndex = firstPIndex; particleIndex < endPIndex; ++particleIndex)
+				{
+					_offsets[particleIndex] = static_cast<uint32_t>(block._packedNeighbors.size());
+
+					if (shouldKeepPrevious(particleIndex))
+					{
+						this->appendPreviousToBlock(block, particleIndex);
+					}
+					else
+					{
+						currentPNeighborhood.clear();
+						searchFunc(currentPNeighborhood, particleIndex);
+
+						this->appendToBlock(block, currentPNeighborhood);
+					}
+				}
+			});
+		}
+
+		// Same as fill, but the neighbors from the owner particle system are searched only once per pair, then written in both neighborhoods (Wij is the same, xij and gradWij are negated).
+		// searchFunc(Storm::ParticleNeighborhoodBuildArray &outForwardNeighborhood, Storm::ParticleNeighborhoodBuildArray &outOtherNeighborhood, const std::size_t particleIndex) is called once per particle with empty arrays to fill, already with their kernel values.
+		// outForwardNeighborhood should only receive the particles of the owner system such as each pair is found by only one of its particles (see Storm::ISpacePartitionerManager::getForwardBundles), outOtherNeighborhood receives the neighbors from other particle systems.
+		// searchFunc returns false if the particle shouldn't have any neighborhood. It should still fill its forward neighbors since they won't find it themselves.
+		// The neighbors from the owner particle system are sorted by particle index, so the result doesn't depend on the threads scheduling.
+		template<class SearchFunc>
+		void fillSymmetric(const SearchFunc &searchFunc)
+		{
+			this->fillSymmetricImpl<false>(searchFunc, [](const std::size_t) { return false; });
+		}
+
+		// Same as fillSymmetric, but the particles for which shouldKeepPrevious(const std::size_t particleIndex) returns true get back the neighborhood they had before resetKeepingPrevious, without searching anything (same requirements than fillKeepingPrevious).
+		// The other particles don't take the pairs they have with the kept particles from their search, those are written from the kept neighborhoods. If there is no previous neighborhood to keep, this is a fillSymmetric.
+		template<class SearchFunc, class KeepPredicate>
+		void fillSymmetricKeepingPrevious(const SearchFunc &searchFunc, const KeepPredicate &shouldKeepPrevious)
+		{
+			if (!_hasPreviousNeighborhoods)
+			{
+				this->fillSymmetric(searchFunc);
+				return;
+			}
+
+			this->fillSymmetricImpl<true>(searchFunc, shouldKeepPrevious);
+		}
+
+		// Replace the neighborhood of one particle. This is slower than fill since the particles after it inside the same block must be shifted. Only for debugging purpose.
+		void setParticleNeighborhood(const std::size_t particleIndex, const Storm::ParticleNeighborhoodBuildArray &neighborhood);
+
+	public:
+		// The memory (in bytes) allocated by this storage.
+		std::size_t computeUsedMemory() const;
+
+		// An estimation of the memory (in bytes) the same neighborhoods would have taken stored as one array of NeighborParticleInfo per particle (with the capacity of 64 we used to reserve).
+		std::size_t computePerParticleArrayLayoutMemory() const;
+
+	private:
+		template<bool keepPrevious, class SearchFunc, class KeepPredicate>
+		void fillSymmetricImpl(const SearchFunc &searchFunc, const KeepPredicate &shouldKeepPrevious)
+		{
+			assert(!_referencedPSystems.empty() && "The neighborhood storage should have been reset before being filled!");
+
+			const std::size_t particleCount = _offsets.size();
+			_symmetricSearchBlocks.resize(_blocks.size());
+
+			const uint32_t ownerPackedSlot = static_cast<uint32_t>(this->findOwnerSlot() << k_particleIndexBitCount);
+
+			Storm::runParallel(_symmetricSearchBlocks, [this, &searchFunc, &shouldKeepPrevious, particleCount, ownerPackedSlot](SymmetricSearchBlock &searchBlock, const std::size_t blockIndex)
+			{
+				searchBlock.clear();
+
+				Storm::ParticleNeighborhoodBuildArray forwardNeighborhood;
+				forwardNeighborhood.reserve(32);
+
+				Storm::ParticleNeighborhoodBuildArray otherNeighborhood;
+				otherNeighborhood.reserve(32);
+
+				const std::size_t firstPIndex = blockIndex << k_blockParticleCountShift;
+				const std::size_t endPIndex = std::min(firstPIndex + k_blockParticleCount, particleCount);
+				for (std::size_t particleIndex = firstPIndex; particleIndex < endPIndex; ++particleIndex)
+				{
+					bool hasNeighborhood = true;
+					bool keepsPrevious = false;
+					if constexpr (keepPrevious)
+					{
+						keepsPrevious = shouldKeepPrevious(particleIndex);
+					}
+
+					if (keepsPrevious)
+					{
+						this->appendPreviousToSearchBlock(searchBlock, particleIndex, ownerPackedSlot);
+					}
+					else
+					{
+						forwardNeighborhood.clear();
+						otherNeighborhood.clear();
+
+						hasNeighborhood = searchFunc(forwardNeighborhood, otherNeighborhood, particleIndex);
+
+						if constexpr (keepPrevious)
+						{
+							// The pairs with the kept particles are written from their neighborhoods.
+							this->appendToBlockIf(searchBlock._forwardNeighbors, forwardNeighborhood, [&shouldKeepPrevious](const Storm::NeighborParticleInfo &neighbor)
+							{
+								return !shouldKeepPrevious(neighbor._particleIndex);
+							});
+						}
+						else
+						{
+							this->appendToBlock(searchBlock._forwardNeighbors, forwardNeighborhood);
+						}
+						if (hasNeighborhood)
+						{
+							this->appendToBlock(searchBlock._otherNeighbors, otherNeighborhood);
+						}
+					}
+
+					searchBlock._forwardEnds.emplace_back(static_cast<uint32_t>(searchBlock._forwardNeighbors._packedNeighbors.size()));
+					searchBlock._otherEnds.emplace_back(static_cast<uint32_t>(searchBlock._otherNeighbors._packedNeighbors.size()));
+					searchBlock._hasNeighborhood.push_back(hasNeighborhood);
+					searchBlock._keepsPrevious.push_back(keepsPrevious);
+				}
+			});
+
+			this->scatterSymmetricSearch(ownerPackedSlot);
+		}
+
+		void appendToBlock(Block &block, const Storm::ParticleNeighborhoodBuildArray &neighborhood) const;
+		void appendPreviousToBlock(Block &block, const std::size_t particleIndex) const;
+
+		template<class Predicate>
+		void appendToBlockIf(Block &block, const Storm::ParticleNeighborhoodBuildArray &neighborhood, const Predicate &predicate) const
+		{
+			std::size_t lastSlot = 0;
+			for (const Storm::NeighborParticleInfo &neighbor : neighborhood)
+			{
+				if (predicate(neighbor))
+				{
+					block._packedNeighbors.emplace_back(this->packNeighbor(neighbor, lastSlot));
+					block._xij.emplace_back(neighbor._xij);
+					block._Wij.emplace_back(neighbor._Wij);
+					block._gradWij.emplace_back(neighbor._gradWij);
+				}
+			}
+		}
+
+		// The previous neighbors of the owner system go to the forward neighbors (to be written in both directions), the others to the other neighbors.
+		void appendPreviousToSearchBlock(SymmetricSearchBlock &searchBlock, const std::size_t particleIndex, const uint32_t ownerPackedSlot) const;
+		uint32_t packNeighbor(const Storm::NeighborParticleInfo &neighbor, std::size_t &inOutLastSlot) const;
+
+		std::size_t getNeighborhoodEndOffset(const std::size_t particleIndex) const;
+		std::size_t getPreviousNeighborhoodEndOffset(const std::size_t particleIndex) const;
+
+		// Debugging purpose : a kept neighbor outside the kernel support moved since its neighborhood was built.
+		bool isPreviousNeighborhoodInsideKernelSupport(const std::size_t particleIndex) const;
+
+		// The slot of the owner particle system inside _referencedPSystems.
+		std::size_t findOwnerSlot() const;
+
+		// The end of fillSymmetric : count the neighbors of each particle, then write them (both directions of each pair) to their final place.
+		void scatterSymmetricSearch(const uint32_t ownerPackedSlot);
+
+		// Neighbors from the other side of the domain (infinite domain) are found by getting xij back to the nearest image. Returns true if xij wasn't reflected.
+		__forceinline bool applyDomainReflection(Storm::Vector3 &inOutXij) const
+		{
+			bool notReflected = true;
+			if (_infiniteDomain)
+			{
+				for (int coord = 0; coord < 3; ++coord)
+				{
+					float &xijCoord = inOutXij[coord];
+					if (xijCoord > _halfDomainDimension[coord])
+					{
+						xijCoord -= _domainDimension[coord];
+						notReflected = false;
+					}
+					else if (xijCoord < -_halfDomainDimension[coord])
+					{
+						xijCoord += _domainDimension[coord];
+						notReflected = false;
+					}
+				}
+			}
+
+			return notReflected;
+		}
+
+	private:
+		// Per particle, the offset of its first neighbor inside its block. Its last neighbor is just before the first neighbor of the next particle (or the end of the block).
+		std::vector<uint32_t> _offsets;
+		std::vector<Block> _blocks;
+
+		std::vector<ReferencedParticleSystem> _referencedPSystems;
+		float _kernelLength;
+
+		// The neighborhoods before the last resetKeepingPrevious (same layout than _offsets and _blocks).
+		std::vector<uint32_t> _previousOffsets;
+		std::vector<Block> _previousBlocks;
+		std::vector<ReferencedParticleSystem> _previousReferencedPSystems;
+
+		// fillSymmetric temporaries, kept to not reallocate them at each build.
+		std::vector<SymmetricSearchBlock> _symmetricSearchBlocks;
+		std::vector<uint32_t> _symmetricWriteCursors;
+		const std::vector<Storm::Vector3>* _ownerPositions;
+
+		bool _hasPreviousNeighborhoods;
+
+		bool _infiniteDomain;
+		Storm::Vector3 _domainDimension;
+		Storm::Vector3 _halfDomainDimension;
+	};
+}
+
+__forceinline Storm::NeighborParticleInfo Storm::ParticleNeighborhoodArray::operator[](const std::size_t neighborIndex) const
+{
+	const uint32_t packedNeighbor = _packedNeighbors[neighborIndex];
+	const Storm::ParticleNeighborhoodStorage::ReferencedParticleSystem &referencedPSystem = _storage->_referencedPSystems[packedNeighbor >> Storm::ParticleNeighborhoodStorage::k_particleIndexBitCount];
+	const std::size_t particleIndex = packedNeighbor & Storm::ParticleNeighborhoodStorage::k_particleIndexMask;
+
+	const Storm::Vector3 &xij = _xij[neighborIndex];
+
+	// The reflection isn't stored. It is only needed in infinite domain mode, where we find it back from the positions.
+	bool notReflected = true;
+	if (_storage->_infiniteDomain)
+	{
+		Storm::Vector3 positionDifference = *_currentPPosition - (*referencedPSystem._positions)[particleIndex];
+		notReflected = _storage->applyDomainReflection(positionDifference);
+	}
+
+	Storm::NeighborParticleInfo result{ referencedPSystem._pSystem, particleIndex, xij, xij.squaredNorm(), referencedPSystem._isFluid, notReflected };
+	result._Wij = _Wij[neighborIndex];
+	result._gradWij = _gradWij[neighborIndex];
+
+	return result;
+}
@@ -0,0 +1,111 @@
+#include "ParticleReorderer.h"
+
+#include "ParticleSystem.h"
+
+#include "SceneSimulationConfig.h"
+
+#include "MortonCode.h"
+
+#define STORM_HIJACKED_TYPE std::pair<uint64_t, std::size_t>
+#	include "VectHijack.h"
+#undef STORM_HIJACKED_TYPE
+
+
+Storm::ParticleReorderer::ParticleReorderer(const Storm::SceneSimulationConfig &sceneSimulationConfig) :
+	_reorderingStep{ sceneSimulationConfig._particleReorderingStep },
+	_localityThreshold{ sceneSimulationConfig._particleReorderingLocalityThreshold },
+	_particleDiameter{ sceneSimulationConfig._particleRadius * 2.f },
+	_frameCountSinceLastReordering{ 0 }
+{
+
+}
+
+Storm::ParticleReorderer::~ParticleReorderer() = default;
+
+bool Storm::ParticleReorderer::isEnabled(const Storm::SceneSimulationConfig &sceneSimulationConfig)
+{
+	return sceneSimulationConfig._particleReorderingStep > 0 || sceneSimulationConfig._particleReorderingLocalityThreshold > 0.f;
+}
+
+void Storm::ParticleReorderer::onFrameAdvanced()
+{
+	++_frameCountSinceLastReordering;
+}
+
+void Storm::ParticleReorderer::onReorderingDone()
+{
+	_frameCountSinceLastReordering = 0;
+}
+
+bool Storm::ParticleReorderer::shouldReorder(const Storm::ParticleSystem &pSystem) const
+{
+	if (_reorderingStep > 0 && _frameCountSinceLastReordering >= _reorderingStep)
+	{
+		return true;
+	}
+	else if (_localityThreshold > 0.f)
+	{
+		return this->computeLocalityMetric(pSystem.getPositions()) > _localityThreshold;
+	}
+
+	return false;
+}
+
+void Storm::ParticleReorderer::computeMortonOrder(const std::vector<Storm::Vector3> &positions, const float voxelLength, std::vector<std::size_t> &outNewToOldIndexes)
+{
+	const std::size_t particleCount = positions.size();
+
+	outNewToOldIndexes.clear();
+	if (particleCount == 0)
+	{
+		return;
+	}
+
+	// The voxel grid starts at the minimal corner of the particle system bounding box, so that all voxel coordinates are positive.
+	const Storm::Vector3 minCorner = std::reduce(std::execution::par, std::begin(positions), std::end(positions), positions[0], [](const Storm::Vector3 &left, const Storm::Vector3 &right) -> Storm::Vector3
+	{
+		return left.cwiseMin(right);
+	});
+
+	const float voxelLengthInv = 1.f / voxelLength;
+
+	Storm::setNumUninitialized_safeHijack(_mortonCodes, Storm::VectorHijacker{ particleCount });
+
+	Storm::runParallel(_mortonCodes, [&positions, &minCorner, voxelLengthInv](std::pair<uint64_t, std::size_t> &code, const std::size_t particleIndex)
+	{
+		const Storm::Vector3 voxelCoord = (positions[particleIndex] - minCorner) * voxelLengthInv;
+
+		constexpr float k_maxCoordinate = static_cast<float>(Storm::MortonCode::k_maxCoordinate);
+		code.first = Storm::MortonCode::encode(
+			static_cast<uint32_t>(std::min(voxelCoord.x(), k_maxCoordinate)),
+			static_cast<uint32_t>(std::min(voxelCoord.y(), k_maxCoordinate)),
+			static_cast<uint32_t>(std::min(voxelCoord.z(), k_maxCoordinate))
+		);
+		code.second = particleIndex;
+	});
+
+	// Particles inside the same voxel keep their relative order (the pair comparison falls back to the index), so the result is deterministic.
+	std::sort(std::execution::par, std::begin(_mortonCodes), std::end(_mortonCodes));
+
+	outNewToOldIndexes.reserve(particleCount);
+	for (const std::pair<uint64_t, std::size_t> &code : _mortonCodes)
+	{
+		outNewToOldIndexes.emplace_back(code.second);
+	}
+}
+
+float Storm::ParticleReorderer::computeLocalityMetric(const std::vector<Storm::Vector3> &positions) const
+{
+	const std::size_t particleCount = positions.size();
+	if (particleCount < 2)
+	{
+		return 0.f;
+	}
+
+	const float totalDistance = std::transform_reduce(std::execution::par, std::begin(positions) + 1, std::end(positions), std::begin(positions), 0.f, std::plus<float>{}, [](const Storm::Vector3 &current, const Storm::Vector3 &previous)
+	{
+		return (current - previous).norm();
+	});
+
+	return totalDistance / (static_cast<float>(particleCount - 1) * _particleDiameter);
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "RunnerHelper.h"
+
+
+namespace Storm
+{
+	class ParticleSystem;
+	struct SceneSimulationConfig;
+
+	// Sorts the particles of a system following the Morton code (Z-order) of the voxel they are inside, so that particles near in space become near in memory.
+	// This is done periodically (each reordering step frames), or when the particle storage locality degrades too much.
+	class ParticleReorderer
+	{
+	public:
+		ParticleReorderer(const Storm::SceneSimulationConfig &sceneSimulationConfig);
+		~ParticleReorderer();
+
+	public:
+		static bool isEnabled(const Storm::SceneSimulationConfig &sceneSimulationConfig);
+
+	public:
+		void onFrameAdvanced();
+		void onReorderingDone();
+
+		bool shouldReorder(const Storm::ParticleSystem &pSystem) const;
+
+		// Computes the permutation to apply to the particle system : outNewToOldIndexes[newIndex] is the current index of the particle that must be moved at newIndex.
+		void computeMortonOrder(const std::vector<Storm::Vector3> &positions, const float voxelLength, std::vector<std::size_t> &outNewToOldIndexes);
+
+		// The locality metric is the average distance between 2 consecutive particles inside the storage, expressed in particle diameter.
+		float computeLocalityMetric(const std::vector<Storm::Vector3> &positions) const;
+
+	public:
+		// Apply the permutation computed by computeMortonOrder to a per particle array.
+		template<class Type>
+		static void applyPermutation(std::vector<Type> &inOutArray, const std::vector<std::size_t> &newToOldIndexes)
+		{
+			if (inOutArray.empty())
+			{
+				return;
+			}
+
+			assert(inOutArray.size() == newToOldIndexes.size() && "The permutation should have the same particle count than the array to reorder!");
+
+			std::vector<Type> reordered(inOutArray.size());
+			Storm::runParallel(reordered, [&inOutArray, &newToOldIndexes](Type &value, const std::size_t newIndex)
+			{
+				value = std::move(inOutArray[newToOldIndexes[newIndex]]);
+			});
+
+			inOutArray = std::move(reordered);
+		}
+
+	private:
+		unsigned int _reorderingStep;
+		float _localityThreshold;
+		float _particleDiameter;
+
+		unsigned int _frameCountSinceLastReordering;
+
+		// Tmp buffer to not reallocate the codes each time we reorder.
+		std::vector<std::pair<uint64_t, std::size_t>> _mortonCodes;
+	};
+}
@@ -48,10 +48,10 @@ case Storm::ParticleSelectionMode::Case:					\
 
 		switch (mode)
 		{
-			STORM_PARSE_CASE(Velocity,						"Velocity",							true);
-			STORM_PARSE_CASE(Pressure,						"Pressure",							true);
-			STORM_PARSE_CASE(Viscosity,						"Viscosity",						true);
-			STORM_PARSE_CASE(AllOnParticle,					"All On Particle",					true);
+			STORM_PARSE_CASE(Velocity,						"Velocity",							supportedFeatures._hasVelocities);
+			STORM_PARSE_CASE(Pressure,						"Pressure",							supportedFeatures._hasPressureComponentforces);
+			STORM_PARSE_CASE(Viscosity,						"Viscosity",						supportedFeatures._hasViscosityComponentforces);
+			STORM_PARSE_CASE(AllOnParticle,					"All On Particle",					supportedFeatures._hasForces);
 			STORM_PARSE_CASE(Custom,						"Custom",							true);
 			STORM_PARSE_CASE(Drag,							"Drag",								supportedFeatures._hasDragComponentforces);
 			STORM_PARSE_CASE(DynamicPressure,				"DynamicQ",							supportedFeatures._hasDynamicPressureQForces);
@@ -2,18 +2,53 @@
 
 #include "SingletonHolder.h"
 #include "IConfigManager.h"
+#include "ISpacePartitionerManager.h"
 #include "SimulatorManager.h"
 
 #include "SceneSimulationConfig.h"
 
+#include "Kernel.h"
+#include "ParticleReorderer.h"
+#include "ParticleCompaction.h"
+#include "VerletNeighborhood.h"
+
 #include "RunnerHelper.h"
 
 #include "ThreadingSafety.h"
 
 
+namespace
+{
+	Storm::ParticleNeighborhoodStorage::NeighborSources makeNeighborSources(const Storm::ParticleSystemContainer &allParticleSystems, const float kernelLength)
+	{
+		const Storm::ISpacePartitionerManager &spacePartitionerMgr = Storm::SingletonHolder::instance().getSingleton<Storm::ISpacePartitionerManager>();
+
+		Storm::ParticleNeighborhoodStorage::NeighborSources result{
+			._infiniteDomain = spacePartitionerMgr.isInfiniteDomainMode(),
+			._domainDimension = spacePartitionerMgr.getDomainDimension(),
+			._kernelLength = kernelLength
+		};
+
+		result._referencedPSystems.reserve(allParticleSystems.size());
+		for (const auto &particleSystemPair : allParticleSystems)
+		{
+			Storm::ParticleSystem &pSystem = *particleSystemPair.second;
+			result._referencedPSystems.emplace_back(Storm::ParticleNeighborhoodStorage::ReferencedParticleSystem{
+				._pSystem = &pSystem,
+				._positions = &pSystem.getPositions(),
+				._isFluid = pSystem.isFluids()
+			});
+		}
+
+		return result;
+	}
+}
+
 
 Storm::ParticleSystem::ParticleSystem(unsigned int particleSystemIndex, std::vector<Storm::Vector3> &&worldPositions) :
 	_positions{ std::move(worldPositions) },
+	_neighborhood{ _positions },
+	_neighborhoodCandidates{ _positions },
 	_particleSystemIndex{ particleSystemIndex },
 	_isDirty{ true }
 {
@@ -21,6 +56,8 @@ Storm::ParticleSystem::ParticleSystem(unsigned int particleSystemIndex, std::vec
 }
 
 Storm::ParticleSystem::ParticleSystem(unsigned int particleSystemIndex, const std::size_t particleCount) :
+	_neighborhood{ _positions },
+	_neighborhoodCandidates{ _positions },
 	_particleSystemIndex{ particleSystemIndex },
 	_isDirty{ true }
 {
@@ -50,11 +87,6 @@ void Storm::ParticleSystem::initParticlesCount(const std::size_t particleCount)
 	if (!replayMode)
 	{
 		_neighborhood.resize(particleCount);
-
-		for (auto &neighborHoodArray : _neighborhood)
-		{
-			neighborHoodArray.reserve(64);
-		}
 	}
 }
 
@@ -174,7 +206,7 @@ std::vector<Storm::Vector3>& Storm::ParticleSystem::getTemporaryPressureVelocity
 	return _tmpPressureVelocityIntermediaryForce;
 }
 
-const std::vector<Storm::ParticleNeighborhoodArray>& Storm::ParticleSystem::getNeighborhoodArrays() const noexcept
+const Storm::ParticleNeighborhoodStorage& Storm::ParticleSystem::getNeighborhoodArrays() const noexcept
 {
 	return _neighborhood;
 }
@@ -185,11 +217,16 @@ const Storm::Vector3& Storm::ParticleSystem::getTotalForceNonPhysX() const noexc
 	return _totalForceNonPhysX;
 }
 
-std::vector<Storm::ParticleNeighborhoodArray>& Storm::ParticleSystem::getNeighborhoodArrays() noexcept
+Storm::ParticleNeighborhoodStorage& Storm::ParticleSystem::getNeighborhoodArrays() noexcept
 {
 	return _neighborhood;
 }
 
+const Storm::ParticleNeighborhoodStorage& Storm::ParticleSystem::getNeighborhoodCandidates() const noexcept
+{
+	return _neighborhoodCandidates;
+}
+
 std::size_t Storm::ParticleSystem::getParticleCount() const noexcept
 {
 	return _positions.size();
@@ -200,6 +237,16 @@ unsigned int Storm::ParticleSystem::getId() const noexcept
 	return _particleSystemIndex;
 }
 
+bool Storm::ParticleSystem::hasSleepingParticles() const noexcept
+{
+	return false;
+}
+
+const std::vector<uint8_t>& Storm::ParticleSystem::computeKeptNeighborhoods(const Storm::ParticleSystemContainer &/*allParticleSystems*/, const bool /*fromCandidates*/)
+{
+	Storm::throwException<Storm::Exception>("Particle system " + std::to_string(this->getId()) + " doesn't have sleeping particles, it cannot keep previous neighborhoods!");
+}
+
 bool Storm::ParticleSystem::isDirty() const noexcept
 {
 	return _isDirty;
@@ -225,14 +272,19 @@ void Storm::ParticleSystem::buildNeighborhood(const Storm::ParticleSystemContain
 {
 	assert(Storm::isSimulationThread() && "This method should only be executed inside the simulation thread!");
 
-	// First, clear all neighborhood
-	Storm::runParallel(_neighborhood, [](Storm::ParticleNeighborhoodArray &neighbors)
+	const float kernelLength = Storm::SimulatorManager::instance().getKernelLength();
+
+	// First, clear all neighborhood. If some particles are sleeping, we keep their neighborhood aside since they'll reuse it.
+	if (this->hasSleepingParticles())
 	{
-		neighbors.clear();
-	});
+		_neighborhood.resetKeepingPrevious(makeNeighborSources(allParticleSystems, kernelLength));
+	}
+	else
+	{
+		_neighborhood.reset(makeNeighborSources(allParticleSystems, kernelLength));
+	}
 
 	// Then fill them again with the right data
-	const float kernelLength = Storm::SimulatorManager::instance().getKernelLength();
 	this->buildNeighborhoodOnParticleSystemUsingSpacePartition(allParticleSystems, kernelLength);
 }
 
@@ -244,12 +296,256 @@ void Storm::ParticleSystem::buildSpecificParticleNeighborhood(const Storm::Parti
 		Storm::throwException<Storm::Exception>("pIndex (" + std::to_string(pIndex) + ") is out of range in particle system (" + std::to_string(this->getId()) + ")!");
 	}
 
-	_neighborhood[pIndex].clear();
+	_neighborhood.setParticleNeighborhood(pIndex, Storm::ParticleNeighborhoodBuildArray{});
 
 	const float kernelLength = Storm::SimulatorManager::instance().getKernelLength();
 	this->buildSpecificParticleNeighborhoodOnParticleSystemUsingSpacePartition(allParticleSystems, pIndex, kernelLength);
 }
 
+void Storm::ParticleSystem::buildNeighborhoodCandidates(const Storm::ParticleSystemContainer &allParticleSystems, const float searchLength)
+{
+	assert(Storm::isSimulationThread() && "This method should only be executed inside the simulation thread!");
+
+	// Build the neighborhood as usual but with the enlarged search length, then keep it as candidates.
+	_neighborhood.reset(makeNeighborSources(allParticleSystems, searchLength));
+
+	this->buildNeighborhoodOnParticleSystemUsingSpacePartition(allParticleSystems, searchLength);
+
+	// Swap instead of copying. The previous candidates storage becomes the neighborhood storage, it'll be reset and refilled by the refresh (and we keep its capacity).
+	// Those former candidates shouldn't be taken as the previous neighborhood by sleeping particles.
+	std::swap(_neighborhood, _neighborhoodCandidates);
+	_neighborhood.invalidate();
+
+	_positionsAtNeighborhoodBuild = _positions;
+}
+
+void Storm::ParticleSystem::refreshNeighborhoodFromCandidates(const Storm::ParticleSystemContainer &allParticleSystems, const float kernelLength)
+{
+	assert(Storm::isSimulationThread() && "This method should only be executed inside the simulation thread!");
+	assert(this->hasNeighborhoodCandidates() && "Neighborhood candidates should have been built before refreshing the neighborhood from them!");
+
+	const Storm::SceneSimulationConfig &sceneSimulationConfig = Storm::SingletonHolder::instance().getSingleton<Storm::IConfigManager>().getSceneSimulationConfig();
+
+	const Storm::KernelBatchMethodDelegate kernelBatch = Storm::retrieveKernelBatchMethod(sceneSimulationConfig._kernelMode);
+
+	const auto candidateDisplacementFunc = [](const Storm::NeighborParticleInfo &candidate) -> Storm::Vector3
+	{
+		const Storm::ParticleSystem &candidatePSystem = *candidate._containingParticleSystem;
+		return candidatePSystem._positions[candidate._particleIndex] - candidatePSystem._positionsAtNeighborhoodBuild[candidate._particleIndex];
+	};
+
+	const auto filterCandidates = [this, &kernelBatch, &candidateDisplacementFunc, kernelLength, kernelLengthSquared = kernelLength * kernelLength](Storm::ParticleNeighborhoodBuildArray &currentPNeighborhood, const std::size_t particleIndex)
+	{
+		const Storm::Vector3 currentPDisplacement = _positions[particleIndex] - _positionsAtNeighborhoodBuild[particleIndex];
+		Storm::VerletNeighborhood::filterCandidates(_neighborhoodCandidates[particleIndex], currentPDisplacement, kernelLengthSquared, candidateDisplacementFunc, currentPNeighborhood);
+
+		kernelBatch(kernelLength, currentPNeighborhood);
+	};
+
+	if (this->hasSleepingParticles())
+	{
+		_neighborhood.resetKeepingPrevious(makeNeighborSources(allParticleSystems, kernelLength));
+
+		const std::vector<uint8_t> &keptNeighborhoods = this->computeKeptNeighborhoods(allParticleSystems, true);
+		_neighborhood.fillKeepingPrevious(filterCandidates, [&keptNeighborhoods](const std::size_t particleIndex)
+		{
+			return keptNeighborhoods[particleIndex] != 0;
+		});
+	}
+	else
+	{
+		_neighborhood.reset(makeNeighborSources(allParticleSystems, kernelLength));
+		_neighborhood.fill(filterCandidates);
+	}
+}
+
+bool Storm::ParticleSystem::hasNeighborhoodCandidates() const noexcept
+{
+	const std::size_t particleCount = this->getParticleCount();
+	return
+		_neighborhoodCandidates.size() == particleCount &&
+		_positionsAtNeighborhoodBuild.size() == particleCount
+		;
+}
+
+float Storm::ParticleSystem::computeMaxDisplacementSquaredSinceNeighborhoodBuild() const
+{
+	return Storm::VerletNeighborhood::computeMaxDisplacementSquared(_positions, _positionsAtNeighborhoodBuild);
+}
+
+void Storm::ParticleSystem::reorderParticles(const std::vector<std::size_t> &newToOldIndexes)
+{
+	assert(Storm::isSimulationThread() && "This method should only be executed inside the simulation thread!");
+	assert(newToOldIndexes.size() == this->getParticleCount() && "The reordering should be done on all particles!");
+
+	Storm::ParticleReorderer::applyPermutation(_positions, newToOldIndexes);
+	Storm::ParticleReorderer::applyPermutation(_velocity, newToOldIndexes);
+	Storm::ParticleReorderer::applyPermutation(_force, newToOldIndexes);
+	Storm::ParticleReorderer::applyPermutation(_tmpPressureForce, newToOldIndexes);
+	Storm::ParticleReorderer::applyPermutation(_tmpPressureDensityIntermediaryForce, newToOldIndexes);
+	Storm::ParticleReorderer::applyPermutation(_tmpPressureVelocityIntermediaryForce, newToOldIndexes);
+	Storm::ParticleReorderer::applyPermutation(_tmpViscosityForce, newToOldIndexes);
+	Storm::ParticleReorderer::applyPermutation(_tmpDragForce, newToOldIndexes);
+	Storm::ParticleReorderer::applyPermutation(_tmpBernoulliDynamicPressureForce, newToOldIndexes);
+	Storm::ParticleReorderer::applyPermutation(_tmpNoStickForce, newToOldIndexes);
+	Storm::ParticleReorderer::applyPermutation(_tmpCoandaForce, newToOldIndexes);
+
+	// The neighborhood content is outdated but it is rebuilt before being used anyway.
+	// The Verlet list candidates reference the old indexes though. Drop them to force a full rebuild.
+	_neighborhoodCandidates.resize(0);
+	_positionsAtNeighborhoodBuild.clear();
+
+	const std::size_t particleCount = newToOldIndexes.size();
+	if (_stableIds.empty())
+	{
+		_stableIds = newToOldIndexes;
+	}
+	else
+	{
+		Storm::ParticleReorderer::applyPermutation(_stableIds, newToOldIndexes);
+	}
+
+	// After a compaction, the stable ids can be greater than the particle count (the reverse mapping is already sized to the greatest stable id in this case).
+	if (_stableIdToIndex.size() < particleCount)
+	{
+		_stableIdToIndex.resize(particleCount);
+	}
+
+	for (std::size_t newIndex = 0; newIndex < particleCount; ++newIndex)
+	{
+		_stableIdToIndex[_stableIds[newIndex]] = newIndex;
+	}
+
+	_isDirty = true;
+}
+
+void Storm::ParticleSystem::compactParticles(const Storm::ParticleCompaction &compaction)
+{
+	assert(Storm::isSimulationThread() && "This method should only be executed inside the simulation thread!");
+	assert(compaction.getOldParticleCount() == this->getParticleCount() && "The compaction wasn't computed for this particle system!");
+
+	if (compaction.empty())
+	{
+		return;
+	}
+
+	this->initializeStableIdsIfNeeded();
+
+	compaction.applyToStableIds(_stableIds, _stableIdToIndex);
+	compaction.apply(_positions);
+	compaction.apply(_velocity);
+	compaction.apply(_force);
+	compaction.apply(_tmpPressureForce);
+	compaction.apply(_tmpPressureDensityIntermediaryForce);
+	compaction.apply(_tmpPressureVelocityIntermediaryForce);
+	compaction.apply(_tmpViscosityForce);
+	compaction.apply(_tmpDragForce);
+	compaction.apply(_tmpBernoulliDynamicPressureForce);
+	compaction.apply(_tmpNoStickForce);
+	compaction.apply(_tmpCoandaForce);
+
+	// Same as reorderParticles : the neighborhood is rebuilt before being used, but the Verlet list candidates reference the old indexes.
+	_neighborhood.resize(compaction.getNewParticleCount());
+	_neighborhoodCandidates.resize(0);
+	_positionsAtNeighborhoodBuild.clear();
+
+	_isDirty = true;
+}
+
+void Storm::ParticleSystem::appendParticles(const std::vector<Storm::Vector3> &positions, const Storm::Vector3 &velocity)
+{
+	assert(Storm::isSimulationThread() && "This method should only be executed inside the simulation thread!");
+
+	if (positions.empty())
+	{
+		return;
+	}
+
+	this->initializeStableIdsIfNeeded();
+
+	const std::size_t oldParticleCount = this->getParticleCount();
+	const std::size_t newParticleCount = oldParticleCount + positions.size();
+
+	// The new stable ids follow the greatest stable id ever given, that is the size of the reverse mapping.
+	std::size_t nextStableId = _stableIdToIndex.size();
+	_stableIds.reserve(newParticleCount);
+	for (std::size_t newIndex = oldParticleCount; newIndex < newParticleCount; ++newIndex)
+	{
+		_stableIds.emplace_back(nextStableId++);
+		_stableIdToIndex.emplace_back(newIndex);
+	}
+
+	_positions.insert(std::end(_positions), std::begin(positions), std::end(positions));
+	_velocity.resize(newParticleCount, velocity);
+	_force.resize(newParticleCount, Storm::Vector3::Zero());
+	_tmpPressureForce.resize(newParticleCount, Storm::Vector3::Zero());
+	_tmpPressureDensityIntermediaryForce.resize(newParticleCount, Storm::Vector3::Zero());
+	_tmpPressureVelocityIntermediaryForce.resize(newParticleCount, Storm::Vector3::Zero());
+	_tmpViscosityForce.resize(newParticleCount, Storm::Vector3::Zero());
+	_tmpDragForce.resize(newParticleCount, Storm::Vector3::Zero());
+	_tmpBernoulliDynamicPressureForce.resize(newParticleCount, Storm::Vector3::Zero());
+	_tmpNoStickForce.resize(newParticleCount, Storm::Vector3::Zero());
+	_tmpCoandaForce.resize(newParticleCount, Storm::Vector3::Zero());
+
+	_neighborhood.resize(newParticleCount);
+	_neighborhoodCandidates.resize(0);
+	_positionsAtNeighborhoodBuild.clear();
+
+	_isDirty = true;
+}
+
+void Storm::ParticleSystem::reserveParticles(const std::size_t particleCount)
+{
+	_positions.reserve(particleCount);
+	_velocity.reserve(particleCount);
+	_force.reserve(particleCount);
+	_tmpPressureForce.reserve(particleCount);
+	_tmpPressureDensityIntermediaryForce.reserve(particleCount);
+	_tmpPressureVelocityIntermediaryForce.reserve(particleCount);
+	_tmpViscosityForce.reserve(particleCount);
+	_tmpDragForce.reserve(particleCount);
+	_tmpBernoulliDynamicPressureForce.reserve(particleCount);
+	_tmpNoStickForce.reserve(particleCount);
+	_tmpCoandaForce.reserve(particleCount);
+	_stableIds.reserve(particleCount);
+}
+
+void Storm::ParticleSystem::initializeStableIdsIfNeeded()
+{
+	if (_stableIds.empty())
+	{
+		const std::size_t particleCount = this->getParticleCount();
+		_stableIds.resize(particleCount);
+		for (std::size_t particleIndex = 0; particleIndex < particleCount; ++particleIndex)
+		{
+			_stableIds[particleIndex] = particleIndex;
+		}
+
+		_stableIdToIndex = _stableIds;
+	}
+}
+
+bool Storm::ParticleSystem::hasReorderedParticles() const noexcept
+{
+	return !_stableIds.empty();
+}
+
+const std::vector<std::size_t>& Storm::ParticleSystem::getStableIds() const noexcept
+{
+	return _stableIds;
+}
+
+std::size_t Storm::ParticleSystem::getStableId(const std::size_t particleIndex) const
+{
+	return _stableIds.empty() ? particleIndex : _stableIds[particleIndex];
+}
+
+std::size_t Storm::ParticleSystem::getParticleIndexFromStableId(const std::size_t stableId) const
+{
+	// Out of range ids are returned as is, so that the caller particle existence check fails as it would have without reordering.
+	return stableId < _stableIdToIndex.size() ? _stableIdToIndex[stableId] : stableId;
+}
+
 void Storm::ParticleSystem::initializePreSimulation(const Storm::ParticleSystemContainer &/*allParticleSystems*/, const float /*kernelLengthSquared*/)
 {
 	assert(Storm::isSimulationThread() && "This method should only be executed inside the simulation thread!");
@@ -303,11 +599,6 @@ float Storm::ParticleSystem::computeParticleDefaultVolume()
 	return particleDiameter * particleDiameter * particleDiameter;
 }
 
-bool Storm::ParticleSystem::isElligibleNeighborParticle(const float kernelLengthSquared, const float normSquared)
-{
-	return normSquared > 0.000001f && normSquared < kernelLengthSquared;
-}
-
 void Storm::ParticleSystem::resetParticleTemporaryForces(const std::size_t currentPIndex)
 {
 	_tmpPressureForce[currentPIndex].setZero();
@@ -1,11 +1,12 @@
 #pragma once
 
-#include "NeighborParticleInfo.h"
+#include "ParticleNeighborhoodStorage.h"
 #include "ParticleSystemContainer.h"
 
 namespace Storm
 {
 	class IBlower;
+	class ParticleCompaction;
 
 	class ParticleSystem
 	{
@@ -43,8 +44,11 @@ namespace Storm
 		const std::vector<Storm::Vector3>& getTemporaryPressureVelocityIntermediaryForces() const noexcept;
 		std::vector<Storm::Vector3>& getTemporaryPressureVelocityIntermediaryForces() noexcept;
 
-		const std::vector<Storm::ParticleNeighborhoodArray>& getNeighborhoodArrays() const noexcept;
-		std::vector<Storm::ParticleNeighborhoodArray>& getNeighborhoodArrays() noexcept;
+		const Storm::ParticleNeighborhoodStorage& getNeighborhoodArrays() const noexcept;
+		Storm::ParticleNeighborhoodStorage& getNeighborhoodArrays() noexcept;
+
+		// Verlet list mode only (empty otherwise).
+		const Storm::ParticleNeighborhoodStorage& getNeighborhoodCandidates() const noexcept;
 
 		const Storm::Vector3& getTotalForceNonPhysX() const noexcept;
 
@@ -56,6 +60,9 @@ namespace Storm
 		virtual bool isStatic() const noexcept = 0;
 		virtual bool isWall() const noexcept = 0;
 
+		// Sleeping particles keep their former neighborhood instead of searching it again when the neighborhood is built (see FluidParticleSystem::updateSleeping).
+		virtual bool hasSleepingParticles() const noexcept;
+
 		bool isDirty() const noexcept;
 		void setIsDirty(bool dirty);
 
@@ -92,12 +99,48 @@ namespace Storm
 		// Debugging purpose. This method could be left trailing behind with recent neighborhood building modification done inside buildNeighborhood. The update would only be done when we need to debug!
 		void buildSpecificParticleNeighborhood(const Storm::ParticleSystemContainer &allParticleSystems, const std::size_t pIndex);
 
+		// Verlet list mode. The full search is done with searchLength (the kernel length enlarged by a skin) and its result is kept as candidates.
+		// The real neighborhood is then only a filtered view of those candidates, refreshed with refreshNeighborhoodFromCandidates.
+		// Beware, candidates must be built for all particle systems at the same time, since the refresh uses the displacement of the neighbor particles since the last build.
+		void buildNeighborhoodCandidates(const Storm::ParticleSystemContainer &allParticleSystems, const float searchLength);
+		void refreshNeighborhoodFromCandidates(const Storm::ParticleSystemContainer &allParticleSystems, const float kernelLength);
+
+		bool hasNeighborhoodCandidates() const noexcept;
+		float computeMaxDisplacementSquaredSinceNeighborhoodBuild() const;
+
+	public:
+		// Reorder the particles to improve the memory locality. newToOldIndexes[newIndex] is the current index of the particle that will be moved at newIndex.
+		// Beware, the neighborhoods aren't valid anymore afterward (they must be rebuilt).
+		virtual void reorderParticles(const std::vector<std::size_t> &newToOldIndexes);
+
+		// Open boundaries : remove the particles of the compaction (their order isn't preserved), or append new particles at the end of the arrays.
+		// The appended particles get stable ids that were never used before, and the removed particles stable ids aren't bound to any particle anymore.
+		// Like reorderParticles, the neighborhoods aren't valid anymore afterward.
+		virtual void compactParticles(const Storm::ParticleCompaction &compaction);
+		virtual void appendParticles(const std::vector<Storm::Vector3> &positions, const Storm::Vector3 &velocity);
+
+		// Preallocate the per particle arrays, so that appending particles until particleCount won't reallocate them.
+		virtual void reserveParticles(const std::size_t particleCount);
+
+		// The stable id is the index the particle had before any reordering. This is what should be exposed outside the simulation (records, selection, scripts, ...).
+		bool hasReorderedParticles() const noexcept;
+		const std::vector<std::size_t>& getStableIds() const noexcept;
+		std::size_t getStableId(const std::size_t particleIndex) const;
+		std::size_t getParticleIndexFromStableId(const std::size_t stableId) const;
+
+	private:
+		// Make the stable ids explicit (they're implicit as long as the particles were never reordered, compacted or appended).
+		void initializeStableIdsIfNeeded();
+
 	protected:
 		virtual void buildNeighborhoodOnParticleSystemUsingSpacePartition(const Storm::ParticleSystemContainer &allParticleSystems, const float kernelLength) = 0;
 
 		// Debugging purpose. This method could be left trailing behind recent neighborhood building modification done inside buildNeighborhoodOnParticleSystemUsingSpacePartition (the real one because optimized). The update would only be done when we need to debug the feature!
 		virtual void buildSpecificParticleNeighborhoodOnParticleSystemUsingSpacePartition(const Storm::ParticleSystemContainer &allParticleSystems, const std::size_t pIndex, const float kernelLength) = 0;
 
+		// Only for particle systems with sleeping particles. Returns, per particle, 1 if the particle should keep its previous neighborhood in the neighborhood build in progress (fromCandidates is true for the Verlet list refresh).
+		virtual const std::vector<uint8_t>& computeKeptNeighborhoods(const Storm::ParticleSystemContainer &allParticleSystems, const bool fromCandidates);
+
 	public:
 		virtual void updatePosition(float deltaTimeInSec, bool force) = 0;
 
@@ -115,7 +158,11 @@ namespace Storm
 		static float computeParticleDefaultVolume();
 
 	public:
-		static bool isElligibleNeighborParticle(const float kernelLengthSquared, const float normSquared);
+		// Inline since it is called per neighbor (see Storm::VerletNeighborhood::filterCandidates).
+		static bool isElligibleNeighborParticle(const float kernelLengthSquared, const float normSquared)
+		{
+			return normSquared > 0.000001f && normSquared < kernelLengthSquared;
+		}
 
 	public:
 		virtual void revertToCurrentTimestep(const std::vector<std::unique_ptr<Storm::IBlower>> &blowers) = 0;
@@ -144,14 +191,19 @@ namespace Storm
 		// Note : For static rigid body, it does not contain the static particles neighborhood because we use it only one time (when initializing the volume) and this is a huge lost of computation time !
 		// So when we would need to have the static neighborhood for static rigid body, we should add another array separated from this one and compute it only one time 
 		// => Static rigid bodies doesn't move, so static particles from static rigid bodies would always be the same, at the same position. Thus recomputing it each timestep takes a lot of time for nothing (for getting the same result as the time step before). Therefore, storing the result used from this static neighborhood, instead of recomputing it, is wiser.
-		std::vector<Storm::ParticleNeighborhoodArray> _neighborhood;
+		Storm::ParticleNeighborhoodStorage _neighborhood;
+
+		// Verlet list mode only : the neighborhood computed with the enlarged search length at the last full build, and the particle positions at this time.
+		Storm::ParticleNeighborhoodStorage _neighborhoodCandidates;
+		std::vector<Storm::Vector3> _positionsAtNeighborhoodBuild;
+
+		// Particle index -> stable id, and its reverse. Both are empty as long as the particles were never reordered (the stable id is the particle index).
+		std::vector<std::size_t> _stableIds;
+		std::vector<std::size_t> _stableIdToIndex;
 
 		unsigned int _particleSystemIndex;
 		bool _isDirty;
 
 		float _maxVelocityNorm;
-
-	public:
-		mutable std::mutex _mutex;
 	};
 }
@@ -3,6 +3,7 @@
 #include "ParticleSystemContainer.h"
 
 #include "OutReflectedModality.h"
+#include "NeighborParticleReferralBundle.h"
 
 
 namespace Storm
@@ -23,13 +24,12 @@ namespace Storm
 		};
 	}
 
-	template<class NeighborhoodArrayType, class RawKernelFuncType, class GradKernelFuncType, std::size_t outLinkedNeighborBundleSize>
+	// The search only gathers the neighbors. Their kernel values are computed afterward for the whole neighborhood at once (see Storm::retrieveKernelBatchMethod).
+	template<class NeighborhoodArrayType, std::size_t outLinkedNeighborBundleSize>
 	struct NeighborSearchInParam
 	{
 	public:
 		using NeighborhoodArray = NeighborhoodArrayType;
-		using RawKernelFunc = RawKernelFuncType;
-		using GradKernelFunc = GradKernelFuncType;
 
 	public:
 		Storm::ParticleSystem*const _thisParticleSystem;
@@ -40,10 +40,8 @@ namespace Storm
 		NeighborhoodArray &_currentPNeighborhood;
 		const std::size_t _particleIndex;
 		const Storm::Vector3 &_currentPPosition;
-		const std::vector<Storm::NeighborParticleReferral>* &_containingBundleReferrals;
-		const std::vector<Storm::NeighborParticleReferral>*(&_outLinkedNeighborBundle)[outLinkedNeighborBundleSize];
-		const RawKernelFunc &_rawKernelFunc;
-		const GradKernelFunc &_gradKernelFunc;
+		const Storm::NeighborParticleReferralBundle* &_containingBundleReferrals;
+		const Storm::NeighborParticleReferralBundle*(&_outLinkedNeighborBundle)[outLinkedNeighborBundleSize];
 		const Storm::Vector3 &_domainDimension;
 
 		bool _isFluid;
@@ -158,13 +156,10 @@ namespace Storm
 		if (Storm::isNeighborhood(inParam, param))
 		{
 #if STORM_USE_INTRINSICS
-			Storm::NeighborParticleInfo &addedNeighbor = inParam._currentPNeighborhood.emplace_back(particleSystem, particleReferral._particleIndex, param._xij.m128_f32[0], param._xij.m128_f32[1], param._xij.m128_f32[2], param._normSquared, inParam._isFluid, notReflected);
+			inParam._currentPNeighborhood.emplace_back(particleSystem, particleReferral._particleIndex, param._xij.m128_f32[0], param._xij.m128_f32[1], param._xij.m128_f32[2], param._normSquared, inParam._isFluid, notReflected);
 #else
-			Storm::NeighborParticleInfo &addedNeighbor = inParam._currentPNeighborhood.emplace_back(particleSystem, particleReferral._particleIndex, param._xij, param._normSquared, inParam._isFluid, notReflected);
+			inParam._currentPNeighborhood.emplace_back(particleSystem, particleReferral._particleIndex, param._xij, param._normSquared, inParam._isFluid, notReflected);
 #endif
-
-			addedNeighbor._Wij = inParam._rawKernelFunc(inParam._kernelLength, addedNeighbor._xijNorm);
-			addedNeighbor._gradWij = inParam._gradKernelFunc(inParam._kernelLength, addedNeighbor._xij, addedNeighbor._xijNorm);
 		}
 	}
 
@@ -256,7 +251,7 @@ namespace Storm
 				}
 			}
 
-			for (const std::vector<Storm::NeighborParticleReferral>** linkedNeighborReferralsIter = inParam._outLinkedNeighborBundle; *linkedNeighborReferralsIter != nullptr; ++linkedNeighborReferralsIter)
+			for (const Storm::NeighborParticleReferralBundle** linkedNeighborReferralsIter = inParam._outLinkedNeighborBundle; *linkedNeighborReferralsIter != nullptr; ++linkedNeighborReferralsIter)
 			{
 				bool noReflect;
 				if constexpr (considerInfiniteDomain)
@@ -340,7 +335,7 @@ namespace Storm
 				Storm::addIfNeighbor<true>(inParam, param, otherPSystem, particleReferral);
 			}
 
-			for (const std::vector<Storm::NeighborParticleReferral>** linkedNeighborReferralsIter = inParam._outLinkedNeighborBundle; *linkedNeighborReferralsIter != nullptr; ++linkedNeighborReferralsIter)
+			for (const Storm::NeighborParticleReferralBundle** linkedNeighborReferralsIter = inParam._outLinkedNeighborBundle; *linkedNeighborReferralsIter != nullptr; ++linkedNeighborReferralsIter)
 			{
 				bool noReflect;
 				if constexpr (considerInfiniteDomain)
@@ -392,4 +387,103 @@ namespace Storm
 			}
 		}
 	}
+
+	// Search only the particles of this particle system that are after the current one : inside the containing bundle, those after it, and all those inside the forward bundles (see Storm::ISpacePartitionerManager::getForwardBundles).
+	// Running it for all particles finds each pair of neighbors of this particle system once. There is no infinite domain handling since the forward bundles aren't reflected.
+	template<class NeighborSearchParamType>
+	void searchForForwardNeighborhood(const NeighborSearchParamType &inParam)
+	{
+#if STORM_USE_INTRINSICS
+		details::NeighborSearchParamTmp<__m128> param {
+			._currentPPos = STORM_INTRINSICS_LOAD_PS_FROM_VECT3(inParam._currentPPosition)
+		};
+
+#else
+		details::NeighborSearchParamTmp<Storm::Vector3> param {
+			._currentPPos = inParam._currentPPosition
+		};
+#endif
+
+		const std::vector<Storm::Vector3> &thisSystemAllPPosition = inParam._thisParticleSystem->getPositions();
+
+		const Storm::NeighborParticleReferralBundle &containingBundleReferrals = *inParam._containingBundleReferrals;
+		const std::size_t containingBundleRefCount = containingBundleReferrals.size();
+
+		std::size_t iter = 0;
+		for (; iter < containingBundleRefCount; ++iter)
+		{
+			const Storm::NeighborParticleReferral &particleReferral = containingBundleReferrals[iter];
+			if (particleReferral._particleIndex == inParam._particleIndex && particleReferral._systemId == inParam._currentSystemId)
+			{
+				++iter; // The particles before it inside the containing bundle have already found it.
+				break;
+			}
+		}
+
+		for (; iter < containingBundleRefCount; ++iter)
+		{
+			const Storm::NeighborParticleReferral &particleReferral = containingBundleReferrals[iter];
+			if (particleReferral._systemId == inParam._currentSystemId)
+			{
+				Storm::retrieveNeighborPosition<false>(param, thisSystemAllPPosition, particleReferral);
+				Storm::addIfNeighbor<true>(inParam, param, inParam._thisParticleSystem, particleReferral);
+			}
+		}
+
+		for (const Storm::NeighborParticleReferralBundle** linkedNeighborReferralsIter = inParam._outLinkedNeighborBundle; *linkedNeighborReferralsIter != nullptr; ++linkedNeighborReferralsIter)
+		{
+			for (const Storm::NeighborParticleReferral &particleReferral : **linkedNeighborReferralsIter)
+			{
+				if (particleReferral._systemId == inParam._currentSystemId)
+				{
+					Storm::retrieveNeighborPosition<false>(param, thisSystemAllPPosition, particleReferral);
+					Storm::addIfNeighbor<true>(inParam, param, inParam._thisParticleSystem, particleReferral);
+				}
+			}
+		}
+	}
+
+	// Search the particles of the other particle systems only (the containing and the linked bundles are expected to be the whole neighborhood, see Storm::ISpacePartitionerManager::getAllBundles).
+	// This is the complement of searchForForwardNeighborhood when the partition is shared with other particle systems. There is no infinite domain handling either.
+	template<class NeighborSearchParamType>
+	void searchForOtherSystemsNeighborhood(const NeighborSearchParamType &inParam)
+	{
+#if STORM_USE_INTRINSICS
+		details::NeighborSearchParamTmp<__m128> param {
+			._currentPPos = STORM_INTRINSICS_LOAD_PS_FROM_VECT3(inParam._currentPPosition)
+		};
+
+#else
+		details::NeighborSearchParamTmp<Storm::Vector3> param {
+			._currentPPos = inParam._currentPPosition
+		};
+#endif
+
+		Storm::ParticleSystem* otherPSystem = nullptr;
+		unsigned int lastOtherPSystemCachedId = inParam._currentSystemId;
+
+		const auto searchInBundle = [&inParam, &param, &otherPSystem, &lastOtherPSystemCachedId](const Storm::NeighborParticleReferralBundle &bundle)
+		{
+			for (const Storm::NeighborParticleReferral &particleReferral : bundle)
+			{
+				if (particleReferral._systemId != inParam._currentSystemId)
+				{
+					if (lastOtherPSystemCachedId != particleReferral._systemId)
+					{
+						lastOtherPSystemCachedId = particleReferral._systemId;
+						otherPSystem = inParam._allParticleSystems.find(particleReferral._systemId)->second.get();
+					}
+
+					Storm::retrieveNeighborPosition<false>(param, otherPSystem->getPositions(), particleReferral);
+					Storm::addIfNeighbor<true>(inParam, param, otherPSystem, particleReferral);
+				}
+			}
+		};
+
+		searchInBundle(*inParam._containingBundleReferrals);
+		for (const Storm::NeighborParticleReferralBundle** linkedNeighborReferralsIter = inParam._outLinkedNeighborBundle; *linkedNeighborReferralsIter != nullptr; ++linkedNeighborReferralsIter)
+		{
+			searchInBundle(**linkedNeighborReferralsIter);
+		}
+	}
 }
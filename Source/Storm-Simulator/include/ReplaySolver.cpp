@@ -12,6 +12,8 @@
 #include "SerializeRecordParticleSystemData.h"
 #include "SerializeRecordContraintsData.h"
 
+#include "RecordChannel.h"
+
 #include "RunnerHelper.h"
 
 #define STORM_HIJACKED_TYPE float
@@ -438,141 +440,229 @@ namespace
 		}
 	}
 
+	// The rank of each particle stable id among the stable ids of its particle system, that is the particle index once in the stable order.
+	// The stable ids are a permutation of [0, particle count) unless particles were removed (open boundaries), then there are holes to skip.
+	const std::vector<std::size_t>& computeStableRanks(const std::vector<std::size_t> &stableIds)
+	{
+		const std::size_t particleCount = stableIds.size();
+		const std::size_t stableIdCount = particleCount > 0 ? *std::max_element(std::begin(stableIds), std::end(stableIds)) + 1 : 0;
+		if (stableIdCount == particleCount)
+		{
+			return stableIds;
+		}
+
+		// Kept between records to not reallocate them.
+		thread_local std::vector<std::size_t> t_stableIdRanks;
+		thread_local std::vector<std::size_t> t_stableRanks;
+
+		t_stableIdRanks.assign(stableIdCount, 0);
+		for (const std::size_t stableId : stableIds)
+		{
+			t_stableIdRanks[stableId] = 1;
+		}
+
+		std::size_t rank = 0;
+		for (std::size_t &stableIdRank : t_stableIdRanks)
+		{
+			const std::size_t isUsed = stableIdRank;
+			stableIdRank = rank;
+			rank += isUsed;
+		}
+
+		t_stableRanks.resize(particleCount);
+		for (std::size_t particleIndex = 0; particleIndex < particleCount; ++particleIndex)
+		{
+			t_stableRanks[particleIndex] = t_stableIdRanks[stableIds[particleIndex]];
+		}
+
+		return t_stableRanks;
+	}
+
+	template<class Type>
+	void restoreStableOrder(std::vector<Type> &inOutArray, const std::vector<std::size_t> &stableRanks)
+	{
+		if (!inOutArray.empty())
+		{
+			assert(inOutArray.size() == stableRanks.size() && "The recorded array should have one value per particle!");
+
+			// Swapped with the reordered array, so the buffers go back and forth between the record frames and here instead of being allocated each record.
+			thread_local std::vector<Type> t_stableOrdered;
+			t_stableOrdered.clear();
+			setNumUninitializedIfCountMismatch(t_stableOrdered, inOutArray.size());
+
+			Storm::runParallel(inOutArray, [&stableOrdered = t_stableOrdered, &stableRanks](const Type &value, const std::size_t particleIndex)
+			{
+				stableOrdered[stableRanks[particleIndex]] = value;
+			});
+
+			std::swap(inOutArray, t_stableOrdered);
+		}
+	}
+
+	void restoreStableOrder(Storm::SerializeRecordParticleSystemData &inOutFramePSystemData, const std::vector<std::size_t> &stableRanks)
+	{
+		restoreStableOrder(inOutFramePSystemData._positions, stableRanks);
+		restoreStableOrder(inOutFramePSystemData._velocities, stableRanks);
+		restoreStableOrder(inOutFramePSystemData._forces, stableRanks);
+		restoreStableOrder(inOutFramePSystemData._densities, stableRanks);
+		restoreStableOrder(inOutFramePSystemData._pressures, stableRanks);
+		restoreStableOrder(inOutFramePSystemData._blowerForces, stableRanks);
+		restoreStableOrder(inOutFramePSystemData._normals, stableRanks);
+		restoreStableOrder(inOutFramePSystemData._volumes, stableRanks);
+		restoreStableOrder(inOutFramePSystemData._pressureComponentforces, stableRanks);
+		restoreStableOrder(inOutFramePSystemData._viscosityComponentforces, stableRanks);
+		restoreStableOrder(inOutFramePSystemData._dragComponentforces, stableRanks);
+		restoreStableOrder(inOutFramePSystemData._dynamicPressureQForces, stableRanks);
+		restoreStableOrder(inOutFramePSystemData._noStickForces, stableRanks);
+		restoreStableOrder(inOutFramePSystemData._coandaForces, stableRanks);
+		restoreStableOrder(inOutFramePSystemData._intermediaryPressureDensityComponentForces, stableRanks);
+		restoreStableOrder(inOutFramePSystemData._intermediaryPressureVelocityComponentForces, stableRanks);
+	}
+
+	// Empty the arrays but keep their capacity, so copying the next frame into them doesn't reallocate. The arrays of channels not recorded stay empty.
+	void clearArrays(Storm::SerializeRecordParticleSystemData &inOutFramePSystemData)
+	{
+		inOutFramePSystemData._positions.clear();
+		inOutFramePSystemData._velocities.clear();
+		inOutFramePSystemData._forces.clear();
+		inOutFramePSystemData._densities.clear();
+		inOutFramePSystemData._pressures.clear();
+		inOutFramePSystemData._blowerForces.clear();
+		inOutFramePSystemData._normals.clear();
+		inOutFramePSystemData._volumes.clear();
+		inOutFramePSystemData._pressureComponentforces.clear();
+		inOutFramePSystemData._viscosityComponentforces.clear();
+		inOutFramePSystemData._dragComponentforces.clear();
+		inOutFramePSystemData._dynamicPressureQForces.clear();
+		inOutFramePSystemData._noStickForces.clear();
+		inOutFramePSystemData._coandaForces.clear();
+		inOutFramePSystemData._intermediaryPressureDensityComponentForces.clear();
+		inOutFramePSystemData._intermediaryPressureVelocityComponentForces.clear();
+	}
+
+	// One array of a particle system to copy into the record frame. The array types are erased so the arrays of all particle systems are copied by the same parallel loop.
+	struct RecordArrayCopyTask
+	{
+	public:
+		void(*_copyFunc)(const void* srcArray, void* dstArray);
+		const void* _srcArray;
+		void* _dstArray;
+	};
+
+	template<Storm::SIMDUsageMode simdMode, class Type>
+	void copyRecordArray(const void* srcArrayPtr, void* dstArrayPtr)
+	{
+		const std::vector<Type> &srcArray = *static_cast<const std::vector<Type>*>(srcArrayPtr);
+		std::vector<Type> &dstArray = *static_cast<std::vector<Type>*>(dstArrayPtr);
+
+		if constexpr (simdMode == Storm::SIMDUsageMode::AVX512)
+		{
+			setNumUninitializedIfCountMismatch(dstArray, srcArray.size());
+			makeAVX512CpyArrayLambda()(srcArray, dstArray);
+		}
+		else if constexpr (simdMode == Storm::SIMDUsageMode::SSE)
+		{
+			setNumUninitializedIfCountMismatch(dstArray, srcArray.size());
+			makeSSECpyArrayLambda()(srcArray, dstArray);
+		}
+		else
+		{
+			dstArray = srcArray;
+		}
+	}
+
+	template<Storm::SIMDUsageMode simdMode, class Type>
+	RecordArrayCopyTask makeRecordArrayCopyTask(const std::vector<Type> &srcArray, std::vector<Type> &dstArray)
+	{
+		return RecordArrayCopyTask{ &copyRecordArray<simdMode, Type>, &srcArray, &dstArray };
+	}
+
 	template<Storm::SIMDUsageMode simdMode>
-	void fillRecordFromSystemsImpl(const bool pushStatics, const Storm::ParticleSystemContainer &particleSystems, Storm::SerializeRecordPendingData &currentFrameData)
+	void fillRecordFromSystemsImpl(const bool pushStatics, const Storm::RecordChannel recordedChannels, const Storm::ParticleSystemContainer &particleSystems, Storm::SerializeRecordPendingData &currentFrameData)
 	{
-		enum { k_pSystemArrayMaxCount = 10 };
-		const std::size_t particleSystemCount = particleSystems.size();
+		const auto isRecorded = [pushStatics](const auto &particleSystemPair)
+		{
+			return !particleSystemPair.second->isStatic() || pushStatics;
+		};
 
-		currentFrameData._particleSystemElements.reserve(particleSystemCount);
-		std::vector<std::future<void>> fillerFuturesExecutor;
-		fillerFuturesExecutor.reserve(particleSystemCount * k_pSystemArrayMaxCount);
+		// The frame comes from the record frame pool, its elements keep the capacity of their arrays from a previous record.
+		// Most of the time, it was filled with the same particle systems in the same order. Except after the first frame that also records the static particle systems : the elements don't match anymore, it just costs some reallocations until they fit again.
+		currentFrameData._particleSystemElements.resize(static_cast<std::size_t>(std::count_if(std::begin(particleSystems), std::end(particleSystems), isRecorded)));
 
-		const auto sseCpyLambda = makeSSECpyArrayLambda();
-		const auto avx512CpyLambda = makeAVX512CpyArrayLambda();
+		// Kept between records to not reallocate it.
+		thread_local std::vector<RecordArrayCopyTask> t_copyTasks;
+		t_copyTasks.clear();
 
+		std::size_t elementIndex = 0;
 		for (const auto &particleSystemPair : particleSystems)
 		{
-			const Storm::ParticleSystem &pSystemRef = *particleSystemPair.second;
-
-			if (!pSystemRef.isStatic() || pushStatics)
+			if (isRecorded(particleSystemPair))
 			{
-				Storm::SerializeRecordParticleSystemData &framePSystemElementData = currentFrameData._particleSystemElements.emplace_back();
+				const Storm::ParticleSystem &pSystemRef = *particleSystemPair.second;
 
-				framePSystemElementData._systemId = particleSystemPair.first;
+				Storm::SerializeRecordParticleSystemData &framePSystemElementData = currentFrameData._particleSystemElements[elementIndex++];
+				clearArrays(framePSystemElementData);
 
-#define STORM_COPY_ARRAYS(cpyLambda, memberName, srcArray)																								\
-	fillerFuturesExecutor.emplace_back(std::async(std::launch::async, [&cpyLambda, &dst = framePSystemElementData.memberName, &src = srcArray]()		\
-	{																																					\
-		setNumUninitializedIfCountMismatch(dst, src.size());																							\
-		cpyLambda(src, dst);																															\
-	}))
+				framePSystemElementData._systemId = particleSystemPair.first;
 
-#define STORM_MAKE_SIMPLE_COPY_ARRAY(memberName, srcArray)																				\
-	fillerFuturesExecutor.emplace_back(std::async(std::launch::async, [&dst = framePSystemElementData.memberName, &src = srcArray]()	\
-	{																																	\
-		dst = src;																														\
-	}))
+#define STORM_COPY_ARRAY(channel, memberName, srcArray)																\
+	if (STORM_IS_BIT_ENABLED(recordedChannels, Storm::RecordChannel::channel))										\
+		t_copyTasks.emplace_back(makeRecordArrayCopyTask<simdMode>(srcArray, framePSystemElementData.memberName))
 
 				if (pSystemRef.isFluids())
 				{
 					const Storm::FluidParticleSystem &pSystemRefAsFluid = static_cast<const Storm::FluidParticleSystem &>(pSystemRef);
 
-					if constexpr (simdMode == Storm::SIMDUsageMode::AVX512)
-					{
-						STORM_COPY_ARRAYS(avx512CpyLambda, _densities, pSystemRefAsFluid.getDensities());
-						STORM_COPY_ARRAYS(avx512CpyLambda, _pressures, pSystemRefAsFluid.getPressures());
-						STORM_COPY_ARRAYS(avx512CpyLambda, _blowerForces, pSystemRefAsFluid.getTmpBlowerForces());
-					}
-					else if constexpr (simdMode == Storm::SIMDUsageMode::SSE)
-					{
-						STORM_COPY_ARRAYS(sseCpyLambda, _densities, pSystemRefAsFluid.getDensities());
-						STORM_COPY_ARRAYS(sseCpyLambda, _pressures, pSystemRefAsFluid.getPressures());
-						STORM_COPY_ARRAYS(sseCpyLambda, _blowerForces, pSystemRefAsFluid.getTmpBlowerForces());
-					}
-					else
-					{
-						STORM_MAKE_SIMPLE_COPY_ARRAY(_densities, pSystemRefAsFluid.getDensities());
-						STORM_MAKE_SIMPLE_COPY_ARRAY(_pressures, pSystemRefAsFluid.getPressures());
-						STORM_MAKE_SIMPLE_COPY_ARRAY(_blowerForces, pSystemRefAsFluid.getTmpBlowerForces());
-					}
+					STORM_COPY_ARRAY(Densities, _densities, pSystemRefAsFluid.getDensities());
+					STORM_COPY_ARRAY(Pressures, _pressures, pSystemRefAsFluid.getPressures());
+					STORM_COPY_ARRAY(BlowerForces, _blowerForces, pSystemRefAsFluid.getTmpBlowerForces());
 
 					framePSystemElementData._wantedDensity = pSystemRefAsFluid.getRestDensity();
 				}
 				else
 				{
 					const Storm::RigidBodyParticleSystem &pSystemRefAsRb = static_cast<const Storm::RigidBodyParticleSystem &>(pSystemRef);
-					if constexpr (simdMode == Storm::SIMDUsageMode::AVX512)
-					{
-						STORM_COPY_ARRAYS(avx512CpyLambda, _normals, pSystemRefAsRb.getNormals());
-						STORM_COPY_ARRAYS(avx512CpyLambda, _volumes, pSystemRefAsRb.getVolumes());
-					}
-					else if constexpr (simdMode == Storm::SIMDUsageMode::SSE)
-					{
-						STORM_COPY_ARRAYS(sseCpyLambda, _normals, pSystemRefAsRb.getNormals());
-						STORM_COPY_ARRAYS(sseCpyLambda, _volumes, pSystemRefAsRb.getVolumes());
-					}
-					else
-					{
-						STORM_MAKE_SIMPLE_COPY_ARRAY(_normals, pSystemRefAsRb.getNormals());
-						STORM_MAKE_SIMPLE_COPY_ARRAY(_volumes, pSystemRefAsRb.getVolumes());
-					}
+
+					STORM_COPY_ARRAY(Normals, _normals, pSystemRefAsRb.getNormals());
+					STORM_COPY_ARRAY(Volumes, _volumes, pSystemRefAsRb.getVolumes());
 
 					framePSystemElementData._pSystemPosition = pSystemRefAsRb.getRbPosition();
 					framePSystemElementData._pSystemGlobalForce = pSystemRefAsRb.getRbTotalForce();
 				}
 
-				if constexpr (simdMode == Storm::SIMDUsageMode::AVX512)
-				{
-					STORM_COPY_ARRAYS(avx512CpyLambda, _positions, pSystemRef.getPositions());
-					STORM_COPY_ARRAYS(avx512CpyLambda, _velocities, pSystemRef.getVelocity());
-					STORM_COPY_ARRAYS(avx512CpyLambda, _forces, pSystemRef.getForces());
-					STORM_COPY_ARRAYS(avx512CpyLambda, _pressureComponentforces, pSystemRef.getTemporaryPressureForces());
-					STORM_COPY_ARRAYS(avx512CpyLambda, _viscosityComponentforces, pSystemRef.getTemporaryViscosityForces());
-					STORM_COPY_ARRAYS(avx512CpyLambda, _dragComponentforces, pSystemRef.getTemporaryDragForces());
-					STORM_COPY_ARRAYS(avx512CpyLambda, _dynamicPressureQForces, pSystemRef.getTemporaryBernoulliDynamicPressureForces());
-					STORM_COPY_ARRAYS(avx512CpyLambda, _noStickForces, pSystemRef.getTemporaryNoStickForces());
-					STORM_COPY_ARRAYS(avx512CpyLambda, _coandaForces, pSystemRef.getTemporaryCoandaForces());
-					STORM_COPY_ARRAYS(avx512CpyLambda, _intermediaryPressureDensityComponentForces, pSystemRef.getTemporaryPressureDensityIntermediaryForces());
-					STORM_COPY_ARRAYS(avx512CpyLambda, _intermediaryPressureVelocityComponentForces, pSystemRef.getTemporaryPressureVelocityIntermediaryForces());
-				}
-				else if constexpr (simdMode == Storm::SIMDUsageMode::SSE)
-				{
-					STORM_COPY_ARRAYS(sseCpyLambda, _positions, pSystemRef.getPositions());
-					STORM_COPY_ARRAYS(sseCpyLambda, _velocities, pSystemRef.getVelocity());
-					STORM_COPY_ARRAYS(sseCpyLambda, _forces, pSystemRef.getForces());
-					STORM_COPY_ARRAYS(sseCpyLambda, _pressureComponentforces, pSystemRef.getTemporaryPressureForces());
-					STORM_COPY_ARRAYS(sseCpyLambda, _viscosityComponentforces, pSystemRef.getTemporaryViscosityForces());
-					STORM_COPY_ARRAYS(sseCpyLambda, _dragComponentforces, pSystemRef.getTemporaryDragForces());
-					STORM_COPY_ARRAYS(sseCpyLambda, _dynamicPressureQForces, pSystemRef.getTemporaryBernoulliDynamicPressureForces());
-					STORM_COPY_ARRAYS(sseCpyLambda, _noStickForces, pSystemRef.getTemporaryNoStickForces());
-					STORM_COPY_ARRAYS(sseCpyLambda, _coandaForces, pSystemRef.getTemporaryCoandaForces());
-					STORM_COPY_ARRAYS(sseCpyLambda, _intermediaryPressureDensityComponentForces, pSystemRef.getTemporaryPressureDensityIntermediaryForces());
-					STORM_COPY_ARRAYS(sseCpyLambda, _intermediaryPressureVelocityComponentForces, pSystemRef.getTemporaryPressureVelocityIntermediaryForces());
-				}
-				else
-				{
-					STORM_MAKE_SIMPLE_COPY_ARRAY(_positions, pSystemRef.getPositions());
-					STORM_MAKE_SIMPLE_COPY_ARRAY(_velocities, pSystemRef.getVelocity());
-					STORM_MAKE_SIMPLE_COPY_ARRAY(_forces, pSystemRef.getForces());
-					STORM_MAKE_SIMPLE_COPY_ARRAY(_pressureComponentforces, pSystemRef.getTemporaryPressureForces());
-					STORM_MAKE_SIMPLE_COPY_ARRAY(_viscosityComponentforces, pSystemRef.getTemporaryViscosityForces());
-					STORM_MAKE_SIMPLE_COPY_ARRAY(_dragComponentforces, pSystemRef.getTemporaryDragForces());
-					STORM_MAKE_SIMPLE_COPY_ARRAY(_dynamicPressureQForces, pSystemRef.getTemporaryBernoulliDynamicPressureForces());
-					STORM_MAKE_SIMPLE_COPY_ARRAY(_noStickForces, pSystemRef.getTemporaryNoStickForces());
-					STORM_MAKE_SIMPLE_COPY_ARRAY(_coandaForces, pSystemRef.getTemporaryCoandaForces());
-					STORM_MAKE_SIMPLE_COPY_ARRAY(_intermediaryPressureDensityComponentForces, pSystemRef.getTemporaryPressureDensityIntermediaryForces());
-					STORM_MAKE_SIMPLE_COPY_ARRAY(_intermediaryPressureVelocityComponentForces, pSystemRef.getTemporaryPressureVelocityIntermediaryForces());
-				}
+				STORM_COPY_ARRAY(Positions, _positions, pSystemRef.getPositions());
+				STORM_COPY_ARRAY(Velocities, _velocities, pSystemRef.getVelocity());
+				STORM_COPY_ARRAY(Forces, _forces, pSystemRef.getForces());
+				STORM_COPY_ARRAY(PressureForces, _pressureComponentforces, pSystemRef.getTemporaryPressureForces());
+				STORM_COPY_ARRAY(ViscosityForces, _viscosityComponentforces, pSystemRef.getTemporaryViscosityForces());
+				STORM_COPY_ARRAY(DragForces, _dragComponentforces, pSystemRef.getTemporaryDragForces());
+				STORM_COPY_ARRAY(DynamicPressureQForces, _dynamicPressureQForces, pSystemRef.getTemporaryBernoulliDynamicPressureForces());
+				STORM_COPY_ARRAY(NoStickForces, _noStickForces, pSystemRef.getTemporaryNoStickForces());
+				STORM_COPY_ARRAY(CoandaForces, _coandaForces, pSystemRef.getTemporaryCoandaForces());
+				STORM_COPY_ARRAY(IntermediaryDensityPressureForces, _intermediaryPressureDensityComponentForces, pSystemRef.getTemporaryPressureDensityIntermediaryForces());
+				STORM_COPY_ARRAY(IntermediaryVelocityPressureForces, _intermediaryPressureVelocityComponentForces, pSystemRef.getTemporaryPressureVelocityIntermediaryForces());
 
 				framePSystemElementData._pSystemTotalEngineForce = pSystemRef.getTotalForceNonPhysX();
 
-#undef STORM_COPY_ARRAYS
-#undef STORM_MAKE_SIMPLE_COPY_ARRAY
+#undef STORM_COPY_ARRAY
 			}
 		}
 
-		fillerFuturesExecutor.clear();
+		// The copies are run on the parallel workers, that are already there instead of creating one thread per array.
+		Storm::runParallel(t_copyTasks, [](const RecordArrayCopyTask &copyTask)
+		{
+			copyTask._copyFunc(copyTask._srcArray, copyTask._dstArray);
+		});
+
+		// Particles could have been reordered in memory (for cache efficiency), but the record should always be done following their stable ids.
+		for (Storm::SerializeRecordParticleSystemData &framePSystemElementData : currentFrameData._particleSystemElements)
+		{
+			const Storm::ParticleSystem &pSystemRef = *particleSystems.find(framePSystemElementData._systemId)->second;
+			if (pSystemRef.hasReorderedParticles())
+			{
+				restoreStableOrder(framePSystemElementData, computeStableRanks(pSystemRef.getStableIds()));
+			}
+		}
 	}
 }
 
@@ -876,29 +966,20 @@ bool Storm::ReplaySolver::seekFrame(const float toFrameTime, Storm::ParticleSyst
 	const Storm::SingletonHolder &singletonHolder = Storm::SingletonHolder::instance();
 	Storm::ISerializerManager &serializerMgr = singletonHolder.getSingleton<Storm::ISerializerManager>();
 
-	bool skipAdvance = false;
-
-	assert(frameBefore._physicsTime <= toFrameTime && "We mustn't have the frameBefore after the toFrameTime before entering this method!");
+	// If the frame time is between the frames we already have, we only need to interpolate them.
+	const bool isBetweenCurrentFrames =
+		frameBefore._physicsTime <= toFrameTime &&
+		toFrameTime <= frameAfter._physicsTime &&
+		frameBefore._physicsTime < frameAfter._physicsTime;
 
-	if (frameAfter._physicsTime > toFrameTime)
+	if (!isBetweenCurrentFrames)
 	{
-		const float lerpRatio = (frameAfter._physicsTime - toFrameTime) / (frameAfter._physicsTime - frameBefore._physicsTime);
-
-		// To frame time is not between before and after, then we need to change them.
-		if (lerpRatio > 1.f)
-		{
-			frameAfter = frameBefore;
-		}
-		else
+		// Jump to the last recorded frame before the frame time (backward or forward), then the next recorded frames are the ones after.
+		if (!serializerMgr.seekReplay(toFrameTime) || !serializerMgr.obtainNextFrame(frameBefore))
 		{
-			skipAdvance = true;
+			return false;
 		}
-	}
 
-	if (!skipAdvance)
-	{
-		// Advance until the right frame.
-		// TODO : Optimize with a real seek, but right now, this will do the job since the record files we dump weren't designed to be seekable easily.
 		do
 		{
 			if (!serializerMgr.obtainNextFrame(frameAfter))
@@ -975,7 +1056,7 @@ bool Storm::ReplaySolver::seekFrame(const float toFrameTime, Storm::ParticleSyst
 	return true;
 }
 
-void Storm::ReplaySolver::fillRecordFromSystems(const bool pushStatics, const Storm::ParticleSystemContainer &particleSystems, Storm::SerializeRecordPendingData &currentFrameData)
+void Storm::ReplaySolver::fillRecordFromSystems(const bool pushStatics, const Storm::RecordChannel recordedChannels, const Storm::ParticleSystemContainer &particleSystems, Storm::SerializeRecordPendingData &currentFrameData)
 {
 	const bool useSIMD = Storm::InstructionSet::SSE() && Storm::InstructionSet::SSE2();
 	const bool useAVX512 = useSIMD && Storm::InstructionSet::AVX512F();
@@ -984,15 +1065,15 @@ void Storm::ReplaySolver::fillRecordFromSystems(const bool pushStatics, const St
 	{
 		if (useAVX512)
 		{
-			fillRecordFromSystemsImpl<Storm::SIMDUsageMode::AVX512>(pushStatics, particleSystems, currentFrameData);
+			fillRecordFromSystemsImpl<Storm::SIMDUsageMode::AVX512>(pushStatics, recordedChannels, particleSystems, currentFrameData);
 		}
 		else
 		{
-			fillRecordFromSystemsImpl<Storm::SIMDUsageMode::SSE>(pushStatics, particleSystems, currentFrameData);
+			fillRecordFromSystemsImpl<Storm::SIMDUsageMode::SSE>(pushStatics, recordedChannels, particleSystems, currentFrameData);
 		}
 	}
 	else
 	{
-		fillRecordFromSystemsImpl<Storm::SIMDUsageMode::SISD>(pushStatics, particleSystems, currentFrameData);
+		fillRecordFromSystemsImpl<Storm::SIMDUsageMode::SISD>(pushStatics, recordedChannels, particleSystems, currentFrameData);
 	}
 }
@@ -9,6 +9,7 @@ namespace Storm
 	class ParticleSystem;
 	struct SerializeRecordPendingData;
 	struct SerializeRecordContraintsData;
+	enum class RecordChannel : uint16_t;
 
 	class ReplaySolver : private Storm::NonInstanciable
 	{
@@ -21,6 +22,6 @@ namespace Storm
 		static bool replayCurrentNextFrame(Storm::ParticleSystemContainer &particleSystems, Storm::SerializeRecordPendingData &frameBefore, Storm::SerializeRecordPendingData &frameAfter, const float recordFps, std::vector<Storm::SerializeRecordContraintsData> &outFrameConstraintData, float &outKernelValue);
 		static bool seekFrame(const float toFrameTime, Storm::ParticleSystemContainer &particleSystems, Storm::SerializeRecordPendingData &frameBefore, Storm::SerializeRecordPendingData &frameAfter, std::vector<Storm::SerializeRecordContraintsData> &outFrameConstraintData, float &outKernelValue);
 
-		static void fillRecordFromSystems(const bool pushStatics, const Storm::ParticleSystemContainer &particleSystems, Storm::SerializeRecordPendingData &currentFrameData);
+		static void fillRecordFromSystems(const bool pushStatics, const Storm::RecordChannel recordedChannels, const Storm::ParticleSystemContainer &particleSystems, Storm::SerializeRecordPendingData &currentFrameData);
 	};
 }
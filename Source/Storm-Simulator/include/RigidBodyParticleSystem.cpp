@@ -20,6 +20,9 @@
 #include "Kernel.h"
 
 #include "ParticleSystemUtils.h"
+#include "RigidBodyTransform.h"
+
+#include "StaticVolumeCache.h"
 
 
 namespace
@@ -55,13 +58,35 @@ namespace
 		const float rbVolume = rbPtr->getRigidBodyVolume();
 
 		return rbVolume / particleCountFl;
+	}
+
+	// Note that the neighborhood of a static particle includes the particles of the other static rigid bodies, so all of them are part of the key.
+	std::filesystem::path computeStaticVolumeCachePath(const Storm::ParticleSystemContainer &allParticleSystems, const unsigned int currentSystemId, const Storm::KernelMode kernelMode, const float kernelLength)
+	{
+		const Storm::SingletonHolder &singletonHolder = Storm::SingletonHolder::instance();
+		const Storm::ISpacePartitionerManager &spacePartitionerMgr = singletonHolder.getSingleton<Storm::ISpacePartitionerManager>();
+
+		Storm::StaticVolumeCache cache{ kernelMode, kernelLength, spacePartitionerMgr.isInfiniteDomainMode(), spacePartitionerMgr.getDomainDimension() };
+		for (const auto &particleSystem : allParticleSystems)
+		{
+			const Storm::ParticleSystem &pSystem = *particleSystem.second;
+			if (!pSystem.isFluids() && pSystem.isStatic())
+			{
+				cache.addStaticParticleSystem(pSystem.getId(), pSystem.getPositions());
+			}
+		}
+
+		const Storm::IConfigManager &configMgr = singletonHolder.getSingleton<Storm::IConfigManager>();
+		return std::filesystem::path{ configMgr.getTemporaryPath() } / "StaticVolumes" / ("rb" + std::to_string(currentSystemId) + '_' + std::to_string(cache.getKey()) + ".cStaticVolumes");
 	}
 }
 
 
 Storm::RigidBodyParticleSystem::RigidBodyParticleSystem(unsigned int particleSystemIndex, std::vector<Storm::Vector3> &&worldPositions) :
 	Storm::ParticleSystem{ particleSystemIndex, std::move(worldPositions) },
+	_cachedTrackedRbPosition{ Storm::Vector3::Zero() },
 	_cachedTrackedRbRotationQuat{ Storm::Quaternion::Identity() },
+	_localCoordinatesDirty{ true },
 	_velocityDirtyInternal{ false },
 	_rbTotalForce{ Storm::Vector3::Zero() }
 {
@@ -80,7 +105,9 @@ Storm::RigidBodyParticleSystem::RigidBodyParticleSystem(unsigned int particleSys
 
 Storm::RigidBodyParticleSystem::RigidBodyParticleSystem(unsigned int particleSystemIndex, const std::size_t particleCount) :
 	Storm::ParticleSystem{ particleSystemIndex, particleCount },
+	_cachedTrackedRbPosition{ Storm::Vector3::Zero() },
 	_cachedTrackedRbRotationQuat{ Storm::Quaternion::Identity() },
+	_localCoordinatesDirty{ true },
 	_rbTotalForce{ Storm::Vector3::Zero() },
 	_volumeFixed{ false },
 	_velocityDirtyInternal{ false }
@@ -138,70 +165,86 @@ void Storm::RigidBodyParticleSystem::initializePreSimulation(const Storm::Partic
 		}
 		else
 		{
-			const Storm::ISpacePartitionerManager &spacePartitionerMgr = singletonHolder.getSingleton<Storm::ISpacePartitionerManager>();
-
-			std::vector<Storm::ParticleNeighborhoodArray> staticNeighborhood;
-			staticNeighborhood.resize(_positions.size());
-			for (Storm::ParticleNeighborhoodArray &particleNeighbor : staticNeighborhood)
+			const bool useStaticVolumeCache = sceneSimulationConfig._cacheStaticVolumes;
+			std::filesystem::path staticVolumeCachePath;
+			bool hasCachedStaticVolumes = false;
+			if (useStaticVolumeCache)
+			{
+				staticVolumeCachePath = computeStaticVolumeCachePath(allParticleSystems, this->getId(), sceneSimulationConfig._kernelMode, kernelLength);
+				hasCachedStaticVolumes = !configMgr.shouldRegenerateParticleCache() && Storm::StaticVolumeCache::read(staticVolumeCachePath, _staticVolumesInitValue);
+			}
+
+			if (!hasCachedStaticVolumes)
 			{
-				particleNeighbor.reserve(32);
-			}
-			const float currentKernelZero = Storm::retrieveKernelZeroValue(sceneSimulationConfig._kernelMode);
-			const Storm::RawKernelMethodDelegate rawKernelMeth = Storm::retrieveRawKernelMethod(sceneSimulationConfig._kernelMode);
-			const Storm::GradKernelMethodDelegate gradKernel = Storm::retrieveGradKernelMethod(sceneSimulationConfig._kernelMode);
+				const Storm::ISpacePartitionerManager &spacePartitionerMgr = singletonHolder.getSingleton<Storm::ISpacePartitionerManager>();
 
-			Storm::runParallel(staticNeighborhood, [this, &allParticleSystems, &spacePartitionerMgr, &rawKernelMeth, &gradKernel, kernelLength, currentKernelZero, kernelLengthSquared = kernelLength * kernelLength, currentSystemId = this->getId(), domainDimension = spacePartitionerMgr.getDomainDimension(), infiniteDomain = spacePartitionerMgr.isInfiniteDomainMode()](ParticleNeighborhoodArray &currentPStaticNeighborhood, const std::size_t particleIndex)
-			{
-				const Storm::Vector3 &currentPPosition = _positions[particleIndex];
-				if (spacePartitionerMgr.isOutsideSpaceDomain(currentPPosition)) STORM_UNLIKELY
+				std::vector<Storm::ParticleNeighborhoodBuildArray> staticNeighborhood;
+				staticNeighborhood.resize(_positions.size());
+				for (Storm::ParticleNeighborhoodBuildArray &particleNeighbor : staticNeighborhood)
 				{
-					return;
+					particleNeighbor.reserve(32);
 				}
-
-				const std::vector<Storm::NeighborParticleReferral>* bundleContainingPtr;
-				const std::vector<Storm::NeighborParticleReferral>* outLinkedNeighborBundle[Storm::k_neighborLinkedBunkCount];
-
-				Storm::NeighborSearchInParam<ParticleNeighborhoodArray, decltype(rawKernelMeth), decltype(gradKernel), Storm::k_neighborLinkedBunkCount> inParam{
-					this,
-					allParticleSystems,
-					kernelLength,
-					kernelLengthSquared,
-					currentSystemId,
-					currentPStaticNeighborhood,
-					particleIndex,
-					currentPPosition,
-					bundleContainingPtr,
-					outLinkedNeighborBundle,
-					rawKernelMeth,
-					gradKernel,
-					domainDimension,
-					false
-				};
-
-				// Get all particles referrals that are near the current particle position.
-				if (infiniteDomain)
-				{
-					spacePartitionerMgr.getAllBundlesInfinite(bundleContainingPtr, outLinkedNeighborBundle, currentPPosition, Storm::PartitionSelection::StaticRigidBody, inParam._reflectedModality);
-
-					if (inParam._reflectedModality->_summary != Storm::OutReflectedModalityEnum::None)
+				const float currentKernelZero = Storm::retrieveKernelZeroValue(sceneSimulationConfig._kernelMode);
+				const Storm::KernelBatchMethodDelegate kernelBatch = Storm::retrieveKernelBatchMethod(sceneSimulationConfig._kernelMode);
+
+				Storm::runParallel(staticNeighborhood, [this, &allParticleSystems, &spacePartitionerMgr, &kernelBatch, kernelLength, currentKernelZero, kernelLengthSquared = kernelLength * kernelLength, currentSystemId = this->getId(), domainDimension = spacePartitionerMgr.getDomainDimension(), infiniteDomain = spacePartitionerMgr.isInfiniteDomainMode()](ParticleNeighborhoodBuildArray &currentPStaticNeighborhood, const std::size_t particleIndex)
+				{
+					const Storm::Vector3 &currentPPosition = _positions[particleIndex];
+					if (spacePartitionerMgr.isOutsideSpaceDomain(currentPPosition)) STORM_UNLIKELY
+					{
+						return;
+					}
+
+					const Storm::NeighborParticleReferralBundle* bundleContainingPtr;
+					const Storm::NeighborParticleReferralBundle* outLinkedNeighborBundle[Storm::k_neighborLinkedBunkCount];
+
+					Storm::NeighborSearchInParam<ParticleNeighborhoodBuildArray, Storm::k_neighborLinkedBunkCount> inParam{
+						this,
+						allParticleSystems,
+						kernelLength,
+						kernelLengthSquared,
+						currentSystemId,
+						currentPStaticNeighborhood,
+						particleIndex,
+						currentPPosition,
+						bundleContainingPtr,
+						outLinkedNeighborBundle,
+						domainDimension,
+						false
+					};
+
+					// Get all particles referrals that are near the current particle position.
+					if (infiniteDomain)
 					{
-						Storm::searchForNeighborhood<true, true>(inParam);
+						spacePartitionerMgr.getAllBundlesInfinite(bundleContainingPtr, outLinkedNeighborBundle, currentPPosition, Storm::PartitionSelection::StaticRigidBody, inParam._reflectedModality);
+
+						if (inParam._reflectedModality->_summary != Storm::OutReflectedModalityEnum::None)
+						{
+							Storm::searchForNeighborhood<true, true>(inParam);
+						}
+						else
+						{
+							Storm::searchForNeighborhood<true, false>(inParam);
+						}
 					}
 					else
 					{
+						spacePartitionerMgr.getAllBundles(bundleContainingPtr, outLinkedNeighborBundle, currentPPosition, Storm::PartitionSelection::StaticRigidBody);
 						Storm::searchForNeighborhood<true, false>(inParam);
 					}
+
+					kernelBatch(kernelLength, currentPStaticNeighborhood);
+
+					// Initialize the static volume.
+					float &currentPStaticVolumeDelta = _staticVolumesInitValue[particleIndex];
+					currentPStaticVolumeDelta = computeParticleDeltaVolume(currentPStaticNeighborhood, this, currentKernelZero);
+				});
+
+				if (useStaticVolumeCache)
+				{
+					Storm::StaticVolumeCache::write(staticVolumeCachePath, _staticVolumesInitValue);
 				}
-				else
-				{
-					spacePartitionerMgr.getAllBundles(bundleContainingPtr, outLinkedNeighborBundle, currentPPosition, Storm::PartitionSelection::StaticRigidBody);
-					Storm::searchForNeighborhood<true, false>(inParam);
-				}
-
-				// Initialize the static volume.
-				float &currentPStaticVolumeDelta = _staticVolumesInitValue[particleIndex];
-				currentPStaticVolumeDelta = computeParticleDeltaVolume(currentPStaticNeighborhood, this, currentKernelZero);
-			});
+			}
 
 			if (_volumeFixed)
 			{
@@ -227,17 +270,16 @@ void Storm::RigidBodyParticleSystem::initializePreSimulation(const Storm::Partic
 		{
 			const Storm::ISpacePartitionerManager &spacePartitionerMgr = singletonHolder.getSingleton<Storm::ISpacePartitionerManager>();
 
-			std::vector<Storm::ParticleNeighborhoodArray> staticNeighborhood;
+			std::vector<Storm::ParticleNeighborhoodBuildArray> staticNeighborhood;
 			staticNeighborhood.resize(_positions.size());
-			for (Storm::ParticleNeighborhoodArray &particleNeighbor : staticNeighborhood)
+			for (Storm::ParticleNeighborhoodBuildArray &particleNeighbor : staticNeighborhood)
 			{
 				particleNeighbor.reserve(32);
 			}
 			const float currentKernelZero = Storm::retrieveKernelZeroValue(sceneSimulationConfig._kernelMode);
-			const Storm::RawKernelMethodDelegate rawKernelMeth = Storm::retrieveRawKernelMethod(sceneSimulationConfig._kernelMode);
-			const Storm::GradKernelMethodDelegate gradKernel = Storm::retrieveGradKernelMethod(sceneSimulationConfig._kernelMode);
+			const Storm::KernelBatchMethodDelegate kernelBatch = Storm::retrieveKernelBatchMethod(sceneSimulationConfig._kernelMode);
 
-			Storm::runParallel(staticNeighborhood, [this, &allParticleSystems, &spacePartitionerMgr, &rawKernelMeth, &gradKernel, kernelLength, currentKernelZero, kernelLengthSquared = kernelLength * kernelLength, currentSystemId = this->getId(), coeff = sceneRbConfig._reducedVolumeCoeff, domainDimension = spacePartitionerMgr.getDomainDimension(), infiniteDomain = spacePartitionerMgr.isInfiniteDomainMode()](ParticleNeighborhoodArray &currentPStaticNeighborhood, const std::size_t particleIndex)
+			Storm::runParallel(staticNeighborhood, [this, &allParticleSystems, &spacePartitionerMgr, &kernelBatch, kernelLength, currentKernelZero, kernelLengthSquared = kernelLength * kernelLength, currentSystemId = this->getId(), coeff = sceneRbConfig._reducedVolumeCoeff, domainDimension = spacePartitionerMgr.getDomainDimension(), infiniteDomain = spacePartitionerMgr.isInfiniteDomainMode()](ParticleNeighborhoodBuildArray &currentPStaticNeighborhood, const std::size_t particleIndex)
 			{
 				const Storm::Vector3 &currentPPosition = _positions[particleIndex];
 				if (spacePartitionerMgr.isOutsideSpaceDomain(currentPPosition)) STORM_UNLIKELY
@@ -245,10 +287,10 @@ void Storm::RigidBodyParticleSystem::initializePreSimulation(const Storm::Partic
 					return;
 				}
 
-				const std::vector<Storm::NeighborParticleReferral>* bundleContainingPtr;
-				const std::vector<Storm::NeighborParticleReferral>* outLinkedNeighborBundle[Storm::k_neighborLinkedBunkCount];
+				const Storm::NeighborParticleReferralBundle* bundleContainingPtr;
+				const Storm::NeighborParticleReferralBundle* outLinkedNeighborBundle[Storm::k_neighborLinkedBunkCount];
 
-				Storm::NeighborSearchInParam<ParticleNeighborhoodArray, decltype(rawKernelMeth), decltype(gradKernel), Storm::k_neighborLinkedBunkCount> inParam{
+				Storm::NeighborSearchInParam<ParticleNeighborhoodBuildArray, Storm::k_neighborLinkedBunkCount> inParam{
 					this,
 					allParticleSystems,
 					kernelLength,
@@ -259,8 +301,6 @@ void Storm::RigidBodyParticleSystem::initializePreSimulation(const Storm::Partic
 					currentPPosition,
 					bundleContainingPtr,
 					outLinkedNeighborBundle,
-					rawKernelMeth,
-					gradKernel,
 					domainDimension,
 					false
 				};
@@ -285,6 +325,8 @@ void Storm::RigidBodyParticleSystem::initializePreSimulation(const Storm::Partic
 					Storm::searchForNeighborhood<true, false>(inParam);
 				}
 
+				kernelBatch(kernelLength, currentPStaticNeighborhood);
+
 				// Compute the volume with the current dynamic rigid body (since the internal particle to the dynamic rigid body are statics from each other, or we won't call it rigid...).
 				float initialDeltaVolume = currentKernelZero;
 
@@ -428,6 +470,38 @@ const Storm::Vector3& Storm::RigidBodyParticleSystem::getRbTotalForce() const no
 	return _rbTotalForce;
 }
 
+void Storm::RigidBodyParticleSystem::computeWrench(Storm::Vector3 &outTotalForce, Storm::Vector3 &outTotalTorque) const
+{
+	struct Wrench
+	{
+	public:
+		__forceinline void merge(const Wrench &other)
+		{
+			_force += other._force;
+			_torque += other._torque;
+		}
+
+	public:
+		Storm::Vector3 _force = Storm::Vector3::Zero();
+		Storm::Vector3 _torque = Storm::Vector3::Zero();
+	};
+
+	// The torque is accumulated around the rigid body center (the particles are near it, so the cross products keep their precision),
+	// then moved back to the world origin (that's what the per particle path of the physics engine does) : sum(f x p) = sum(f x (p - c)) + (sum f) x c
+	// The chunks are merged in order, so the total doesn't change from a run to another whatever the thread count.
+	const Storm::Vector3 &rbCenter = _cachedTrackedRbPosition;
+
+	const Wrench totalWrench = Storm::reduceChunkedParallel<1024, Wrench>(_positions, [this, &rbCenter](const Storm::Vector3 &pPosition, const std::size_t currentPIndex, Wrench &chunkWrench)
+	{
+		const Storm::Vector3 &pForce = _force[currentPIndex];
+		chunkWrench._force += pForce;
+		chunkWrench._torque += pForce.cross(pPosition - rbCenter);
+	});
+
+	outTotalForce = totalWrench._force;
+	outTotalTorque = totalWrench._torque + totalWrench._force.cross(rbCenter);
+}
+
 bool Storm::RigidBodyParticleSystem::isFluids() const noexcept
 {
 	return false;
@@ -449,6 +523,7 @@ void Storm::RigidBodyParticleSystem::setPositions(std::vector<Storm::Vector3> &&
 	{
 		_positions = std::move(positions);
 		_isDirty = true;
+		_localCoordinatesDirty = true;
 	}
 }
 
@@ -491,6 +566,7 @@ void Storm::RigidBodyParticleSystem::setMasses(std::vector<float> &&)
 void Storm::RigidBodyParticleSystem::setNormals(std::vector<Storm::Vector3> &&normals)
 {
 	_normals = std::move(normals);
+	_localCoordinatesDirty = true;
 }
 
 void Storm::RigidBodyParticleSystem::setTmpPressureForces(std::vector<Storm::Vector3> &&tmpPressureForces)
@@ -565,6 +641,7 @@ void Storm::RigidBodyParticleSystem::setTmpBlowerForces(std::vector<Storm::Vecto
 void Storm::RigidBodyParticleSystem::setParticleSystemPosition(const Storm::Vector3 &rbPosition)
 {
 	_cachedTrackedRbPosition = rbPosition;
+	_localCoordinatesDirty = true;
 }
 
 void Storm::RigidBodyParticleSystem::setParticleSystemTotalForce(const Storm::Vector3 &rbTotalForce)
@@ -593,12 +670,11 @@ void Storm::RigidBodyParticleSystem::buildNeighborhoodOnParticleSystemUsingSpace
 	const Storm::IConfigManager &configMgr = singletonHolder.getSingleton<Storm::IConfigManager>();
 	const Storm::SceneSimulationConfig &sceneSimulationConfig = configMgr.getSceneSimulationConfig();
 
-	const Storm::RawKernelMethodDelegate rawKernelMeth = Storm::retrieveRawKernelMethod(sceneSimulationConfig._kernelMode);
-	const Storm::GradKernelMethodDelegate gradKernel = Storm::retrieveGradKernelMethod(sceneSimulationConfig._kernelMode);
+	const Storm::KernelBatchMethodDelegate kernelBatch = Storm::retrieveKernelBatchMethod(sceneSimulationConfig._kernelMode);
 
 	if (this->isStatic())
 	{
-		Storm::runParallel(_neighborhood, [this, &allParticleSystems, &spacePartitionerMgr, &rawKernelMeth, &gradKernel, kernelLength, kernelLengthSquared = kernelLength * kernelLength, currentSystemId = this->getId(), domainDimension = spacePartitionerMgr.getDomainDimension(), infiniteDomain = spacePartitionerMgr.isInfiniteDomainMode()](ParticleNeighborhoodArray &currentPNeighborhood, const std::size_t particleIndex)
+		_neighborhood.fill([this, &allParticleSystems, &spacePartitionerMgr, &kernelBatch, kernelLength, kernelLengthSquared = kernelLength * kernelLength, currentSystemId = this->getId(), domainDimension = spacePartitionerMgr.getDomainDimension(), infiniteDomain = spacePartitionerMgr.isInfiniteDomainMode()](ParticleNeighborhoodBuildArray &currentPNeighborhood, const std::size_t particleIndex)
 		{
 			const Storm::Vector3 &currentPPosition = _positions[particleIndex];
 			if (spacePartitionerMgr.isOutsideSpaceDomain(currentPPosition)) STORM_UNLIKELY
@@ -606,10 +682,10 @@ void Storm::RigidBodyParticleSystem::buildNeighborhoodOnParticleSystemUsingSpace
 				return;
 			}
 
-			const std::vector<Storm::NeighborParticleReferral>* bundleContainingPtr;
-			const std::vector<Storm::NeighborParticleReferral>* outLinkedNeighborBundle[Storm::k_neighborLinkedBunkCount];
+			const Storm::NeighborParticleReferralBundle* bundleContainingPtr;
+			const Storm::NeighborParticleReferralBundle* outLinkedNeighborBundle[Storm::k_neighborLinkedBunkCount];
 
-			Storm::NeighborSearchInParam<ParticleNeighborhoodArray, decltype(rawKernelMeth), decltype(gradKernel), Storm::k_neighborLinkedBunkCount> inParam{
+			Storm::NeighborSearchInParam<ParticleNeighborhoodBuildArray, Storm::k_neighborLinkedBunkCount> inParam{
 				this,
 				allParticleSystems,
 				kernelLength,
@@ -620,8 +696,6 @@ void Storm::RigidBodyParticleSystem::buildNeighborhoodOnParticleSystemUsingSpace
 				currentPPosition,
 				bundleContainingPtr,
 				outLinkedNeighborBundle,
-				rawKernelMeth,
-				gradKernel,
 				domainDimension,
 				false
 			};
@@ -645,11 +719,13 @@ void Storm::RigidBodyParticleSystem::buildNeighborhoodOnParticleSystemUsingSpace
 				spacePartitionerMgr.getAllBundles(bundleContainingPtr, outLinkedNeighborBundle, currentPPosition, Storm::PartitionSelection::DynamicRigidBody);
 				Storm::searchForNeighborhood<false, false>(inParam);
 			}
+
+			kernelBatch(kernelLength, currentPNeighborhood);
 		});
 	}
 	else
 	{
-		Storm::runParallel(_neighborhood, [this, &allParticleSystems, &spacePartitionerMgr, &rawKernelMeth, &gradKernel, kernelLength, kernelLengthSquared = kernelLength * kernelLength, currentSystemId = this->getId(), domainDimension = spacePartitionerMgr.getDomainDimension(), infiniteDomain = spacePartitionerMgr.isInfiniteDomainMode()](ParticleNeighborhoodArray &currentPNeighborhood, const std::size_t particleIndex)
+		_neighborhood.fill([this, &allParticleSystems, &spacePartitionerMgr, &kernelBatch, kernelLength, kernelLengthSquared = kernelLength * kernelLength, currentSystemId = this->getId(), domainDimension = spacePartitionerMgr.getDomainDimension(), infiniteDomain = spacePartitionerMgr.isInfiniteDomainMode()](ParticleNeighborhoodBuildArray &currentPNeighborhood, const std::size_t particleIndex)
 		{
 			const Storm::Vector3 &currentPPosition = _positions[particleIndex];
 			if (spacePartitionerMgr.isOutsideSpaceDomain(currentPPosition)) STORM_UNLIKELY
@@ -657,10 +733,10 @@ void Storm::RigidBodyParticleSystem::buildNeighborhoodOnParticleSystemUsingSpace
 				return;
 			}
 
-			const std::vector<Storm::NeighborParticleReferral>* bundleContainingPtr;
-			const std::vector<Storm::NeighborParticleReferral>* outLinkedNeighborBundle[Storm::k_neighborLinkedBunkCount];
+			const Storm::NeighborParticleReferralBundle* bundleContainingPtr;
+			const Storm::NeighborParticleReferralBundle* outLinkedNeighborBundle[Storm::k_neighborLinkedBunkCount];
 
-			Storm::NeighborSearchInParam<ParticleNeighborhoodArray, decltype(rawKernelMeth), decltype(gradKernel), Storm::k_neighborLinkedBunkCount> inParam{
+			Storm::NeighborSearchInParam<ParticleNeighborhoodBuildArray, Storm::k_neighborLinkedBunkCount> inParam{
 				this,
 				allParticleSystems,
 				kernelLength,
@@ -671,8 +747,6 @@ void Storm::RigidBodyParticleSystem::buildNeighborhoodOnParticleSystemUsingSpace
 				currentPPosition,
 				bundleContainingPtr,
 				outLinkedNeighborBundle,
-				rawKernelMeth,
-				gradKernel,
 				domainDimension,
 				false
 			};
@@ -705,6 +779,8 @@ void Storm::RigidBodyParticleSystem::buildNeighborhoodOnParticleSystemUsingSpace
 				spacePartitionerMgr.getAllBundles(bundleContainingPtr, outLinkedNeighborBundle, currentPPosition, Storm::PartitionSelection::DynamicRigidBody);
 				Storm::searchForNeighborhood<true, false>(inParam);
 			}
+
+			kernelBatch(kernelLength, currentPNeighborhood);
 		});
 	}
 }
@@ -727,22 +803,22 @@ void Storm::RigidBodyParticleSystem::buildSpecificParticleNeighborhoodOnParticle
 
 	const bool infiniteDomain = spacePartitionerMgr.isInfiniteDomainMode();
 
-	const std::vector<Storm::NeighborParticleReferral>* bundleContainingPtr;
-	const std::vector<Storm::NeighborParticleReferral>* outLinkedNeighborBundle[Storm::k_neighborLinkedBunkCount];
+	const Storm::NeighborParticleReferralBundle* bundleContainingPtr;
+	const Storm::NeighborParticleReferralBundle* outLinkedNeighborBundle[Storm::k_neighborLinkedBunkCount];
+
+	Storm::ParticleNeighborhoodBuildArray currentPNeighborhood;
 
-	Storm::NeighborSearchInParam<ParticleNeighborhoodArray, decltype(Storm::retrieveRawKernelMethod(sceneSimulationConfig._kernelMode)), decltype(Storm::retrieveGradKernelMethod(sceneSimulationConfig._kernelMode)), Storm::k_neighborLinkedBunkCount> inParam{
+	Storm::NeighborSearchInParam<ParticleNeighborhoodBuildArray, Storm::k_neighborLinkedBunkCount> inParam{
 		this,
 		allParticleSystems,
 		kernelLength,
 		kernelLength * kernelLength,
 		this->getId(),
-		_neighborhood[particleIndex],
+		currentPNeighborhood,
 		particleIndex,
 		currentPPosition,
 		bundleContainingPtr,
 		outLinkedNeighborBundle,
-		Storm::retrieveRawKernelMethod(sceneSimulationConfig._kernelMode),
-		Storm::retrieveGradKernelMethod(sceneSimulationConfig._kernelMode),
 		spacePartitionerMgr.getDomainDimension(),
 		false
 	};
@@ -800,6 +876,9 @@ void Storm::RigidBodyParticleSystem::buildSpecificParticleNeighborhoodOnParticle
 			Storm::searchForNeighborhood<true, false>(inParam);
 		}
 	}
+
+	Storm::retrieveKernelBatchMethod(sceneSimulationConfig._kernelMode)(kernelLength, currentPNeighborhood);
+	_neighborhood.setParticleNeighborhood(particleIndex, currentPNeighborhood);
 }
 
 bool Storm::RigidBodyParticleSystem::computeVelocityChange(float, float)
@@ -831,46 +910,56 @@ void Storm::RigidBodyParticleSystem::updatePosition(float deltaTimeInSec, bool f
 			_isDirty = true;
 			_velocityDirtyInternal = true;
 
-			const Storm::Quaternion oldRbRotationConjugateQuat = _cachedTrackedRbRotationQuat.conjugate();
-			const Storm::Quaternion currentConjugateQuatRotation = currentQuatRotation.conjugate();
-
-			Storm::runParallel(_positions, [&](Storm::Vector3 &currentPPosition, const std::size_t currentPIndex)
+			if (_localCoordinatesDirty)
 			{
-				Storm::Vector3 &currentPVelocity = _velocity[currentPIndex];
-				Storm::Vector3 &currentPNormal = _normals[currentPIndex];
-
-				/* First, remove the current world space coordinate to revert to the object space coordinate (where particle were defined initially and on which PhysX was initialized). */
-
-				// 1- Remove the translation
-				Storm::Quaternion currentPosAsPureQuat{ 0.f, currentPPosition.x() - _cachedTrackedRbPosition.x(), currentPPosition.y() - _cachedTrackedRbPosition.y(), currentPPosition.z() - _cachedTrackedRbPosition.z() };
+				this->computeLocalCoordinates();
+			}
 
-				Storm::Quaternion currentNormalsAsPureQuat{ 0.f, currentPNormal.x(), currentPNormal.y() , currentPNormal.z() };
+			// The particles are always placed from their object space coordinates (where particle were defined initially and on which PhysX was initialized), so the float errors don't accumulate over the frames.
+			const Storm::RigidBodyTransform rbTransform{ currentQuatRotation, currentRbPosition };
 
+			// The particles are transformed by chunks so the batched (SIMD) transform is used on contiguous particles.
+			enum : std::size_t { k_transformChunkSize = 1024 };
 
-				// 2- Remove the rotation
-				currentPosAsPureQuat = oldRbRotationConjugateQuat * currentPosAsPureQuat * _cachedTrackedRbRotationQuat;
-				currentNormalsAsPureQuat = oldRbRotationConjugateQuat * currentNormalsAsPureQuat * _cachedTrackedRbRotationQuat;
+			const std::size_t particleCount = _positions.size();
+			std::vector<std::size_t> chunkFirstIndexes((particleCount + k_transformChunkSize - 1) / k_transformChunkSize);
+			for (std::size_t chunkIndex = 0; chunkIndex < chunkFirstIndexes.size(); ++chunkIndex)
+			{
+				chunkFirstIndexes[chunkIndex] = chunkIndex * k_transformChunkSize;
+			}
 
+			Storm::runParallel(chunkFirstIndexes, [&](const std::size_t firstPIndex, const std::size_t)
+			{
+				const std::size_t chunkParticleCount = std::min(static_cast<std::size_t>(k_transformChunkSize), particleCount - firstPIndex);
 
-				/* Finally, once we're in object space coordinate, reapply the correct transformation to go back to the world coordinate (with correct transformation) */
+				Storm::Vector3 newPPositions[k_transformChunkSize];
+				rbTransform.transformPositions(&_localPositions[firstPIndex], newPPositions, chunkParticleCount);
+				rbTransform.transformDirections(&_localNormals[firstPIndex], &_normals[firstPIndex], chunkParticleCount);
 
-				// 1- Apply the rotation
-				currentPosAsPureQuat = currentQuatRotation * currentPosAsPureQuat * currentConjugateQuatRotation;
-				currentNormalsAsPureQuat = currentQuatRotation * currentNormalsAsPureQuat * currentConjugateQuatRotation;
+				for (std::size_t chunkPIndex = 0; chunkPIndex < chunkParticleCount; ++chunkPIndex)
+				{
+					const std::size_t currentPIndex = firstPIndex + chunkPIndex;
+					Storm::Vector3 &currentPPosition = _positions[currentPIndex];
+					Storm::Vector3 &currentPVelocity = _velocity[currentPIndex];
 
-				// 2- Apply the translation
-				const Storm::Vector3 newPPosition = currentPosAsPureQuat.vec() + currentRbPosition;
+					const Storm::Vector3 &newPPosition = newPPositions[chunkPIndex];
 
-				currentPVelocity = newPPosition - currentPPosition;
-				currentPVelocity /= deltaTimeInSec;
+					currentPVelocity = newPPosition - currentPPosition;
+					currentPVelocity /= deltaTimeInSec;
 
-				currentPPosition = newPPosition;
-				currentPNormal = currentNormalsAsPureQuat.vec();
+					currentPPosition = newPPosition;
+				}
 			});
 
-			this->setParticleSystemPosition(currentRbPosition);
+			_cachedTrackedRbPosition = currentRbPosition;
 			_cachedTrackedRbRotationQuat = currentQuatRotation;
 
+			// Static rigid bodies are only moved once (to be placed in the scene). Don't keep their object space coordinates.
+			if (_isStatic)
+			{
+				this->releaseLocalCoordinates();
+			}
+
 			// The force is for the first frame, where we set the position to the position in scene.
 			// The velocity mustn't be changed because it is a artificial move (not a physic move) from object space to world space.
 			if (force || deltaTimeInSec == 0.f)
@@ -897,6 +986,31 @@ void Storm::RigidBodyParticleSystem::updatePosition(float deltaTimeInSec, bool f
 	}
 }
 
+void Storm::RigidBodyParticleSystem::computeLocalCoordinates()
+{
+	// Remove the transform the particles were placed with (translation, then rotation). Note that the rotation matrix inverse is its transpose.
+	const Eigen::Matrix3f inverseRotation = _cachedTrackedRbRotationQuat.toRotationMatrix().transpose();
+
+	_localPositions.resize(_positions.size());
+	_localNormals.resize(_normals.size());
+
+	Storm::runParallel(_localPositions, [this, &inverseRotation](Storm::Vector3 &localPosition, const std::size_t currentPIndex)
+	{
+		localPosition = inverseRotation * (_positions[currentPIndex] - _cachedTrackedRbPosition);
+		_localNormals[currentPIndex] = inverseRotation * _normals[currentPIndex];
+	});
+
+	_localCoordinatesDirty = false;
+}
+
+void Storm::RigidBodyParticleSystem::releaseLocalCoordinates()
+{
+	std::vector<Storm::Vector3>{}.swap(_localPositions);
+	std::vector<Storm::Vector3>{}.swap(_localNormals);
+
+	_localCoordinatesDirty = true;
+}
+
 void Storm::RigidBodyParticleSystem::revertToCurrentTimestep(const std::vector<std::unique_ptr<Storm::IBlower>> &)
 {
 	if (!_isStatic)
@@ -912,33 +1026,28 @@ void Storm::RigidBodyParticleSystem::revertToCurrentTimestep(const std::vector<s
 std::vector<float> Storm::RigidBodyParticleSystem::computeEmptiness(const Storm::ParticleSystemContainer &allParticleSystems, const float kernelLength) const
 {
 	std::vector<float> results;
-	std::vector<Storm::ParticleNeighborhoodArray> tmpFluidNeighbors;
+	std::vector<Storm::ParticleNeighborhoodBuildArray> tmpFluidNeighbors;
 
 	const std::size_t pCount = this->getParticleCount();
 
 	results.resize(pCount);
 	tmpFluidNeighbors.resize(pCount);
-	for (Storm::ParticleNeighborhoodArray &particleNeighbor : tmpFluidNeighbors)
+	for (Storm::ParticleNeighborhoodBuildArray &particleNeighbor : tmpFluidNeighbors)
 	{
 		particleNeighbor.reserve(32);
 	}
 
 	const Storm::SingletonHolder &singletonHolder = Storm::SingletonHolder::instance();
 	const Storm::ISpacePartitionerManager &spacePartitionerMgr = singletonHolder.getSingleton<Storm::ISpacePartitionerManager>();
-	const Storm::IConfigManager &configMgr = singletonHolder.getSingleton<Storm::IConfigManager>();
-
-	const Storm::SceneSimulationConfig &sceneSimulationConfig = configMgr.getSceneSimulationConfig();
-	const Storm::RawKernelMethodDelegate rawKernelMeth = Storm::retrieveRawKernelMethod(sceneSimulationConfig._kernelMode);
-	const Storm::GradKernelMethodDelegate gradKernel = Storm::retrieveGradKernelMethod(sceneSimulationConfig._kernelMode);
 
-	Storm::runParallel(tmpFluidNeighbors, [&, kernelLengthSquared = kernelLength * kernelLength, currentSystemId = this->getId(), domainDimension = spacePartitionerMgr.getDomainDimension(), infiniteDomain = spacePartitionerMgr.isInfiniteDomainMode()](ParticleNeighborhoodArray &currentPFluidNeighborhood, const std::size_t particleIndex)
+	Storm::runParallel(tmpFluidNeighbors, [&, kernelLengthSquared = kernelLength * kernelLength, currentSystemId = this->getId(), domainDimension = spacePartitionerMgr.getDomainDimension(), infiniteDomain = spacePartitionerMgr.isInfiniteDomainMode()](ParticleNeighborhoodBuildArray &currentPFluidNeighborhood, const std::size_t particleIndex)
 	{
-		const std::vector<Storm::NeighborParticleReferral>* bundleContainingPtr;
-		const std::vector<Storm::NeighborParticleReferral>* outLinkedNeighborBundle[Storm::k_neighborLinkedBunkCount];
+		const Storm::NeighborParticleReferralBundle* bundleContainingPtr;
+		const Storm::NeighborParticleReferralBundle* outLinkedNeighborBundle[Storm::k_neighborLinkedBunkCount];
 
 		const Storm::Vector3 &currentPPosition = _positions[particleIndex];
 
-		Storm::NeighborSearchInParam<ParticleNeighborhoodArray, decltype(rawKernelMeth), decltype(gradKernel), Storm::k_neighborLinkedBunkCount> inParam{
+		Storm::NeighborSearchInParam<ParticleNeighborhoodBuildArray, Storm::k_neighborLinkedBunkCount> inParam{
 			const_cast<Storm::RigidBodyParticleSystem*>(this), // const_cast because we take a non const but we don't actually modify the object (Just the neighbor structure obtain a non const pointed object it could change later, but we wont right now)
 			allParticleSystems,
 			kernelLength,
@@ -949,8 +1058,6 @@ std::vector<float> Storm::RigidBodyParticleSystem::computeEmptiness(const Storm:
 			currentPPosition,
 			bundleContainingPtr,
 			outLinkedNeighborBundle,
-			rawKernelMeth,
-			gradKernel,
 			domainDimension,
 			true
 		};
@@ -61,6 +61,9 @@ namespace Storm
 		const Storm::Vector3& getRbPosition() const noexcept;
 		const Storm::Vector3& getRbTotalForce() const noexcept;
 
+		// The sum of the particles forces, and their torque with the same convention than Storm::IPhysicsManager::applyLocalForces.
+		void computeWrench(Storm::Vector3 &outTotalForce, Storm::Vector3 &outTotalTorque) const;
+
 	private:
 		void buildNeighborhoodOnParticleSystemUsingSpacePartition(const Storm::ParticleSystemContainer &allParticleSystems, const float kernelLength) final override;
 		void buildSpecificParticleNeighborhoodOnParticleSystemUsingSpacePartition(const Storm::ParticleSystemContainer &allParticleSystems, const std::size_t particleIndex, const float kernelLength) final override;
@@ -71,6 +74,11 @@ namespace Storm
 	public:
 		void updatePosition(float deltaTimeInSec, bool force) final override;
 
+	private:
+		// Retrieve the particles object space coordinates from their current world coordinates and the transform they were placed with.
+		void computeLocalCoordinates();
+		void releaseLocalCoordinates();
+
 	public:
 		void revertToCurrentTimestep(const std::vector<std::unique_ptr<Storm::IBlower>> &blowers) final override;
 
@@ -97,6 +105,11 @@ namespace Storm
 		Storm::Vector3 _cachedTrackedRbPosition;
 		Storm::Quaternion _cachedTrackedRbRotationQuat;
 
+		// The particles positions and normals in object space, from which we compute their world coordinates when the rigid body moves.
+		// They're retrieved from the world coordinates the first time the rigid body moves after its particles were set from outside (load, state file, ...).
+		std::vector<Storm::Vector3> _localPositions;
+		std::vector<Storm::Vector3> _localNormals;
+
 		// Account for PhysX
 		Storm::Vector3 _rbTotalForce;
 
@@ -105,5 +118,6 @@ namespace Storm
 		bool _isStatic;
 		bool _isWall;
 		bool _velocityDirtyInternal;
+		bool _localCoordinatesDirty;
 	};
 }
@@ -0,0 +1,44 @@
+#include "RigidBodyReactionAccumulator.h"
+
+
+Storm::RigidBodyReactionAccumulator::RigidBodyReactionAccumulator() = default;
+Storm::RigidBodyReactionAccumulator::~RigidBodyReactionAccumulator() = default;
+
+void Storm::RigidBodyReactionAccumulator::Chunk::grow()
+{
+	std::vector<Reaction> previousReactionSlots = std::move(_reactionSlots);
+
+	_reactionSlots.assign(std::max(previousReactionSlots.size() * 2, static_cast<std::size_t>(k_minReactionSlotCount)), Reaction{ nullptr, Storm::Vector3::Zero() });
+	_reactionCount = 0;
+
+	for (const Reaction &previousReaction : previousReactionSlots)
+	{
+		if (previousReaction._target != nullptr)
+		{
+			this->findReaction(*previousReaction._target)._value = previousReaction._value;
+		}
+	}
+}
+
+void Storm::RigidBodyReactionAccumulator::applyReactions()
+{
+	// Sequential on purpose : a rigid body particle can receive reactions summed by different chunks, and we want them to be always summed in the same order.
+	// The order of the targets inside a chunk table doesn't matter since each target only appears once.
+	// This is cheap compared to the loop that produced them since there is only one add per target and per chunk.
+	for (Chunk &chunk : _chunks)
+	{
+		if (chunk._reactionCount != 0)
+		{
+			for (Chunk::Reaction &reaction : chunk._reactionSlots)
+			{
+				if (reaction._target != nullptr)
+				{
+					*reaction._target += reaction._value;
+					reaction._target = nullptr;
+				}
+			}
+
+			chunk._reactionCount = 0;
+		}
+	}
+}
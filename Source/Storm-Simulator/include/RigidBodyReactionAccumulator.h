@@ -0,0 +1,120 @@
+#pragma once
+
+#include "RunnerHelper.h"
+
+
+namespace Storm
+{
+	// Accumulates the forces fluid particles mirror on dynamic rigid body particles (3rd Newton law) without any lock.
+	// The fluid particles are processed by chunks of consecutive particles, each chunk sums its reactions per target inside its own table,
+	// then those sums are applied to their targets chunk after chunk once the parallel loop is over.
+	// Since chunks depend neither on the thread count nor on the scheduling, the summation order (so the result) is always the same.
+	// The particles being sorted spatially, the fluid particles of a chunk push on the same few rigid body particles, so summing them inside the chunk is much cheaper than recording each reaction.
+	class RigidBodyReactionAccumulator
+	{
+	public:
+		class Chunk
+		{
+		private:
+			friend class Storm::RigidBodyReactionAccumulator;
+
+			// The sum of the reactions of the chunk on one target. An empty slot has no target.
+			struct Reaction
+			{
+				Storm::Vector3* _target;
+				Storm::Vector3 _value;
+			};
+
+			enum : std::size_t
+			{
+				k_minReactionSlotCount = 256,
+			};
+
+		public:
+			__forceinline void add(Storm::Vector3 &target, const Storm::Vector3 &value)
+			{
+				this->findReaction(target)._value += value;
+			}
+
+			__forceinline void subtract(Storm::Vector3 &target, const Storm::Vector3 &value)
+			{
+				this->findReaction(target)._value -= value;
+			}
+
+		private:
+			// Open addressing with linear probing. The table is kept at most half full so the probe sequences remain short.
+			__forceinline Reaction& findReaction(Storm::Vector3 &target)
+			{
+				if (_reactionCount * 2 >= _reactionSlots.size()) STORM_UNLIKELY
+				{
+					this->grow();
+				}
+
+				const std::size_t slotMask = _reactionSlots.size() - 1;
+				std::size_t slotIndex = ((reinterpret_cast<std::uintptr_t>(&target) * 0x9E3779B97F4A7C15ull) >> 32) & slotMask;
+				for (;;)
+				{
+					Reaction &reaction = _reactionSlots[slotIndex];
+					if (reaction._target == &target)
+					{
+						return reaction;
+					}
+					else if (reaction._target == nullptr)
+					{
+						reaction._target = &target;
+						reaction._value = Storm::Vector3::Zero();
+						++_reactionCount;
+						return reaction;
+					}
+
+					slotIndex = (slotIndex + 1) & slotMask;
+				}
+			}
+
+			void grow();
+
+		private:
+			std::vector<Reaction> _reactionSlots;
+			std::size_t _reactionCount = 0;
+		};
+
+	private:
+		enum : std::size_t
+		{
+			k_chunkItemCountShift = 8,
+			k_chunkItemCount = static_cast<std::size_t>(1) << k_chunkItemCountShift,
+		};
+
+	public:
+		RigidBodyReactionAccumulator();
+		~RigidBodyReactionAccumulator();
+
+	public:
+		// Like Storm::runParallel, except that func(item, index, chunk) also receives the chunk to record the reactions into.
+		// The recorded reactions are applied to their targets before returning.
+		template<class ContainerType, class Func>
+		void runParallel(ContainerType &container, const Func &func)
+		{
+			const std::size_t itemCount = std::size(container);
+			_chunks.resize((itemCount + k_chunkItemCount - 1) >> k_chunkItemCountShift);
+
+			Storm::runParallel(_chunks, [&container, &func, itemCount](Chunk &chunk, const std::size_t chunkIndex)
+			{
+				const std::size_t firstIndex = chunkIndex << k_chunkItemCountShift;
+				const std::size_t endIndex = std::min(firstIndex + k_chunkItemCount, itemCount);
+				for (std::size_t index = firstIndex; index < endIndex; ++index)
+				{
+					func(container[index], index, chunk);
+				}
+			});
+
+			this->applyReactions();
+		}
+
+	private:
+		void applyReactions();
+
+	private:
+		std::vector<Chunk> _chunks;
+	};
+}
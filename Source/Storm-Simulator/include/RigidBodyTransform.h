@@ -0,0 +1,121 @@
+#pragma once
+
+#include "ArchitectureMacros.h"
+
+#if STORM_USE_INTRINSICS
+#	include <immintrin.h>
+#endif
+
+
+namespace Storm
+{
+	// The rigid body transform (rotation then translation), to place the rigid body particles from their object space coordinates.
+	// The batched methods transform 4 particles at once : their coordinates are loaded with 3 unaligned loads, deinterleaved to one register per axis (SoA), transformed with 9 multiply-add, then interleaved back.
+	// The particles left after the last group of 4 are transformed one by one.
+	class RigidBodyTransform
+	{
+	public:
+		RigidBodyTransform(const Storm::Quaternion &rotation, const Storm::Vector3 &translation) :
+			_rotation{ rotation.toRotationMatrix() },
+			_translation{ translation }
+		{}
+
+	public:
+		__forceinline Storm::Vector3 transformPosition(const Storm::Vector3 &localPosition) const
+		{
+			return _rotation * localPosition + _translation;
+		}
+
+		__forceinline Storm::Vector3 transformDirection(const Storm::Vector3 &localDirection) const
+		{
+			return _rotation * localDirection;
+		}
+
+		// outPositions[i] = transformPosition(localPositions[i]) for i in [0, count). Both arrays shouldn't overlap.
+		void transformPositions(const Storm::Vector3*const localPositions, Storm::Vector3*const outPositions, const std::size_t count) const
+		{
+			this->transformBatch<true>(localPositions, outPositions, count);
+		}
+
+		// outDirections[i] = transformDirection(localDirections[i]) for i in [0, count). Both arrays shouldn't overlap.
+		void transformDirections(const Storm::Vector3*const localDirections, Storm::Vector3*const outDirections, const std::size_t count) const
+		{
+			this->transformBatch<false>(localDirections, outDirections, count);
+		}
+
+	private:
+		template<bool translate>
+		void transformBatch(const Storm::Vector3*const localVects, Storm::Vector3*const outVects, const std::size_t count) const
+		{
+			static_assert(sizeof(Storm::Vector3) == 3 * sizeof(float), "The batched transform expects packed float Vector3!");
+
+			std::size_t iter = 0;
+
+#if STORM_USE_INTRINSICS
+			enum : std::size_t { k_laneCount = 4 };
+
+			__m128 rotation[3][3];
+			for (int row = 0; row < 3; ++row)
+			{
+				for (int column = 0; column < 3; ++column)
+				{
+					rotation[row][column] = _mm_set1_ps(_rotation(row, column));
+				}
+			}
+
+			const __m128 translation[3] = {
+				_mm_set1_ps(translate ? _translation.x() : 0.f),
+				_mm_set1_ps(translate ? _translation.y() : 0.f),
+				_mm_set1_ps(translate ? _translation.z() : 0.f)
+			};
+
+			const float*const srcPtr = reinterpret_cast<const float*>(localVects);
+			float*const dstPtr = reinterpret_cast<float*>(outVects);
+
+			for (; iter + k_laneCount <= count; iter += k_laneCount)
+			{
+				// a = (x0, y0, z0, x1), b = (y1, z1, x2, y2), c = (z2, x3, y3, z3)
+				const float*const src = srcPtr + iter * 3;
+				const __m128 a = _mm_loadu_ps(src);
+				const __m128 b = _mm_loadu_ps(src + 4);
+				const __m128 c = _mm_loadu_ps(src + 8);
+
+				const __m128 x = _mm_shuffle_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 3, 0, 0)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 2, 0));
+				const __m128 y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+				const __m128 z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+
+				__m128 result[3];
+				for (int row = 0; row < 3; ++row)
+				{
+					result[row] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(rotation[row][0], x), _mm_mul_ps(rotation[row][1], y)), _mm_add_ps(_mm_mul_ps(rotation[row][2], z), translation[row]));
+				}
+
+				const __m128 &rx = result[0];
+				const __m128 &ry = result[1];
+				const __m128 &rz = result[2];
+
+				float*const dst = dstPtr + iter * 3;
+				_mm_storeu_ps(dst, _mm_shuffle_ps(_mm_shuffle_ps(rx, ry, _MM_SHUFFLE(0, 0, 0, 0)), _mm_shuffle_ps(rz, rx, _MM_SHUFFLE(1, 1, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0)));
+				_mm_storeu_ps(dst + 4, _mm_shuffle_ps(_mm_shuffle_ps(ry, rz, _MM_SHUFFLE(1, 1, 1, 1)), _mm_shuffle_ps(rx, ry, _MM_SHUFFLE(2, 2, 2, 2)), _MM_SHUFFLE(2, 0, 2, 0)));
+				_mm_storeu_ps(dst + 8, _mm_shuffle_ps(_mm_shuffle_ps(rz, rx, _MM_SHUFFLE(3, 3, 2, 2)), _mm_shuffle_ps(ry, rz, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0)));
+			}
+#endif
+
+			for (; iter < count; ++iter)
+			{
+				if constexpr (translate)
+				{
+					outVects[iter] = this->transformPosition(localVects[iter]);
+				}
+				else
+				{
+					outVects[iter] = this->transformDirection(localVects[iter]);
+				}
+			}
+		}
+
+	private:
+		Eigen::Matrix3f _rotation;
+		Storm::Vector3 _translation;
+	};
+}
@@ -8,6 +8,7 @@
 #include "PCISPHSolver.h"
 #include "IISPHSolver.h"
 #include "DFSPHSolver.h"
+#include "CGSPHSolver.h"
 
 
 std::unique_ptr<Storm::ISPHBaseSolver> Storm::instantiateSPHSolver(const Storm::SolverCreationParameter &creationParameter)
@@ -18,6 +19,7 @@ std::unique_ptr<Storm::ISPHBaseSolver> Storm::instantiateSPHSolver(const Storm::
 	case Storm::SimulationMode::PCISPH: return std::make_unique<Storm::PCISPHSolver>(creationParameter._kernelLength, *creationParameter._particleSystems);
 	case Storm::SimulationMode::IISPH: return std::make_unique<Storm::IISPHSolver>(creationParameter._kernelLength, *creationParameter._particleSystems);
 	case Storm::SimulationMode::DFSPH: return std::make_unique<Storm::DFSPHSolver>(creationParameter._kernelLength, *creationParameter._particleSystems);
+	case Storm::SimulationMode::CGSPH: return std::make_unique<Storm::CGSPHSolver>(creationParameter._kernelLength, *creationParameter._particleSystems);
 
 	default:
 		Storm::throwException<Storm::Exception>("Unknown simulation mode!");
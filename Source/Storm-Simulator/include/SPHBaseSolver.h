@@ -5,6 +5,7 @@ namespace Storm
 {
 	struct IterationParameter;
 	struct SolverCreationParameter;
+	class ParticleCompaction;
 
 	class __declspec(novtable) ISPHBaseSolver
 	{
@@ -15,6 +16,13 @@ namespace Storm
 		virtual void execute(const Storm::IterationParameter &iterationParameter) = 0;
 
 		virtual void removeRawEndData(const unsigned int pSystemId, std::size_t toRemoveCount) = 0;
+
+		// Apply to the solver per particle data the same reordering than the one done on the particle system (see ParticleSystem::reorderParticles).
+		virtual void reorderParticleData(const unsigned int pSystemId, const std::vector<std::size_t> &newToOldIndexes) = 0;
+
+		// Same for the open boundaries (see ParticleSystem::compactParticles and ParticleSystem::appendParticles). The appended data is zeroed.
+		virtual void compactParticleData(const unsigned int pSystemId, const Storm::ParticleCompaction &compaction) = 0;
+		virtual void appendRawEndData(const unsigned int pSystemId, std::size_t toAddCount) = 0;
 	};
 
 	std::unique_ptr<Storm::ISPHBaseSolver> instantiateSPHSolver(const Storm::SolverCreationParameter &creationParameter);
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "RigidBodyReactionAccumulator.h"
+
 
 namespace Storm
 {
@@ -14,5 +16,8 @@ namespace Storm
 
 	protected:
 		static constexpr const float k_epsilon = 0.0000000001f;
+
+	protected:
+		Storm::RigidBodyReactionAccumulator _rbReactionAccumulator;
 	};
 }
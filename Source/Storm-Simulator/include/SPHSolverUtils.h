@@ -1,6 +1,9 @@
 #pragma once
 
 #include "NonInstanciable.h"
+#include "ParticleReorderer.h"
+#include "ParticleCompaction.h"
+#include "RigidBodyReactionAccumulator.h"
 
 
 namespace Storm
@@ -26,6 +29,47 @@ namespace Storm
 			}
 		}
 
+		template<class DataContainerType>
+		static void reorderData(const unsigned int pSystemId, const std::vector<std::size_t> &newToOldIndexes, DataContainerType &dataMap)
+		{
+			if (auto found = dataMap.find(pSystemId); found != std::end(dataMap))
+			{
+				Storm::ParticleReorderer::applyPermutation(found->second, newToOldIndexes);
+			}
+			else
+			{
+				Storm::throwException<Storm::Exception>("Cannot find particle system data bound to particle system " + std::to_string(pSystemId));
+			}
+		}
+
+		template<class DataContainerType>
+		static void compactData(const unsigned int pSystemId, const Storm::ParticleCompaction &compaction, DataContainerType &dataMap)
+		{
+			if (auto found = dataMap.find(pSystemId); found != std::end(dataMap))
+			{
+				compaction.apply(found->second);
+			}
+			else
+			{
+				Storm::throwException<Storm::Exception>("Cannot find particle system data bound to particle system " + std::to_string(pSystemId));
+			}
+		}
+
+		template<class DataContainerType>
+		static void appendRawEndData(const unsigned int pSystemId, std::size_t toAddCount, DataContainerType &dataMap)
+		{
+			if (auto found = dataMap.find(pSystemId); found != std::end(dataMap))
+			{
+				// The data are value initialized (zeroed), since they don't have any user provided constructor.
+				auto &data = found->second;
+				data.resize(data.size() + toAddCount);
+			}
+			else
+			{
+				Storm::throwException<Storm::Exception>("Cannot find particle system data bound to particle system " + std::to_string(pSystemId));
+			}
+		}
+
 		__forceinline static void computeDragForce(const Storm::Vector3 &vi, const Storm::Vector3 &vj, const float dragPreCoeff, const float rij, Storm::Vector3 &outForce)
 		{
 			outForce = vj - vi;
@@ -34,7 +78,7 @@ namespace Storm
 		}
 
 		template<bool applyDragOnFluid>
-		static Storm::Vector3 computeSumDragForce(const Storm::IterationParameter &/*iterationParameter*/, const float uniformDragCoeff, const Storm::FluidParticleSystem &fluidParticleSystem, const Storm::Vector3 &vi, const Storm::ParticleNeighborhoodArray &currentPNeighborhood, const float currentPDensity)
+		static Storm::Vector3 computeSumDragForce(const Storm::IterationParameter &/*iterationParameter*/, const float uniformDragCoeff, const Storm::FluidParticleSystem &fluidParticleSystem, const Storm::Vector3 &vi, const Storm::ParticleNeighborhoodArray &currentPNeighborhood, const float currentPDensity, Storm::RigidBodyReactionAccumulator::Chunk &rbReactions)
 		{
 			Storm::Vector3 totalDragForce = Storm::Vector3::Zero();
 			Storm::Vector3 currentDragTmpComponent = Storm::Vector3::Zero();
@@ -76,8 +120,7 @@ namespace Storm
 						{
 							Storm::Vector3 &boundaryNeighborTmpDragForce = neighborPSystemAsBoundary->getTemporaryDragForces()[neighbor._particleIndex];
 
-							std::lock_guard<std::mutex> lock{ neighbor._containingParticleSystem->_mutex };
-							boundaryNeighborTmpDragForce -= currentDragTmpComponent;
+							rbReactions.subtract(boundaryNeighborTmpDragForce, currentDragTmpComponent);
 						}
 					}
 				}
@@ -21,6 +21,7 @@
 #include "ParticleSystem.h"
 #include "FluidParticleSystem.h"
 #include "RigidBodyParticleSystem.h"
+#include "VerletNeighborhood.h"
 
 #include "GeneralApplicationConfig.h"
 #include "GeneralSimulationConfig.h"
@@ -30,8 +31,10 @@
 #include "SceneRecordConfig.h"
 #include "SceneRigidBodyConfig.h"
 #include "SceneCageConfig.h"
+#include "SceneOpenBoundaryConfig.h"
 
 #include "RecordMode.h"
+#include "RecordChannel.h"
 #include "ReplaySolver.h"
 
 #include "PartitionSelection.h"
@@ -60,6 +63,8 @@
 #include "Blower.h"
 
 #include "Cage.h"
+#include "ParticleReorderer.h"
+#include "OpenBoundaries.h"
 
 #include "IRigidBody.h"
 
@@ -103,10 +108,6 @@
 
 #include "FuncMovePass.h"
 
-#define STORM_HIJACKED_TYPE float
-#	include "VectHijack.h"
-#undef STORM_HIJACKED_TYPE
-
 #include "CSVFormulaType.h"
 
 #include <fstream>
@@ -155,6 +156,24 @@ namespace
 				inOutResult += Storm::toStdString<PolicyType>(neighbor._isFluidParticle);
 			}
 		}
+
+		template<class PolicyType>
+		static void parseAppending(std::string &inOutResult, const Storm::ParticleNeighborhoodStorage &neighborhoods)
+		{
+			const std::size_t particleCount = neighborhoods.size();
+			for (std::size_t particleIndex = 0; particleIndex < particleCount; ++particleIndex)
+			{
+				if (particleIndex != 0)
+				{
+					inOutResult += '\n';
+				}
+
+				inOutResult += "Iter=";
+				inOutResult += std::to_string(particleIndex);
+				inOutResult += "; ";
+				ParticleDataParser::parseAppending<PolicyType>(inOutResult, neighborhoods[particleIndex]);
+			}
+		}
 	};
 
 	template<bool separator, class StreamType, class ContainerType>
@@ -642,6 +661,14 @@ namespace
 		}
 	}
 
+	void removeRawParticles(Storm::ParticleNeighborhoodStorage &neighborhoods, std::size_t toRemove)
+	{
+		if (neighborhoods.size() != 0)
+		{
+			neighborhoods.resize(neighborhoods.size() - toRemove);
+		}
+	}
+
 	template<class RemoveCallback>
 	void removeVolumeBurstingFluidPaticle(const Storm::ParticleSystemContainer &allParticleSystems, Storm::FluidParticleSystem &addedFluidPSystem, const RemoveCallback &removeCallback)
 	{
@@ -887,7 +914,7 @@ namespace
 		LOG_ALWAYS << "The participation of " << reducedSelectedPair.first << " force to the total is " << reducedSelectedPair.second.dot(baseForceVectToCheckContribAgainst) / (normSquared / 100.f) << "%";
 	}
 
-	void interpolateVelocityAtPositionPerBundle(const Storm::ParticleSystemContainer &particleSystem, const std::vector<Storm::NeighborParticleReferral> &allReferrals, const Storm::Vector3 &position, const float k_kernelSquared, std::size_t &inOutTotalPCount, Storm::Vector3 &inOutResult, const Storm::ParticleSystem* &lastPSystem, const std::vector<Storm::Vector3>* &lastPSystemPositions, const std::vector<Storm::Vector3>* &lastPSystemVelocities)
+	void interpolateVelocityAtPositionPerBundle(const Storm::ParticleSystemContainer &particleSystem, const Storm::NeighborParticleReferralBundle &allReferrals, const Storm::Vector3 &position, const float k_kernelSquared, std::size_t &inOutTotalPCount, Storm::Vector3 &inOutResult, const Storm::ParticleSystem* &lastPSystem, const std::vector<Storm::Vector3>* &lastPSystemPositions, const std::vector<Storm::Vector3>* &lastPSystemVelocities)
 	{
 		const auto interpolator = [&inOutResult]<class Selector>(const Storm::Vector3 & currentPVelocity, const float alpha, const Selector & selector)
 		{
@@ -931,6 +958,8 @@ Storm::SimulatorManager::SimulatorManager() :
 	_currentFrameNumber{ 0 },
 	_currentSimulationSystemsState{ Storm::SimulationSystemsState::Normal },
 	_maxVelocitySquaredLastStateCheck{ 0.f },
+	_neighborhoodRefreshCountSinceBuild{ 0 },
+	_neighborhoodBuildKernelLength{ -1.f },
 	_rigidBodySelectedNormalsNonOwningPtr{ nullptr },
 	_replayNeedNeighborhoodRefresh{ true }
 {
@@ -1018,6 +1047,18 @@ void Storm::SimulatorManager::initialize_Implementation()
 		{
 			_cage = std::make_unique<Storm::Cage>(*sceneOptionalCageConfig);
 		}
+
+		const Storm::SceneSimulationConfig &sceneSimulationConfig = configMgr.getSceneSimulationConfig();
+		if (Storm::ParticleReorderer::isEnabled(sceneSimulationConfig))
+		{
+			_particleReorderer = std::make_unique<Storm::ParticleReorderer>(sceneSimulationConfig);
+		}
+
+		const std::vector<Storm::SceneOpenBoundaryConfig> &sceneOpenBoundariesConfig = configMgr.getSceneOpenBoundariesConfig();
+		if (!sceneOpenBoundariesConfig.empty())
+		{
+			_openBoundaries = std::make_unique<Storm::OpenBoundaries>(sceneOpenBoundariesConfig, sceneSimulationConfig._particleRadius);
+		}
 	}
 
 	_particleSelector.initialize(isReplayMode);
@@ -1192,7 +1233,7 @@ Storm::ExitCode Storm::SimulatorManager::runReplay_Internal()
 	Storm::SerializeRecordPendingData &frameBefore = *_frameBefore;
 	Storm::SerializeRecordPendingData &frameAfter = *_frameAfter;
 
-	this->refreshParticlePartition(false);
+	this->refreshParticlePartition();
 
 	// We need particle partitioning for smoke emitters, since they aren't recorded.
 	const bool needParticlePartitionFeature = !configMgr.getSceneSmokeEmittersConfig().empty();
@@ -1377,6 +1418,7 @@ Storm::ExitCode Storm::SimulatorManager::runSimulation_Internal()
 	Storm::ISpacePartitionerManager &spacePartitionerMgr = singletonHolder.getSingleton<Storm::ISpacePartitionerManager>();
 	Storm::ISafetyManager &safetyMgr = singletonHolder.getSingleton<Storm::ISafetyManager>();
 	Storm::IEmitterManager &emitterMgr = singletonHolder.getSingleton<Storm::IEmitterManager>();
+	Storm::IProfilerManager &profilerMgr = singletonHolder.getSingleton<Storm::IProfilerManager>();
 
 	safetyMgr.notifySimulationThreadAlive();
 
@@ -1396,10 +1438,21 @@ Storm::ExitCode Storm::SimulatorManager::runSimulation_Internal()
 		this->pushParticlesToGraphicModule(true);
 	}
 
-	this->refreshParticlePartition(false);
+	this->refreshParticlePartition();
 
 	this->initializePreSimulation();
 
+	if (_openBoundaries)
+	{
+		for (auto &particleSystem : _particleSystem)
+		{
+			if (particleSystem.second->isFluids())
+			{
+				_openBoundaries->reserve(static_cast<Storm::FluidParticleSystem &>(*particleSystem.second));
+			}
+		}
+	}
+
 	const Storm::SceneRecordConfig &sceneRecordConfig = configMgr.getSceneRecordConfig();
 	const bool shouldBeRecording = sceneRecordConfig._recordMode == Storm::RecordMode::Record;
 	float nextRecordTime = -1.f;
@@ -1484,10 +1537,18 @@ Storm::ExitCode Storm::SimulatorManager::runSimulation_Internal()
 		const float k_kernelVal = this->getKernelLength();
 		if (lastKernelValue != k_kernelVal)
 		{
-			spacePartitionerMgr.setPartitionLength(k_kernelVal);
+			spacePartitionerMgr.setPartitionLength(this->getNeighborhoodSearchLength());
 			lastKernelValue = k_kernelVal;
 		}
+
+		// Not on the first frame because the particles that burst the domain volume are removed from the end of the arrays at the end of it.
+		if (_particleReorderer && !firstFrame)
+		{
+			this->reorderParticlesIfNeeded();
+		}
 
+		const auto iterationStartTime = std::chrono::high_resolution_clock::now();
+
 		// On iteration start
 		physicsMgr.notifyIterationStart();
 		for (auto &particleSystem : _particleSystem)
@@ -1514,6 +1575,36 @@ Storm::ExitCode Storm::SimulatorManager::runSimulation_Internal()
 			particleSystem.second->onIterationEnd();
 		}
 
+		// Put the quiet fluid regions to sleep (and wake the others) from the state the solver just computed.
+		if (sceneSimulationConfig._fluidSleepingStepCount != 0)
+		{
+			// The particles that slept during this iteration, before updating them for the next one.
+			std::size_t fluidParticleCount = 0;
+			std::size_t sleepingFluidParticleCount = 0;
+			for (auto &particleSystem : _particleSystem)
+			{
+				if (particleSystem.second->isFluids())
+				{
+					Storm::FluidParticleSystem &fluidPSystem = static_cast<Storm::FluidParticleSystem &>(*particleSystem.second);
+
+					fluidParticleCount += fluidPSystem.getParticleCount();
+					sleepingFluidParticleCount += fluidPSystem.getSleepingParticleCount();
+
+					fluidPSystem.updateSleeping(_particleSystem);
+				}
+			}
+
+			profilerMgr.addFluidSleepingProfile(fluidParticleCount, fluidParticleCount - sleepingFluidParticleCount, std::chrono::high_resolution_clock::now() - iterationStartTime);
+		}
+
+		this->profileNeighborhoodMemory(profilerMgr);
+
+		// Not on the first frame, for the same reason than the reordering.
+		if (_openBoundaries && !firstFrame)
+		{
+			this->updateOpenBoundaries(timeMgr.getCurrentPhysicsDeltaTime());
+		}
+
 		// Update the particle selector data with the external sum force.
 		this->refreshParticleSelection();
 
@@ -1640,11 +1731,10 @@ bool Storm::SimulatorManager::applyCFLIfNeeded(const Storm::SceneSimulationConfi
 		{
 			if (!particleSystemPair.second->isStatic())
 			{
-				const std::vector<Storm::Vector3> &velocityField = particleSystemPair.second->getVelocity();
-				float maxVelocitySquaredOnParticleSystem = std::max_element(std::execution::par, std::begin(velocityField), std::end(velocityField), [](const Storm::Vector3 &pLeftVelocity, const Storm::Vector3 &pRightVelocity)
+				const float maxVelocitySquaredOnParticleSystem = Storm::reduceChunkedParallel(particleSystemPair.second->getVelocity(), [](const Storm::Vector3 &currentPVelocity, const std::size_t, Storm::ParallelReduceResult &chunkResult)
 				{
-					return pLeftVelocity.squaredNorm() < pRightVelocity.squaredNorm();
-				})->squaredNorm();
+					chunkResult._max = std::max(chunkResult._max, currentPVelocity.squaredNorm());
+				})._max;
 
 				if (maxVelocitySquaredOnParticleSystem > currentStepMaxVelocityNorm)
 				{
@@ -1851,15 +1941,12 @@ void Storm::SimulatorManager::evaluateCurrentSystemsState()
 			const Storm::ParticleSystem &pSystem = *particleSystemPair.second;
 			if (pSystem.isFluids()) // fluids
 			{
-				const std::vector<Storm::Vector3> &velocities = pSystem.getVelocity();
-
-				Storm::setNumUninitialized_safeHijack(_tmp, Storm::VectorHijacker{ velocities.size() });
-				Storm::runParallel(velocities, [&tmp = this->_tmp](const Storm::Vector3 &currentPVelocity, const std::size_t currentPIndex)
+				const Storm::ParallelReduceResult velocityResult = Storm::reduceChunkedParallel(pSystem.getVelocity(), [](const Storm::Vector3 &currentPVelocity, const std::size_t, Storm::ParallelReduceResult &chunkResult)
 				{
-					tmp[currentPIndex] = currentPVelocity.squaredNorm();
+					chunkResult._max = std::max(chunkResult._max, currentPVelocity.squaredNorm());
 				});
 
-				currentMaxVelocitySquared = std::max(currentMaxVelocitySquared, *std::max_element(std::begin(_tmp), std::end(_tmp)));
+				currentMaxVelocitySquared = std::max(currentMaxVelocitySquared, velocityResult._max);
 			}
 			else if (!pSystem.isStatic()) // dynamic rigid body
 			{
@@ -1968,13 +2055,26 @@ void Storm::SimulatorManager::flushPhysics(const float deltaTime)
 
 	Storm::IPhysicsManager &physicsMgr = singletonHolder.getSingleton<Storm::IPhysicsManager>();
 
+	const Storm::SceneSimulationConfig &sceneSimulationConfig = singletonHolder.getSingleton<Storm::IConfigManager>().getSceneSimulationConfig();
+
 	for (auto &particleSystem : _particleSystem)
 	{
 		Storm::ParticleSystem &pSystem = *particleSystem.second;
 		// Only non static rigidbody have a changing physics state managed by PhysX engine.
 		if (!pSystem.isFluids() && !pSystem.isStatic())
 		{
-			physicsMgr.applyLocalForces(particleSystem.first, pSystem.getPositions(), pSystem.getForces());
+			if (sceneSimulationConfig._applyRbForcesPerParticle)
+			{
+				physicsMgr.applyLocalForces(particleSystem.first, pSystem.getPositions(), pSystem.getForces());
+			}
+			else
+			{
+				Storm::Vector3 totalForce;
+				Storm::Vector3 totalTorque;
+				static_cast<const Storm::RigidBodyParticleSystem &>(pSystem).computeWrench(totalForce, totalTorque);
+
+				physicsMgr.applyWrench(particleSystem.first, totalForce, totalTorque);
+			}
 		}
 	}
 
@@ -2006,13 +2106,190 @@ void Storm::SimulatorManager::refreshParticleNeighborhood()
 {
 	assert(Storm::isSimulationThread() && "This method should only be executed inside the simulation thread!");
 
-	this->refreshParticlePartition();
+	const Storm::SceneSimulationConfig &sceneSimulationConfig = Storm::SingletonHolder::instance().getSingleton<Storm::IConfigManager>().getSceneSimulationConfig();
+	if (sceneSimulationConfig._recomputeNeighborhoodStep > 1)
+	{
+		// Verlet list : the space partition and the full neighbor search are only done from time to time, with the kernel length enlarged by a skin.
+		// In between, the neighborhoods are just filtered from those candidates (and their kernel values refreshed).
+		const float kernelLength = this->getKernelLength();
+		if (this->shouldRebuildNeighborhoodCandidates(sceneSimulationConfig, kernelLength))
+		{
+			this->refreshParticlePartition();
+
+			const float searchLength = this->getNeighborhoodSearchLength();
+			for (auto &particleSystem : _particleSystem)
+			{
+				Storm::ParticleSystem &pSystem = *particleSystem.second;
+				pSystem.buildNeighborhoodCandidates(_particleSystem, searchLength);
+			}
+
+			_neighborhoodRefreshCountSinceBuild = 0;
+			_neighborhoodBuildKernelLength = kernelLength;
+		}
+
+		++_neighborhoodRefreshCountSinceBuild;
+
+		for (auto &particleSystem : _particleSystem)
+		{
+			Storm::ParticleSystem &pSystem = *particleSystem.second;
+			pSystem.refreshNeighborhoodFromCandidates(_particleSystem, kernelLength);
+		}
+	}
+	else
+	{
+		this->refreshParticlePartition();
+
+		for (auto &particleSystem : _particleSystem)
+		{
+			Storm::ParticleSystem &pSystem = *particleSystem.second;
+			pSystem.buildNeighborhood(_particleSystem);
+		}
+	}
+}
+
+void Storm::SimulatorManager::reorderParticlesIfNeeded()
+{
+	assert(Storm::isSimulationThread() && "This method should only be executed inside the simulation thread!");
+
+	_particleReorderer->onFrameAdvanced();
+
+	bool hasReordered = false;
+	std::vector<std::size_t> newToOldIndexes;
 
 	for (auto &particleSystem : _particleSystem)
 	{
 		Storm::ParticleSystem &pSystem = *particleSystem.second;
-		pSystem.buildNeighborhood(_particleSystem);
+		if (pSystem.isFluids() && _particleReorderer->shouldReorder(pSystem))
+		{
+			const unsigned int pSystemId = particleSystem.first;
+
+			// The selection is done on a particle index, so remember the particle to select it again at its new index after the reordering.
+			const bool selectionOnThisSystem = _particleSelector.hasSelectedParticle() && _particleSelector.getSelectedParticleSystemId() == pSystemId;
+			const std::size_t selectedStableId = selectionOnThisSystem ? pSystem.getStableId(_particleSelector.getSelectedParticleIndex()) : 0;
+
+			_particleReorderer->computeMortonOrder(pSystem.getPositions(), this->getKernelLength(), newToOldIndexes);
+
+			pSystem.reorderParticles(newToOldIndexes);
+			_sphSolver->reorderParticleData(pSystemId, newToOldIndexes);
+
+			if (selectionOnThisSystem)
+			{
+				_particleSelector.setParticleSelection(pSystemId, pSystem.getParticleIndexFromStableId(selectedStableId));
+			}
+
+			hasReordered = true;
+		}
+	}
+
+	if (hasReordered)
+	{
+		_particleReorderer->onReorderingDone();
+		this->onFluidParticleIndexesChanged();
+	}
+}
+
+void Storm::SimulatorManager::updateOpenBoundaries(const float deltaTime)
+{
+	assert(Storm::isSimulationThread() && "This method should only be executed inside the simulation thread!");
+
+	for (auto &particleSystem : _particleSystem)
+	{
+		Storm::ParticleSystem &pSystem = *particleSystem.second;
+		if (pSystem.isFluids())
+		{
+			const unsigned int pSystemId = particleSystem.first;
+
+			// Same as the reordering, the selected particle is found again from its stable id. It is unselected if it was removed.
+			const bool selectionOnThisSystem = _particleSelector.hasSelectedParticle() && _particleSelector.getSelectedParticleSystemId() == pSystemId;
+			const std::size_t selectedStableId = selectionOnThisSystem ? pSystem.getStableId(_particleSelector.getSelectedParticleIndex()) : 0;
+
+			if (_openBoundaries->update(static_cast<Storm::FluidParticleSystem &>(pSystem), *_sphSolver, deltaTime))
+			{
+				if (selectionOnThisSystem)
+				{
+					const std::size_t selectedIndex = pSystem.getParticleIndexFromStableId(selectedStableId);
+					if (selectedIndex < pSystem.getParticleCount())
+					{
+						_particleSelector.setParticleSelection(pSystemId, selectedIndex);
+					}
+					else
+					{
+						_particleSelector.clearParticleSelection();
+					}
+				}
+
+				this->onFluidParticleIndexesChanged();
+			}
+
+			// There is only one fluid (the scene has only one fluid config), and the inflows shouldn't inject their layers twice.
+			break;
+		}
+	}
+}
+
+void Storm::SimulatorManager::onFluidParticleIndexesChanged()
+{
+	// The fluid partition references the particles by their index, the voxel each particle was in cannot be used to update it anymore.
+	Storm::SingletonHolder::instance().getSingleton<Storm::ISpacePartitionerManager>().invalidateSpaceReorderingUpdate(Storm::PartitionSelection::Fluid);
+
+	// Sleeping particles keep their former neighborhood, that could reference particles of a fluid whose indexes changed.
+	for (auto &particleSystem : _particleSystem)
+	{
+		if (particleSystem.second->isFluids())
+		{
+			static_cast<Storm::FluidParticleSystem &>(*particleSystem.second).wakeAllParticles();
+		}
+	}
+}
+
+bool Storm::SimulatorManager::shouldRebuildNeighborhoodCandidates(const Storm::SceneSimulationConfig &sceneSimulationConfig, const float kernelLength) const
+{
+	if (_neighborhoodRefreshCountSinceBuild >= sceneSimulationConfig._recomputeNeighborhoodStep || _neighborhoodBuildKernelLength != kernelLength)
+	{
+		return true;
+	}
+
+	const float searchLength = this->getNeighborhoodSearchLength();
+
+	for (const auto &particleSystem : _particleSystem)
+	{
+		const Storm::ParticleSystem &pSystem = *particleSystem.second;
+		if (!pSystem.hasNeighborhoodCandidates())
+		{
+			// Particles were added or removed since the last build.
+			return true;
+		}
+		else if (!pSystem.isStatic() && !Storm::VerletNeighborhood::areCandidatesValid(pSystem.computeMaxDisplacementSquaredSinceNeighborhoodBuild(), kernelLength, searchLength))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void Storm::SimulatorManager::profileNeighborhoodMemory(Storm::IProfilerManager &profilerMgr) const
+{
+	std::size_t neighborCount = 0;
+	std::size_t usedMemory = 0;
+	std::size_t perParticleArrayLayoutMemory = 0;
+
+	for (const auto &particleSystem : _particleSystem)
+	{
+		const Storm::ParticleSystem &pSystem = *particleSystem.second;
+
+		const Storm::ParticleNeighborhoodStorage &neighborhoods = pSystem.getNeighborhoodArrays();
+		neighborCount += neighborhoods.getNeighborCount();
+		usedMemory += neighborhoods.computeUsedMemory();
+		perParticleArrayLayoutMemory += neighborhoods.computePerParticleArrayLayoutMemory();
+
+		// The Verlet list candidates would have been stored the same way.
+		const Storm::ParticleNeighborhoodStorage &neighborhoodCandidates = pSystem.getNeighborhoodCandidates();
+		usedMemory += neighborhoodCandidates.computeUsedMemory();
+		perParticleArrayLayoutMemory += neighborhoodCandidates.computePerParticleArrayLayoutMemory();
 	}
+
+	profilerMgr.addNeighborhoodMemoryProfile(neighborCount, usedMemory, perParticleArrayLayoutMemory);
 }
 
 void Storm::SimulatorManager::onGraphicParticleSettingsChanged()
@@ -2247,8 +2524,8 @@ Storm::Vector3 Storm::SimulatorManager::interpolateVelocityAtPosition(const Stor
 {
 	Storm::Vector3 result = Storm::Vector3::Zero();
 
-	const std::vector<Storm::NeighborParticleReferral>* bundleContainingPtr;
-	const std::vector<Storm::NeighborParticleReferral>* outLinkedNeighborBundle[Storm::k_neighborLinkedBunkCount];
+	const Storm::NeighborParticleReferralBundle* bundleContainingPtr;
+	const Storm::NeighborParticleReferralBundle* outLinkedNeighborBundle[Storm::k_neighborLinkedBunkCount];
 
 	const auto &partitionerMgr = Storm::SingletonHolder::instance().getSingleton<Storm::ISpacePartitionerManager>();
 	const Storm::OutReflectedModality* reflectModality;
@@ -2396,6 +2673,19 @@ float Storm::SimulatorManager::getKernelLength() const
 	return _kernelHandler.getKernelValue();
 }
 
+float Storm::SimulatorManager::getNeighborhoodSearchLength() const
+{
+	const float kernelLength = this->getKernelLength();
+
+	const Storm::SceneSimulationConfig &sceneSimulationConfig = Storm::SingletonHolder::instance().getSingleton<Storm::IConfigManager>().getSceneSimulationConfig();
+	if (sceneSimulationConfig._recomputeNeighborhoodStep > 1)
+	{
+		return kernelLength * (1.f + sceneSimulationConfig._neighborhoodSkinCoeff);
+	}
+
+	return kernelLength;
+}
+
 void Storm::SimulatorManager::pushParticlesToGraphicModule(bool ignoreDirty) const
 {
 	assert(Storm::isSimulationThread() && "This method should only be executed inside the simulation thread!");
@@ -2594,10 +2884,20 @@ void Storm::SimulatorManager::beginRecord() const
 
 	const Storm::SingletonHolder &singletonHolder = Storm::SingletonHolder::instance();
 
-	const Storm::SceneRecordConfig &sceneRecordConfig = singletonHolder.getSingleton<Storm::IConfigManager>().getSceneRecordConfig();
+	const Storm::IConfigManager &configMgr = singletonHolder.getSingleton<Storm::IConfigManager>();
+	const Storm::SceneRecordConfig &sceneRecordConfig = configMgr.getSceneRecordConfig();
 
 	Storm::SerializeRecordHeader recordHeader;
 	recordHeader._recordFrameRate = sceneRecordConfig._recordFps;
+	recordHeader._keyFrameInterval = sceneRecordConfig._keyFrameInterval;
+	recordHeader._positionPrecision = sceneRecordConfig._positionPrecision;
+	recordHeader._recordedChannels = sceneRecordConfig._recordedChannels;
+
+	// The positions are quantized relative to the domain box.
+	if (const Storm::SceneCageConfig*const sceneCageConfig = configMgr.getSceneOptionalCageConfig())
+	{
+		recordHeader._positionQuantizationOrigin = sceneCageConfig->_boxMin;
+	}
 
 	recordHeader._particleSystemLayouts.reserve(_particleSystem.size());
 	for (const auto &particleSystemPair : _particleSystem)
@@ -2625,16 +2925,19 @@ void Storm::SimulatorManager::pushRecord(float currentPhysicsTime, bool pushStat
 
 	const Storm::SingletonHolder &singletonHolder = Storm::SingletonHolder::instance();
 
-	Storm::SerializeRecordPendingData currentFrameData;
-	currentFrameData._physicsTime = currentPhysicsTime;
-	currentFrameData._kernelLength = this->getKernelLength();
+	Storm::ISerializerManager &serializerMgr = singletonHolder.getSingleton<Storm::ISerializerManager>();
 
-	Storm::ReplaySolver::fillRecordFromSystems(pushStatics, _particleSystem, currentFrameData);
+	// Waits if the serializer is too late.
+	std::unique_ptr<Storm::SerializeRecordPendingData> currentFrameData = serializerMgr.acquireRecordFrame();
+	currentFrameData->_physicsTime = currentPhysicsTime;
+	currentFrameData->_kernelLength = this->getKernelLength();
+
+	const Storm::SceneRecordConfig &sceneRecordConfig = singletonHolder.getSingleton<Storm::IConfigManager>().getSceneRecordConfig();
+	Storm::ReplaySolver::fillRecordFromSystems(pushStatics, sceneRecordConfig._recordedChannels, _particleSystem, *currentFrameData);
 
 	const Storm::IPhysicsManager &physicsMgr = singletonHolder.getSingleton<Storm::IPhysicsManager>();
-	physicsMgr.getConstraintsRecordFrameData(currentFrameData._constraintElements);
+	physicsMgr.getConstraintsRecordFrameData(currentFrameData->_constraintElements);
 
-	Storm::ISerializerManager &serializerMgr = singletonHolder.getSingleton<Storm::ISerializerManager>();
 	serializerMgr.recordFrame(std::move(currentFrameData));
 }
 
@@ -2761,9 +3064,11 @@ void Storm::SimulatorManager::saveSimulationState() const
 	});
 }
 
-void Storm::SimulatorManager::refreshParticlePartition(bool ignoreStatics /*= true*/) const
+void Storm::SimulatorManager::refreshParticlePartition() const
 {
-	if (ignoreStatics)
+	// Static rigid bodies don't move : their partition is filled once then frozen. It is only rebuilt when the partitions were recreated (i.e. the partition length changed).
+	const Storm::ISpacePartitionerManager &spacePartitionerMgr = Storm::SingletonHolder::instance().getSingleton<Storm::ISpacePartitionerManager>();
+	if (spacePartitionerMgr.isStaticPartitionFrozen())
 	{
 		this->refreshSpecificParticlePartition<true, true, false>();
 	}
@@ -2781,17 +3086,38 @@ void Storm::SimulatorManager::refreshSpecificParticlePartition() const
 	const Storm::SingletonHolder &singletonHolder = Storm::SingletonHolder::instance();
 	Storm::ISpacePartitionerManager &spacePartitionerMgr = singletonHolder.getSingleton<Storm::ISpacePartitionerManager>();
 
-	if constexpr (fluid && dynamic)
+	// When most particles stay inside their voxel, patching the few voxels particles moved from/to is cheaper than rebuilding the whole partition.
+	bool fluidPartitionUpdated = false;
+	bool dynamicPartitionUpdated = false;
+
+	const float incrementalPartitionThreshold = singletonHolder.getSingleton<Storm::IConfigManager>().getSceneSimulationConfig()._incrementalPartitionThreshold;
+	if (incrementalPartitionThreshold > 0.f)
 	{
-		spacePartitionerMgr.clearSpaceReorderingNoStatic();
+		if constexpr (fluid)
+		{
+			fluidPartitionUpdated = this->updateParticlePartitionIncrementally(spacePartitionerMgr, Storm::PartitionSelection::Fluid, incrementalPartitionThreshold);
+		}
+
+		if constexpr (dynamic)
+		{
+			dynamicPartitionUpdated = this->updateParticlePartitionIncrementally(spacePartitionerMgr, Storm::PartitionSelection::DynamicRigidBody, incrementalPartitionThreshold);
+		}
 	}
-	else if constexpr (fluid)
+
+	if constexpr (fluid)
 	{
-		spacePartitionerMgr.clearSpaceReorderingForPartition(Storm::PartitionSelection::Fluid);
+		if (!fluidPartitionUpdated)
+		{
+			spacePartitionerMgr.clearSpaceReorderingForPartition(Storm::PartitionSelection::Fluid);
+		}
 	}
-	else if constexpr (dynamic)
+
+	if constexpr (dynamic)
 	{
-		spacePartitionerMgr.clearSpaceReorderingForPartition(Storm::PartitionSelection::DynamicRigidBody);
+		if (!dynamicPartitionUpdated)
+		{
+			spacePartitionerMgr.clearSpaceReorderingForPartition(Storm::PartitionSelection::DynamicRigidBody);
+		}
 	}
 
 	if constexpr (statics)
@@ -2808,7 +3134,10 @@ void Storm::SimulatorManager::refreshSpecificParticlePartition() const
 		{
 			if (isFluid)
 			{
-				spacePartitionerMgr.computeSpaceReordering(pSystem.getPositions(), Storm::PartitionSelection::Fluid, pSystem.getId());
+				if (!fluidPartitionUpdated)
+				{
+					spacePartitionerMgr.computeSpaceReordering(pSystem.getPositions(), Storm::PartitionSelection::Fluid, pSystem.getId());
+				}
 				continue;
 			}
 		}
@@ -2823,7 +3152,10 @@ void Storm::SimulatorManager::refreshSpecificParticlePartition() const
 				{
 					if (!isStatic)
 					{
-						spacePartitionerMgr.computeSpaceReordering(pSystem.getPositions(), Storm::PartitionSelection::DynamicRigidBody, pSystem.getId());
+						if (!dynamicPartitionUpdated)
+						{
+							spacePartitionerMgr.computeSpaceReordering(pSystem.getPositions(), Storm::PartitionSelection::DynamicRigidBody, pSystem.getId());
+						}
 						continue;
 					}
 				}
@@ -2839,6 +3171,43 @@ void Storm::SimulatorManager::refreshSpecificParticlePartition() const
 			}
 		}
 	}
+
+	// Only now that all systems are registered, the partitions can be made ready to be queried.
+	if constexpr (fluid)
+	{
+		spacePartitionerMgr.finishSpaceReordering(Storm::PartitionSelection::Fluid);
+	}
+
+	if constexpr (dynamic)
+	{
+		spacePartitionerMgr.finishSpaceReordering(Storm::PartitionSelection::DynamicRigidBody);
+	}
+
+	if constexpr (statics)
+	{
+		spacePartitionerMgr.finishSpaceReordering(Storm::PartitionSelection::StaticRigidBody);
+		spacePartitionerMgr.freezeStaticPartition();
+	}
+}
+
+bool Storm::SimulatorManager::updateParticlePartitionIncrementally(Storm::ISpacePartitionerManager &spacePartitionerMgr, const Storm::PartitionSelection modality, const float maxMovedParticleRatio) const
+{
+	const bool forFluids = modality == Storm::PartitionSelection::Fluid;
+
+	for (const auto &particleSystem : _particleSystem)
+	{
+		const Storm::ParticleSystem &pSystem = *particleSystem.second;
+		if (pSystem.isFluids() == forFluids && !pSystem.isStatic())
+		{
+			// On failure, the partition will be cleared anyway, which also drops what was prepared.
+			if (!spacePartitionerMgr.prepareSpaceReorderingUpdate(pSystem.getPositions(), modality, pSystem.getId()))
+			{
+				return false;
+			}
+		}
+	}
+
+	return spacePartitionerMgr.applySpaceReorderingUpdate(modality, maxMovedParticleRatio);
 }
 
 Storm::ParticleSystem& Storm::SimulatorManager::getParticleSystem(unsigned int id)
@@ -3186,7 +3555,7 @@ void Storm::SimulatorManager::writeParticleNeighborhood(const unsigned int id, c
 				filePathSystem.replace_extension();
 
 				const Storm::Vector3 &currentPPosition = pSystem.getPositions()[pIndex];
-				const Storm::ParticleNeighborhoodArray &currentPNeighborhood = pSystem.getNeighborhoodArrays()[pIndex];
+				const Storm::ParticleNeighborhoodArray currentPNeighborhood = pSystem.getNeighborhoodArrays()[pIndex];
 				const std::size_t neighborCount = currentPNeighborhood.size();
 
 				std::vector<std::size_t> toSkip;
@@ -3245,7 +3614,7 @@ void Storm::SimulatorManager::writeParticleNeighborhood(const unsigned int id, c
 				std::string toLog;
 
 				const Storm::Vector3 &currentPPosition = pSystem.getPositions()[pIndex];
-				const Storm::ParticleNeighborhoodArray &currentPNeighborhood = pSystem.getNeighborhoodArrays()[pIndex];
+				const Storm::ParticleNeighborhoodArray currentPNeighborhood = pSystem.getNeighborhoodArrays()[pIndex];
 
 				const std::size_t neighborCount = currentPNeighborhood.size();
 
@@ -3584,7 +3953,7 @@ void Storm::SimulatorManager::forceRefreshParticleNeighborhood(const unsigned in
 		{
 			// Since this method is called from callbacks, then it is after a loop iteration was done, therefore the cage would move particles but the space partitioner wouldn't have refreshed its data yet (would do after the callbacks when the simulation loop iteration truly starts).
 			// Therefore, refresh it now to be kept up to date with last iteration particle moves.
-			this->refreshParticlePartition(!containingPSystem->isStatic());
+			this->refreshParticlePartition();
 
 			containingPSystem->buildSpecificParticleNeighborhood(_particleSystem, particleIndex);
 		}
@@ -3657,7 +4026,14 @@ void Storm::SimulatorManager::selectSpecificParticle(const unsigned pSystemId, c
 	const Storm::SingletonHolder &singletonHolder = Storm::SingletonHolder::instance();
 	singletonHolder.getSingleton<Storm::IThreadManager>().executeOnThread(Storm::ThreadEnumeration::MainThread, [this, pSystemId, particleIndex, &singletonHolder]()
 	{
-		if (this->selectSpecificParticle_Internal(pSystemId, particleIndex))
+		// Scripts refer to particles with their stable id (the index they had before any reordering).
+		std::size_t currentPIndex = particleIndex;
+		if (const auto found = _particleSystem.find(pSystemId); found != std::end(_particleSystem))
+		{
+			currentPIndex = found->second->getParticleIndexFromStableId(particleIndex);
+		}
+
+		if (this->selectSpecificParticle_Internal(pSystemId, currentPIndex))
 		{
 			const Storm::ITimeManager &timeMgr = singletonHolder.getSingleton<Storm::ITimeManager>();
 			if (timeMgr.simulationIsPaused())
@@ -3754,18 +4130,13 @@ void Storm::SimulatorManager::refreshReplayNeighborhood()
 		Storm::ISpacePartitionerManager &spacePartitionerMgr = singletonHolder.getSingleton<Storm::ISpacePartitionerManager>();
 
 		// Recreate the partition (if needed)
-		spacePartitionerMgr.setPartitionLength(this->getKernelLength());
-
-		// Fill Neighborhood for current frame
-		this->refreshParticlePartition(false);
+		spacePartitionerMgr.setPartitionLength(this->getNeighborhoodSearchLength());
 
 		_replayNeedNeighborhoodRefresh = false;
 	}
-	else
-	{
-		// Fill Neighborhood for current frame
-		this->refreshParticlePartition(true);
-	}
+
+	// Fill Neighborhood for current frame (the static partition is refilled only if it was recreated).
+	this->refreshParticlePartition();
 
 	// Build particle system neighborhoods
 	for (auto &particleSystem : _particleSystem)
@@ -3820,13 +4191,6 @@ void Storm::SimulatorManager::seekReplay(const float seekPhysicsTimeSec)
 			Storm::SerializeRecordPendingData &frameBefore = *_frameBefore;
 			Storm::SerializeRecordPendingData &frameAfter = *_frameAfter;
 
-			// We need to go back in time
-			if (seekPhysicsTimeSec <= frameBefore._physicsTime)
-			{
-				this->resetReplay_SimulationThread(false);
-				frameAfter = frameBefore;
-			}
-
 			std::vector<Storm::SerializeRecordContraintsData> recordedConstraintsData;
 			float currentKernelValue;
 
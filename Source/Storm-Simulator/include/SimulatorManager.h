@@ -21,13 +21,18 @@ namespace Storm
 	class ISPHBaseSolver;
 	class UIFieldContainer;
 	class Cage;
+	class OpenBoundaries;
 	class MassCoeffHandler;
+	class ParticleReorderer;
+	class ISpacePartitionerManager;
+	class IProfilerManager;
 	struct SceneSimulationConfig;
 	struct SerializeRecordPendingData;
 	struct SerializeSupportedFeatureLayout;
 	enum class RaycastEnablingFlag : uint8_t;
 	enum class SimulationSystemsState : uint8_t;
 	enum class CustomForceSelect : uint8_t;
+	enum class PartitionSelection;
 
 	class SimulatorManager final :
 		private Storm::Singleton<Storm::SimulatorManager, Storm::DefineDefaultCleanupImplementationOnly>,
@@ -79,6 +84,18 @@ namespace Storm
 		void refreshParticlesPosition() final override;
 		void refreshParticleNeighborhood();
 
+	private:
+		void reorderParticlesIfNeeded();
+		void updateOpenBoundaries(const float deltaTime);
+
+		// To be called when the fluid particle indexes changed (reordering, open boundaries, ...).
+		void onFluidParticleIndexesChanged();
+
+		bool shouldRebuildNeighborhoodCandidates(const Storm::SceneSimulationConfig &sceneSimulationConfig, const float kernelLength) const;
+
+		void profileNeighborhoodMemory(Storm::IProfilerManager &profilerMgr) const;
+
+	public:
 		void onGraphicParticleSettingsChanged() final override;
 
 	public:
@@ -119,6 +136,9 @@ namespace Storm
 	public:
 		float getKernelLength() const final override;
 
+		// The length used to search neighbors (and therefore to partition the space). This is the kernel length, enlarged by the skin when we're using a Verlet list (neighborCheckStep > 1).
+		float getNeighborhoodSearchLength() const;
+
 	private:
 		void pushParticlesToGraphicModule(bool ignoreDirty) const;
 		
@@ -154,8 +174,9 @@ namespace Storm
 		void saveSimulationState() const final override;
 
 	private:
-		void refreshParticlePartition(bool ignoreStatics = true) const;
+		void refreshParticlePartition() const;
 		template<bool fluid, bool dynamic, bool statics> void refreshSpecificParticlePartition() const;
+		bool updateParticlePartitionIncrementally(Storm::ISpacePartitionerManager &spacePartitionerMgr, const Storm::PartitionSelection modality, const float maxMovedParticleRatio) const;
 
 	public:
 		// Not from interface because they are intended to be used within simulation only (non thread safe)!
@@ -219,9 +240,16 @@ namespace Storm
 
 		std::unique_ptr<Storm::Cage> _cage;
 
+		std::unique_ptr<Storm::OpenBoundaries> _openBoundaries;
+
+		std::unique_ptr<Storm::ParticleReorderer> _particleReorderer;
+
 		Storm::SimulationSystemsState _currentSimulationSystemsState;
 		float _maxVelocitySquaredLastStateCheck;
-		std::vector<float> _tmp; // Temporary buffer for any work
+
+		// Verlet list neighborhood (only used when neighborCheckStep > 1)
+		unsigned int _neighborhoodRefreshCountSinceBuild;
+		float _neighborhoodBuildKernelLength;
 
 		Storm::ExitCode _runExitCode;
 
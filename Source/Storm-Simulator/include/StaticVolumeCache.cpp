@@ -0,0 +1,142 @@
+#include "StaticVolumeCache.h"
+
+#include "Version.h"
+#include "MemoryHelper.h"
+
+#include <fstream>
+
+
+namespace
+{
+	enum : uint64_t
+	{
+		// Like the rigid body particle cache, the placeholder is written first and only replaced by the good checksum once the file is complete.
+		k_staticVolumeCachePlaceholderChecksum = 0x00AA00CC,
+		k_staticVolumeCacheGoodChecksum = 0xABCDEF72,
+	};
+
+	// FNV-1a.
+	uint64_t hashStaticVolumeCacheKey(uint64_t hash, const void* data, const std::size_t byteCount)
+	{
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		for (std::size_t iter = 0; iter < byteCount; ++iter)
+		{
+			hash ^= bytes[iter];
+			hash *= 0x100000001B3ull;
+		}
+
+		return hash;
+	}
+}
+
+
+Storm::StaticVolumeCache::StaticVolumeCache(const Storm::KernelMode kernelMode, const float kernelLength, const bool infiniteDomain, const Storm::Vector3 &domainDimension) :
+	_key{ 0xCBF29CE484222325ull }
+{
+	_key = hashStaticVolumeCacheKey(_key, &kernelMode, sizeof(kernelMode));
+	_key = hashStaticVolumeCacheKey(_key, &kernelLength, sizeof(kernelLength));
+	_key = hashStaticVolumeCacheKey(_key, &infiniteDomain, sizeof(infiniteDomain));
+	_key = hashStaticVolumeCacheKey(_key, domainDimension.data(), sizeof(Storm::Vector3::Scalar) * 3);
+}
+
+void Storm::StaticVolumeCache::addStaticParticleSystem(const unsigned int pSystemId, const std::vector<Storm::Vector3> &positions)
+{
+	_key = hashStaticVolumeCacheKey(_key, &pSystemId, sizeof(pSystemId));
+
+	for (const Storm::Vector3 &position : positions)
+	{
+		_key = hashStaticVolumeCacheKey(_key, position.data(), sizeof(Storm::Vector3::Scalar) * 3);
+	}
+}
+
+uint64_t Storm::StaticVolumeCache::getKey() const noexcept
+{
+	return _key;
+}
+
+bool Storm::StaticVolumeCache::read(const std::filesystem::path &cachePath, std::vector<float> &outStaticVolumesInitValue)
+{
+	if (!std::filesystem::exists(cachePath))
+	{
+		return false;
+	}
+
+	std::ifstream cacheReadStream{ cachePath.wstring(), std::ios_base::in | std::ios_base::binary };
+
+	uint64_t checksum;
+	Storm::binaryRead(cacheReadStream, checksum);
+	if (!cacheReadStream || checksum != k_staticVolumeCacheGoodChecksum)
+	{
+		LOG_WARNING << "'" << cachePath << "' static volumes cache is corrupted (invalid), therefore we will compute the volumes anew.";
+		return false;
+	}
+
+	std::string versionTmp;
+	Storm::binaryRead(cacheReadStream, versionTmp);
+	if (versionTmp != static_cast<std::string>(Storm::Version::retrieveCurrentStormVersion()))
+	{
+		LOG_WARNING << "'" << cachePath << "' static volumes cache was made with another version of the application, therefore we will compute the volumes anew.";
+		return false;
+	}
+
+	uint64_t particleCount;
+	Storm::binaryRead(cacheReadStream, particleCount);
+	if (particleCount != static_cast<uint64_t>(outStaticVolumesInitValue.size()))
+	{
+		LOG_WARNING << "'" << cachePath << "' static volumes cache doesn't have the right particle count (" << particleCount << " instead of " << outStaticVolumesInitValue.size() << "), therefore we will compute the volumes anew.";
+		return false;
+	}
+
+	cacheReadStream.read(reinterpret_cast<char*>(outStaticVolumesInitValue.data()), outStaticVolumesInitValue.size() * sizeof(float));
+	if (!cacheReadStream)
+	{
+		LOG_WARNING << "'" << cachePath << "' static volumes cache is truncated, therefore we will compute the volumes anew.";
+		return false;
+	}
+
+	LOG_COMMENT << "Static volumes loaded from the cache '" << cachePath << "'.";
+	return true;
+}
+
+bool Storm::StaticVolumeCache::write(const std::filesystem::path &cachePath, const std::vector<float> &staticVolumesInitValue)
+{
+	std::error_code errorCode;
+	std::filesystem::create_directories(cachePath.parent_path(), errorCode);
+
+	bool succeeded;
+
+	{
+		std::ofstream cacheFileStream{ cachePath.wstring(), std::ios_base::out | std::ios_base::binary };
+
+		Storm::binaryWrite(cacheFileStream, static_cast<uint64_t>(k_staticVolumeCachePlaceholderChecksum));
+		Storm::binaryWrite(cacheFileStream, static_cast<std::string>(Storm::Version::retrieveCurrentStormVersion()));
+		Storm::binaryWrite(cacheFileStream, static_cast<uint64_t>(staticVolumesInitValue.size()));
+		cacheFileStream.write(reinterpret_cast<const char*>(staticVolumesInitValue.data()), staticVolumesInitValue.size() * sizeof(float));
+
+		// Don't finalize a cache whose payload wasn't entirely written (the disk could be full)...
+		succeeded = cacheFileStream.good();
+		if (succeeded)
+		{
+			// Replace the placeholder checksum by the right one to finalize the writing
+			cacheFileStream.seekp(0);
+			Storm::binaryWrite(cacheFileStream, static_cast<uint64_t>(k_staticVolumeCacheGoodChecksum));
+
+			// ... and check that everything reached the file.
+			cacheFileStream.flush();
+			succeeded = cacheFileStream.good();
+		}
+	}
+
+	if (!succeeded)
+	{
+		LOG_WARNING << "'" << cachePath << "' static volumes cache couldn't be written, therefore the volumes will be computed anew next time.";
+
+		// Don't leave an incomplete cache behind (but don't remove what we couldn't open as a file, like a folder).
+		if (std::filesystem::is_regular_file(cachePath, errorCode))
+		{
+			std::filesystem::remove(cachePath, errorCode);
+		}
+	}
+
+	return succeeded;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+
+namespace Storm
+{
+	enum class KernelMode;
+
+	// The static rigid body volumes only depend on the static particle positions (so on the meshes, their sampling settings and their transforms), the kernel and the domain.
+	// Therefore, they're computed once then saved in a file named after a key computed from all of this.
+	class StaticVolumeCache
+	{
+	public:
+		StaticVolumeCache(const Storm::KernelMode kernelMode, const float kernelLength, const bool infiniteDomain, const Storm::Vector3 &domainDimension);
+
+	public:
+		// The neighborhood of a static particle includes the particles of the other static rigid bodies, so all of them should be added to the key (in the same order each time).
+		void addStaticParticleSystem(const unsigned int pSystemId, const std::vector<Storm::Vector3> &positions);
+
+		uint64_t getKey() const noexcept;
+
+	public:
+		// Returns false if the cache doesn't exist, or cannot be used (corrupted, made with another version, or for another particle count). outStaticVolumesInitValue should already be sized to the particle count.
+		static bool read(const std::filesystem::path &cachePath, std::vector<float> &outStaticVolumesInitValue);
+
+		// Returns false if the cache couldn't be written. The incomplete file is removed in this case.
+		static bool write(const std::filesystem::path &cachePath, const std::vector<float> &staticVolumesInitValue);
+
+	private:
+		uint64_t _key;
+	};
+}
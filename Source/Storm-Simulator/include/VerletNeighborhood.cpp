@@ -0,0 +1,23 @@
+#include "VerletNeighborhood.h"
+
+
+bool Storm::VerletNeighborhood::areCandidatesValid(const float maxDisplacementSquared, const float kernelLength, const float searchLength)
+{
+	const float halfSkin = (searchLength - kernelLength) * 0.5f;
+	return maxDisplacementSquared <= halfSkin * halfSkin;
+}
+
+float Storm::VerletNeighborhood::computeMaxDisplacementSquared(const std::vector<Storm::Vector3> &positions, const std::vector<Storm::Vector3> &positionsAtBuild)
+{
+	assert(positions.size() == positionsAtBuild.size() && "Positions at the last neighborhood build should have the same particle count than the current positions!");
+
+	return std::transform_reduce(std::execution::par, std::begin(positions), std::end(positions), std::begin(positionsAtBuild), 0.f,
+		[](const float left, const float right)
+	{
+		return std::max(left, right);
+	},
+		[](const Storm::Vector3 &currentPosition, const Storm::Vector3 &positionAtBuild)
+	{
+		return (currentPosition - positionAtBuild).squaredNorm();
+	});
+}
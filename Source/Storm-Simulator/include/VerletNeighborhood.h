@@ -0,0 +1,37 @@
+#pragma once
+
+#include "ParticleSystem.h"
+
+
+namespace Storm
+{
+	// The Verlet list rules (used when neighborCheckStep > 1, see Storm::SimulatorManager::refreshParticleNeighborhood).
+	// The neighbors are searched with the kernel length enlarged by a skin and kept as candidates, then the next neighborhoods are only filtered from those candidates as long as they're valid.
+	class VerletNeighborhood
+	{
+	public:
+		// The candidates contain all particles that were nearer than the search length (the kernel length + the skin). Two particles cannot come nearer than the skin length from each other
+		// while both moved less than half the skin. Therefore, the candidates remain valid as long as no particle has moved more than half the skin since they were searched.
+		static bool areCandidatesValid(const float maxDisplacementSquared, const float kernelLength, const float searchLength);
+
+		static float computeMaxDisplacementSquared(const std::vector<Storm::Vector3> &positions, const std::vector<Storm::Vector3> &positionsAtBuild);
+
+		// Appends the candidates of a particle that are inside the kernel support to outNeighborhood, without their kernel values.
+		// The candidates xij are the ones of when they were searched. xij = xi - xj, therefore the current xij is this one corrected by the displacement of both particles since then
+		// (currentPDisplacement for the particle, candidateDisplacementFunc(const Storm::NeighborParticleInfo &candidate) for the candidate).
+		// This way, we don't need to know if the candidate was reflected (infinite domain) since the reflection offset is already inside the xij of the candidate.
+		template<class CandidateDisplacementFunc>
+		static void filterCandidates(const Storm::ParticleNeighborhoodArray &candidates, const Storm::Vector3 &currentPDisplacement, const float kernelLengthSquared, const CandidateDisplacementFunc &candidateDisplacementFunc, Storm::ParticleNeighborhoodBuildArray &outNeighborhood)
+		{
+			for (const Storm::NeighborParticleInfo &candidate : candidates)
+			{
+				const Storm::Vector3 xij = candidate._xij + currentPDisplacement - candidateDisplacementFunc(candidate);
+				const float normSquared = xij.squaredNorm();
+				if (Storm::ParticleSystem::isElligibleNeighborParticle(kernelLengthSquared, normSquared))
+				{
+					outNeighborhood.emplace_back(candidate._containingParticleSystem, candidate._particleIndex, xij, normSquared, candidate._isFluidParticle, candidate._notReflected);
+				}
+			}
+		}
+	};
+}
@@ -30,7 +30,7 @@ namespace
 	};
 	
 	template<Storm::ViscosityMethod viscosityMethodOnFluid, Storm::ViscosityMethod viscosityMethodOnRigidBody, DragComputeMode dragComputeMode>
-	void computeAll(const Storm::IterationParameter &iterationParameter, const Storm::SceneFluidConfig &fluidConfig, const float density0, const float currentPMass, const Storm::Vector3 &vi, const Storm::ParticleNeighborhoodArray &currentPNeighborhood, const float currentPDensity, const float currentPPressure, const float viscoPrecoeff, Storm::Vector3 &outTotalPressureForceOnParticle, Storm::Vector3 &outTotalViscosityForceOnParticle, Storm::Vector3 &outTotalDragForceOnParticle)
+	void computeAll(const Storm::IterationParameter &iterationParameter, const Storm::SceneFluidConfig &fluidConfig, const float density0, const float currentPMass, const Storm::Vector3 &vi, const Storm::ParticleNeighborhoodArray &currentPNeighborhood, const float currentPDensity, const float currentPPressure, const float viscoPrecoeff, Storm::Vector3 &outTotalPressureForceOnParticle, Storm::Vector3 &outTotalViscosityForceOnParticle, Storm::Vector3 &outTotalDragForceOnParticle, Storm::RigidBodyReactionAccumulator::Chunk &rbReactions)
 	{
 		outTotalPressureForceOnParticle = Storm::Vector3::Zero();
 		outTotalViscosityForceOnParticle = Storm::Vector3::Zero();
@@ -147,16 +147,15 @@ namespace
 						dragComponent
 						;
 
-					std::lock_guard<std::mutex> lock{ neighbor._containingParticleSystem->_mutex };
-					boundaryNeighborForce -= sumForces;
+					rbReactions.subtract(boundaryNeighborForce, sumForces);
 #if STORM_ENABLE_PRESSURE_FORCE_ON_RB
-					boundaryNeighborTmpPressureForce -= pressureComponent;
+					rbReactions.subtract(boundaryNeighborTmpPressureForce, pressureComponent);
 #endif
-					boundaryNeighborTmpViscosityForce -= viscosityComponent;
+					rbReactions.subtract(boundaryNeighborTmpViscosityForce, viscosityComponent);
 
 					if constexpr (dragComputeMode != DragComputeMode::NoCompute)
 					{
-						boundaryNeighborTmpDragForce -= dragComponent;
+						rbReactions.subtract(boundaryNeighborTmpDragForce, dragComponent);
 					}
 				}
 			}
@@ -200,7 +199,7 @@ void Storm::WCSPHSolver::execute(const Storm::IterationParameter &iterationParam
 
 			const float particleVolume = fluidParticleSystem.getParticleVolume();
 			const float density0 = fluidParticleSystem.getRestDensity();
-			const std::vector<Storm::ParticleNeighborhoodArray> &neighborhoodArrays = fluidParticleSystem.getNeighborhoodArrays();
+			const Storm::ParticleNeighborhoodStorage &neighborhoodArrays = fluidParticleSystem.getNeighborhoodArrays();
 			std::vector<float> &pressures = fluidParticleSystem.getPressures();
 
 			Storm::runParallel(fluidParticleSystem.getDensities(), [&](float &currentPDensity, const std::size_t currentPIndex)
@@ -208,7 +207,7 @@ void Storm::WCSPHSolver::execute(const Storm::IterationParameter &iterationParam
 				// Density
 				currentPDensity = particleVolume * k_kernelZero;
 
-				const Storm::ParticleNeighborhoodArray &currentPNeighborhood = neighborhoodArrays[currentPIndex];
+				const Storm::ParticleNeighborhoodArray currentPNeighborhood = neighborhoodArrays[currentPIndex];
 				for (const Storm::NeighborParticleInfo &neighbor : currentPNeighborhood)
 				{
 					float deltaDensity;
@@ -258,7 +257,7 @@ void Storm::WCSPHSolver::execute(const Storm::IterationParameter &iterationParam
 		{
 			Storm::FluidParticleSystem &fluidParticleSystem = static_cast<Storm::FluidParticleSystem &>(currentParticleSystem);
 			
-			const std::vector<Storm::ParticleNeighborhoodArray> &neighborhoodArrays = currentParticleSystem.getNeighborhoodArrays();
+			const Storm::ParticleNeighborhoodStorage &neighborhoodArrays = currentParticleSystem.getNeighborhoodArrays();
 			std::vector<float> &masses = fluidParticleSystem.getMasses();
 			const std::vector<float> &densities = fluidParticleSystem.getDensities();
 			const std::vector<float> &pressures = fluidParticleSystem.getPressures();
@@ -267,7 +266,7 @@ void Storm::WCSPHSolver::execute(const Storm::IterationParameter &iterationParam
 			std::vector<Storm::Vector3> &temporaryPViscoForce = fluidParticleSystem.getTemporaryViscosityForces();
 			std::vector<Storm::Vector3> &temporaryPDragForce = fluidParticleSystem.getTemporaryDragForces();
 
-			Storm::runParallel(fluidParticleSystem.getForces(), [&](Storm::Vector3 &currentPForce, const std::size_t currentPIndex)
+			_rbReactionAccumulator.runParallel(fluidParticleSystem.getForces(), [&](Storm::Vector3 &currentPForce, const std::size_t currentPIndex, Storm::RigidBodyReactionAccumulator::Chunk &rbReactions)
 			{
 				Storm::Vector3 &currentPTmpPressureForce = temporaryPPressureForce[currentPIndex];
 				Storm::Vector3 &currentPTmpViscoForce = temporaryPViscoForce[currentPIndex];
@@ -276,15 +275,15 @@ void Storm::WCSPHSolver::execute(const Storm::IterationParameter &iterationParam
 #define STORM_COMPUTE_ALL(fluidMethod, rbMethod)	\
 	if (!sceneSimulationConfig._applyDragEffect)	\
 	{												\
-		computeAll<fluidMethod, rbMethod, DragComputeMode::NoCompute>(iterationParameter, fluidConfig, fluidParticleSystem.getRestDensity(), masses[currentPIndex], velocities[currentPIndex], neighborhoodArrays[currentPIndex], densities[currentPIndex], pressures[currentPIndex], k_kernelLengthSquared00_1, currentPTmpPressureForce, currentPTmpViscoForce, currentPTmpDragForce);					  \
+		computeAll<fluidMethod, rbMethod, DragComputeMode::NoCompute>(iterationParameter, fluidConfig, fluidParticleSystem.getRestDensity(), masses[currentPIndex], velocities[currentPIndex], neighborhoodArrays[currentPIndex], densities[currentPIndex], pressures[currentPIndex], k_kernelLengthSquared00_1, currentPTmpPressureForce, currentPTmpViscoForce, currentPTmpDragForce, rbReactions);					  \
 	}												\
 	else if (fluidConfig._uniformDragCoefficient > 0.f)		\
 	{												\
-		computeAll<fluidMethod, rbMethod, DragComputeMode::ForAll>(iterationParameter, fluidConfig, fluidParticleSystem.getRestDensity(), masses[currentPIndex], velocities[currentPIndex], neighborhoodArrays[currentPIndex], densities[currentPIndex], pressures[currentPIndex], k_kernelLengthSquared00_1, currentPTmpPressureForce, currentPTmpViscoForce, currentPTmpDragForce);					  \
+		computeAll<fluidMethod, rbMethod, DragComputeMode::ForAll>(iterationParameter, fluidConfig, fluidParticleSystem.getRestDensity(), masses[currentPIndex], velocities[currentPIndex], neighborhoodArrays[currentPIndex], densities[currentPIndex], pressures[currentPIndex], k_kernelLengthSquared00_1, currentPTmpPressureForce, currentPTmpViscoForce, currentPTmpDragForce, rbReactions);					  \
 	}												\
 	else											\
 	{												\
-		computeAll<fluidMethod, rbMethod, DragComputeMode::RbOnly>(iterationParameter, fluidConfig, fluidParticleSystem.getRestDensity(), masses[currentPIndex], velocities[currentPIndex], neighborhoodArrays[currentPIndex], densities[currentPIndex], pressures[currentPIndex], k_kernelLengthSquared00_1, currentPTmpPressureForce, currentPTmpViscoForce, currentPTmpDragForce);					  \
+		computeAll<fluidMethod, rbMethod, DragComputeMode::RbOnly>(iterationParameter, fluidConfig, fluidParticleSystem.getRestDensity(), masses[currentPIndex], velocities[currentPIndex], neighborhoodArrays[currentPIndex], densities[currentPIndex], pressures[currentPIndex], k_kernelLengthSquared00_1, currentPTmpPressureForce, currentPTmpViscoForce, currentPTmpDragForce, rbReactions);					  \
 	}
 
 
@@ -340,7 +339,6 @@ void Storm::WCSPHSolver::execute(const Storm::IterationParameter &iterationParam
 	simulMgr.flushPhysics(iterationParameter._deltaTime);
 
 	// 5th : update fluid positions (Euler integration)
-	std::atomic<bool> dirtyTmp;
 	for (auto &particleSystemPair : particleSystems)
 	{
 		Storm::ParticleSystem &currentPSystem = *particleSystemPair.second;
@@ -352,10 +350,9 @@ void Storm::WCSPHSolver::execute(const Storm::IterationParameter &iterationParam
 			std::vector<Storm::Vector3> &positions = currentPSystemAsFluid.getPositions();
 			const std::vector<Storm::Vector3> &force = currentPSystemAsFluid.getForces();
 
-			dirtyTmp = false;
 			constexpr const float minForceDirtyEpsilon = 0.0001f;
 
-			Storm::runParallel(force, [&](const Storm::Vector3 &currentPForce, const std::size_t currentPIndex) 
+			const Storm::ParallelReduceResult integrationResult = Storm::reduceChunkedParallel(force, [&](const Storm::Vector3 &currentPForce, const std::size_t currentPIndex, Storm::ParallelReduceResult &chunkResult)
 			{
 				const float &currentPMass = masses[currentPIndex];
 				Storm::Vector3 &currentPVelocity = velocities[currentPIndex];
@@ -365,7 +362,7 @@ void Storm::WCSPHSolver::execute(const Storm::IterationParameter &iterationParam
 				currentPVelocity += currentPForce * forceToVelocityCoeff;
 				currentPPositions += currentPVelocity * iterationParameter._deltaTime;
 
-				if (!dirtyTmp)
+				if (!chunkResult._flag)
 				{
 					if (
 						std::fabs(currentPForce.x()) > minForceDirtyEpsilon ||
@@ -373,12 +370,12 @@ void Storm::WCSPHSolver::execute(const Storm::IterationParameter &iterationParam
 						std::fabs(currentPForce.z()) > minForceDirtyEpsilon
 						)
 					{
-						dirtyTmp = true;
+						chunkResult._flag = true;
 					}
 				}
 			});
 
-			currentPSystemAsFluid.setIsDirty(dirtyTmp);
+			currentPSystemAsFluid.setIsDirty(integrationResult._flag);
 		}
 	}
 }
@@ -387,3 +384,18 @@ void Storm::WCSPHSolver::removeRawEndData(const unsigned int /*pSystemId*/, std:
 {
 
 }
+
+void Storm::WCSPHSolver::reorderParticleData(const unsigned int /*pSystemId*/, const std::vector<std::size_t> &/*newToOldIndexes*/)
+{
+
+}
+
+void Storm::WCSPHSolver::compactParticleData(const unsigned int /*pSystemId*/, const Storm::ParticleCompaction &/*compaction*/)
+{
+
+}
+
+void Storm::WCSPHSolver::appendRawEndData(const unsigned int /*pSystemId*/, std::size_t /*toAddCount*/)
+{
+
+}
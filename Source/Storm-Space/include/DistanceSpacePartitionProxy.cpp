@@ -129,6 +129,12 @@ std::vector<Storm::Vector3> Storm::DistanceSpacePartitionProxy::getCompleteData(
 	return result;
 }
 
+const std::vector<Storm::Vector3>* Storm::DistanceSpacePartitionProxy::getBundleAt(const std::size_t voxelIndex, const std::size_t /*bundleSlot*/) const
+{
+	// Our voxels own their data, so we can refer to them directly.
+	return &_voxels[voxelIndex].getData();
+}
+
 std::size_t Storm::DistanceSpacePartitionProxy::size() const
 {
 	return _gridBoundary.x() * _gridBoundary.y() * _gridBoundary.z();
@@ -24,6 +24,7 @@ namespace Storm
 
 	public:
 		__forceinline const std::vector<Storm::PositionVoxel>& getVoxels() const noexcept { return _voxels; }
+		const std::vector<Storm::Vector3>* getBundleAt(const std::size_t voxelIndex, const std::size_t bundleSlot) const;
 		__forceinline const Storm::Vector3ui& getGridBoundary() const noexcept { return _gridBoundary; }
 
 	public:
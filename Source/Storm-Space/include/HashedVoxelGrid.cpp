@@ -0,0 +1,625 @@
+#include "HashedVoxelGrid.h"
+
+#include "StormMacro.h"
+
+#include "NeighborParticleReferral.h"
+#include "MemoryHelper.h"
+#include "RunnerHelper.h"
+
+#include "VoxelHelper.h"
+
+#define STORM_HIJACKED_TYPE uint32_t
+#	include "VectHijack.h"
+#undef STORM_HIJACKED_TYPE
+
+#define STORM_HIJACKED_TYPE uint64_t
+#	include "VectHijack.h"
+#undef STORM_HIJACKED_TYPE
+
+#define STORM_HIJACKED_TYPE Storm::NeighborParticleReferral
+#	include "VectHijack.h"
+#undef STORM_HIJACKED_TYPE
+
+#define STORM_HIJACKED_TYPE Storm::HashedVoxelGrid::KeyedParticle
+#	include "VectHijack.h"
+#undef STORM_HIJACKED_TYPE
+
+#define STORM_HIJACKED_TYPE Storm::HashedVoxelGrid::VoxelSlot
+#	include "VectHijack.h"
+#undef STORM_HIJACKED_TYPE
+
+
+namespace
+{
+	// The bundles given to the client are views living inside the thread that asked for them (see Storm::HashedVoxelGrid::getBundleAt).
+	thread_local Storm::NeighborParticleReferralBundle g_bundlesPerThread[Storm::k_neighborLinkedBunkCount];
+
+	enum : std::size_t
+	{
+		k_minVoxelTableSize = 16,
+
+		// The 3x3x3 voxels around an occupied voxel (itself included, at the center).
+		k_voxelCubeSize = 27,
+		k_voxelCubeCenterIndex = 13,
+	};
+
+	// No voxel can have this key since it is above the voxel count (checked at the construction).
+	constexpr uint64_t k_emptyVoxelKey = std::numeric_limits<uint64_t>::max();
+
+	// The neighbor of an occupied voxel is outside the domain.
+	constexpr uint32_t k_outsideDomainVoxel = std::numeric_limits<uint32_t>::max();
+
+	__forceinline std::size_t hashVoxelKey(const uint64_t voxelKey)
+	{
+		// Fibonacci hashing of the key without its 3 lowest bits, that are kept as is : runs of 8 voxels along z stay in consecutive slots (a neighborhood query hits the same cache lines),
+		// while the runs are spread over the whole table (neighbor voxels have close keys, without hashing they would pile up in the same part of the table).
+		return (static_cast<std::size_t>(((voxelKey >> 3) * 0x9E3779B97F4A7C15ull) >> 32) << 3) | static_cast<std::size_t>(voxelKey & 7);
+	}
+
+	__forceinline std::size_t computeVoxelCubeIndex(const int (&offset)[3])
+	{
+		return static_cast<std::size_t>((offset[0] + 1) * 9 + (offset[1] + 1) * 3 + (offset[2] + 1));
+	}
+
+	// Inside a voxel, the referrals are ordered by system registration order, then by particle index. This is what Storm::VoxelGrid produces, and it keeps the neighborhood (and therefore the simulation) deterministic.
+	__forceinline bool isKeyedParticleBefore(const Storm::HashedVoxelGrid::KeyedParticle &left, const Storm::HashedVoxelGrid::KeyedParticle &right)
+	{
+		return
+			left._voxelKey < right._voxelKey || (left._voxelKey == right._voxelKey &&
+			(left._systemRank < right._systemRank || (left._systemRank == right._systemRank && left._particleIndex < right._particleIndex)));
+	}
+}
+
+
+Storm::HashedVoxelGrid::HashedVoxelGrid(const Storm::Vector3 &upCorner, const Storm::Vector3 &downCorner, float voxelEdgeLength) :
+	_registeredSystemCount{ 0 },
+	_referralsSorted{ true }
+{
+	if (voxelEdgeLength < 0.00000001f || isnan(voxelEdgeLength) || isinf(voxelEdgeLength))
+	{
+		assert(false && "Invalid voxel length! This is forbidden!");
+		Storm::throwException<Storm::Exception>("Invalid voxel length (" + std::to_string(voxelEdgeLength) + ")! This is forbidden!");
+	}
+
+	const Storm::Vector3 diff = upCorner - downCorner;
+
+	_gridBoundary.x() = computeBlocCountOnAxis(diff.x(), voxelEdgeLength);
+	_gridBoundary.y() = computeBlocCountOnAxis(diff.y(), voxelEdgeLength);
+	_gridBoundary.z() = computeBlocCountOnAxis(diff.z(), voxelEdgeLength);
+
+	const double voxelCount = static_cast<double>(_gridBoundary.x()) * static_cast<double>(_gridBoundary.y()) * static_cast<double>(_gridBoundary.z());
+	if (voxelCount >= static_cast<double>(k_emptyVoxelKey))
+	{
+		Storm::throwException<Storm::Exception>("The domain is too big to be partitioned with a voxel length of " + std::to_string(voxelEdgeLength) + " (" + std::to_string(voxelCount) + " voxels)!");
+	}
+
+	_xIndexOffsetCoeff = static_cast<uint64_t>(_gridBoundary.y()) * static_cast<uint64_t>(_gridBoundary.z());
+
+	this->clearQueryTables();
+}
+
+Storm::HashedVoxelGrid::HashedVoxelGrid(Storm::HashedVoxelGrid &&other) = default;
+Storm::HashedVoxelGrid::HashedVoxelGrid(const Storm::HashedVoxelGrid &other) = default;
+Storm::HashedVoxelGrid::~HashedVoxelGrid() = default;
+
+uint32_t Storm::HashedVoxelGrid::findOccupiedVoxelIndex(const uint64_t voxelKey) const
+{
+	// The table is never full (at least half of it is empty), so the probing always ends.
+	std::size_t slotIndex = hashVoxelKey(voxelKey) & _voxelTableMask;
+	for (;;)
+	{
+		const Storm::HashedVoxelGrid::VoxelSlot &voxelSlot = _voxelTable[slotIndex];
+		if (voxelSlot._voxelKey == voxelKey)
+		{
+			return voxelSlot._occupiedVoxelIndex;
+		}
+		else if (voxelSlot._voxelKey == k_emptyVoxelKey)
+		{
+			return static_cast<uint32_t>(_occupiedVoxelCount);
+		}
+
+		slotIndex = (slotIndex + 1) & _voxelTableMask;
+	}
+}
+
+const Storm::NeighborParticleReferralBundle* Storm::HashedVoxelGrid::getOccupiedVoxelBundle(const uint32_t occupiedVoxelIndex, const std::size_t bundleSlot) const
+{
+	assert(bundleSlot < Storm::k_neighborLinkedBunkCount && "Bundle slot is out of the thread bundle storage!");
+
+	const Storm::NeighborParticleReferral*const referrals = _referrals.data();
+
+	Storm::NeighborParticleReferralBundle &bundle = g_bundlesPerThread[bundleSlot];
+	bundle = Storm::NeighborParticleReferralBundle{ referrals + _occupiedVoxelReferralStart[occupiedVoxelIndex], referrals + _occupiedVoxelReferralStart[occupiedVoxelIndex + 1] };
+	return &bundle;
+}
+
+const Storm::NeighborParticleReferralBundle* Storm::HashedVoxelGrid::getBundleAt(const std::size_t voxelIndex, const std::size_t bundleSlot) const
+{
+	assert(_queryTablesUpToDate && "prepareQueries should be called after the partition was filled or updated!");
+	return this->getOccupiedVoxelBundle(this->findOccupiedVoxelIndex(static_cast<uint64_t>(voxelIndex)), bundleSlot);
+}
+
+void Storm::HashedVoxelGrid::getVoxelsDataAtPosition(float voxelEdgeLength, const Storm::Vector3 &voxelShift, const Storm::NeighborParticleReferralBundle* &outContainingVoxelPtr, const Storm::NeighborParticleReferralBundle*(&outNeighborData)[Storm::k_neighborLinkedBunkCount], const Storm::Vector3 &particlePosition) const
+{
+	assert(_queryTablesUpToDate && "prepareQueries should be called after the partition was filled or updated!");
+
+	unsigned int xIndex;
+	unsigned int yIndex;
+	unsigned int zIndex;
+
+	const std::size_t voxelKey = this->computeRawIndexFromPosition(_gridBoundary, voxelEdgeLength, voxelShift, particlePosition, xIndex, yIndex, zIndex);
+	const uint32_t occupiedVoxelIndex = this->findOccupiedVoxelIndex(static_cast<uint64_t>(voxelKey));
+	if (occupiedVoxelIndex == _occupiedVoxelCount)
+	{
+		// The neighborhood of an empty voxel wasn't prepared, look for each neighbor.
+		const Storm::OutReflectedModality* dummy;
+		retrieveVoxelsDataAtPositionImpl<false>(*this, voxelEdgeLength, voxelShift, outContainingVoxelPtr, outNeighborData, particlePosition, dummy);
+		return;
+	}
+
+	outContainingVoxelPtr = this->getOccupiedVoxelBundle(occupiedVoxelIndex, k_containingBundleSlot);
+
+	// Same order than retrieveVoxelsDataAtPositionImpl : the neighbors inside the domain, ordered by x, then by y and finally by z.
+	const uint32_t*const neighborIndexes = _occupiedVoxelNeighbors.data() + static_cast<std::size_t>(occupiedVoxelIndex) * k_voxelCubeSize;
+
+	const Storm::NeighborParticleReferralBundle** iter = std::begin(outNeighborData);
+	for (std::size_t cubeIndex = 0; cubeIndex < k_voxelCubeSize; ++cubeIndex)
+	{
+		const uint32_t neighborIndex = neighborIndexes[cubeIndex];
+		if (cubeIndex != k_voxelCubeCenterIndex && neighborIndex != k_outsideDomainVoxel)
+		{
+			*iter = this->getOccupiedVoxelBundle(neighborIndex, static_cast<std::size_t>(iter - outNeighborData));
+			++iter;
+		}
+	}
+
+	*iter = nullptr;
+}
+
+void Storm::HashedVoxelGrid::getVoxelsDataAtPositionInfinite(float voxelEdgeLength, const Storm::Vector3 &voxelShift, const Storm::NeighborParticleReferralBundle* &outContainingVoxelPtr, const Storm::NeighborParticleReferralBundle*(&outNeighborData)[Storm::k_neighborLinkedBunkCount], const Storm::Vector3 &particlePosition, const Storm::OutReflectedModality* &reflectModality) const
+{
+	// The prepared neighborhoods don't contain the reflected voxels.
+	retrieveVoxelsDataAtPositionImpl<true>(*this, voxelEdgeLength, voxelShift, outContainingVoxelPtr, outNeighborData, particlePosition, reflectModality);
+}
+
+void Storm::HashedVoxelGrid::getVoxelsDataAtPosition(float voxelEdgeLength, const Storm::Vector3 &voxelShift, const Storm::NeighborParticleReferralBundle* &outContainingVoxelPtr, const Storm::Vector3 &particlePosition) const
+{
+	unsigned int xIndex;
+	unsigned int yIndex;
+	unsigned int zIndex;
+
+	const std::size_t voxelIndex = this->computeRawIndexFromPosition(_gridBoundary, voxelEdgeLength, voxelShift, particlePosition, xIndex, yIndex, zIndex);
+	outContainingVoxelPtr = this->getBundleAt(voxelIndex, k_containingBundleSlot);
+}
+
+void Storm::HashedVoxelGrid::getForwardVoxelsDataAtPosition(float voxelEdgeLength, const Storm::Vector3 &voxelShift, const Storm::NeighborParticleReferralBundle* &outContainingVoxelPtr, const Storm::NeighborParticleReferralBundle*(&outForwardNeighborData)[Storm::k_neighborLinkedBunkCount], const Storm::Vector3 &particlePosition) const
+{
+	assert(_queryTablesUpToDate && "prepareQueries should be called after the partition was filled or updated!");
+
+	unsigned int xIndex;
+	unsigned int yIndex;
+	unsigned int zIndex;
+
+	const std::size_t voxelKey = this->computeRawIndexFromPosition(_gridBoundary, voxelEdgeLength, voxelShift, particlePosition, xIndex, yIndex, zIndex);
+	const uint32_t occupiedVoxelIndex = this->findOccupiedVoxelIndex(static_cast<uint64_t>(voxelKey));
+	if (occupiedVoxelIndex == _occupiedVoxelCount)
+	{
+		retrieveForwardVoxelsDataAtPositionImpl(*this, voxelEdgeLength, voxelShift, outContainingVoxelPtr, outForwardNeighborData, particlePosition);
+		return;
+	}
+
+	outContainingVoxelPtr = this->getOccupiedVoxelBundle(occupiedVoxelIndex, k_containingBundleSlot);
+
+	const uint32_t*const neighborIndexes = _occupiedVoxelNeighbors.data() + static_cast<std::size_t>(occupiedVoxelIndex) * k_voxelCubeSize;
+
+	const Storm::NeighborParticleReferralBundle** iter = std::begin(outForwardNeighborData);
+	for (const int (&offset)[3] : k_forwardNeighborVoxelOffsets)
+	{
+		const uint32_t neighborIndex = neighborIndexes[computeVoxelCubeIndex(offset)];
+		if (neighborIndex != k_outsideDomainVoxel)
+		{
+			*iter = this->getOccupiedVoxelBundle(neighborIndex, static_cast<std::size_t>(iter - outForwardNeighborData));
+			++iter;
+		}
+	}
+
+	*iter = nullptr;
+}
+
+void Storm::HashedVoxelGrid::fill(float voxelEdgeLength, const Storm::Vector3 &voxelShift, const std::vector<Storm::Vector3> &particlePositions, const unsigned int systemId)
+{
+	// Register the system, reusing the buffers of a system registered before the last clear if any.
+	if (_registeredSystemCount == _registeredSystems.size())
+	{
+		_registeredSystems.emplace_back();
+	}
+
+	const std::size_t systemRank = _registeredSystemCount++;
+
+	Storm::HashedVoxelGrid::RegisteredSystem &registeredSystem = _registeredSystems[systemRank];
+	registeredSystem._systemId = systemId;
+	registeredSystem._updatePrepared = false;
+
+	std::vector<uint64_t> &particleVoxelKeys = registeredSystem._particleVoxelKeys;
+
+	const std::size_t particleCount = particlePositions.size();
+	if (particleCount == 0)
+	{
+		particleVoxelKeys.clear();
+		return;
+	}
+
+	const std::size_t firstReferralIndex = _keyedReferrals.size();
+	const std::size_t totalReferralCount = firstReferralIndex + particleCount;
+	if (totalReferralCount > static_cast<std::size_t>(std::numeric_limits<uint32_t>::max()))
+	{
+		Storm::throwException<Storm::Exception>("Too many particles registered inside the voxel grid (" + std::to_string(totalReferralCount) + "). The maximum is " + std::to_string(std::numeric_limits<uint32_t>::max()));
+	}
+
+	// The new referrals are appended after the previous ones, they will all be sorted at once by prepareQueries.
+	Storm::setNumUninitialized_safeHijack(particleVoxelKeys, Storm::VectorHijacker{ particleCount });
+	Storm::setNumUninitialized_safeHijack(_keyedReferrals, Storm::VectorHijacker{ totalReferralCount });
+	Storm::runParallel(particlePositions, [this, voxelEdgeLength, &voxelShift, &particleVoxelKeys, firstReferralIndex, systemRank](const Storm::Vector3 &position, const std::size_t particleIndex)
+	{
+		unsigned int dummy1;
+		unsigned int dummy2;
+		unsigned int dummy3;
+
+		const uint64_t voxelKey = static_cast<uint64_t>(this->computeRawIndexFromPosition(_gridBoundary, voxelEdgeLength, voxelShift, position, dummy1, dummy2, dummy3));
+
+		particleVoxelKeys[particleIndex] = voxelKey;
+		_keyedReferrals[firstReferralIndex + particleIndex] = Storm::HashedVoxelGrid::KeyedParticle{ voxelKey, static_cast<uint32_t>(particleIndex), static_cast<uint32_t>(systemRank) };
+	});
+
+	_referralsSorted = false;
+	_queryTablesUpToDate = false;
+}
+
+void Storm::HashedVoxelGrid::prepareQueries()
+{
+	if (!_referralsSorted)
+	{
+		std::sort(std::execution::par, std::begin(_keyedReferrals), std::end(_keyedReferrals), isKeyedParticleBefore);
+		this->setReferralsFromKeyedReferrals();
+
+		_referralsSorted = true;
+	}
+
+	if (!_queryTablesUpToDate)
+	{
+		this->rebuildQueryTables();
+		_queryTablesUpToDate = true;
+	}
+}
+
+void Storm::HashedVoxelGrid::setReferralsFromKeyedReferrals()
+{
+	Storm::setNumUninitialized_safeHijack(_referrals, Storm::VectorHijacker{ _keyedReferrals.size() });
+	Storm::runParallel(_keyedReferrals, [this](const Storm::HashedVoxelGrid::KeyedParticle &keyedReferral, const std::size_t referralIndex)
+	{
+		_referrals[referralIndex] = Storm::NeighborParticleReferral{ keyedReferral._particleIndex, _registeredSystems[keyedReferral._systemRank]._systemId };
+	});
+}
+
+void Storm::HashedVoxelGrid::rebuildQueryTables()
+{
+	const std::size_t referralCount = _keyedReferrals.size();
+	if (referralCount == 0)
+	{
+		this->clearQueryTables();
+		return;
+	}
+
+	// Flag the first referral of each voxel (the one with a different key than the previous referral)...
+	Storm::setNumUninitialized_safeHijack(_referralOccupiedVoxelIndexes, Storm::VectorHijacker{ referralCount });
+	Storm::runParallel(_keyedReferrals, [this](const Storm::HashedVoxelGrid::KeyedParticle &keyedReferral, const std::size_t referralIndex)
+	{
+		_referralOccupiedVoxelIndexes[referralIndex] = (referralIndex == 0 || keyedReferral._voxelKey != _keyedReferrals[referralIndex - 1]._voxelKey) ? 1 : 0;
+	});
+
+	// ... so the prefix sum numbers the occupied voxels (from 1).
+	std::inclusive_scan(std::execution::par, std::begin(_referralOccupiedVoxelIndexes), std::end(_referralOccupiedVoxelIndexes), std::begin(_referralOccupiedVoxelIndexes));
+
+	const std::size_t occupiedVoxelCount = _referralOccupiedVoxelIndexes.back();
+	_occupiedVoxelCount = occupiedVoxelCount;
+
+	std::size_t voxelTableSize = k_minVoxelTableSize;
+	while (voxelTableSize < occupiedVoxelCount * 2)
+	{
+		voxelTableSize *= 2;
+	}
+
+	Storm::setNumUninitialized_safeHijack(_voxelTable, Storm::VectorHijacker{ voxelTableSize });
+	std::fill(std::execution::par, std::begin(_voxelTable), std::end(_voxelTable), Storm::HashedVoxelGrid::VoxelSlot{ k_emptyVoxelKey, 0 });
+	_voxelTableMask = voxelTableSize - 1;
+
+	// Each first referral gives where its voxel starts, and inserts it inside the hash table : the voxel takes the first free slot of its probe sequence.
+	// Which voxel ends up in which slot depends on the thread scheduling when their probe sequences cross, but not what a lookup finds.
+	Storm::setNumUninitialized_safeHijack(_occupiedVoxelReferralStart, Storm::VectorHijacker{ occupiedVoxelCount + 2 });
+	Storm::runParallel(_referralOccupiedVoxelIndexes, [this](const uint32_t occupiedVoxelNumber, const std::size_t referralIndex)
+	{
+		if (referralIndex != 0 && _referralOccupiedVoxelIndexes[referralIndex - 1] == occupiedVoxelNumber)
+		{
+			return;
+		}
+
+		const uint32_t occupiedVoxelIndex = occupiedVoxelNumber - 1;
+		_occupiedVoxelReferralStart[occupiedVoxelIndex] = static_cast<uint32_t>(referralIndex);
+
+		const uint64_t voxelKey = _keyedReferrals[referralIndex]._voxelKey;
+
+		std::size_t slotIndex = hashVoxelKey(voxelKey) & _voxelTableMask;
+		for (;;)
+		{
+			Storm::HashedVoxelGrid::VoxelSlot &voxelSlot = _voxelTable[slotIndex];
+
+			uint64_t expectedKey = k_emptyVoxelKey;
+			if (std::atomic_ref<uint64_t>{ voxelSlot._voxelKey }.compare_exchange_strong(expectedKey, voxelKey, std::memory_order_relaxed))
+			{
+				voxelSlot._occupiedVoxelIndex = occupiedVoxelIndex;
+				break;
+			}
+
+			slotIndex = (slotIndex + 1) & _voxelTableMask;
+		}
+	});
+
+	_occupiedVoxelReferralStart[occupiedVoxelCount] = static_cast<uint32_t>(referralCount);
+	_occupiedVoxelReferralStart[occupiedVoxelCount + 1] = static_cast<uint32_t>(referralCount);
+
+	// Then look up the neighbors of each occupied voxel once, instead of once for each particle querying it.
+	const uint64_t zBoundary = static_cast<uint64_t>(_gridBoundary.z());
+
+	Storm::setNumUninitialized_safeHijack(_occupiedVoxelNeighbors, Storm::VectorHijacker{ occupiedVoxelCount * k_voxelCubeSize });
+	Storm::runParallel(_occupiedVoxelReferralStart, [this, occupiedVoxelCount, zBoundary](const uint32_t referralStart, const std::size_t occupiedVoxelIndex)
+	{
+		// The 2 last starts are the ends of the last occupied voxel and of the empty voxel.
+		if (occupiedVoxelIndex >= occupiedVoxelCount)
+		{
+			return;
+		}
+
+		const uint64_t voxelKey = _keyedReferrals[referralStart]._voxelKey;
+		const unsigned int xIndex = static_cast<unsigned int>(voxelKey / _xIndexOffsetCoeff);
+		const unsigned int yIndex = static_cast<unsigned int>((voxelKey % _xIndexOffsetCoeff) / zBoundary);
+		const unsigned int zIndex = static_cast<unsigned int>(voxelKey % zBoundary);
+
+		uint32_t* neighborIndexIter = _occupiedVoxelNeighbors.data() + occupiedVoxelIndex * k_voxelCubeSize;
+		for (int xOffset = -1; xOffset <= 1; ++xOffset)
+		{
+			for (int yOffset = -1; yOffset <= 1; ++yOffset)
+			{
+				for (int zOffset = -1; zOffset <= 1; ++zOffset, ++neighborIndexIter)
+				{
+					// Unsigned wrapping makes the index before 0 greater than the boundary, so one check is enough for both sides.
+					const unsigned int neighborXIndex = xIndex + xOffset;
+					const unsigned int neighborYIndex = yIndex + yOffset;
+					const unsigned int neighborZIndex = zIndex + zOffset;
+					if (neighborXIndex < _gridBoundary.x() && neighborYIndex < _gridBoundary.y() && neighborZIndex < _gridBoundary.z())
+					{
+						*neighborIndexIter = this->findOccupiedVoxelIndex(static_cast<uint64_t>(this->computeRawIndexFromCoordIndex(neighborXIndex, neighborYIndex, neighborZIndex)));
+					}
+					else
+					{
+						*neighborIndexIter = k_outsideDomainVoxel;
+					}
+				}
+			}
+		}
+	});
+}
+
+void Storm::HashedVoxelGrid::clearQueryTables()
+{
+	_occupiedVoxelReferralStart.assign(2, 0);
+	_occupiedVoxelCount = 0;
+
+	_voxelTable.assign(k_minVoxelTableSize, Storm::HashedVoxelGrid::VoxelSlot{ k_emptyVoxelKey, 0 });
+	_voxelTableMask = k_minVoxelTableSize - 1;
+
+	_occupiedVoxelNeighbors.clear();
+	_queryTablesUpToDate = true;
+}
+
+bool Storm::HashedVoxelGrid::prepareUpdate(float voxelEdgeLength, const Storm::Vector3 &voxelShift, const std::vector<Storm::Vector3> &particlePositions, const unsigned int systemId)
+{
+	const std::size_t systemRank = this->findRegisteredSystemRank(systemId);
+	if (systemRank == _registeredSystemCount || !_referralsSorted)
+	{
+		return false;
+	}
+
+	Storm::HashedVoxelGrid::RegisteredSystem &registeredSystem = _registeredSystems[systemRank];
+
+	const std::size_t particleCount = particlePositions.size();
+	if (registeredSystem._particleVoxelKeys.size() != particleCount)
+	{
+		return false;
+	}
+
+	// Particles that changed of voxel are appended after the ones of the systems prepared before. Their order depends on the thread scheduling, but they're sorted before being applied.
+	const std::size_t firstMovedParticleIndex = _movedParticles.size();
+	Storm::setNumUninitialized_safeHijack(_movedParticles, Storm::VectorHijacker{ firstMovedParticleIndex + particleCount });
+
+	std::atomic<std::size_t> movedParticleCount{ firstMovedParticleIndex };
+
+	Storm::setNumUninitialized_safeHijack(registeredSystem._updatedParticleVoxelKeys, Storm::VectorHijacker{ particleCount });
+	Storm::runParallel(particlePositions, [this, voxelEdgeLength, &voxelShift, &registeredSystem, systemRank, &movedParticleCount](const Storm::Vector3 &position, const std::size_t particleIndex)
+	{
+		unsigned int dummy1;
+		unsigned int dummy2;
+		unsigned int dummy3;
+
+		const uint64_t oldVoxelKey = registeredSystem._particleVoxelKeys[particleIndex];
+		const uint64_t newVoxelKey = static_cast<uint64_t>(this->computeRawIndexFromPosition(_gridBoundary, voxelEdgeLength, voxelShift, position, dummy1, dummy2, dummy3));
+
+		registeredSystem._updatedParticleVoxelKeys[particleIndex] = newVoxelKey;
+
+		if (newVoxelKey != oldVoxelKey)
+		{
+			_movedParticles[movedParticleCount.fetch_add(1, std::memory_order_relaxed)] = Storm::HashedVoxelGrid::KeyedParticle{ newVoxelKey, static_cast<uint32_t>(particleIndex), static_cast<uint32_t>(systemRank) };
+		}
+	});
+
+	_movedParticles.resize(movedParticleCount.load(std::memory_order_relaxed));
+
+	registeredSystem._updatePrepared = true;
+	return true;
+}
+
+bool Storm::HashedVoxelGrid::applyUpdate(float maxMovedParticleRatio)
+{
+	const std::size_t referralCount = _keyedReferrals.size();
+
+	bool canApply = static_cast<float>(_movedParticles.size()) <= maxMovedParticleRatio * static_cast<float>(referralCount);
+	for (std::size_t systemRank = 0; systemRank < _registeredSystemCount; ++systemRank)
+	{
+		Storm::HashedVoxelGrid::RegisteredSystem &registeredSystem = _registeredSystems[systemRank];
+		canApply &= registeredSystem._updatePrepared;
+		registeredSystem._updatePrepared = false;
+	}
+
+	if (!canApply)
+	{
+		_movedParticles.clear();
+		return false;
+	}
+
+	// From now, the updated voxel keys are the current ones.
+	for (std::size_t systemRank = 0; systemRank < _registeredSystemCount; ++systemRank)
+	{
+		Storm::HashedVoxelGrid::RegisteredSystem &registeredSystem = _registeredSystems[systemRank];
+		std::swap(registeredSystem._particleVoxelKeys, registeredSystem._updatedParticleVoxelKeys);
+	}
+
+	if (_movedParticles.empty())
+	{
+		return true;
+	}
+
+	// Only the moved particles need to be sorted...
+	std::sort(std::execution::par, std::begin(_movedParticles), std::end(_movedParticles), isKeyedParticleBefore);
+
+	// ... since the referrals that stayed inside their voxel remain sorted once the moved ones are removed.
+	Storm::setNumUninitialized_safeHijack(_stayedParticles, Storm::VectorHijacker{ referralCount });
+	const auto stayedParticlesEnd = std::remove_copy_if(std::execution::par, std::begin(_keyedReferrals), std::end(_keyedReferrals), std::begin(_stayedParticles), [this](const Storm::HashedVoxelGrid::KeyedParticle &keyedReferral)
+	{
+		return _registeredSystems[keyedReferral._systemRank]._particleVoxelKeys[keyedReferral._particleIndex] != keyedReferral._voxelKey;
+	});
+
+	assert(static_cast<std::size_t>(stayedParticlesEnd - std::begin(_stayedParticles)) + _movedParticles.size() == referralCount && "The moved and stayed particles should make all referrals!");
+
+	// Both are ordered like a full rebuild would order them, so is their merge.
+	std::merge(std::execution::par, std::begin(_stayedParticles), stayedParticlesEnd, std::begin(_movedParticles), std::end(_movedParticles), std::begin(_keyedReferrals), isKeyedParticleBefore);
+	this->setReferralsFromKeyedReferrals();
+
+	_movedParticles.clear();
+	_queryTablesUpToDate = false;
+	return true;
+}
+
+void Storm::HashedVoxelGrid::invalidateUpdate()
+{
+	// The systems remain registered (their referrals are still inside the grid), but they cannot match their particle count anymore, therefore they cannot be updated until the next clear.
+	for (std::size_t systemRank = 0; systemRank < _registeredSystemCount; ++systemRank)
+	{
+		Storm::HashedVoxelGrid::RegisteredSystem &registeredSystem = _registeredSystems[systemRank];
+		registeredSystem._particleVoxelKeys.clear();
+		registeredSystem._updatePrepared = false;
+	}
+
+	_movedParticles.clear();
+}
+
+std::size_t Storm::HashedVoxelGrid::findRegisteredSystemRank(const unsigned int systemId) const
+{
+	// There are only a few systems, a linear search is enough.
+	std::size_t systemRank = 0;
+	while (systemRank < _registeredSystemCount && _registeredSystems[systemRank]._systemId != systemId)
+	{
+		++systemRank;
+	}
+
+	return systemRank;
+}
+
+void Storm::HashedVoxelGrid::clear()
+{
+	_registeredSystemCount = 0;
+
+	_referrals.clear();
+	_keyedReferrals.clear();
+	_referralsSorted = true;
+
+	_movedParticles.clear();
+
+	this->clearQueryTables();
+}
+
+void Storm::HashedVoxelGrid::traverseVoxelsUnderRaycast(const Storm::Vector3 &origin, const Storm::Vector3 &direction, const float minDist, const float maxDist, const float rayRadius, const float voxelEdgeLength, const Storm::Vector3 &voxelShift, const Storm::ISpacePartition::RaycastVoxelVisitor &visitor) const
+{
+	traverseVoxelsUnderRaycastImpl(*this, origin, direction, minDist, maxDist, rayRadius, voxelEdgeLength, voxelShift, visitor);
+}
+
+void Storm::HashedVoxelGrid::traverseVoxelsInsideBox(const Storm::Vector3 &minCorner, const Storm::Vector3 &maxCorner, const float voxelEdgeLength, const Storm::Vector3 &voxelShift, const Storm::ISpacePartition::BoxVoxelVisitor &visitor) const
+{
+	traverseVoxelsInsideBoxImpl(*this, minCorner, maxCorner, voxelEdgeLength, voxelShift, visitor);
+}
+
+std::vector<unsigned int> Storm::HashedVoxelGrid::getRegisteredSystemIds() const
+{
+	std::vector<unsigned int> result;
+	result.reserve(_registeredSystemCount);
+
+	for (std::size_t systemRank = 0; systemRank < _registeredSystemCount; ++systemRank)
+	{
+		result.emplace_back(_registeredSystems[systemRank]._systemId);
+	}
+
+	return result;
+}
+
+std::size_t Storm::HashedVoxelGrid::getAllocatedMemorySize() const
+{
+	std::size_t result = sizeof(Storm::HashedVoxelGrid) +
+		_referrals.capacity() * sizeof(Storm::NeighborParticleReferral) +
+		(_keyedReferrals.capacity() + _movedParticles.capacity() + _stayedParticles.capacity()) * sizeof(Storm::HashedVoxelGrid::KeyedParticle) +
+		(_occupiedVoxelReferralStart.capacity() + _occupiedVoxelNeighbors.capacity() + _referralOccupiedVoxelIndexes.capacity()) * sizeof(uint32_t) +
+		_voxelTable.capacity() * sizeof(Storm::HashedVoxelGrid::VoxelSlot) +
+		_registeredSystems.capacity() * sizeof(Storm::HashedVoxelGrid::RegisteredSystem);
+
+	for (const Storm::HashedVoxelGrid::RegisteredSystem &registeredSystem : _registeredSystems)
+	{
+		result += (registeredSystem._particleVoxelKeys.capacity() + registeredSystem._updatedParticleVoxelKeys.capacity()) * sizeof(uint64_t);
+	}
+
+	return result;
+}
+
+std::size_t Storm::HashedVoxelGrid::getOccupiedVoxelCount() const noexcept
+{
+	assert(_queryTablesUpToDate && "prepareQueries should be called after the partition was filled or updated!");
+	return _occupiedVoxelCount;
+}
+
+void Storm::HashedVoxelGrid::computeCoordIndexFromPosition(const Storm::Vector3ui &maxValue, const float voxelEdgeLength, const Storm::Vector3 &voxelShift, const Storm::Vector3 &position, unsigned int &outXIndex, unsigned int &outYIndex, unsigned int &outZIndex) const
+{
+	outXIndex = computeCoordIndexOnAxis(maxValue, voxelEdgeLength, voxelShift, position, [](auto &vect) -> auto& { return vect.x(); });
+	outYIndex = computeCoordIndexOnAxis(maxValue, voxelEdgeLength, voxelShift, position, [](auto &vect) -> auto& { return vect.y(); });
+	outZIndex = computeCoordIndexOnAxis(maxValue, voxelEdgeLength, voxelShift, position, [](auto &vect) -> auto& { return vect.z(); });
+}
+
+std::size_t Storm::HashedVoxelGrid::computeRawIndexFromCoordIndex(unsigned int xIndex, unsigned int yIndex, unsigned int zIndex) const
+{
+	return static_cast<std::size_t>(
+		static_cast<uint64_t>(xIndex) * _xIndexOffsetCoeff +
+		static_cast<uint64_t>(yIndex) * static_cast<uint64_t>(_gridBoundary.z()) +
+		static_cast<uint64_t>(zIndex)
+		);
+}
+
+std::size_t Storm::HashedVoxelGrid::computeRawIndexFromPosition(const Storm::Vector3ui &maxValue, const float voxelEdgeLength, const Storm::Vector3 &voxelShift, const Storm::Vector3 &position, unsigned int &outXIndex, unsigned int &outYIndex, unsigned int &outZIndex) const
+{
+	this->computeCoordIndexFromPosition(maxValue, voxelEdgeLength, voxelShift, position, outXIndex, outYIndex, outZIndex);
+	return this->computeRawIndexFromCoordIndex(outXIndex, outYIndex, outZIndex);
+}
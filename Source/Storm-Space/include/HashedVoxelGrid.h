@@ -0,0 +1,144 @@
+#pragma once
+
+#include "ISpacePartition.h"
+
+
+namespace Storm
+{
+	struct NeighborParticleReferral;
+
+	// The sparse space partition : only the voxels containing particles exist, inside an open addressing hash table keyed on the voxel coordinate.
+	// Its memory grows with the particle count instead of the domain volume, so it is meant for sparse scenes (a domain much bigger than the volume the particles occupy, like a wind tunnel).
+	// The neighborhood of a voxel containing particles is looked up once by prepareQueries, then the queries from inside it only cost one hash lookup. But queries from an empty voxel,
+	// in infinite domain mode, and the raycasts/box traversals still need one hash lookup per voxel, and are therefore slower than with Storm::VoxelGrid. On dense scenes, prefer Storm::VoxelGrid.
+	// The referrals inside each voxel are in the same order than Storm::VoxelGrid, so both give the same neighborhood.
+	class HashedVoxelGrid : public Storm::ISpacePartition
+	{
+	public:
+		HashedVoxelGrid(const Storm::Vector3 &upCorner, const Storm::Vector3 &downCorner, float voxelEdgeLength);
+		HashedVoxelGrid(Storm::HashedVoxelGrid &&other);
+		HashedVoxelGrid(const Storm::HashedVoxelGrid &other);
+		~HashedVoxelGrid();
+
+	public:
+		void getVoxelsDataAtPosition(float voxelEdgeLength, const Storm::Vector3 &voxelShift, const Storm::NeighborParticleReferralBundle* &outContainingVoxelPtr, const Storm::NeighborParticleReferralBundle*(&outNeighborData)[Storm::k_neighborLinkedBunkCount], const Storm::Vector3 &particlePosition) const final override;
+		void getVoxelsDataAtPositionInfinite(float voxelEdgeLength, const Storm::Vector3 &voxelShift, const Storm::NeighborParticleReferralBundle* &outContainingVoxelPtr, const Storm::NeighborParticleReferralBundle*(&outNeighborData)[Storm::k_neighborLinkedBunkCount], const Storm::Vector3 &particlePosition, const Storm::OutReflectedModality* &reflectModality) const final override;
+		void getVoxelsDataAtPosition(float voxelEdgeLength, const Storm::Vector3 &voxelShift, const Storm::NeighborParticleReferralBundle* &outContainingVoxelPtr, const Storm::Vector3 &particlePosition) const final override;
+		void getForwardVoxelsDataAtPosition(float voxelEdgeLength, const Storm::Vector3 &voxelShift, const Storm::NeighborParticleReferralBundle* &outContainingVoxelPtr, const Storm::NeighborParticleReferralBundle*(&outForwardNeighborData)[Storm::k_neighborLinkedBunkCount], const Storm::Vector3 &particlePosition) const final override;
+
+		// Only finds (in parallel) the voxel of each particle. The referrals of all systems are sorted at once by prepareQueries.
+		void fill(float voxelEdgeLength, const Storm::Vector3 &voxelShift, const std::vector<Storm::Vector3> &particlePositions, const unsigned int systemId) final override;
+
+		// Incremental update of a system registered with fill since the last clear. It computes in parallel the voxel of each particle and keeps the ones that changed of voxel since the last fill or update.
+		// Returns false if it isn't possible (the system wasn't registered, its particle count changed, invalidateUpdate was called or prepareQueries wasn't called since the last fill), in which case a full rebuild (clear then fill) is needed.
+		bool prepareUpdate(float voxelEdgeLength, const Storm::Vector3 &voxelShift, const std::vector<Storm::Vector3> &particlePositions, const unsigned int systemId) final override;
+
+		// Apply the changes found by prepareUpdate (which should have been called for all registered systems). The referrals that stayed are already sorted, so only the moved ones are sorted,
+		// then both are merged (in parallel), and the referrals are in the same order than a full rebuild would produce. Returns false (and changes nothing) if the moved particle count
+		// is above maxMovedParticleRatio of all referrals, or if a registered system wasn't prepared. In this case, a full rebuild is needed.
+		bool applyUpdate(float maxMovedParticleRatio) final override;
+
+		// Forget the voxels the particles were in, to force the next update to fail until the next clear. It should be called when the particle indexes changed without changing their count (reordering).
+		void invalidateUpdate() final override;
+
+		// Sort the referrals registered by fill if any, then rebuild (in parallel) the hash table and the neighborhood of each occupied voxel. Nothing is done if the partition didn't change since the last call.
+		void prepareQueries() final override;
+
+		void clear() final override;
+
+		void traverseVoxelsUnderRaycast(const Storm::Vector3 &origin, const Storm::Vector3 &direction, const float minDist, const float maxDist, const float rayRadius, const float voxelEdgeLength, const Storm::Vector3 &voxelShift, const Storm::ISpacePartition::RaycastVoxelVisitor &visitor) const final override;
+
+		// Iterates over all voxel keys inside the box, so it is proportional to the box volume, not to the occupied voxel count inside it.
+		void traverseVoxelsInsideBox(const Storm::Vector3 &minCorner, const Storm::Vector3 &maxCorner, const float voxelEdgeLength, const Storm::Vector3 &voxelShift, const Storm::ISpacePartition::BoxVoxelVisitor &visitor) const final override;
+
+		std::vector<unsigned int> getRegisteredSystemIds() const final override;
+
+		std::size_t getAllocatedMemorySize() const final override;
+
+		// The count of voxels containing at least one particle.
+		std::size_t getOccupiedVoxelCount() const noexcept;
+
+		// Same as Storm::VoxelGrid::getBundleAt, except that voxelIndex is the voxel key (see computeRawIndexFromCoordIndex). An empty voxel gives an empty bundle.
+		const Storm::NeighborParticleReferralBundle* getBundleAt(const std::size_t voxelIndex, const std::size_t bundleSlot) const;
+
+		__forceinline const Storm::Vector3ui& getGridBoundary() const noexcept { return _gridBoundary; }
+
+	public:
+		void computeCoordIndexFromPosition(const Storm::Vector3ui &maxValue, const float voxelEdgeLength, const Storm::Vector3 &voxelShift, const Storm::Vector3 &position, unsigned int &outXIndex, unsigned int &outYIndex, unsigned int &outZIndex) const;
+
+		// The voxel key. Like the dense voxel index, but on 64 bits since there is no voxel array to limit the domain size.
+		std::size_t computeRawIndexFromCoordIndex(unsigned int xIndex, unsigned int yIndex, unsigned int zIndex) const;
+		std::size_t computeRawIndexFromPosition(const Storm::Vector3ui &maxValue, const float voxelEdgeLength, const Storm::Vector3 &voxelShift, const Storm::Vector3 &position, unsigned int &outXIndex, unsigned int &outYIndex, unsigned int &outZIndex) const;
+
+	public:
+		struct KeyedParticle
+		{
+		public:
+			uint64_t _voxelKey;
+			uint32_t _particleIndex;
+			uint32_t _systemRank; // Index of the system inside _registeredSystems.
+		};
+
+		struct VoxelSlot
+		{
+		public:
+			uint64_t _voxelKey;
+			uint32_t _occupiedVoxelIndex;
+		};
+
+		struct RegisteredSystem
+		{
+		public:
+			unsigned int _systemId;
+			bool _updatePrepared;
+
+			// The key of the voxel each particle of the system was in at the last fill or update.
+			std::vector<uint64_t> _particleVoxelKeys;
+			std::vector<uint64_t> _updatedParticleVoxelKeys;
+		};
+
+	private:
+		std::size_t findRegisteredSystemRank(const unsigned int systemId) const;
+
+		// Returns the index of the occupied voxel with this key, or getOccupiedVoxelCount() if the voxel is empty.
+		uint32_t findOccupiedVoxelIndex(const uint64_t voxelKey) const;
+
+		const Storm::NeighborParticleReferralBundle* getOccupiedVoxelBundle(const uint32_t occupiedVoxelIndex, const std::size_t bundleSlot) const;
+
+		void setReferralsFromKeyedReferrals();
+		void rebuildQueryTables();
+		void clearQueryTables();
+
+	private:
+		Storm::Vector3ui _gridBoundary;
+
+		uint64_t _xIndexOffsetCoeff;
+
+		std::vector<Storm::HashedVoxelGrid::RegisteredSystem> _registeredSystems;
+		std::size_t _registeredSystemCount;
+
+		// All referrals, sorted by voxel key (then by system registration order and particle index). _keyedReferrals[i] is _referrals[i] along with the key of its voxel.
+		// Between a fill and prepareQueries, the new referrals are appended unsorted at the end of _keyedReferrals, and _referrals is outdated.
+		std::vector<Storm::NeighborParticleReferral> _referrals;
+		std::vector<Storm::HashedVoxelGrid::KeyedParticle> _keyedReferrals;
+		bool _referralsSorted;
+
+		// The occupied voxels are numbered in key order. The referrals of the occupied voxel i are inside _referrals, from _occupiedVoxelReferralStart[i] (included) to _occupiedVoxelReferralStart[i + 1] (excluded).
+		// The array has one more element than needed, so the index _occupiedVoxelCount is an empty voxel (it stands for the empty neighbors inside _occupiedVoxelNeighbors).
+		std::vector<uint32_t> _occupiedVoxelReferralStart;
+		std::size_t _occupiedVoxelCount;
+
+		// The open addressing hash table (linear probing) of the occupied voxels. Its size is a power of 2, at least twice the occupied voxel count so the probe sequences remain short.
+		std::vector<Storm::HashedVoxelGrid::VoxelSlot> _voxelTable;
+		std::size_t _voxelTableMask;
+
+		// The occupied voxel index of the 3x3x3 voxels around each occupied voxel (27 per occupied voxel, ordered by x, then by y and finally by z offset).
+		std::vector<uint32_t> _occupiedVoxelNeighbors;
+		bool _queryTablesUpToDate;
+
+		// Scratch buffers. We keep them to not reallocate them each time the grid is rebuilt or updated.
+		std::vector<Storm::HashedVoxelGrid::KeyedParticle> _movedParticles;
+		std::vector<Storm::HashedVoxelGrid::KeyedParticle> _stayedParticles;
+		std::vector<uint32_t> _referralOccupiedVoxelIndexes;
+	};
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "SpacePartitionConstants.h"
+#include "NeighborParticleReferralBundle.h"
+
+
+namespace Storm
+{
+	class OutReflectedModality;
+
+	// The contract of a space partition backend (see Storm::SpacePartitionMode). Particles are registered inside the cell (voxel) of edge voxelEdgeLength containing them,
+	// and the client asks for the cells around a position to find the neighborhood.
+	class ISpacePartition
+	{
+	public:
+		// Receives the bundle of a visited voxel and the distance (along the ray) where the ray enters the voxel it crosses (the visited voxel itself, or the one it neighbors). Returns false to stop the traversal.
+		using RaycastVoxelVisitor = std::function<bool(const Storm::NeighborParticleReferralBundle &, const float)>;
+
+		// Receives the bundle of a non empty voxel overlapping the box.
+		using BoxVoxelVisitor = std::function<void(const Storm::NeighborParticleReferralBundle &)>;
+
+	public:
+		virtual ~ISpacePartition() = default;
+
+	public:
+		// The bundles returned are views living inside the calling thread storage, they remain valid until this thread asks for bundles again, or until the partition is modified.
+		virtual void getVoxelsDataAtPosition(float voxelEdgeLength, const Storm::Vector3 &voxelShift, const Storm::NeighborParticleReferralBundle* &outContainingVoxelPtr, const Storm::NeighborParticleReferralBundle*(&outNeighborData)[Storm::k_neighborLinkedBunkCount], const Storm::Vector3 &particlePosition) const = 0;
+		virtual void getVoxelsDataAtPositionInfinite(float voxelEdgeLength, const Storm::Vector3 &voxelShift, const Storm::NeighborParticleReferralBundle* &outContainingVoxelPtr, const Storm::NeighborParticleReferralBundle*(&outNeighborData)[Storm::k_neighborLinkedBunkCount], const Storm::Vector3 &particlePosition, const Storm::OutReflectedModality* &reflectModality) const = 0;
+		virtual void getVoxelsDataAtPosition(float voxelEdgeLength, const Storm::Vector3 &voxelShift, const Storm::NeighborParticleReferralBundle* &outContainingVoxelPtr, const Storm::Vector3 &particlePosition) const = 0;
+
+		// The containing voxel and only the neighbors after it (half of them, without the domain reflection), ended by a nullptr. If each particle only looks there (and only at the particles after it inside its own voxel), each pair of neighbors is found once.
+		virtual void getForwardVoxelsDataAtPosition(float voxelEdgeLength, const Storm::Vector3 &voxelShift, const Storm::NeighborParticleReferralBundle* &outContainingVoxelPtr, const Storm::NeighborParticleReferralBundle*(&outForwardNeighborData)[Storm::k_neighborLinkedBunkCount], const Storm::Vector3 &particlePosition) const = 0;
+
+		// Add the particles to the partition. The referrals already registered since the last clear are kept (they remain before the new ones inside each voxel).
+		virtual void fill(float voxelEdgeLength, const Storm::Vector3 &voxelShift, const std::vector<Storm::Vector3> &particlePositions, const unsigned int systemId) = 0;
+
+		// Incremental update of the registered systems (prepareUpdate for each of them, then applyUpdate). When one of them returns false, a full rebuild (clear then fill) is needed.
+		virtual bool prepareUpdate(float voxelEdgeLength, const Storm::Vector3 &voxelShift, const std::vector<Storm::Vector3> &particlePositions, const unsigned int systemId) = 0;
+		virtual bool applyUpdate(float maxMovedParticleRatio) = 0;
+		virtual void invalidateUpdate() = 0;
+
+		// To call after the partition was filled or updated, before querying it : some partitions only sort the particles or build their lookup tables there.
+		virtual void prepareQueries() = 0;
+
+		// Remove all referrals (the space remains partitioned, but without any particle inside).
+		virtual void clear() = 0;
+
+		// Visit the voxels crossed by the ray (direction should be normalized) between minDist and maxDist, in the order the ray crosses them.
+		// With a rayRadius (that shouldn't exceed the voxel edge length), the ray is inflated : each crossed voxel is visited along with its neighbors nearer than rayRadius from the ray, and each voxel is visited once.
+		virtual void traverseVoxelsUnderRaycast(const Storm::Vector3 &origin, const Storm::Vector3 &direction, const float minDist, const float maxDist, const float rayRadius, const float voxelEdgeLength, const Storm::Vector3 &voxelShift, const Storm::ISpacePartition::RaycastVoxelVisitor &visitor) const = 0;
+
+		// Visit the non empty voxels overlapping the axis aligned box between minCorner and maxCorner. The visit order is the voxel order, and each voxel is visited once.
+		virtual void traverseVoxelsInsideBox(const Storm::Vector3 &minCorner, const Storm::Vector3 &maxCorner, const float voxelEdgeLength, const Storm::Vector3 &voxelShift, const Storm::ISpacePartition::BoxVoxelVisitor &visitor) const = 0;
+
+		// The ids of the systems registered (filled) since the last clear.
+		virtual std::vector<unsigned int> getRegisteredSystemIds() const = 0;
+
+		// The memory held by the partition, in bytes.
+		virtual std::size_t getAllocatedMemorySize() const = 0;
+	};
+}
@@ -0,0 +1,17 @@
+#include "PositionVoxel.h"
+
+
+Storm::PositionVoxel::PositionVoxel() = default;
+Storm::PositionVoxel::PositionVoxel(Storm::PositionVoxel &&other) = default;
+Storm::PositionVoxel::PositionVoxel(const Storm::PositionVoxel &other) = default;
+Storm::PositionVoxel::~PositionVoxel() = default;
+
+void Storm::PositionVoxel::clear()
+{
+	_positionData.clear();
+}
+
+void Storm::PositionVoxel::addData(const Storm::Vector3 &pos)
+{
+	_positionData.emplace_back(pos);
+}
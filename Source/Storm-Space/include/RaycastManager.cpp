@@ -8,8 +8,7 @@
 
 #include "SpacePartitionerManager.h"
 
-#include "Voxel.h"
-#include "VoxelGrid.h"
+#include "ISpacePartition.h"
 #include "NeighborParticleReferral.h"
 
 #include "RaycastQueryRequest.h"
@@ -20,12 +19,140 @@
 #include "ThreadEnumeration.h"
 #include "ThreadingSafety.h"
 
+#include "RunnerHelper.h"
+
 
 namespace
 {
-	Storm::Vector3 raySphereCollisionHit(const Storm::Vector3 &/*rayOrigin*/, const Storm::Vector3 &/*rayDirection*/, const Storm::Vector3 &/*particleCenter*/, const float /*particleRadiusSquared*/)
+	using SystemPositionsMap = std::map<unsigned int, const std::vector<Storm::Vector3>*>;
+
+	// rayDirection should be normalized. Returns the distance along the ray where it enters the particle (or exits it if the ray origin is inside), negative if there is no hit in front of the origin.
+	float raySphereCollisionDistance(const Storm::Vector3 &rayOrigin, const Storm::Vector3 &rayDirection, const Storm::Vector3 &particleCenter, const float particleRadiusSquared)
 	{
-		STORM_NOT_IMPLEMENTED;
+		// Solve |rayOrigin + t * rayDirection - particleCenter|^2 = particleRadius^2, which simplifies to t^2 + 2bt + c = 0 since rayDirection is normalized.
+		const Storm::Vector3 centerToOrigin = rayOrigin - particleCenter;
+		const float b = centerToOrigin.dot(rayDirection);
+		const float c = centerToOrigin.squaredNorm() - particleRadiusSquared;
+
+		const float discriminant = b * b - c;
+		if (discriminant < 0.f)
+		{
+			return -1.f;
+		}
+
+		const float discriminantSqrt = std::sqrt(discriminant);
+
+		const float enterDist = -b - discriminantSqrt;
+		if (enterDist >= 0.f)
+		{
+			return enterDist;
+		}
+
+		return -b + discriminantSqrt;
+	}
+
+	void validateRaycastRequest(const Storm::RaycastQueryRequest &queryRequest)
+	{
+		if (queryRequest._minDistance < 0.f)
+		{
+			Storm::throwException<Storm::Exception>("min distance (" + std::to_string(queryRequest._minDistance) + ") raycast shouldn't be less than 0!");
+		}
+		else if (queryRequest._minDistance >= queryRequest._maxDistance)
+		{
+			Storm::throwException<Storm::Exception>("min distance (" + std::to_string(queryRequest._minDistance) + ") raycast shouldn't be greater than max distance (" + std::to_string(queryRequest._maxDistance) + ")!");
+		}
+	}
+
+	// The simulator only gives the particle positions to the simulation thread. Retrieve them beforehand so the rays can be traced from any thread.
+	SystemPositionsMap retrieveSystemPositions(const Storm::RaycastQueryRequest &queryRequest, const Storm::SpacePartitionerManager &spacePartitionMgr, const Storm::ISimulatorManager &simulatorMgr)
+	{
+		SystemPositionsMap result;
+
+		for (const Storm::PartitionSelection selection : queryRequest._particleSystemSelectionFlag)
+		{
+			for (const unsigned int systemId : spacePartitionMgr.getSpacePartition(selection)->getRegisteredSystemIds())
+			{
+				result.try_emplace(systemId, &simulatorMgr.getParticleSystemPositionsReferences(systemId));
+			}
+		}
+
+		return result;
+	}
+
+	void traceRay(const Storm::Vector3 &origin, const Storm::Vector3 &rayDirection, const Storm::RaycastQueryRequest &queryRequest, const Storm::SpacePartitionerManager &spacePartitionMgr, const SystemPositionsMap &systemPositions, const float particleRadius, std::vector<Storm::RaycastHitResult> &outResults)
+	{
+		outResults.clear();
+
+		const float directionNorm = rayDirection.norm();
+		if (directionNorm == 0.f)
+		{
+			return;
+		}
+
+		const Storm::Vector3 direction = rayDirection / directionNorm;
+
+		const float voxelLength = spacePartitionMgr.getPartitionLength();
+		const Storm::Vector3 &voxelShift = spacePartitionMgr.getGridShiftOffset();
+		const float particleRadiusSquared = particleRadius * particleRadius;
+
+		// When we want only the first hit, the farthest distance we're interested in shrinks with the nearest hit found so far.
+		float maxDistance = queryRequest._maxDistance;
+		float nearestHitDist = std::numeric_limits<float>::max();
+
+		// The visited voxels neighbor the voxel the ray enters at voxelEnterDist, so any particle registered inside them would be hit after voxelEnterDist - 2 * voxelLength * sqrt(3) - particleRadius (the diagonal of 2 voxels).
+		const float firstHitSearchMargin = 2.f * voxelLength * 1.7320508f + particleRadius;
+
+		for (const Storm::PartitionSelection selection : queryRequest._particleSystemSelectionFlag)
+		{
+			const auto &partition = spacePartitionMgr.getSpacePartition(selection);
+
+			// A particle is registered inside the voxel containing its center, but can be hit by a ray that doesn't cross this voxel as long as the ray passes near enough.
+			// This is why we inflate the traversed ray by the particle radius : the voxels the ray only passes near are visited too.
+			partition->traverseVoxelsUnderRaycast(origin, direction, queryRequest._minDistance, maxDistance, particleRadius, voxelLength, voxelShift, [&](const Storm::NeighborParticleReferralBundle &voxelData, const float voxelEnterDist)
+			{
+				if (queryRequest._wantOnlyFirstHit && voxelEnterDist - firstHitSearchMargin > nearestHitDist)
+				{
+					return false;
+				}
+
+				const std::vector<Storm::Vector3>* particleSystemPositions = nullptr;
+				unsigned int lastId = std::numeric_limits<decltype(lastId)>::max();
+
+				for (const Storm::NeighborParticleReferral &particleReferral : voxelData)
+				{
+					if (lastId != particleReferral._systemId)
+					{
+						lastId = particleReferral._systemId;
+						particleSystemPositions = systemPositions.find(lastId)->second;
+					}
+
+					const Storm::Vector3 &particleCenter = (*particleSystemPositions)[particleReferral._particleIndex];
+
+					const float hitDist = raySphereCollisionDistance(origin, direction, particleCenter, particleRadiusSquared);
+					if (hitDist > queryRequest._minDistance && hitDist < maxDistance)
+					{
+						if (queryRequest._wantOnlyFirstHit)
+						{
+							outResults.clear();
+							maxDistance = hitDist;
+							nearestHitDist = hitDist;
+						}
+
+						outResults.emplace_back(particleReferral._particleIndex, particleReferral._systemId, origin + hitDist * direction);
+					}
+				}
+
+				return true;
+			});
+		}
+
+		if (!queryRequest._wantOnlyFirstHit)
+		{
+			std::sort(std::begin(outResults), std::end(outResults), [&origin](const Storm::RaycastHitResult &left, const Storm::RaycastHitResult &right)
+			{
+				return (left._hitPosition - origin).squaredNorm() < (right._hitPosition - origin).squaredNorm();
+			});
+		}
 	}
 }
 
@@ -98,67 +225,50 @@ void Storm::RaycastManager::queryRaycast(const Storm::Vector2 &pixelScreenPos, S
 	});
 }
 
-void Storm::RaycastManager::executeRaycast(const Storm::Vector3 &origin, const Storm::Vector3 &direction, const Storm::RaycastQueryRequest &queryRequest) const
+void Storm::RaycastManager::queryRaycastBatch(const std::vector<Storm::Vector3> &origins, const std::vector<Storm::Vector3> &directions, const Storm::RaycastQueryRequest &queryRequest, std::vector<std::vector<Storm::RaycastHitResult>> &outResults) const
 {
 	assert(Storm::isSpaceThread() && "this method should only be executed on the same thread that the space partitioner.");
 
-	if (queryRequest._minDistance < 0.f)
+	const std::size_t rayCount = origins.size();
+	if (rayCount != directions.size())
 	{
-		Storm::throwException<Storm::Exception>("min distance (" + std::to_string(queryRequest._minDistance) + ") raycast shouldn't be less than 0!");
-	}
-	else if (queryRequest._minDistance >= queryRequest._maxDistance)
-	{
-		Storm::throwException<Storm::Exception>("min distance (" + std::to_string(queryRequest._minDistance) + ") raycast shouldn't be greater than max distance (" + std::to_string(queryRequest._maxDistance) + ")!");
+		Storm::throwException<Storm::Exception>("Raycast batch origin count (" + std::to_string(rayCount) + ") and direction count (" + std::to_string(directions.size()) + ") should be the same!");
 	}
 
-	std::vector<Storm::RaycastHitResult> results;
-	results.reserve(queryRequest._particleSystemSelectionFlag.size() * 124);
+	validateRaycastRequest(queryRequest);
+
+	outResults.resize(rayCount);
 
 	const Storm::SingletonHolder &singletonHolder = Storm::SingletonHolder::instance();
-	const Storm::ISimulatorManager &simulatorMgr = singletonHolder.getSingleton<Storm::ISimulatorManager>();
 	const Storm::IConfigManager &configMgr = singletonHolder.getSingleton<Storm::IConfigManager>();
 
 	const Storm::SpacePartitionerManager &spacePartitionMgr = Storm::SpacePartitionerManager::instance();
 
-	const float voxelLength = spacePartitionMgr.getPartitionLength();
+	const SystemPositionsMap systemPositions = retrieveSystemPositions(queryRequest, spacePartitionMgr, singletonHolder.getSingleton<Storm::ISimulatorManager>());
 	const float particleRadius = configMgr.getSceneSimulationConfig()._particleRadius;
-	const float particleRadiusSquared = particleRadius * particleRadius;
-	for (const Storm::PartitionSelection selection : queryRequest._particleSystemSelectionFlag)
+
+	Storm::runParallel(origins, [&](const Storm::Vector3 &origin, const std::size_t rayIndex)
 	{
-		const auto &partition = spacePartitionMgr.getSpacePartition(selection);
-		
-		std::vector<Storm::Voxel*> voxelsUnderRaycast = partition->getVoxelsUnderRaycast(origin, direction, queryRequest._minDistance, queryRequest._maxDistance, voxelLength);
+		traceRay(origin, directions[rayIndex], queryRequest, spacePartitionMgr, systemPositions, particleRadius, outResults[rayIndex]);
+	});
+}
 
-		const float minDistSquared = queryRequest._minDistance * queryRequest._minDistance;
-		const float maxDistSquared = queryRequest._maxDistance * queryRequest._maxDistance;
+void Storm::RaycastManager::executeRaycast(const Storm::Vector3 &origin, const Storm::Vector3 &direction, const Storm::RaycastQueryRequest &queryRequest) const
+{
+	assert(Storm::isSpaceThread() && "this method should only be executed on the same thread that the space partitioner.");
 
-		for (const Storm::Voxel* voxelPtr : voxelsUnderRaycast)
-		{
-			const Storm::Voxel &voxel = *voxelPtr;
+	validateRaycastRequest(queryRequest);
 
-			const std::vector<Storm::Vector3>* particleSystemPositions = nullptr;
-			unsigned int lastId = std::numeric_limits<decltype(lastId)>::max();
+	const Storm::SingletonHolder &singletonHolder = Storm::SingletonHolder::instance();
+	const Storm::IConfigManager &configMgr = singletonHolder.getSingleton<Storm::IConfigManager>();
 
-			const auto &voxelData = voxel.getData();
-			for (const auto &particleReferral : voxelData)
-			{
-				if (lastId != particleReferral._systemId)
-				{
-					lastId = particleReferral._systemId;
-					particleSystemPositions = &simulatorMgr.getParticleSystemPositionsReferences(particleReferral._systemId);
-				}
+	const Storm::SpacePartitionerManager &spacePartitionMgr = Storm::SpacePartitionerManager::instance();
 
-				 const Storm::Vector3 &particleCenter = (*particleSystemPositions)[particleReferral._particleIndex];
+	const SystemPositionsMap systemPositions = retrieveSystemPositions(queryRequest, spacePartitionMgr, singletonHolder.getSingleton<Storm::ISimulatorManager>());
+	const float particleRadius = configMgr.getSceneSimulationConfig()._particleRadius;
 
-				 Storm::Vector3 hitPosition = raySphereCollisionHit(origin, direction, particleCenter, particleRadiusSquared);
-				 const float distCollisionSquared = (hitPosition - origin).squaredNorm();
-				 if (distCollisionSquared > minDistSquared && distCollisionSquared < maxDistSquared)
-				 {
-					 results.emplace_back(particleReferral._particleIndex, particleReferral._systemId, hitPosition);
-				 }
-			}
-		}
-	}
+	std::vector<Storm::RaycastHitResult> results;
+	traceRay(origin, direction, queryRequest, spacePartitionMgr, systemPositions, particleRadius, results);
 
 	queryRequest._hitResponseCallback(std::move(results));
 }
@@ -177,8 +287,8 @@ void Storm::RaycastManager::searchForNearestParticle(const Storm::Vector3 &posit
 		const Storm::SpacePartitionerManager &spaceMgr = Storm::SpacePartitionerManager::instance();
 		for (const Storm::PartitionSelection modality : queryReq._particleSystemSelectionFlag)
 		{
-			const std::vector<Storm::NeighborParticleReferral>* containingBundlePtr = nullptr;
-			const std::vector<Storm::NeighborParticleReferral>* neighborhoodBundles[Storm::k_neighborLinkedBunkCount];
+			const Storm::NeighborParticleReferralBundle* containingBundlePtr = nullptr;
+			const Storm::NeighborParticleReferralBundle* neighborhoodBundles[Storm::k_neighborLinkedBunkCount];
 
 			spaceMgr.getAllBundles(containingBundlePtr, neighborhoodBundles, position, modality);
 
@@ -248,7 +358,7 @@ void Storm::RaycastManager::searchForNearestParticle(const Storm::Vector3 &posit
 				searchLambda(particleReferral);
 			}
 
-			for (const std::vector<Storm::NeighborParticleReferral>*const* neighborBundle = neighborhoodBundles; *neighborBundle != nullptr; ++neighborBundle)
+			for (const Storm::NeighborParticleReferralBundle*const* neighborBundle = neighborhoodBundles; *neighborBundle != nullptr; ++neighborBundle)
 			{
 				for (const Storm::NeighborParticleReferral &particleReferral : **neighborBundle)
 				{
@@ -17,6 +17,7 @@ namespace Storm
 	public:
 		void queryRaycast(const Storm::Vector3 &origin, const Storm::Vector3 &direction, Storm::RaycastQueryRequest &&queryRequest) const final override;
 		void queryRaycast(const Storm::Vector2 &pixelScreenPos, Storm::RaycastQueryRequest &&queryRequest) const override;
+		void queryRaycastBatch(const std::vector<Storm::Vector3> &origins, const std::vector<Storm::Vector3> &directions, const Storm::RaycastQueryRequest &queryRequest, std::vector<std::vector<Storm::RaycastHitResult>> &outResults) const final override;
 
 	private:
 		void executeRaycast(const Storm::Vector3 &origin, const Storm::Vector3 &direction, const Storm::RaycastQueryRequest &queryRequest) const;
@@ -8,10 +8,14 @@
 #include "IRigidBody.h"
 
 #include "VoxelGrid.h"
+#include "HashedVoxelGrid.h"
 #include "PartitionSelection.h"
 #include "DistanceSpacePartitionProxy.h"
 
 #include "SceneCageConfig.h"
+#include "SceneSimulationConfig.h"
+
+#include "SpacePartitionMode.h"
 
 #include "SerializeSupportedFeatureLayout.h"
 #include "SerializeRecordHeader.h"
@@ -21,7 +25,12 @@
 #include "ThreadingSafety.h"
 
 
-Storm::SpacePartitionerManager::SpacePartitionerManager() = default;
+Storm::SpacePartitionerManager::SpacePartitionerManager() :
+	_staticPartitionFrozen{ false }
+{
+
+}
+
 Storm::SpacePartitionerManager::~SpacePartitionerManager() = default;
 
 void Storm::SpacePartitionerManager::initialize_Implementation(float partitionLength)
@@ -101,6 +110,8 @@ void Storm::SpacePartitionerManager::initialize_Implementation(float partitionLe
 	Storm::minNegativeInPlaceFromBoth(_gridShiftOffset, _downSpaceCorner, _upSpaceCorner, yCoordProvider);
 	Storm::minNegativeInPlaceFromBoth(_gridShiftOffset, _downSpaceCorner, _upSpaceCorner, zCoordProvider);
 
+	_spacePartitionMode = configMgr.getSceneSimulationConfig()._spacePartitionMode;
+
 	_partitionLength = -1.f; // To be sure we don't set the same length.
 	this->setPartitionLength(partitionLength);
 
@@ -126,16 +137,39 @@ void Storm::SpacePartitionerManager::partitionSpace()
 
 	LOG_DEBUG << "Space partitioning requested from " << _upSpaceCorner << " to " << _downSpaceCorner << " with a partition length of " << _partitionLength;
 
-	auto fluidSpacePartitionSrc = std::make_unique<Storm::VoxelGrid>(_upSpaceCorner, _downSpaceCorner, _partitionLength);
+	// The partitions are empty at creation, so creating them is as cheap as copying one.
+	auto fluidSpacePartitionSrc = this->makeSpacePartition();
+	auto dynamicRigidBodySpacePartitionSrc = this->makeSpacePartition();
+	auto staticRigidBodySpacePartitionSrc = this->makeSpacePartition();
 
-	// Since the space partition are the same (this is the internal referrals that differ, but since we have not added anything, those does not differ for now). 
-	// Just copy the newly created space partition instead of computing everything again. 
-	auto dynamicRigidBodySpacePartitionSrc = std::make_unique<Storm::VoxelGrid>(*fluidSpacePartitionSrc);
-	auto staticRigidBodySpacePartitionSrc = std::make_unique<Storm::VoxelGrid>(*fluidSpacePartitionSrc);
+	LOG_DEBUG << "Each space partition uses " << fluidSpacePartitionSrc->getAllocatedMemorySize() << " bytes when empty";
+
+	if (_spacePartitionMode == Storm::SpacePartitionMode::Hashed)
+	{
+		const Storm::Vector3 voxelCountPerAxis = ((_upSpaceCorner - _downSpaceCorner) / _partitionLength).array().ceil();
+		LOG_WARNING <<
+			"The hashed space partition is used : it doesn't allocate the " << static_cast<std::size_t>(voxelCountPerAxis.prod()) << " voxels a dense partition would have, "
+			"but its neighborhood queries are slower. It only pays off on big and mostly empty domains, prefer the dense partition otherwise.";
+	}
 
 	_fluidSpacePartition = std::move(fluidSpacePartitionSrc);
 	_dynamicRigidBodySpacePartition = std::move(dynamicRigidBodySpacePartitionSrc);
 	_staticRigidBodySpacePartition = std::move(staticRigidBodySpacePartitionSrc);
+
+	// The new static partition is empty, it should be filled again.
+	_staticPartitionFrozen = false;
+}
+
+std::unique_ptr<Storm::ISpacePartition> Storm::SpacePartitionerManager::makeSpacePartition() const
+{
+	switch (_spacePartitionMode)
+	{
+	case Storm::SpacePartitionMode::Dense: return std::make_unique<Storm::VoxelGrid>(_upSpaceCorner, _downSpaceCorner, _partitionLength);
+	case Storm::SpacePartitionMode::Hashed: return std::make_unique<Storm::HashedVoxelGrid>(_upSpaceCorner, _downSpaceCorner, _partitionLength);
+
+	default:
+		Storm::throwException<Storm::Exception>("Unknown space partition mode!");
+	}
 }
 
 void Storm::SpacePartitionerManager::clearSpaceReorderingNoStatic()
@@ -148,7 +182,7 @@ void Storm::SpacePartitionerManager::computeSpaceReordering(const std::vector<St
 {
 	assert(Storm::isSpaceThread() && "This method should only be executed inside the space thread!");
 
-	const std::unique_ptr<Storm::VoxelGrid> &spacePartition = this->getSpacePartition(modality);
+	const std::unique_ptr<Storm::ISpacePartition> &spacePartition = this->getSpacePartition(modality);
 	spacePartition->fill(this->getPartitionLength(), _gridShiftOffset, particlePositions, systemId);
 }
 
@@ -156,29 +190,93 @@ void Storm::SpacePartitionerManager::clearSpaceReorderingForPartition(Storm::Par
 {
 	assert(Storm::isSpaceThread() && "This method should only be executed inside the space thread!");
 
-	const std::unique_ptr<Storm::VoxelGrid> &spacePartition = this->getSpacePartition(modality);
+	const std::unique_ptr<Storm::ISpacePartition> &spacePartition = this->getSpacePartition(modality);
 	spacePartition->clear();
+
+	if (modality == Storm::PartitionSelection::StaticRigidBody)
+	{
+		_staticPartitionFrozen = false;
+	}
+}
+
+bool Storm::SpacePartitionerManager::prepareSpaceReorderingUpdate(const std::vector<Storm::Vector3> &particlePositions, Storm::PartitionSelection modality, const unsigned int systemId)
+{
+	assert(Storm::isSpaceThread() && "This method should only be executed inside the space thread!");
+
+	const std::unique_ptr<Storm::ISpacePartition> &spacePartition = this->getSpacePartition(modality);
+	return spacePartition->prepareUpdate(this->getPartitionLength(), _gridShiftOffset, particlePositions, systemId);
+}
+
+bool Storm::SpacePartitionerManager::applySpaceReorderingUpdate(Storm::PartitionSelection modality, float maxMovedParticleRatio)
+{
+	assert(Storm::isSpaceThread() && "This method should only be executed inside the space thread!");
+
+	const std::unique_ptr<Storm::ISpacePartition> &spacePartition = this->getSpacePartition(modality);
+	return spacePartition->applyUpdate(maxMovedParticleRatio);
 }
 
-void Storm::SpacePartitionerManager::getAllBundles(const std::vector<Storm::NeighborParticleReferral>* &outContainingBundlePtr, const std::vector<Storm::NeighborParticleReferral>*(&outNeighborBundle)[Storm::k_neighborLinkedBunkCount], const Storm::Vector3 &particlePosition, Storm::PartitionSelection modality) const
+void Storm::SpacePartitionerManager::finishSpaceReordering(Storm::PartitionSelection modality)
 {
-	const std::unique_ptr<Storm::VoxelGrid> &spacePartition = this->getSpacePartition(modality);
-	const Storm::OutReflectedModality* dummy;
-	spacePartition->getVoxelsDataAtPosition<false>(this->getPartitionLength(), _gridShiftOffset, outContainingBundlePtr, outNeighborBundle, particlePosition, dummy);
+	assert(Storm::isSpaceThread() && "This method should only be executed inside the space thread!");
+
+	const std::unique_ptr<Storm::ISpacePartition> &spacePartition = this->getSpacePartition(modality);
+	spacePartition->prepareQueries();
 }
 
-void Storm::SpacePartitionerManager::getAllBundlesInfinite(const std::vector<Storm::NeighborParticleReferral>* &outContainingBundlePtr, const std::vector<Storm::NeighborParticleReferral>*(&outNeighborBundle)[Storm::k_neighborLinkedBunkCount], const Storm::Vector3 &particlePosition, Storm::PartitionSelection modality, const Storm::OutReflectedModality* &reflectModality) const
+void Storm::SpacePartitionerManager::invalidateSpaceReorderingUpdate(Storm::PartitionSelection modality)
 {
-	const std::unique_ptr<Storm::VoxelGrid> &spacePartition = this->getSpacePartition(modality);
-	spacePartition->getVoxelsDataAtPosition<true>(this->getPartitionLength(), _gridShiftOffset, outContainingBundlePtr, outNeighborBundle, particlePosition, reflectModality);
+	assert(Storm::isSpaceThread() && "This method should only be executed inside the space thread!");
+
+	const std::unique_ptr<Storm::ISpacePartition> &spacePartition = this->getSpacePartition(modality);
+	spacePartition->invalidateUpdate();
 }
 
-void Storm::SpacePartitionerManager::getContainingBundle(const std::vector<Storm::NeighborParticleReferral>* &outContainingBundlePtr, const Storm::Vector3 &particlePosition, Storm::PartitionSelection modality) const
+void Storm::SpacePartitionerManager::freezeStaticPartition()
 {
-	const std::unique_ptr<Storm::VoxelGrid> &spacePartition = this->getSpacePartition(modality);
+	assert(Storm::isSpaceThread() && "This method should only be executed inside the space thread!");
+
+	// The static partition won't be updated incrementally, so drop what could have been prepared.
+	_staticRigidBodySpacePartition->invalidateUpdate();
+	_staticPartitionFrozen = true;
+
+	LOG_DEBUG << "Static rigid bodies partition frozen";
+}
+
+bool Storm::SpacePartitionerManager::isStaticPartitionFrozen() const noexcept
+{
+	return _staticPartitionFrozen;
+}
+
+void Storm::SpacePartitionerManager::getAllBundles(const Storm::NeighborParticleReferralBundle* &outContainingBundlePtr, const Storm::NeighborParticleReferralBundle*(&outNeighborBundle)[Storm::k_neighborLinkedBunkCount], const Storm::Vector3 &particlePosition, Storm::PartitionSelection modality) const
+{
+	const std::unique_ptr<Storm::ISpacePartition> &spacePartition = this->getSpacePartition(modality);
+	spacePartition->getVoxelsDataAtPosition(this->getPartitionLength(), _gridShiftOffset, outContainingBundlePtr, outNeighborBundle, particlePosition);
+}
+
+void Storm::SpacePartitionerManager::getAllBundlesInfinite(const Storm::NeighborParticleReferralBundle* &outContainingBundlePtr, const Storm::NeighborParticleReferralBundle*(&outNeighborBundle)[Storm::k_neighborLinkedBunkCount], const Storm::Vector3 &particlePosition, Storm::PartitionSelection modality, const Storm::OutReflectedModality* &reflectModality) const
+{
+	const std::unique_ptr<Storm::ISpacePartition> &spacePartition = this->getSpacePartition(modality);
+	spacePartition->getVoxelsDataAtPositionInfinite(this->getPartitionLength(), _gridShiftOffset, outContainingBundlePtr, outNeighborBundle, particlePosition, reflectModality);
+}
+
+void Storm::SpacePartitionerManager::getForwardBundles(const Storm::NeighborParticleReferralBundle* &outContainingBundlePtr, const Storm::NeighborParticleReferralBundle*(&outForwardNeighborBundle)[Storm::k_neighborLinkedBunkCount], const Storm::Vector3 &particlePosition, Storm::PartitionSelection modality) const
+{
+	const std::unique_ptr<Storm::ISpacePartition> &spacePartition = this->getSpacePartition(modality);
+	spacePartition->getForwardVoxelsDataAtPosition(this->getPartitionLength(), _gridShiftOffset, outContainingBundlePtr, outForwardNeighborBundle, particlePosition);
+}
+
+void Storm::SpacePartitionerManager::getContainingBundle(const Storm::NeighborParticleReferralBundle* &outContainingBundlePtr, const Storm::Vector3 &particlePosition, Storm::PartitionSelection modality) const
+{
+	const std::unique_ptr<Storm::ISpacePartition> &spacePartition = this->getSpacePartition(modality);
 	spacePartition->getVoxelsDataAtPosition(this->getPartitionLength(), _gridShiftOffset, outContainingBundlePtr, particlePosition);
 }
 
+void Storm::SpacePartitionerManager::visitBundlesInsideBox(const Storm::Vector3 &minCorner, const Storm::Vector3 &maxCorner, Storm::PartitionSelection modality, const Storm::ISpacePartitionerManager::BundleVisitor &visitor) const
+{
+	const std::unique_ptr<Storm::ISpacePartition> &spacePartition = this->getSpacePartition(modality);
+	spacePartition->traverseVoxelsInsideBox(minCorner, maxCorner, this->getPartitionLength(), _gridShiftOffset, visitor);
+}
+
 float Storm::SpacePartitionerManager::getPartitionLength() const
 {
 	return _partitionLength;
@@ -223,7 +321,12 @@ Storm::Vector3 Storm::SpacePartitionerManager::getDomainDimension() const noexce
 	return _upSpaceCorner - _downSpaceCorner;
 }
 
-const std::unique_ptr<Storm::VoxelGrid>& Storm::SpacePartitionerManager::getSpacePartition(Storm::PartitionSelection modality) const
+const Storm::Vector3& Storm::SpacePartitionerManager::getGridShiftOffset() const noexcept
+{
+	return _gridShiftOffset;
+}
+
+const std::unique_ptr<Storm::ISpacePartition>& Storm::SpacePartitionerManager::getSpacePartition(Storm::PartitionSelection modality) const
 {
 	switch (modality)
 	{
@@ -5,7 +5,8 @@
 
 namespace Storm
 {
-	class VoxelGrid;
+	class ISpacePartition;
+	enum class SpacePartitionMode;
 
 	class SpacePartitionerManager final :
 		private Storm::Singleton<SpacePartitionerManager>,
@@ -14,20 +15,30 @@ namespace Storm
 		STORM_DECLARE_SINGLETON(SpacePartitionerManager);
 
 	private:
-		using SpacePartitionStructure = std::unique_ptr<Storm::VoxelGrid>;
+		using SpacePartitionStructure = std::unique_ptr<Storm::ISpacePartition>;
 
 	private:
 		void initialize_Implementation(float partitionLength);
 		void cleanUp_Implementation();
 
+		std::unique_ptr<Storm::ISpacePartition> makeSpacePartition() const;
+
 	public:
 		void partitionSpace() final override;
 		void clearSpaceReorderingNoStatic() final override;
 		void computeSpaceReordering(const std::vector<Storm::Vector3> &particlePositions, Storm::PartitionSelection modality, const unsigned int systemId) final override;
 		void clearSpaceReorderingForPartition(Storm::PartitionSelection modality) final override;
-		void getAllBundles(const std::vector<Storm::NeighborParticleReferral>* &outContainingBundlePtr, const std::vector<Storm::NeighborParticleReferral>*(&outNeighborBundle)[Storm::k_neighborLinkedBunkCount], const Storm::Vector3 &particlePosition, Storm::PartitionSelection modality) const final override;
-		void getAllBundlesInfinite(const std::vector<Storm::NeighborParticleReferral>* &outContainingBundlePtr, const std::vector<Storm::NeighborParticleReferral>*(&outNeighborBundle)[Storm::k_neighborLinkedBunkCount], const Storm::Vector3 &particlePosition, Storm::PartitionSelection modality, const Storm::OutReflectedModality* &reflectModality) const final override;
-		void getContainingBundle(const std::vector<Storm::NeighborParticleReferral>* &outContainingBundlePtr, const Storm::Vector3 &particlePosition, Storm::PartitionSelection modality) const final override;
+		bool prepareSpaceReorderingUpdate(const std::vector<Storm::Vector3> &particlePositions, Storm::PartitionSelection modality, const unsigned int systemId) final override;
+		bool applySpaceReorderingUpdate(Storm::PartitionSelection modality, float maxMovedParticleRatio) final override;
+		void finishSpaceReordering(Storm::PartitionSelection modality) final override;
+		void invalidateSpaceReorderingUpdate(Storm::PartitionSelection modality) final override;
+		void freezeStaticPartition() final override;
+		bool isStaticPartitionFrozen() const noexcept final override;
+		void getAllBundles(const Storm::NeighborParticleReferralBundle* &outContainingBundlePtr, const Storm::NeighborParticleReferralBundle*(&outNeighborBundle)[Storm::k_neighborLinkedBunkCount], const Storm::Vector3 &particlePosition, Storm::PartitionSelection modality) const final override;
+		void getAllBundlesInfinite(const Storm::NeighborParticleReferralBundle* &outContainingBundlePtr, const Storm::NeighborParticleReferralBundle*(&outNeighborBundle)[Storm::k_neighborLinkedBunkCount], const Storm::Vector3 &particlePosition, Storm::PartitionSelection modality, const Storm::OutReflectedModality* &reflectModality) const final override;
+		void getForwardBundles(const Storm::NeighborParticleReferralBundle* &outContainingBundlePtr, const Storm::NeighborParticleReferralBundle*(&outForwardNeighborBundle)[Storm::k_neighborLinkedBunkCount], const Storm::Vector3 &particlePosition, Storm::PartitionSelection modality) const final override;
+		void getContainingBundle(const Storm::NeighborParticleReferralBundle* &outContainingBundlePtr, const Storm::Vector3 &particlePosition, Storm::PartitionSelection modality) const final override;
+		void visitBundlesInsideBox(const Storm::Vector3 &minCorner, const Storm::Vector3 &maxCorner, Storm::PartitionSelection modality, const Storm::ISpacePartitionerManager::BundleVisitor &visitor) const final override;
 
 		float getPartitionLength() const final override;
 		void setPartitionLength(float length) final override;
@@ -42,18 +53,21 @@ namespace Storm
 		std::shared_ptr<Storm::IDistanceSpacePartitionProxy> makeDistancePartitionProxy(const Storm::Vector3 &upCorner, const Storm::Vector3 &downCorner, const float partitionLength) final override;
 
 	public:
-		const std::unique_ptr<Storm::VoxelGrid>& getSpacePartition(Storm::PartitionSelection modality) const;
+		const std::unique_ptr<Storm::ISpacePartition>& getSpacePartition(Storm::PartitionSelection modality) const;
+		const Storm::Vector3& getGridShiftOffset() const noexcept;
 
 	private:
 		Storm::Vector3 _upSpaceCorner;
 		Storm::Vector3 _downSpaceCorner;
 
 		float _partitionLength;
+		Storm::SpacePartitionMode _spacePartitionMode;
 		Storm::Vector3 _gridShiftOffset;
 
 		SpacePartitionStructure _fluidSpacePartition;
 		SpacePartitionStructure _dynamicRigidBodySpacePartition;
 		SpacePartitionStructure _staticRigidBodySpacePartition;
+		bool _staticPartitionFrozen;
 
 		bool _infiniteDomain;
 	};
@@ -2,13 +2,40 @@
 
 #include "StormMacro.h"
 
-#include "Voxel.h"
+#include "NeighborParticleReferral.h"
 #include "MemoryHelper.h"
+#include "RunnerHelper.h"
 
 #include "VoxelHelper.h"
 
+#define STORM_HIJACKED_TYPE uint32_t
+#	include "VectHijack.h"
+#undef STORM_HIJACKED_TYPE
 
-Storm::VoxelGrid::VoxelGrid(const Storm::Vector3 &upCorner, const Storm::Vector3 &downCorner, float voxelEdgeLength)
+#define STORM_HIJACKED_TYPE Storm::NeighborParticleReferral
+#	include "VectHijack.h"
+#undef STORM_HIJACKED_TYPE
+
+#define STORM_HIJACKED_TYPE Storm::VoxelGrid::MovedParticle
+#	include "VectHijack.h"
+#undef STORM_HIJACKED_TYPE
+
+
+namespace
+{
+	// The bundles given to the client are views living inside the thread that asked for them (see Storm::VoxelGrid::getBundleAt).
+	thread_local Storm::NeighborParticleReferralBundle g_bundlesPerThread[Storm::k_neighborLinkedBunkCount];
+
+	// Inside a voxel, the referrals are ordered by system registration order, then by particle index (this is what the rebuild produces).
+	__forceinline bool isReferralBefore(const std::size_t leftSystemRank, const std::size_t leftParticleIndex, const std::size_t rightSystemRank, const std::size_t rightParticleIndex)
+	{
+		return leftSystemRank < rightSystemRank || (leftSystemRank == rightSystemRank && leftParticleIndex < rightParticleIndex);
+	}
+}
+
+
+Storm::VoxelGrid::VoxelGrid(const Storm::Vector3 &upCorner, const Storm::Vector3 &downCorner, float voxelEdgeLength) :
+	_registeredSystemCount{ 0 }
 {
 	if (voxelEdgeLength < 0.00000001f || isnan(voxelEdgeLength) || isinf(voxelEdgeLength))
 	{
@@ -24,52 +51,353 @@ Storm::VoxelGrid::VoxelGrid(const Storm::Vector3 &upCorner, const Storm::Vector3
 
 	_xIndexOffsetCoeff = _gridBoundary.y() * _gridBoundary.z();
 
-	_voxels.resize(this->size());
+	// One more element than the voxel count, so the end of the last voxel is also its next voxel start.
+	_voxelStart.resize(this->size() + 1, 0);
 }
 
 Storm::VoxelGrid::VoxelGrid(Storm::VoxelGrid &&other) = default;
 Storm::VoxelGrid::VoxelGrid(const Storm::VoxelGrid &other) = default;
 Storm::VoxelGrid::~VoxelGrid() = default;
 
-template<bool infiniteDomain>
-void Storm::VoxelGrid::getVoxelsDataAtPosition(float voxelEdgeLength, const Storm::Vector3 &voxelShift, const std::vector<Storm::NeighborParticleReferral>* &outContainingVoxelPtr, const std::vector<Storm::NeighborParticleReferral>*(&outNeighborData)[Storm::k_neighborLinkedBunkCount], const Storm::Vector3 &particlePosition, const Storm::OutReflectedModality* &reflectModality) const
+const Storm::NeighborParticleReferralBundle* Storm::VoxelGrid::getBundleAt(const std::size_t voxelIndex, const std::size_t bundleSlot) const
 {
-	retrieveVoxelsDataAtPositionImpl<infiniteDomain>(*this, voxelEdgeLength, voxelShift, outContainingVoxelPtr, outNeighborData, particlePosition, reflectModality);
+	assert(bundleSlot < Storm::k_neighborLinkedBunkCount && "Bundle slot is out of the thread bundle storage!");
+
+	const Storm::NeighborParticleReferral*const referrals = _referrals.data();
+
+	Storm::NeighborParticleReferralBundle &bundle = g_bundlesPerThread[bundleSlot];
+	bundle = Storm::NeighborParticleReferralBundle{ referrals + _voxelStart[voxelIndex], referrals + _voxelStart[voxelIndex + 1] };
+	return &bundle;
 }
 
-template void Storm::VoxelGrid::getVoxelsDataAtPosition<true>(float, const Storm::Vector3 &, const std::vector<Storm::NeighborParticleReferral>* &, const std::vector<Storm::NeighborParticleReferral>*(&)[Storm::k_neighborLinkedBunkCount], const Storm::Vector3 &, const Storm::OutReflectedModality* &) const;
-template void Storm::VoxelGrid::getVoxelsDataAtPosition<false>(float, const Storm::Vector3 &, const std::vector<Storm::NeighborParticleReferral>* &, const std::vector<Storm::NeighborParticleReferral>*(&)[Storm::k_neighborLinkedBunkCount], const Storm::Vector3 &, const Storm::OutReflectedModality* &) const;
+void Storm::VoxelGrid::getVoxelsDataAtPosition(float voxelEdgeLength, const Storm::Vector3 &voxelShift, const Storm::NeighborParticleReferralBundle* &outContainingVoxelPtr, const Storm::NeighborParticleReferralBundle*(&outNeighborData)[Storm::k_neighborLinkedBunkCount], const Storm::Vector3 &particlePosition) const
+{
+	const Storm::OutReflectedModality* dummy;
+	retrieveVoxelsDataAtPositionImpl<false>(*this, voxelEdgeLength, voxelShift, outContainingVoxelPtr, outNeighborData, particlePosition, dummy);
+}
 
-void Storm::VoxelGrid::getVoxelsDataAtPosition(float voxelEdgeLength, const Storm::Vector3 &voxelShift, const std::vector<Storm::NeighborParticleReferral>* &outContainingVoxelPtr, const Storm::Vector3 &particlePosition) const
+void Storm::VoxelGrid::getVoxelsDataAtPositionInfinite(float voxelEdgeLength, const Storm::Vector3 &voxelShift, const Storm::NeighborParticleReferralBundle* &outContainingVoxelPtr, const Storm::NeighborParticleReferralBundle*(&outNeighborData)[Storm::k_neighborLinkedBunkCount], const Storm::Vector3 &particlePosition, const Storm::OutReflectedModality* &reflectModality) const
+{
+	retrieveVoxelsDataAtPositionImpl<true>(*this, voxelEdgeLength, voxelShift, outContainingVoxelPtr, outNeighborData, particlePosition, reflectModality);
+}
+
+void Storm::VoxelGrid::getVoxelsDataAtPosition(float voxelEdgeLength, const Storm::Vector3 &voxelShift, const Storm::NeighborParticleReferralBundle* &outContainingVoxelPtr, const Storm::Vector3 &particlePosition) const
 {
 	unsigned int xIndex;
 	unsigned int yIndex;
 	unsigned int zIndex;
 
 	const std::size_t voxelIndex = static_cast<std::size_t>(this->computeRawIndexFromPosition(_gridBoundary, voxelEdgeLength, voxelShift, particlePosition, xIndex, yIndex, zIndex));
-	outContainingVoxelPtr = &_voxels[voxelIndex].getData();
+	outContainingVoxelPtr = this->getBundleAt(voxelIndex, k_containingBundleSlot);
+}
+
+void Storm::VoxelGrid::getForwardVoxelsDataAtPosition(float voxelEdgeLength, const Storm::Vector3 &voxelShift, const Storm::NeighborParticleReferralBundle* &outContainingVoxelPtr, const Storm::NeighborParticleReferralBundle*(&outForwardNeighborData)[Storm::k_neighborLinkedBunkCount], const Storm::Vector3 &particlePosition) const
+{
+	retrieveForwardVoxelsDataAtPositionImpl(*this, voxelEdgeLength, voxelShift, outContainingVoxelPtr, outForwardNeighborData, particlePosition);
 }
 
 void Storm::VoxelGrid::fill(float voxelEdgeLength, const Storm::Vector3 &voxelShift, const std::vector<Storm::Vector3> &particlePositions, const unsigned int systemId)
 {
-	unsigned int dummy1;
-	unsigned int dummy2;
-	unsigned int dummy3;
+	// Register the system, reusing the buffers of a system registered before the last clear if any.
+	if (_registeredSystemCount == _registeredSystems.size())
+	{
+		_registeredSystems.emplace_back();
+	}
+
+	Storm::VoxelGrid::RegisteredSystem &registeredSystem = _registeredSystems[_registeredSystemCount++];
+	registeredSystem._systemId = systemId;
+	registeredSystem._updatePrepared = false;
+
+	std::vector<uint32_t> &particleVoxelIndexes = registeredSystem._particleVoxelIndexes;
 
 	const std::size_t particleCount = particlePositions.size();
-	for (std::size_t index = 0; index < particleCount; ++index)
+	if (particleCount == 0)
 	{
-		const std::size_t voxelIndex = static_cast<std::size_t>(this->computeRawIndexFromPosition(_gridBoundary, voxelEdgeLength, voxelShift, particlePositions[index], dummy1, dummy2, dummy3));
-		_voxels[voxelIndex].addParticle(index, systemId);
+		particleVoxelIndexes.clear();
+		return;
 	}
+
+	const std::size_t voxelCount = this->size();
+	const std::size_t totalReferralCount = _referrals.size() + particleCount;
+	if (totalReferralCount > static_cast<std::size_t>(std::numeric_limits<uint32_t>::max()))
+	{
+		Storm::throwException<Storm::Exception>("Too many particles registered inside the voxel grid (" + std::to_string(totalReferralCount) + "). The maximum is " + std::to_string(std::numeric_limits<uint32_t>::max()));
+	}
+
+	// First, find the voxel containing each particle.
+	Storm::setNumUninitialized_safeHijack(particleVoxelIndexes, Storm::VectorHijacker{ particleCount });
+	Storm::runParallel(particlePositions, [this, voxelEdgeLength, &voxelShift, &particleVoxelIndexes](const Storm::Vector3 &position, const std::size_t particleIndex)
+	{
+		unsigned int dummy1;
+		unsigned int dummy2;
+		unsigned int dummy3;
+
+		particleVoxelIndexes[particleIndex] = this->computeRawIndexFromPosition(_gridBoundary, voxelEdgeLength, voxelShift, position, dummy1, dummy2, dummy3);
+	});
+
+	// Then make the histogram of the new particle count inside each voxel...
+	_voxelCursors.assign(voxelCount, 0);
+	Storm::runParallel(particleVoxelIndexes, [this](const uint32_t voxelIndex)
+	{
+		std::atomic_ref<uint32_t>{ _voxelCursors[voxelIndex] }.fetch_add(1, std::memory_order_relaxed);
+	});
+
+	// ... and turn it into the offset of the first new referral of each voxel (if we only had the new referrals).
+	std::exclusive_scan(std::execution::par, std::begin(_voxelCursors), std::end(_voxelCursors), std::begin(_voxelCursors), static_cast<uint32_t>(0));
+
+	// Since the previous referrals precede the new ones, the new start of a voxel is the sum of both offsets. Move the previous referrals to their new place,
+	// and leave the voxel cursor right after them, where the new referrals will be scattered.
+	Storm::setNumUninitialized_safeHijack(_nextVoxelStart, Storm::VectorHijacker{ voxelCount + 1 });
+	Storm::setNumUninitialized_safeHijack(_nextReferrals, Storm::VectorHijacker{ totalReferralCount });
+	Storm::runParallel(_voxelCursors, [this](uint32_t &voxelCursor, const std::size_t voxelIndex)
+	{
+		const uint32_t previousStart = _voxelStart[voxelIndex];
+		const uint32_t previousEnd = _voxelStart[voxelIndex + 1];
+
+		const uint32_t newStart = previousStart + voxelCursor;
+		_nextVoxelStart[voxelIndex] = newStart;
+
+		std::copy(_referrals.data() + previousStart, _referrals.data() + previousEnd, _nextReferrals.data() + newStart);
+
+		voxelCursor = newStart + (previousEnd - previousStart);
+	});
+	_nextVoxelStart[voxelCount] = static_cast<uint32_t>(totalReferralCount);
+
+	std::swap(_voxelStart, _nextVoxelStart);
+	std::swap(_referrals, _nextReferrals);
+
+	// Scatter the new referrals.
+	Storm::runParallel(particleVoxelIndexes, [this, systemId](const uint32_t voxelIndex, const std::size_t particleIndex)
+	{
+		const uint32_t referralIndex = std::atomic_ref<uint32_t>{ _voxelCursors[voxelIndex] }.fetch_add(1, std::memory_order_relaxed);
+		_referrals[referralIndex] = Storm::NeighborParticleReferral{ particleIndex, systemId };
+	});
+
+	// The scatter order inside a voxel depends on the thread scheduling. Sort the new referrals of each voxel by particle index to keep the neighborhood (and therefore the simulation) deterministic.
+	Storm::runParallel(_voxelCursors, [this, systemId](const uint32_t voxelEnd, const std::size_t voxelIndex)
+	{
+		Storm::NeighborParticleReferral*const voxelBegin = _referrals.data() + _voxelStart[voxelIndex];
+		Storm::NeighborParticleReferral*const newReferralsEnd = _referrals.data() + voxelEnd;
+
+		// A system is registered once between 2 clears, so all referrals of this system inside the voxel are the new ones, and they are at the end.
+		Storm::NeighborParticleReferral* newReferralsBegin = newReferralsEnd;
+		while (newReferralsBegin != voxelBegin && (newReferralsBegin - 1)->_systemId == systemId)
+		{
+			--newReferralsBegin;
+		}
+
+		std::sort(newReferralsBegin, newReferralsEnd, [](const Storm::NeighborParticleReferral &left, const Storm::NeighborParticleReferral &right)
+		{
+			return left._particleIndex < right._particleIndex;
+		});
+	});
 }
 
-void Storm::VoxelGrid::clear()
+bool Storm::VoxelGrid::prepareUpdate(float voxelEdgeLength, const Storm::Vector3 &voxelShift, const std::vector<Storm::Vector3> &particlePositions, const unsigned int systemId)
 {
-	for (Storm::Voxel &voxel : _voxels)
+	const std::size_t systemRank = this->findRegisteredSystemRank(systemId);
+	if (systemRank == _registeredSystemCount)
 	{
-		voxel.clear();
+		return false;
 	}
+
+	Storm::VoxelGrid::RegisteredSystem &registeredSystem = _registeredSystems[systemRank];
+
+	const std::size_t particleCount = particlePositions.size();
+	if (registeredSystem._particleVoxelIndexes.size() != particleCount)
+	{
+		return false;
+	}
+
+	// Particles that changed of voxel are appended after the ones of the systems prepared before. Their order depends on the thread scheduling, but they're sorted before being applied.
+	const std::size_t firstMovedParticleIndex = _movedParticles.size();
+	Storm::setNumUninitialized_safeHijack(_movedParticles, Storm::VectorHijacker{ firstMovedParticleIndex + particleCount });
+
+	std::atomic<std::size_t> movedParticleCount{ firstMovedParticleIndex };
+
+	Storm::setNumUninitialized_safeHijack(registeredSystem._updatedParticleVoxelIndexes, Storm::VectorHijacker{ particleCount });
+	Storm::runParallel(particlePositions, [this, voxelEdgeLength, &voxelShift, &registeredSystem, systemRank, &movedParticleCount](const Storm::Vector3 &position, const std::size_t particleIndex)
+	{
+		unsigned int dummy1;
+		unsigned int dummy2;
+		unsigned int dummy3;
+
+		const uint32_t oldVoxelIndex = registeredSystem._particleVoxelIndexes[particleIndex];
+		const uint32_t newVoxelIndex = this->computeRawIndexFromPosition(_gridBoundary, voxelEdgeLength, voxelShift, position, dummy1, dummy2, dummy3);
+
+		registeredSystem._updatedParticleVoxelIndexes[particleIndex] = newVoxelIndex;
+
+		if (newVoxelIndex != oldVoxelIndex)
+		{
+			_movedParticles[movedParticleCount.fetch_add(1, std::memory_order_relaxed)] = Storm::VoxelGrid::MovedParticle{ newVoxelIndex, oldVoxelIndex, systemRank, particleIndex };
+		}
+	});
+
+	_movedParticles.resize(movedParticleCount.load(std::memory_order_relaxed));
+
+	registeredSystem._updatePrepared = true;
+	return true;
+}
+
+bool Storm::VoxelGrid::applyUpdate(float maxMovedParticleRatio)
+{
+	bool canApply = static_cast<float>(_movedParticles.size()) <= maxMovedParticleRatio * static_cast<float>(_referrals.size());
+	for (std::size_t systemRank = 0; systemRank < _registeredSystemCount; ++systemRank)
+	{
+		Storm::VoxelGrid::RegisteredSystem &registeredSystem = _registeredSystems[systemRank];
+		canApply &= registeredSystem._updatePrepared;
+		registeredSystem._updatePrepared = false;
+	}
+
+	if (!canApply)
+	{
+		_movedParticles.clear();
+		return false;
+	}
+
+	// From now, the updated voxel indexes are the current ones.
+	for (std::size_t systemRank = 0; systemRank < _registeredSystemCount; ++systemRank)
+	{
+		Storm::VoxelGrid::RegisteredSystem &registeredSystem = _registeredSystems[systemRank];
+		std::swap(registeredSystem._particleVoxelIndexes, registeredSystem._updatedParticleVoxelIndexes);
+	}
+
+	if (_movedParticles.empty())
+	{
+		return true;
+	}
+
+	// Sort the moved particles by the voxel they enter, so the particles entering a voxel are contiguous and already in the order they should have inside it.
+	std::sort(std::execution::par, std::begin(_movedParticles), std::end(_movedParticles), [](const Storm::VoxelGrid::MovedParticle &left, const Storm::VoxelGrid::MovedParticle &right)
+	{
+		return left._newVoxelIndex < right._newVoxelIndex || (left._newVoxelIndex == right._newVoxelIndex && isReferralBefore(left._systemRank, left._particleIndex, right._systemRank, right._particleIndex));
+	});
+
+	// Compute the new particle count inside each voxel, and flag the voxels that a particle left or entered.
+	const std::size_t voxelCount = this->size();
+
+	Storm::setNumUninitialized_safeHijack(_voxelCursors, Storm::VectorHijacker{ voxelCount });
+	Storm::runParallel(_voxelCursors, [this](uint32_t &voxelCursor, const std::size_t voxelIndex)
+	{
+		voxelCursor = _voxelStart[voxelIndex + 1] - _voxelStart[voxelIndex];
+	});
+
+	_dirtyVoxels.assign(voxelCount, 0);
+	for (const Storm::VoxelGrid::MovedParticle &movedParticle : _movedParticles)
+	{
+		--_voxelCursors[movedParticle._oldVoxelIndex];
+		++_voxelCursors[movedParticle._newVoxelIndex];
+
+		_dirtyVoxels[movedParticle._oldVoxelIndex] = 1;
+		_dirtyVoxels[movedParticle._newVoxelIndex] = 1;
+	}
+
+	const std::size_t totalReferralCount = _referrals.size();
+
+	Storm::setNumUninitialized_safeHijack(_nextVoxelStart, Storm::VectorHijacker{ voxelCount + 1 });
+	std::exclusive_scan(std::execution::par, std::begin(_voxelCursors), std::end(_voxelCursors), std::begin(_nextVoxelStart), static_cast<uint32_t>(0));
+	_nextVoxelStart[voxelCount] = static_cast<uint32_t>(totalReferralCount);
+
+	// Untouched voxels are copied as is. The dirty ones are the merge of the referrals that stayed and the ones that entered, both being already sorted.
+	Storm::setNumUninitialized_safeHijack(_nextReferrals, Storm::VectorHijacker{ totalReferralCount });
+	Storm::runParallel(_dirtyVoxels, [this](const uint8_t isDirty, const std::size_t voxelIndex)
+	{
+		const Storm::NeighborParticleReferral* previousIter = _referrals.data() + _voxelStart[voxelIndex];
+		const Storm::NeighborParticleReferral*const previousEnd = _referrals.data() + _voxelStart[voxelIndex + 1];
+
+		Storm::NeighborParticleReferral* nextIter = _nextReferrals.data() + _nextVoxelStart[voxelIndex];
+
+		if (!isDirty)
+		{
+			std::copy(previousIter, previousEnd, nextIter);
+			return;
+		}
+
+		const uint32_t voxelIndexU32 = static_cast<uint32_t>(voxelIndex);
+
+		auto enteringIter = std::lower_bound(std::begin(_movedParticles), std::end(_movedParticles), voxelIndexU32, [](const Storm::VoxelGrid::MovedParticle &movedParticle, const uint32_t value)
+		{
+			return movedParticle._newVoxelIndex < value;
+		});
+		const auto enteringEnd = std::end(_movedParticles);
+
+		std::size_t previousSystemRank = 0;
+		unsigned int previousSystemId = _registeredSystems[0]._systemId;
+
+		for (; previousIter != previousEnd; ++previousIter)
+		{
+			if (previousIter->_systemId != previousSystemId)
+			{
+				previousSystemId = previousIter->_systemId;
+				previousSystemRank = this->findRegisteredSystemRank(previousSystemId);
+			}
+
+			// The particle left this voxel.
+			if (_registeredSystems[previousSystemRank]._particleVoxelIndexes[previousIter->_particleIndex] != voxelIndexU32)
+			{
+				continue;
+			}
+
+			for (; enteringIter != enteringEnd && enteringIter->_newVoxelIndex == voxelIndexU32 && isReferralBefore(enteringIter->_systemRank, enteringIter->_particleIndex, previousSystemRank, previousIter->_particleIndex); ++enteringIter, ++nextIter)
+			{
+				*nextIter = Storm::NeighborParticleReferral{ enteringIter->_particleIndex, _registeredSystems[enteringIter->_systemRank]._systemId };
+			}
+
+			*nextIter = *previousIter;
+			++nextIter;
+		}
+
+		for (; enteringIter != enteringEnd && enteringIter->_newVoxelIndex == voxelIndexU32; ++enteringIter, ++nextIter)
+		{
+			*nextIter = Storm::NeighborParticleReferral{ enteringIter->_particleIndex, _registeredSystems[enteringIter->_systemRank]._systemId };
+		}
+
+		assert(nextIter == _nextReferrals.data() + _nextVoxelStart[voxelIndex + 1] && "The patched voxel doesn't have the expected referral count!");
+	});
+
+	std::swap(_voxelStart, _nextVoxelStart);
+	std::swap(_referrals, _nextReferrals);
+
+	_movedParticles.clear();
+	return true;
+}
+
+void Storm::VoxelGrid::invalidateUpdate()
+{
+	// The systems remain registered (their referrals are still inside the grid), but they cannot match their particle count anymore, therefore they cannot be updated until the next clear.
+	for (std::size_t systemRank = 0; systemRank < _registeredSystemCount; ++systemRank)
+	{
+		Storm::VoxelGrid::RegisteredSystem &registeredSystem = _registeredSystems[systemRank];
+		registeredSystem._particleVoxelIndexes.clear();
+		registeredSystem._updatePrepared = false;
+	}
+
+	_movedParticles.clear();
+}
+
+void Storm::VoxelGrid::prepareQueries()
+{
+
+}
+
+std::size_t Storm::VoxelGrid::findRegisteredSystemRank(const unsigned int systemId) const
+{
+	// There are only a few systems, a linear search is enough.
+	std::size_t systemRank = 0;
+	while (systemRank < _registeredSystemCount && _registeredSystems[systemRank]._systemId != systemId)
+	{
+		++systemRank;
+	}
+
+	return systemRank;
+}
+
+void Storm::VoxelGrid::clear()
+{
+	std::fill(std::begin(_voxelStart), std::end(_voxelStart), 0);
+	_referrals.clear();
+	_registeredSystemCount = 0;
+	_movedParticles.clear();
 }
 
 std::size_t Storm::VoxelGrid::size() const
@@ -103,7 +431,59 @@ unsigned int Storm::VoxelGrid::computeRawIndexFromPosition(const Storm::Vector3u
 	return result;
 }
 
-std::vector<Storm::Voxel*> Storm::VoxelGrid::getVoxelsUnderRaycast(const Storm::Vector3 &/*origin*/, const Storm::Vector3 &/*direction*/, const float /*minDist*/, const float /*maxDist*/, const float /*voxelEdgeLength*/) const
+void Storm::VoxelGrid::traverseVoxelsUnderRaycast(const Storm::Vector3 &origin, const Storm::Vector3 &direction, const float minDist, const float maxDist, const float rayRadius, const float voxelEdgeLength, const Storm::Vector3 &voxelShift, const Storm::ISpacePartition::RaycastVoxelVisitor &visitor) const
+{
+	traverseVoxelsUnderRaycastImpl(*this, origin, direction, minDist, maxDist, rayRadius, voxelEdgeLength, voxelShift, visitor);
+}
+
+void Storm::VoxelGrid::traverseVoxelsInsideBox(const Storm::Vector3 &minCorner, const Storm::Vector3 &maxCorner, const float voxelEdgeLength, const Storm::Vector3 &voxelShift, const Storm::ISpacePartition::BoxVoxelVisitor &visitor) const
+{
+	traverseVoxelsInsideBoxImpl(*this, minCorner, maxCorner, voxelEdgeLength, voxelShift, visitor);
+}
+
+std::vector<Storm::NeighborParticleReferralBundle> Storm::VoxelGrid::getVoxelsUnderRaycast(const Storm::Vector3 &origin, const Storm::Vector3 &direction, const float minDist, const float maxDist, const float voxelEdgeLength, const Storm::Vector3 &voxelShift) const
+{
+	std::vector<Storm::NeighborParticleReferralBundle> result;
+
+	this->traverseVoxelsUnderRaycast(origin, direction, minDist, maxDist, 0.f, voxelEdgeLength, voxelShift, [&result](const Storm::NeighborParticleReferralBundle &bundle, const float)
+	{
+		if (!bundle.empty())
+		{
+			result.emplace_back(bundle);
+		}
+
+		return true;
+	});
+
+	return result;
+}
+
+std::size_t Storm::VoxelGrid::getAllocatedMemorySize() const
+{
+	std::size_t result = sizeof(Storm::VoxelGrid) +
+		(_voxelStart.capacity() + _voxelCursors.capacity() + _nextVoxelStart.capacity()) * sizeof(uint32_t) +
+		(_referrals.capacity() + _nextReferrals.capacity()) * sizeof(Storm::NeighborParticleReferral) +
+		_movedParticles.capacity() * sizeof(Storm::VoxelGrid::MovedParticle) +
+		_dirtyVoxels.capacity() * sizeof(uint8_t) +
+		_registeredSystems.capacity() * sizeof(Storm::VoxelGrid::RegisteredSystem);
+
+	for (const Storm::VoxelGrid::RegisteredSystem &registeredSystem : _registeredSystems)
+	{
+		result += (registeredSystem._particleVoxelIndexes.capacity() + registeredSystem._updatedParticleVoxelIndexes.capacity()) * sizeof(uint32_t);
+	}
+
+	return result;
+}
+
+std::vector<unsigned int> Storm::VoxelGrid::getRegisteredSystemIds() const
 {
-	STORM_NOT_IMPLEMENTED;
+	std::vector<unsigned int> result;
+	result.reserve(_registeredSystemCount);
+
+	for (std::size_t systemRank = 0; systemRank < _registeredSystemCount; ++systemRank)
+	{
+		result.emplace_back(_registeredSystems[systemRank]._systemId);
+	}
+
+	return result;
 }
@@ -1,15 +1,14 @@
 #pragma once
 
-#include "SpacePartitionConstants.h"
+#include "ISpacePartition.h"
 
 
 namespace Storm
 {
-	class Voxel;
 	struct NeighborParticleReferral;
-	class OutReflectedModality;
 
-	class VoxelGrid
+	// The dense space partition : every voxel of the domain exists, even empty. This is the fastest to query, but its memory grows with the domain volume.
+	class VoxelGrid : public Storm::ISpacePartition
 	{
 	public:
 		VoxelGrid(const Storm::Vector3 &upCorner, const Storm::Vector3 &downCorner, float voxelEdgeLength);
@@ -18,18 +17,39 @@ namespace Storm
 		~VoxelGrid();
 
 	public:
-		template<bool infiniteDomain> void getVoxelsDataAtPosition(float voxelEdgeLength, const Storm::Vector3 &voxelShift, const std::vector<Storm::NeighborParticleReferral>* &outContainingVoxelPtr, const std::vector<Storm::NeighborParticleReferral>*(&outNeighborData)[Storm::k_neighborLinkedBunkCount], const Storm::Vector3 &particlePosition, const Storm::OutReflectedModality* &reflectModality) const;
-		void getVoxelsDataAtPosition(float voxelEdgeLength, const Storm::Vector3 &voxelShift, const std::vector<Storm::NeighborParticleReferral>* &outContainingVoxelPtr, const Storm::Vector3 &particlePosition) const;
+		void getVoxelsDataAtPosition(float voxelEdgeLength, const Storm::Vector3 &voxelShift, const Storm::NeighborParticleReferralBundle* &outContainingVoxelPtr, const Storm::NeighborParticleReferralBundle*(&outNeighborData)[Storm::k_neighborLinkedBunkCount], const Storm::Vector3 &particlePosition) const final override;
+		void getVoxelsDataAtPositionInfinite(float voxelEdgeLength, const Storm::Vector3 &voxelShift, const Storm::NeighborParticleReferralBundle* &outContainingVoxelPtr, const Storm::NeighborParticleReferralBundle*(&outNeighborData)[Storm::k_neighborLinkedBunkCount], const Storm::Vector3 &particlePosition, const Storm::OutReflectedModality* &reflectModality) const final override;
+		void getVoxelsDataAtPosition(float voxelEdgeLength, const Storm::Vector3 &voxelShift, const Storm::NeighborParticleReferralBundle* &outContainingVoxelPtr, const Storm::Vector3 &particlePosition) const final override;
+		void getForwardVoxelsDataAtPosition(float voxelEdgeLength, const Storm::Vector3 &voxelShift, const Storm::NeighborParticleReferralBundle* &outContainingVoxelPtr, const Storm::NeighborParticleReferralBundle*(&outForwardNeighborData)[Storm::k_neighborLinkedBunkCount], const Storm::Vector3 &particlePosition) const final override;
 
-		void fill(float voxelEdgeLength, const Storm::Vector3 &voxelShift, const std::vector<Storm::Vector3> &particlePositions, const unsigned int systemId);
+		// The rebuild is done in parallel : a histogram of the particle count per voxel, a prefix sum to find where each voxel starts, then a scatter of the referrals.
+		void fill(float voxelEdgeLength, const Storm::Vector3 &voxelShift, const std::vector<Storm::Vector3> &particlePositions, const unsigned int systemId) final override;
+
+		// Incremental update of a system registered with fill since the last clear. It computes in parallel the voxel of each particle and keeps the ones that changed of voxel since the last fill or update.
+		// Returns false if it isn't possible (the system wasn't registered, its particle count changed or invalidateUpdate was called), in which case a full rebuild (clear then fill) is needed.
+		bool prepareUpdate(float voxelEdgeLength, const Storm::Vector3 &voxelShift, const std::vector<Storm::Vector3> &particlePositions, const unsigned int systemId) final override;
+
+		// Apply the changes found by prepareUpdate (which should have been called for all registered systems). Only the voxels that particles left or entered are patched, the other are copied as is.
+		// The referrals inside each voxel are kept in the same order than a full rebuild would produce. Returns false (and changes nothing) if the moved particle count is above maxMovedParticleRatio of all referrals,
+		// or if a registered system wasn't prepared. In this case, a full rebuild is needed.
+		bool applyUpdate(float maxMovedParticleRatio) final override;
+
+		// Forget the voxels the particles were in, to force the next update to fail until the next clear. It should be called when the particle indexes changed without changing their count (reordering).
+		void invalidateUpdate() final override;
+
+		// Nothing to do, the voxels are ready to be queried as soon as they're filled or updated.
+		void prepareQueries() final override;
 
 		// Beware, this clear all data inside all voxels but not the voxels themselves (the space would remains partitioned, but without any particle inside).
 		// To reset the partitioning, you must create a new VoxelGrid.
-		void clear();
+		void clear() final override;
 
 		std::size_t size() const;
 
-		__forceinline const std::vector<Storm::Voxel>& getVoxels() const noexcept { return _voxels; }
+		// Returns the bundle of the voxel at voxelIndex. The bundle is a view stored inside the calling thread storage at bundleSlot (must be less than Storm::k_neighborLinkedBunkCount),
+		// therefore it remains valid until this thread asks another bundle for the same slot, or until the grid is modified.
+		const Storm::NeighborParticleReferralBundle* getBundleAt(const std::size_t voxelIndex, const std::size_t bundleSlot) const;
+
 		__forceinline const Storm::Vector3ui& getGridBoundary() const noexcept { return _gridBoundary; }
 
 	public:
@@ -38,14 +58,59 @@ namespace Storm
 		unsigned int computeRawIndexFromPosition(const Storm::Vector3ui &maxValue, const float voxelEdgeLength, const Storm::Vector3 &voxelShift, const Storm::Vector3 &position, unsigned int &outXIndex, unsigned int &outYIndex, unsigned int &outZIndex) const;
 
 	public:
-		std::vector<Storm::Voxel*> getVoxelsUnderRaycast(const Storm::Vector3 &origin, const Storm::Vector3 &direction, const float minDist, const float maxDist, const float voxelEdgeLength) const;
+		// 3D-DDA traversal from Amanatides and Woo. Only the voxels crossed (and their neighbors near an inflated ray) are visited, so it is linear to the ray length instead of the voxel count.
+		void traverseVoxelsUnderRaycast(const Storm::Vector3 &origin, const Storm::Vector3 &direction, const float minDist, const float maxDist, const float rayRadius, const float voxelEdgeLength, const Storm::Vector3 &voxelShift, const Storm::ISpacePartition::RaycastVoxelVisitor &visitor) const final override;
+		void traverseVoxelsInsideBox(const Storm::Vector3 &minCorner, const Storm::Vector3 &maxCorner, const float voxelEdgeLength, const Storm::Vector3 &voxelShift, const Storm::ISpacePartition::BoxVoxelVisitor &visitor) const final override;
+		std::vector<Storm::NeighborParticleReferralBundle> getVoxelsUnderRaycast(const Storm::Vector3 &origin, const Storm::Vector3 &direction, const float minDist, const float maxDist, const float voxelEdgeLength, const Storm::Vector3 &voxelShift) const;
+
+		std::vector<unsigned int> getRegisteredSystemIds() const final override;
+
+		std::size_t getAllocatedMemorySize() const final override;
+
+	public:
+		struct RegisteredSystem
+		{
+		public:
+			unsigned int _systemId;
+			bool _updatePrepared;
+
+			// The voxel each particle of the system was in at the last fill or update.
+			std::vector<uint32_t> _particleVoxelIndexes;
+			std::vector<uint32_t> _updatedParticleVoxelIndexes;
+		};
+
+		struct MovedParticle
+		{
+		public:
+			uint32_t _newVoxelIndex;
+			uint32_t _oldVoxelIndex;
+			std::size_t _systemRank; // Index of the system inside _registeredSystems.
+			std::size_t _particleIndex;
+		};
+
+	private:
+		std::size_t findRegisteredSystemRank(const unsigned int systemId) const;
 
 	private:
 		Storm::Vector3ui _gridBoundary;
 
 		unsigned int _xIndexOffsetCoeff;
 
-		// The raw buffer of voxel elements. It is ordered by x, then by y and finally by z.
-		std::vector<Storm::Voxel> _voxels;
+		// The voxels are stored in a compressed way, they are ordered by x, then by y and finally by z.
+		// The referrals of the voxel at index i are inside _referrals, from _voxelStart[i] (included) to _voxelStart[i + 1] (excluded).
+		std::vector<uint32_t> _voxelStart;
+		std::vector<Storm::NeighborParticleReferral> _referrals;
+
+		// The systems registered since the last clear, in their registration order (this is also their order inside each voxel).
+		// Only the first _registeredSystemCount are valid, we keep the other to not reallocate their buffers.
+		std::vector<Storm::VoxelGrid::RegisteredSystem> _registeredSystems;
+		std::size_t _registeredSystemCount;
+
+		// Scratch buffers used by the rebuild and the update. We keep them to not reallocate them each time the grid is refilled.
+		std::vector<uint32_t> _voxelCursors;
+		std::vector<uint32_t> _nextVoxelStart;
+		std::vector<Storm::NeighborParticleReferral> _nextReferrals;
+		std::vector<Storm::VoxelGrid::MovedParticle> _movedParticles;
+		std::vector<uint8_t> _dirtyVoxels;
 	};
 }
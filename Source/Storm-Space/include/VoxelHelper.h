@@ -248,8 +248,14 @@ namespace
 		}
 	}
 
-	template<bool infiniteDomain = false, class VoxelType, class VoxelData>
-	static void retrieveVoxelsDataAtPositionImpl(const VoxelType &voxel, float voxelEdgeLength, const Storm::Vector3 &voxelShift, const std::vector<VoxelData>* &outContainingVoxelPtr, const std::vector<VoxelData>*(&outNeighborData)[Storm::k_neighborLinkedBunkCount], const Storm::Vector3 &particlePosition, const Storm::OutReflectedModality* &reflectModality)
+	enum : std::size_t
+	{
+		// The neighbor bundles use at most k_neighborLinkedBunkCount - 1 slots (the last pointer is the nullptr end marker), so the last slot is free to hold the containing bundle.
+		k_containingBundleSlot = Storm::k_neighborLinkedBunkCount - 1
+	};
+
+	template<bool infiniteDomain = false, class VoxelType, class BundleType>
+	static void retrieveVoxelsDataAtPositionImpl(const VoxelType &voxel, float voxelEdgeLength, const Storm::Vector3 &voxelShift, const BundleType* &outContainingVoxelPtr, const BundleType*(&outNeighborData)[Storm::k_neighborLinkedBunkCount], const Storm::Vector3 &particlePosition, const Storm::OutReflectedModality* &reflectModality)
 	{
 		thread_local Storm::OutReflectedModality reflectedModalityPerThread;
 		reflectModality = &reflectedModalityPerThread;
@@ -260,12 +266,10 @@ namespace
 
 		const auto &gridBoundary = voxel.getGridBoundary();
 
-		const auto &voxels = voxel.getVoxels();
-
 		const std::size_t voxelIndex = static_cast<std::size_t>(voxel.computeRawIndexFromPosition(gridBoundary, voxelEdgeLength, voxelShift, particlePosition, xIndex, yIndex, zIndex));
-		outContainingVoxelPtr = &voxels[voxelIndex].getData();
+		outContainingVoxelPtr = voxel.getBundleAt(voxelIndex, k_containingBundleSlot);
 
-		const std::vector<VoxelData>** iter = std::begin(outNeighborData);
+		const BundleType** iter = std::begin(outNeighborData);
 
 		const unsigned int xIndexBefore = xIndex - 1;
 		const unsigned int yIndexBefore = yIndex - 1;
@@ -290,7 +294,7 @@ Storm::OutReflectedModalityEnum* reflectedModalityIter;																					\
 reflectedModalityPerThread._summary = static_cast<Storm::OutReflectedModalityEnum>(MakeSummaryReflectedComposeFrom::caseFlag)
 
 #define STORM_ATTRIBUTE_VALUES_TO_NEIGHBOR_DATA_ITERATOR(xIndex, yIndex, zIndex) \
-*iter = &voxels[voxel.computeRawIndexFromCoordIndex(xIndex, yIndex, zIndex)].getData(); \
+*iter = voxel.getBundleAt(voxel.computeRawIndexFromCoordIndex(xIndex, yIndex, zIndex), static_cast<std::size_t>(iter - outNeighborData)); \
 ++iter
 
 #define STORM_ATTRIBUTE_VALUES_TO_NEIGHBOR_DATA_ITERATOR_REFLECTED(xIndex, yIndex, zIndex, reflectionModalityFlag) \
@@ -1485,6 +1489,285 @@ STORM_ATTRIBUTE_VALUES_TO_NEIGHBOR_DATA_ITERATOR(xIndex, yIndex, zIndex); \
 		// The next iterator should always be a nullptr to stop the loop. Since we have 1 more pointer than the maximum logically possible, we shouldn't trigger any sigsegv...
 		*iter = nullptr;
 	}
+
+	// The 13 neighbor voxel offsets that are after the containing voxel in the lexicographic (x, y, z) order. The other 13 are their opposites.
+	// If each voxel only looks at itself and at those neighbors, each pair of neighbor voxels is considered only once.
+	constexpr int k_forwardNeighborVoxelOffsets[13][3] =
+	{
+		{ 1, -1, -1 }, { 1, -1, 0 }, { 1, -1, 1 },
+		{ 1, 0, -1 }, { 1, 0, 0 }, { 1, 0, 1 },
+		{ 1, 1, -1 }, { 1, 1, 0 }, { 1, 1, 1 },
+
+		{ 0, 1, -1 }, { 0, 1, 0 }, { 0, 1, 1 },
+
+		{ 0, 0, 1 },
+	};
+
+	// Like retrieveVoxelsDataAtPositionImpl, but outForwardNeighborData only receives the forward neighbors (see k_forwardNeighborVoxelOffsets) inside the domain (no reflection), followed by a nullptr.
+	template<class VoxelType, class BundleType>
+	static void retrieveForwardVoxelsDataAtPositionImpl(const VoxelType &voxel, float voxelEdgeLength, const Storm::Vector3 &voxelShift, const BundleType* &outContainingVoxelPtr, const BundleType*(&outForwardNeighborData)[Storm::k_neighborLinkedBunkCount], const Storm::Vector3 &particlePosition)
+	{
+		unsigned int xIndex;
+		unsigned int yIndex;
+		unsigned int zIndex;
+
+		const auto &gridBoundary = voxel.getGridBoundary();
+
+		const std::size_t voxelIndex = static_cast<std::size_t>(voxel.computeRawIndexFromPosition(gridBoundary, voxelEdgeLength, voxelShift, particlePosition, xIndex, yIndex, zIndex));
+		outContainingVoxelPtr = voxel.getBundleAt(voxelIndex, k_containingBundleSlot);
+
+		const BundleType** iter = std::begin(outForwardNeighborData);
+		for (const int (&offset)[3] : k_forwardNeighborVoxelOffsets)
+		{
+			// Unsigned wrapping makes the index before 0 greater than the boundary, so one check is enough for both sides.
+			const unsigned int neighborXIndex = xIndex + offset[0];
+			const unsigned int neighborYIndex = yIndex + offset[1];
+			const unsigned int neighborZIndex = zIndex + offset[2];
+			if (neighborXIndex < gridBoundary.x() && neighborYIndex < gridBoundary.y() && neighborZIndex < gridBoundary.z())
+			{
+				*iter = voxel.getBundleAt(voxel.computeRawIndexFromCoordIndex(neighborXIndex, neighborYIndex, neighborZIndex), static_cast<std::size_t>(iter - outForwardNeighborData));
+				++iter;
+			}
+		}
+
+		*iter = nullptr;
+	}
+
+	// Clip the ray segment between enterDist and exitDist to the axis aligned box (slab test). Returns false if the segment misses the box.
+	static bool clipRayToBox(const Storm::Vector3 &origin, const Storm::Vector3 &direction, const Storm::Vector3 &boxMin, const Storm::Vector3 &boxMax, float &enterDist, float &exitDist)
+	{
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			if (direction[axis] == 0.f)
+			{
+				if (origin[axis] < boxMin[axis] || origin[axis] >= boxMax[axis])
+				{
+					return false;
+				}
+			}
+			else
+			{
+				const float invDirection = 1.f / direction[axis];
+
+				float slabEnterDist = (boxMin[axis] - origin[axis]) * invDirection;
+				float slabExitDist = (boxMax[axis] - origin[axis]) * invDirection;
+				if (slabEnterDist > slabExitDist)
+				{
+					std::swap(slabEnterDist, slabExitDist);
+				}
+
+				enterDist = std::max(enterDist, slabEnterDist);
+				exitDist = std::min(exitDist, slabExitDist);
+			}
+		}
+
+		return enterDist <= exitDist;
+	}
+
+	// Visit the voxels crossed by the ray (direction should be normalized) between minDist and maxDist, in the order the ray crosses them (3D-DDA traversal from Amanatides and Woo).
+	// If rayRadius is not 0, the neighbors of the crossed voxels whose box inflated by rayRadius is crossed by the ray are visited too, right after the crossed voxel they neighbor
+	// (and receive its enter distance). Since rayRadius cannot exceed the voxel edge length, those are all the voxels nearer than rayRadius from the ray.
+	template<class VoxelType, class VisitorFunc>
+	static void traverseVoxelsUnderRaycastImpl(const VoxelType &voxel, const Storm::Vector3 &origin, const Storm::Vector3 &direction, const float minDist, const float maxDist, const float rayRadius, const float voxelEdgeLength, const Storm::Vector3 &voxelShift, const VisitorFunc &visitor)
+	{
+		if (rayRadius < 0.f || rayRadius > voxelEdgeLength)
+		{
+			Storm::throwException<Storm::Exception>("The ray radius (" + std::to_string(rayRadius) + ") should be positive and not exceed the voxel edge length (" + std::to_string(voxelEdgeLength) + ")!");
+		}
+
+		const auto &gridBoundary = voxel.getGridBoundary();
+		const bool inflatedRay = rayRadius > 0.f;
+
+		constexpr float k_infinity = std::numeric_limits<float>::infinity();
+
+		const Storm::Vector3 rayRadiusVect{ rayRadius, rayRadius, rayRadius };
+		const Storm::Vector3 gridMin = voxelShift;
+		const Storm::Vector3 gridMax{
+			gridMin.x() + static_cast<float>(gridBoundary.x()) * voxelEdgeLength,
+			gridMin.y() + static_cast<float>(gridBoundary.y()) * voxelEdgeLength,
+			gridMin.z() + static_cast<float>(gridBoundary.z()) * voxelEdgeLength
+		};
+
+		// First, clip the ray to the partitioned space (inflated by the ray radius).
+		float enterDist = minDist;
+		float exitDist = maxDist;
+		if (!clipRayToBox(origin, direction, gridMin - rayRadiusVect, gridMax + rayRadiusVect, enterDist, exitDist))
+		{
+			return;
+		}
+
+		// Then, walk the voxels, each step going to the next voxel boundary the ray crosses.
+		// An inflated ray can travel along the outside of the grid while still being near its border voxels, so we walk one layer of virtual voxels around the grid in this case.
+		const int minWalkCoord = inflatedRay ? -1 : 0;
+		int maxWalkCoord[3];
+
+		int voxelCoord[3];
+		int step[3];
+		float nextBoundaryDist[3];
+		float boundaryDistDelta[3];
+
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			maxWalkCoord[axis] = static_cast<int>(gridBoundary[axis]) - (inflatedRay ? 0 : 1);
+			const float enterPosition = origin[axis] + enterDist * direction[axis];
+
+			voxelCoord[axis] = std::clamp(static_cast<int>(std::floor((enterPosition - voxelShift[axis]) / voxelEdgeLength)), minWalkCoord, maxWalkCoord[axis]);
+
+			if (direction[axis] > 0.f)
+			{
+				step[axis] = 1;
+				nextBoundaryDist[axis] = (voxelShift[axis] + static_cast<float>(voxelCoord[axis] + 1) * voxelEdgeLength - origin[axis]) / direction[axis];
+				boundaryDistDelta[axis] = voxelEdgeLength / direction[axis];
+			}
+			else if (direction[axis] < 0.f)
+			{
+				step[axis] = -1;
+				nextBoundaryDist[axis] = (voxelShift[axis] + static_cast<float>(voxelCoord[axis]) * voxelEdgeLength - origin[axis]) / direction[axis];
+				boundaryDistDelta[axis] = -voxelEdgeLength / direction[axis];
+			}
+			else
+			{
+				step[axis] = 0;
+				nextBoundaryDist[axis] = k_infinity;
+				boundaryDistDelta[axis] = k_infinity;
+			}
+		}
+
+		const auto isInsideGrid = [&gridBoundary](const int(&coord)[3])
+		{
+			return
+				coord[0] >= 0 && coord[0] < static_cast<int>(gridBoundary.x()) &&
+				coord[1] >= 0 && coord[1] < static_cast<int>(gridBoundary.y()) &&
+				coord[2] >= 0 && coord[2] < static_cast<int>(gridBoundary.z());
+		};
+
+		int previousVoxelCoord[3];
+		bool hasPreviousVoxel = false;
+
+		float voxelEnterDist = enterDist;
+		for (;;)
+		{
+			if (!inflatedRay)
+			{
+				const std::size_t voxelIndex = static_cast<std::size_t>(voxel.computeRawIndexFromCoordIndex(voxelCoord[0], voxelCoord[1], voxelCoord[2]));
+				if (!visitor(*voxel.getBundleAt(voxelIndex, k_containingBundleSlot), voxelEnterDist))
+				{
+					return;
+				}
+			}
+			else
+			{
+				// The crossed voxel coordinates are monotonic on each axis, so a neighbor of an already crossed voxel is a neighbor of the previous crossed voxel, and was visited with it.
+				// This also includes the crossed voxel itself, since it neighbors the previous one.
+				int neighborCoord[3];
+				for (neighborCoord[0] = voxelCoord[0] - 1; neighborCoord[0] <= voxelCoord[0] + 1; ++neighborCoord[0])
+				{
+					for (neighborCoord[1] = voxelCoord[1] - 1; neighborCoord[1] <= voxelCoord[1] + 1; ++neighborCoord[1])
+					{
+						for (neighborCoord[2] = voxelCoord[2] - 1; neighborCoord[2] <= voxelCoord[2] + 1; ++neighborCoord[2])
+						{
+							if (!isInsideGrid(neighborCoord))
+							{
+								continue;
+							}
+
+							if (hasPreviousVoxel &&
+								std::abs(neighborCoord[0] - previousVoxelCoord[0]) <= 1 &&
+								std::abs(neighborCoord[1] - previousVoxelCoord[1]) <= 1 &&
+								std::abs(neighborCoord[2] - previousVoxelCoord[2]) <= 1)
+							{
+								continue;
+							}
+
+							const Storm::Vector3 neighborMin{
+								gridMin.x() + static_cast<float>(neighborCoord[0]) * voxelEdgeLength,
+								gridMin.y() + static_cast<float>(neighborCoord[1]) * voxelEdgeLength,
+								gridMin.z() + static_cast<float>(neighborCoord[2]) * voxelEdgeLength
+							};
+							const Storm::Vector3 neighborMax = neighborMin + Storm::Vector3{ voxelEdgeLength, voxelEdgeLength, voxelEdgeLength };
+
+							float neighborEnterDist = minDist;
+							float neighborExitDist = maxDist;
+							if (!clipRayToBox(origin, direction, neighborMin - rayRadiusVect, neighborMax + rayRadiusVect, neighborEnterDist, neighborExitDist))
+							{
+								continue;
+							}
+
+							const std::size_t voxelIndex = static_cast<std::size_t>(voxel.computeRawIndexFromCoordIndex(neighborCoord[0], neighborCoord[1], neighborCoord[2]));
+							if (!visitor(*voxel.getBundleAt(voxelIndex, k_containingBundleSlot), voxelEnterDist))
+							{
+								return;
+							}
+						}
+					}
+				}
+
+				std::copy(std::begin(voxelCoord), std::end(voxelCoord), std::begin(previousVoxelCoord));
+				hasPreviousVoxel = true;
+			}
+
+			int nextAxis = nextBoundaryDist[0] < nextBoundaryDist[1] ? 0 : 1;
+			if (nextBoundaryDist[2] < nextBoundaryDist[nextAxis])
+			{
+				nextAxis = 2;
+			}
+
+			if (nextBoundaryDist[nextAxis] > exitDist)
+			{
+				return;
+			}
+
+			voxelCoord[nextAxis] += step[nextAxis];
+			if (voxelCoord[nextAxis] < minWalkCoord || voxelCoord[nextAxis] > maxWalkCoord[nextAxis])
+			{
+				return;
+			}
+
+			voxelEnterDist = nextBoundaryDist[nextAxis];
+			nextBoundaryDist[nextAxis] += boundaryDistDelta[nextAxis];
+		}
+	}
+
+	// Visit the voxels overlapping the axis aligned box between minCorner and maxCorner (the part of the box outside the partitioned space is ignored).
+	template<class VoxelType, class VisitorFunc>
+	static void traverseVoxelsInsideBoxImpl(const VoxelType &voxel, const Storm::Vector3 &minCorner, const Storm::Vector3 &maxCorner, const float voxelEdgeLength, const Storm::Vector3 &voxelShift, const VisitorFunc &visitor)
+	{
+		const auto &gridBoundary = voxel.getGridBoundary();
+
+		int minCoord[3];
+		int maxCoord[3];
+
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			const float gridMin = voxelShift[axis];
+			const float gridMax = gridMin + static_cast<float>(gridBoundary[axis]) * voxelEdgeLength;
+			if (maxCorner[axis] < gridMin || minCorner[axis] >= gridMax || minCorner[axis] > maxCorner[axis])
+			{
+				return;
+			}
+
+			// Clamp before converting to int since the corners can be very far outside the grid (i.e. to visit the whole grid).
+			const float maxGridCoord = static_cast<float>(gridBoundary[axis] - 1);
+			minCoord[axis] = static_cast<int>(std::clamp(std::floor((minCorner[axis] - gridMin) / voxelEdgeLength), 0.f, maxGridCoord));
+			maxCoord[axis] = static_cast<int>(std::clamp(std::floor((maxCorner[axis] - gridMin) / voxelEdgeLength), 0.f, maxGridCoord));
+		}
+
+		for (int xIndex = minCoord[0]; xIndex <= maxCoord[0]; ++xIndex)
+		{
+			for (int yIndex = minCoord[1]; yIndex <= maxCoord[1]; ++yIndex)
+			{
+				for (int zIndex = minCoord[2]; zIndex <= maxCoord[2]; ++zIndex)
+				{
+					const std::size_t voxelIndex = static_cast<std::size_t>(voxel.computeRawIndexFromCoordIndex(xIndex, yIndex, zIndex));
+					const Storm::NeighborParticleReferralBundle &bundle = *voxel.getBundleAt(voxelIndex, k_containingBundleSlot);
+					if (!bundle.empty())
+					{
+						visitor(bundle);
+					}
+				}
+			}
+		}
+	}
 }
 
 #undef STORM_COMPOSE_REFLECTED_BITS
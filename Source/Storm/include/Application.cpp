@@ -160,7 +160,7 @@ namespace
 
 			Storm::SimulatorManager::instance().initialize();
 
-			Storm::SpacePartitionerManager::instance().initialize(Storm::SimulatorManager::instance().getKernelLength());
+			Storm::SpacePartitionerManager::instance().initialize(Storm::SimulatorManager::instance().getNeighborhoodSearchLength());
 
 			Storm::RaycastManager::instance().initialize();
 
@@ -188,7 +188,6 @@ namespace
 			Storm::SafetyManager::instance().cleanUp();
 			Storm::RaycastManager::instance().cleanUp();
 			Storm::SpacePartitionerManager::instance().cleanUp();
-			Storm::ThreadManager::instance().cleanUp();
 
 			if (hasUI)
 			{
@@ -223,6 +222,10 @@ namespace
 			Storm::BibliographyManager::instance().cleanUp();
 			Storm::RandomManager::instance().cleanUp();
 			Storm::SerializerManager::instance().cleanUp();
+
+			// The parallel worker pool is destroyed here. It must be after all threads that can run parallel loops (graphics, serializer, ...) were stopped.
+			Storm::ThreadManager::instance().cleanUp();
+
 			Storm::ConfigManager::instance().cleanUp();
 			Storm::LoggerManager::instance().cleanUp();
 